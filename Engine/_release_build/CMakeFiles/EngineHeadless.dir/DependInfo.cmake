@@ -0,0 +1,45 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Engine/assetloaderclass.cpp" "CMakeFiles/EngineHeadless.dir/assetloaderclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/assetloaderclass.cpp.o.d"
+  "/root/repo/Engine/blockcompressorclass.cpp" "CMakeFiles/EngineHeadless.dir/blockcompressorclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/blockcompressorclass.cpp.o.d"
+  "/root/repo/Engine/dependencygraphclass.cpp" "CMakeFiles/EngineHeadless.dir/dependencygraphclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/dependencygraphclass.cpp.o.d"
+  "/root/repo/Engine/filewatcherclass.cpp" "CMakeFiles/EngineHeadless.dir/filewatcherclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/filewatcherclass.cpp.o.d"
+  "/root/repo/Engine/gltfimporterclass.cpp" "CMakeFiles/EngineHeadless.dir/gltfimporterclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/gltfimporterclass.cpp.o.d"
+  "/root/repo/Engine/hdrdecoderclass.cpp" "CMakeFiles/EngineHeadless.dir/hdrdecoderclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/hdrdecoderclass.cpp.o.d"
+  "/root/repo/Engine/imageconverterclass.cpp" "CMakeFiles/EngineHeadless.dir/imageconverterclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/imageconverterclass.cpp.o.d"
+  "/root/repo/Engine/inflateclass.cpp" "CMakeFiles/EngineHeadless.dir/inflateclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/inflateclass.cpp.o.d"
+  "/root/repo/Engine/jsonparserclass.cpp" "CMakeFiles/EngineHeadless.dir/jsonparserclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/jsonparserclass.cpp.o.d"
+  "/root/repo/Engine/mappedfileclass.cpp" "CMakeFiles/EngineHeadless.dir/mappedfileclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/mappedfileclass.cpp.o.d"
+  "/root/repo/Engine/meshcookerclass.cpp" "CMakeFiles/EngineHeadless.dir/meshcookerclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/meshcookerclass.cpp.o.d"
+  "/root/repo/Engine/meshfileclass.cpp" "CMakeFiles/EngineHeadless.dir/meshfileclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/meshfileclass.cpp.o.d"
+  "/root/repo/Engine/meshletclass.cpp" "CMakeFiles/EngineHeadless.dir/meshletclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/meshletclass.cpp.o.d"
+  "/root/repo/Engine/meshoptimizerclass.cpp" "CMakeFiles/EngineHeadless.dir/meshoptimizerclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/meshoptimizerclass.cpp.o.d"
+  "/root/repo/Engine/meshsimplifierclass.cpp" "CMakeFiles/EngineHeadless.dir/meshsimplifierclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/meshsimplifierclass.cpp.o.d"
+  "/root/repo/Engine/meshwelderclass.cpp" "CMakeFiles/EngineHeadless.dir/meshwelderclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/meshwelderclass.cpp.o.d"
+  "/root/repo/Engine/mipgeneratorclass.cpp" "CMakeFiles/EngineHeadless.dir/mipgeneratorclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/mipgeneratorclass.cpp.o.d"
+  "/root/repo/Engine/modelparserclass.cpp" "CMakeFiles/EngineHeadless.dir/modelparserclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/modelparserclass.cpp.o.d"
+  "/root/repo/Engine/objimporterclass.cpp" "CMakeFiles/EngineHeadless.dir/objimporterclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/objimporterclass.cpp.o.d"
+  "/root/repo/Engine/pngdecoderclass.cpp" "CMakeFiles/EngineHeadless.dir/pngdecoderclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/pngdecoderclass.cpp.o.d"
+  "/root/repo/Engine/resourcecacheclass.cpp" "CMakeFiles/EngineHeadless.dir/resourcecacheclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/resourcecacheclass.cpp.o.d"
+  "/root/repo/Engine/shadercacheclass.cpp" "CMakeFiles/EngineHeadless.dir/shadercacheclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/shadercacheclass.cpp.o.d"
+  "/root/repo/Engine/shaderpermutationclass.cpp" "CMakeFiles/EngineHeadless.dir/shaderpermutationclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/shaderpermutationclass.cpp.o.d"
+  "/root/repo/Engine/targadecoderclass.cpp" "CMakeFiles/EngineHeadless.dir/targadecoderclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/targadecoderclass.cpp.o.d"
+  "/root/repo/Engine/texturestreamerclass.cpp" "CMakeFiles/EngineHeadless.dir/texturestreamerclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/texturestreamerclass.cpp.o.d"
+  "/root/repo/Engine/threadpoolclass.cpp" "CMakeFiles/EngineHeadless.dir/threadpoolclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/threadpoolclass.cpp.o.d"
+  "/root/repo/Engine/vertexencoderclass.cpp" "CMakeFiles/EngineHeadless.dir/vertexencoderclass.cpp.o" "gcc" "CMakeFiles/EngineHeadless.dir/vertexencoderclass.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,63 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/EngineHeadless.dir/assetloaderclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/assetloaderclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/blockcompressorclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/blockcompressorclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/dependencygraphclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/dependencygraphclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/filewatcherclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/filewatcherclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/gltfimporterclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/gltfimporterclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/hdrdecoderclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/hdrdecoderclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/imageconverterclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/imageconverterclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/inflateclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/inflateclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/jsonparserclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/jsonparserclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/mappedfileclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/mappedfileclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/meshcookerclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/meshcookerclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/meshfileclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/meshfileclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/meshletclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/meshletclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/meshoptimizerclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/meshoptimizerclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/meshsimplifierclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/meshsimplifierclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/meshwelderclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/meshwelderclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/mipgeneratorclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/mipgeneratorclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/modelparserclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/modelparserclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/objimporterclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/objimporterclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/pngdecoderclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/pngdecoderclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/resourcecacheclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/resourcecacheclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/shadercacheclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/shadercacheclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/shaderpermutationclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/shaderpermutationclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/targadecoderclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/targadecoderclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/texturestreamerclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/texturestreamerclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/threadpoolclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/threadpoolclass.cpp.o.d"
+  "CMakeFiles/EngineHeadless.dir/vertexencoderclass.cpp.o"
+  "CMakeFiles/EngineHeadless.dir/vertexencoderclass.cpp.o.d"
+  "libEngineHeadless.a"
+  "libEngineHeadless.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/EngineHeadless.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
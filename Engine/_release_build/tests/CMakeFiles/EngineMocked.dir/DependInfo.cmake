@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Engine/constantringclass.cpp" "tests/CMakeFiles/EngineMocked.dir/__/constantringclass.cpp.o" "gcc" "tests/CMakeFiles/EngineMocked.dir/__/constantringclass.cpp.o.d"
+  "/root/repo/Engine/renderstateclass.cpp" "tests/CMakeFiles/EngineMocked.dir/__/renderstateclass.cpp.o" "gcc" "tests/CMakeFiles/EngineMocked.dir/__/renderstateclass.cpp.o.d"
+  "/root/repo/Engine/stateobjectcacheclass.cpp" "tests/CMakeFiles/EngineMocked.dir/__/stateobjectcacheclass.cpp.o" "gcc" "tests/CMakeFiles/EngineMocked.dir/__/stateobjectcacheclass.cpp.o.d"
+  "/root/repo/Engine/texturecookerclass.cpp" "tests/CMakeFiles/EngineMocked.dir/__/texturecookerclass.cpp.o" "gcc" "tests/CMakeFiles/EngineMocked.dir/__/texturecookerclass.cpp.o.d"
+  "/root/repo/Engine/texturefileclass.cpp" "tests/CMakeFiles/EngineMocked.dir/__/texturefileclass.cpp.o" "gcc" "tests/CMakeFiles/EngineMocked.dir/__/texturefileclass.cpp.o.d"
+  "/root/repo/Engine/texturepackerclass.cpp" "tests/CMakeFiles/EngineMocked.dir/__/texturepackerclass.cpp.o" "gcc" "tests/CMakeFiles/EngineMocked.dir/__/texturepackerclass.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/Engine/_release_build/CMakeFiles/EngineHeadless.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,21 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/EngineMocked.dir/__/constantringclass.cpp.o"
+  "CMakeFiles/EngineMocked.dir/__/constantringclass.cpp.o.d"
+  "CMakeFiles/EngineMocked.dir/__/renderstateclass.cpp.o"
+  "CMakeFiles/EngineMocked.dir/__/renderstateclass.cpp.o.d"
+  "CMakeFiles/EngineMocked.dir/__/stateobjectcacheclass.cpp.o"
+  "CMakeFiles/EngineMocked.dir/__/stateobjectcacheclass.cpp.o.d"
+  "CMakeFiles/EngineMocked.dir/__/texturecookerclass.cpp.o"
+  "CMakeFiles/EngineMocked.dir/__/texturecookerclass.cpp.o.d"
+  "CMakeFiles/EngineMocked.dir/__/texturefileclass.cpp.o"
+  "CMakeFiles/EngineMocked.dir/__/texturefileclass.cpp.o.d"
+  "CMakeFiles/EngineMocked.dir/__/texturepackerclass.cpp.o"
+  "CMakeFiles/EngineMocked.dir/__/texturepackerclass.cpp.o.d"
+  "libEngineMocked.a"
+  "libEngineMocked.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/EngineMocked.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
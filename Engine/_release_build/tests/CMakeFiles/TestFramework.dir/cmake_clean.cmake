@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/TestFramework.dir/testframework.cpp.o"
+  "CMakeFiles/TestFramework.dir/testframework.cpp.o.d"
+  "libTestFramework.a"
+  "libTestFramework.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TestFramework.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
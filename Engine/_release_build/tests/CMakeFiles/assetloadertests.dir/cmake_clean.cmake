@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/assetloadertests.dir/assetloadertests.cpp.o"
+  "CMakeFiles/assetloadertests.dir/assetloadertests.cpp.o.d"
+  "assetloadertests"
+  "assetloadertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/assetloadertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
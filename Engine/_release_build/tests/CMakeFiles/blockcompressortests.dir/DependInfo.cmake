@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Engine/tests/blockcompressortests.cpp" "tests/CMakeFiles/blockcompressortests.dir/blockcompressortests.cpp.o" "gcc" "tests/CMakeFiles/blockcompressortests.dir/blockcompressortests.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/Engine/_release_build/tests/CMakeFiles/TestFramework.dir/DependInfo.cmake"
+  "/root/repo/Engine/_release_build/tests/CMakeFiles/EngineMocked.dir/DependInfo.cmake"
+  "/root/repo/Engine/_release_build/CMakeFiles/EngineHeadless.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/blockcompressortests.dir/blockcompressortests.cpp.o"
+  "CMakeFiles/blockcompressortests.dir/blockcompressortests.cpp.o.d"
+  "blockcompressortests"
+  "blockcompressortests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/blockcompressortests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/constantringtests.dir/constantringtests.cpp.o"
+  "CMakeFiles/constantringtests.dir/constantringtests.cpp.o.d"
+  "constantringtests"
+  "constantringtests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/constantringtests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hdrtests.dir/hdrtests.cpp.o"
+  "CMakeFiles/hdrtests.dir/hdrtests.cpp.o.d"
+  "hdrtests"
+  "hdrtests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/hdrtests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hotreloadtests.dir/hotreloadtests.cpp.o"
+  "CMakeFiles/hotreloadtests.dir/hotreloadtests.cpp.o.d"
+  "hotreloadtests"
+  "hotreloadtests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/hotreloadtests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
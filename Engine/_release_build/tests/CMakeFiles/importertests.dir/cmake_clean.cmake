@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/importertests.dir/importertests.cpp.o"
+  "CMakeFiles/importertests.dir/importertests.cpp.o.d"
+  "importertests"
+  "importertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/importertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
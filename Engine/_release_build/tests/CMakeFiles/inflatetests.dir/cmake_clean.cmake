@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/inflatetests.dir/inflatetests.cpp.o"
+  "CMakeFiles/inflatetests.dir/inflatetests.cpp.o.d"
+  "inflatetests"
+  "inflatetests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/inflatetests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
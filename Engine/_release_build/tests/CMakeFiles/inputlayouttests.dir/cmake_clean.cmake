@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/inputlayouttests.dir/inputlayouttests.cpp.o"
+  "CMakeFiles/inputlayouttests.dir/inputlayouttests.cpp.o.d"
+  "inputlayouttests"
+  "inputlayouttests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/inputlayouttests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/meshfiletests.dir/meshfiletests.cpp.o"
+  "CMakeFiles/meshfiletests.dir/meshfiletests.cpp.o.d"
+  "meshfiletests"
+  "meshfiletests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/meshfiletests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
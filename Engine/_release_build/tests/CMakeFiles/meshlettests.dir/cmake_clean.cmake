@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/meshlettests.dir/meshlettests.cpp.o"
+  "CMakeFiles/meshlettests.dir/meshlettests.cpp.o.d"
+  "meshlettests"
+  "meshlettests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/meshlettests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
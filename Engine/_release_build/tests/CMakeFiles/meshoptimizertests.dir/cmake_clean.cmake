@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/meshoptimizertests.dir/meshoptimizertests.cpp.o"
+  "CMakeFiles/meshoptimizertests.dir/meshoptimizertests.cpp.o.d"
+  "meshoptimizertests"
+  "meshoptimizertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/meshoptimizertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
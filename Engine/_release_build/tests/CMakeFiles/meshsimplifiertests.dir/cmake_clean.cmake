@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/meshsimplifiertests.dir/meshsimplifiertests.cpp.o"
+  "CMakeFiles/meshsimplifiertests.dir/meshsimplifiertests.cpp.o.d"
+  "meshsimplifiertests"
+  "meshsimplifiertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/meshsimplifiertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/meshweldertests.dir/meshweldertests.cpp.o"
+  "CMakeFiles/meshweldertests.dir/meshweldertests.cpp.o.d"
+  "meshweldertests"
+  "meshweldertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/meshweldertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
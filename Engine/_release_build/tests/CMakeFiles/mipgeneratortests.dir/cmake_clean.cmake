@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mipgeneratortests.dir/mipgeneratortests.cpp.o"
+  "CMakeFiles/mipgeneratortests.dir/mipgeneratortests.cpp.o.d"
+  "mipgeneratortests"
+  "mipgeneratortests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mipgeneratortests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/modelparsertests.dir/modelparsertests.cpp.o"
+  "CMakeFiles/modelparsertests.dir/modelparsertests.cpp.o.d"
+  "modelparsertests"
+  "modelparsertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/modelparsertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
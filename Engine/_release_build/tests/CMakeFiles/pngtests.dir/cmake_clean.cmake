@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pngtests.dir/pngtests.cpp.o"
+  "CMakeFiles/pngtests.dir/pngtests.cpp.o.d"
+  "pngtests"
+  "pngtests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pngtests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/renderstatetests.dir/renderstatetests.cpp.o"
+  "CMakeFiles/renderstatetests.dir/renderstatetests.cpp.o.d"
+  "renderstatetests"
+  "renderstatetests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/renderstatetests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
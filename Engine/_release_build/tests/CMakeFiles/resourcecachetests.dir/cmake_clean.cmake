@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/resourcecachetests.dir/resourcecachetests.cpp.o"
+  "CMakeFiles/resourcecachetests.dir/resourcecachetests.cpp.o.d"
+  "resourcecachetests"
+  "resourcecachetests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/resourcecachetests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
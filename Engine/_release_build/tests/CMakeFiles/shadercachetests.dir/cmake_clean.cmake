@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/shadercachetests.dir/shadercachetests.cpp.o"
+  "CMakeFiles/shadercachetests.dir/shadercachetests.cpp.o.d"
+  "shadercachetests"
+  "shadercachetests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/shadercachetests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
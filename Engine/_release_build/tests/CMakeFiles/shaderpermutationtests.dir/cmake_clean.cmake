@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/shaderpermutationtests.dir/shaderpermutationtests.cpp.o"
+  "CMakeFiles/shaderpermutationtests.dir/shaderpermutationtests.cpp.o.d"
+  "shaderpermutationtests"
+  "shaderpermutationtests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/shaderpermutationtests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/targatests.dir/targatests.cpp.o"
+  "CMakeFiles/targatests.dir/targatests.cpp.o.d"
+  "targatests"
+  "targatests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/targatests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
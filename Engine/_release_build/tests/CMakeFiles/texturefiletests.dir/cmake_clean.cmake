@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/texturefiletests.dir/texturefiletests.cpp.o"
+  "CMakeFiles/texturefiletests.dir/texturefiletests.cpp.o.d"
+  "texturefiletests"
+  "texturefiletests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/texturefiletests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/texturepackertests.dir/texturepackertests.cpp.o"
+  "CMakeFiles/texturepackertests.dir/texturepackertests.cpp.o.d"
+  "texturepackertests"
+  "texturepackertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/texturepackertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/texturestreamertests.dir/texturestreamertests.cpp.o"
+  "CMakeFiles/texturestreamertests.dir/texturestreamertests.cpp.o.d"
+  "texturestreamertests"
+  "texturestreamertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/texturestreamertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
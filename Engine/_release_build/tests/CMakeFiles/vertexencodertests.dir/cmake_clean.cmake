@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/vertexencodertests.dir/vertexencodertests.cpp.o"
+  "CMakeFiles/vertexencodertests.dir/vertexencodertests.cpp.o.d"
+  "vertexencodertests"
+  "vertexencodertests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/vertexencodertests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,56 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/Engine/tests
+# Build directory: /root/repo/Engine/_release_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(meshfiletests "/root/repo/Engine/_release_build/tests/meshfiletests")
+set_tests_properties(meshfiletests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;23;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(modelparsertests "/root/repo/Engine/_release_build/tests/modelparsertests")
+set_tests_properties(modelparsertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;24;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(meshweldertests "/root/repo/Engine/_release_build/tests/meshweldertests")
+set_tests_properties(meshweldertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;25;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(meshoptimizertests "/root/repo/Engine/_release_build/tests/meshoptimizertests")
+set_tests_properties(meshoptimizertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;26;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(vertexencodertests "/root/repo/Engine/_release_build/tests/vertexencodertests")
+set_tests_properties(vertexencodertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;27;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(inputlayouttests "/root/repo/Engine/_release_build/tests/inputlayouttests")
+set_tests_properties(inputlayouttests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;28;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(meshlettests "/root/repo/Engine/_release_build/tests/meshlettests")
+set_tests_properties(meshlettests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;29;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(meshsimplifiertests "/root/repo/Engine/_release_build/tests/meshsimplifiertests")
+set_tests_properties(meshsimplifiertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;30;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(importertests "/root/repo/Engine/_release_build/tests/importertests")
+set_tests_properties(importertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;31;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(assetloadertests "/root/repo/Engine/_release_build/tests/assetloadertests")
+set_tests_properties(assetloadertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;32;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(resourcecachetests "/root/repo/Engine/_release_build/tests/resourcecachetests")
+set_tests_properties(resourcecachetests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;33;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(hotreloadtests "/root/repo/Engine/_release_build/tests/hotreloadtests")
+set_tests_properties(hotreloadtests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;34;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(targatests "/root/repo/Engine/_release_build/tests/targatests")
+set_tests_properties(targatests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;35;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(inflatetests "/root/repo/Engine/_release_build/tests/inflatetests")
+set_tests_properties(inflatetests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;36;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(pngtests "/root/repo/Engine/_release_build/tests/pngtests")
+set_tests_properties(pngtests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;37;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(mipgeneratortests "/root/repo/Engine/_release_build/tests/mipgeneratortests")
+set_tests_properties(mipgeneratortests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;38;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(blockcompressortests "/root/repo/Engine/_release_build/tests/blockcompressortests")
+set_tests_properties(blockcompressortests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;39;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(texturefiletests "/root/repo/Engine/_release_build/tests/texturefiletests")
+set_tests_properties(texturefiletests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;40;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(texturepackertests "/root/repo/Engine/_release_build/tests/texturepackertests")
+set_tests_properties(texturepackertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;41;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(texturestreamertests "/root/repo/Engine/_release_build/tests/texturestreamertests")
+set_tests_properties(texturestreamertests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;42;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(hdrtests "/root/repo/Engine/_release_build/tests/hdrtests")
+set_tests_properties(hdrtests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;43;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(shadercachetests "/root/repo/Engine/_release_build/tests/shadercachetests")
+set_tests_properties(shadercachetests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;44;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(renderstatetests "/root/repo/Engine/_release_build/tests/renderstatetests")
+set_tests_properties(renderstatetests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;45;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(constantringtests "/root/repo/Engine/_release_build/tests/constantringtests")
+set_tests_properties(constantringtests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;46;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
+add_test(shaderpermutationtests "/root/repo/Engine/_release_build/tests/shaderpermutationtests")
+set_tests_properties(shaderpermutationtests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Engine/tests/CMakeLists.txt;20;add_test;/root/repo/Engine/tests/CMakeLists.txt;47;engine_test;/root/repo/Engine/tests/CMakeLists.txt;0;")
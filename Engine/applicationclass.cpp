@@ -10,39 +10,108 @@ ApplicationClass::ApplicationClass(int screenWidth, int screenHeight, HWND hwnd)
 	XMFLOAT3 camPos{ 0.0f, 0.0f, -5.0f };
 	m_Camera = new CameraClass(camPos);
 
-	m_Model = new ModelClass(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), modelFilename, textureFilename);
-	if (not m_Model->isInitialized) {
-		MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
+	XMFLOAT4 diffuseCol{ 1.0f, 1.0f, 1.0f, 1.0f };
+	XMFLOAT3 lDirection{ 0.0f, 0.0f, 1.0f };
+	m_Light = new LightClass(diffuseCol, lDirection);
+
+	m_Registry = new ResourceRegistryClass();
+	char cardName[128];
+	int videoMemory = 0;
+	m_Direct3D->GetVideoCardInfo(cardName, videoMemory);
+	m_TextureStreamer = new TextureStreamerClass(TextureStreamSettings::FromVideoMemory(videoMemory, TEXTURE_MEMORY_SHARE));
+	m_Registry->textureStreamer = m_TextureStreamer;
+	m_ShaderCache = new ShaderCacheClass(SHADER_CACHE_DIRECTORY, ShaderCacheClass::CompileD3D, ShaderCacheClass::GetD3DCompilerKey());
+	m_Registry->shaderCache = m_ShaderCache;
+	m_Registry->stateObjects = &m_Direct3D->GetStateObjects();
+	m_modelPath = m_Registry->paths.Intern(MODEL_FILENAME);
+	m_texturePath = m_Registry->paths.Intern(TEXTURE_FILENAME);
+	m_lightShaderPath = m_Registry->paths.Intern(LIGHT_SHADER_FILENAME);
+	m_lightPixelShaderPath = m_Registry->paths.Intern(LIGHT_PIXEL_SHADER_FILENAME);
+
+	m_Loader = new AssetLoaderClass();
+	if (not m_Loader->isInitialized) {
+		MessageBox(hwnd, L"Could not start the asset loader.", L"Error", MB_OK);
 		return;
 	}
+	// Editing the content while the engine runs is a convenience, the engine works without it.
+	m_HotReload = new HotReloadClass(*m_Registry, m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext());
+	LoadScene(hwnd);
+
+	isInitialized = true;
+}
+
+AssetTask ApplicationClass::LoadScene(HWND hwnd) {
+	// The window keeps running while the model cooks and decodes, the rest of the scene waits for its vertex format.
+	MeshCookSettings cookSettings;
+	cookSettings.vertexEncoding = VertexEncoding::Compact();
+	// The shaders the model will most likely need load or compile meanwhile, the format only decides their defines.
+	// Every detail level of the scene's shading is compiled up front, so switching between them never stalls.
+	std::vector<ShaderKey> shaderKeys = ShaderPermutationClass::GetDetailKeys(SCENE_SHADER_KEY);
+	MeshVertexFormat expectedFormat;
+	expectedFormat.encoding = cookSettings.vertexEncoding;
+	m_ShaderCache->Prefetch(LightShaderClass::GetCompileRequests(expectedFormat, shaderKeys));
+	AssetHandle<ModelClass> model = ModelClass::LoadAsync(*m_Loader, *m_Registry, m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(),
+		m_modelPath, m_texturePath, cookSettings);
+	if (not co_await model) {
+		MessageBoxA(hwnd, model.GetError().c_str(), "Could not initialize the model object.", MB_OK);
+		m_loadFailed = true;
+		co_return;
+	}
 
-	m_LightShader = new LightShaderClass(m_Direct3D->GetDevice(), hwnd);
-	if (not m_LightShader->isInitialized) {
+	// Models with the same vertex encodings share one compiled shader.
+	const MeshVertexFormat& format = model.Get()->GetVertexFormat();
+	std::string error;
+	m_lightShaderHandle = m_Registry->shaders.Acquire(ResourceKey(m_lightShaderPath, LightShaderClass::GetVariant(format)), [&](std::string&) -> LightShaderClass* {
+		LightShaderClass* shader = new LightShaderClass(m_Direct3D->GetDevice(), hwnd, format, shaderKeys, m_Direct3D->GetStateObjects(), m_ShaderCache);
+		if (shader->isInitialized) { return shader; }
+		delete shader;
+		return 0;
+	}, error);
+	if (not m_lightShaderHandle.IsValid()) {
 		MessageBox(hwnd, L"Could not initialize the light shader object.", L"Error", MB_OK);
-		return;
+		m_loadFailed = true;
+		co_return;
 	}
+	m_Model = model.Get();
 
-	XMFLOAT4 diffuseCol{ 1.0f, 1.0f, 1.0f, 1.0f };
-	XMFLOAT3 lDirection{ 0.0f, 0.0f, 1.0f };
-	m_Light = new LightClass(diffuseCol, lDirection);
+	ShaderCacheStats shaderStats = m_ShaderCache->GetStats();
+	OutputDebugStringA(("Shader cache: " + std::to_string(shaderStats.hits) + " loaded in " + std::to_string(shaderStats.loadMilliseconds) + " ms, "
+		+ std::to_string(shaderStats.misses) + " compiled in " + std::to_string(shaderStats.compileMilliseconds) + " ms\n").c_str());
 
-	isInitialized = true;
+	m_HotReload->WatchMesh(m_modelPath, cookSettings);
+	m_HotReload->WatchTexture(m_texturePath);
+	m_HotReload->WatchLightShader(m_lightShaderPath, m_lightPixelShaderPath, format, shaderKeys);
 }
 
 ApplicationClass::~ApplicationClass() {
+	Delete(m_Loader);	// First, a scene load still waiting on it must not outlive the rest.
+	Delete(m_HotReload);
+	Delete(m_ShaderCache);	// After everything that may still compile on a worker.
+	if (m_Registry) { m_Registry->shaders.Release(m_lightShaderHandle); }
+	Delete(m_Registry);	// After every owner of a handle is gone.
+	Delete(m_TextureStreamer);
 	Delete(m_Light);
-	Delete(m_LightShader);
-	Delete(m_Model);
 	Delete(m_Camera);
 	Delete(m_Direct3D);
 }
 
-void ApplicationClass::Delete(const void* item) {
-	if (!item) { return; }
-	delete item;
-	item = 0;
-}
 bool ApplicationClass::Frame() {
+	m_Loader->Update(UPLOADS_PER_FRAME);
+	if (m_loadFailed) { return false; }
+
+	// Between frames, so a frame never mixes old and new resources. Failed reloads keep the old ones.
+	std::vector<std::string> reloadErrors;
+	m_HotReload->Update(reloadErrors);
+	for (const std::string& error : reloadErrors) { OutputDebugStringA(("Hot reload: " + error + "\n").c_str()); }
+
+	// The mips the last frame's models asked for. A texture that could not be rebuilt keeps what it had.
+	for (const TextureStreamAction& action : m_TextureStreamer->Update()) {
+		TextureClass* texture = m_Registry->textures.Lookup(action.key);
+		if (!texture) { continue; }
+		texture->SetResidentMip(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), action.mip);
+		m_TextureStreamer->SetResident(action.key, texture->GetResidentMip());
+	}
+
 	static float rotation = 0.0f;
 	rotation -= 0.0174532925f * 0.3f;
 	if (rotation < 0.0f) { rotation += 360.0f; }
@@ -51,6 +120,10 @@ bool ApplicationClass::Frame() {
 
 bool ApplicationClass::Render(float rotation ) {
 	m_Direct3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+	if (!m_Model) {	// Still loading, show the cleared screen.
+		m_Direct3D->EndScene();
+		return true;
+	}
 	m_Camera->Render();
 
 	XMMATRIX worldMatrix = m_Direct3D->GetWorldMatrix();
@@ -59,10 +132,26 @@ bool ApplicationClass::Render(float rotation ) {
 
 	worldMatrix = XMMatrixRotationY(rotation);
 
-	m_Model->Render(m_Direct3D->GetDeviceContext());
+	RenderStateClass& states = m_Direct3D->GetRenderState();
+	m_Model->Render(states);
+	LodSelection lodSelection;
+	lodSelection.pixelScale = m_Direct3D->GetViewportHeight() / (2.0f * tanf(FIELD_OF_VIEW * 0.5f));
+	lodSelection.nearPlane = SCREEN_NEAR;
+	const vector<IndexRange>& visibleRanges = m_Model->Cull(worldMatrix, viewMatrix, projectionMatrix, lodSelection);
+
+	// Once for the frame, every object only adds its world matrix.
+	LightShaderClass* lightShader = m_Registry->shaders.Get(m_lightShaderHandle);
+	XMMATRIX viewProjectionMatrix = XMMatrixMultiply(viewMatrix, projectionMatrix);
+	SceneLighting lighting;
+	lighting.directions[0] = m_Light->GetDirection();
+	lighting.colors[0] = m_Light->GetDiffuseColor();
+	bool success = lightShader->SetFrameParameters(states, viewProjectionMatrix, m_Camera->GetPosition(), lighting);
+	if (not success) { return false; }
 
-	bool success = m_LightShader->Render(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, m_Model->GetTexture(),
-		m_Light->GetDirection(), m_Light->GetDiffuseColor());
+	// Shaded by how much of the screen the model covers, whatever LODs its mesh has.
+	ShaderKey shaderKey = ShaderPermutationClass::Reduce(SCENE_SHADER_KEY, ShaderPermutationClass::SelectDetail(m_Model->GetScreenSize()));
+	success = lightShader->Render(states, m_Direct3D->GetConstantRing(), shaderKey, visibleRanges, worldMatrix, m_Model->GetTexture(),
+		m_Model->GetTextureRegion(), m_Model->GetVertexFormat());
 	if (not success) { return false; }
 
 	m_Direct3D->EndScene();
@@ -3,8 +3,7 @@
 #include "d3dclass.hpp"
 #include "cameraclass.hpp"
 #include "modelclass.hpp"
-#include "colorshaderclass.hpp"
-#include "textureshaderclass.hpp"
+#include "hotreloadclass.hpp"
 #include "lightshaderclass.hpp"
 #include "lightclass.hpp"
 
@@ -12,6 +11,15 @@ static constexpr bool FULL_SCREEN = false;
 static constexpr bool VSYNC_ENABLED = true;
 static constexpr float SCREEN_DEPTH = 1000.0f;
 static constexpr float SCREEN_NEAR = 0.3f;
+static constexpr size_t UPLOADS_PER_FRAME = 4;	// Finished loads that may create their GPU objects in one frame.
+static constexpr float TEXTURE_MEMORY_SHARE = 0.5f;	// Of the dedicated video memory, for the streamed textures.
+static constexpr const char* MODEL_FILENAME = "../Engine/data/cube.txt";
+static constexpr const char* TEXTURE_FILENAME = "../Engine/data/stone01.tga";
+static constexpr const char* LIGHT_SHADER_FILENAME = LightShaderClass::VERTEX_SHADER_FILENAME;
+static constexpr const char* LIGHT_PIXEL_SHADER_FILENAME = LightShaderClass::PIXEL_SHADER_FILENAME;
+static constexpr const char* SHADER_CACHE_DIRECTORY = "../Engine/shadercache";
+// How the scene is shaded up close, farther objects draw with ShaderPermutationClass::Reduce of it.
+static constexpr ShaderKey SCENE_SHADER_KEY = ShaderKey().With(ShaderKey::TEXTURE).WithLighting(LIGHTING_LAMBERT).WithLightCount(1);
 
 class ApplicationClass
 {
@@ -26,14 +34,25 @@ public:
 private:
 	D3DClass* m_Direct3D = 0;
 	CameraClass* m_Camera = 0;
-	ModelClass* m_Model = 0;
-	ColorShaderClass* m_ColorShader = 0;
-	TextureShaderClass* m_TextureShader = 0;
-	char textureFilename[128] = "../Engine/data/stone01.tga";
-	char modelFilename[128] = "../Engine/data/cube.txt";
-	LightShaderClass* m_LightShader = 0;
+	ResourceRegistryClass* m_Registry = 0;	// Outlives the loader, whose models hold handles into it.
+	AssetLoaderClass* m_Loader = 0;
+	HotReloadClass* m_HotReload = 0;
+	TextureStreamerClass* m_TextureStreamer = 0;	// Used by the registry's textures.
+	ShaderCacheClass* m_ShaderCache = 0;	// Used by the registry's shaders.
+	ModelClass* m_Model = 0;	// Owned by the loader, 0 until it is ready.
+	AssetPath m_modelPath;
+	AssetPath m_texturePath;
+	AssetPath m_lightShaderPath;
+	AssetPath m_lightPixelShaderPath;
+	ResourceHandle m_lightShaderHandle;	// Looked up every frame, hot reloads swap the shader behind it.
 	LightClass* m_Light = 0;
+	bool m_loadFailed = false;
 
+	AssetTask LoadScene(HWND);
 	bool Render(float);
-	void Delete(const void *);
+	template <class T> void Delete(T*& item) {	// Typed, so the destructor runs.
+		if (!item) { return; }
+		delete item;
+		item = 0;
+	}
 };
\ No newline at end of file
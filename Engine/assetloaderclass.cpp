@@ -0,0 +1,75 @@
+#include "assetloaderclass.hpp"
+
+AssetLoaderClass::AssetLoaderClass(size_t threadCount, size_t uploadQueueSize) {
+	m_uploadQueueSize = uploadQueueSize > 0 ? uploadQueueSize : 1;
+	m_pool = new ThreadPoolClass(threadCount);
+	isInitialized = m_pool->isInitialized;
+}
+
+AssetLoaderClass::~AssetLoaderClass() {
+	// Workers stuck on a full queue give up, the pool then waits for the running loads and drops the rest.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_notFull.notify_all();
+	if (m_pool) {
+		delete m_pool;
+		m_pool = 0;
+	}
+
+	for (AssetState* state : m_states) {
+		for (std::coroutine_handle<> waiter : state->waiters) { waiter.destroy(); }
+		delete state;
+	}
+	m_states.clear();
+}
+
+void AssetLoaderClass::Start(std::function<void()> work) {
+	m_pool->Submit(std::move(work));
+}
+
+void AssetLoaderClass::Finish(AssetState* state) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_notFull.wait(lock, [this] { return m_stopping || m_uploads.size() < m_uploadQueueSize; });
+	if (m_stopping) { return; }
+	m_uploads.push_back(state);
+	m_notEmpty.notify_one();
+}
+
+size_t AssetLoaderClass::Update(size_t maxUploads) {
+	size_t uploads = 0;
+	while (uploads < maxUploads) {
+		AssetState* state = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_uploads.empty()) { break; }
+			state = m_uploads.front();
+			m_uploads.pop_front();
+		}
+		m_notFull.notify_one();
+		Complete(state);
+		uploads++;
+	}
+	return uploads;
+}
+
+void AssetLoaderClass::Complete(AssetState* state) {
+	bool success = state->HasResource() && state->Upload(state->error);
+	if (!success) {
+		state->Release();
+		if (state->error.empty()) { state->error = "the asset could not be loaded"; }
+	}
+	state->status = success ? ASSET_READY : ASSET_FAILED;
+	m_loading--;
+
+	// Resumed coroutines may start or wait for other loads, so they get a copy of the list.
+	std::vector<std::coroutine_handle<>> waiters;
+	waiters.swap(state->waiters);
+	for (std::coroutine_handle<> waiter : waiters) { waiter.resume(); }
+}
+
+void AssetLoaderClass::WaitForUpload() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_notEmpty.wait(lock, [this] { return !m_uploads.empty(); });
+}
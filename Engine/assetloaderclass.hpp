@@ -0,0 +1,158 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "threadpoolclass.hpp"
+
+enum AssetStatus { ASSET_LOADING, ASSET_READY, ASSET_FAILED };
+
+// What the loader keeps per asset. Workers only fill in the resource and error, then hand the state over through the
+// upload queue; status and waiters belong to the main thread.
+struct AssetState {
+	AssetState() {}
+	AssetState(const AssetState&) = delete;
+	virtual ~AssetState() {}
+
+	virtual bool HasResource() const = 0;
+	virtual bool Upload(std::string& error) = 0;
+	virtual void Release() = 0;
+
+	AssetStatus status = ASSET_LOADING;
+	std::string error;
+	std::vector<std::coroutine_handle<>> waiters;
+};
+
+template <class T>
+struct AssetStateOf : AssetState {
+	T* resource = 0;
+	T* placeholder = 0;	// Owned by the caller.
+	std::function<bool(T&, std::string&)> upload;
+
+	~AssetStateOf() { Release(); }
+	bool HasResource() const override { return resource != 0; }
+	bool Upload(std::string& error) override { return !upload || upload(*resource, error); }
+	void Release() override {
+		delete resource;
+		resource = 0;
+	}
+};
+
+// Main thread view of a load. Get hands out the placeholder until the asset is ready, co_await suspends the caller
+// until AssetLoaderClass::Update finished it and yields the asset, or 0 when it failed.
+template <class T>
+class AssetHandle {
+public:
+	AssetHandle() {}
+	explicit AssetHandle(AssetStateOf<T>* state) : m_state(state) {}
+
+	bool IsValid() const { return m_state != 0; }
+	bool IsLoading() const { return m_state && m_state->status == ASSET_LOADING; }
+	bool IsReady() const { return m_state && m_state->status == ASSET_READY; }
+	bool IsFailed() const { return m_state && m_state->status == ASSET_FAILED; }
+	T* Get() const {
+		if (!m_state) { return 0; }
+		return m_state->status == ASSET_READY ? m_state->resource : m_state->placeholder;
+	}
+	const std::string& GetError() const {
+		static const std::string none;
+		return m_state ? m_state->error : none;
+	}
+
+	struct Awaiter {
+		AssetStateOf<T>* state;
+		bool await_ready() const { return !state || state->status != ASSET_LOADING; }
+		void await_suspend(std::coroutine_handle<> handle) const { state->waiters.push_back(handle); }
+		T* await_resume() const { return state && state->status == ASSET_READY ? state->resource : 0; }
+	};
+	Awaiter operator co_await() const { return Awaiter{ m_state }; }
+
+private:
+	AssetStateOf<T>* m_state = 0;
+};
+
+// Return type for coroutines that await assets. Runs eagerly on the calling thread, resumes on the main thread inside
+// Update and frees itself when it returns. A coroutine still waiting when the loader goes away is destroyed with it.
+struct AssetTask {
+	struct promise_type {
+		AssetTask get_return_object() { return AssetTask(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+// Runs the file I/O and decoding of assets on a thread pool and finishes them on the main thread. Finished loads wait
+// in a bounded queue, so workers stall instead of piling up decoded data when the main thread falls behind, and
+// Update takes at most a per frame budget of them to create their GPU objects. The loader owns every asset it loaded.
+class AssetLoaderClass {
+public:
+	static constexpr size_t UPLOAD_QUEUE_SIZE = 16;
+
+	AssetLoaderClass(size_t threadCount = 0, size_t uploadQueueSize = UPLOAD_QUEUE_SIZE);
+	AssetLoaderClass(const AssetLoaderClass&) = delete;
+	~AssetLoaderClass();
+
+	// load runs on a worker and returns the new asset or 0 with an error, upload then runs on the main thread.
+	template <class T>
+	AssetHandle<T> Load(std::function<T*(std::string&)> load, std::function<bool(T&, std::string&)> upload, T* placeholder = 0);
+
+	// Main thread, once per frame. Finishes up to maxUploads loads and resumes whatever awaited them.
+	size_t Update(size_t maxUploads = SIZE_MAX);
+	// Blocks like future::get, finishing loads in the meantime. Only for the main thread.
+	template <class T>
+	T* Wait(const AssetHandle<T>& handle);
+
+	size_t GetLoadingCount() const { return m_loading; }
+	size_t GetThreadCount() const { return m_pool->GetThreadCount(); }
+
+	bool isInitialized = false;
+
+private:
+	void Start(std::function<void()> work);
+	void Finish(AssetState* state);
+	void Complete(AssetState* state);
+	void WaitForUpload();
+
+	ThreadPoolClass* m_pool = 0;
+	std::vector<AssetState*> m_states;
+	size_t m_loading = 0;
+
+	std::deque<AssetState*> m_uploads;
+	size_t m_uploadQueueSize = UPLOAD_QUEUE_SIZE;
+	std::mutex m_mutex;
+	std::condition_variable m_notFull;
+	std::condition_variable m_notEmpty;
+	bool m_stopping = false;
+};
+
+template <class T>
+AssetHandle<T> AssetLoaderClass::Load(std::function<T*(std::string&)> load, std::function<bool(T&, std::string&)> upload, T* placeholder) {
+	AssetStateOf<T>* state = new AssetStateOf<T>;
+	state->placeholder = placeholder;
+	state->upload = std::move(upload);
+	m_states.push_back(state);
+	m_loading++;
+
+	Start([this, state, load = std::move(load)]() {
+		state->resource = load(state->error);
+		Finish(state);
+	});
+	return AssetHandle<T>(state);
+}
+
+template <class T>
+T* AssetLoaderClass::Wait(const AssetHandle<T>& handle) {
+	while (handle.IsLoading()) {
+		WaitForUpload();
+		Update();
+	}
+	return handle.IsReady() ? handle.Get() : 0;
+}
@@ -0,0 +1,1169 @@
+#include "blockcompressorclass.hpp"
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLOCKCOMPRESSOR_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BLOCKCOMPRESSOR_NEON
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline unsigned int CountTrailingZeros(unsigned int mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+static constexpr int REFINE_ROUNDS = 8;	// Cap on the endpoint search of the high preset.
+
+namespace {
+
+// The texels of one block in RGBA order, rows top to bottom.
+typedef unsigned char Texels[16][4];
+typedef unsigned char Palette[16][4];
+
+// The block again, one channel after the other and widened to 16 bits, the layout FitPalette works on. Channels left
+// out are zero, so a palette with zeros there ignores them.
+struct alignas(16) PlanarBlock {
+	int16_t channels[4][16];
+};
+
+// One row of the BC7 mode table.
+struct Bc7Mode {
+	int subsets;
+	int partitionBits;
+	int rotationBits;
+	int indexSelectionBits;
+	int colorBits;
+	int alphaBits;
+	int endpointPBits;	// One p-bit for every endpoint.
+	int sharedPBits;	// One p-bit for both endpoints of a subset.
+	int indexBits;
+	int secondaryIndexBits;
+};
+
+struct Bc1Result {
+	unsigned error;
+	uint16_t color0;
+	uint16_t color1;
+	unsigned char indices[16];
+};
+
+struct Bc4Result {
+	unsigned error;
+	int endpoint0;
+	int endpoint1;
+	unsigned char indices[16];
+};
+
+struct Bc7Result {
+	unsigned error;
+	int mode;
+	int partition;
+	unsigned char endpoints[3][2][4];	// Subset, endpoint, channel. Quantized to the mode's bits, without the p-bits.
+	unsigned char pbits[3][2];
+	int rotation;
+	unsigned char indices[16];
+	unsigned char secondaryIndices[16];	// Alpha of mode 5.
+};
+
+// 128 bits from the least significant bit of the first byte up, the order every BC7 field is stored in.
+struct BitWriter {
+	unsigned char* data;
+	int position;
+
+	void Write(unsigned value, int bits) {
+		for (int i = 0; i < bits; i++, position++) { data[position >> 3] |= (unsigned char)(((value >> i) & 1) << (position & 7)); }
+	}
+};
+
+struct BitReader {
+	const unsigned char* data;
+	int position;
+
+	unsigned Read(int bits) {
+		unsigned value = 0;
+		for (int i = 0; i < bits; i++, position++) { value |= (unsigned)((data[position >> 3] >> (position & 7)) & 1) << i; }
+		return value;
+	}
+};
+
+struct SingleColorTables {
+	unsigned char five[256][2];	// Endpoints whose 2/3 point is closest to each byte, for the 5 and 6 bit fields of 565.
+	unsigned char six[256][2];
+};
+
+}
+
+static const Bc7Mode BC7_MODES[8] = {
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// Subset of every texel, two bits each with texel 0 lowest.
+static const uint32_t BC7_PARTITIONS_2[64] = {
+	0x50505050, 0x40404040, 0x54545454, 0x54505040, 0x50404000, 0x55545450, 0x55545040, 0x54504000,
+	0x50400000, 0x55555450, 0x55544000, 0x54400000, 0x55555440, 0x55550000, 0x55555500, 0x55000000,
+	0x55150100, 0x00004054, 0x15010000, 0x00405054, 0x00004050, 0x15050100, 0x05010000, 0x40505054,
+	0x00404050, 0x05010100, 0x14141414, 0x05141450, 0x01155440, 0x00555500, 0x15014054, 0x05414150,
+	0x44444444, 0x55005500, 0x11441144, 0x05055050, 0x05500550, 0x11114444, 0x41144114, 0x44111144,
+	0x15055054, 0x01055040, 0x05041050, 0x05455150, 0x14414114, 0x50050550, 0x41411414, 0x00141400,
+	0x00041504, 0x00105410, 0x10541000, 0x04150400, 0x50410514, 0x41051450, 0x05415014, 0x14054150,
+	0x41050514, 0x41505014, 0x40011554, 0x54150140, 0x50505500, 0x00555050, 0x15151010, 0x54540404,
+};
+
+static const uint32_t BC7_PARTITIONS_3[64] = {
+	0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+	0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+	0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+	0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+	0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+	0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+	0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+	0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+};
+
+// The texel of each subset after the first whose index is stored one bit short, texel 0 is the anchor of the first.
+static const unsigned char BC7_ANCHORS_2[64] = {
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+	15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+	 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+};
+
+static const unsigned char BC7_ANCHORS_3[2][64] = {
+	{
+		 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+		 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+		 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+		 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+	},
+	{
+		15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+		15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+		15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+		15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+	},
+};
+
+static const unsigned char BC7_WEIGHTS_2[4] = { 0, 21, 43, 64 };
+static const unsigned char BC7_WEIGHTS_3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const unsigned char BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// How far along from the first endpoint to the second each index of the fixed formats sits.
+static const float BC1_WEIGHTS_4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const float BC1_WEIGHTS_3[3] = { 0.0f, 1.0f, 0.5f };
+static const float BC4_WEIGHTS[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+
+// Best palette entry of every texel in mask and their summed squared error. Indices of texels outside mask are kept,
+// ties go to the lower index.
+#if defined(BLOCKCOMPRESSOR_SSE2)
+static unsigned FitPalette(const PlanarBlock& block, const Palette palette, int count, unsigned mask, unsigned char* indices) {
+	const __m128i* channels = (const __m128i*)block.channels;
+	__m128i best[4];
+	__m128i bestIndex[4];
+	for (int g = 0; g < 4; g++) {
+		best[g] = _mm_set1_epi32(INT_MAX);
+		bestIndex[g] = _mm_setzero_si128();
+	}
+
+	for (int p = 0; p < count; p++) {
+		__m128i index = _mm_set1_epi32(p);
+		for (int half = 0; half < 2; half++) {
+			__m128i r = _mm_sub_epi16(_mm_load_si128(channels + half), _mm_set1_epi16(palette[p][0]));
+			__m128i g = _mm_sub_epi16(_mm_load_si128(channels + 2 + half), _mm_set1_epi16(palette[p][1]));
+			__m128i b = _mm_sub_epi16(_mm_load_si128(channels + 4 + half), _mm_set1_epi16(palette[p][2]));
+			__m128i a = _mm_sub_epi16(_mm_load_si128(channels + 6 + half), _mm_set1_epi16(palette[p][3]));
+			// Interleaving two channels lets one multiply-add square and sum them for four texels.
+			__m128i rg = _mm_unpacklo_epi16(r, g);
+			__m128i ba = _mm_unpacklo_epi16(b, a);
+			__m128i errors[2];
+			errors[0] = _mm_add_epi32(_mm_madd_epi16(rg, rg), _mm_madd_epi16(ba, ba));
+			rg = _mm_unpackhi_epi16(r, g);
+			ba = _mm_unpackhi_epi16(b, a);
+			errors[1] = _mm_add_epi32(_mm_madd_epi16(rg, rg), _mm_madd_epi16(ba, ba));
+			for (int k = 0; k < 2; k++) {
+				int g4 = half * 2 + k;
+				__m128i less = _mm_cmplt_epi32(errors[k], best[g4]);
+				best[g4] = _mm_or_si128(_mm_and_si128(less, errors[k]), _mm_andnot_si128(less, best[g4]));
+				bestIndex[g4] = _mm_or_si128(_mm_and_si128(less, index), _mm_andnot_si128(less, bestIndex[g4]));
+			}
+		}
+	}
+
+	__m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+	__m128i selected[4];
+	__m128i total = _mm_setzero_si128();
+	for (int g = 0; g < 4; g++) {
+		__m128i group = _mm_and_si128(_mm_set1_epi32((int)(mask >> (g * 4))), bits);
+		selected[g] = _mm_cmpeq_epi32(group, bits);
+		total = _mm_add_epi32(total, _mm_and_si128(selected[g], best[g]));
+	}
+	total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+	total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	__m128i fitted = _mm_packus_epi16(_mm_packs_epi32(bestIndex[0], bestIndex[1]), _mm_packs_epi32(bestIndex[2], bestIndex[3]));
+	__m128i keep = _mm_packs_epi16(_mm_packs_epi32(selected[0], selected[1]), _mm_packs_epi32(selected[2], selected[3]));
+	__m128i previous = _mm_loadu_si128((const __m128i*)indices);
+	_mm_storeu_si128((__m128i*)indices, _mm_or_si128(_mm_and_si128(keep, fitted), _mm_andnot_si128(keep, previous)));
+	return (unsigned)_mm_cvtsi128_si32(total);
+}
+#elif defined(BLOCKCOMPRESSOR_NEON)
+static unsigned FitPalette(const PlanarBlock& block, const Palette palette, int count, unsigned mask, unsigned char* indices) {
+	int32x4_t best[4];
+	int32x4_t bestIndex[4];
+	for (int g = 0; g < 4; g++) {
+		best[g] = vdupq_n_s32(INT_MAX);
+		bestIndex[g] = vdupq_n_s32(0);
+	}
+
+	for (int p = 0; p < count; p++) {
+		int32x4_t index = vdupq_n_s32(p);
+		for (int half = 0; half < 2; half++) {
+			int16x8_t r = vsubq_s16(vld1q_s16(block.channels[0] + half * 8), vdupq_n_s16(palette[p][0]));
+			int16x8_t g = vsubq_s16(vld1q_s16(block.channels[1] + half * 8), vdupq_n_s16(palette[p][1]));
+			int16x8_t b = vsubq_s16(vld1q_s16(block.channels[2] + half * 8), vdupq_n_s16(palette[p][2]));
+			int16x8_t a = vsubq_s16(vld1q_s16(block.channels[3] + half * 8), vdupq_n_s16(palette[p][3]));
+			int32x4_t errors[2];
+			errors[0] = vmull_s16(vget_low_s16(r), vget_low_s16(r));
+			errors[0] = vmlal_s16(errors[0], vget_low_s16(g), vget_low_s16(g));
+			errors[0] = vmlal_s16(errors[0], vget_low_s16(b), vget_low_s16(b));
+			errors[0] = vmlal_s16(errors[0], vget_low_s16(a), vget_low_s16(a));
+			errors[1] = vmull_s16(vget_high_s16(r), vget_high_s16(r));
+			errors[1] = vmlal_s16(errors[1], vget_high_s16(g), vget_high_s16(g));
+			errors[1] = vmlal_s16(errors[1], vget_high_s16(b), vget_high_s16(b));
+			errors[1] = vmlal_s16(errors[1], vget_high_s16(a), vget_high_s16(a));
+			for (int k = 0; k < 2; k++) {
+				int g4 = half * 2 + k;
+				uint32x4_t less = vcltq_s32(errors[k], best[g4]);
+				best[g4] = vbslq_s32(less, errors[k], best[g4]);
+				bestIndex[g4] = vbslq_s32(less, index, bestIndex[g4]);
+			}
+		}
+	}
+
+	static const uint32_t BITS[4] = { 1, 2, 4, 8 };
+	uint32x4_t bits = vld1q_u32(BITS);
+	uint32x4_t selected[4];
+	uint32x4_t total = vdupq_n_u32(0);
+	for (int g = 0; g < 4; g++) {
+		selected[g] = vtstq_u32(vdupq_n_u32(mask >> (g * 4)), bits);
+		total = vaddq_u32(total, vandq_u32(selected[g], vreinterpretq_u32_s32(best[g])));
+	}
+
+	uint8x8_t low = vmovn_u16(vcombine_u16(vmovn_u32(vreinterpretq_u32_s32(bestIndex[0])), vmovn_u32(vreinterpretq_u32_s32(bestIndex[1]))));
+	uint8x8_t high = vmovn_u16(vcombine_u16(vmovn_u32(vreinterpretq_u32_s32(bestIndex[2])), vmovn_u32(vreinterpretq_u32_s32(bestIndex[3]))));
+	uint8x8_t keepLow = vmovn_u16(vcombine_u16(vmovn_u32(selected[0]), vmovn_u32(selected[1])));
+	uint8x8_t keepHigh = vmovn_u16(vcombine_u16(vmovn_u32(selected[2]), vmovn_u32(selected[3])));
+	uint8x16_t previous = vld1q_u8(indices);
+	vst1q_u8(indices, vbslq_u8(vcombine_u8(keepLow, keepHigh), vcombine_u8(low, high), previous));
+	return vgetq_lane_u32(total, 0) + vgetq_lane_u32(total, 1) + vgetq_lane_u32(total, 2) + vgetq_lane_u32(total, 3);
+}
+#else
+static unsigned FitPalette(const PlanarBlock& block, const Palette palette, int count, unsigned mask, unsigned char* indices) {
+	unsigned total = 0;
+	for (int i = 0; i < 16; i++) {
+		if (!(mask & (1u << i))) { continue; }
+		int best = INT_MAX;
+		for (int p = 0; p < count; p++) {
+			int error = 0;
+			for (int c = 0; c < 4; c++) {
+				int difference = block.channels[c][i] - palette[p][c];
+				error += difference * difference;
+			}
+			if (error < best) {
+				best = error;
+				indices[i] = (unsigned char)p;
+			}
+		}
+		total += (unsigned)best;
+	}
+	return total;
+}
+#endif
+
+static void LoadBlock(const unsigned char* pixels, int width, int height, int blockX, int blockY, Texels& texels) {
+	for (int y = 0; y < 4; y++) {
+		const unsigned char* row = pixels + (size_t)std::min(blockY * 4 + y, height - 1) * width * 4;
+		for (int x = 0; x < 4; x++) { memcpy(texels[y * 4 + x], row + (size_t)std::min(blockX * 4 + x, width - 1) * 4, 4); }
+	}
+}
+
+static void StoreBlock(const Texels& texels, int width, int height, int blockX, int blockY, unsigned char* pixels) {
+	int columns = std::min(4, width - blockX * 4);
+	int rows = std::min(4, height - blockY * 4);
+	for (int y = 0; y < rows; y++) {
+		unsigned char* row = pixels + ((size_t)(blockY * 4 + y) * width + blockX * 4) * 4;
+		memcpy(row, texels[y * 4], (size_t)columns * 4);
+	}
+}
+
+static void ToPlanar(const Texels& texels, unsigned channelMask, PlanarBlock& block) {
+	for (int c = 0; c < 4; c++) {
+		bool used = (channelMask >> c) & 1;
+		for (int i = 0; i < 16; i++) { block.channels[c][i] = used ? texels[i][c] : 0; }
+	}
+}
+
+// Ends of the spread of the texels in mask along their principal axis, over count channels starting at first.
+static void FitLine(const Texels& texels, unsigned mask, int first, int count, float* low, float* high) {
+	float mean[4] = {};
+	int texelCount = 0;
+	for (int i = 0; i < 16; i++) {
+		if (!(mask & (1u << i))) { continue; }
+		texelCount++;
+		for (int c = 0; c < count; c++) { mean[c] += texels[i][first + c]; }
+	}
+	if (texelCount == 0) {
+		for (int c = 0; c < count; c++) { low[c] = high[c] = 0.0f; }
+		return;
+	}
+	for (int c = 0; c < count; c++) { mean[c] /= (float)texelCount; }
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; i++) {
+		if (!(mask & (1u << i))) { continue; }
+		float difference[4];
+		for (int c = 0; c < count; c++) { difference[c] = texels[i][first + c] - mean[c]; }
+		for (int a = 0; a < count; a++) {
+			for (int b = 0; b < count; b++) { covariance[a][b] += difference[a] * difference[b]; }
+		}
+	}
+
+	// Power iteration, starting from the column of the widest channel so it is never orthogonal to the answer.
+	int widest = 0;
+	for (int c = 1; c < count; c++) {
+		if (covariance[c][c] > covariance[widest][widest]) { widest = c; }
+	}
+	float axis[4] = {};
+	for (int c = 0; c < count; c++) { axis[c] = covariance[c][widest]; }
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = {};
+		float largest = 0.0f;
+		for (int a = 0; a < count; a++) {
+			for (int b = 0; b < count; b++) { next[a] += covariance[a][b] * axis[b]; }
+			largest = std::max(largest, fabsf(next[a]));
+		}
+		if (largest < 1e-6f) { break; }
+		for (int c = 0; c < count; c++) { axis[c] = next[c] / largest; }
+	}
+	float length = 0.0f;
+	for (int c = 0; c < count; c++) { length += axis[c] * axis[c]; }
+	if (length < 1e-12f) {
+		for (int c = 0; c < count; c++) { low[c] = high[c] = mean[c]; }
+		return;
+	}
+	length = sqrtf(length);
+	for (int c = 0; c < count; c++) { axis[c] /= length; }
+
+	float minimum = 0.0f;
+	float maximum = 0.0f;
+	for (int i = 0; i < 16; i++) {
+		if (!(mask & (1u << i))) { continue; }
+		float t = 0.0f;
+		for (int c = 0; c < count; c++) { t += (texels[i][first + c] - mean[c]) * axis[c]; }
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+	for (int c = 0; c < count; c++) {
+		low[c] = std::min(255.0f, std::max(0.0f, mean[c] + minimum * axis[c]));
+		high[c] = std::min(255.0f, std::max(0.0f, mean[c] + maximum * axis[c]));
+	}
+}
+
+// Least squares endpoints for the texels in mask once their indices are picked, weights[index] being how far from low
+// to high that index sits. False when every texel took the same weight and there is nothing to solve.
+static bool RefineEndpoints(const Texels& texels, unsigned mask, int first, int count, const unsigned char* indices, const float* weights,
+	float* low, float* high) {
+	float aa = 0.0f;
+	float ab = 0.0f;
+	float bb = 0.0f;
+	float ax[4] = {};
+	float bx[4] = {};
+	for (int i = 0; i < 16; i++) {
+		if (!(mask & (1u << i))) { continue; }
+		float b = weights[indices[i]];
+		float a = 1.0f - b;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < count; c++) {
+			ax[c] += a * texels[i][first + c];
+			bx[c] += b * texels[i][first + c];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+	if (determinant < 1e-4f) { return false; }
+	for (int c = 0; c < count; c++) {
+		low[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+		high[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+	}
+	return true;
+}
+
+// BC1
+
+static const SingleColorTables& GetSingleColorTables() {
+	static const SingleColorTables tables = [] {
+		SingleColorTables result;
+		for (int bits = 5; bits <= 6; bits++) {
+			int top = (1 << bits) - 1;
+			for (int value = 0; value < 256; value++) {
+				int bestError = INT_MAX;
+				for (int e0 = 0; e0 <= top; e0++) {
+					for (int e1 = 0; e1 <= top; e1++) {
+						int x0 = bits == 5 ? (e0 << 3) | (e0 >> 2) : (e0 << 2) | (e0 >> 4);
+						int x1 = bits == 5 ? (e1 << 3) | (e1 >> 2) : (e1 << 2) | (e1 >> 4);
+						int error = abs((2 * x0 + x1 + 1) / 3 - value) * 256 + abs(x0 - x1);	// Closer endpoints break ties.
+						if (error >= bestError) { continue; }
+						bestError = error;
+						unsigned char* entry = bits == 5 ? result.five[value] : result.six[value];
+						entry[0] = (unsigned char)e0;
+						entry[1] = (unsigned char)e1;
+					}
+				}
+			}
+		}
+		return result;
+	}();
+	return tables;
+}
+
+static void Expand565(uint16_t color, unsigned char* rgb) {
+	int r = (color >> 11) & 31;
+	int g = (color >> 5) & 63;
+	int b = color & 31;
+	rgb[0] = (unsigned char)((r << 3) | (r >> 2));
+	rgb[1] = (unsigned char)((g << 2) | (g >> 4));
+	rgb[2] = (unsigned char)((b << 3) | (b >> 2));
+}
+
+static uint16_t Quantize565(const float* rgb) {
+	int r = std::min(31, std::max(0, (int)(rgb[0] * (31.0f / 255.0f) + 0.5f)));
+	int g = std::min(63, std::max(0, (int)(rgb[1] * (63.0f / 255.0f) + 0.5f)));
+	int b = std::min(31, std::max(0, (int)(rgb[2] * (31.0f / 255.0f) + 0.5f)));
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// The four colors of a BC1 block. color0 > color1 picks the four color mode, anything else has three colors and
+// transparent black. The color block of BC3 always has four.
+static void GetBc1Palette(uint16_t color0, uint16_t color1, bool fourColors, Palette palette) {
+	Expand565(color0, palette[0]);
+	Expand565(color1, palette[1]);
+	for (int c = 0; c < 3; c++) {
+		if (fourColors || color0 > color1) {
+			palette[2][c] = (unsigned char)((2 * palette[0][c] + palette[1][c] + 1) / 3);
+			palette[3][c] = (unsigned char)((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+		}
+		else {
+			palette[2][c] = (unsigned char)((palette[0][c] + palette[1][c] + 1) / 2);
+			palette[3][c] = 0;
+		}
+	}
+	palette[0][3] = palette[1][3] = palette[2][3] = 255;
+	palette[3][3] = fourColors || color0 > color1 ? 255 : 0;
+}
+
+// Puts the colors in the order of the mode asked for and keeps the fit when it beats result. Equal colors read as three
+// color mode in BC1, whose first entries are that color as well, so they need no special case.
+static void TryBc1(const PlanarBlock& block, unsigned mask, uint16_t color0, uint16_t color1, bool threeColors, bool fourColorsOnly,
+	Bc1Result& result) {
+	if (threeColors == (color0 > color1)) { std::swap(color0, color1); }
+	Palette palette;
+	GetBc1Palette(color0, color1, fourColorsOnly, palette);
+	unsigned char indices[16] = {};
+	unsigned error = FitPalette(block, palette, fourColorsOnly || color0 > color1 ? 4 : 3, mask, indices);
+	if (error >= result.error) { return; }
+	result.error = error;
+	result.color0 = color0;
+	result.color1 = color1;
+	memcpy(result.indices, indices, sizeof(indices));
+}
+
+// Least squares endpoints from the indices of the fit, then for the high preset a search around them.
+static void RefineBc1(const Texels& texels, const PlanarBlock& block, unsigned mask, bool threeColors, bool fourColorsOnly, BlockQuality quality,
+	Bc1Result& result) {
+	float low[4];
+	float high[4];
+
+	const float* weights = threeColors ? BC1_WEIGHTS_3 : BC1_WEIGHTS_4;
+	for (int i = 0; i < 2 && result.error > 0; i++) {
+		if (!RefineEndpoints(texels, mask, 0, 3, result.indices, weights, low, high)) { break; }
+		TryBc1(block, mask, Quantize565(low), Quantize565(high), threeColors, fourColorsOnly, result);
+	}
+	if (quality != BLOCK_QUALITY_HIGH) { return; }
+
+	// Steps every 565 field of both colors by one while that still helps, quantization often lands one off.
+	static const int SHIFTS[3] = { 11, 5, 0 };
+	static const int TOPS[3] = { 31, 63, 31 };
+	for (int round = 0; round < REFINE_ROUNDS && result.error > 0; round++) {
+		unsigned before = result.error;
+		for (int endpoint = 0; endpoint < 2; endpoint++) {
+			for (int field = 0; field < 3; field++) {
+				for (int step = -1; step <= 1; step += 2) {
+					uint16_t colors[2] = { result.color0, result.color1 };
+					int value = ((colors[endpoint] >> SHIFTS[field]) & TOPS[field]) + step;
+					if (value < 0 || value > TOPS[field]) { continue; }
+					colors[endpoint] = (uint16_t)((colors[endpoint] & ~(TOPS[field] << SHIFTS[field])) | (value << SHIFTS[field]));
+					TryBc1(block, mask, colors[0], colors[1], threeColors, fourColorsOnly, result);
+				}
+			}
+		}
+		if (result.error == before) { break; }
+	}
+}
+
+// Fits the texels in mask in one of the two modes and keeps the fit when it beats result.
+static void FitBc1(const Texels& texels, const PlanarBlock& block, unsigned mask, bool threeColors, bool fourColorsOnly, BlockQuality quality,
+	Bc1Result& best) {
+	Bc1Result result;
+	result.error = UINT_MAX;
+	float low[4];
+	float high[4];
+	FitLine(texels, mask, 0, 3, low, high);
+	TryBc1(block, mask, Quantize565(low), Quantize565(high), threeColors, fourColorsOnly, result);
+	if (quality != BLOCK_QUALITY_FAST) { RefineBc1(texels, block, mask, threeColors, fourColorsOnly, quality, result); }
+	if (result.error < best.error) { best = result; }
+}
+
+static void EncodeBc1Block(const Texels& texels, BlockQuality quality, bool fourColorsOnly, unsigned char* output) {
+	// Texels under half alpha can only be kept transparent by the three color mode.
+	unsigned transparent = 0;
+	if (!fourColorsOnly) {
+		for (int i = 0; i < 16; i++) {
+			if (texels[i][3] < 128) { transparent |= 1u << i; }
+		}
+	}
+	unsigned opaque = ~transparent & 0xFFFF;
+
+	Bc1Result result;
+	result.error = UINT_MAX;
+	result.color0 = result.color1 = 0;
+	memset(result.indices, 0, sizeof(result.indices));
+	if (opaque) {
+		PlanarBlock block;
+		ToPlanar(texels, 0x7, block);
+
+		bool singleColor = !transparent;
+		for (int i = 1; i < 16 && singleColor; i++) { singleColor = memcmp(texels[i], texels[0], 3) == 0; }
+		if (singleColor) {
+			// Every color has a pair of endpoints whose 2/3 point lands on it closer than the ends of the fit do.
+			const SingleColorTables& tables = GetSingleColorTables();
+			uint16_t color0 = (uint16_t)((tables.five[texels[0][0]][0] << 11) | (tables.six[texels[0][1]][0] << 5) | tables.five[texels[0][2]][0]);
+			uint16_t color1 = (uint16_t)((tables.five[texels[0][0]][1] << 11) | (tables.six[texels[0][1]][1] << 5) | tables.five[texels[0][2]][1]);
+			TryBc1(block, opaque, color0, color1, false, fourColorsOnly, result);
+		}
+		else {
+			FitBc1(texels, block, opaque, transparent != 0, fourColorsOnly, quality, result);
+			// The three color mode has its midpoint exactly, which some opaque blocks fit better.
+			if (!transparent && !fourColorsOnly && quality == BLOCK_QUALITY_HIGH) { FitBc1(texels, block, opaque, true, false, quality, result); }
+		}
+	}
+	for (int i = 0; i < 16; i++) {
+		if (transparent & (1u << i)) { result.indices[i] = 3; }
+	}
+
+	uint32_t indices = 0;
+	for (int i = 0; i < 16; i++) { indices |= (uint32_t)result.indices[i] << (i * 2); }
+	output[0] = (unsigned char)result.color0;
+	output[1] = (unsigned char)(result.color0 >> 8);
+	output[2] = (unsigned char)result.color1;
+	output[3] = (unsigned char)(result.color1 >> 8);
+	for (int i = 0; i < 4; i++) { output[4 + i] = (unsigned char)(indices >> (i * 8)); }
+}
+
+static void DecodeBc1Block(const unsigned char* input, bool fourColorsOnly, Texels& texels) {
+	Palette palette;
+	GetBc1Palette((uint16_t)(input[0] | input[1] << 8), (uint16_t)(input[2] | input[3] << 8), fourColorsOnly, palette);
+	uint32_t indices = (uint32_t)input[4] | (uint32_t)input[5] << 8 | (uint32_t)input[6] << 16 | (uint32_t)input[7] << 24;
+	for (int i = 0; i < 16; i++) { memcpy(texels[i], palette[(indices >> (i * 2)) & 3], 4); }
+}
+
+// BC4, one channel. endpoint0 > endpoint1 interpolates eight values, otherwise six and the values 0 and 255.
+
+static void GetBc4Palette(int endpoint0, int endpoint1, unsigned char* values) {
+	values[0] = (unsigned char)endpoint0;
+	values[1] = (unsigned char)endpoint1;
+	if (endpoint0 > endpoint1) {
+		for (int i = 2; i < 8; i++) { values[i] = (unsigned char)(((8 - i) * endpoint0 + (i - 1) * endpoint1 + 3) / 7); }
+	}
+	else {
+		for (int i = 2; i < 6; i++) { values[i] = (unsigned char)(((6 - i) * endpoint0 + (i - 1) * endpoint1 + 2) / 5); }
+		values[6] = 0;
+		values[7] = 255;
+	}
+}
+
+static void TryBc4(const PlanarBlock& block, int channel, int endpoint0, int endpoint1, Bc4Result& result) {
+	unsigned char values[8];
+	GetBc4Palette(endpoint0, endpoint1, values);
+	Palette palette = {};
+	for (int i = 0; i < 8; i++) { palette[i][channel] = values[i]; }
+	unsigned char indices[16] = {};
+	unsigned error = FitPalette(block, palette, 8, 0xFFFF, indices);
+	if (error >= result.error) { return; }
+	result.error = error;
+	result.endpoint0 = endpoint0;
+	result.endpoint1 = endpoint1;
+	memcpy(result.indices, indices, sizeof(indices));
+}
+
+static void EncodeBc4Block(const Texels& texels, int channel, BlockQuality quality, unsigned char* output) {
+	int low = 255;
+	int high = 0;
+	int innerLow = 255;	// Leaving out 0 and 255, which the six value mode has for free.
+	int innerHigh = 0;
+	for (int i = 0; i < 16; i++) {
+		int value = texels[i][channel];
+		low = std::min(low, value);
+		high = std::max(high, value);
+		if (value != 0 && value != 255) {
+			innerLow = std::min(innerLow, value);
+			innerHigh = std::max(innerHigh, value);
+		}
+	}
+
+	Bc4Result result;
+	result.error = UINT_MAX;
+	result.endpoint0 = result.endpoint1 = low;
+	memset(result.indices, 0, sizeof(result.indices));
+	if (low != high) {
+		PlanarBlock block;
+		ToPlanar(texels, 1u << channel, block);
+		TryBc4(block, channel, high, low, result);
+
+		if (quality != BLOCK_QUALITY_FAST) {
+			for (int i = 0; i < 2 && result.error > 0 && result.endpoint0 > result.endpoint1; i++) {
+				float refined0;
+				float refined1;
+				if (!RefineEndpoints(texels, 0xFFFF, channel, 1, result.indices, BC4_WEIGHTS, &refined0, &refined1)) { break; }
+				int endpoint0 = (int)(refined0 + 0.5f);
+				int endpoint1 = (int)(refined1 + 0.5f);
+				if (endpoint0 < endpoint1) { std::swap(endpoint0, endpoint1); }
+				if (endpoint0 > endpoint1) { TryBc4(block, channel, endpoint0, endpoint1, result); }
+			}
+			if (low == 0 || high == 255) {
+				if (innerLow > innerHigh) { innerLow = innerHigh = 0; }
+				TryBc4(block, channel, innerLow, innerHigh, result);
+			}
+		}
+		if (quality == BLOCK_QUALITY_HIGH && result.endpoint0 > result.endpoint1) {
+			int center0 = result.endpoint0;
+			int center1 = result.endpoint1;
+			for (int d0 = -2; d0 <= 2; d0++) {
+				for (int d1 = -2; d1 <= 2; d1++) {
+					int endpoint0 = std::min(255, std::max(0, center0 + d0));
+					int endpoint1 = std::min(255, std::max(0, center1 + d1));
+					if (endpoint0 > endpoint1) { TryBc4(block, channel, endpoint0, endpoint1, result); }
+				}
+			}
+		}
+	}
+
+	uint64_t indices = 0;
+	for (int i = 0; i < 16; i++) { indices |= (uint64_t)result.indices[i] << (i * 3); }
+	output[0] = (unsigned char)result.endpoint0;
+	output[1] = (unsigned char)result.endpoint1;
+	for (int i = 0; i < 6; i++) { output[2 + i] = (unsigned char)(indices >> (i * 8)); }
+}
+
+static void DecodeBc4Block(const unsigned char* input, int channel, Texels& texels) {
+	unsigned char values[8];
+	GetBc4Palette(input[0], input[1], values);
+	uint64_t indices = 0;
+	for (int i = 0; i < 6; i++) { indices |= (uint64_t)input[2 + i] << (i * 8); }
+	for (int i = 0; i < 16; i++) { texels[i][channel] = values[(indices >> (i * 3)) & 7]; }
+}
+
+// BC7
+
+static int GetBc7Subset(int subsets, int partition, int texel) {
+	if (subsets == 1) { return 0; }
+	uint32_t pattern = subsets == 2 ? BC7_PARTITIONS_2[partition] : BC7_PARTITIONS_3[partition];
+	return (pattern >> (texel * 2)) & 3;
+}
+
+// Texels of the second subset of every two subset partition, one bit each.
+static const uint16_t* GetBc7SecondSubsetMasks() {
+	static const struct Masks {
+		uint16_t masks[64];
+	} table = [] {
+		Masks result;
+		for (int partition = 0; partition < 64; partition++) {
+			result.masks[partition] = 0;
+			for (int i = 0; i < 16; i++) {
+				if (GetBc7Subset(2, partition, i)) { result.masks[partition] |= (uint16_t)(1u << i); }
+			}
+		}
+		return result;
+	}();
+	return table.masks;
+}
+
+static bool IsBc7Anchor(int subsets, int partition, int texel) {
+	if (texel == 0) { return true; }
+	if (subsets == 2) { return texel == BC7_ANCHORS_2[partition]; }
+	if (subsets == 3) { return texel == BC7_ANCHORS_3[0][partition] || texel == BC7_ANCHORS_3[1][partition]; }
+	return false;
+}
+
+static const unsigned char* GetBc7Weights(int indexBits) {
+	return indexBits == 2 ? BC7_WEIGHTS_2 : indexBits == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4;
+}
+
+static int Bc7Interpolate(int endpoint0, int endpoint1, int weight) {
+	return ((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6;
+}
+
+// A field of precision bits, p-bit included, widened to 8 bits by repeating its top bits.
+static int Unquantize(int value, int precision) {
+	value <<= 8 - precision;
+	return value | (value >> precision);
+}
+
+// The closest field of bits to channels first to first + count - 1 of target, followed by pbit when it is not -1.
+// Returns the squared error of the widened endpoint.
+static float QuantizeBc7Endpoint(const float* target, int first, int count, const Bc7Mode& mode, int pbit, unsigned char* endpoint) {
+	float error = 0.0f;
+	for (int c = first; c < first + count; c++) {
+		int bits = c < 3 ? mode.colorBits : mode.alphaBits;
+		int top = (1 << bits) - 1;
+		int precision = bits + (pbit >= 0 ? 1 : 0);
+		float scaled = target[c] * ((1 << precision) - 1) / 255.0f;
+		int guess = pbit >= 0 ? (int)((scaled - pbit) * 0.5f + 0.5f) : (int)(scaled + 0.5f);
+		float bestError = 1e30f;
+		for (int q = std::max(0, guess - 1); q <= std::min(top, guess + 1); q++) {
+			float difference = Unquantize(pbit >= 0 ? (q << 1) | pbit : q, precision) - target[c];
+			if (difference * difference >= bestError) { continue; }
+			bestError = difference * difference;
+			endpoint[c] = (unsigned char)q;
+		}
+		error += bestError;
+	}
+	return error;
+}
+
+static void QuantizeBc7(const float* low, const float* high, int first, int count, const Bc7Mode& mode, unsigned char endpoints[2][4],
+	unsigned char pbits[2]) {
+	const float* targets[2] = { low, high };
+	if (mode.endpointPBits) {
+		for (int e = 0; e < 2; e++) {
+			unsigned char other[4] = {};
+			float error0 = QuantizeBc7Endpoint(targets[e], first, count, mode, 0, endpoints[e]);
+			float error1 = QuantizeBc7Endpoint(targets[e], first, count, mode, 1, other);
+			pbits[e] = error1 < error0;
+			if (pbits[e]) { memcpy(endpoints[e], other, 4); }
+		}
+	}
+	else if (mode.sharedPBits) {
+		unsigned char other[2][4] = {};
+		float error0 = QuantizeBc7Endpoint(low, first, count, mode, 0, endpoints[0]) + QuantizeBc7Endpoint(high, first, count, mode, 0, endpoints[1]);
+		float error1 = QuantizeBc7Endpoint(low, first, count, mode, 1, other[0]) + QuantizeBc7Endpoint(high, first, count, mode, 1, other[1]);
+		pbits[0] = pbits[1] = error1 < error0;
+		if (pbits[0]) { memcpy(endpoints, other, sizeof(other)); }
+	}
+	else {
+		for (int e = 0; e < 2; e++) {
+			QuantizeBc7Endpoint(targets[e], first, count, mode, -1, endpoints[e]);
+			pbits[e] = 0;
+		}
+	}
+}
+
+// Endpoints as the decoder widens them to 8 bits. Modes without alpha decode it as 255.
+static void UnquantizeBc7(const unsigned char endpoints[2][4], const unsigned char pbits[2], const Bc7Mode& mode, unsigned char widened[2][4]) {
+	bool hasPBit = mode.endpointPBits || mode.sharedPBits;
+	for (int e = 0; e < 2; e++) {
+		for (int c = 0; c < 4; c++) {
+			int bits = c < 3 ? mode.colorBits : mode.alphaBits;
+			if (bits == 0) {
+				widened[e][c] = 255;
+				continue;
+			}
+			int value = hasPBit ? (endpoints[e][c] << 1) | pbits[e] : endpoints[e][c];
+			widened[e][c] = (unsigned char)Unquantize(value, bits + (hasPBit ? 1 : 0));
+		}
+	}
+}
+
+// Fits channels first to first + count - 1 of the texels in mask as one subset, and returns their squared error. block
+// holds just those channels. Endpoints come back quantized to the mode's bits, the other channels left as they were,
+// and the anchor texel's index with its top bit clear as the format stores it one bit short.
+static unsigned EncodeBc7Subset(const Texels& texels, const PlanarBlock& block, unsigned mask, int anchor, const Bc7Mode& mode, int first, int count,
+	int indexBits, int iterations, unsigned char endpoints[2][4], unsigned char pbits[2], unsigned char* indices) {
+	int entries = 1 << indexBits;
+	const unsigned char* weights = GetBc7Weights(indexBits);
+	float refineWeights[16];
+	for (int i = 0; i < entries; i++) { refineWeights[i] = weights[i] / 64.0f; }
+
+	float low[4] = {};
+	float high[4] = {};
+	FitLine(texels, mask, first, count, low + first, high + first);
+	unsigned bestError = UINT_MAX;
+	unsigned char fitted[16];
+	memcpy(fitted, indices, sizeof(fitted));
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		unsigned char quantized[2][4] = {};
+		unsigned char quantizedPBits[2];
+		QuantizeBc7(low, high, first, count, mode, quantized, quantizedPBits);
+		unsigned char widened[2][4];
+		UnquantizeBc7(quantized, quantizedPBits, mode, widened);
+		Palette palette = {};
+		for (int i = 0; i < entries; i++) {
+			for (int c = first; c < first + count; c++) { palette[i][c] = (unsigned char)Bc7Interpolate(widened[0][c], widened[1][c], weights[i]); }
+		}
+
+		unsigned error = FitPalette(block, palette, entries, mask, fitted);
+		if (error < bestError) {
+			bestError = error;
+			for (int e = 0; e < 2; e++) {
+				for (int c = first; c < first + count; c++) { endpoints[e][c] = quantized[e][c]; }
+				pbits[e] = quantizedPBits[e];
+			}
+			for (int i = 0; i < 16; i++) {
+				if (mask & (1u << i)) { indices[i] = fitted[i]; }
+			}
+		}
+		if (error == 0 || !RefineEndpoints(texels, mask, first, count, fitted, refineWeights, low + first, high + first)) { break; }
+	}
+
+	// The weights are symmetric, so swapping the endpoints and mirroring the indices decodes to the same texels.
+	if (indices[anchor] >= entries / 2) {
+		for (int c = first; c < first + count; c++) { std::swap(endpoints[0][c], endpoints[1][c]); }
+		std::swap(pbits[0], pbits[1]);
+		for (int i = 0; i < 16; i++) {
+			if (mask & (1u << i)) { indices[i] = (unsigned char)(entries - 1 - indices[i]); }
+		}
+	}
+	return bestError;
+}
+
+// Scatter of the texels around the best line through them, for ranking partitions without fitting them. The spread
+// along the line is the Rayleigh quotient of one power step from the widest channel, close enough to rank by.
+static float GetLineResidual(float count, const float* sum, const float* products) {
+	if (count == 0.0f) { return 0.0f; }
+	float scatter[3][3];
+	int k = 0;
+	for (int a = 0; a < 3; a++) {
+		for (int b = a; b < 3; b++, k++) { scatter[a][b] = scatter[b][a] = products[k] - sum[a] * sum[b] / count; }
+	}
+	float trace = scatter[0][0] + scatter[1][1] + scatter[2][2];
+	int widest = scatter[1][1] > scatter[0][0] ? 1 : 0;
+	if (scatter[2][2] > scatter[widest][widest]) { widest = 2; }
+
+	float axis[3] = { scatter[0][widest], scatter[1][widest], scatter[2][widest] };
+	float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	if (length < 1e-6f) { return trace; }
+	float along = 0.0f;
+	for (int a = 0; a < 3; a++) { along += axis[a] * (scatter[a][0] * axis[0] + scatter[a][1] * axis[1] + scatter[a][2] * axis[2]); }
+	return trace - along / length;
+}
+
+// The count two subset partitions whose subsets lie closest to a line in RGB, best first.
+static void SelectBc7Partitions(const Texels& texels, int count, int* partitions) {
+	// Sums are exact in integers, so the first subset is just the whole block minus the second.
+	int moments[16][12] = {};	// r, g, b, then the products rr, rg, rb, gg, gb, bb. Padded for the vector units.
+	int total[12] = {};
+	for (int i = 0; i < 16; i++) {
+		int r = texels[i][0];
+		int g = texels[i][1];
+		int b = texels[i][2];
+		int texel[9] = { r, g, b, r * r, r * g, r * b, g * g, g * b, b * b };
+		for (int k = 0; k < 9; k++) { moments[i][k] = texel[k]; }
+		for (int k = 0; k < 12; k++) { total[k] += moments[i][k]; }
+	}
+
+	const uint16_t* masks = GetBc7SecondSubsetMasks();
+	float residuals[64];
+	for (int partition = 0; partition < 64; partition++) {
+		int second[12] = {};
+		int secondCount = 0;
+		for (unsigned mask = masks[partition]; mask; mask &= mask - 1) {
+			const int* texel = moments[CountTrailingZeros(mask)];
+			secondCount++;
+			for (int k = 0; k < 12; k++) { second[k] += texel[k]; }
+		}
+		float first[9];
+		float secondSums[9];
+		for (int k = 0; k < 9; k++) {
+			first[k] = (float)(total[k] - second[k]);
+			secondSums[k] = (float)second[k];
+		}
+		residuals[partition] = GetLineResidual((float)(16 - secondCount), first, first + 3) + GetLineResidual((float)secondCount, secondSums, secondSums + 3);
+	}
+
+	int order[64];
+	for (int i = 0; i < 64; i++) { order[i] = i; }
+	std::partial_sort(order, order + count, order + 64, [&](int a, int b) { return residuals[a] < residuals[b]; });
+	memcpy(partitions, order, sizeof(int) * count);
+}
+
+static void WriteBc7(const Bc7Result& result, unsigned char* output) {
+	const Bc7Mode& mode = BC7_MODES[result.mode];
+	memset(output, 0, 16);
+	BitWriter writer = { output, 0 };
+	writer.Write(1u << result.mode, result.mode + 1);
+	writer.Write(result.partition, mode.partitionBits);
+	writer.Write(result.rotation, mode.rotationBits);
+	writer.Write(0, mode.indexSelectionBits);	// Mode 4 is never written.
+	for (int c = 0; c < 3; c++) {
+		for (int s = 0; s < mode.subsets; s++) {
+			for (int e = 0; e < 2; e++) { writer.Write(result.endpoints[s][e][c], mode.colorBits); }
+		}
+	}
+	for (int s = 0; s < mode.subsets && mode.alphaBits; s++) {
+		for (int e = 0; e < 2; e++) { writer.Write(result.endpoints[s][e][3], mode.alphaBits); }
+	}
+	for (int s = 0; s < mode.subsets; s++) {
+		if (mode.endpointPBits) {
+			writer.Write(result.pbits[s][0], 1);
+			writer.Write(result.pbits[s][1], 1);
+		}
+		if (mode.sharedPBits) { writer.Write(result.pbits[s][0], 1); }
+	}
+	for (int i = 0; i < 16; i++) { writer.Write(result.indices[i], mode.indexBits - (IsBc7Anchor(mode.subsets, result.partition, i) ? 1 : 0)); }
+	for (int i = 0; i < 16 && mode.secondaryIndexBits; i++) { writer.Write(result.secondaryIndices[i], mode.secondaryIndexBits - (i == 0 ? 1 : 0)); }
+}
+
+// Mode 5 gives alpha its own endpoints and indices. Rotation swaps alpha with one of the colors first, so whichever
+// channel varies on its own gets them.
+static void EncodeBc7Mode5(const Texels& texels, int rotation, int iterations, Bc7Result& best) {
+	Texels rotated;
+	memcpy(rotated, texels, sizeof(Texels));
+	if (rotation) {
+		for (int i = 0; i < 16; i++) { std::swap(rotated[i][3], rotated[i][rotation - 1]); }
+	}
+	PlanarBlock color;
+	PlanarBlock alpha;
+	ToPlanar(rotated, 0x7, color);
+	ToPlanar(rotated, 0x8, alpha);
+
+	const Bc7Mode& mode = BC7_MODES[5];
+	Bc7Result candidate = {};
+	candidate.mode = 5;
+	candidate.rotation = rotation;
+	candidate.error = EncodeBc7Subset(rotated, color, 0xFFFF, 0, mode, 0, 3, mode.indexBits, iterations, candidate.endpoints[0], candidate.pbits[0],
+		candidate.indices);
+	if (candidate.error >= best.error) { return; }
+	candidate.error += EncodeBc7Subset(rotated, alpha, 0xFFFF, 0, mode, 3, 1, mode.secondaryIndexBits, iterations, candidate.endpoints[0],
+		candidate.pbits[0], candidate.secondaryIndices);
+	if (candidate.error < best.error) { best = candidate; }
+}
+
+static void EncodeBc7Block(const Texels& texels, BlockQuality quality, unsigned char* output) {
+	PlanarBlock block;
+	ToPlanar(texels, 0xF, block);
+	int iterations = quality == BLOCK_QUALITY_FAST ? 1 : quality == BLOCK_QUALITY_NORMAL ? 3 : 6;
+	bool opaque = true;
+	for (int i = 0; i < 16 && opaque; i++) { opaque = texels[i][3] == 255; }
+
+	// Mode 6 has one subset of RGBA with 4-bit indices, the best single fit the format has.
+	const Bc7Mode& mode6 = BC7_MODES[6];
+	Bc7Result best = {};
+	best.mode = 6;
+	best.error = EncodeBc7Subset(texels, block, 0xFFFF, 0, mode6, 0, 4, mode6.indexBits, iterations, best.endpoints[0], best.pbits[0], best.indices);
+
+	// Alpha that does not follow the color, cut-outs above all, fits one line badly.
+	if (!opaque && best.error > 0) {
+		for (int rotation = 0; rotation < (quality == BLOCK_QUALITY_HIGH ? 4 : 1); rotation++) { EncodeBc7Mode5(texels, rotation, iterations, best); }
+	}
+
+	// Opaque blocks with two clusters of color do better split in two, mode 1 is the one with the most color bits.
+	if (opaque && quality != BLOCK_QUALITY_FAST && best.error > 0) {
+		const Bc7Mode& mode1 = BC7_MODES[1];
+		PlanarBlock color;
+		ToPlanar(texels, 0x7, color);
+		int partitions[8];
+		int partitionCount = quality == BLOCK_QUALITY_HIGH ? 8 : 2;
+		SelectBc7Partitions(texels, partitionCount, partitions);
+		for (int k = 0; k < partitionCount; k++) {
+			Bc7Result candidate = {};
+			candidate.mode = 1;
+			candidate.partition = partitions[k];
+			unsigned second = GetBc7SecondSubsetMasks()[candidate.partition];
+			candidate.error = EncodeBc7Subset(texels, color, ~second & 0xFFFF, 0, mode1, 0, 3, mode1.indexBits, iterations, candidate.endpoints[0],
+				candidate.pbits[0], candidate.indices);
+			if (candidate.error >= best.error) { continue; }
+			candidate.error += EncodeBc7Subset(texels, color, second, BC7_ANCHORS_2[candidate.partition], mode1, 0, 3, mode1.indexBits, iterations,
+				candidate.endpoints[1], candidate.pbits[1], candidate.indices);
+			if (candidate.error < best.error) { best = candidate; }
+		}
+	}
+	WriteBc7(best, output);
+}
+
+static void DecodeBc7Block(const unsigned char* input, Texels& texels) {
+	BitReader reader = { input, 0 };
+	int modeIndex = 0;
+	while (modeIndex < 8 && reader.Read(1) == 0) { modeIndex++; }
+	if (modeIndex == 8) {
+		memset(texels, 0, sizeof(Texels));	// Reserved, decodes as transparent black.
+		return;
+	}
+	const Bc7Mode& mode = BC7_MODES[modeIndex];
+	int partition = (int)reader.Read(mode.partitionBits);
+	int rotation = (int)reader.Read(mode.rotationBits);
+	int indexSelection = (int)reader.Read(mode.indexSelectionBits);
+
+	unsigned char endpoints[3][2][4] = {};
+	unsigned char pbits[3][2] = {};
+	for (int c = 0; c < 3; c++) {
+		for (int s = 0; s < mode.subsets; s++) {
+			for (int e = 0; e < 2; e++) { endpoints[s][e][c] = (unsigned char)reader.Read(mode.colorBits); }
+		}
+	}
+	for (int s = 0; s < mode.subsets && mode.alphaBits; s++) {
+		for (int e = 0; e < 2; e++) { endpoints[s][e][3] = (unsigned char)reader.Read(mode.alphaBits); }
+	}
+	for (int s = 0; s < mode.subsets; s++) {
+		if (mode.endpointPBits) {
+			pbits[s][0] = (unsigned char)reader.Read(1);
+			pbits[s][1] = (unsigned char)reader.Read(1);
+		}
+		if (mode.sharedPBits) { pbits[s][0] = pbits[s][1] = (unsigned char)reader.Read(1); }
+	}
+	unsigned char widened[3][2][4];
+	for (int s = 0; s < mode.subsets; s++) { UnquantizeBc7(endpoints[s], pbits[s], mode, widened[s]); }
+
+	unsigned char indices[16];
+	unsigned char secondaryIndices[16] = {};
+	for (int i = 0; i < 16; i++) { indices[i] = (unsigned char)reader.Read(mode.indexBits - (IsBc7Anchor(mode.subsets, partition, i) ? 1 : 0)); }
+	for (int i = 0; i < 16 && mode.secondaryIndexBits; i++) { secondaryIndices[i] = (unsigned char)reader.Read(mode.secondaryIndexBits - (i == 0 ? 1 : 0)); }
+
+	// Modes 4 and 5 interpolate color and alpha with separate indices, the index selection bit swaps which set is which.
+	const unsigned char* colorWeights = GetBc7Weights(mode.indexBits);
+	const unsigned char* alphaWeights = colorWeights;
+	const unsigned char* colorIndices = indices;
+	const unsigned char* alphaIndices = indices;
+	if (mode.secondaryIndexBits) {
+		alphaWeights = GetBc7Weights(mode.secondaryIndexBits);
+		alphaIndices = secondaryIndices;
+		if (indexSelection) {
+			std::swap(colorWeights, alphaWeights);
+			std::swap(colorIndices, alphaIndices);
+		}
+	}
+	for (int i = 0; i < 16; i++) {
+		const unsigned char (*pair)[4] = widened[GetBc7Subset(mode.subsets, partition, i)];
+		for (int c = 0; c < 3; c++) { texels[i][c] = (unsigned char)Bc7Interpolate(pair[0][c], pair[1][c], colorWeights[colorIndices[i]]); }
+		texels[i][3] = (unsigned char)Bc7Interpolate(pair[0][3], pair[1][3], alphaWeights[alphaIndices[i]]);
+		if (rotation) { std::swap(texels[i][3], texels[i][rotation - 1]); }
+	}
+}
+
+size_t BlockCompressorClass::GetBlockSize(BlockFormat format) {
+	return format == BLOCK_FORMAT_BC1 ? 8 : 16;
+}
+
+size_t BlockCompressorClass::GetRowPitch(BlockFormat format, int width) {
+	return (size_t)((width + 3) / 4) * GetBlockSize(format);
+}
+
+size_t BlockCompressorClass::GetLevelSize(BlockFormat format, int width, int height) {
+	return GetRowPitch(format, width) * (size_t)((height + 3) / 4);
+}
+
+void BlockCompressorClass::Encode(const unsigned char* pixels, int width, int height, unsigned char* blocks, BlockFormat format,
+	BlockQuality quality, ThreadPoolClass* pool) {
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	size_t blockSize = GetBlockSize(format);
+	size_t bands = (size_t)(blocksHigh + BAND_BLOCKS - 1) / BAND_BLOCKS;
+	auto band = [&](size_t index) {
+		int first = (int)index * BAND_BLOCKS;
+		int last = std::min(first + BAND_BLOCKS, blocksHigh);
+		for (int y = first; y < last; y++) {
+			unsigned char* output = blocks + (size_t)y * blocksWide * blockSize;
+			for (int x = 0; x < blocksWide; x++, output += blockSize) {
+				Texels texels;
+				LoadBlock(pixels, width, height, x, y, texels);
+				switch (format) {
+				case BLOCK_FORMAT_BC1:
+					EncodeBc1Block(texels, quality, false, output);
+					break;
+				case BLOCK_FORMAT_BC3:
+					EncodeBc4Block(texels, 3, quality, output);
+					EncodeBc1Block(texels, quality, true, output + 8);
+					break;
+				case BLOCK_FORMAT_BC5:
+					EncodeBc4Block(texels, 0, quality, output);
+					EncodeBc4Block(texels, 1, quality, output + 8);
+					break;
+				case BLOCK_FORMAT_BC7:
+					EncodeBc7Block(texels, quality, output);
+					break;
+				}
+			}
+		}
+	};
+
+	if (pool && bands > 1) { pool->ParallelFor(bands, band); }
+	else {
+		for (size_t i = 0; i < bands; i++) { band(i); }
+	}
+}
+
+void BlockCompressorClass::Decode(const unsigned char* blocks, int width, int height, unsigned char* pixels, BlockFormat format) {
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	size_t blockSize = GetBlockSize(format);
+	for (int y = 0; y < blocksHigh; y++) {
+		for (int x = 0; x < blocksWide; x++, blocks += blockSize) {
+			Texels texels;
+			switch (format) {
+			case BLOCK_FORMAT_BC1:
+				DecodeBc1Block(blocks, false, texels);
+				break;
+			case BLOCK_FORMAT_BC3:
+				DecodeBc1Block(blocks + 8, true, texels);
+				DecodeBc4Block(blocks, 3, texels);
+				break;
+			case BLOCK_FORMAT_BC5:
+				for (int i = 0; i < 16; i++) {
+					texels[i][2] = 0;
+					texels[i][3] = 255;
+				}
+				DecodeBc4Block(blocks, 0, texels);
+				DecodeBc4Block(blocks + 8, 1, texels);
+				break;
+			case BLOCK_FORMAT_BC7:
+				DecodeBc7Block(blocks, texels);
+				break;
+			}
+			StoreBlock(texels, width, height, x, y, pixels);
+		}
+	}
+}
+
+double BlockCompressorClass::GetPsnr(const unsigned char* a, const unsigned char* b, int width, int height, int channels) {
+	size_t texels = (size_t)width * height;
+	double sum = 0.0;
+	for (size_t i = 0; i < texels; i++, a += 4, b += 4) {
+		for (int c = 0; c < channels; c++) {
+			double difference = (double)a[c] - b[c];
+			sum += difference * difference;
+		}
+	}
+	if (sum == 0.0) { return INFINITY; }
+	double meanSquare = sum / ((double)texels * channels);
+	return 10.0 * log10(255.0 * 255.0 / meanSquare);
+}
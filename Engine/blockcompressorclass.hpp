@@ -0,0 +1,36 @@
+#pragma once
+#include <stddef.h>
+#include "threadpoolclass.hpp"
+
+enum BlockFormat {
+	BLOCK_FORMAT_BC1,	// RGB with 1-bit alpha, 8 bytes a block.
+	BLOCK_FORMAT_BC3,	// BC1 color and a BC4 block for smooth alpha, 16 bytes.
+	BLOCK_FORMAT_BC5,	// Red and green as two BC4 blocks, for normal maps. 16 bytes.
+	BLOCK_FORMAT_BC7,	// RGBA at the best quality of the four, 16 bytes.
+};
+
+enum BlockQuality {
+	BLOCK_QUALITY_FAST,		// One fit along the principal axis. BC7 only uses mode 6.
+	BLOCK_QUALITY_NORMAL,	// Least squares refinement, BC7 tries the two best partitions of mode 1 on opaque blocks.
+	BLOCK_QUALITY_HIGH,		// Endpoint search around the refined fit, eight BC7 partitions.
+};
+
+// Compresses RGBA8 images into 4x4 blocks of the BCn formats on the CPU, and decodes them again to measure what was
+// lost. Rows of blocks are split into bands that run in parallel when a pool is given. Edge blocks of images that are
+// not a multiple of 4 repeat the last row and column.
+class BlockCompressorClass {
+public:
+	static constexpr int BAND_BLOCKS = 8;	// Rows of blocks per job.
+
+	static size_t GetBlockSize(BlockFormat format);
+	static size_t GetRowPitch(BlockFormat format, int width);
+	static size_t GetLevelSize(BlockFormat format, int width, int height);
+
+	// pixels has width * 4 bytes a row, blocks has room for GetLevelSize bytes.
+	static void Encode(const unsigned char* pixels, int width, int height, unsigned char* blocks, BlockFormat format, BlockQuality quality,
+		ThreadPoolClass* pool = 0);
+	// Back to RGBA8. BC5 comes back with blue 0 and alpha 255.
+	static void Decode(const unsigned char* blocks, int width, int height, unsigned char* pixels, BlockFormat format);
+	// Over the first channels of every texel, infinite when the images are the same.
+	static double GetPsnr(const unsigned char* a, const unsigned char* b, int width, int height, int channels);
+};
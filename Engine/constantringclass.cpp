@@ -0,0 +1,64 @@
+#include "constantringclass.hpp"
+#include <string.h>
+
+ConstantRingClass::ConstantRingClass(ID3D11Device* device, ID3D11DeviceContext* context, UINT size) : m_context(context) {
+	m_offsetting = SupportsOffsetting(device);
+	// Without offsets one allocation at a time is all the buffer ever holds.
+	m_size = m_offsetting ? (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT : MAX_ALLOCATION;
+	if (m_size < MAX_ALLOCATION) { m_size = MAX_ALLOCATION; }
+
+	D3D11_BUFFER_DESC bufferDesc{};
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = m_size;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	HRESULT result = device->CreateBuffer(&bufferDesc, NULL, &m_buffer);
+	isInitialized = !FAILED(result);
+}
+
+ConstantRingClass::~ConstantRingClass() {
+	if (m_buffer) {
+		m_buffer->Release();
+		m_buffer = 0;
+	}
+}
+
+bool ConstantRingClass::SupportsOffsetting(ID3D11Device* device) {
+	// The 11.0 runtime does not know the query and fails it. Offsets also need no-overwrite maps on constant buffers,
+	// which the 11.1 runtime reports separately.
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	HRESULT result = device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+	return !FAILED(result) && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+}
+
+bool ConstantRingClass::Write(const void* data, UINT size, ConstantAllocation& allocation) {
+	UINT alignedSize = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	if (size == 0 || alignedSize > MAX_ALLOCATION) { return false; }
+
+	D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (!m_offsetting || m_head == 0 || m_head + alignedSize > m_size) {
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		m_head = 0;
+		m_stats.wraps++;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	HRESULT result = m_context->Map(m_buffer, 0, mapType, 0, &mappedResource);
+	if (FAILED(result)) {
+		m_head = 0;	// Whatever was mapped before is unknown now, start over with a discard.
+		return false;
+	}
+	memcpy((unsigned char*)mappedResource.pData + m_head, data, size);
+	m_context->Unmap(m_buffer, 0);
+
+	allocation.buffer = m_buffer;
+	allocation.firstConstant = m_offsetting ? m_head / ConstantLayout::REGISTER_SIZE : 0;
+	allocation.constantCount = m_offsetting ? alignedSize / ConstantLayout::REGISTER_SIZE : 0;
+	m_head += alignedSize;
+	m_stats.allocations++;
+	m_stats.bytes += alignedSize;
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <d3d11_1.h>
+#include <stddef.h>
+
+// HLSL packs cbuffer members into 16 byte registers: a member never straddles two of them, and matrices, arrays and
+// structs start a new one. The C++ mirrors of the cbuffers walk their members through this in a static_assert, so a
+// member that lands somewhere else than the shader reads it fails the build instead of the picture.
+class ConstantLayout {
+public:
+	static constexpr UINT REGISTER_SIZE = 16;
+
+	// The offset of the next member.
+	constexpr UINT Add(UINT size, bool startsRegister = false) {
+		UINT used = end % REGISTER_SIZE;
+		if (used != 0 && (startsRegister || used + size > REGISTER_SIZE)) { end += REGISTER_SIZE - used; }
+		UINT offset = end;
+		end += size;
+		return offset;
+	}
+	// Of the whole cbuffer, which is always whole registers.
+	constexpr UINT Size() const { return (end + REGISTER_SIZE - 1) / REGISTER_SIZE * REGISTER_SIZE; }
+
+private:
+	UINT end = 0;
+};
+
+struct ConstantAllocation {
+	ID3D11Buffer* buffer = 0;
+	UINT firstConstant = 0;	// In 16 byte constants.
+	UINT constantCount = 0;	// 0 binds the whole buffer.
+};
+
+struct ConstantRingStats {
+	size_t allocations = 0;
+	size_t wraps = 0;	// Maps that discarded the buffer.
+	size_t bytes = 0;	// Including the alignment.
+};
+
+// Suballocates the constants that change with every draw from one large dynamic buffer, bound with the D3D 11.1
+// constant buffer offsets. Allocations follow each other with no-overwrite maps and, once the end is reached, the
+// buffer is discarded and filled from the start again, so the driver keeps the old contents alive for the draws the
+// GPU has not run yet and no fence is needed. Without offsetting every allocation discards a small buffer and binds
+// all of it, which is how the shaders used to update, only the last allocation stays valid then, so every draw has to
+// take its own. Main thread only.
+class ConstantRingClass {
+public:
+	static constexpr UINT ALIGNMENT = 256;	// Offsets and sizes are whole multiples of 16 constants.
+	static constexpr UINT MAX_ALLOCATION = 4096;
+
+	ConstantRingClass(ID3D11Device* device, ID3D11DeviceContext* context, UINT size);
+	ConstantRingClass(const ConstantRingClass&) = delete;
+	~ConstantRingClass();
+
+	// Copies the constants into the ring, false when they are too large or the buffer could not be mapped.
+	bool Write(const void* data, UINT size, ConstantAllocation& allocation);
+	template <class T> bool Write(const T& data, ConstantAllocation& allocation) { return Write(&data, sizeof(T), allocation); }
+
+	bool IsOffsetting() const { return m_offsetting; }
+	const ConstantRingStats& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = ConstantRingStats(); }
+
+	bool isInitialized = false;
+private:
+	static bool SupportsOffsetting(ID3D11Device* device);
+
+	ID3D11DeviceContext* m_context = 0;
+	ID3D11Buffer* m_buffer = 0;
+	UINT m_size = 0;
+	UINT m_head = 0;	// Where the next allocation goes, 0 discards first.
+	bool m_offsetting = false;
+	ConstantRingStats m_stats;
+};
@@ -4,20 +4,24 @@ D3DClass::D3DClass(int screenWidth, int screenHeight, bool vsync, HWND hwnd, boo
 	vsync_enabled = vsync;
 	bool success = CreateSwapChainDesc(screenWidth, screenHeight, hwnd, fullscreen);
 	if (!success) { return; }
+	renderState = new RenderStateClass(deviceContext);
+	stateObjects = new StateObjectCacheClass(device);
+	constantRing = new ConstantRingClass(device, deviceContext, CONSTANT_RING_SIZE);
+	if (!constantRing->isInitialized) { return; }
 
 	success = CreateRenderTargetView();
 	if (!success) { return; }
 
 	success = CreateBuffers(screenWidth, screenHeight);
 	if (!success) { return; }
-	deviceContext->OMSetRenderTargets(1, &renderTargetView, depthStencilView);	// Bind the render target view and depth stencil buffer to the output render pipeline.
+	renderState->SetRenderTarget(renderTargetView, depthStencilView);	// Bind the render target view and depth stencil buffer to the output render pipeline.
 
 	success = CreateRaster();
 	if (!success) { return; }
-	deviceContext->RSSetState(rasterState);
+	renderState->SetRasterizerState(rasterState);
 
 	SetViewport((float)screenWidth, (float)screenHeight);
-	deviceContext->RSSetViewports(1, &viewport);
+	renderState->SetViewport(viewport);
 
 	SetProjectionMatrix((float)screenWidth, (float)screenHeight, screenDepth, screenNear);
 
@@ -138,7 +142,7 @@ bool D3DClass::CreateBuffers(int screenWidth, int screenHeight) {
 	if (!success) { return false; }
 	success = CreateDepthStencil();
 	if (!success) { return false; }
-	deviceContext->OMSetDepthStencilState(depthStencilState, 1);
+	renderState->SetDepthStencilState(depthStencilState, 1);
 
 	success = CreateDepthStencilView();
 	return success;
@@ -182,8 +186,8 @@ bool D3DClass::CreateDepthStencil() {
 	depthStencilDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 	depthStencilDesc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
 
-	auto result = device->CreateDepthStencilState(&depthStencilDesc, &depthStencilState);
-	return !FAILED(result);
+	depthStencilState = stateObjects->GetDepthStencilState(depthStencilDesc);
+	return depthStencilState != 0;
 }
 
 bool D3DClass::CreateDepthStencilView() {
@@ -212,8 +216,8 @@ bool D3DClass::CreateRaster() {
 	rasterDesc.ScissorEnable = false;
 	rasterDesc.SlopeScaledDepthBias = 0.0f;
 
-	auto result = device->CreateRasterizerState(&rasterDesc, &rasterState);
-	return !FAILED(result);
+	rasterState = stateObjects->GetRasterizerState(rasterDesc);
+	return rasterState != 0;
 }
 
 void D3DClass::SetViewport(float screenWidth, float screenHeight) {
@@ -227,10 +231,9 @@ void D3DClass::SetViewport(float screenWidth, float screenHeight) {
 }
 
 void D3DClass::SetProjectionMatrix(float screenWidth, float screenHeight, float screenDepth, float screenNear) {
-	float fieldOfView = PI / 4.0f;
 	float screenAspect = screenWidth / screenHeight;
 
-	projectionMatrix = XMMatrixPerspectiveFovLH(fieldOfView, screenAspect, screenNear, screenDepth);
+	projectionMatrix = XMMatrixPerspectiveFovLH(FIELD_OF_VIEW, screenAspect, screenNear, screenDepth);
 	orthoMatrix = XMMatrixOrthographicLH((float)screenWidth, (float)screenHeight, screenNear, screenDepth);
 }
 
@@ -248,24 +251,12 @@ D3DClass::~D3DClass()
 		swapChain->SetFullscreenState(false, NULL);
 	}
 
-	if (rasterState)
-	{
-		rasterState->Release();
-		rasterState = 0;
-	}
-
 	if (depthStencilView)
 	{
 		depthStencilView->Release();
 		depthStencilView = 0;
 	}
 
-	if (depthStencilState)
-	{
-		depthStencilState->Release();
-		depthStencilState = 0;
-	}
-
 	if (depthStencilBuffer)
 	{
 		depthStencilBuffer->Release();
@@ -278,6 +269,25 @@ D3DClass::~D3DClass()
 		renderTargetView = 0;
 	}
 
+	// Before the device and context they were made for.
+	if (renderState)
+	{
+		delete renderState;
+		renderState = 0;
+	}
+
+	if (stateObjects)
+	{
+		delete stateObjects;
+		stateObjects = 0;
+	}
+
+	if (constantRing)
+	{
+		delete constantRing;
+		constantRing = 0;
+	}
+
 	if (deviceContext)
 	{
 		deviceContext->Release();
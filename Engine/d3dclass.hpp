@@ -7,9 +7,14 @@
 #include <d3d11.h>
 #include <directxmath.h>
 #include <string>
+#include "renderstateclass.hpp"
+#include "stateobjectcacheclass.hpp"
+#include "constantringclass.hpp"
 using namespace DirectX;
 
 static constexpr float PI = 3.141592654f;
+static constexpr float FIELD_OF_VIEW = PI / 4.0f;	// Vertical, in radians.
+static constexpr UINT CONSTANT_RING_SIZE = 4u << 20;	// A frame and a half of 10000 objects, at 256 bytes each.
 struct RefreshRate {
     unsigned int numerator = 0;
     unsigned int denominator = 0;
@@ -33,14 +38,18 @@ public:
 
     ID3D11Device* GetDevice() { return device; }
     ID3D11DeviceContext* GetDeviceContext() { return deviceContext; }
+    RenderStateClass& GetRenderState() { return *renderState; }	// For every bind, see RenderStateClass.
+    StateObjectCacheClass& GetStateObjects() { return *stateObjects; }
+    ConstantRingClass& GetConstantRing() { return *constantRing; }	// For the per object constants.
     XMMATRIX GetProjectionMatrix() const { return projectionMatrix; }
     XMMATRIX GetWorldMatrix() const { return worldMatrix; }
     XMMATRIX GetOrthoMatrix() const { return orthoMatrix; }
+    float GetViewportHeight() const { return viewport.Height; }
 
     void GetVideoCardInfo(char* cardName, int& memory) const;
 
-    void SetBackBufferRenderTarget() { deviceContext->OMSetRenderTargets(1, &renderTargetView, depthStencilView); }
-    void ResetViewport() { deviceContext->RSSetViewports(1, &viewport); }
+    void SetBackBufferRenderTarget() { renderState->SetRenderTarget(renderTargetView, depthStencilView); }
+    void ResetViewport() { renderState->SetViewport(viewport); }
 
 private:
     bool vsync_enabled = false;
@@ -49,9 +58,12 @@ private:
     IDXGISwapChain* swapChain{};
     ID3D11Device* device{};
     ID3D11DeviceContext* deviceContext{};
+    RenderStateClass* renderState{};
+    StateObjectCacheClass* stateObjects{};
+    ConstantRingClass* constantRing{};
     ID3D11RenderTargetView* renderTargetView{};
     ID3D11Texture2D* depthStencilBuffer{};
-    ID3D11DepthStencilState* depthStencilState{};
+    ID3D11DepthStencilState* depthStencilState{};	// Owned by stateObjects, as is rasterState.
     ID3D11DepthStencilView* depthStencilView{};
     ID3D11RasterizerState* rasterState{};
     XMMATRIX projectionMatrix{};
@@ -0,0 +1,62 @@
+#include "dependencygraphclass.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+void DependencyGraphClass::SetDependencies(uint32_t asset, const std::vector<AssetPath>& files) {
+	Remove(asset);
+	std::vector<AssetPath>& list = m_files[asset];
+	for (AssetPath file : files) {
+		if (!file.IsValid() || std::find(list.begin(), list.end(), file) != list.end()) { continue; }
+		list.push_back(file);
+		m_dependents[file.id].push_back(asset);
+	}
+}
+
+void DependencyGraphClass::Remove(uint32_t asset) {
+	auto found = m_files.find(asset);
+	if (found == m_files.end()) { return; }
+	for (AssetPath file : found->second) {
+		std::vector<uint32_t>& assets = m_dependents[file.id];
+		assets.erase(std::remove(assets.begin(), assets.end(), asset), assets.end());
+		if (assets.empty()) { m_dependents.erase(file.id); }
+	}
+	m_files.erase(found);
+}
+
+const std::vector<uint32_t>& DependencyGraphClass::GetDependents(AssetPath file) const {
+	static const std::vector<uint32_t> none;
+	auto found = m_dependents.find(file.id);
+	return found != m_dependents.end() ? found->second : none;
+}
+
+std::vector<std::string> DependencyGraphClass::ScanShaderIncludes(const char* filename) {
+	std::vector<std::string> files;
+	std::unordered_set<std::string> seen;
+	std::vector<std::string> pending{ PathTableClass::Normalize(filename) };
+
+	while (!pending.empty()) {
+		std::string file = pending.back();
+		pending.pop_back();
+		if (!seen.insert(file).second) { continue; }
+		files.push_back(file);
+
+		// Only quoted includes are project files, conditional ones count too since any permutation may need them.
+		std::ifstream stream(file);
+		std::filesystem::path directory = std::filesystem::path(file).parent_path();
+		std::string line;
+		while (std::getline(stream, line)) {
+			size_t start = line.find_first_not_of(" \t");
+			if (start == std::string::npos || line[start] != '#') { continue; }
+			start = line.find_first_not_of(" \t", start + 1);
+			if (start == std::string::npos || line.compare(start, 7, "include") != 0) { continue; }
+			size_t open = line.find('"', start + 7);
+			size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos) { continue; }
+			std::string include = (directory / line.substr(open + 1, close - open - 1)).string();
+			pending.push_back(PathTableClass::Normalize(include.c_str()));
+		}
+	}
+	return files;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "resourcecacheclass.hpp"
+
+// Which assets have to be rebuilt when a file changes. Assets are plain ids chosen by the caller, each one lists every
+// file it was built from, includes already followed, so a change maps to its assets with one lookup.
+class DependencyGraphClass {
+public:
+	void SetDependencies(uint32_t asset, const std::vector<AssetPath>& files);	// Replaces the earlier list, a rebuild may have changed it.
+	void Remove(uint32_t asset);
+	const std::vector<uint32_t>& GetDependents(AssetPath file) const;
+
+	// The shader and every file it pulls in through #include "...", resolved relative to the including file.
+	static std::vector<std::string> ScanShaderIncludes(const char* filename);
+
+private:
+	std::unordered_map<uint32_t, std::vector<AssetPath>> m_files;		// By asset.
+	std::unordered_map<uint32_t, std::vector<uint32_t>> m_dependents;	// By file id.
+};
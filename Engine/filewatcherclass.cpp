@@ -0,0 +1,215 @@
+#include "filewatcherclass.hpp"
+#include "resourcecacheclass.hpp"
+
+void FileWatcherClass::Record(const std::string& path) {
+	std::string normalized = PathTableClass::Normalize(path.c_str());
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending[normalized] = std::chrono::steady_clock::now();	// Every write restarts the wait.
+}
+
+std::vector<std::string> FileWatcherClass::Poll() {
+	std::vector<std::string> files;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto file = m_pending.begin(); file != m_pending.end();) {
+		if (now - file->second < m_debounce) {
+			++file;
+			continue;
+		}
+		files.push_back(file->first);
+		file = m_pending.erase(file);
+	}
+	return files;
+}
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+struct FileWatcherClass::Directory {
+	std::string path;
+	HANDLE handle = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped{};
+	bool listening = false;	// Reads are issued by the watcher thread, pending I/O dies with the thread that started it.
+	alignas(DWORD) BYTE buffer[32 * 1024];
+};
+
+static bool Listen(HANDLE handle, OVERLAPPED& overlapped, BYTE* buffer, DWORD size) {
+	ResetEvent(overlapped.hEvent);
+	DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+	return ReadDirectoryChangesW(handle, buffer, size, FALSE, filter, NULL, &overlapped, NULL) != 0;
+}
+
+FileWatcherClass::FileWatcherClass(unsigned debounceMilliseconds) : m_debounce(debounceMilliseconds) {
+	m_wake = CreateEventA(NULL, FALSE, FALSE, NULL);
+	if (!m_wake) { return; }
+	m_thread = std::thread(&FileWatcherClass::Run, this);
+	isInitialized = true;
+}
+
+FileWatcherClass::~FileWatcherClass() {
+	if (m_thread.joinable()) {
+		m_stopping = true;
+		SetEvent(m_wake);
+		m_thread.join();
+	}
+	for (Directory* directory : m_directories) {
+		if (directory->listening) {
+			DWORD bytes = 0;
+			CancelIoEx(directory->handle, &directory->overlapped);
+			GetOverlappedResult(directory->handle, &directory->overlapped, &bytes, TRUE);
+		}
+		CloseHandle(directory->overlapped.hEvent);
+		CloseHandle(directory->handle);
+		delete directory;
+	}
+	m_directories.clear();
+	if (m_wake) {
+		CloseHandle(m_wake);
+		m_wake = 0;
+	}
+}
+
+bool FileWatcherClass::Watch(const char* directory) {
+	if (!isInitialized) { return false; }
+	std::string path = PathTableClass::Normalize(directory);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (Directory* watched : m_directories) {
+			if (watched->path == path) { return true; }
+		}
+		if (m_directories.size() + 1 >= MAXIMUM_WAIT_OBJECTS) { return false; }
+	}
+
+	HANDLE handle = CreateFileA(path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (handle == INVALID_HANDLE_VALUE) { return false; }
+	HANDLE event = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!event) {
+		CloseHandle(handle);
+		return false;
+	}
+
+	Directory* watched = new Directory;
+	watched->path = path;
+	watched->handle = handle;
+	watched->overlapped.hEvent = event;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_directories.push_back(watched);
+	}
+	SetEvent(m_wake);
+	return true;
+}
+
+void FileWatcherClass::Run() {
+	std::vector<HANDLE> events;
+	std::vector<Directory*> directories;
+	while (!m_stopping) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			directories = m_directories;
+		}
+		events.assign(1, (HANDLE)m_wake);
+		for (Directory* directory : directories) {
+			if (!directory->listening) { directory->listening = Listen(directory->handle, directory->overlapped, directory->buffer, sizeof(directory->buffer)); }
+			events.push_back(directory->overlapped.hEvent);
+		}
+
+		DWORD result = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE, INFINITE);
+		if (result <= WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + events.size()) { continue; }	// Woken up, or an error.
+
+		Directory* directory = directories[result - WAIT_OBJECT_0 - 1];
+		DWORD bytes = 0;
+		// No bytes means the buffer overflowed and the changes are lost, nothing to do but keep listening.
+		if (GetOverlappedResult(directory->handle, &directory->overlapped, &bytes, FALSE) && bytes > 0) {
+			const BYTE* entry = directory->buffer;
+			while (true) {
+				const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+				if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+					int length = (int)(info->FileNameLength / sizeof(WCHAR));
+					int size = WideCharToMultiByte(CP_UTF8, 0, info->FileName, length, NULL, 0, NULL, NULL);
+					std::string name(size, '\0');
+					WideCharToMultiByte(CP_UTF8, 0, info->FileName, length, name.data(), size, NULL, NULL);
+					Record(directory->path + "/" + name);
+				}
+				if (info->NextEntryOffset == 0) { break; }
+				entry += info->NextEntryOffset;
+			}
+		}
+		directory->listening = Listen(directory->handle, directory->overlapped, directory->buffer, sizeof(directory->buffer));
+	}
+}
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+struct FileWatcherClass::Directory {
+	std::string path;
+	int watch = -1;
+};
+
+static constexpr int POLL_MILLISECONDS = 100;	// How long stopping the watcher may take.
+
+FileWatcherClass::FileWatcherClass(unsigned debounceMilliseconds) : m_debounce(debounceMilliseconds) {
+	m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotify < 0) { return; }
+	m_thread = std::thread(&FileWatcherClass::Run, this);
+	isInitialized = true;
+}
+
+FileWatcherClass::~FileWatcherClass() {
+	if (m_thread.joinable()) {
+		m_stopping = true;
+		m_thread.join();
+	}
+	if (m_inotify >= 0) {
+		close(m_inotify);	// Drops the watches with it.
+		m_inotify = -1;
+	}
+	for (Directory* directory : m_directories) { delete directory; }
+	m_directories.clear();
+}
+
+bool FileWatcherClass::Watch(const char* directory) {
+	if (!isInitialized) { return false; }
+	std::string path = PathTableClass::Normalize(directory);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (Directory* watched : m_directories) {
+		if (watched->path == path) { return true; }
+	}
+
+	int watch = inotify_add_watch(m_inotify, path.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE);
+	if (watch < 0) { return false; }
+	Directory* watched = new Directory;
+	watched->path = path;
+	watched->watch = watch;
+	m_directories.push_back(watched);
+	return true;
+}
+
+void FileWatcherClass::Run() {
+	alignas(inotify_event) char buffer[16 * 1024];
+	while (!m_stopping) {
+		pollfd descriptor{ m_inotify, POLLIN, 0 };
+		if (poll(&descriptor, 1, POLL_MILLISECONDS) <= 0) { continue; }
+
+		ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length;) {
+			const inotify_event* event = (const inotify_event*)(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+			if (event->len == 0 || (event->mask & IN_ISDIR)) { continue; }
+
+			std::string path;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (Directory* directory : m_directories) {
+					if (directory->watch == event->wd) { path = directory->path + "/" + event->name; }
+				}
+			}
+			if (!path.empty()) { Record(path); }
+		}
+	}
+}
+#endif
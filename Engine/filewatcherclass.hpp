@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Reports files written in watched directories, through inotify on Linux and ReadDirectoryChangesW on Windows. A
+// thread blocks on the OS and only records what changed; Poll hands out files once they were quiet for the debounce
+// time, so an editor saving in several writes causes one reload.
+class FileWatcherClass {
+public:
+	static constexpr unsigned DEBOUNCE_MILLISECONDS = 150;
+
+	FileWatcherClass(unsigned debounceMilliseconds = DEBOUNCE_MILLISECONDS);
+	FileWatcherClass(const FileWatcherClass&) = delete;
+	~FileWatcherClass();
+
+	bool Watch(const char* directory);	// Not recursive. Watching a directory twice is fine.
+	std::vector<std::string> Poll();	// Settled files, normalized like PathTableClass. Never blocks.
+
+	bool isInitialized = false;
+
+private:
+	struct Directory;	// Per platform, see the source.
+
+	void Run();
+	void Record(const std::string& path);
+
+	std::chrono::milliseconds m_debounce;
+	std::thread m_thread;
+	std::atomic<bool> m_stopping{ false };
+	std::mutex m_mutex;
+	std::vector<Directory*> m_directories;
+	std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_pending;	// Last change of each file.
+#ifdef _WIN32
+	void* m_wake = 0;	// Event that makes the thread pick up new directories or stop.
+#else
+	int m_inotify = -1;
+#endif
+};
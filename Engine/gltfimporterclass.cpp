@@ -0,0 +1,591 @@
+#include "gltfimporterclass.hpp"
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <utility>
+
+enum GltfComponentType {
+	GLTF_BYTE = 5120,
+	GLTF_UNSIGNED_BYTE = 5121,
+	GLTF_SHORT = 5122,
+	GLTF_UNSIGNED_SHORT = 5123,
+	GLTF_UNSIGNED_INT = 5125,
+	GLTF_FLOAT = 5126,
+};
+
+static constexpr uint32_t GLB_MAGIC = 0x46546C67;	// "glTF"
+static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+static constexpr int GLTF_TRIANGLES = 4;
+
+static const float IDENTITY[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+// Array indices, counts and offsets have to be whole, non negative numbers.
+static bool ToSize(const JsonValue* value, size_t& result) {
+	if (!value || !value->IsNumber()) { return false; }
+	double number = value->number;
+	if (number < 0.0 || number != floor(number) || number > 9007199254740992.0) { return false; }
+	result = (size_t)number;
+	return true;
+}
+
+// Optional member, result keeps its default when the member is missing.
+static bool ReadSize(const JsonValue& object, const char* key, size_t& result) {
+	const JsonValue* member = object.Find(key);
+	return !member || ToSize(member, result);
+}
+
+static bool ReadNumbers(const JsonValue& object, const char* key, float* values, size_t count) {
+	const JsonValue* member = object.Find(key);
+	if (!member) { return true; }
+	if (member->Size() != count) { return false; }
+	for (size_t i = 0; i < count; i++) {
+		if (!(*member)[i].IsNumber()) { return false; }
+		values[i] = (float)(*member)[i].number;
+	}
+	return true;
+}
+
+static size_t ComponentSize(int componentType) {
+	switch (componentType) {
+	case GLTF_BYTE: case GLTF_UNSIGNED_BYTE: return 1;
+	case GLTF_SHORT: case GLTF_UNSIGNED_SHORT: return 2;
+	case GLTF_UNSIGNED_INT: case GLTF_FLOAT: return 4;
+	default: return 0;
+	}
+}
+
+static int ComponentCount(const std::string& type) {
+	if (type == "SCALAR") { return 1; }
+	if (type == "VEC2") { return 2; }
+	if (type == "VEC3") { return 3; }
+	if (type == "VEC4" || type == "MAT2") { return 4; }
+	if (type == "MAT3") { return 9; }
+	if (type == "MAT4") { return 16; }
+	return 0;
+}
+
+static void Multiply(const float a[16], const float b[16], float result[16]) {
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) {
+			float sum = 0.0f;
+			for (int k = 0; k < 4; k++) { sum += a[k * 4 + row] * b[column * 4 + k]; }
+			result[column * 4 + row] = sum;
+		}
+	}
+}
+
+static void Cross(const float a[3], const float b[3], float result[3]) {
+	result[0] = a[1] * b[2] - a[2] * b[1];
+	result[1] = a[2] * b[0] - a[0] * b[2];
+	result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// Relative URIs may be percent encoded, "my%20mesh.bin" names "my mesh.bin".
+static std::string DecodeUri(const std::string& uri) {
+	std::string result;
+	for (size_t i = 0; i < uri.size(); i++) {
+		if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2])) {
+			result += (char)strtol(uri.substr(i + 1, 2).c_str(), 0, 16);
+			i += 2;
+		}
+		else {
+			result += uri[i];
+		}
+	}
+	return result;
+}
+
+bool GltfImporterClass::Import(const char* filename, MeshData& mesh) {
+	m_filename = filename;
+	m_error.clear();
+	m_files.clear();
+	m_binaryChunk = Buffer();
+	m_buffers.clear();
+	m_draws.clear();
+
+	JsonValue root;
+	if (!LoadDocument(filename, root)) { return false; }
+	if (!LoadBuffers(root, std::filesystem::path(filename).parent_path().string())) { return false; }
+
+	// The default scene, or every root node when the file has no scenes.
+	std::vector<size_t> roots;
+	const JsonValue* scenes = root.Find("scenes");
+	const JsonValue* nodes = root.Find("nodes");
+	if (scenes && scenes->Size() > 0) {
+		size_t scene = 0;
+		if (!ReadSize(root, "scene", scene) || scene >= scenes->Size()) { return Fail("the default scene does not exist"); }
+		const JsonValue* sceneNodes = (*scenes)[scene].Find("nodes");
+		for (size_t i = 0; sceneNodes && i < sceneNodes->Size(); i++) {
+			size_t node = 0;
+			if (!ToSize(&(*sceneNodes)[i], node)) { return Fail("the default scene has an invalid node"); }
+			roots.push_back(node);
+		}
+	}
+	else if (nodes) {
+		std::vector<bool> isChild(nodes->Size(), false);
+		for (size_t i = 0; i < nodes->Size(); i++) {
+			const JsonValue* children = (*nodes)[i].Find("children");
+			for (size_t c = 0; children && c < children->Size(); c++) {
+				size_t child = 0;
+				if (ToSize(&(*children)[c], child) && child < isChild.size()) { isChild[child] = true; }
+			}
+		}
+		for (size_t i = 0; i < nodes->Size(); i++) {
+			if (!isChild[i]) { roots.push_back(i); }
+		}
+	}
+	for (size_t node : roots) {
+		if (!AddNode(root, node, IDENTITY, 0)) { return false; }
+	}
+	if (m_draws.empty()) { return Fail("the scene has no triangle meshes"); }
+
+	// Every draw gets its own range of the merged arrays, so the jobs never share an output element.
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (Draw& draw : m_draws) {
+		draw.vertexBase = vertexCount;
+		draw.indexBase = indexCount;
+		vertexCount += draw.vertexCount;
+		indexCount += draw.triangleCount * 3;
+	}
+	if (vertexCount > UINT32_MAX) { return Fail("too many vertices for 32-bit indices"); }
+	MeshVertex facing;	// What a vertex without a usable normal keeps.
+	facing.Set<SEMANTIC_NORMAL>({ 0.0f, 0.0f, -1.0f });
+	mesh.vertices.assign(vertexCount, facing);
+	mesh.indices.resize(indexCount);
+
+	std::vector<Job> jobs;
+	for (size_t d = 0; d < m_draws.size(); d++) {
+		const Draw& draw = m_draws[d];
+		for (int triangles = 0; triangles < 2; triangles++) {
+			// Flat shaded draws write their vertices from the triangle jobs.
+			if (!triangles && draw.normals.count == 0) { continue; }
+			size_t count = triangles ? draw.triangleCount : draw.vertexCount;
+			for (size_t begin = 0; begin < count; begin += JOB_SIZE) {
+				Job job;
+				job.draw = d;
+				job.triangles = triangles != 0;
+				job.begin = begin;
+				job.end = std::min(begin + JOB_SIZE, count);
+				jobs.push_back(job);
+			}
+		}
+	}
+
+	size_t threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0) { threadCount = 1; }
+	if (threadCount > jobs.size()) { threadCount = jobs.size(); }
+	auto work = [&](size_t first) {
+		for (size_t i = first; i < jobs.size(); i += threadCount) { RunJob(jobs[i], mesh); }
+	};
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < threadCount; i++) { workers.emplace_back(work, i); }
+	if (threadCount > 0) { work(0); }
+	for (std::thread& worker : workers) { worker.join(); }
+
+	mesh.bounds = MeshBounds();
+	for (const Job& job : jobs) {
+		if (!job.error.empty()) { return Fail(job.error); }
+		mesh.bounds.Add(job.bounds);
+	}
+
+	m_files.clear();
+	m_buffers.clear();
+	m_draws.clear();
+	return true;
+}
+
+bool GltfImporterClass::LoadDocument(const char* filename, JsonValue& root) {
+	m_files.emplace_back(filename);
+	const MappedFileClass& file = m_files.back();
+	if (!file.isInitialized) { return Fail("could not read the file"); }
+
+	const unsigned char* data = file.GetData();
+	size_t size = file.GetSize();
+	const char* json = (const char*)data;
+	size_t jsonSize = size;
+
+	// Binary container: a 12 byte header, then length/type prefixed chunks padded to 4 bytes.
+	uint32_t header[3]{};
+	if (size >= sizeof(header)) { memcpy(header, data, sizeof(header)); }
+	if (header[0] == GLB_MAGIC) {
+		if (header[1] != 2) { return Fail("only version 2 .glb containers are supported"); }
+		size_t length = std::min((size_t)header[2], size);
+		json = 0;
+		for (size_t offset = sizeof(header); offset + 8 <= length;) {
+			uint32_t chunk[2];
+			memcpy(chunk, data + offset, sizeof(chunk));
+			offset += sizeof(chunk);
+			if (chunk[0] > length - offset) { return Fail("a .glb chunk runs past the end of the file"); }
+			if (chunk[1] == GLB_CHUNK_JSON && !json) {
+				json = (const char*)data + offset;
+				jsonSize = chunk[0];
+			}
+			else if (chunk[1] == GLB_CHUNK_BIN && !m_binaryChunk.data) {
+				m_binaryChunk.data = data + offset;
+				m_binaryChunk.size = chunk[0];
+			}
+			offset += ((size_t)chunk[0] + 3) & ~(size_t)3;
+		}
+		if (!json) { return Fail("the .glb container has no JSON chunk"); }
+	}
+
+	JsonParserClass parser;
+	if (!parser.Parse(json, jsonSize, root)) { return Fail(parser.GetError()); }
+	const JsonValue* asset = root.Find("asset");
+	if (!asset || asset->GetString("version").compare(0, 2, "2.") != 0) { return Fail("not a glTF 2.0 file"); }
+
+	// Quantized attributes are read like any other accessor, compressed buffers are out of reach.
+	const JsonValue* required = root.Find("extensionsRequired");
+	for (size_t i = 0; required && i < required->Size(); i++) {
+		const std::string& extension = (*required)[i].string;
+		if (extension != "KHR_mesh_quantization") { return Fail("requires the unsupported extension " + extension); }
+	}
+	return true;
+}
+
+bool GltfImporterClass::LoadBuffers(const JsonValue& root, const std::string& directory) {
+	const JsonValue* buffers = root.Find("buffers");
+	for (size_t i = 0; buffers && i < buffers->Size(); i++) {
+		const JsonValue& description = (*buffers)[i];
+		std::string name = "buffer " + std::to_string(i);
+		size_t byteLength = 0;
+		if (!ToSize(description.Find("byteLength"), byteLength)) { return Fail(name + " has no byteLength"); }
+
+		Buffer buffer;
+		const JsonValue* uri = description.Find("uri");
+		if (!uri) {
+			// Only the first buffer of a .glb may leave out its uri, it is the binary chunk.
+			if (i != 0 || !m_binaryChunk.data) { return Fail(name + " has no uri"); }
+			buffer = m_binaryChunk;
+		}
+		else {
+			if (uri->type != JsonValue::JSON_STRING) { return Fail(name + " has an invalid uri"); }
+			if (uri->string.compare(0, 5, "data:") == 0) { return Fail(name + " is embedded as base64, export with a separate .bin or as .glb"); }
+
+			std::string path = (std::filesystem::path(directory) / DecodeUri(uri->string)).string();
+			m_files.emplace_back(path.c_str());
+			if (!m_files.back().isInitialized) { return Fail("could not read " + name + " from '" + path + "'"); }
+			buffer.data = m_files.back().GetData();
+			buffer.size = m_files.back().GetSize();
+		}
+
+		if (buffer.size < byteLength) { return Fail(name + " is shorter than its byteLength"); }
+		buffer.size = byteLength;
+		m_buffers.push_back(buffer);
+	}
+	return true;
+}
+
+bool GltfImporterClass::ReadAccessor(const JsonValue& root, const JsonValue& index, Accessor& accessor, const char* name) {
+	const JsonValue* accessors = root.Find("accessors");
+	size_t i = 0;
+	if (!ToSize(&index, i) || !accessors || i >= accessors->Size()) { return Fail(std::string(name) + " refers to a missing accessor"); }
+	const JsonValue& description = (*accessors)[i];
+	std::string what = "accessor " + std::to_string(i);
+	if (description.Find("sparse")) { return Fail(what + " is sparse, which is not supported"); }
+
+	accessor = Accessor();
+	if (!ToSize(description.Find("count"), accessor.count)) { return Fail(what + " has no count"); }
+	accessor.componentType = (int)description.GetNumber("componentType", 0);
+	accessor.components = ComponentCount(description.GetString("type"));
+	const JsonValue* normalized = description.Find("normalized");
+	accessor.normalized = normalized && normalized->boolean;
+	size_t elementSize = ComponentSize(accessor.componentType) * accessor.components;
+	if (elementSize == 0) { return Fail(what + " has an unknown type"); }
+
+	// Without a buffer view every element reads as zero.
+	const JsonValue* viewIndex = description.Find("bufferView");
+	if (!viewIndex) { return true; }
+
+	const JsonValue* views = root.Find("bufferViews");
+	size_t v = 0;
+	if (!ToSize(viewIndex, v) || !views || v >= views->Size()) { return Fail(what + " refers to a missing buffer view"); }
+	const JsonValue& view = (*views)[v];
+	std::string viewName = "buffer view " + std::to_string(v);
+
+	size_t buffer = 0, viewOffset = 0, viewLength = 0, stride = elementSize, offset = 0;
+	if (!ToSize(view.Find("buffer"), buffer) || buffer >= m_buffers.size()) { return Fail(viewName + " refers to a missing buffer"); }
+	if (!ToSize(view.Find("byteLength"), viewLength) || !ReadSize(view, "byteOffset", viewOffset) || !ReadSize(view, "byteStride", stride)) {
+		return Fail(viewName + " has an invalid range");
+	}
+	if (viewOffset > m_buffers[buffer].size || viewLength > m_buffers[buffer].size - viewOffset) { return Fail(viewName + " reaches past its buffer"); }
+	if (!ReadSize(description, "byteOffset", offset)) { return Fail(what + " has an invalid byteOffset"); }
+	if (stride < elementSize) { return Fail(viewName + " has a stride smaller than " + what); }
+
+	// The last element has to end inside the view.
+	if (accessor.count > 0 && (offset > viewLength || viewLength - offset < elementSize || (accessor.count - 1) > (viewLength - offset - elementSize) / stride)) {
+		return Fail(what + " reaches past its buffer view");
+	}
+	accessor.data = m_buffers[buffer].data + viewOffset + offset;
+	accessor.stride = stride;
+	return true;
+}
+
+bool GltfImporterClass::AddNode(const JsonValue& root, size_t index, const float parent[16], size_t depth) {
+	const JsonValue* nodes = root.Find("nodes");
+	if (!nodes || index >= nodes->Size()) { return Fail("node " + std::to_string(index) + " does not exist"); }
+	if (depth > nodes->Size()) { return Fail("the node hierarchy has a cycle"); }
+	const JsonValue& node = (*nodes)[index];
+	std::string name = "node " + std::to_string(index);
+
+	float local[16];
+	memcpy(local, IDENTITY, sizeof(local));
+	if (node.Find("matrix")) {
+		if (!ReadNumbers(node, "matrix", local, 16)) { return Fail(name + " has an invalid matrix"); }
+	}
+	else {
+		// Translation * rotation * scale, the quaternion is x, y, z, w.
+		float t[3] = { 0.0f, 0.0f, 0.0f };
+		float r[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		float s[3] = { 1.0f, 1.0f, 1.0f };
+		if (!ReadNumbers(node, "translation", t, 3) || !ReadNumbers(node, "rotation", r, 4) || !ReadNumbers(node, "scale", s, 3)) {
+			return Fail(name + " has an invalid transform");
+		}
+		float x = r[0], y = r[1], z = r[2], w = r[3];
+		float columns[3][3] = {
+			{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y) },
+			{ 2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x) },
+			{ 2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y) } };
+		for (int c = 0; c < 3; c++) {
+			for (int k = 0; k < 3; k++) { local[c * 4 + k] = columns[c][k] * s[c]; }
+			local[12 + c] = t[c];
+		}
+	}
+
+	float world[16];
+	Multiply(parent, local, world);
+
+	if (node.Find("mesh")) {
+		size_t mesh = 0;
+		if (!ToSize(node.Find("mesh"), mesh)) { return Fail(name + " has an invalid mesh"); }
+		if (!AddMesh(root, mesh, world)) { return false; }
+	}
+
+	const JsonValue* children = node.Find("children");
+	for (size_t i = 0; children && i < children->Size(); i++) {
+		size_t child = 0;
+		if (!ToSize(&(*children)[i], child)) { return Fail(name + " has an invalid child"); }
+		if (!AddNode(root, child, world, depth + 1)) { return false; }
+	}
+	return true;
+}
+
+bool GltfImporterClass::AddMesh(const JsonValue& root, size_t index, const float matrix[16]) {
+	const JsonValue* meshes = root.Find("meshes");
+	if (!meshes || index >= meshes->Size()) { return Fail("mesh " + std::to_string(index) + " does not exist"); }
+	const JsonValue* primitives = (*meshes)[index].Find("primitives");
+	std::string name = "mesh " + std::to_string(index);
+
+	for (size_t p = 0; primitives && p < primitives->Size(); p++) {
+		// Points and lines have nothing to draw for the engine.
+		const JsonValue& primitive = (*primitives)[p];
+		if (primitive.GetNumber("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) { continue; }
+		const JsonValue* attributes = primitive.Find("attributes");
+		const JsonValue* position = attributes ? attributes->Find("POSITION") : 0;
+		if (!position) { continue; }
+
+		Draw draw;
+		if (!ReadAccessor(root, *position, draw.positions, "POSITION")) { return false; }
+		if (const JsonValue* normal = attributes->Find("NORMAL")) {
+			if (!ReadAccessor(root, *normal, draw.normals, "NORMAL")) { return false; }
+		}
+		if (const JsonValue* texcoord = attributes->Find("TEXCOORD_0")) {
+			if (!ReadAccessor(root, *texcoord, draw.texcoords, "TEXCOORD_0")) { return false; }
+		}
+		if (const JsonValue* indices = primitive.Find("indices")) {
+			if (!ReadAccessor(root, *indices, draw.indices, "indices")) { return false; }
+			bool integer = draw.indices.componentType == GLTF_UNSIGNED_BYTE || draw.indices.componentType == GLTF_UNSIGNED_SHORT || draw.indices.componentType == GLTF_UNSIGNED_INT;
+			if (!integer || draw.indices.components != 1 || !draw.indices.data) { return Fail(name + " has invalid indices"); }
+			if (draw.indices.count == 0) { continue; }
+		}
+
+		if (draw.positions.components != 3) { return Fail(name + " has positions that are not VEC3"); }
+		if (draw.normals.count > 0 && (draw.normals.components != 3 || draw.normals.count != draw.positions.count)) { return Fail(name + " has normals that do not match its positions"); }
+		if (draw.texcoords.count > 0 && (draw.texcoords.components != 2 || draw.texcoords.count != draw.positions.count)) { return Fail(name + " has texture coordinates that do not match its positions"); }
+
+		size_t cornerCount = draw.indices.count > 0 ? draw.indices.count : draw.positions.count;
+		if (cornerCount % 3 != 0) { return Fail(name + " has a partial triangle"); }
+		draw.triangleCount = cornerCount / 3;
+		draw.vertexCount = draw.normals.count > 0 ? draw.positions.count : cornerCount;
+
+		// Normals go through the inverse transpose. The cofactors are that times the determinant, the sign is all
+		// that matters since the normals get normalized anyway.
+		memcpy(draw.matrix, matrix, sizeof(draw.matrix));
+		float columns[3][3];
+		for (int c = 0; c < 3; c++) {
+			for (int k = 0; k < 3; k++) { columns[c][k] = matrix[c * 4 + k]; }
+		}
+		Cross(columns[1], columns[2], &draw.normalMatrix[0]);
+		Cross(columns[2], columns[0], &draw.normalMatrix[3]);
+		Cross(columns[0], columns[1], &draw.normalMatrix[6]);
+		float determinant = columns[0][0] * draw.normalMatrix[0] + columns[0][1] * draw.normalMatrix[1] + columns[0][2] * draw.normalMatrix[2];
+		draw.mirrored = determinant < 0.0f;
+		if (draw.mirrored) {
+			for (float& value : draw.normalMatrix) { value = -value; }
+		}
+
+		m_draws.push_back(draw);
+	}
+	return true;
+}
+
+void GltfImporterClass::RunJob(Job& job, MeshData& mesh) const {
+	const Draw& draw = m_draws[job.draw];
+	if (!job.triangles) {
+		for (size_t v = job.begin; v < job.end; v++) {
+			MeshVertex& vertex = mesh.vertices[draw.vertexBase + v];
+			WriteVertex(draw, v, vertex);
+			job.bounds.Add(vertex.Position());
+		}
+		return;
+	}
+
+	bool flat = draw.normals.count == 0;
+	for (size_t t = job.begin; t < job.end; t++) {
+		uint32_t corners[3];
+		for (int k = 0; k < 3; k++) {
+			corners[k] = draw.indices.count > 0 ? ReadIndex(draw.indices, t * 3 + k) : (uint32_t)(t * 3 + k);
+			if (corners[k] >= draw.positions.count) {
+				job.error = "index " + std::to_string(corners[k]) + " is out of range for " + std::to_string(draw.positions.count) + " vertices";
+				return;
+			}
+		}
+
+		// glTF fronts are counter clockwise. A mirroring node transform already turned them over.
+		if (!draw.mirrored) { std::swap(corners[1], corners[2]); }
+
+		size_t first = draw.indexBase + t * 3;
+		if (!flat) {
+			for (int k = 0; k < 3; k++) { mesh.indices[first + k] = (uint32_t)(draw.vertexBase + corners[k]); }
+			continue;
+		}
+
+		// Without normals every corner is its own vertex with the face normal, the welder merges coplanar ones.
+		size_t base = draw.vertexBase + t * 3;
+		MeshVertex* vertices = &mesh.vertices[base];
+		for (int k = 0; k < 3; k++) {
+			WriteVertex(draw, corners[k], vertices[k]);
+			mesh.indices[first + k] = (uint32_t)(base + k);
+			job.bounds.Add(vertices[k].Position());
+		}
+
+		const float* a = vertices[0].Position();
+		const float* b = vertices[1].Position();
+		const float* c = vertices[2].Position();
+		float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float normal[3];
+		Cross(ab, ac, normal);
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0f) { continue; }
+		for (int k = 0; k < 3; k++) {
+			for (int axis = 0; axis < 3; axis++) { vertices[k].Normal()[axis] = normal[axis] / length; }
+		}
+	}
+}
+
+void GltfImporterClass::WriteVertex(const Draw& draw, size_t source, MeshVertex& vertex) const {
+	// glTF is right handed, mirroring z makes it left handed. Texture coordinates already start at the top left.
+	float p[3];
+	ReadFloats(draw.positions, source, p, 3);
+	const float* m = draw.matrix;
+	for (int k = 0; k < 3; k++) { vertex.Position()[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k]; }
+	vertex.Position()[2] = -vertex.Position()[2];
+
+	if (draw.texcoords.count > 0) { ReadFloats(draw.texcoords, source, vertex.Texcoord(), 2); }
+
+	if (draw.normals.count > 0) {
+		float n[3];
+		ReadFloats(draw.normals, source, n, 3);
+		const float* c = draw.normalMatrix;
+		float t[3];
+		for (int k = 0; k < 3; k++) { t[k] = c[k] * n[0] + c[3 + k] * n[1] + c[6 + k] * n[2]; }
+		float length = sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+		if (length > 0.0f) {
+			vertex.Normal()[0] = t[0] / length;
+			vertex.Normal()[1] = t[1] / length;
+			vertex.Normal()[2] = -t[2] / length;
+		}
+	}
+}
+
+void GltfImporterClass::ReadFloats(const Accessor& accessor, size_t element, float* values, int count) {
+	if (!accessor.data) {
+		for (int k = 0; k < count; k++) { values[k] = 0.0f; }
+		return;
+	}
+
+	const unsigned char* p = accessor.data + element * accessor.stride;
+	if (accessor.componentType == GLTF_FLOAT) {
+		memcpy(values, p, count * sizeof(float));
+		return;
+	}
+
+	for (int k = 0; k < count; k++) {
+		float value = 0.0f;
+		switch (accessor.componentType) {
+		case GLTF_BYTE: {
+			int8_t c;
+			memcpy(&c, p + k, sizeof(c));
+			value = accessor.normalized ? fmaxf(c / 127.0f, -1.0f) : c;
+			break;
+		}
+		case GLTF_UNSIGNED_BYTE: {
+			uint8_t c;
+			memcpy(&c, p + k, sizeof(c));
+			value = accessor.normalized ? c / 255.0f : c;
+			break;
+		}
+		case GLTF_SHORT: {
+			int16_t c;
+			memcpy(&c, p + k * sizeof(c), sizeof(c));
+			value = accessor.normalized ? fmaxf(c / 32767.0f, -1.0f) : c;
+			break;
+		}
+		case GLTF_UNSIGNED_SHORT: {
+			uint16_t c;
+			memcpy(&c, p + k * sizeof(c), sizeof(c));
+			value = accessor.normalized ? c / 65535.0f : c;
+			break;
+		}
+		case GLTF_UNSIGNED_INT: {
+			uint32_t c;
+			memcpy(&c, p + k * sizeof(c), sizeof(c));
+			value = (float)c;
+			break;
+		}
+		}
+		values[k] = value;
+	}
+}
+
+uint32_t GltfImporterClass::ReadIndex(const Accessor& accessor, size_t element) {
+	const unsigned char* p = accessor.data + element * accessor.stride;
+	switch (accessor.componentType) {
+	case GLTF_UNSIGNED_BYTE: return *p;
+	case GLTF_UNSIGNED_SHORT: {
+		uint16_t index;
+		memcpy(&index, p, sizeof(index));
+		return index;
+	}
+	default: {
+		uint32_t index;
+		memcpy(&index, p, sizeof(index));
+		return index;
+	}
+	}
+}
+
+bool GltfImporterClass::Fail(const std::string& message) {
+	m_error = m_filename + ": " + message;
+	m_files.clear();
+	m_buffers.clear();
+	m_draws.clear();
+	return false;
+}
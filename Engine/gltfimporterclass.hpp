@@ -0,0 +1,79 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <vector>
+#include "jsonparserclass.hpp"
+#include "mappedfileclass.hpp"
+#include "meshtypes.hpp"
+
+// glTF 2.0 importer for .gltf files with external .bin buffers and for .glb containers. Buffers stay mapped, the
+// triangle primitives of the default scene are flattened with their node transforms and the accessors are read
+// by several threads in fixed size jobs straight into the merged vertex and index arrays.
+// Output is converted to the engine's left handed, clockwise convention.
+class GltfImporterClass {
+public:
+	bool Import(const char* filename, MeshData& mesh);
+	const std::string& GetError() const { return m_error; }	// "file: message" of the first problem found.
+
+private:
+	struct Buffer {
+		const unsigned char* data = 0;
+		size_t size = 0;
+	};
+
+	struct Accessor {
+		const unsigned char* data = 0;	// 0 for accessors without a buffer view, which read as zeros.
+		size_t stride = 0;
+		size_t count = 0;
+		int componentType = 0;
+		int components = 0;
+		bool normalized = false;
+	};
+
+	// One primitive under one node, with where its output goes in the merged mesh.
+	struct Draw {
+		Accessor positions;
+		Accessor normals;		// count is 0 when missing, flat normals are made up then.
+		Accessor texcoords;		// count is 0 when missing.
+		Accessor indices;		// count is 0 for unindexed primitives.
+		float matrix[16]{};		// Column major node to world transform.
+		float normalMatrix[9]{};	// Columns of the inverse transpose, up to scale.
+		bool mirrored = false;	// Negative determinant, the transform already flipped the winding.
+		size_t triangleCount = 0;
+		size_t vertexBase = 0;
+		size_t vertexCount = 0;
+		size_t indexBase = 0;
+	};
+
+	struct Job {
+		size_t draw = 0;
+		bool triangles = false;	// Writes indices, or whole corners for flat shaded draws, instead of vertices.
+		size_t begin = 0;
+		size_t end = 0;
+		MeshBounds bounds;
+		std::string error;
+	};
+
+	bool LoadDocument(const char* filename, JsonValue& root);
+	bool LoadBuffers(const JsonValue& root, const std::string& directory);
+	bool ReadAccessor(const JsonValue& root, const JsonValue& index, Accessor& accessor, const char* name);
+	bool AddNode(const JsonValue& root, size_t node, const float parent[16], size_t depth);
+	bool AddMesh(const JsonValue& root, size_t mesh, const float matrix[16]);
+	void RunJob(Job& job, MeshData& mesh) const;
+	void WriteVertex(const Draw& draw, size_t source, MeshVertex& vertex) const;
+	bool Fail(const std::string& message);
+
+	static void ReadFloats(const Accessor& accessor, size_t element, float* values, int count);
+	static uint32_t ReadIndex(const Accessor& accessor, size_t element);
+
+	static constexpr size_t JOB_SIZE = 1 << 16;	// Elements per job, small enough to balance and big enough to not matter.
+
+	std::string m_filename;
+	std::list<MappedFileClass> m_files;	// Keeps the document and the .bin files mapped until the import is done.
+	Buffer m_binaryChunk;
+	std::vector<Buffer> m_buffers;
+	std::vector<Draw> m_draws;
+	std::string m_error;
+};
@@ -0,0 +1,128 @@
+#include "hdrdecoderclass.hpp"
+#include "imageconverterclass.hpp"
+#include <stdio.h>
+#include <string.h>
+
+static constexpr size_t MAX_HEADER_LINE = 4096;
+
+HdrDecoderClass::HdrDecoderClass(const unsigned char* data, size_t size) : m_data(data), m_size(size) {}
+
+bool HdrDecoderClass::IsHdr(const unsigned char* data, size_t size) {
+	// "#?RADIANCE" from Radiance itself, "#?RGBE" and others from other tools.
+	return size >= 2 && data[0] == '#' && data[1] == '?';
+}
+
+bool HdrDecoderClass::Fail(const std::string& message) {
+	errorMessage = message;
+	return false;
+}
+
+bool HdrDecoderClass::ReadLine(std::string& line) {
+	line.clear();
+	while (m_position < m_size) {
+		char c = (char)m_data[m_position++];
+		if (c == '\n') {
+			if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+			return true;
+		}
+		if (line.size() == MAX_HEADER_LINE) { return false; }
+		line += c;
+	}
+	return false;
+}
+
+bool HdrDecoderClass::ReadHeader() {
+	if (!IsHdr(m_data, m_size)) { return Fail("not a Radiance HDR file"); }
+
+	// Variables up to the first empty line, only the format matters. The resolution follows on the next line.
+	std::string line;
+	while (true) {
+		if (!ReadLine(line)) { return Fail("unexpected end of header"); }
+		if (line.empty()) { break; }
+		if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe") { return Fail("unsupported " + line); }
+	}
+	if (!ReadLine(line)) { return Fail("missing resolution"); }
+
+	char yAxis[3] = {}, xAxis[3] = {};
+	int height = 0, width = 0;
+	if (sscanf(line.c_str(), "%2s %d %2s %d", yAxis, &height, xAxis, &width) != 4) { return Fail("bad resolution " + line); }
+	// Rows of pixels running left to right are all anyone writes, the column major orientations are not handled.
+	if ((strcmp(yAxis, "-Y") != 0 && strcmp(yAxis, "+Y") != 0) || strcmp(xAxis, "+X") != 0) { return Fail("unsupported orientation " + line); }
+	if (width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+		return Fail("bad size " + std::to_string(width) + "x" + std::to_string(height));
+	}
+	m_width = width;
+	m_height = height;
+	m_bottomUp = yAxis[0] == '+';
+	m_headerRead = true;
+	return true;
+}
+
+bool HdrDecoderClass::Decode(float* destination) {
+	if (!m_headerRead) { return Fail("the header was not read"); }
+
+	// Scanlines are decoded to RGBE bytes one at a time, then widened to floats straight into their row.
+	std::vector<unsigned char> rgbe((size_t)m_width * 4);
+	for (int y = 0; y < m_height; y++) {
+		if (!ReadScanline(rgbe.data())) { return false; }
+		int row = m_bottomUp ? m_height - 1 - y : y;
+		ImageConverterClass::RgbeToFloat(rgbe.data(), destination + (size_t)row * m_width * 4, (size_t)m_width);
+	}
+	return true;
+}
+
+bool HdrDecoderClass::ReadScanline(unsigned char* rgbe) {
+	// Run length scanlines start with 2, 2 and their width, which no flat pixel can: its mantissas would be
+	// unnormalized. Very narrow and very wide images are always flat.
+	if (m_width < 8 || m_width > 0x7FFF || m_size - m_position < 4) { return ReadFlatScanline(rgbe); }
+	const unsigned char* start = m_data + m_position;
+	if (start[0] != 2 || start[1] != 2 || (start[2] & 0x80)) { return ReadFlatScanline(rgbe); }
+	if ((start[2] << 8 | start[3]) != m_width) { return Fail("bad scanline width"); }
+	m_position += 4;
+
+	// Each channel on its own: runs of one value or literal bytes, up to 127 at a time.
+	for (int channel = 0; channel < 4; channel++) {
+		int x = 0;
+		while (x < m_width) {
+			if (m_position >= m_size) { return Fail("unexpected end of file"); }
+			int count = m_data[m_position++];
+			if (count > 128) {
+				count -= 128;
+				if (count > m_width - x) { return Fail("run past the end of a scanline"); }
+				if (m_position >= m_size) { return Fail("unexpected end of file"); }
+				unsigned char value = m_data[m_position++];
+				for (; count > 0; count--, x++) { rgbe[(size_t)x * 4 + channel] = value; }
+			}
+			else {
+				if (count == 0 || count > m_width - x) { return Fail("bad scanline run"); }
+				if ((size_t)count > m_size - m_position) { return Fail("unexpected end of file"); }
+				for (; count > 0; count--, x++) { rgbe[(size_t)x * 4 + channel] = m_data[m_position++]; }
+			}
+		}
+	}
+	return true;
+}
+
+bool HdrDecoderClass::ReadFlatScanline(unsigned char* rgbe) {
+	// Plain pixels, where 1, 1, 1, n repeats the one before n times, shifted up by 8 bits for every repeat in a row.
+	size_t width = (size_t)m_width;
+	int shift = 0;
+	size_t x = 0;
+	while (x < width) {
+		if (m_size - m_position < 4) { return Fail("unexpected end of file"); }
+		const unsigned char* pixel = m_data + m_position;
+		m_position += 4;
+		if (pixel[0] == 1 && pixel[1] == 1 && pixel[2] == 1) {
+			if (x == 0 || shift > 24) { return Fail("bad repeat"); }
+			size_t count = (size_t)pixel[3] << shift;
+			if (count > width - x) { return Fail("repeat past the end of a scanline"); }
+			for (; count > 0; count--, x++) { memcpy(rgbe + x * 4, rgbe + (x - 1) * 4, 4); }
+			shift += 8;
+			continue;
+		}
+		memcpy(rgbe + x * 4, pixel, 4);
+		x++;
+		shift = 0;
+	}
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Radiance HDR (*.hdr, RGBE) decoder over a file already in memory, usually a MappedFileClass view. Writes linear
+// RGBA floats with alpha 1, top row first, into the caller's buffer. Handles flat, old style run length and the usual
+// per channel run length scanlines, stored top down or bottom up. Values come out as stored, EXPOSURE lines are not
+// applied, which is what other tools expect as well.
+class HdrDecoderClass {
+public:
+	static constexpr int MAX_DIMENSION = 16384;	// The largest texture D3D11 can create.
+
+	HdrDecoderClass(const unsigned char* data, size_t size);	// The data must outlive the decoder.
+	HdrDecoderClass(const HdrDecoderClass&) = delete;
+
+	static bool IsHdr(const unsigned char* data, size_t size);
+
+	bool ReadHeader();
+	bool Decode(float* destination);	// GetWidth() * GetHeight() * 4 floats, after ReadHeader.
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	std::string errorMessage;
+
+private:
+	bool ReadLine(std::string& line);
+	bool ReadScanline(unsigned char* rgbe);
+	bool ReadFlatScanline(unsigned char* rgbe);
+	bool Fail(const std::string& message);
+
+	const unsigned char* m_data = 0;
+	size_t m_size = 0;
+	size_t m_position = 0;
+
+	int m_width = 0;
+	int m_height = 0;
+	bool m_bottomUp = false;
+	bool m_headerRead = false;
+};
@@ -0,0 +1,192 @@
+#include "hotreloadclass.hpp"
+#include <algorithm>
+#include <filesystem>
+
+HotReloadClass::HotReloadClass(ResourceRegistryClass& registry, ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+	: m_registry(&registry), m_device(device), m_deviceContext(deviceContext) {
+	m_watcher = new FileWatcherClass();
+	if (!m_watcher->isInitialized) { return; }
+	m_pool = new ThreadPoolClass(1);	// Reloads come one edit at a time and stay out of the asset loader's way.
+	isInitialized = m_pool->isInitialized;
+}
+
+HotReloadClass::~HotReloadClass() {
+	if (m_pool) {	// Waits for the running rebuild and drops the queued ones, so every rebuild can go.
+		delete m_pool;
+		m_pool = 0;
+	}
+	for (Rebuild* rebuild : m_running) { delete rebuild; }
+	m_running.clear();
+	m_finished.clear();
+	if (m_watcher) {
+		delete m_watcher;
+		m_watcher = 0;
+	}
+}
+
+void HotReloadClass::WatchMesh(AssetPath source, const MeshCookSettings& settings) {
+	std::string filename = m_registry->paths.GetString(source);
+	ID3D11Device* device = m_device;
+	Watch<MeshClass>(m_registry->meshes, ResourceKey(source), { source },
+		[filename, settings](std::string& error) -> MeshClass* {
+			MeshClass* mesh = new MeshClass(filename.c_str(), settings);
+			if (mesh->isLoaded) { return mesh; }
+			error = mesh->errorMessage;
+			delete mesh;
+			return 0;
+		},
+		[device](MeshClass& mesh, std::string& error) {
+			if (mesh.CreateBuffers(device)) { return true; }
+			error = mesh.errorMessage;
+			return false;
+		});
+}
+
+void HotReloadClass::WatchTexture(AssetPath texture) {
+	std::string filename = m_registry->paths.GetString(texture);
+	ID3D11Device* device = m_device;
+	ID3D11DeviceContext* deviceContext = m_deviceContext;
+	Watch<TextureClass>(m_registry->textures, ResourceKey(texture), { texture },
+		[filename](std::string& error) -> TextureClass* {
+			std::string path = filename;
+			TextureClass* result = new TextureClass(path.data());
+			if (result->isLoaded) { return result; }
+			error = filename + ": " + result->errorMessage;
+			delete result;
+			return 0;
+		},
+		[filename, device, deviceContext, registry = m_registry, key = ResourceKey(texture)](TextureClass& result, std::string& error) {
+			// The edit may have changed the mips, so a streamed texture starts over from its new tail.
+			TextureStreamerClass* streamer = registry->textureStreamer;
+			if (!registry->textures.Lookup(key)) {	// Released since the edit, nothing to swap and nothing to stream.
+				error = filename + ": no longer loaded";
+				return false;
+			}
+			uint32_t firstMip = 0;
+			if (streamer) {
+				streamer->Remove(key);
+				firstMip = streamer->Add(key, result.GetMipSizes(), result.GetCoarsestTopMip());
+			}
+			if (result.Create(device, deviceContext, firstMip)) { return true; }
+			if (streamer) { streamer->Remove(key); }	// The old texture stays, just no longer streamed.
+			error = filename + ": could not create the texture";
+			return false;
+		});
+}
+
+void HotReloadClass::WatchLightShader(AssetPath vertexShader, AssetPath pixelShader, const MeshVertexFormat& format, const std::vector<ShaderKey>& keys) {
+	// Every rebuild lists the includes again, an edit may have added one.
+	std::function<std::vector<std::string>()> scan = [stages = std::vector<std::string>{ m_registry->paths.GetString(vertexShader),
+		m_registry->paths.GetString(pixelShader) }]() {
+		std::vector<std::string> files;
+		for (const std::string& stage : stages) {
+			std::vector<std::string> included = DependencyGraphClass::ScanShaderIncludes(stage.c_str());
+			files.insert(files.end(), included.begin(), included.end());
+		}
+		return files;
+	};
+	std::vector<AssetPath> files;
+	for (const std::string& file : scan()) { files.push_back(m_registry->paths.Intern(file.c_str())); }
+
+	// The device is free threaded, so the whole compile and create stays on the worker. The cache sees the edit in its
+	// source hash and compiles again.
+	ID3D11Device* device = m_device;
+	ShaderCacheClass* cache = m_registry->shaderCache;
+	StateObjectCacheClass* stateObjects = m_registry->stateObjects;
+	uint64_t key = ResourceKey(vertexShader, LightShaderClass::GetVariant(format));
+	Watch<LightShaderClass>(m_registry->shaders, key, files,
+		[device, format, keys, cache, stateObjects](std::string& error) -> LightShaderClass* {
+			if (!stateObjects) {
+				error = "could not rebuild the light shader, the registry has no state objects";
+				return 0;
+			}
+			// Without a window the compile errors come back in errorMessage instead of a message box.
+			LightShaderClass* shader = new LightShaderClass(device, NULL, format, keys, *stateObjects, cache);
+			if (shader->isInitialized) { return shader; }
+			error = "could not rebuild the light shader: " + shader->errorMessage;
+			delete shader;
+			return 0;
+		});
+	m_entries[Find(&m_registry->shaders, key)].scan = std::move(scan);
+}
+
+uint32_t HotReloadClass::Find(const void* cache, uint64_t key) {
+	uint32_t entry = 0;
+	while (entry < m_entries.size() && !(m_entries[entry].cache == cache && m_entries[entry].key == key)) { entry++; }
+	if (entry == m_entries.size()) {
+		m_entries.emplace_back();
+		m_entries[entry].cache = cache;
+		m_entries[entry].key = key;
+	}
+	return entry;
+}
+
+void HotReloadClass::Add(const void* cache, uint64_t key, const std::vector<AssetPath>& files, std::function<Rebuild*()> create) {
+	uint32_t entry = Find(cache, key);
+	m_entries[entry].create = std::move(create);
+	SetFiles(entry, files);
+}
+
+void HotReloadClass::SetFiles(uint32_t entry, const std::vector<std::string>& files) {
+	std::vector<AssetPath> paths;
+	for (const std::string& file : files) { paths.push_back(m_registry->paths.Intern(file.c_str())); }
+	SetFiles(entry, paths);
+}
+
+void HotReloadClass::SetFiles(uint32_t entry, const std::vector<AssetPath>& files) {
+	m_graph.SetDependencies(entry, files);
+	if (!isInitialized) { return; }
+	for (AssetPath file : files) {
+		std::filesystem::path directory = std::filesystem::path(m_registry->paths.GetString(file)).parent_path();
+		m_watcher->Watch(directory.empty() ? "." : directory.string().c_str());
+	}
+}
+
+void HotReloadClass::Start(uint32_t entry) {
+	if (m_entries[entry].running) {
+		m_entries[entry].dirty = true;
+		return;
+	}
+	m_entries[entry].running = true;
+	m_entries[entry].dirty = false;
+
+	Rebuild* rebuild = m_entries[entry].create();
+	rebuild->entry = entry;
+	m_running.push_back(rebuild);
+	m_pool->Submit([this, rebuild, scan = m_entries[entry].scan]() {
+		rebuild->Build();
+		if (scan) { rebuild->files = scan(); }	// Failed builds too, fixing a new include has to rebuild again.
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_finished.push_back(rebuild);
+	});
+}
+
+size_t HotReloadClass::Update(std::vector<std::string>& errors) {
+	if (!isInitialized) { return 0; }
+
+	for (const std::string& file : m_watcher->Poll()) {
+		AssetPath path = m_registry->paths.Find(file.c_str());
+		if (!path.IsValid()) { continue; }
+		for (uint32_t entry : m_graph.GetDependents(path)) { Start(entry); }
+	}
+
+	std::vector<Rebuild*> finished;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		finished.swap(m_finished);
+	}
+
+	size_t swapped = 0;
+	for (Rebuild* rebuild : finished) {
+		if (rebuild->Commit()) { swapped++; }
+		else { errors.push_back(rebuild->error.empty() ? "a rebuild failed" : rebuild->error); }
+
+		uint32_t entry = rebuild->entry;
+		if (!rebuild->files.empty()) { SetFiles(entry, rebuild->files); }
+		m_running.erase(std::find(m_running.begin(), m_running.end(), rebuild));
+		delete rebuild;
+		m_entries[entry].running = false;
+		if (m_entries[entry].dirty) { Start(entry); }
+	}
+	return swapped;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <d3d11.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "resourceregistryclass.hpp"
+#include "dependencygraphclass.hpp"
+#include "filewatcherclass.hpp"
+#include "threadpoolclass.hpp"
+
+// Rebuilds shared resources whose files changed while the engine runs. A changed file marks the cache entries built
+// from it, those rebuild on a worker and Update swaps the results into the registry at the start of a frame, so every
+// owner draws with the new resource from that frame on. A failed rebuild keeps the old resource.
+class HotReloadClass {
+public:
+	HotReloadClass(ResourceRegistryClass& registry, ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+	HotReloadClass(const HotReloadClass&) = delete;
+	~HotReloadClass();
+
+	void WatchMesh(AssetPath source, const MeshCookSettings& settings = MeshCookSettings());
+	void WatchTexture(AssetPath texture);
+	// The shader is rebuilt when either stage or anything they include changes.
+	void WatchLightShader(AssetPath vertexShader, AssetPath pixelShader, const MeshVertexFormat& format, const std::vector<ShaderKey>& keys);
+	// load runs on the worker, upload on the main thread before the swap.
+	template <class T>
+	void Watch(ResourceCacheClass<T>& cache, uint64_t key, const std::vector<AssetPath>& files, std::function<T*(std::string&)> load,
+		std::function<bool(T&, std::string&)> upload = {});
+
+	// Main thread, at the start of a frame. Starts rebuilds for files that settled and swaps in the finished ones.
+	// Returns how many were swapped, errors of failed rebuilds are appended.
+	size_t Update(std::vector<std::string>& errors);
+
+	bool isInitialized = false;
+
+private:
+	struct Rebuild {
+		Rebuild() {}
+		Rebuild(const Rebuild&) = delete;
+		virtual ~Rebuild() {}
+		virtual void Build() = 0;	// Worker.
+		virtual bool Commit() = 0;	// Main thread.
+
+		uint32_t entry = 0;
+		std::string error;
+		std::vector<std::string> files;	// Listed again after the build, empty keeps the entry's files.
+	};
+
+	template <class T>
+	struct RebuildOf : Rebuild {
+		ResourceCacheClass<T>* cache = 0;
+		uint64_t key = 0;
+		T* resource = 0;
+		std::function<T*(std::string&)> load;
+		std::function<bool(T&, std::string&)> upload;
+
+		~RebuildOf() { delete resource; }
+		void Build() override { resource = load(error); }
+		bool Commit() override {
+			if (!resource || (upload && !upload(*resource, error))) { return false; }
+			T* old = cache->Replace(key, resource);
+			resource = 0;
+			delete old;	// D3D keeps whatever is still bound alive until it is unbound.
+			return true;
+		}
+	};
+
+	struct Entry {
+		const void* cache = 0;
+		uint64_t key = 0;
+		std::function<Rebuild*()> create;
+		std::function<std::vector<std::string>()> scan;	// Worker, for entries whose files can change with an edit.
+		bool running = false;	// Only one rebuild per entry at a time.
+		bool dirty = false;		// Changed again while it was running.
+	};
+
+	uint32_t Find(const void* cache, uint64_t key);	// Adds the entry when there is none.
+	void Add(const void* cache, uint64_t key, const std::vector<AssetPath>& files, std::function<Rebuild*()> create);
+	void SetFiles(uint32_t entry, const std::vector<std::string>& files);
+	void SetFiles(uint32_t entry, const std::vector<AssetPath>& files);
+	void Start(uint32_t entry);
+
+	ResourceRegistryClass* m_registry = 0;
+	ID3D11Device* m_device = 0;
+	ID3D11DeviceContext* m_deviceContext = 0;
+	FileWatcherClass* m_watcher = 0;
+	ThreadPoolClass* m_pool = 0;
+	DependencyGraphClass m_graph;
+	std::vector<Entry> m_entries;
+	std::vector<Rebuild*> m_running;	// Main thread, owns every rebuild that was started.
+	std::mutex m_mutex;
+	std::vector<Rebuild*> m_finished;
+};
+
+template <class T>
+void HotReloadClass::Watch(ResourceCacheClass<T>& cache, uint64_t key, const std::vector<AssetPath>& files, std::function<T*(std::string&)> load,
+	std::function<bool(T&, std::string&)> upload) {
+	Add(&cache, key, files, [&cache, key, load = std::move(load), upload = std::move(upload)]() -> Rebuild* {
+		RebuildOf<T>* rebuild = new RebuildOf<T>;
+		rebuild->cache = &cache;
+		rebuild->key = key;
+		rebuild->load = load;
+		rebuild->upload = upload;
+		return rebuild;
+	});
+}
@@ -0,0 +1,279 @@
+#include "imageconverterclass.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define IMAGECONVERTER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGECONVERTER_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IMAGECONVERTER_NEON
+#endif
+
+// The float kernels only need SSE2, which every AVX2 target has. Halves convert in hardware with F16C, which MSVC
+// allows whenever it targets AVX2, or on 64-bit ARM.
+#if defined(IMAGECONVERTER_AVX2) || defined(IMAGECONVERTER_SSE2)
+#define IMAGECONVERTER_FLOAT_SSE2
+#endif
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define IMAGECONVERTER_F16C
+#elif defined(IMAGECONVERTER_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define IMAGECONVERTER_NEON_HALF
+#endif
+
+static inline uint32_t SwapRedBlue(uint32_t pixel) {
+	return (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFFu) | ((pixel & 0xFFu) << 16);
+}
+
+static inline void ConvertPixel(const unsigned char* source, unsigned char* destination) {
+	uint32_t pixel;
+	memcpy(&pixel, source, 4);
+	pixel = SwapRedBlue(pixel);
+	memcpy(destination, &pixel, 4);
+}
+
+// A block is as many pixels as one register holds, the loops below are the same for every instruction set.
+#if defined(IMAGECONVERTER_AVX2)
+typedef __m256i Block;
+static constexpr size_t BLOCK_PIXELS = 8;
+static inline Block Load(const unsigned char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline void Store(unsigned char* p, Block block) {
+	const __m256i order = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	_mm256_storeu_si256((__m256i*)p, _mm256_shuffle_epi8(block, order));
+}
+#elif defined(IMAGECONVERTER_SSE2)
+typedef __m128i Block;
+static constexpr size_t BLOCK_PIXELS = 4;
+static inline Block Load(const unsigned char* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void Store(unsigned char* p, Block block) {
+	// No byte shuffle before SSSE3, so the same masks and shifts as the scalar path on four pixels at once.
+	const __m128i greenAlpha = _mm_set1_epi32((int)0xFF00FF00u);
+	const __m128i low = _mm_set1_epi32(0xFF);
+	__m128i red = _mm_and_si128(_mm_srli_epi32(block, 16), low);
+	__m128i blue = _mm_slli_epi32(_mm_and_si128(block, low), 16);
+	_mm_storeu_si128((__m128i*)p, _mm_or_si128(_mm_and_si128(block, greenAlpha), _mm_or_si128(red, blue)));
+}
+#elif defined(IMAGECONVERTER_NEON)
+typedef uint8x16x4_t Block;
+static constexpr size_t BLOCK_PIXELS = 16;
+static inline Block Load(const unsigned char* p) { return vld4q_u8(p); }	// Deinterleaved, one register per channel.
+static inline void Store(unsigned char* p, Block block) {
+	uint8x16_t blue = block.val[0];
+	block.val[0] = block.val[2];
+	block.val[2] = blue;
+	vst4q_u8(p, block);
+}
+#else
+typedef uint32_t Block;
+static constexpr size_t BLOCK_PIXELS = 1;
+static inline Block Load(const unsigned char* p) {
+	Block block;
+	memcpy(&block, p, 4);
+	return block;
+}
+static inline void Store(unsigned char* p, Block block) {
+	block = SwapRedBlue(block);
+	memcpy(p, &block, 4);
+}
+#endif
+
+void ImageConverterClass::BgraToRgba(const unsigned char* source, unsigned char* destination, size_t pixels) {
+	size_t i = 0;
+	for (; i + BLOCK_PIXELS <= pixels; i += BLOCK_PIXELS) { Store(destination + i * 4, Load(source + i * 4)); }
+	for (; i < pixels; i++) { ConvertPixel(source + i * 4, destination + i * 4); }
+}
+
+// Converts two rows and exchanges them, both are read before either is written.
+static void SwapRows(unsigned char* top, unsigned char* bottom, size_t pixels) {
+	size_t i = 0;
+	for (; i + BLOCK_PIXELS <= pixels; i += BLOCK_PIXELS) {
+		Block upper = Load(top + i * 4);
+		Block lower = Load(bottom + i * 4);
+		Store(top + i * 4, lower);
+		Store(bottom + i * 4, upper);
+	}
+	for (; i < pixels; i++) {
+		uint32_t upper, lower;
+		memcpy(&upper, top + i * 4, 4);
+		memcpy(&lower, bottom + i * 4, 4);
+		upper = SwapRedBlue(upper);
+		lower = SwapRedBlue(lower);
+		memcpy(top + i * 4, &lower, 4);
+		memcpy(bottom + i * 4, &upper, 4);
+	}
+}
+
+void ImageConverterClass::BgraToRgbaImage(unsigned char* pixels, size_t width, size_t height, bool flip) {
+	size_t rowSize = width * 4;
+	if (!flip) {
+		BgraToRgba(pixels, pixels, width * height);
+		return;
+	}
+	for (size_t top = 0; top < height / 2; top++) { SwapRows(pixels + top * rowSize, pixels + (height - 1 - top) * rowSize, width); }
+	if (height % 2) {
+		unsigned char* middle = pixels + height / 2 * rowSize;
+		BgraToRgba(middle, middle, width);
+	}
+}
+
+static inline uint32_t FloatBits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	return bits;
+}
+
+static inline float BitsFloat(uint32_t bits) {
+	float value;
+	memcpy(&value, &bits, 4);
+	return value;
+}
+
+// The scalar conversions do the same arithmetic as the vector ones, so the tails of a row round the same way.
+static inline void ConvertRgbe(const unsigned char* rgbe, float* destination) {
+	// Mantissas are taken at the middle of their step, as Radiance does. 2^(e - 128) is built from its bits.
+	float scale = rgbe[3] > 1 ? BitsFloat((uint32_t)(rgbe[3] - 1) << 23) * (1.0f / 256.0f) : 0.0f;
+	for (int channel = 0; channel < 3; channel++) { destination[channel] = (rgbe[channel] + 0.5f) * scale; }
+	destination[3] = 1.0f;
+}
+
+static inline uint16_t ConvertHalf(float value) {
+	uint32_t bits = FloatBits(value);
+	uint32_t sign = (bits >> 16) & 0x8000u;
+	bits &= 0x7FFFFFFFu;
+	if (bits >= 0x47800000u) { return (uint16_t)(sign | (bits > 0x7F800000u ? 0x7E00u : 0x7C00u)); }	// Overflow, infinity, NaN.
+	if (bits < 0x38800000u) {
+		// Denormal halves: adding 0.5 lines the mantissa up with the half's, the float adder rounds.
+		return (uint16_t)(sign | (FloatBits(BitsFloat(bits) + 0.5f) - 0x3F000000u));
+	}
+	// Rebias the exponent and round the 13 dropped bits, ties to even.
+	bits += 0xC8000FFFu + ((bits >> 13) & 1u);
+	return (uint16_t)(sign | (bits >> 13));
+}
+
+static const float RGB9E5_MAXIMUM = 65408.0f;	// 511 / 512 * 2^16.
+static const float RGB9E5_MINIMUM = 1.0f / 65536.0f;	// Below the smallest shared exponent.
+
+static inline uint32_t ConvertRgb9e5(const float* rgba) {
+	// Clamped, then the largest channel picks the exponent. Its mantissa may round up to 512, which needs one more.
+	float channels[3];
+	for (int channel = 0; channel < 3; channel++) { channels[channel] = rgba[channel] > 0.0f ? std::min(rgba[channel], RGB9E5_MAXIMUM) : 0.0f; }
+	float largest = std::max(std::max(channels[0], channels[1]), std::max(channels[2], RGB9E5_MINIMUM));
+	uint32_t exponentBits = FloatBits(largest) >> 23;
+	float scale = BitsFloat((262u - exponentBits) << 23);	// 2^(8 - exponent), so the largest lands in [256, 512).
+	uint32_t exponent = exponentBits - 111;	// Biased by 15, plus one for the 9 bit mantissas.
+	if (largest * scale + 0.5f >= 512.0f) {
+		scale *= 0.5f;
+		exponent++;
+	}
+	uint32_t packed = exponent << 27;
+	for (int channel = 0; channel < 3; channel++) { packed |= (uint32_t)(channels[channel] * scale + 0.5f) << (9 * channel); }
+	return packed;
+}
+
+void ImageConverterClass::RgbeToFloat(const unsigned char* source, float* destination, size_t pixels) {
+	size_t i = 0;
+#if defined(IMAGECONVERTER_FLOAT_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128 colorLanes = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	const __m128 alpha = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+	for (; i + 4 <= pixels; i += 4) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(source + i * 4));
+		__m128i words[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+		for (int k = 0; k < 4; k++) {
+			__m128i pixel = k % 2 == 0 ? _mm_unpacklo_epi16(words[k / 2], zero) : _mm_unpackhi_epi16(words[k / 2], zero);
+			__m128i exponent = _mm_shuffle_epi32(pixel, _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i scaleBits = _mm_and_si128(_mm_cmpgt_epi32(exponent, one), _mm_slli_epi32(_mm_sub_epi32(exponent, one), 23));
+			__m128 scale = _mm_mul_ps(_mm_castsi128_ps(scaleBits), _mm_set1_ps(1.0f / 256.0f));
+			__m128 value = _mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(pixel), _mm_set1_ps(0.5f)), scale);
+			_mm_storeu_ps(destination + (i + k) * 4, _mm_or_ps(_mm_and_ps(value, colorLanes), alpha));
+		}
+	}
+#endif
+	for (; i < pixels; i++) { ConvertRgbe(source + i * 4, destination + i * 4); }
+}
+
+void ImageConverterClass::FloatToHalf(const float* source, uint16_t* destination, size_t count) {
+	size_t i = 0;
+#if defined(IMAGECONVERTER_F16C)
+	for (; i + 4 <= count; i += 4) { _mm_storel_epi64((__m128i*)(destination + i), _mm_cvtps_ph(_mm_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT)); }
+#elif defined(IMAGECONVERTER_NEON_HALF)
+	for (; i + 4 <= count; i += 4) { vst1_u16(destination + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(source + i)))); }
+#elif defined(IMAGECONVERTER_FLOAT_SSE2)
+	// ConvertHalf on four values at once, the three cases are computed for all and then selected.
+	const __m128i absolute = _mm_set1_epi32(0x7FFFFFFF);
+	for (; i + 4 <= count; i += 4) {
+		__m128i bits = _mm_castps_si128(_mm_loadu_ps(source + i));
+		__m128i sign = _mm_srli_epi32(_mm_andnot_si128(absolute, bits), 16);
+		bits = _mm_and_si128(bits, absolute);
+		__m128i large = _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x477FFFFF));
+		__m128i nan = _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x7F800000));
+		__m128i small = _mm_cmplt_epi32(bits, _mm_set1_epi32(0x38800000));
+		__m128i overflowed = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(nan, _mm_set1_epi32(0x0200)));
+		__m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_set1_ps(0.5f))), _mm_set1_epi32(0x3F000000));
+		__m128i odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+		__m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32((int)0xC8000FFFu)), odd), 13);
+		__m128i half = _mm_or_si128(_mm_and_si128(small, denormal), _mm_andnot_si128(small, normal));
+		half = _mm_or_si128(_mm_and_si128(large, overflowed), _mm_andnot_si128(large, half));
+		half = _mm_or_si128(half, sign);
+		// Sign extended, so the saturating pack keeps all 16 bits.
+		half = _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+		_mm_storel_epi64((__m128i*)(destination + i), _mm_packs_epi32(half, half));
+	}
+#endif
+	for (; i < count; i++) { destination[i] = ConvertHalf(source[i]); }
+}
+
+void ImageConverterClass::FloatToRgb9e5(const float* source, uint32_t* destination, size_t pixels) {
+	size_t i = 0;
+#if defined(IMAGECONVERTER_FLOAT_SSE2)
+	// ConvertRgb9e5 on four pixels, transposed so each register holds one channel.
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 maximum = _mm_set1_ps(RGB9E5_MAXIMUM);
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (; i + 4 <= pixels; i += 4) {
+		__m128 red = _mm_loadu_ps(source + i * 4), green = _mm_loadu_ps(source + i * 4 + 4);
+		__m128 blue = _mm_loadu_ps(source + i * 4 + 8), alpha = _mm_loadu_ps(source + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(red, green, blue, alpha);
+		// The NaN checks come from max returning its second operand.
+		red = _mm_min_ps(_mm_max_ps(red, zero), maximum);
+		green = _mm_min_ps(_mm_max_ps(green, zero), maximum);
+		blue = _mm_min_ps(_mm_max_ps(blue, zero), maximum);
+		__m128 largest = _mm_max_ps(_mm_max_ps(red, green), _mm_max_ps(blue, _mm_set1_ps(RGB9E5_MINIMUM)));
+		__m128i exponentBits = _mm_srli_epi32(_mm_castps_si128(largest), 23);
+		__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(262), exponentBits), 23));
+		__m128 rounded = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(largest, scale), half), _mm_set1_ps(512.0f));
+		scale = _mm_mul_ps(scale, _mm_or_ps(_mm_and_ps(rounded, half), _mm_andnot_ps(rounded, _mm_set1_ps(1.0f))));
+		__m128i exponent = _mm_sub_epi32(_mm_sub_epi32(exponentBits, _mm_set1_epi32(111)), _mm_castps_si128(rounded));
+		__m128i packed = _mm_slli_epi32(exponent, 27);
+		packed = _mm_or_si128(packed, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(red, scale), half)));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(green, scale), half)), 9));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(blue, scale), half)), 18));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < pixels; i++) { destination[i] = ConvertRgb9e5(source + i * 4); }
+}
+
+float ImageConverterClass::HalfToFloat(uint16_t half) {
+	uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+	uint32_t exponent = (half >> 10) & 0x1Fu;
+	uint32_t mantissa = half & 0x3FFu;
+	if (exponent == 0) {
+		float value = mantissa * (1.0f / 16777216.0f);	// Denormals are mantissa * 2^-24.
+		return sign ? -value : value;
+	}
+	if (exponent == 0x1F) { return BitsFloat(sign | 0x7F800000u | mantissa << 13); }
+	return BitsFloat(sign | (exponent + 112) << 23 | mantissa << 13);
+}
+
+void ImageConverterClass::Rgb9e5ToFloat(uint32_t packed, float rgb[3]) {
+	// mantissa * 2^(exponent - 15 - 9)
+	float scale = BitsFloat((uint32_t)((packed >> 27) + 103) << 23);
+	for (int channel = 0; channel < 3; channel++) { rgb[channel] = ((packed >> (9 * channel)) & 0x1FFu) * scale; }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Pixel conversions for image loaders. Vectorized with AVX2, SSE2 or NEON when the compiler targets them.
+class ImageConverterClass {
+public:
+	// Swaps blue and red of 8-bit BGRA pixels. Source and destination may be the same.
+	static void BgraToRgba(const unsigned char* source, unsigned char* destination, size_t pixels);
+	// Same for a whole image in place, turning it upside down on the way when flip is set.
+	static void BgraToRgbaImage(unsigned char* pixels, size_t width, size_t height, bool flip);
+
+	// Radiance RGBE pixels to linear RGBA floats with alpha 1.
+	static void RgbeToFloat(const unsigned char* source, float* destination, size_t pixels);
+	// Floats to half floats for R16G16B16A16_FLOAT, rounded to nearest even. Too large values become infinity. Uses
+	// F16C or NEON where the compiler allows, integer SSE2 otherwise.
+	static void FloatToHalf(const float* source, uint16_t* destination, size_t count);
+	// RGBA floats to R9G9B9E5_SHAREDEXP, rounded to nearest. Alpha is dropped, negative values and NaN become 0 and
+	// anything above 65408 saturates, as the format cannot hold them.
+	static void FloatToRgb9e5(const float* source, uint32_t* destination, size_t pixels);
+	// The way back, for checking the above.
+	static float HalfToFloat(uint16_t half);
+	static void Rgb9e5ToFloat(uint32_t packed, float rgb[3]);
+};
@@ -0,0 +1,302 @@
+#include "inflateclass.hpp"
+#include <stdint.h>
+#include <string.h>
+
+static const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+	4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static constexpr int FAST_SIZE = 1 << InflateClass::FAST_BITS;
+static constexpr int MAX_CODE_LENGTH = 15;
+
+static bool Fail(std::string& error, const char* message) {
+	error = message;
+	return false;
+}
+
+static int ReverseBits(int value, int bits) {
+	int reversed = 0;
+	for (int i = 0; i < bits; i++, value >>= 1) { reversed = reversed << 1 | (value & 1); }
+	return reversed;
+}
+
+namespace {
+
+struct Huffman {
+	uint16_t fast[FAST_SIZE];	// Indexed by the next bits: length << 9 | symbol, 0 when the code is longer.
+	uint16_t firstCode[MAX_CODE_LENGTH + 1];
+	uint16_t firstSymbol[MAX_CODE_LENGTH + 1];
+	uint32_t maxCode[MAX_CODE_LENGTH + 2];	// End of the codes of each length, left aligned to 16 bits.
+	uint8_t lengths[288];	// In canonical order.
+	uint16_t symbols[288];
+	int count = 0;
+
+	bool Build(const uint8_t* codeLengths, int symbolCount) {
+		int sizes[MAX_CODE_LENGTH + 1] = {};
+		for (int i = 0; i < symbolCount; i++) { sizes[codeLengths[i]]++; }
+		sizes[0] = 0;
+
+		int nextCode[MAX_CODE_LENGTH + 1] = {};
+		int code = 0;
+		count = 0;
+		for (int length = 1; length <= MAX_CODE_LENGTH; length++) {
+			nextCode[length] = code;
+			firstCode[length] = (uint16_t)code;
+			firstSymbol[length] = (uint16_t)count;
+			code += sizes[length];
+			if (sizes[length] && code - 1 >= (1 << length)) { return false; }	// More codes than the length allows.
+			maxCode[length] = (uint32_t)code << (16 - length);
+			code <<= 1;
+			count += sizes[length];
+		}
+		maxCode[MAX_CODE_LENGTH + 1] = 0x10000;
+
+		memset(fast, 0, sizeof(fast));
+		for (int symbol = 0; symbol < symbolCount; symbol++) {
+			int length = codeLengths[symbol];
+			if (!length) { continue; }
+			int canonical = nextCode[length] - firstCode[length] + firstSymbol[length];
+			lengths[canonical] = (uint8_t)length;
+			symbols[canonical] = (uint16_t)symbol;
+			if (length <= InflateClass::FAST_BITS) {
+				// DEFLATE sends codes most significant bit first, the bit buffer is read from the bottom.
+				uint16_t entry = (uint16_t)(length << 9 | symbol);
+				for (int index = ReverseBits(nextCode[length], length); index < FAST_SIZE; index += 1 << length) { fast[index] = entry; }
+			}
+			nextCode[length]++;
+		}
+		return true;
+	}
+};
+
+struct BitReader {
+	const unsigned char* begin;
+	const unsigned char* source;
+	const unsigned char* end;
+	uint64_t bits = 0;
+	int count = 0;			// Valid bits at the bottom of bits.
+	size_t padding = 0;		// Zero bytes fed in past the end.
+
+	BitReader(const unsigned char* data, size_t size) : begin(data), source(data), end(data + size) {}
+
+	void Refill() {
+		if (end - source >= 8) {
+			uint64_t word;
+			memcpy(&word, source, 8);
+			bits |= word << count;
+			source += (63 - count) >> 3;
+			count |= 56;
+			return;
+		}
+		while (count <= 56) {
+			if (source < end) { bits |= (uint64_t)*source++ << count; }
+			else { padding++; }
+			count += 8;
+		}
+	}
+
+	uint32_t ReadBits(int n) {
+		if (count < n) { Refill(); }
+		uint32_t value = (uint32_t)(bits & ((1ull << n) - 1));
+		bits >>= n;
+		count -= n;
+		return value;
+	}
+
+	size_t Position() const { return (size_t)(source - begin) + padding - count / 8; }	// Whole bytes consumed.
+	bool Overrun() const { return Position() > (size_t)(end - begin); }
+
+	// Stored blocks start at a byte, the bytes still buffered go back to the input.
+	bool AlignToByte() {
+		size_t position = Position();
+		if (position > (size_t)(end - begin)) { return false; }
+		source = begin + position;
+		bits = 0;
+		count = 0;
+		padding = 0;
+		return true;
+	}
+};
+
+}
+
+static int DecodeSlow(BitReader& reader, const Huffman& huffman) {
+	int code = ReverseBits((int)(reader.bits & 0xFFFF), 16);
+	int length = InflateClass::FAST_BITS + 1;
+	while (length <= MAX_CODE_LENGTH && (uint32_t)code >= huffman.maxCode[length]) { length++; }
+	if (length > MAX_CODE_LENGTH) { return -1; }
+
+	int canonical = (code >> (16 - length)) - huffman.firstCode[length] + huffman.firstSymbol[length];
+	if (canonical < 0 || canonical >= huffman.count || huffman.lengths[canonical] != length) { return -1; }
+	reader.bits >>= length;
+	reader.count -= length;
+	return huffman.symbols[canonical];
+}
+
+static inline int Decode(BitReader& reader, const Huffman& huffman) {
+	if (reader.count < 16) { reader.Refill(); }
+	int entry = huffman.fast[reader.bits & (FAST_SIZE - 1)];
+	if (!entry) { return DecodeSlow(reader, huffman); }
+	int length = entry >> 9;
+	reader.bits >>= length;
+	reader.count -= length;
+	return entry & 511;
+}
+
+static const Huffman& FixedLiterals() {
+	static const Huffman table = [] {
+		uint8_t lengths[288];
+		memset(lengths, 8, 144);
+		memset(lengths + 144, 9, 112);
+		memset(lengths + 256, 7, 24);
+		memset(lengths + 280, 8, 8);
+		Huffman huffman;
+		huffman.Build(lengths, 288);
+		return huffman;
+	}();
+	return table;
+}
+
+static const Huffman& FixedDistances() {
+	static const Huffman table = [] {
+		uint8_t lengths[32];
+		memset(lengths, 5, 32);
+		Huffman huffman;
+		huffman.Build(lengths, 32);
+		return huffman;
+	}();
+	return table;
+}
+
+static bool ReadDynamicTables(BitReader& reader, Huffman& literals, Huffman& distances, std::string& error) {
+	int literalCount = (int)reader.ReadBits(5) + 257;
+	int distanceCount = (int)reader.ReadBits(5) + 1;
+	int codeLengthCount = (int)reader.ReadBits(4) + 4;
+	if (literalCount > 286 || distanceCount > 30) { return Fail(error, "too many length or distance codes"); }
+
+	uint8_t codeLengthLengths[19] = {};
+	for (int i = 0; i < codeLengthCount; i++) { codeLengthLengths[CODE_LENGTH_ORDER[i]] = (uint8_t)reader.ReadBits(3); }
+	Huffman codeLengths;
+	if (!codeLengths.Build(codeLengthLengths, 19)) { return Fail(error, "bad code length code"); }
+
+	uint8_t lengths[286 + 30];
+	int total = literalCount + distanceCount;
+	for (int n = 0; n < total;) {
+		int symbol = Decode(reader, codeLengths);
+		if (symbol < 0 || symbol > 18) { return Fail(error, "bad code length"); }
+		if (symbol < 16) {
+			lengths[n++] = (uint8_t)symbol;
+			continue;
+		}
+
+		uint8_t value = 0;
+		int repeat;
+		if (symbol == 16) {
+			if (n == 0) { return Fail(error, "repeat without a previous length"); }
+			value = lengths[n - 1];
+			repeat = 3 + (int)reader.ReadBits(2);
+		}
+		else if (symbol == 17) { repeat = 3 + (int)reader.ReadBits(3); }
+		else { repeat = 11 + (int)reader.ReadBits(7); }
+		if (n + repeat > total) { return Fail(error, "code lengths overflow"); }
+		memset(lengths + n, value, (size_t)repeat);
+		n += repeat;
+	}
+
+	if (lengths[256] == 0) { return Fail(error, "no end of block code"); }
+	if (!literals.Build(lengths, literalCount)) { return Fail(error, "bad literal code"); }
+	if (!distances.Build(lengths + literalCount, distanceCount)) { return Fail(error, "bad distance code"); }
+	return true;
+}
+
+static bool InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, unsigned char* start, unsigned char*& out,
+	unsigned char* end, std::string& error) {
+	while (true) {
+		int symbol = Decode(reader, literals);
+		if (symbol < 256) {
+			if (symbol < 0) { return Fail(error, "bad literal or length code"); }
+			if (out == end) { return Fail(error, "more data than expected"); }
+			*out++ = (unsigned char)symbol;
+			continue;
+		}
+		if (symbol == 256) { return true; }
+
+		symbol -= 257;
+		if (symbol >= 29) { return Fail(error, "bad length code"); }
+		size_t length = LENGTH_BASE[symbol] + reader.ReadBits(LENGTH_EXTRA[symbol]);
+		int distanceSymbol = Decode(reader, distances);
+		if (distanceSymbol < 0 || distanceSymbol >= 30) { return Fail(error, "bad distance code"); }
+		size_t distance = DISTANCE_BASE[distanceSymbol] + reader.ReadBits(DISTANCE_EXTRA[distanceSymbol]);
+		if (distance > (size_t)(out - start)) { return Fail(error, "distance too far back"); }
+		if (length > (size_t)(end - out)) { return Fail(error, "more data than expected"); }
+
+		const unsigned char* from = out - distance;
+		if (distance == 1) {
+			memset(out, *from, length);
+			out += length;
+		}
+		else if (distance >= 8 && (size_t)(end - out) >= length + 8) {
+			// Eight bytes at a time never overlap at this distance, the overshoot is rewritten by the next match.
+			unsigned char* stop = out + length;
+			do {
+				memcpy(out, from, 8);
+				out += 8;
+				from += 8;
+			} while (out < stop);
+			out = stop;
+		}
+		else {
+			while (length--) { *out++ = *from++; }
+		}
+	}
+}
+
+bool InflateClass::Inflate(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity, size_t& written, std::string& error) {
+	BitReader reader(source, size);
+	unsigned char* out = destination;
+	unsigned char* end = destination + capacity;
+	written = 0;
+
+	bool last = false;
+	while (!last) {
+		last = reader.ReadBits(1) != 0;
+		int type = (int)reader.ReadBits(2);
+		bool success = true;
+		if (type == 0) {
+			if (!reader.AlignToByte() || reader.end - reader.source < 4) { return Fail(error, "truncated stored block"); }
+			const unsigned char* header = reader.source;
+			size_t length = header[0] | header[1] << 8;
+			size_t check = header[2] | header[3] << 8;
+			if ((length ^ 0xFFFF) != check) { return Fail(error, "bad stored block length"); }
+			if ((size_t)(reader.end - header - 4) < length) { return Fail(error, "truncated stored block"); }
+			if ((size_t)(end - out) < length) { return Fail(error, "more data than expected"); }
+			memcpy(out, header + 4, length);
+			out += length;
+			reader.source = header + 4 + length;
+		}
+		else if (type == 1) { success = InflateBlock(reader, FixedLiterals(), FixedDistances(), destination, out, end, error); }
+		else if (type == 2) {
+			Huffman literals, distances;
+			success = ReadDynamicTables(reader, literals, distances, error) && InflateBlock(reader, literals, distances, destination, out, end, error);
+		}
+		else { return Fail(error, "bad block type"); }
+
+		written = (size_t)(out - destination);
+		if (reader.Overrun()) { return Fail(error, "truncated data"); }
+		if (!success) { return false; }
+	}
+	return true;
+}
+
+bool InflateClass::InflateZlib(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity, size_t& written, std::string& error) {
+	written = 0;
+	if (size < 2) { return Fail(error, "truncated zlib header"); }
+	int method = source[0] & 15;
+	int window = source[0] >> 4;
+	if (method != 8 || window > 7 || (source[0] << 8 | source[1]) % 31 != 0) { return Fail(error, "bad zlib header"); }
+	if (source[1] & 0x20) { return Fail(error, "preset dictionaries are not supported"); }
+	return Inflate(source + 2, size - 2, destination, capacity, written, error);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+
+// DEFLATE and zlib decompression into a buffer of known size. Huffman codes up to FAST_BITS long decode with one
+// table lookup, the rare longer ones fall back to a search over the canonical code.
+class InflateClass {
+public:
+	static constexpr int FAST_BITS = 10;
+
+	// Raw DEFLATE. Fails when the output would not fit, written tells how much of destination was filled.
+	static bool Inflate(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity, size_t& written, std::string& error);
+	// The same behind the two byte zlib header, as PNG stores it. The Adler-32 trailer is not checked.
+	static bool InflateZlib(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity, size_t& written, std::string& error);
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <d3d11.h>
+#include <vector>
+#include "vertexlayoutclass.hpp"
+
+struct InputElements {
+	D3D11_INPUT_ELEMENT_DESC elements[VertexLayout::MAX_ELEMENTS]{};
+	UINT count = 0;
+};
+
+// Makes the D3D input layouts from the vertex layouts, so the shaders read the vertices exactly where the cooker and
+// the vertex structs put them. Every element of a stream comes from the input slot of the same number.
+class InputLayoutClass {
+public:
+	static constexpr DXGI_FORMAT GetFormat(VertexElementFormat format) {
+		switch (format) {
+		case ELEMENT_FLOAT2: return DXGI_FORMAT_R32G32_FLOAT;
+		case ELEMENT_FLOAT3: return DXGI_FORMAT_R32G32B32_FLOAT;
+		case ELEMENT_FLOAT4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		case ELEMENT_HALF2: return DXGI_FORMAT_R16G16_FLOAT;
+		case ELEMENT_HALF4: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case ELEMENT_UNORM16X2: return DXGI_FORMAT_R16G16_UNORM;
+		case ELEMENT_SNORM16X2: return DXGI_FORMAT_R16G16_SNORM;
+		case ELEMENT_SNORM16X4: return DXGI_FORMAT_R16G16B16A16_SNORM;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	static constexpr LPCSTR GetSemanticName(VertexSemantic semantic) {
+		switch (semantic) {
+		case SEMANTIC_POSITION: return "POSITION";
+		case SEMANTIC_TEXCOORD: return "TEXCOORD";
+		case SEMANTIC_NORMAL: return "NORMAL";
+		case SEMANTIC_COLOR: return "COLOR";
+		}
+		return 0;
+	}
+
+	static constexpr InputElements GetElements(const VertexLayout& layout) {
+		InputElements input;
+		for (uint32_t i = 0; i < layout.elementCount; i++) {
+			const VertexElement& element = layout.elements[i];
+			D3D11_INPUT_ELEMENT_DESC& desc = input.elements[input.count++];
+			desc.SemanticName = GetSemanticName(element.semantic);
+			desc.SemanticIndex = 0;
+			desc.Format = GetFormat(element.format);
+			desc.InputSlot = element.stream;
+			desc.AlignedByteOffset = element.offset;
+			desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			desc.InstanceDataStepRate = 0;
+		}
+		return input;
+	}
+
+	// For the vertex shader compiled to bytecode, E_INVALIDARG for a layout that failed to build.
+	static HRESULT Create(ID3D11Device* device, const VertexLayout& layout, const std::vector<unsigned char>& bytecode, ID3D11InputLayout** inputLayout) {
+		if (!layout.isValid) { return E_INVALIDARG; }
+		InputElements input = GetElements(layout);
+		return device->CreateInputLayout(input.elements, input.count, bytecode.data(), bytecode.size(), inputLayout);
+	}
+};
+
+static_assert(InputLayoutClass::GetElements(VertexLayoutChecks::SPLIT).count == 3);
+static_assert(InputLayoutClass::GetElements(VertexLayoutChecks::SPLIT).elements[0].Format == DXGI_FORMAT_R16G16B16A16_SNORM);
+static_assert(InputLayoutClass::GetElements(VertexLayoutChecks::SPLIT).elements[2].InputSlot == 1
+	&& InputLayoutClass::GetElements(VertexLayoutChecks::SPLIT).elements[2].AlignedByteOffset == 4);
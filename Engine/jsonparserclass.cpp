@@ -0,0 +1,212 @@
+#include "jsonparserclass.hpp"
+#include <string.h>
+#include <charconv>
+
+const JsonValue* JsonValue::Find(const char* key) const {
+	if (type != JSON_OBJECT) { return 0; }
+	for (const auto& member : members) {
+		if (member.first == key) { return &member.second; }
+	}
+	return 0;
+}
+
+double JsonValue::GetNumber(const char* key, double fallback) const {
+	const JsonValue* value = Find(key);
+	return value && value->type == JSON_NUMBER ? value->number : fallback;
+}
+
+const std::string& JsonValue::GetString(const char* key) const {
+	static const std::string empty;
+	const JsonValue* value = Find(key);
+	return value && value->type == JSON_STRING ? value->string : empty;
+}
+
+bool JsonParserClass::Parse(const char* text, size_t size, JsonValue& root) {
+	m_text = text;
+	m_size = size;
+	m_position = 0;
+	m_error.clear();
+
+	// A UTF-8 byte order mark is tolerated, the spec leaves that to the reader.
+	if (size >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0) { m_position = 3; }
+
+	root = JsonValue();
+	if (!ParseValue(root, 0)) { return false; }
+	SkipWhitespace();
+	if (m_position != m_size) { return Fail("unexpected text after the document"); }
+	return true;
+}
+
+bool JsonParserClass::ParseValue(JsonValue& value, int depth) {
+	if (depth > MAX_DEPTH) { return Fail("nested too deeply"); }
+	SkipWhitespace();
+	if (m_position == m_size) { return Fail("unexpected end of the document"); }
+
+	char c = m_text[m_position];
+	if (c == '{') {
+		value.type = JsonValue::JSON_OBJECT;
+		m_position++;
+		SkipWhitespace();
+		if (m_position < m_size && m_text[m_position] == '}') {
+			m_position++;
+			return true;
+		}
+		while (true) {
+			SkipWhitespace();
+			value.members.emplace_back();
+			if (!ParseString(value.members.back().first)) { return false; }
+			SkipWhitespace();
+			if (m_position == m_size || m_text[m_position] != ':') { return Fail("expected ':'"); }
+			m_position++;
+			if (!ParseValue(value.members.back().second, depth + 1)) { return false; }
+
+			SkipWhitespace();
+			if (m_position < m_size && m_text[m_position] == ',') {
+				m_position++;
+				continue;
+			}
+			if (m_position < m_size && m_text[m_position] == '}') {
+				m_position++;
+				return true;
+			}
+			return Fail("expected ',' or '}'");
+		}
+	}
+	if (c == '[') {
+		value.type = JsonValue::JSON_ARRAY;
+		m_position++;
+		SkipWhitespace();
+		if (m_position < m_size && m_text[m_position] == ']') {
+			m_position++;
+			return true;
+		}
+		while (true) {
+			value.items.emplace_back();
+			if (!ParseValue(value.items.back(), depth + 1)) { return false; }
+
+			SkipWhitespace();
+			if (m_position < m_size && m_text[m_position] == ',') {
+				m_position++;
+				continue;
+			}
+			if (m_position < m_size && m_text[m_position] == ']') {
+				m_position++;
+				return true;
+			}
+			return Fail("expected ',' or ']'");
+		}
+	}
+	if (c == '"') {
+		value.type = JsonValue::JSON_STRING;
+		return ParseString(value.string);
+	}
+	if (c == 't' || c == 'f') {
+		value.type = JsonValue::JSON_BOOL;
+		value.boolean = c == 't';
+		return ParseLiteral(c == 't' ? "true" : "false");
+	}
+	if (c == 'n') {
+		value.type = JsonValue::JSON_NULL;
+		return ParseLiteral("null");
+	}
+	value.type = JsonValue::JSON_NUMBER;
+	return ParseNumber(value.number);
+}
+
+bool JsonParserClass::ParseString(std::string& result) {
+	if (m_position == m_size || m_text[m_position] != '"') { return Fail("expected a string"); }
+	m_position++;
+
+	result.clear();
+	while (m_position < m_size) {
+		char c = m_text[m_position++];
+		if (c == '"') { return true; }
+		if ((unsigned char)c < 0x20) { return Fail("control character in a string"); }
+		if (c != '\\') {
+			result += c;
+			continue;
+		}
+
+		if (m_position == m_size) { break; }
+		char escape = m_text[m_position++];
+		switch (escape) {
+		case '"': result += '"'; break;
+		case '\\': result += '\\'; break;
+		case '/': result += '/'; break;
+		case 'b': result += '\b'; break;
+		case 'f': result += '\f'; break;
+		case 'n': result += '\n'; break;
+		case 'r': result += '\r'; break;
+		case 't': result += '\t'; break;
+		case 'u': {
+			auto hex = [&](unsigned int& code) {
+				if (m_size - m_position < 4) { return false; }
+				auto parsed = std::from_chars(m_text + m_position, m_text + m_position + 4, code, 16);
+				if (parsed.ec != std::errc() || parsed.ptr != m_text + m_position + 4) { return false; }
+				m_position += 4;
+				return true;
+			};
+			unsigned int code = 0;
+			if (!hex(code)) { return Fail("invalid \\u escape"); }
+			if (code >= 0xD800 && code < 0xDC00) {	// Surrogate pair.
+				unsigned int low = 0;
+				if (m_size - m_position < 2 || m_text[m_position] != '\\' || m_text[m_position + 1] != 'u') { return Fail("unpaired surrogate"); }
+				m_position += 2;
+				if (!hex(low) || low < 0xDC00 || low > 0xDFFF) { return Fail("unpaired surrogate"); }
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+			}
+
+			// Back to UTF-8.
+			if (code < 0x80) { result += (char)code; }
+			else if (code < 0x800) {
+				result += (char)(0xC0 | (code >> 6));
+				result += (char)(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000) {
+				result += (char)(0xE0 | (code >> 12));
+				result += (char)(0x80 | ((code >> 6) & 0x3F));
+				result += (char)(0x80 | (code & 0x3F));
+			}
+			else {
+				result += (char)(0xF0 | (code >> 18));
+				result += (char)(0x80 | ((code >> 12) & 0x3F));
+				result += (char)(0x80 | ((code >> 6) & 0x3F));
+				result += (char)(0x80 | (code & 0x3F));
+			}
+			break;
+		}
+		default: return Fail("invalid escape in a string");
+		}
+	}
+	return Fail("unterminated string");
+}
+
+bool JsonParserClass::ParseNumber(double& result) {
+	// from_chars takes neither a leading '+' nor hex, which matches the JSON grammar closely enough.
+	auto parsed = std::from_chars(m_text + m_position, m_text + m_size, result);
+	if (parsed.ec != std::errc() || parsed.ptr == m_text + m_position) { return Fail("expected a value"); }
+	m_position = parsed.ptr - m_text;
+	return true;
+}
+
+bool JsonParserClass::ParseLiteral(const char* literal) {
+	size_t length = strlen(literal);
+	if (m_size - m_position < length || memcmp(m_text + m_position, literal, length) != 0) { return Fail("expected a value"); }
+	m_position += length;
+	return true;
+}
+
+void JsonParserClass::SkipWhitespace() {
+	while (m_position < m_size) {
+		char c = m_text[m_position];
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r') { return; }
+		m_position++;
+	}
+}
+
+bool JsonParserClass::Fail(const char* message) {
+	size_t line = 1;
+	for (size_t i = 0; i < m_position && i < m_size; i++) { line += m_text[i] == '\n'; }
+	m_error = "line " + std::to_string(line) + ": " + message;
+	return false;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A parsed JSON document. Objects keep their members in file order, lookups are linear which is fine for the
+// small documents this is used for (glTF scene descriptions).
+struct JsonValue {
+	enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+	Type type = JSON_NULL;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> items;
+	std::vector<std::pair<std::string, JsonValue>> members;
+
+	const JsonValue* Find(const char* key) const;	// 0 when this is not an object or has no such member.
+	size_t Size() const { return type == JSON_ARRAY ? items.size() : 0; }
+	const JsonValue& operator[](size_t i) const { return items[i]; }
+	bool IsNumber() const { return type == JSON_NUMBER; }
+
+	// Member lookups with a fallback for missing or mistyped values.
+	double GetNumber(const char* key, double fallback) const;
+	const std::string& GetString(const char* key) const;
+};
+
+class JsonParserClass {
+public:
+	bool Parse(const char* text, size_t size, JsonValue& root);
+	const std::string& GetError() const { return m_error; }	// "line N: message" of the first problem found.
+
+private:
+	bool ParseValue(JsonValue& value, int depth);
+	bool ParseString(std::string& result);
+	bool ParseNumber(double& result);
+	bool ParseLiteral(const char* literal);
+	void SkipWhitespace();
+	bool Fail(const char* message);
+
+	static constexpr int MAX_DEPTH = 256;
+
+	const char* m_text = 0;
+	size_t m_size = 0;
+	size_t m_position = 0;
+	std::string m_error;
+};
@@ -1,33 +1,70 @@
-cbuffer MatrixBuffer {
-    matrix worldMatrix;
-    matrix viewMatrix;
-    matrix projectionMatrix;
+// Split by how often they change, see LightShaderClass. Row major, so the matrices go up as DirectXMath keeps them.
+cbuffer FrameBuffer : register(b0) {
+    row_major matrix viewProjectionMatrix;
+};
+
+// The texture region the material samples, in the texture's shared slice.
+cbuffer MaterialBuffer : register(b1) {
+    float4 regionScaleBias;
+    float textureSlice;
+    float3 materialPadding;
+};
+
+// A window of the constant ring. The dequantization undoes the cooked vertex quantization, see MeshVertexFormat.
+cbuffer ObjectBuffer : register(b2) {
+    row_major matrix worldMatrix;
+    float4 positionScale;
+    float4 positionBias;
+    float4 texcoordScaleBias;   // xy scale, zw bias.
 };
 
 struct VertexInputType {
     float4 position : POSITION;
     float2 tex : TEXCOORD0;
+#ifdef NORMAL_OCTAHEDRAL
+    float2 normal : NORMAL;
+#else
     float3 normal : NORMAL;
+#endif
 };
 
 struct PixelInputType {
     float4 position : SV_POSITION;
-    float2 tex : TEXCOORD0;
+    float3 tex : TEXCOORD0;     // z is the array slice.
     float3 normal : NORMAL;
+    float3 worldPosition : TEXCOORD1;   // For the specular highlight and the fog, see light.ps.
 };
 
+// Mirrors VertexEncoderClass::OctahedralDecode.
+float3 OctahedralDecode(float2 encoded)
+{
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0f) {
+        normal.xy = (1.0f - abs(normal.yx)) * (normal.xy >= 0.0f ? 1.0f : -1.0f);
+    }
+    return normalize(normal);
+}
+
 PixelInputType LightVertexShader(VertexInputType input)
 {
+    input.position.xyz = input.position.xyz * positionScale.xyz + positionBias.xyz;
+    input.tex = input.tex * texcoordScaleBias.xy + texcoordScaleBias.zw;
+    input.tex = input.tex * regionScaleBias.xy + regionScaleBias.zw;
     // Change the position vector to be 4 units for proper matrix calculations.
     input.position.w = 1.0f;
+#ifdef NORMAL_OCTAHEDRAL
+    float3 normal = OctahedralDecode(input.normal);
+#else
+    float3 normal = input.normal;
+#endif
 
-    // Calculate the position of the vertex against the world, view, and projection matrices.
+    // Calculate the position of the vertex against the world matrix and the view and projection, combined once a frame.
     PixelInputType output;
     output.position = mul(input.position, worldMatrix);
-    output.position = mul(output.position, viewMatrix);
-    output.position = mul(output.position, projectionMatrix);
-    output.tex = input.tex; // Store the texture coordinates for the pixel shader.
-    output.normal = mul(input.normal, (float3x3)worldMatrix);   // Calculate the normal vector against the world matrix only.
+    output.worldPosition = output.position.xyz;
+    output.position = mul(output.position, viewProjectionMatrix);
+    output.tex = float3(input.tex, textureSlice); // Store the texture coordinates for the pixel shader.
+    output.normal = mul(normal, (float3x3)worldMatrix);   // Calculate the normal vector against the world matrix only.
     output.normal = normalize(output.normal);   // Normalize the normal vector.
 
     return output;
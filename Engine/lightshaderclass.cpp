@@ -1,100 +1,81 @@
 #include "lightshaderclass.hpp"
+#include <string.h>
 
-bool LightShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix,
-		ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor)
+bool LightShaderClass::Render(RenderStateClass& states, ConstantRingClass& ring, ShaderKey key, int indexCount, XMMATRIX worldMatrix,
+		ID3D11ShaderResourceView* texture, const TextureRegion& region, const MeshVertexFormat& format)
 {
-	bool result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, diffuseColor); // Set the shader parameters that it will use for rendering.
-	if (result) { RenderShader(deviceContext, indexCount); }
-	return result;
+	vector<IndexRange> ranges = { { 0, (uint32_t)indexCount } };
+	return Render(states, ring, key, ranges, worldMatrix, texture, region, format);
 }
 
-LightShaderClass::LightShaderClass(ID3D11Device* device, HWND hwnd){
-	isInitialized = SetVertexBuffer(device, hwnd) 
-		&& SetPixelBuffer(device, hwnd) 
-		&& SetSamplerDesc(device) 
-		&& SetMatrixBuffer(device) 
-		&& SetLightBufferDesc(device);
+bool LightShaderClass::Render(RenderStateClass& states, ConstantRingClass& ring, ShaderKey key, const vector<IndexRange>& ranges, XMMATRIX worldMatrix,
+		ID3D11ShaderResourceView* texture, const TextureRegion& region, const MeshVertexFormat& format)
+{
+	if (!HasKey(key)) { return false; }
+	bool result = SetShaderParameters(states, ring, worldMatrix, texture, region, format); // Set the shader parameters that it will use for rendering.
+	if (result) { RenderShader(states, key, ranges); }
+	return result;
 }
-bool LightShaderClass::SetVertexBuffer(ID3D11Device* device, HWND hwnd) {
-	ID3D10Blob* errorMessage{};
-	ID3D10Blob* vertexShaderBuffer = 0;
-	HRESULT result = D3DCompileFromFile(vsFilename, NULL, NULL, "LightVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &vertexShaderBuffer, &errorMessage);
-	if (FAILED(result)) {
-		if (errorMessage) { OutputShaderErrorMessage(errorMessage, hwnd, vsFilename); }
-		else { MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK); }
-		return false;
-	}
-
-	result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
-	if (FAILED(result)) { return false; }
 
-	result = VertexInputLayout(device, vertexShaderBuffer);
-	if (FAILED(result)) { return false; }
-
-	vertexShaderBuffer->Release();
-	vertexShaderBuffer = 0;
+LightShaderClass::LightShaderClass(ID3D11Device* device, HWND hwnd, const MeshVertexFormat& format, const vector<ShaderKey>& keys,
+	StateObjectCacheClass& stateObjects, ShaderCacheClass* cache){
+	vector<ShaderCompileRequest> requests = GetCompileRequests(format, keys);
+	if (cache) { cache->Prefetch(requests); }	// Every permutation compiles at once, the ones already prefetched are not queued again.
+	isInitialized = SetVertexBuffer(device, hwnd, requests[0], cache, format) 
+		&& SetSamplerDesc(stateObjects) 
+		&& SetConstantBuffers(device);
+	for (size_t i = 0; i < keys.size() && isInitialized; i++) {
+		isInitialized = keys[i].IsValid() && SetPixelBuffer(device, hwnd, keys[i], requests[1 + i], cache);
+	}
+}
 
-	return true;
+vector<ShaderCompileRequest> LightShaderClass::GetCompileRequests(const MeshVertexFormat& format, const vector<ShaderKey>& keys) {
+	vector<ShaderCompileRequest> requests;
+	ShaderCompileRequest vertexShaderRequest{ VERTEX_SHADER_FILENAME, "LightVertexShader", "vs_5_0", {}, D3D10_SHADER_ENABLE_STRICTNESS };
+	// Octahedral normals arrive as two components and are unfolded in the shader.
+	if (format.encoding.normal == NORMAL_OCT16) { vertexShaderRequest.defines.push_back({ "NORMAL_OCTAHEDRAL", "1" }); }
+	requests.push_back(vertexShaderRequest);
+	for (ShaderKey key : keys) {
+		requests.push_back({ PIXEL_SHADER_FILENAME, "LightPixelShader", "ps_5_0", ShaderPermutationClass::GetDefines(key), D3D10_SHADER_ENABLE_STRICTNESS });
+	}
+	return requests;
 }
 
-bool LightShaderClass::SetPixelBuffer(ID3D11Device* device, HWND hwnd) {
-	ID3D10Blob* errorMessage{};
-	ID3D10Blob* pixelShaderBuffer = 0;
-	HRESULT result = D3DCompileFromFile(psFilename, NULL, NULL, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pixelShaderBuffer, &errorMessage);
-	if (FAILED(result)) {
-		if (errorMessage) { OutputShaderErrorMessage(errorMessage, hwnd, psFilename); }
-		else { MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK); }
+bool LightShaderClass::SetVertexBuffer(ID3D11Device* device, HWND hwnd, const ShaderCompileRequest& request, ShaderCacheClass* cache,
+	const MeshVertexFormat& format) {
+	vector<unsigned char> bytecode;
+	string errorMessage;
+	if (!ShaderCacheClass::Compile(cache, request, bytecode, errorMessage)) {
+		OutputShaderErrorMessage(errorMessage, hwnd, request.filename);
 		return false;
 	}
 
-	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader);
+	HRESULT result = device->CreateVertexShader(bytecode.data(), bytecode.size(), NULL, &vertexShader);
 	if (FAILED(result)) { return false; }
 
-	pixelShaderBuffer->Release();
-	pixelShaderBuffer = 0;
-
-	return true;
+	result = VertexInputLayout(device, bytecode, format);
+	return !FAILED(result);
 }
 
-HRESULT LightShaderClass::VertexInputLayout(ID3D11Device* device, ID3D10Blob* vertexShaderBuffer) {
-	// This setup needs to match the VertexType stucture in the ModelClass and in the shader.
-	auto pLayout_position = SetPolygon("POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0);
-	auto pLayout_tex = SetPolygon("TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0);
-	auto pLayout_normal = SetPolygon("NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0);
-	D3D11_INPUT_ELEMENT_DESC polygonLayout[3] = { pLayout_position, pLayout_tex, pLayout_normal };
-	unsigned int numElements = sizeof(polygonLayout) / sizeof(pLayout_position);
-
-	return device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(),
-		vertexShaderBuffer->GetBufferSize(), &layout);
-}
+bool LightShaderClass::SetPixelBuffer(ID3D11Device* device, HWND hwnd, ShaderKey key, const ShaderCompileRequest& request, ShaderCacheClass* cache) {
+	if (pixelShaders[key.bits]) { return true; }	// Asked for twice.
+	vector<unsigned char> bytecode;
+	string errorMessage;
+	if (!ShaderCacheClass::Compile(cache, request, bytecode, errorMessage)) {
+		OutputShaderErrorMessage(errorMessage, hwnd, request.filename);
+		return false;
+	}
 
-D3D11_INPUT_ELEMENT_DESC LightShaderClass::SetPolygon(LPCSTR name, UINT index, DXGI_FORMAT format, UINT inputSlot, UINT offset, D3D11_INPUT_CLASSIFICATION slotClass, UINT stepRate) {
-	D3D11_INPUT_ELEMENT_DESC p;
-	p.SemanticName = name;
-	p.SemanticIndex = index;
-	p.Format = format;
-	p.InputSlot = inputSlot;
-	p.AlignedByteOffset = offset;
-	p.InputSlotClass = slotClass;
-	p.InstanceDataStepRate = stepRate;
-	return p;
+	HRESULT result = device->CreatePixelShader(bytecode.data(), bytecode.size(), NULL, &pixelShaders[key.bits]);
+	return !FAILED(result);
 }
 
-bool LightShaderClass::SetMatrixBuffer(ID3D11Device* device) {
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	D3D11_BUFFER_DESC matrixBufferDesc{};
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	HRESULT result = device->CreateBuffer(&matrixBufferDesc, NULL, &matrixBuffer);
-	return !FAILED(result);
+HRESULT LightShaderClass::VertexInputLayout(ID3D11Device* device, const vector<unsigned char>& bytecode, const MeshVertexFormat& format) {
+	// The cooker stored the vertices as the encoding describes them.
+	return InputLayoutClass::Create(device, VertexEncoderClass::Describe(format.encoding), bytecode, &layout);
 }
 
-bool LightShaderClass::SetSamplerDesc(ID3D11Device* device) {
+bool LightShaderClass::SetSamplerDesc(StateObjectCacheClass& stateObjects) {
 	D3D11_SAMPLER_DESC samplerDesc{};
 	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
 	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -110,71 +91,93 @@ bool LightShaderClass::SetSamplerDesc(ID3D11Device* device) {
 	samplerDesc.MinLOD = 0;
 	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
 
-	// Create the texture sampler state.
-	HRESULT result = device->CreateSamplerState(&samplerDesc, &sampleState);
-	return !FAILED(result);
+	// Shared with every other shader sampling the same way.
+	sampleState = stateObjects.GetSamplerState(samplerDesc);
+	return sampleState != 0;
 }
 
-bool LightShaderClass::SetLightBufferDesc(ID3D11Device* device) {
-	// Setup the description of the light dynamic constant buffer that is in the pixel shader.
+bool LightShaderClass::SetConstantBuffers(ID3D11Device* device) {
+	// The mirrors have to place every member where HLSL packs it.
+	static_assert([] {
+		ConstantLayout layout;
+		return layout.Add(sizeof(XMMATRIX), true) == offsetof(FrameBufferType, viewProjection) && layout.Size() == sizeof(FrameBufferType);
+	}());
+	static_assert([] {
+		ConstantLayout layout;
+		return layout.Add(sizeof(LightBufferType::directions), true) == offsetof(LightBufferType, directions)
+			&& layout.Add(sizeof(LightBufferType::colors), true) == offsetof(LightBufferType, colors)
+			&& layout.Add(sizeof(XMFLOAT4)) == offsetof(LightBufferType, ambientColor) && layout.Add(sizeof(XMFLOAT4)) == offsetof(LightBufferType, fogColor)
+			&& layout.Add(sizeof(XMFLOAT3)) == offsetof(LightBufferType, cameraPosition) && layout.Add(sizeof(float)) == offsetof(LightBufferType, specularPower)
+			&& layout.Add(sizeof(float)) == offsetof(LightBufferType, fogStart) && layout.Add(sizeof(float)) == offsetof(LightBufferType, fogScale)
+			&& layout.Add(sizeof(float)) == offsetof(LightBufferType, alphaReference) && layout.Add(sizeof(float)) == offsetof(LightBufferType, padding)
+			&& layout.Size() == sizeof(LightBufferType);
+	}());
+	static_assert([] {
+		ConstantLayout layout;
+		return layout.Add(sizeof(XMFLOAT4)) == offsetof(MaterialBufferType, regionScaleBias) && layout.Add(sizeof(float)) == offsetof(MaterialBufferType, textureSlice)
+			&& layout.Add(sizeof(XMFLOAT3)) == offsetof(MaterialBufferType, padding) && layout.Size() == sizeof(MaterialBufferType);
+	}());
+	static_assert([] {
+		ConstantLayout layout;
+		return layout.Add(sizeof(XMMATRIX), true) == offsetof(ObjectBufferType, world) && layout.Add(sizeof(XMFLOAT4)) == offsetof(ObjectBufferType, positionScale)
+			&& layout.Add(sizeof(XMFLOAT4)) == offsetof(ObjectBufferType, positionBias) && layout.Add(sizeof(XMFLOAT4)) == offsetof(ObjectBufferType, texcoordScaleBias)
+			&& layout.Size() == sizeof(ObjectBufferType);
+	}());
+
+	// The per object constants live in the ring, these change a few times a frame at most.
 	// Note that ByteWidth always needs to be a multiple of 16 if using D3D11_BIND_CONSTANT_BUFFER or CreateBuffer will fail.
-	D3D11_BUFFER_DESC lightBufferDesc{};
-	lightBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	lightBufferDesc.ByteWidth = sizeof(LightBufferType);
-	lightBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	lightBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	lightBufferDesc.MiscFlags = 0;
-	lightBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	HRESULT result = device->CreateBuffer(&lightBufferDesc, NULL, &lightBuffer);
-	return !FAILED(result);
-}
+	D3D11_BUFFER_DESC bufferDesc{};
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	bufferDesc.ByteWidth = sizeof(FrameBufferType);
+	HRESULT result = device->CreateBuffer(&bufferDesc, NULL, &frameBuffer);
+	if (FAILED(result)) { return false; }
 
-void LightShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename) {
-	if (!errorMessage) {
-		MessageBox(hwnd, shaderFilename, L"Missing Shader File", MB_OK);
-		return;
-	}
+	bufferDesc.ByteWidth = sizeof(LightBufferType);
+	result = device->CreateBuffer(&bufferDesc, NULL, &lightBuffer);
+	if (FAILED(result)) { return false; }
 
-	char* compileErrors = (char*)(errorMessage->GetBufferPointer());
-	unsigned long long bufferSize = errorMessage->GetBufferSize();
+	bufferDesc.ByteWidth = sizeof(MaterialBufferType);
+	result = device->CreateBuffer(&bufferDesc, NULL, &materialBuffer);
+	return !FAILED(result);
+}
 
+void LightShaderClass::OutputShaderErrorMessage(const string& message, HWND hwnd, const string& shaderFilename) {
+	errorMessage = shaderFilename + ": " + message;
 	ofstream fout;
 	fout.open("shader-error.txt");
-
-	for (unsigned long long i = 0; i < bufferSize; i++) {
-		fout << compileErrors[i];
-	}
-
+	fout << message;
 	fout.close();
 
-	errorMessage->Release();
-	errorMessage = 0;
-
-	MessageBox(hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK);
+	if (hwnd) { MessageBoxA(hwnd, "Error compiling shader.  Check shader-error.txt for message.", shaderFilename.c_str(), MB_OK); }
 }
 
 LightShaderClass::~LightShaderClass() {
+	if (materialBuffer) {
+		materialBuffer->Release();
+		materialBuffer = 0;
+	}
 	if (lightBuffer){
 		lightBuffer->Release();
 		lightBuffer = 0;
 	}
-	if (matrixBuffer)	{
-		matrixBuffer->Release();
-		matrixBuffer = 0;
-	}
-	if (sampleState)	{
-		sampleState->Release();
-		sampleState = 0;
+	if (frameBuffer)	{
+		frameBuffer->Release();
+		frameBuffer = 0;
 	}
 	if (layout)	{
 		layout->Release();
 		layout = 0;
 	}
-	if (pixelShader) {
-		pixelShader->Release();
-		pixelShader = 0;
+	for (ID3D11PixelShader*& pixelShader : pixelShaders) {
+		if (pixelShader) {
+			pixelShader->Release();
+			pixelShader = 0;
+		}
 	}
 	if (vertexShader) {
 		vertexShader->Release();
@@ -182,50 +185,89 @@ LightShaderClass::~LightShaderClass() {
 	}
 }
 
-bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix,
-	ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor)
-{
-	// Transpose the matrices to prepare them for the shader.
-	worldMatrix = XMMatrixTranspose(worldMatrix);
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
+bool LightShaderClass::SetFrameParameters(RenderStateClass& states, XMMATRIX viewProjectionMatrix, XMFLOAT3 cameraPosition, const SceneLighting& lighting) {
+	ID3D11DeviceContext* deviceContext = states.GetContext();
 	D3D11_MAPPED_SUBRESOURCE mappedResource;	// Lock the constant buffer so it can be written to.
-	HRESULT result = deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	HRESULT result = deviceContext->Map(frameBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	if (FAILED(result)) { return false; }
-	
-	MatrixBufferType* dataPtr = (MatrixBufferType*)mappedResource.pData;
-	dataPtr->world = worldMatrix;
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-	
-	deviceContext->Unmap(matrixBuffer, 0);	// Unlock the constant buffer.
-	unsigned int bufferNumber = 0;
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &matrixBuffer);	// Set the constant buffer in the vertex shader with the updated values.
-	deviceContext->PSSetShaderResources(0, 1, &texture);	// Set shader texture resource in the pixel shader.
 
+	FrameBufferType* dataPtr = (FrameBufferType*)mappedResource.pData;
+	dataPtr->viewProjection = viewProjectionMatrix;
+	deviceContext->Unmap(frameBuffer, 0);	// Unlock the constant buffer.
 
 	// Lock the light constant buffer so it can be written to.
 	result = deviceContext->Map(lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	if (FAILED(result)) { return false; }
 	
 	LightBufferType* dataPtr2 = (LightBufferType*)mappedResource.pData;	// Get a pointer to the data in the constant buffer.
-	dataPtr2->diffuseColor = diffuseColor;
-	dataPtr2->lightDirection = lightDirection;
+	for (uint32_t i = 0; i < ShaderKey::MAX_LIGHTS; i++) {
+		const XMFLOAT3& direction = lighting.directions[i];
+		dataPtr2->directions[i] = XMFLOAT4(direction.x, direction.y, direction.z, 0.0f);
+		dataPtr2->colors[i] = lighting.colors[i];
+	}
+	dataPtr2->ambientColor = lighting.ambientColor;
+	dataPtr2->fogColor = lighting.fogColor;
+	dataPtr2->cameraPosition = cameraPosition;
+	dataPtr2->specularPower = lighting.specularPower;
+	dataPtr2->fogStart = lighting.fogStart;
+	dataPtr2->fogScale = lighting.fogEnd > lighting.fogStart ? 1.0f / (lighting.fogEnd - lighting.fogStart) : 0.0f;
+	dataPtr2->alphaReference = lighting.alphaReference;
 	dataPtr2->padding = 0.0f;
 
 	deviceContext->Unmap(lightBuffer, 0);
-	bufferNumber = 0;	// Set the position of the light constant buffer in the pixel shader.
-	deviceContext->PSSetConstantBuffers(bufferNumber, 1, &lightBuffer);
+	return true;
+}
+
+bool LightShaderClass::SetMaterialParameters(RenderStateClass& states, const TextureRegion& region) {
+	// Objects sharing a texture share its region, so most draws find it in the buffer already.
+	MaterialBufferType next{};
+	next.regionScaleBias = XMFLOAT4(region.scaleBias);
+	next.textureSlice = (float)region.slice;
+	next.padding = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	if (materialKnown && memcmp(&next, &material, sizeof(next)) == 0) { return true; }
+
+	ID3D11DeviceContext* deviceContext = states.GetContext();
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	materialKnown = false;
+	HRESULT result = deviceContext->Map(materialBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result)) { return false; }
+
+	*(MaterialBufferType*)mappedResource.pData = next;
+	deviceContext->Unmap(materialBuffer, 0);
+	material = next;
+	materialKnown = true;
+	return true;
+}
 
+bool LightShaderClass::SetShaderParameters(RenderStateClass& states, ConstantRingClass& ring, XMMATRIX worldMatrix, ID3D11ShaderResourceView* texture,
+	const TextureRegion& region, const MeshVertexFormat& format)
+{
+	if (!SetMaterialParameters(states, region)) { return false; }
+
+	// Row major like the shader reads it, so nothing is transposed.
+	ObjectBufferType object;
+	object.world = worldMatrix;
+	object.positionScale = XMFLOAT4(format.positionScale);
+	object.positionBias = XMFLOAT4(format.positionBias);
+	object.texcoordScaleBias = XMFLOAT4(format.texcoordScaleBias);
+	ConstantAllocation allocation;
+	if (!ring.Write(object, allocation)) { return false; }
+
+	states.SetVertexConstantBuffer(0, frameBuffer);
+	states.SetVertexConstantBuffer(1, materialBuffer);
+	states.SetVertexConstantBuffer(2, allocation.buffer, allocation.firstConstant, allocation.constantCount);
+	states.SetPixelConstantBuffer(0, lightBuffer);	// Set the position of the light constant buffer in the pixel shader.
+	states.SetPixelShaderResource(0, texture);	// Set shader texture resource in the pixel shader.
 	return true;
 }
 
-void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount) {
-	deviceContext->IASetInputLayout(layout);	// Set the vertex input layout.
+void LightShaderClass::RenderShader(RenderStateClass& states, ShaderKey key, const vector<IndexRange>& ranges) {
+	states.SetInputLayout(layout);	// Set the vertex input layout.
 	// Set the vertex and pixel shaders that will be used to render this triangle.
-	deviceContext->VSSetShader(vertexShader, NULL, 0);
-	deviceContext->PSSetShader(pixelShader, NULL, 0);
-	deviceContext->PSSetSamplers(0, 1, &sampleState);	// Set the sampler state in the pixel shader.
-	deviceContext->DrawIndexed(indexCount, 0, 0);	// Render the triangle.
+	states.SetVertexShader(vertexShader);
+	states.SetPixelShader(pixelShaders[key.bits]);
+	states.SetPixelSampler(0, sampleState);	// Set the sampler state in the pixel shader.
+	for (const IndexRange& range : ranges) {
+		states.DrawIndexed(range.count, range.start, 0);	// Render the triangles.
+	}
 }
@@ -3,49 +3,114 @@
 #include <d3dcompiler.h>
 #include <directxmath.h>
 #include <fstream>
+#include <vector>
+#include "vertexencoderclass.hpp"
+#include "inputlayoutclass.hpp"
+#include "meshletclass.hpp"
+#include "textureclass.hpp"
+#include "shadercacheclass.hpp"
+#include "renderstateclass.hpp"
+#include "stateobjectcacheclass.hpp"
+#include "constantringclass.hpp"
+#include "shaderpermutationclass.hpp"
 
 using namespace DirectX;
 using namespace std;
 
+// What every key reads, once a frame. The lights past a key's count are ignored.
+struct SceneLighting {
+    XMFLOAT3 directions[ShaderKey::MAX_LIGHTS]{};   // The way the light travels.
+    XMFLOAT4 colors[ShaderKey::MAX_LIGHTS]{};
+    XMFLOAT4 ambientColor{ 0.0f, 0.0f, 0.0f, 1.0f };
+    XMFLOAT4 fogColor{ 0.0f, 0.0f, 0.0f, 1.0f };
+    float fogStart = 0.0f;  // In world units from the camera.
+    float fogEnd = 1000.0f;
+    float specularPower = 32.0f;
+    float alphaReference = 0.5f;
+};
+
+// Draws the meshes of one vertex format with any of the pixel shader permutations it was built with, see ShaderKey.
+// The vertex shader, the input layout and the constants are the same for all of them, the key only picks the pixel
+// shader from a table.
 class LightShaderClass {
 public:
-    LightShaderClass(ID3D11Device* device, HWND hwnd);
+    // Compiles the vertex shader and a pixel shader for each key, all at once on the cache's workers. Without a cache
+    // every construction compiles them, one after the other. Without a window, such as on a worker, compile errors
+    // only go to errorMessage and shader-error.txt.
+    LightShaderClass(ID3D11Device* device, HWND hwnd, const MeshVertexFormat& format, const vector<ShaderKey>& keys, StateObjectCacheClass& stateObjects,
+        ShaderCacheClass* cache = 0);
     LightShaderClass(const LightShaderClass&) { isInitialized = true; };
     ~LightShaderClass();
 
-    bool Render(ID3D11DeviceContext*, int, XMMATRIX, XMMATRIX, XMMATRIX, ID3D11ShaderResourceView*, XMFLOAT3, XMFLOAT4);
+    // The constants every object shares, once a frame before the first Render. The view and projection come combined.
+    bool SetFrameParameters(RenderStateClass&, XMMATRIX, XMFLOAT3 cameraPosition, const SceneLighting&);
+    // The world matrix and the vertex format's dequantization go into the ring, the texture region only when it changed.
+    // False for a key the shader was not built with.
+    bool Render(RenderStateClass&, ConstantRingClass&, ShaderKey, int, XMMATRIX, ID3D11ShaderResourceView*, const TextureRegion&, const MeshVertexFormat&);
+    bool Render(RenderStateClass&, ConstantRingClass&, ShaderKey, const vector<IndexRange>&, XMMATRIX, ID3D11ShaderResourceView*, const TextureRegion&,
+        const MeshVertexFormat&);
+    bool HasKey(ShaderKey key) const { return key.bits < ShaderKey::COUNT && pixelShaders[key.bits] != 0; }
+
+    // Vertex formats with the same encodings compile and lay out the same, so they can share one shader. The keys are
+    // the ones of whoever built it first.
+    static uint32_t GetVariant(const MeshVertexFormat& format) {
+        return format.encoding.position | format.encoding.texcoord << 8 | format.encoding.normal << 16 | format.encoding.streams << 24;
+    }
+    // The vertex shader the format needs followed by the pixel shader of every key, for ShaderCacheClass::Prefetch.
+    static vector<ShaderCompileRequest> GetCompileRequests(const MeshVertexFormat& format, const vector<ShaderKey>& keys);
+
+    static constexpr const char* VERTEX_SHADER_FILENAME = "../Engine/light.vs";
+    static constexpr const char* PIXEL_SHADER_FILENAME = "../Engine/light.ps";
 
     bool isInitialized = false;
+    string errorMessage;
 private:
-    struct MatrixBufferType {
-        XMMATRIX world;
-        XMMATRIX view;
-        XMMATRIX projection;
+    // The cbuffers of light.vs and light.ps, split by how often they change. The matrices go up row major, as they are.
+    struct FrameBufferType {
+        XMMATRIX viewProjection;
     };
     struct LightBufferType {
-        XMFLOAT4 diffuseColor;
-        XMFLOAT3 lightDirection;
+        XMFLOAT4 directions[ShaderKey::MAX_LIGHTS];
+        XMFLOAT4 colors[ShaderKey::MAX_LIGHTS];
+        XMFLOAT4 ambientColor;
+        XMFLOAT4 fogColor;
+        XMFLOAT3 cameraPosition;
+        float specularPower;
+        float fogStart;
+        float fogScale;
+        float alphaReference;
         float padding;  // Added extra padding so structure is a multiple of 16 for CreateBuffer function requirements.
     };
-    void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
+    struct MaterialBufferType {
+        XMFLOAT4 regionScaleBias;
+        float textureSlice;
+        XMFLOAT3 padding;
+    };
+    struct ObjectBufferType {
+        XMMATRIX world;
+        XMFLOAT4 positionScale;
+        XMFLOAT4 positionBias;
+        XMFLOAT4 texcoordScaleBias;
+    };
+    void OutputShaderErrorMessage(const string&, HWND, const string&);
 
-    bool SetShaderParameters(ID3D11DeviceContext*, XMMATRIX, XMMATRIX, XMMATRIX, ID3D11ShaderResourceView*, XMFLOAT3, XMFLOAT4);
-    void RenderShader(ID3D11DeviceContext*, int);
+    bool SetShaderParameters(RenderStateClass&, ConstantRingClass&, XMMATRIX, ID3D11ShaderResourceView*, const TextureRegion&, const MeshVertexFormat&);
+    bool SetMaterialParameters(RenderStateClass&, const TextureRegion&);
+    void RenderShader(RenderStateClass&, ShaderKey, const vector<IndexRange>&);
 
-    bool SetVertexBuffer(ID3D11Device* device, HWND hwnd);
-    bool SetPixelBuffer(ID3D11Device* device, HWND hwnd);
-    HRESULT VertexInputLayout(ID3D11Device* device, ID3D10Blob* vertexShaderBuffer);
-    D3D11_INPUT_ELEMENT_DESC SetPolygon(LPCSTR name, UINT index, DXGI_FORMAT format, UINT inputSlot, UINT offset, D3D11_INPUT_CLASSIFICATION slotClass, UINT stepRate);
-    bool SetMatrixBuffer(ID3D11Device* device);
-    bool SetSamplerDesc(ID3D11Device* device);
-    bool SetLightBufferDesc(ID3D11Device* device);
+    bool SetVertexBuffer(ID3D11Device* device, HWND hwnd, const ShaderCompileRequest& request, ShaderCacheClass* cache, const MeshVertexFormat& format);
+    bool SetPixelBuffer(ID3D11Device* device, HWND hwnd, ShaderKey key, const ShaderCompileRequest& request, ShaderCacheClass* cache);
+    HRESULT VertexInputLayout(ID3D11Device* device, const vector<unsigned char>& bytecode, const MeshVertexFormat& format);
+    bool SetConstantBuffers(ID3D11Device* device);
+    bool SetSamplerDesc(StateObjectCacheClass& stateObjects);
 
-    wchar_t vsFilename[128] = L"../Engine/light.vs";
-    wchar_t psFilename[128] = L"../Engine/light.ps";
     ID3D11VertexShader* vertexShader = 0;
-    ID3D11PixelShader* pixelShader = 0;
+    ID3D11PixelShader* pixelShaders[ShaderKey::COUNT]{};    // By key, 0 for the keys not built.
     ID3D11InputLayout* layout = 0;
-    ID3D11SamplerState* sampleState = 0;
-    ID3D11Buffer* matrixBuffer = 0;
+    ID3D11SamplerState* sampleState = 0;	// Owned by the StateObjectCacheClass.
+    ID3D11Buffer* frameBuffer = 0;
     ID3D11Buffer* lightBuffer = 0;
+    ID3D11Buffer* materialBuffer = 0;
+    MaterialBufferType material{};  // What materialBuffer holds.
+    bool materialKnown = false;
 };
\ No newline at end of file
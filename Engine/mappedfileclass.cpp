@@ -0,0 +1,71 @@
+#include "mappedfileclass.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+MappedFileClass::MappedFileClass(const char* filename) {
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) { return; }
+	m_file = file;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { return; }
+
+	m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m_mapping) { return; }
+
+	m_data = (const unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_data) { return; }
+	m_size = (size_t)size.QuadPart;
+
+	isInitialized = true;
+}
+
+MappedFileClass::~MappedFileClass() {
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+		m_data = 0;
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+		m_mapping = 0;
+	}
+	if (m_file) {
+		CloseHandle(m_file);
+		m_file = 0;
+	}
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFileClass::MappedFileClass(const char* filename) {
+	int file = open(filename, O_RDONLY);
+	if (file < 0) { return; }
+
+	struct stat info {};
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		return;
+	}
+
+	void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);	// The mapping keeps its own reference to the file.
+	if (data == MAP_FAILED) { return; }
+	madvise(data, (size_t)info.st_size, MADV_WILLNEED);
+
+	m_data = (const unsigned char*)data;
+	m_size = (size_t)info.st_size;
+	isInitialized = true;
+}
+
+MappedFileClass::~MappedFileClass() {
+	if (m_data) {
+		munmap((void*)m_data, m_size);
+		m_data = 0;
+	}
+}
+#endif
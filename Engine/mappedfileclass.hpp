@@ -0,0 +1,23 @@
+#pragma once
+#include <stddef.h>
+
+// Read-only view of a whole file. The pages are owned by the OS, so handing out pointers into the view costs no copies.
+class MappedFileClass {
+public:
+	MappedFileClass(const char* filename);
+	MappedFileClass(const MappedFileClass&) = delete;
+	~MappedFileClass();
+
+	const unsigned char* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+	bool isInitialized = false;
+
+private:
+	const unsigned char* m_data = 0;
+	size_t m_size = 0;
+#ifdef _WIN32
+	void* m_file = 0;
+	void* m_mapping = 0;
+#endif
+};
@@ -0,0 +1,128 @@
+#include "meshclass.hpp"
+#include <limits.h>
+
+MeshClass::MeshClass(const char* sourceFilename, const MeshCookSettings& settings) {
+	isLoaded = Load(sourceFilename, settings);
+}
+
+MeshClass::~MeshClass() {
+	if (indexBuffer) {
+		indexBuffer->Release();
+		indexBuffer = 0;
+	}
+	if (vertexBuffer) {
+		vertexBuffer->Release();
+		vertexBuffer = 0;
+	}
+	if (m_file) {
+		delete m_file;
+		m_file = 0;
+	}
+}
+
+bool MeshClass::Load(const char* sourceFilename, const MeshCookSettings& settings) {
+	// Source models are cooked once into a binary mesh next to them, later launches just map that file.
+	std::string meshFilename = MeshCookerClass::GetCookedFilename(sourceFilename);
+	if (MeshCookerClass::IsStale(sourceFilename, meshFilename.c_str(), settings)) {
+		bool success = MeshCookerClass::Cook(sourceFilename, meshFilename.c_str(), settings, cookReport);
+		if (!success) {
+			errorMessage = cookReport.error;
+			return false;
+		}
+	}
+
+	m_file = new MeshFileClass(meshFilename.c_str());
+	if (not m_file->isInitialized) {
+		errorMessage = meshFilename + ": not a valid cooked mesh";
+		return false;
+	}
+	if (m_file->GetVertexCount() > INT_MAX / m_file->GetVertexStride() || m_file->GetIndexCount() > INT_MAX / sizeof(unsigned int)) {
+		errorMessage = meshFilename + ": too large for one buffer";
+		return false;
+	}
+	// D3D refuses buffers of zero bytes, and there would be nothing to draw anyway.
+	if (m_file->GetVertexCount() == 0 || m_file->GetIndexCount() == 0) {
+		errorMessage = meshFilename + ": has no triangles";
+		return false;
+	}
+
+	vertexCount = (int)m_file->GetVertexCount();
+	indexCount = (int)m_file->GetIndexCount();
+	indexFormat = m_file->GetIndexStride() == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	vertexFormat = m_file->GetVertexFormat();
+	meshlets.assign(m_file->GetMeshlets(), m_file->GetMeshlets() + m_file->GetMeshletCount());
+	lods.assign(m_file->GetLods(), m_file->GetLods() + m_file->GetLodCount());
+
+	const MeshBounds& bounds = m_file->GetBounds();
+	for (int k = 0; k < 3; k++) { boundsCenter[k] = bounds.center[k]; }
+	boundsRadius = bounds.radius;
+	worldPerTexcoord = bounds.worldPerTexcoord;
+	return true;
+}
+
+bool MeshClass::CreateBuffers(ID3D11Device* device) {
+	if (!isLoaded) { return false; }
+
+	// The cooked mesh already has the GPU layout, so the mapped sections are uploaded as they are.
+	D3D11_BUFFER_DESC vertexBufferDesc = BufferDesc(m_file->GetVertexStride() * vertexCount, D3D11_BIND_VERTEX_BUFFER);
+	D3D11_SUBRESOURCE_DATA vertexData = Data(m_file->GetVertices());
+	HRESULT result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
+	if (FAILED(result)) {
+		errorMessage = "could not create the vertex buffer";
+		return false;
+	}
+
+	D3D11_BUFFER_DESC indexBufferDesc = BufferDesc(m_file->GetIndexStride() * indexCount, D3D11_BIND_INDEX_BUFFER);
+	D3D11_SUBRESOURCE_DATA indexData = Data(m_file->GetIndices());
+	result = device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
+	if (FAILED(result)) {
+		errorMessage = "could not create the index buffer";
+		return false;
+	}
+
+	delete m_file;	// The GPU has its own copy now, drop the mapping.
+	m_file = 0;
+
+	isLoaded = false;
+	isInitialized = true;
+	return true;
+}
+
+void MeshClass::Render(RenderStateClass& states) const {
+	// Every stream is a range of the one vertex buffer, bound to the slot of its number.
+	VertexLayout layout = VertexEncoderClass::Describe(vertexFormat.encoding);
+	for (uint32_t stream = 0; stream < vertexFormat.streamCount; stream++) {
+		UINT offset = (UINT)layout.GetStreamStart(stream, vertexCount);
+		states.SetVertexBuffer(stream, vertexBuffer, vertexFormat.streamStrides[stream], offset);
+	}
+	states.SetIndexBuffer(indexBuffer, indexFormat, 0);	// Set the index buffer to active in the input assembler so it can be rendered.
+	states.SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
+}
+
+void MeshClass::RenderPositions(RenderStateClass& states) const {
+	// Stream 0 starts with the positions in either layout, a split one holds nothing else there.
+	states.SetVertexBuffer(0, vertexBuffer, vertexFormat.streamStrides[0], 0);
+	states.SetIndexBuffer(indexBuffer, indexFormat, 0);
+	states.SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+D3D11_BUFFER_DESC MeshClass::BufferDesc(UINT byteWidth, UINT bindFlags) const {
+	// Set up the description of the static vertex/index buffer.
+	D3D11_BUFFER_DESC v{};
+	v.Usage = D3D11_USAGE_DEFAULT;
+	v.ByteWidth = byteWidth;
+	v.BindFlags = bindFlags;
+	v.CPUAccessFlags = 0;
+	v.MiscFlags = 0;
+	v.StructureByteStride = 0;
+	return v;
+}
+
+D3D11_SUBRESOURCE_DATA MeshClass::Data(const void* v) const {
+	// Give the subresource structure a pointer to the vertex/index data.
+	D3D11_SUBRESOURCE_DATA d{};
+	d.pSysMem = v;
+	d.SysMemPitch = 0;
+	d.SysMemSlicePitch = 0;
+	return d;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <d3d11.h>
+#include "meshcookerclass.hpp"
+#include "renderstateclass.hpp"
+#include <string>
+#include <vector>
+
+// The GPU copy of one cooked mesh, shared by every model that draws it through the resource registry.
+class MeshClass
+{
+public:
+	// Cooks the source when the cooked file is stale and maps the result, without touching the GPU.
+	MeshClass(const char* sourceFilename, const MeshCookSettings& settings = MeshCookSettings());
+	MeshClass(const MeshClass&) = delete;
+	~MeshClass();
+	bool CreateBuffers(ID3D11Device* device);	// On the thread owning the context.
+	void Render(RenderStateClass& states) const;
+	// Binds only the stream with the positions, for passes that read nothing else. The input layout of such a pass
+	// comes from Describe(GetVertexFormat().encoding).Select(1u << SEMANTIC_POSITION).
+	void RenderPositions(RenderStateClass& states) const;
+
+	int GetVertexCount() const { return vertexCount; }
+	int GetIndexCount() const { return indexCount; }
+	const MeshVertexFormat& GetVertexFormat() const { return vertexFormat; }
+	const std::vector<Meshlet>& GetMeshlets() const { return meshlets; }
+	const std::vector<MeshLod>& GetLods() const { return lods; }
+	const float* GetBoundsCenter() const { return boundsCenter; }
+	float GetBoundsRadius() const { return boundsRadius; }
+	float GetWorldPerTexcoord() const { return worldPerTexcoord; }	// For the texel density of the texture streaming.
+	const MeshCookReport& GetCookReport() const { return cookReport; }	// Only filled in when this load had to cook the model.
+	bool isLoaded = false;	// The cooked file is mapped, CreateBuffers has not run yet.
+	bool isInitialized = false;
+	std::string errorMessage;
+
+private:
+	bool Load(const char* sourceFilename, const MeshCookSettings& settings);
+	D3D11_BUFFER_DESC BufferDesc(UINT byteWidth, UINT bindFlags) const;
+	D3D11_SUBRESOURCE_DATA Data(const void* v) const;
+
+	ID3D11Buffer* vertexBuffer{};
+	ID3D11Buffer* indexBuffer{};
+	MeshFileClass* m_file{};	// Only mapped while the buffers are being created.
+	int vertexCount = 0;
+	int indexCount = 0;
+	DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;	// 16-bit whenever the cooker could fit the indices.
+	MeshVertexFormat vertexFormat;
+	MeshCookReport cookReport;
+
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshLod> lods;
+	float boundsCenter[3]{};	// Cooked sphere around the model, for the distance of the LOD selection.
+	float boundsRadius = 0.0f;
+	float worldPerTexcoord = 0.0f;
+};
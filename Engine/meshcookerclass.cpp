@@ -0,0 +1,153 @@
+#include "meshcookerclass.hpp"
+#include <ctype.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include "gltfimporterclass.hpp"
+#include "modelparserclass.hpp"
+#include "objimporterclass.hpp"
+
+std::string MeshCookerClass::GetCookedFilename(const char* sourceFilename) {
+	std::filesystem::path path(sourceFilename);
+	path.replace_extension(".mesh");
+	return path.string();
+}
+
+bool MeshCookerClass::IsStale(const char* sourceFilename, const char* meshFilename, const MeshCookSettings& settings) {
+	std::error_code error;
+	if (std::filesystem::equivalent(sourceFilename, meshFilename, error)) { return false; }
+
+	auto meshTime = std::filesystem::last_write_time(meshFilename, error);
+	if (error) { return true; }	// Never cooked.
+	auto sourceTime = std::filesystem::last_write_time(sourceFilename, error);
+	if (error) { return false; }	// Only the cooked file was shipped.
+
+	if (meshTime < sourceTime) { return true; }
+
+	// Older versions fail to open, other settings need a new cook as well.
+	MeshFileClass mesh(meshFilename);
+	return !mesh.isInitialized || mesh.GetCookKey() != GetCookKey(settings);
+}
+
+uint32_t MeshCookerClass::GetCookKey(const MeshCookSettings& settings) {
+	// FNV-1a over every setting that changes the output.
+	uint32_t hash = 2166136261u;
+	auto add = [&hash](uint32_t value) {
+		for (int i = 0; i < 4; i++) { hash = (hash ^ (value >> (i * 8) & 0xFF)) * 16777619u; }
+	};
+	add(settings.reduceOverdraw);
+	add(settings.vertexEncoding.position);
+	add(settings.vertexEncoding.texcoord);
+	add(settings.vertexEncoding.normal);
+	add(settings.vertexEncoding.streams);
+	add(settings.maxMeshletVertices);
+	add(settings.maxMeshletTriangles);
+	auto addFloat = [&add](float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		add(bits);
+	};
+	add(settings.lods.lodCount);
+	addFloat(settings.lods.reduction);
+	addFloat(settings.lods.maxError);
+	addFloat(settings.lods.texcoordWeight);
+	addFloat(settings.lods.normalWeight);
+	return hash ? hash : 1;	// Zero is what files of older versions hold.
+}
+
+bool MeshCookerClass::Cook(const char* sourceFilename, const char* meshFilename, const MeshCookSettings& settings, MeshCookReport& report) {
+	MeshData mesh;
+	if (!Import(sourceFilename, mesh, report.error)) { return false; }
+	ComputeBounds(mesh);
+
+	report.weld = MeshWelderClass::Weld(mesh);
+	report.optimize = MeshOptimizerClass::Optimize(mesh, settings.reduceOverdraw);
+
+	CookedMesh cooked;
+	cooked.lods = MeshSimplifierClass::BuildLods(mesh, settings.lods);
+	for (MeshLod& lod : cooked.lods) {
+		std::vector<Meshlet> meshlets = MeshletClass::Build(mesh, lod.indexStart, lod.indexCount, settings.maxMeshletVertices, settings.maxMeshletTriangles);
+		lod.meshletStart = (uint32_t)cooked.meshlets.size();
+		lod.meshletCount = (uint32_t)meshlets.size();
+		cooked.meshlets.insert(cooked.meshlets.end(), meshlets.begin(), meshlets.end());
+	}
+	report.meshlets = cooked.meshlets.size();
+	report.lods = cooked.lods;
+	report.encode = VertexEncoderClass::Encode(mesh.vertices, settings.vertexEncoding, cooked.format, cooked.vertices);
+	cooked.indices = std::move(mesh.indices);
+	cooked.cookKey = GetCookKey(settings);
+
+	// The bounds were taken from the float positions, cover what the quantization moved as well.
+	for (Meshlet& meshlet : cooked.meshlets) { meshlet.radius += report.encode.maxPositionError; }
+	cooked.bounds = mesh.bounds;
+	cooked.bounds.radius += report.encode.maxPositionError;
+
+	if (!MeshFileClass::Write(meshFilename, cooked)) {
+		report.error = std::string(meshFilename) + ": could not write the cooked mesh";
+		return false;
+	}
+	return true;
+}
+
+bool MeshCookerClass::Import(const char* sourceFilename, MeshData& mesh, std::string& error) {
+	std::string extension = std::filesystem::path(sourceFilename).extension().string();
+	for (char& c : extension) { c = (char)tolower((unsigned char)c); }
+
+	if (extension == ".obj") {
+		ObjImporterClass importer;
+		if (importer.Import(sourceFilename, mesh)) { return true; }
+		error = importer.GetError();
+		return false;
+	}
+	if (extension == ".gltf" || extension == ".glb") {
+		GltfImporterClass importer;
+		if (importer.Import(sourceFilename, mesh)) { return true; }
+		error = importer.GetError();
+		return false;
+	}
+
+	ModelParserClass parser;
+	if (parser.Parse(sourceFilename, mesh)) { return true; }
+	error = parser.GetError();
+	return false;
+}
+
+void MeshCookerClass::ComputeBounds(MeshData& mesh) {
+	// The importers fill the box while they write the vertices, the text format leaves it to here.
+	MeshBounds& bounds = mesh.bounds;
+	if (bounds.IsEmpty()) {
+		for (const MeshVertex& vertex : mesh.vertices) { bounds.Add(vertex.Position()); }
+	}
+	if (bounds.IsEmpty()) { return; }
+
+	// The sphere is centred on the box, which is tighter than the box's own sphere for most models.
+	float radiusSquared = 0.0f;
+	for (int k = 0; k < 3; k++) { bounds.center[k] = (bounds.minimum[k] + bounds.maximum[k]) * 0.5f; }
+	for (const MeshVertex& vertex : mesh.vertices) {
+		float x = vertex.Position()[0] - bounds.center[0], y = vertex.Position()[1] - bounds.center[1], z = vertex.Position()[2] - bounds.center[2];
+		radiusSquared = std::max(radiusSquared, x * x + y * y + z * z);
+	}
+	bounds.radius = sqrtf(radiusSquared);
+
+	// Texel density for the streaming: how much surface one unit square of UV is stretched over, as a length.
+	double worldArea = 0.0, texcoordArea = 0.0;
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+		const MeshVertex& a = mesh.vertices[mesh.indices[i]];
+		const MeshVertex& b = mesh.vertices[mesh.indices[i + 1]];
+		const MeshVertex& c = mesh.vertices[mesh.indices[i + 2]];
+		double e[2][3], cross[3];
+		for (int k = 0; k < 3; k++) {
+			e[0][k] = (double)b.Position()[k] - a.Position()[k];
+			e[1][k] = (double)c.Position()[k] - a.Position()[k];
+		}
+		cross[0] = e[0][1] * e[1][2] - e[0][2] * e[1][1];
+		cross[1] = e[0][2] * e[1][0] - e[0][0] * e[1][2];
+		cross[2] = e[0][0] * e[1][1] - e[0][1] * e[1][0];
+		worldArea += sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) * 0.5;
+		double u0 = (double)b.Texcoord()[0] - a.Texcoord()[0], v0 = (double)b.Texcoord()[1] - a.Texcoord()[1];
+		double u1 = (double)c.Texcoord()[0] - a.Texcoord()[0], v1 = (double)c.Texcoord()[1] - a.Texcoord()[1];
+		texcoordArea += fabs(u0 * v1 - v0 * u1) * 0.5;
+	}
+	bounds.worldPerTexcoord = texcoordArea > 0.0 ? (float)sqrt(worldArea / texcoordArea) : 0.0f;
+}
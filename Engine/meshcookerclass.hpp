@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include "meshfileclass.hpp"
+#include "meshwelderclass.hpp"
+#include "meshoptimizerclass.hpp"
+
+struct MeshCookSettings {
+	bool reduceOverdraw = true;	// Sort cache independent triangle clusters front to back after the cache pass.
+	VertexEncoding vertexEncoding;	// Full floats unless a compact encoding is asked for.
+	uint32_t maxMeshletVertices = MeshletClass::MAX_VERTICES;
+	uint32_t maxMeshletTriangles = MeshletClass::MAX_TRIANGLES;
+	MeshSimplifySettings lods;
+};
+
+// What the cooker did to a mesh, or why it failed.
+struct MeshCookReport {
+	std::string error;
+	MeshWeldStats weld;
+	MeshOptimizeStats optimize;
+	VertexEncodeStats encode;	// Vertex memory before/after and the worst error each attribute picked up.
+	size_t meshlets = 0;
+	std::vector<MeshLod> lods;	// Index count and error of every level that was kept.
+};
+
+// Turns source model files (the text format, OBJ or glTF) into cooked *.mesh files that ModelClass can map directly.
+class MeshCookerClass {
+public:
+	static std::string GetCookedFilename(const char* sourceFilename);
+	static bool IsStale(const char* sourceFilename, const char* meshFilename, const MeshCookSettings& settings);
+	static bool Cook(const char* sourceFilename, const char* meshFilename, const MeshCookSettings& settings, MeshCookReport& report);
+	// Differs between settings that cook different meshes, never zero.
+	static uint32_t GetCookKey(const MeshCookSettings& settings);
+
+private:
+	// Picks the importer from the extension: .obj, .gltf and .glb, anything else is the engine's text format.
+	static bool Import(const char* sourceFilename, MeshData& mesh, std::string& error);
+	static void ComputeBounds(MeshData& mesh);
+};
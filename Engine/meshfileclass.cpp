@@ -0,0 +1,140 @@
+#include "meshfileclass.hpp"
+#include "meshwelderclass.hpp"
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+MeshFileClass::MeshFileClass(const char* filename) {
+	m_file = new MappedFileClass(filename);
+	if (not m_file->isInitialized) { return; }
+
+	size_t size = m_file->GetSize();
+	if (size < sizeof(MeshFileHeader)) { return; }
+	m_header = (const MeshFileHeader*)m_file->GetData();
+	if (memcmp(m_header->magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0) { return; }
+	if (m_header->version != MESH_FILE_VERSION) { return; }
+
+	uint64_t tableEnd = sizeof(MeshFileHeader) + (uint64_t)m_header->sectionCount * sizeof(MeshFileSection);
+	if (tableEnd > size) { return; }
+	m_sections = (const MeshFileSection*)(m_file->GetData() + sizeof(MeshFileHeader));
+
+	// Validate every payload up front so the getters can hand out raw pointers.
+	for (uint32_t i = 0; i < m_header->sectionCount; i++) {
+		const MeshFileSection& s = m_sections[i];
+		if (s.offset % MESH_FILE_ALIGNMENT != 0 || s.offset < tableEnd || s.offset > size) { return; }
+		// Without a stride there is nothing to hold the elements, such a section has to be empty.
+		if (s.stride == 0 ? s.count != 0 : s.count > (size - s.offset) / s.stride) { return; }
+	}
+
+	m_vertices = FindSection(MESH_SECTION_VERTICES);
+	m_indices = FindSection(MESH_SECTION_INDICES);
+	m_format = FindSection(MESH_SECTION_VERTEX_FORMAT);
+	m_meshlets = FindSection(MESH_SECTION_MESHLETS);
+	m_lods = FindSection(MESH_SECTION_LODS);
+	m_bounds = FindSection(MESH_SECTION_BOUNDS);
+	if (!m_vertices || !m_indices || !m_format || !m_meshlets || !m_lods || !m_bounds) { return; }
+	if (m_indices->stride != 2 && m_indices->stride != 4) { return; }
+	if (m_format->stride != sizeof(MeshVertexFormat) || m_format->count != 1) { return; }
+	if (m_bounds->stride != sizeof(MeshBounds) || m_bounds->count != 1) { return; }
+	if (m_meshlets->stride != sizeof(Meshlet)) { return; }
+	for (uint64_t i = 0; i < m_meshlets->count; i++) {
+		const Meshlet& meshlet = GetMeshlets()[i];
+		if ((uint64_t)meshlet.indexStart + meshlet.indexCount > m_indices->count) { return; }
+	}
+	if (m_lods->stride != sizeof(MeshLod) || m_lods->count == 0) { return; }
+	for (uint64_t i = 0; i < m_lods->count; i++) {
+		const MeshLod& lod = GetLods()[i];
+		if ((uint64_t)lod.indexStart + lod.indexCount > m_indices->count) { return; }
+		if ((uint64_t)lod.meshletStart + lod.meshletCount > m_meshlets->count) { return; }
+	}
+
+	// The streams have to be the ones the encoding describes, the input layouts are made from that.
+	const MeshVertexFormat& format = GetVertexFormat();
+	VertexLayout layout = VertexEncoderClass::Describe(format.encoding);
+	if (format.streamCount != layout.streamCount || format.stride != layout.GetStride()) { return; }
+	for (uint32_t stream = 0; stream < layout.streamCount; stream++) {
+		if (format.streamStrides[stream] != layout.strides[stream]) { return; }
+	}
+
+	isInitialized = m_vertices->stride == format.stride;
+}
+
+MeshFileClass::~MeshFileClass() {
+	if (m_file) {
+		delete m_file;
+		m_file = 0;
+	}
+}
+
+const MeshFileSection* MeshFileClass::FindSection(uint32_t type) const {
+	for (uint32_t i = 0; i < m_header->sectionCount; i++) {
+		if (m_sections[i].type == type) { return &m_sections[i]; }
+	}
+	return 0;
+}
+
+bool MeshFileClass::Write(const char* filename, const CookedMesh& mesh) {
+	struct Payload {
+		uint32_t type;
+		uint32_t stride;
+		uint64_t count;
+		const void* data;
+	};
+	std::vector<uint16_t> shortIndices;
+	const void* indices = mesh.indices.data();
+	uint64_t vertexCount = mesh.format.stride ? mesh.vertices.size() / mesh.format.stride : 0;
+	uint32_t indexStride = (uint32_t)MeshWelderClass::IndexStride(vertexCount);
+	if (indexStride == sizeof(uint16_t)) {
+		shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+		indices = shortIndices.data();
+	}
+
+	const Payload payloads[] = {
+		{ MESH_SECTION_VERTICES, mesh.format.stride, vertexCount, mesh.vertices.data() },
+		{ MESH_SECTION_INDICES, indexStride, mesh.indices.size(), indices },
+		{ MESH_SECTION_VERTEX_FORMAT, sizeof(MeshVertexFormat), 1, &mesh.format },
+		{ MESH_SECTION_MESHLETS, sizeof(Meshlet), mesh.meshlets.size(), mesh.meshlets.data() },
+		{ MESH_SECTION_LODS, sizeof(MeshLod), mesh.lods.size(), mesh.lods.data() },
+		{ MESH_SECTION_BOUNDS, sizeof(MeshBounds), 1, &mesh.bounds },
+	};
+	const uint32_t sectionCount = sizeof(payloads) / sizeof(payloads[0]);
+
+	MeshFileHeader header{};
+	memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+	header.version = MESH_FILE_VERSION;
+	header.sectionCount = sectionCount;
+	header.cookKey = mesh.cookKey;
+
+	auto align = [](uint64_t offset) { return (offset + MESH_FILE_ALIGNMENT - 1) & ~(uint64_t)(MESH_FILE_ALIGNMENT - 1); };
+	MeshFileSection sections[sectionCount]{};
+	uint64_t offset = align(sizeof(MeshFileHeader) + sizeof(sections));
+	for (uint32_t i = 0; i < sectionCount; i++) {
+		sections[i].type = payloads[i].type;
+		sections[i].stride = payloads[i].stride;
+		sections[i].count = payloads[i].count;
+		sections[i].offset = offset;
+		offset = align(offset + payloads[i].count * payloads[i].stride);
+	}
+
+	// Write next to the target and swap it in, so a crash never leaves a half written mesh behind.
+	std::string tempFilename = std::string(filename) + ".tmp";
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (fout.fail()) { return false; }
+
+	static const char padding[MESH_FILE_ALIGNMENT]{};
+	fout.write((const char*)&header, sizeof(header));
+	fout.write((const char*)sections, sizeof(sections));
+	uint64_t written = sizeof(header) + sizeof(sections);
+	for (uint32_t i = 0; i < sectionCount; i++) {
+		fout.write(padding, (std::streamsize)(sections[i].offset - written));
+		fout.write((const char*)payloads[i].data, (std::streamsize)(payloads[i].count * payloads[i].stride));
+		written = sections[i].offset + payloads[i].count * payloads[i].stride;
+	}
+	fout.close();
+	if (fout.fail()) { return false; }
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, filename, error);
+	return !error;
+}
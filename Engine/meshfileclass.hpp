@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include "mappedfileclass.hpp"
+#include "meshtypes.hpp"
+#include "vertexencoderclass.hpp"
+#include "meshletclass.hpp"
+#include "meshsimplifierclass.hpp"
+
+// Cooked mesh container (*.mesh). A header, a section table and the raw section payloads, each aligned so it can be
+// handed to the GPU straight from the mapped file.
+static constexpr char MESH_FILE_MAGIC[4] = { 'E', 'M', 'S', 'H' };
+static constexpr uint32_t MESH_FILE_VERSION = 10;	// Bumped whenever cooked output changes, older files get re-cooked.
+static constexpr uint32_t MESH_FILE_ALIGNMENT = 16;
+
+enum MeshSectionType : uint32_t {
+	MESH_SECTION_VERTICES = 1,	// Packed as described by the vertex format section.
+	MESH_SECTION_INDICES = 2,	// 16-bit when every index fits, 32-bit otherwise.
+	MESH_SECTION_VERTEX_FORMAT = 3,	// One MeshVertexFormat.
+	MESH_SECTION_MESHLETS = 4,	// Meshlets of every level, each level's in index order.
+	MESH_SECTION_LODS = 5,		// Levels of detail from full detail down, at least one.
+	MESH_SECTION_BOUNDS = 6,	// One MeshBounds around every vertex.
+};
+
+struct MeshFileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t sectionCount;
+	uint32_t cookKey;	// The settings it was cooked with, see MeshCookerClass::GetCookKey.
+};
+
+struct MeshFileSection {
+	uint32_t type;
+	uint32_t stride;	// Size of one element in bytes.
+	uint64_t count;		// Number of elements.
+	uint64_t offset;	// From the start of the file, always a multiple of MESH_FILE_ALIGNMENT.
+};
+
+// What the cooker hands to Write, already in its final GPU layout.
+struct CookedMesh {
+	MeshVertexFormat format;
+	std::vector<unsigned char> vertices;	// Packed as the format describes.
+	std::vector<unsigned int> indices;		// Narrowed to 16-bit on write when they fit.
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshLod> lods;
+	MeshBounds bounds;
+	uint32_t cookKey = 0;
+};
+
+class MeshFileClass {
+public:
+	MeshFileClass(const char* filename);
+	MeshFileClass(const MeshFileClass&) = delete;
+	~MeshFileClass();
+
+	const void* GetVertices() const { return GetSection(m_vertices); }
+	const void* GetIndices() const { return GetSection(m_indices); }
+	uint32_t GetVertexStride() const { return m_vertices ? m_vertices->stride : 0; }
+	uint32_t GetIndexStride() const { return m_indices ? m_indices->stride : 0; }
+	uint64_t GetVertexCount() const { return m_vertices ? m_vertices->count : 0; }
+	uint64_t GetIndexCount() const { return m_indices ? m_indices->count : 0; }
+	const MeshVertexFormat& GetVertexFormat() const { return *(const MeshVertexFormat*)GetSection(m_format); }
+	const Meshlet* GetMeshlets() const { return (const Meshlet*)GetSection(m_meshlets); }
+	uint64_t GetMeshletCount() const { return m_meshlets ? m_meshlets->count : 0; }
+	const MeshLod* GetLods() const { return (const MeshLod*)GetSection(m_lods); }
+	uint64_t GetLodCount() const { return m_lods ? m_lods->count : 0; }
+	const MeshBounds& GetBounds() const { return *(const MeshBounds*)GetSection(m_bounds); }
+	uint32_t GetCookKey() const { return m_header ? m_header->cookKey : 0; }
+
+	static bool Write(const char* filename, const CookedMesh& mesh);
+
+	bool isInitialized = false;
+
+private:
+	const MeshFileSection* FindSection(uint32_t type) const;
+	const void* GetSection(const MeshFileSection* section) const { return section ? m_file->GetData() + section->offset : 0; }
+
+	MappedFileClass* m_file = 0;
+	const MeshFileHeader* m_header = 0;
+	const MeshFileSection* m_sections = 0;
+	const MeshFileSection* m_vertices = 0;
+	const MeshFileSection* m_indices = 0;
+	const MeshFileSection* m_format = 0;
+	const MeshFileSection* m_meshlets = 0;
+	const MeshFileSection* m_lods = 0;
+	const MeshFileSection* m_bounds = 0;
+};
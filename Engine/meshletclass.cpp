@@ -0,0 +1,199 @@
+#include "meshletclass.hpp"
+#include <math.h>
+#include <algorithm>
+
+std::vector<Meshlet> MeshletClass::Build(const MeshData& mesh, size_t indexStart, size_t indexCount, uint32_t maxVertices, uint32_t maxTriangles) {
+	std::vector<Meshlet> meshlets;
+	if (maxVertices < 3 || maxTriangles < 1) { return meshlets; }
+
+	// Which meshlet last took each vertex, so the unique count of the open meshlet is known per triangle.
+	std::vector<uint32_t> owner(mesh.vertices.size(), UINT32_MAX);
+	std::vector<unsigned int> vertices;
+	vertices.reserve(maxVertices);
+
+	Meshlet current;
+	current.indexStart = (uint32_t)indexStart;
+	auto close = [&](size_t nextIndex) {
+		if (current.indexCount == 0) { return; }
+		current.vertexCount = (uint32_t)vertices.size();
+		ComputeBounds(mesh, vertices, current);
+		ComputeCone(mesh, current);
+		meshlets.push_back(current);
+		current = Meshlet();
+		current.indexStart = (uint32_t)nextIndex;
+		vertices.clear();
+	};
+
+	size_t indexEnd = std::min(indexStart + indexCount, mesh.indices.size());
+	for (size_t i = indexStart; i + 2 < indexEnd; i += 3) {
+		const unsigned int* triangle = &mesh.indices[i];
+		uint32_t id = (uint32_t)meshlets.size();
+		size_t added = 0;
+		for (int k = 0; k < 3; k++) {
+			bool repeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+			added += owner[triangle[k]] != id && !repeated;
+		}
+		if (vertices.size() + added > maxVertices || current.indexCount / 3 + 1 > maxTriangles) {
+			close(i);
+			id = (uint32_t)meshlets.size();
+		}
+
+		for (int k = 0; k < 3; k++) {
+			if (owner[triangle[k]] == id) { continue; }
+			owner[triangle[k]] = id;
+			vertices.push_back(triangle[k]);
+		}
+		current.indexCount += 3;
+	}
+	close(indexEnd);
+	return meshlets;
+}
+
+void MeshletClass::ComputeBounds(const MeshData& mesh, const std::vector<unsigned int>& vertices, Meshlet& meshlet) {
+	// Ritter's sphere: start from the most distant pair of axis extremes, then grow to take in every outlier.
+	auto position = [&](size_t i) { return mesh.vertices[vertices[i]].Position(); };
+	size_t minimum[3]{}, maximum[3]{};
+	for (size_t i = 1; i < vertices.size(); i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			if (position(i)[axis] < position(minimum[axis])[axis]) { minimum[axis] = i; }
+			if (position(i)[axis] > position(maximum[axis])[axis]) { maximum[axis] = i; }
+		}
+	}
+
+	auto distanceSquared = [](const float* a, const float* b) {
+		float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+		return x * x + y * y + z * z;
+	};
+	int widest = 0;
+	float widestDistance = -1.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		float distance = distanceSquared(position(minimum[axis]), position(maximum[axis]));
+		if (distance > widestDistance) {
+			widest = axis;
+			widestDistance = distance;
+		}
+	}
+
+	const float* a = position(minimum[widest]);
+	const float* b = position(maximum[widest]);
+	float center[3] = { (a[0] + b[0]) * 0.5f, (a[1] + b[1]) * 0.5f, (a[2] + b[2]) * 0.5f };
+	float radius = sqrtf(widestDistance) * 0.5f;
+	for (size_t i = 0; i < vertices.size(); i++) {
+		const float* p = position(i);
+		float distance = distanceSquared(p, center);
+		if (distance <= radius * radius) { continue; }
+
+		distance = sqrtf(distance);
+		float grown = (radius + distance) * 0.5f;
+		float shift = (grown - radius) / distance;
+		for (int axis = 0; axis < 3; axis++) { center[axis] += (p[axis] - center[axis]) * shift; }
+		radius = grown;
+	}
+
+	for (int axis = 0; axis < 3; axis++) { meshlet.center[axis] = center[axis]; }
+	meshlet.radius = radius;
+}
+
+void MeshletClass::ComputeCone(const MeshData& mesh, Meshlet& meshlet) {
+	// Front faces are clockwise, which makes (b - a) x (c - a) point away from the surface.
+	std::vector<float> normals;
+	normals.reserve(meshlet.indexCount);
+	float axis[3]{};
+	for (uint32_t i = meshlet.indexStart; i < meshlet.indexStart + meshlet.indexCount; i += 3) {
+		const float* a = mesh.vertices[mesh.indices[i]].Position();
+		const float* b = mesh.vertices[mesh.indices[i + 1]].Position();
+		const float* c = mesh.vertices[mesh.indices[i + 2]].Position();
+		float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0f) { continue; }	// Zero area, faces nowhere.
+
+		for (int k = 0; k < 3; k++) {
+			normals.push_back(n[k] / length);
+			axis[k] += n[k] / length;
+		}
+	}
+
+	meshlet.coneCutoff = 1.0f;
+	float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	if (length == 0.0f) { return; }
+	for (int k = 0; k < 3; k++) { meshlet.coneAxis[k] = axis[k] / length; }
+
+	float minimumDot = 1.0f;
+	for (size_t i = 0; i < normals.size(); i += 3) {
+		float dot = normals[i] * meshlet.coneAxis[0] + normals[i + 1] * meshlet.coneAxis[1] + normals[i + 2] * meshlet.coneAxis[2];
+		minimumDot = std::min(minimumDot, dot);
+	}
+
+	// Past roughly 84 degrees the cone is almost never entirely behind the camera, keep it from costing a test.
+	if (minimumDot <= 0.1f) { return; }
+	meshlet.coneCutoff = sqrtf(1.0f - minimumDot * minimumDot);
+}
+
+MeshletFrustum MeshletFrustum::FromMatrix(const float m[16], const float cameraPosition[3]) {
+	// Gribb/Hartmann: with row vectors every clip plane is a sum or difference of matrix columns.
+	MeshletFrustum frustum;
+	auto column = [&](int c, int row) { return m[row * 4 + c]; };
+	for (int row = 0; row < 4; row++) {
+		frustum.planes[0][row] = column(3, row) + column(0, row);	// Left.
+		frustum.planes[1][row] = column(3, row) - column(0, row);	// Right.
+		frustum.planes[2][row] = column(3, row) + column(1, row);	// Bottom.
+		frustum.planes[3][row] = column(3, row) - column(1, row);	// Top.
+		frustum.planes[4][row] = column(2, row);					// Near, depth starts at 0.
+		frustum.planes[5][row] = column(3, row) - column(2, row);	// Far.
+	}
+
+	// Normalized planes give real distances, so spheres can be tested against them.
+	for (auto& plane : frustum.planes) {
+		float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length == 0.0f) { continue; }
+		for (int k = 0; k < 4; k++) { plane[k] /= length; }
+	}
+
+	for (int k = 0; k < 3; k++) { frustum.cameraPosition[k] = cameraPosition[k]; }
+	return frustum;
+}
+
+MeshletCullStats MeshletClass::Cull(const Meshlet* meshlets, size_t meshletCount, const MeshletFrustum& frustum, std::vector<IndexRange>& visible) {
+	MeshletCullStats stats;
+	const size_t firstRange = visible.size();
+	for (size_t i = 0; i < meshletCount; i++) {
+		const Meshlet& meshlet = meshlets[i];
+		stats.tested++;
+
+		bool outside = false;
+		for (const auto& plane : frustum.planes) {
+			float distance = plane[0] * meshlet.center[0] + plane[1] * meshlet.center[1] + plane[2] * meshlet.center[2] + plane[3];
+			if (distance < -meshlet.radius) {
+				outside = true;
+				break;
+			}
+		}
+		if (outside) {
+			stats.frustumCulled++;
+			continue;
+		}
+
+		// Every triangle faces away when the view direction to the sphere stays inside the flipped normal cone.
+		float view[3] = {
+			meshlet.center[0] - frustum.cameraPosition[0],
+			meshlet.center[1] - frustum.cameraPosition[1],
+			meshlet.center[2] - frustum.cameraPosition[2] };
+		float distance = sqrtf(view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+		float facing = view[0] * meshlet.coneAxis[0] + view[1] * meshlet.coneAxis[1] + view[2] * meshlet.coneAxis[2];
+		if (facing >= meshlet.coneCutoff * distance + meshlet.radius) {
+			stats.backfaceCulled++;
+			continue;
+		}
+
+		if (visible.size() > firstRange && visible.back().start + visible.back().count == meshlet.indexStart) {
+			visible.back().count += meshlet.indexCount;
+		}
+		else {
+			visible.push_back({ meshlet.indexStart, meshlet.indexCount });
+		}
+	}
+	stats.drawCalls = visible.size() - firstRange;
+	return stats;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "meshtypes.hpp"
+
+// A run of consecutive triangles in the index buffer with bounds for culling. Cooked into the mesh file as is.
+struct Meshlet {
+	uint32_t indexStart = 0;	// First index of the meshlet in the index buffer.
+	uint32_t indexCount = 0;
+	uint32_t vertexCount = 0;	// Unique vertices the triangles reference.
+	uint32_t padding = 0;
+	float center[3]{};		// Bounding sphere in model space.
+	float radius = 0.0f;
+	float coneAxis[3]{};	// Average facing of the triangles.
+	float coneCutoff = 1.0f;	// Sine of the cone half angle, 1 when the normals spread too far to cull anything.
+};
+
+struct IndexRange {
+	uint32_t start = 0;
+	uint32_t count = 0;
+};
+
+// Model space frustum planes (ax + by + cz + d >= 0 inside) and camera position.
+struct MeshletFrustum {
+	float planes[6][4]{};
+	float cameraPosition[3]{};
+
+	// Row major world * view * projection in the DirectXMath row vector convention, depth in 0..1.
+	static MeshletFrustum FromMatrix(const float worldViewProjection[16], const float cameraPosition[3]);
+};
+
+struct MeshletCullStats {
+	size_t tested = 0;
+	size_t frustumCulled = 0;
+	size_t backfaceCulled = 0;
+	size_t drawCalls = 0;	// Visible ranges after merging neighbours.
+};
+
+// Splits indexed meshes into meshlets of bounded vertex and triangle counts and culls them on the CPU.
+class MeshletClass {
+public:
+	static constexpr uint32_t MAX_VERTICES = 64;
+	static constexpr uint32_t MAX_TRIANGLES = 124;
+
+	// Covers indexCount indices from indexStart on. Keeps the triangle order the optimizer chose, a meshlet is closed
+	// as soon as the next triangle would not fit.
+	static std::vector<Meshlet> Build(const MeshData& mesh, size_t indexStart, size_t indexCount, uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+	// Appends the index ranges of the visible meshlets, neighbouring ranges are merged into one draw.
+	static MeshletCullStats Cull(const Meshlet* meshlets, size_t meshletCount, const MeshletFrustum& frustum, std::vector<IndexRange>& visible);
+
+private:
+	static void ComputeBounds(const MeshData& mesh, const std::vector<unsigned int>& vertices, Meshlet& meshlet);
+	static void ComputeCone(const MeshData& mesh, Meshlet& meshlet);
+};
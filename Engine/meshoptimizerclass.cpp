@@ -0,0 +1,257 @@
+#include "meshoptimizerclass.hpp"
+#include <math.h>
+#include <algorithm>
+
+MeshOptimizeStats MeshOptimizerClass::Optimize(MeshData& mesh, bool reduceOverdraw) {
+	MeshOptimizeStats stats;
+	stats.before = AnalyzeCache(mesh.indices, mesh.vertices.size());
+
+	// Triangles that repeat a vertex are invisible and would confuse the cache model, drop them first.
+	size_t kept = 0;
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+		unsigned int a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+		if (a == b || b == c || a == c) { continue; }
+		mesh.indices[kept++] = a;
+		mesh.indices[kept++] = b;
+		mesh.indices[kept++] = c;
+	}
+	mesh.indices.resize(kept);
+
+	OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+	if (reduceOverdraw) { stats.clusters = OptimizeOverdraw(mesh); }
+	OptimizeVertexFetch(mesh);
+
+	stats.after = AnalyzeCache(mesh.indices, mesh.vertices.size());
+	return stats;
+}
+
+MeshCacheStats MeshOptimizerClass::AnalyzeCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize) {
+	MeshCacheStats stats;
+	if (indices.empty() || vertexCount == 0) { return stats; }
+
+	// A vertex is in the FIFO while fewer than cacheSize misses happened since it was loaded.
+	std::vector<size_t> loadedAt(vertexCount, 0);
+	size_t misses = 0;
+	for (unsigned int index : indices) {
+		if (loadedAt[index] == 0 || misses - loadedAt[index] >= cacheSize) {
+			misses++;
+			loadedAt[index] = misses;
+		}
+	}
+
+	size_t usedVertices = 0;
+	for (size_t time : loadedAt) { usedVertices += time != 0; }
+
+	size_t triangles = indices.size() / 3;
+	stats.acmr = triangles ? (float)misses / (float)triangles : 0.0f;	// Fewer than three indices draw nothing.
+	stats.atvr = (float)misses / (float)usedVertices;
+	return stats;
+}
+
+float MeshOptimizerClass::VertexScore(int cachePosition, unsigned int remainingValence) {
+	// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation".
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRI_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+
+	if (remainingValence == 0) { return -1.0f; }	// No triangle needs this vertex any more.
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			score = LAST_TRI_SCORE;	// Used by the last triangle, the exact slot should not matter.
+		}
+		else {
+			const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			score = powf(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+		}
+	}
+
+	// Favour vertices with few triangles left so lone triangles do not get stranded.
+	score += VALENCE_BOOST_SCALE * powf((float)remainingValence, -VALENCE_BOOST_POWER);
+	return score;
+}
+
+void MeshOptimizerClass::OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) { return; }
+
+	// Vertex to triangle adjacency in compressed rows.
+	std::vector<unsigned int> valence(vertexCount, 0);
+	for (unsigned int index : indices) { valence[index]++; }
+	std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) { firstTriangle[v + 1] = firstTriangle[v] + valence[v]; }
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int k = 0; k < 3; k++) { adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t; }
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) { vertexScore[v] = VertexScore(-1, valence[v]); }
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (size_t t = 0; t < triangleCount; t++) {
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+	}
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+	unsigned int cacheCount = 0;
+	size_t scanPosition = 0;	// Fallback search resumes here, everything before it is emitted.
+
+	size_t best = 0;
+	for (size_t t = 1; t < triangleCount; t++) {
+		if (triangleScore[t] > triangleScore[best]) { best = t; }
+	}
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+		emitted[best] = true;
+		unsigned int triangle[3] = { indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2] };
+		result.insert(result.end(), triangle, triangle + 3);
+
+		// Remove the triangle from its vertices' remaining lists.
+		for (unsigned int v : triangle) {
+			unsigned int* begin = &adjacency[firstTriangle[v]];
+			unsigned int* end = begin + valence[v];
+			*std::find(begin, end, (unsigned int)best) = *(end - 1);
+			valence[v]--;
+		}
+
+		// Move the triangle's vertices to the front of the LRU cache.
+		unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+		unsigned int newCount = 0;
+		for (unsigned int v : triangle) { newCache[newCount++] = v; }
+		for (unsigned int i = 0; i < cacheCount; i++) {
+			unsigned int v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) { newCache[newCount++] = v; }
+		}
+		for (unsigned int i = FORSYTH_CACHE_SIZE; i < newCount; i++) { cachePosition[newCache[i]] = -1; }	// Evicted.
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		// Only vertices that were touched can change score, and only their triangles need rescoring.
+		for (unsigned int i = 0; i < newCount; i++) {
+			unsigned int v = newCache[i];
+			if (i < cacheCount) { cachePosition[v] = (int)i; }
+			float score = VertexScore(cachePosition[v], valence[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			for (unsigned int a = 0; a < valence[v]; a++) { triangleScore[adjacency[firstTriangle[v] + a]] += delta; }
+		}
+
+		// Next triangle is the best one around the cache, otherwise the next unused one in file order.
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < cacheCount; i++) {
+			unsigned int v = cache[i];
+			for (unsigned int a = 0; a < valence[v]; a++) {
+				unsigned int t = adjacency[firstTriangle[v] + a];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+		if (bestScore < 0.0f) {
+			while (scanPosition < triangleCount && emitted[scanPosition]) { scanPosition++; }
+			best = scanPosition;
+		}
+	}
+
+	indices.swap(result);
+}
+
+size_t MeshOptimizerClass::OptimizeOverdraw(MeshData& mesh) {
+	std::vector<unsigned int>& indices = mesh.indices;
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) { return 0; }
+
+	// Split where the simulated cache has nothing to offer (all three vertices miss). Reordering whole clusters
+	// then leaves the vertex cache efficiency untouched.
+	std::vector<size_t> clusterStart;
+	std::vector<size_t> loadedAt(mesh.vertices.size(), 0);
+	size_t misses = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		int triangleMisses = 0;
+		for (int k = 0; k < 3; k++) {
+			unsigned int index = indices[t * 3 + k];
+			if (loadedAt[index] == 0 || misses - loadedAt[index] >= SIMULATED_CACHE_SIZE) {
+				misses++;
+				loadedAt[index] = misses;
+				triangleMisses++;
+			}
+		}
+		if (triangleMisses == 3) { clusterStart.push_back(t); }
+	}
+	clusterStart.push_back(triangleCount);
+
+	// Clusters that face away from the mesh centre are likely in front, draw them first so they occlude the rest.
+	float meshCentre[3] = { 0.0f, 0.0f, 0.0f };
+	for (const MeshVertex& v : mesh.vertices) {
+		for (int k = 0; k < 3; k++) { meshCentre[k] += v.Position()[k]; }
+	}
+	for (int k = 0; k < 3; k++) { meshCentre[k] /= (float)mesh.vertices.size(); }
+
+	size_t clusterCount = clusterStart.size() - 1;
+	std::vector<float> sortKey(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) {
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+		for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+			const float* p0 = mesh.vertices[indices[t * 3]].Position();
+			const float* p1 = mesh.vertices[indices[t * 3 + 1]].Position();
+			const float* p2 = mesh.vertices[indices[t * 3 + 2]].Position();
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float a = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);	// Twice the area, weights both sums.
+			for (int k = 0; k < 3; k++) {
+				centroid[k] += (p0[k] + p1[k] + p2[k]) * (a / 3.0f);
+				normal[k] += n[k];
+			}
+			area += a;
+		}
+		if (area > 0.0f) {
+			for (int k = 0; k < 3; k++) { centroid[k] /= area; }
+		}
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0.0f) {
+			for (int k = 0; k < 3; k++) { normal[k] /= length; }
+		}
+		sortKey[c] = (centroid[0] - meshCentre[0]) * normal[0] + (centroid[1] - meshCentre[1]) * normal[1] + (centroid[2] - meshCentre[2]) * normal[2];
+	}
+
+	std::vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) { order[c] = c; }
+	std::stable_sort(order.begin(), order.end(), [&sortKey](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (size_t c : order) {
+		result.insert(result.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+	}
+	indices.swap(result);
+	return clusterCount;
+}
+
+void MeshOptimizerClass::OptimizeVertexFetch(MeshData& mesh) {
+	// Lay vertices out in the order the index buffer first touches them, unused vertices are dropped.
+	const unsigned int UNUSED = 0xFFFFFFFF;
+	std::vector<unsigned int> remap(mesh.vertices.size(), UNUSED);
+	std::vector<MeshVertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (unsigned int& index : mesh.indices) {
+		if (remap[index] == UNUSED) {
+			remap[index] = (unsigned int)vertices.size();
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	mesh.vertices.swap(vertices);
+}
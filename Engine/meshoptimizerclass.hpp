@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+#include "meshtypes.hpp"
+
+// Post-transform cache statistics of an index buffer, measured with a FIFO cache simulator.
+struct MeshCacheStats {
+	float acmr = 0.0f;	// Average cache miss ratio, transformed vertices per triangle. 0.5 is the ideal for large grids, 3 the worst case.
+	float atvr = 0.0f;	// Average transformed to vertex ratio, 1 means every vertex is shaded exactly once.
+};
+
+struct MeshOptimizeStats {
+	MeshCacheStats before;
+	MeshCacheStats after;
+	size_t clusters = 0;	// Number of overdraw clusters that were sorted, 0 when that pass was off.
+};
+
+// Reorders triangles for the post-transform vertex cache (Forsyth), optionally sorts cache independent clusters to cut
+// overdraw, then reorders vertices in first use order for fetch locality.
+class MeshOptimizerClass {
+public:
+	static MeshOptimizeStats Optimize(MeshData& mesh, bool reduceOverdraw);
+	static MeshCacheStats AnalyzeCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = SIMULATED_CACHE_SIZE);
+
+	static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+	static size_t OptimizeOverdraw(MeshData& mesh);
+	static void OptimizeVertexFetch(MeshData& mesh);
+
+	static constexpr unsigned int SIMULATED_CACHE_SIZE = 16;	// Conservative FIFO size for the post-transform cache of current GPUs.
+
+private:
+	static constexpr unsigned int FORSYTH_CACHE_SIZE = 32;	// LRU size the Forsyth scores are tuned for.
+	static float VertexScore(int cachePosition, unsigned int remainingValence);
+};
@@ -0,0 +1,343 @@
+#include "meshsimplifierclass.hpp"
+#include "meshoptimizerclass.hpp"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+void MeshSimplifierClass::Quadric::AddPlane(const float n[3], float offset, float weight) {
+	a[0] += weight * n[0] * n[0];
+	a[1] += weight * n[1] * n[1];
+	a[2] += weight * n[2] * n[2];
+	a[3] += weight * n[0] * n[1];
+	a[4] += weight * n[0] * n[2];
+	a[5] += weight * n[1] * n[2];
+	for (int k = 0; k < 3; k++) { b[k] += weight * offset * n[k]; }
+	c += weight * offset * offset;
+}
+
+void MeshSimplifierClass::Quadric::AddAttribute(int attribute, const float gradient[3], float offset, float weight) {
+	// The squared difference to the face's linear attribute field, expanded so it sums like the plane terms.
+	AddPlane(gradient, offset, weight);
+	for (int k = 0; k < 3; k++) { g[attribute][k] += weight * gradient[k]; }
+	d[attribute] += weight * offset;
+}
+
+void MeshSimplifierClass::Quadric::Add(const Quadric& other) {
+	for (int k = 0; k < 6; k++) { a[k] += other.a[k]; }
+	for (int k = 0; k < 3; k++) { b[k] += other.b[k]; }
+	c += other.c;
+	area += other.area;
+	for (int j = 0; j < ATTRIBUTES; j++) {
+		for (int k = 0; k < 3; k++) { g[j][k] += other.g[j][k]; }
+		d[j] += other.d[j];
+	}
+}
+
+float MeshSimplifierClass::Quadric::Evaluate(const float p[3], const float s[ATTRIBUTES]) const {
+	float x = p[0], y = p[1], z = p[2];
+	float result = a[0] * x * x + a[1] * y * y + a[2] * z * z + 2.0f * (a[3] * x * y + a[4] * x * z + a[5] * y * z);
+	result += 2.0f * (b[0] * x + b[1] * y + b[2] * z) + c;
+	for (int j = 0; j < ATTRIBUTES; j++) {
+		result += area * s[j] * s[j] - 2.0f * s[j] * (g[j][0] * x + g[j][1] * y + g[j][2] * z + d[j]);
+	}
+
+	// Averaged over the area the quadric covers, so the square root reads as a distance.
+	result = std::max(result, 0.0f);
+	return area > 0.0f ? result / area : result;
+}
+
+float MeshSimplifierClass::DistanceSquared(const float a[3], const float b[3]) {
+	float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+	return x * x + y * y + z * z;
+}
+
+std::vector<MeshLod> MeshSimplifierClass::BuildLods(MeshData& mesh, const MeshSimplifySettings& settings) {
+	std::vector<MeshLod> lods(1);
+	lods[0].indexCount = (uint32_t)mesh.indices.size();
+	if (settings.lodCount <= 1 || mesh.indices.empty()) { return lods; }
+
+	size_t levels = settings.lodCount - 1;
+	std::vector<std::vector<unsigned int>> results(levels);
+	std::vector<float> errors(levels, 0.0f);
+	{
+		std::vector<std::thread> workers;
+		double target = (double)mesh.indices.size();
+		for (size_t level = 0; level < levels; level++) {
+			target *= settings.reduction;
+			size_t targetIndexCount = (size_t)(target / 3.0) * 3;
+			workers.emplace_back([&, level, targetIndexCount]() {
+				results[level] = Simplify(mesh, targetIndexCount, settings.maxError, settings, errors[level]);
+			});
+		}
+		for (std::thread& worker : workers) { worker.join(); }
+	}
+
+	// A level that hardly saves anything over the one before is not worth a switch, and the coarser ones ran into
+	// the same error limit.
+	size_t previous = mesh.indices.size();
+	for (size_t level = 0; level < levels; level++) {
+		std::vector<unsigned int>& indices = results[level];
+		if (indices.empty() || indices.size() * 10 > previous * 9) { break; }
+
+		MeshOptimizerClass::OptimizeVertexCache(indices, mesh.vertices.size());
+		MeshLod lod;
+		lod.indexStart = (uint32_t)mesh.indices.size();
+		lod.indexCount = (uint32_t)indices.size();
+		lod.error = errors[level];
+		lods.push_back(lod);
+		mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+		previous = indices.size();
+	}
+	return lods;
+}
+
+std::vector<unsigned int> MeshSimplifierClass::Simplify(const MeshData& mesh, size_t targetIndexCount, float maxError, const MeshSimplifySettings& settings, float& error) {
+	error = 0.0f;
+	std::vector<unsigned int> indices = mesh.indices;
+	const size_t vertexCount = mesh.vertices.size();
+	if (indices.size() <= targetIndexCount || vertexCount == 0) { return indices; }
+
+	// Work on a copy scaled to a unit box, so errors are relative to the mesh extent.
+	float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (const MeshVertex& vertex : mesh.vertices) {
+		for (int k = 0; k < 3; k++) {
+			minimum[k] = std::min(minimum[k], vertex.Position()[k]);
+			maximum[k] = std::max(maximum[k], vertex.Position()[k]);
+		}
+	}
+	float extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+	if (!(extent > 0.0f)) { extent = 1.0f; }
+
+	std::vector<float> positions(vertexCount * 3);
+	std::vector<float> attributes(vertexCount * ATTRIBUTES);
+	for (size_t i = 0; i < vertexCount; i++) {
+		const MeshVertex& vertex = mesh.vertices[i];
+		for (int k = 0; k < 3; k++) { positions[i * 3 + k] = (vertex.Position()[k] - minimum[k]) / extent; }
+		float* s = &attributes[i * ATTRIBUTES];
+		s[0] = vertex.Texcoord()[0] * settings.texcoordWeight;
+		s[1] = vertex.Texcoord()[1] * settings.texcoordWeight;
+		for (int k = 0; k < 3; k++) { s[2 + k] = vertex.Normal()[k] * settings.normalWeight; }
+	}
+	auto position = [&](unsigned int i) { return &positions[i * 3]; };
+	auto normal = [](const float* a, const float* b, const float* c, float n[3]) {
+		float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		n[0] = ab[1] * ac[2] - ab[2] * ac[1];
+		n[1] = ab[2] * ac[0] - ab[0] * ac[2];
+		n[2] = ab[0] * ac[1] - ab[1] * ac[0];
+	};
+
+	// Vertices that share a position with another one sit on a texture or normal seam, moving them would tear it.
+	std::vector<uint8_t> seam(vertexCount, 0);
+	{
+		std::vector<unsigned int> order(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) { order[i] = (unsigned int)i; }
+		auto less = [&](unsigned int a, unsigned int b) { return memcmp(mesh.vertices[a].Position(), mesh.vertices[b].Position(), sizeof(float) * 3) < 0; };
+		std::sort(order.begin(), order.end(), less);
+		for (size_t i = 1; i < vertexCount; i++) {
+			if (less(order[i - 1], order[i])) { continue; }
+			seam[order[i - 1]] = seam[order[i]] = 1;
+		}
+	}
+
+	auto edgeKey = [](unsigned int a, unsigned int b) { return ((uint64_t)a << 32) | b; };
+	std::unordered_map<uint64_t, uint32_t> edges;
+	auto findEdges = [&]() {
+		edges.clear();
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int k = 0; k < 3; k++) { edges[edgeKey(indices[i + k], indices[i + (k + 1) % 3])]++; }
+		}
+	};
+	auto isBorder = [&](unsigned int a, unsigned int b) { return edges.count(edgeKey(a, b)) + edges.count(edgeKey(b, a)) == 1; };
+
+	std::vector<Quadric> quadrics(vertexCount);
+	std::vector<float> facing(vertexCount * 3, 0.0f);	// Area weighted normal of the surface each vertex stands for.
+	findEdges();
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const unsigned int* triangle = &indices[i];
+		const float* p0 = position(triangle[0]);
+		const float* p1 = position(triangle[1]);
+		const float* p2 = position(triangle[2]);
+		float n[3];
+		normal(p0, p1, p2, n);
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0f) { continue; }
+
+		Quadric face;
+		float weight = length * 0.5f;
+		float unit[3] = { n[0] / length, n[1] / length, n[2] / length };
+		face.AddPlane(unit, -(unit[0] * p0[0] + unit[1] * p0[1] + unit[2] * p0[2]), weight);
+		face.area = weight;
+
+		// Gradient of the linearly interpolated attribute, ((s1 - s0)(e2 x n) + (s2 - s0)(n x e1)) / |n|^2.
+		float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		float e2n[3] = { e2[1] * n[2] - e2[2] * n[1], e2[2] * n[0] - e2[0] * n[2], e2[0] * n[1] - e2[1] * n[0] };
+		float ne1[3] = { n[1] * e1[2] - n[2] * e1[1], n[2] * e1[0] - n[0] * e1[2], n[0] * e1[1] - n[1] * e1[0] };
+		for (int j = 0; j < ATTRIBUTES; j++) {
+			float s0 = attributes[triangle[0] * ATTRIBUTES + j];
+			float s1 = attributes[triangle[1] * ATTRIBUTES + j] - s0;
+			float s2 = attributes[triangle[2] * ATTRIBUTES + j] - s0;
+			float gradient[3];
+			for (int k = 0; k < 3; k++) { gradient[k] = (s1 * e2n[k] + s2 * ne1[k]) / (length * length); }
+			face.AddAttribute(j, gradient, s0 - (gradient[0] * p0[0] + gradient[1] * p0[1] + gradient[2] * p0[2]), weight);
+		}
+		for (int k = 0; k < 3; k++) {
+			quadrics[triangle[k]].Add(face);
+			for (int axis = 0; axis < 3; axis++) { facing[triangle[k] * 3 + axis] += n[axis]; }
+		}
+
+		// Open edges get a plane standing on them, so borders keep their outline.
+		for (int k = 0; k < 3; k++) {
+			unsigned int a = triangle[k], b = triangle[(k + 1) % 3];
+			if (!isBorder(a, b)) { continue; }
+			const float* pa = position(a);
+			const float* pb = position(b);
+			float edge[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+			float m[3] = { edge[1] * unit[2] - edge[2] * unit[1], edge[2] * unit[0] - edge[0] * unit[2], edge[0] * unit[1] - edge[1] * unit[0] };
+			float edgeLength = sqrtf(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+			if (edgeLength == 0.0f) { continue; }
+			for (int axis = 0; axis < 3; axis++) { m[axis] /= edgeLength; }
+			float offset = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+			quadrics[a].AddPlane(m, offset, edgeLength * edgeLength * BORDER_WEIGHT);
+			quadrics[b].AddPlane(m, offset, edgeLength * edgeLength * BORDER_WEIGHT);
+		}
+	}
+
+	struct Collapse {
+		unsigned int from;
+		unsigned int to;
+		float cost;	// Squared relative error.
+	};
+	std::vector<Collapse> collapses;
+	std::vector<VertexKind> kinds(vertexCount);
+	std::vector<uint8_t> borderEdges(vertexCount);
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<uint8_t> touched(vertexCount);
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+	std::vector<uint32_t> triangles;
+	const float maxCost = maxError * maxError;
+	float largestCost = 0.0f;
+
+	// Every pass collapses the cheapest edges whose vertices no earlier collapse of the same pass touched, then
+	// rebuilds the topology from the shrunken index buffer.
+	while (indices.size() > targetIndexCount) {
+		findEdges();
+		std::fill(borderEdges.begin(), borderEdges.end(), 0);
+		for (const auto& edge : edges) {
+			unsigned int a = (unsigned int)(edge.first >> 32), b = (unsigned int)edge.first;
+			if (edge.second > 1) { borderEdges[a] = borderEdges[b] = UINT8_MAX; }	// Non-manifold.
+			else if (!edges.count(edgeKey(b, a))) {
+				borderEdges[a] = (uint8_t)std::min(borderEdges[a] + 1, (int)UINT8_MAX);
+				borderEdges[b] = (uint8_t)std::min(borderEdges[b] + 1, (int)UINT8_MAX);
+			}
+		}
+		for (size_t i = 0; i < vertexCount; i++) {
+			if (seam[i]) { kinds[i] = VERTEX_LOCKED; }
+			else if (borderEdges[i] == 0) { kinds[i] = VERTEX_MANIFOLD; }
+			else { kinds[i] = borderEdges[i] == 2 ? VERTEX_BORDER : VERTEX_LOCKED; }
+		}
+
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (unsigned int index : indices) { triangleOffsets[index + 1]++; }
+		for (size_t i = 0; i < vertexCount; i++) { triangleOffsets[i + 1] += triangleOffsets[i]; }
+		triangles.resize(indices.size());
+		std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++) { triangles[fill[indices[i]]++] = (uint32_t)(i / 3); }
+
+		auto canCollapse = [&](unsigned int from, unsigned int to) {
+			if (kinds[from] == VERTEX_MANIFOLD) { return true; }
+			return kinds[from] == VERTEX_BORDER && isBorder(from, to);
+		};
+		collapses.clear();
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = indices[i + k], b = indices[i + (k + 1) % 3];
+				if (a > b && edges.count(edgeKey(b, a))) { continue; }	// Inner edges show up from both sides.
+
+				Collapse best{ a, b, FLT_MAX };
+				if (canCollapse(a, b)) { best.cost = quadrics[a].Evaluate(position(b), &attributes[b * ATTRIBUTES]); }
+				if (canCollapse(b, a)) {
+					float cost = quadrics[b].Evaluate(position(a), &attributes[a * ATTRIBUTES]);
+					if (cost < best.cost) { best = { b, a, cost }; }
+				}
+				if (best.cost <= maxCost) { collapses.push_back(best); }
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		// Returns how many triangles the collapse removes, or -1 when a remaining triangle would fold over.
+		auto trianglesRemoved = [&](unsigned int from, unsigned int to) {
+			int removed = 0;
+			for (uint32_t k = triangleOffsets[from]; k < triangleOffsets[from + 1]; k++) {
+				const unsigned int* triangle = &indices[triangles[k] * 3];
+				unsigned int v[3] = { remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] };
+				if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) { continue; }
+				if (v[0] == to || v[1] == to || v[2] == to) {
+					removed++;
+					continue;
+				}
+
+				const float* p[3] = { position(v[0]), position(v[1]), position(v[2]) };
+				float before[3], after[3];
+				normal(p[0], p[1], p[2], before);
+				for (int i = 0; i < 3; i++) { if (v[i] == from) { p[i] = position(to); } }
+				normal(p[0], p[1], p[2], after);
+				float afterLength = after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+				if (afterLength <= SLIVER_THRESHOLD * DistanceSquared(p[0], p[1]) * DistanceSquared(p[0], p[2])) { return -1; }	// Collinear, the normal is rounding noise.
+
+				float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				float lengths = sqrtf((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) * afterLength);
+				if (dot <= FLIP_THRESHOLD * lengths) { return -1; }
+
+				// Small turns add up over many passes, so the original surface has to agree as well.
+				float original = 0.0f;
+				for (int i = 0; i < 3; i++) {
+					const float* f = &facing[(v[i] == from ? to : v[i]) * 3];
+					original += f[0] * after[0] + f[1] * after[1] + f[2] * after[2];
+				}
+				if (original <= 0.0f) { return -1; }
+			}
+			return removed;
+		};
+
+		for (size_t i = 0; i < vertexCount; i++) { remap[i] = (unsigned int)i; }
+		std::fill(touched.begin(), touched.end(), 0);
+		size_t toRemove = (indices.size() - targetIndexCount + 2) / 3;
+		size_t removed = 0;
+		size_t performed = 0;
+		for (const Collapse& collapse : collapses) {
+			if (removed >= toRemove) { break; }
+			if (touched[collapse.from] || touched[collapse.to]) { continue; }
+			int count = trianglesRemoved(collapse.from, collapse.to);
+			if (count < 0) { continue; }
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+			for (int axis = 0; axis < 3; axis++) { facing[collapse.to * 3 + axis] += facing[collapse.from * 3 + axis]; }
+			touched[collapse.from] = touched[collapse.to] = 1;
+			largestCost = std::max(largestCost, collapse.cost);
+			removed += count;
+			performed++;
+		}
+		if (performed == 0) { break; }
+
+		size_t kept = 0;
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+			if (a == b || b == c || a == c) { continue; }
+			indices[kept++] = a;
+			indices[kept++] = b;
+			indices[kept++] = c;
+		}
+		indices.resize(kept);
+	}
+
+	error = sqrtf(largestCost) * extent;
+	return indices;
+}
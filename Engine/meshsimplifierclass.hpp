@@ -0,0 +1,58 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "meshtypes.hpp"
+
+// One level of detail, a range of the shared index buffer with its own meshlets. Cooked into the mesh file as is.
+struct MeshLod {
+	uint32_t indexStart = 0;
+	uint32_t indexCount = 0;
+	uint32_t meshletStart = 0;
+	uint32_t meshletCount = 0;
+	float error = 0.0f;	// Largest collapse error scaled to model units, attribute deviation included.
+	uint32_t padding[3]{};
+};
+
+struct MeshSimplifySettings {
+	uint32_t lodCount = 4;		// Including the full detail level.
+	float reduction = 0.5f;		// Triangles of each level relative to the one before.
+	float maxError = 0.05f;		// Relative to the mesh extent, coarser levels are dropped once they need more.
+	float texcoordWeight = 1.0f;	// How much attribute deviation counts against the geometric error.
+	float normalWeight = 0.5f;
+};
+
+// Quadric error edge collapse (Garland/Heckbert) with Hoppe's attribute extension for texture coordinates and
+// normals. Vertices collapse onto neighbouring vertices, so every level shares the full detail vertex buffer.
+// Open borders only slide along themselves and texture seams are kept as they are.
+class MeshSimplifierClass {
+public:
+	// Appends the coarser levels to mesh.indices, the current index buffer becomes level 0. Levels are simplified
+	// from the full detail mesh on their own threads.
+	static std::vector<MeshLod> BuildLods(MeshData& mesh, const MeshSimplifySettings& settings);
+	// Collapses edges until at most targetIndexCount indices are left or the next collapse would exceed maxError.
+	static std::vector<unsigned int> Simplify(const MeshData& mesh, size_t targetIndexCount, float maxError, const MeshSimplifySettings& settings, float& error);
+
+private:
+	static constexpr int ATTRIBUTES = 5;	// Texture coordinate and normal.
+	static constexpr float BORDER_WEIGHT = 10.0f;
+	static constexpr float FLIP_THRESHOLD = 0.25f;	// Smallest cosine between a triangle's normal before and after a collapse.
+	static constexpr float SLIVER_THRESHOLD = 1e-4f;	// Smallest squared sine of a corner a collapse may leave.
+
+	struct Quadric {
+		float a[6]{};	// Symmetric 3x3, xx yy zz xy xz yz.
+		float b[3]{};
+		float c = 0.0f;
+		float area = 0.0f;
+		float g[ATTRIBUTES][3]{};	// Area weighted attribute gradients.
+		float d[ATTRIBUTES]{};
+
+		void AddPlane(const float n[3], float offset, float weight);
+		void AddAttribute(int attribute, const float gradient[3], float offset, float weight);
+		void Add(const Quadric& other);
+		float Evaluate(const float p[3], const float s[ATTRIBUTES]) const;
+	};
+	static float DistanceSquared(const float a[3], const float b[3]);
+
+	enum VertexKind : uint8_t { VERTEX_MANIFOLD, VERTEX_BORDER, VERTEX_LOCKED };
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <float.h>
+#include <vector>
+#include "vertexlayoutclass.hpp"
+
+// CPU side mesh data shared by the cooking steps. Kept free of DirectXMath so the cooker builds anywhere. A vertex is
+// the full float layout the importers fill and the encoder packs, see VertexEncoderClass::Describe.
+inline constexpr VertexLayout MESH_VERTEX_LAYOUT = VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_FLOAT3).Add(SEMANTIC_TEXCOORD, ELEMENT_FLOAT2)
+	.Add(SEMANTIC_NORMAL, ELEMENT_FLOAT3);
+typedef VertexStruct<MESH_VERTEX_LAYOUT> MeshVertex;
+
+// Box and sphere around a mesh in model space. Importers fill the box, the cooker adds the sphere and the density.
+struct MeshBounds {
+	float minimum[3]{ FLT_MAX, FLT_MAX, FLT_MAX };
+	float maximum[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	float center[3]{};
+	float radius = 0.0f;
+	float worldPerTexcoord = 0.0f;	// Model space length one unit of UV covers on average, 0 without UVs.
+
+	bool IsEmpty() const { return minimum[0] > maximum[0]; }
+	void Add(const float p[3]) {
+		for (int k = 0; k < 3; k++) {
+			if (p[k] < minimum[k]) { minimum[k] = p[k]; }
+			if (p[k] > maximum[k]) { maximum[k] = p[k]; }
+		}
+	}
+	void Add(const MeshBounds& other) {
+		if (other.IsEmpty()) { return; }
+		Add(other.minimum);
+		Add(other.maximum);
+	}
+};
+
+struct MeshData {
+	std::vector<MeshVertex> vertices;
+	std::vector<unsigned int> indices;
+	MeshBounds bounds;
+};
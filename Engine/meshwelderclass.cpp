@@ -0,0 +1,62 @@
+#include "meshwelderclass.hpp"
+#include <string.h>
+
+MeshWeldStats MeshWelderClass::Weld(MeshData& mesh) {
+	MeshWeldStats stats;
+	size_t vertexCount = mesh.vertices.size();
+	stats.verticesBefore = vertexCount;
+	stats.bytesBefore = vertexCount * sizeof(MeshVertex) + mesh.indices.size() * sizeof(unsigned int);
+
+	// Open addressing table of vertex indices, kept at most half full.
+	size_t tableSize = 16;
+	while (tableSize < vertexCount * 2) { tableSize *= 2; }
+	const unsigned int EMPTY = 0xFFFFFFFF;
+	std::vector<unsigned int> table(tableSize, EMPTY);
+	std::vector<unsigned int> remap(vertexCount);
+
+	size_t uniqueCount = 0;
+	for (size_t i = 0; i < vertexCount; i++) {
+		MeshVertex& vertex = mesh.vertices[i];
+		size_t slot = Hash(vertex) & (tableSize - 1);
+		while (table[slot] != EMPTY && !Equal(mesh.vertices[table[slot]], vertex)) { slot = (slot + 1) & (tableSize - 1); }
+
+		if (table[slot] == EMPTY) {
+			// Compact in place, the unique vertex never moves past the one being read.
+			mesh.vertices[uniqueCount] = vertex;
+			table[slot] = (unsigned int)uniqueCount;
+			uniqueCount++;
+		}
+		remap[i] = table[slot];
+	}
+	mesh.vertices.resize(uniqueCount);
+	mesh.vertices.shrink_to_fit();
+
+	for (unsigned int& index : mesh.indices) { index = remap[index]; }
+
+	stats.verticesAfter = uniqueCount;
+	stats.bytesAfter = uniqueCount * sizeof(MeshVertex) + mesh.indices.size() * IndexStride(uniqueCount);
+	return stats;
+}
+
+size_t MeshWelderClass::Hash(const MeshVertex& vertex) {
+	// FNV-1a over the raw bits, with -0.0 folded into 0.0 so they weld together.
+	unsigned int words[sizeof(MeshVertex) / 4];
+	memcpy(words, &vertex, sizeof(words));
+	unsigned long long hash = 14695981039346656037ull;
+	for (unsigned int word : words) {
+		if (word == 0x80000000u) { word = 0; }
+		hash = (hash ^ word) * 1099511628211ull;
+	}
+	return (size_t)(hash ^ (hash >> 32));
+}
+
+bool MeshWelderClass::Equal(const MeshVertex& a, const MeshVertex& b) {
+	float x[sizeof(MeshVertex) / sizeof(float)];
+	float y[sizeof(MeshVertex) / sizeof(float)];
+	memcpy(x, &a, sizeof(x));
+	memcpy(y, &b, sizeof(y));
+	for (size_t i = 0; i < sizeof(x) / sizeof(float); i++) {
+		if (!(x[i] == y[i]) && memcmp(&x[i], &y[i], sizeof(float)) != 0) { return false; }	// Equal NaN payloads still weld.
+	}
+	return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <stddef.h>
+#include "meshtypes.hpp"
+
+struct MeshWeldStats {
+	size_t verticesBefore = 0;
+	size_t verticesAfter = 0;
+	size_t bytesBefore = 0;		// Vertex and index bytes as they would have been uploaded without welding.
+	size_t bytesAfter = 0;		// Same after welding, with 16-bit indices when they fit.
+
+	size_t BytesSaved() const { return bytesBefore > bytesAfter ? bytesBefore - bytesAfter : 0; }
+};
+
+// Merges bit identical vertices and rewrites the index list to point at the survivors.
+class MeshWelderClass {
+public:
+	static MeshWeldStats Weld(MeshData& mesh);
+	static size_t IndexStride(size_t vertexCount) { return vertexCount <= 0x10000 ? 2 : 4; }
+
+private:
+	static size_t Hash(const MeshVertex& vertex);
+	static bool Equal(const MeshVertex& a, const MeshVertex& b);
+};
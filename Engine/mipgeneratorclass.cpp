@@ -0,0 +1,310 @@
+#include "mipgeneratorclass.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPGENERATOR_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MIPGENERATOR_NEON
+#endif
+
+static constexpr int LINEAR_STEPS = 65535;	// Fine enough that no sRGB byte is lost, 1/255 sRGB is 20 steps.
+static constexpr double KAISER_ALPHA = 4.0;
+static constexpr double PI = 3.14159265358979323846;
+
+// One RGBA pixel as linear floats, the filters below are the same for every instruction set.
+#if defined(MIPGENERATOR_SSE2)
+typedef __m128 Pixel;
+static inline Pixel Zero() { return _mm_setzero_ps(); }
+static inline Pixel Load(const float* p) { return _mm_loadu_ps(p); }
+static inline void Store(float* p, Pixel pixel) { _mm_storeu_ps(p, pixel); }
+static inline Pixel MultiplyAdd(Pixel sum, Pixel pixel, float weight) { return _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(weight))); }
+static inline Pixel Add(Pixel a, Pixel b) { return _mm_add_ps(a, b); }
+#elif defined(MIPGENERATOR_NEON)
+typedef float32x4_t Pixel;
+static inline Pixel Zero() { return vdupq_n_f32(0.0f); }
+static inline Pixel Load(const float* p) { return vld1q_f32(p); }
+static inline void Store(float* p, Pixel pixel) { vst1q_f32(p, pixel); }
+static inline Pixel MultiplyAdd(Pixel sum, Pixel pixel, float weight) { return vmlaq_n_f32(sum, pixel, weight); }
+static inline Pixel Add(Pixel a, Pixel b) { return vaddq_f32(a, b); }
+#else
+struct Pixel {
+	float channels[4];
+};
+static inline Pixel Zero() { return Pixel{}; }
+static inline Pixel Load(const float* p) {
+	Pixel pixel;
+	memcpy(pixel.channels, p, sizeof(pixel.channels));
+	return pixel;
+}
+static inline void Store(float* p, Pixel pixel) { memcpy(p, pixel.channels, sizeof(pixel.channels)); }
+static inline Pixel MultiplyAdd(Pixel sum, Pixel pixel, float weight) {
+	for (int i = 0; i < 4; i++) { sum.channels[i] += pixel.channels[i] * weight; }
+	return sum;
+}
+static inline Pixel Add(Pixel a, Pixel b) { return MultiplyAdd(a, b, 1.0f); }
+#endif
+
+namespace {
+
+struct ColorTables {
+	float srgbToLinear[256];
+	float unormToFloat[256];
+	unsigned char linearToSrgb[LINEAR_STEPS + 1];
+};
+
+// Separable weights over the texels of the larger level, destination texel x takes source texels 2x + first onwards.
+struct Kernel {
+	int first;
+	int count;
+	float weights[4 * MipGeneratorClass::KAISER_RADIUS];
+};
+
+}
+
+static const ColorTables& GetColorTables() {
+	static const ColorTables tables = [] {
+		ColorTables result;
+		for (int i = 0; i < 256; i++) {
+			double value = i / 255.0;
+			result.srgbToLinear[i] = (float)(value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4));
+			result.unormToFloat[i] = (float)value;
+		}
+		for (int i = 0; i <= LINEAR_STEPS; i++) {
+			double linear = (double)i / LINEAR_STEPS;
+			double value = linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+			result.linearToSrgb[i] = (unsigned char)(value * 255.0 + 0.5);
+		}
+		return result;
+	}();
+	return tables;
+}
+
+static double BesselI0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		double factor = x / (2.0 * k);
+		term *= factor * factor;
+		sum += term;
+	}
+	return sum;
+}
+
+static const Kernel& GetKernel(MipFilter filter) {
+	static const Kernel box = { 0, 2, { 0.5f, 0.5f } };
+	static const Kernel kaiser = [] {
+		const int radius = MipGeneratorClass::KAISER_RADIUS;
+		Kernel result = { 1 - 2 * radius, 4 * radius, {} };
+		double weights[4 * radius];
+		double total = 0.0;
+		for (int k = 0; k < result.count; k++) {
+			double distance = (result.first + k - 0.5) / 2.0;	// Source texel center to destination texel center, in destination texels.
+			double sinc = sin(PI * distance) / (PI * distance);
+			double t = distance / radius;
+			double window = BesselI0(KAISER_ALPHA * sqrt(std::max(0.0, 1.0 - t * t))) / BesselI0(KAISER_ALPHA);
+			weights[k] = sinc * window;
+			total += weights[k];
+		}
+		for (int k = 0; k < result.count; k++) { result.weights[k] = (float)(weights[k] / total); }
+		return result;
+	}();
+	return filter == MIP_FILTER_KAISER ? kaiser : box;
+}
+
+static void DecodeRow(const unsigned char* row, int width, const float* colorTable, const float* alphaTable, float* destination) {
+	for (int x = 0; x < width; x++, row += 4, destination += 4) {
+		destination[0] = colorTable[row[0]];
+		destination[1] = colorTable[row[1]];
+		destination[2] = colorTable[row[2]];
+		destination[3] = alphaTable[row[3]];
+	}
+}
+
+static void FilterRow(const float* row, int width, const Kernel& kernel, float* destination, int destinationWidth) {
+	// Kernels have an even number of taps. Two sums halve the chain of dependent adds.
+	for (int x = 0; x < destinationWidth; x++) {
+		int first = 2 * x + kernel.first;
+		Pixel even = Zero();
+		Pixel odd = Zero();
+		if (first >= 0 && first + kernel.count <= width) {
+			const float* texels = row + (size_t)first * 4;
+			for (int k = 0; k < kernel.count; k += 2) {
+				even = MultiplyAdd(even, Load(texels + k * 4), kernel.weights[k]);
+				odd = MultiplyAdd(odd, Load(texels + k * 4 + 4), kernel.weights[k + 1]);
+			}
+		}
+		else {
+			for (int k = 0; k < kernel.count; k += 2) {
+				int texel = std::min(std::max(first + k, 0), width - 1);
+				int next = std::min(std::max(first + k + 1, 0), width - 1);
+				even = MultiplyAdd(even, Load(row + (size_t)texel * 4), kernel.weights[k]);
+				odd = MultiplyAdd(odd, Load(row + (size_t)next * 4), kernel.weights[k + 1]);
+			}
+		}
+		Store(destination + (size_t)x * 4, Add(even, odd));
+	}
+}
+
+static inline unsigned char ToUnorm(float value) { return (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); }
+
+static inline unsigned char ToSrgb(const ColorTables& tables, float linear) {
+	return tables.linearToSrgb[(int)(std::min(std::max(linear, 0.0f), 1.0f) * LINEAR_STEPS + 0.5f)];
+}
+
+// Rows of the larger level as linear floats. RGBA8 rows are decoded into the scratch row, float rows already are.
+static const float* LoadRow(const unsigned char* source, int width, int row, bool srgb, float* scratch) {
+	const ColorTables& tables = GetColorTables();
+	DecodeRow(source + (size_t)row * width * 4, width, srgb ? tables.srgbToLinear : tables.unormToFloat, tables.unormToFloat, scratch);
+	return scratch;
+}
+
+static const float* LoadRow(const float* source, int width, int row, bool, float*) { return source + (size_t)row * width * 4; }
+
+static void StoreRow(const float* linear, int width, bool srgb, unsigned char* output) {
+	const ColorTables& tables = GetColorTables();
+	for (int x = 0; x < width; x++, output += 4, linear += 4) {
+		for (int channel = 0; channel < 3; channel++) { output[channel] = srgb ? ToSrgb(tables, linear[channel]) : ToUnorm(linear[channel]); }
+		output[3] = ToUnorm(linear[3]);
+	}
+}
+
+static void StoreRow(const float* linear, int width, bool, float* output) {
+	// The negative lobes of the filter can ring below zero next to bright texels, light never is.
+	for (int i = 0; i < width * 4; i++) { output[i] = std::max(linear[i], 0.0f); }
+}
+
+// Destination rows [first, last). Source rows are filtered across into a ring of kernel.count rows, each output row
+// then needs two new ones, and the ring stays small enough for the cache.
+template <class Texel>
+static void DownsampleBand(const Texel* source, int width, int height, Texel* destination, int destinationWidth, int first, int last,
+	const Kernel& kernel, bool srgb) {
+	int firstRow = 2 * first + kernel.first;
+	size_t rowFloats = (size_t)destinationWidth * 4;
+	std::vector<float> decoded((size_t)width * 4);
+	std::vector<float> ring(rowFloats * kernel.count);
+	std::vector<float> sums(rowFloats);
+	int filteredRows = 0;
+
+	for (int y = first; y < last; y++) {
+		int needed = 2 * (y - first) + kernel.count;
+		for (; filteredRows < needed; filteredRows++) {
+			int row = std::min(std::max(firstRow + filteredRows, 0), height - 1);
+			const float* linear = LoadRow(source, width, row, srgb, decoded.data());
+			FilterRow(linear, width, kernel, ring.data() + (size_t)(filteredRows % kernel.count) * rowFloats, destinationWidth);
+		}
+
+		// Down, with the same two sums as across.
+		const float* taps[4 * MipGeneratorClass::KAISER_RADIUS];
+		for (int k = 0; k < kernel.count; k++) { taps[k] = ring.data() + (size_t)((needed - kernel.count + k) % kernel.count) * rowFloats; }
+		for (size_t i = 0; i < rowFloats; i += 4) {
+			Pixel even = Zero();
+			Pixel odd = Zero();
+			for (int k = 0; k < kernel.count; k += 2) {
+				even = MultiplyAdd(even, Load(taps[k] + i), kernel.weights[k]);
+				odd = MultiplyAdd(odd, Load(taps[k + 1] + i), kernel.weights[k + 1]);
+			}
+			Store(sums.data() + i, Add(even, odd));
+		}
+		StoreRow(sums.data(), destinationWidth, srgb, destination + (size_t)y * destinationWidth * 4);
+	}
+}
+
+// The box filter straight from the bytes, four texels per output texel need no scratch rows.
+static void DownsampleBoxBand(const unsigned char* source, int width, int height, unsigned char* destination, int destinationWidth,
+	int first, int last, bool srgb) {
+	const ColorTables& tables = GetColorTables();
+	const float* colorTable = tables.srgbToLinear;
+	size_t stride = (size_t)width * 4;
+	for (int y = first; y < last; y++) {
+		const unsigned char* top = source + (size_t)std::min(2 * y, height - 1) * stride;
+		const unsigned char* bottom = source + (size_t)std::min(2 * y + 1, height - 1) * stride;
+		unsigned char* output = destination + (size_t)y * destinationWidth * 4;
+		for (int x = 0; x < destinationWidth; x++, output += 4) {
+			size_t left = (size_t)std::min(2 * x, width - 1) * 4;
+			size_t right = (size_t)std::min(2 * x + 1, width - 1) * 4;
+			// Bytes that need no conversion average in integers, which rounds halves up where floats could go either way.
+			for (int channel = srgb ? 3 : 0; channel < 4; channel++) {
+				output[channel] = (unsigned char)((top[left + channel] + top[right + channel] + bottom[left + channel] + bottom[right + channel] + 2) >> 2);
+			}
+			if (!srgb) { continue; }
+			for (int channel = 0; channel < 3; channel++) {
+				float linear = (colorTable[top[left + channel]] + colorTable[top[right + channel]] + colorTable[bottom[left + channel]] +
+					colorTable[bottom[right + channel]]) * 0.25f;
+				output[channel] = ToSrgb(tables, linear);
+			}
+		}
+	}
+}
+
+std::vector<MipLevel> MipGeneratorClass::GetLevels(int width, int height) {
+	std::vector<MipLevel> levels;
+	size_t offset = 0;
+	while (true) {
+		levels.push_back({ width, height, offset });
+		if (width == 1 && height == 1) { return levels; }
+		offset += (size_t)width * height * 4;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+}
+
+size_t MipGeneratorClass::GetChainSize(int width, int height) {
+	const MipLevel last = GetLevels(width, height).back();
+	return last.offset + (size_t)last.width * last.height * 4;
+}
+
+void MipGeneratorClass::Generate(unsigned char* chain, int width, int height, MipFilter filter, bool srgb, ThreadPoolClass* pool) {
+	std::vector<MipLevel> levels = GetLevels(width, height);
+	for (size_t i = 1; i < levels.size(); i++) {
+		const MipLevel& above = levels[i - 1];
+		Downsample(chain + above.offset, above.width, above.height, chain + levels[i].offset, filter, srgb, pool);
+	}
+}
+
+void MipGeneratorClass::Generate(float* chain, int width, int height, MipFilter filter, ThreadPoolClass* pool) {
+	std::vector<MipLevel> levels = GetLevels(width, height);
+	for (size_t i = 1; i < levels.size(); i++) {
+		const MipLevel& above = levels[i - 1];
+		Downsample(chain + above.offset, above.width, above.height, chain + levels[i].offset, filter, pool);
+	}
+}
+
+void MipGeneratorClass::Downsample(const float* source, int width, int height, float* destination, MipFilter filter, ThreadPoolClass* pool) {
+	// No bytes to save a scratch row on, so the box is just the shorter kernel.
+	int destinationWidth = std::max(1, width / 2);
+	int destinationHeight = std::max(1, height / 2);
+	const Kernel& kernel = GetKernel(filter);
+	size_t bands = (size_t)(destinationHeight + BAND_ROWS - 1) / BAND_ROWS;
+	auto band = [&](size_t index) {
+		int first = (int)index * BAND_ROWS;
+		DownsampleBand(source, width, height, destination, destinationWidth, first, std::min(first + BAND_ROWS, destinationHeight), kernel, false);
+	};
+
+	if (pool && bands > 1) { pool->ParallelFor(bands, band); }
+	else {
+		for (size_t i = 0; i < bands; i++) { band(i); }
+	}
+}
+
+void MipGeneratorClass::Downsample(const unsigned char* source, int width, int height, unsigned char* destination, MipFilter filter, bool srgb,
+	ThreadPoolClass* pool) {
+	int destinationWidth = std::max(1, width / 2);
+	int destinationHeight = std::max(1, height / 2);
+	const Kernel& kernel = GetKernel(filter);
+	size_t bands = (size_t)(destinationHeight + BAND_ROWS - 1) / BAND_ROWS;
+	auto band = [&](size_t index) {
+		int first = (int)index * BAND_ROWS;
+		int last = std::min(first + BAND_ROWS, destinationHeight);
+		if (filter == MIP_FILTER_BOX) { DownsampleBoxBand(source, width, height, destination, destinationWidth, first, last, srgb); }
+		else { DownsampleBand(source, width, height, destination, destinationWidth, first, last, kernel, srgb); }
+	};
+
+	if (pool && bands > 1) { pool->ParallelFor(bands, band); }
+	else {
+		for (size_t i = 0; i < bands; i++) { band(i); }
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+#include <vector>
+#include "threadpoolclass.hpp"
+
+enum MipFilter {
+	MIP_FILTER_BOX,		// 2x2 average, the same as GenerateMips.
+	MIP_FILTER_KAISER,	// Kaiser windowed sinc, 12 taps in all, 6 a side. Keeps small levels sharper.
+};
+
+struct MipLevel {
+	int width;
+	int height;
+	size_t offset;	// From the start of the chain. Rows are tightly packed, width * 4 bytes, or floats in float chains.
+};
+
+// Builds mip chains of RGBA8 or RGBA float images on the CPU, with no device needed. Color is filtered in linear light
+// when the image is sRGB, alpha is always linear. Float images are linear already. Every level comes from the one
+// above it, so levels run in order while the rows of each level are split into bands that run in parallel when a pool
+// is given.
+class MipGeneratorClass {
+public:
+	static constexpr int KAISER_RADIUS = 3;	// In texels of the smaller level.
+	static constexpr int BAND_ROWS = 32;
+
+	static std::vector<MipLevel> GetLevels(int width, int height);	// Every level down to 1x1.
+	static size_t GetChainSize(int width, int height);	// Bytes, or floats of a float chain.
+
+	// chain starts with level 0 and has room for GetChainSize bytes, the smaller levels are written after it.
+	static void Generate(unsigned char* chain, int width, int height, MipFilter filter, bool srgb, ThreadPoolClass* pool = 0);
+	// One level from the one above it, destination is max(1, width / 2) by max(1, height / 2).
+	static void Downsample(const unsigned char* source, int width, int height, unsigned char* destination, MipFilter filter, bool srgb,
+		ThreadPoolClass* pool = 0);
+	// The same for float images such as HDR ones. Results are clamped at zero, where the filter rings below it.
+	static void Generate(float* chain, int width, int height, MipFilter filter, ThreadPoolClass* pool = 0);
+	static void Downsample(const float* source, int width, int height, float* destination, MipFilter filter, ThreadPoolClass* pool = 0);
+};
@@ -1,134 +1,145 @@
 #include "modelclass.hpp"
 
-bool ModelClass::InitializeBuffers(ID3D11Device * device, ID3D11DeviceContext* deviceContext, char* modelFilename, char* textureFilename)
+bool ModelClass::LoadFiles(AssetPath model, AssetPath texture, const MeshCookSettings& settings)
 {
-	bool success = LoadModel(modelFilename);
+	bool success = LoadModel(model, settings);
 	if (!success) { return false; }
-	success = LoadTexture(device, deviceContext, textureFilename);
-	if (!success) { return false; }
-
-	// Load the vertex array with data.
-	VertexType bottomLeft{ XMFLOAT3(-1.0f, -1.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) };
-	VertexType topLeft{ XMFLOAT3(-1.0f, 1.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) };
-	VertexType topMiddle{ XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT2(0.5f, 0.0f) };
-	VertexType bottomRight{ XMFLOAT3(1.0f, -1.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) };
-	VertexType topRight{ XMFLOAT3(1.0f, 1.0f, 0.0f), XMFLOAT2(1.0f, 0.0f)};
-	VertexType* vertices = new VertexType[vertexCount]{ bottomLeft, topMiddle, bottomRight };
-	if (not vertices) { return false; }
-
-	unsigned long* indices = new unsigned long[indexCount]{ 0,1,2 };	// Create the index array.
-	if (not indices) { return false; }
-
-	// Load the vertex array and index array with data.
-	for (int i = 0; i < vertexCount; i++) {
-		vertices[i].position = m_model[i].GetPosition();
-		vertices[i].texture = m_model[i].GetTexture();
-		vertices[i].normal = m_model[i].GetNormal();
+	return LoadTexture(texture);
+}
 
-		indices[i] = i;
+bool ModelClass::CreateBuffers(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+	if (!isLoaded) { return false; }
+
+	// Shared resources get their GPU objects from whichever of their models comes here first.
+	TextureClass* texture = GetTextureResource();
+	if (!texture->isInitialized) {
+		// Streamed textures start with their tail, Cull asks for the finer mips once the model is seen.
+		TextureStreamerClass* streamer = m_registry->textureStreamer;
+		uint32_t firstMip = streamer ? streamer->Add(m_textureKey, texture->GetMipSizes(), texture->GetCoarsestTopMip()) : 0;
+		if (!texture->Create(device, deviceContext, firstMip)) {
+			if (streamer) { streamer->Remove(m_textureKey); }
+			errorMessage = "could not create the texture";
+			return false;
+		}
+	}
+	MeshClass* mesh = GetMesh();
+	if (!mesh->isInitialized && !mesh->CreateBuffers(device)) {
+		errorMessage = mesh->errorMessage;
+		return false;
 	}
 
-
-	D3D11_BUFFER_DESC vertexBufferDesc = BufferDesc(sizeof(VertexType) * vertexCount);
-	D3D11_SUBRESOURCE_DATA vertexData = Data(vertices);
-	HRESULT result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
-	if (FAILED(result)) { return false; }
-
-	D3D11_BUFFER_DESC indexBufferDesc = BufferDesc(sizeof(unsigned long) * indexCount);
-	D3D11_SUBRESOURCE_DATA indexData = Data(indices);
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-	if (FAILED(result)) { return false; }
-
-	delete[] vertices;
-	vertices = 0;
-	delete[] indices;
-	indices = 0;
-
+	isLoaded = false;
 	return true;
 }
 
-bool ModelClass::LoadModel(char* filename) {
-	std::ifstream fin;
-	fin.open(filename);
-	if (fin.fail())	{ return false; }
-
-	// Read up to the value of vertex count.
-	char input = 0;
-	fin.get(input);
-	while (input != ':') { fin.get(input); }
-
-	fin >> vertexCount;			// Read in the vertex count.
-	indexCount = vertexCount;	// Set the number of indices to be the same as the vertex count.
+AssetHandle<ModelClass> ModelClass::LoadAsync(AssetLoaderClass& loader, ResourceRegistryClass& registry, ID3D11Device* device, ID3D11DeviceContext* deviceContext,
+	AssetPath model, AssetPath texture, const MeshCookSettings& settings, ModelClass* placeholder) {
+	return loader.Load<ModelClass>(
+		[&registry, model, texture, settings](std::string& error) -> ModelClass* {
+			ModelClass* result = new ModelClass(registry, model, texture, settings);
+			if (result->isLoaded) { return result; }
+			error = result->errorMessage;
+			delete result;
+			return 0;
+		},
+		[device, deviceContext](ModelClass& result, std::string& error) {
+			result.isInitialized = result.CreateBuffers(device, deviceContext);
+			if (!result.isInitialized) { error = result.errorMessage; }
+			return result.isInitialized;
+		},
+		placeholder);
+}
 
-	// Create the model using the vertex count that was read in.
-	m_model = new ModelType[vertexCount];
+bool ModelClass::LoadModel(AssetPath model, const MeshCookSettings& settings) {
+	const std::string& filename = m_registry->paths.GetString(model);
+	m_meshHandle = m_registry->meshes.Acquire(ResourceKey(model), [&](std::string& error) -> MeshClass* {
+		MeshClass* mesh = new MeshClass(filename.c_str(), settings);
+		if (mesh->isLoaded) { return mesh; }
+		error = mesh->errorMessage;
+		delete mesh;
+		return 0;
+	}, errorMessage);
+	return m_meshHandle.IsValid();
+}
 
-	// Read up to the beginning of the data.
-	fin.get(input);
-	while (input != ':') { fin.get(input); }
-	fin.get(input);
-	fin.get(input);
+float ModelClass::GetDistance(const float cameraPosition[3], const LodSelection& selection) const {
+	// To the nearest point of the bounds, never nearer than the near plane.
+	const MeshClass* mesh = GetMesh();
+	const float* center = mesh->GetBoundsCenter();
+	float x = center[0] - cameraPosition[0], y = center[1] - cameraPosition[1], z = center[2] - cameraPosition[2];
+	return fmaxf(sqrtf(x * x + y * y + z * z) - mesh->GetBoundsRadius(), selection.nearPlane);
+}
 
-	for (int i = 0; i < vertexCount; i++)	{
-		fin >> m_model[i].x >> m_model[i].y >> m_model[i].z;
-		fin >> m_model[i].tu >> m_model[i].tv;
-		fin >> m_model[i].nx >> m_model[i].ny >> m_model[i].nz;
-	}
-	fin.close();
+size_t ModelClass::SelectLod(float distance, const LodSelection& selection) const {
+	if (selection.pixelScale <= 0.0f || distance <= 0.0f) { return 0; }
+	const std::vector<MeshLod>& lods = GetMesh()->GetLods();
 
-	return true;
+	// An error e at distance z covers e * pixelScale / z pixels.
+	size_t lod = 0;
+	while (lod + 1 < lods.size() && lods[lod + 1].error * selection.pixelScale / distance <= selection.maxPixelError) { lod++; }
+	return lod;
 }
 
-D3D11_BUFFER_DESC ModelClass::BufferDesc(UINT byteWidth) const {
-	// Set up the description of the static vertex/index buffer.
-	D3D11_BUFFER_DESC v{};
-	v.Usage = D3D11_USAGE_DEFAULT;
-	v.ByteWidth = byteWidth;
-	v.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	v.CPUAccessFlags = 0;
-	v.MiscFlags = 0;
-	v.StructureByteStride = 0;
-	return v;
+void ModelClass::RequestTextureMips(float distance, const LodSelection& selection) {
+	TextureStreamerClass* streamer = m_registry->textureStreamer;
+	TextureClass* texture = GetTextureResource();
+	if (!streamer || !texture || !texture->isInitialized) { return; }
+
+	uint32_t mip = 0;
+	float worldPerTexcoord = GetMesh()->GetWorldPerTexcoord();
+	if (selection.pixelScale > 0.0f && distance > 0.0f && worldPerTexcoord > 0.0f) {
+		// Texels of this model's region over a unit of its surface against the pixels a unit covers from here.
+		float texelsPerWorld = texture->GetWidth() * textureRegion.scaleBias[0] / worldPerTexcoord;
+		mip = TextureStreamerClass::GetDesiredMip(texelsPerWorld, selection.pixelScale / distance, texture->GetMipLevels());
+	}
+	streamer->Request(m_textureKey, mip);
 }
 
-D3D11_SUBRESOURCE_DATA ModelClass::Data(const void* v) const {
-	// Give the subresource structure a pointer to the vertex/index data.
-	D3D11_SUBRESOURCE_DATA d{};
-	d.pSysMem = v;
-	d.SysMemPitch = 0;
-	d.SysMemSlicePitch = 0;
-	return d;
+const std::vector<IndexRange>& ModelClass::Cull(XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, const LodSelection& selection) {
+	// The meshlet bounds are in model space, so the frustum and camera are brought there instead.
+	XMMATRIX worldView = XMMatrixMultiply(worldMatrix, viewMatrix);
+	XMFLOAT4X4 worldViewProjection;
+	XMStoreFloat4x4(&worldViewProjection, XMMatrixMultiply(worldView, projectionMatrix));
+	XMFLOAT3 cameraPosition;
+	XMStoreFloat3(&cameraPosition, XMMatrixInverse(nullptr, worldView).r[3]);
+
+	float distance = GetDistance(&cameraPosition.x, selection);
+	currentLod = SelectLod(distance, selection);
+	currentScreenSize = selection.pixelScale > 0.0f ? 2.0f * GetMesh()->GetBoundsRadius() * selection.pixelScale / distance : FLT_MAX;
+	MeshletFrustum frustum = MeshletFrustum::FromMatrix(&worldViewProjection.m[0][0], &cameraPosition.x);
+	const MeshClass* mesh = GetMesh();
+	const MeshLod& lod = mesh->GetLods()[currentLod];
+	visibleRanges.clear();
+	cullStats = MeshletClass::Cull(mesh->GetMeshlets().data() + lod.meshletStart, lod.meshletCount, frustum, visibleRanges);
+	if (!visibleRanges.empty()) { RequestTextureMips(distance, selection); }	// Unseen textures age out of the budget.
+	return visibleRanges;
 }
 
 void ModelClass::ShutdownBuffers() {
-	if (m_Texture){
-		delete m_Texture;
-		m_Texture = 0;
-	}
-	if (indexBuffer) {
-		indexBuffer->Release();
-		indexBuffer = 0;
-	}
-	if (vertexBuffer) {
-		vertexBuffer->Release();
-		vertexBuffer = 0;
+	if (m_textureHandle.IsValid()) {
+		m_registry->textures.Release(m_textureHandle);
+		m_textureHandle = ResourceHandle();
+		// The last model of a texture takes it out of the streaming.
+		TextureStreamerClass* streamer = m_registry->textureStreamer;
+		if (streamer && !m_registry->textures.Lookup(m_textureKey)) { streamer->Remove(m_textureKey); }
 	}
-	if (m_model){
-		delete[] m_model;
-		m_model = 0;
+	if (m_meshHandle.IsValid()) {
+		m_registry->meshes.Release(m_meshHandle);
+		m_meshHandle = ResourceHandle();
 	}
 }
 
-void ModelClass::RenderBuffers(ID3D11DeviceContext* deviceContext) const {
-	unsigned int stride = sizeof(VertexType);
-	unsigned int offset = 0;
-
-	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);	// Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-}
-
-bool ModelClass::LoadTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename) {
-	m_Texture = new TextureClass(device, deviceContext, filename);
-	return m_Texture->isInitialized;
+bool ModelClass::LoadTexture(AssetPath texture) {
+	const std::string& filename = m_registry->paths.GetString(texture);
+	m_textureKey = ResourceKey(texture);
+	m_textureHandle = m_registry->textures.Acquire(m_textureKey, [&](std::string& error) -> TextureClass* {
+		std::string path = filename;
+		TextureClass* result = new TextureClass(path.data());
+		if (result->isLoaded) { return result; }
+		error = filename + ": " + result->errorMessage;
+		delete result;
+		return 0;
+	}, errorMessage);
+	return m_textureHandle.IsValid();
 }
\ No newline at end of file
@@ -2,56 +2,80 @@
 
 #include <d3d11.h>
 #include <directxmath.h>
-#include <fstream>
-#include "textureclass.hpp"
+#include "resourceregistryclass.hpp"
+#include "assetloaderclass.hpp"
+#include <float.h>
+#include <math.h>
 using namespace DirectX;
 using namespace std;
 
+// How the level of detail is picked: a level is fine while its error projects to at most maxPixelError pixels.
+struct LodSelection {
+	float pixelScale = 0.0f;	// Viewport height / (2 tan(fov / 2)), 0 always draws full detail.
+	float nearPlane = 0.0f;		// Nothing is closer than this.
+	float maxPixelError = 1.0f;
+};
+
 class ModelClass
 {
 public:
-	ModelClass(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename, char* textureFilename) { isInitialized = InitializeBuffers(device, deviceContext, modelFilename, textureFilename); }
-	ModelClass(const ModelClass&) { isInitialized = true; }
+	ModelClass(ID3D11Device* device, ID3D11DeviceContext* deviceContext, ResourceRegistryClass& registry, AssetPath model, AssetPath texture,
+		const MeshCookSettings& settings = MeshCookSettings())
+		: ModelClass(registry, model, texture, settings) {
+		if (isLoaded) { isInitialized = CreateBuffers(device, deviceContext); }
+	}
+	// Acquires the shared mesh and texture, cooking or decoding them when no other model has yet. Never touches the
+	// GPU, so it can run on a worker thread. The settings only count for the model that loads the mesh first.
+	ModelClass(ResourceRegistryClass& registry, AssetPath model, AssetPath texture, const MeshCookSettings& settings = MeshCookSettings())
+		: m_registry(&registry) {
+		isLoaded = LoadFiles(model, texture, settings);
+	}
+	ModelClass(const ModelClass&) = delete;
 	~ModelClass() { ShutdownBuffers(); }
-	void Render(ID3D11DeviceContext* deviceContext) { RenderBuffers(deviceContext); }
+	void Render(RenderStateClass& states) { GetMesh()->Render(states); }
+	bool CreateBuffers(ID3D11Device* device, ID3D11DeviceContext* deviceContext);	// Second half of a load, on the thread owning the context.
+
+	// Loads on the loader's workers and creates the buffers in its Update.
+	static AssetHandle<ModelClass> LoadAsync(AssetLoaderClass& loader, ResourceRegistryClass& registry, ID3D11Device* device, ID3D11DeviceContext* deviceContext,
+		AssetPath model, AssetPath texture, const MeshCookSettings& settings = MeshCookSettings(), ModelClass* placeholder = 0);
 
-	int GetIndexCount() const { return indexCount; }
-	ID3D11ShaderResourceView* GetTexture() { return m_Texture->GetTexture(); }
+	int GetIndexCount() const { return GetMesh()->GetIndexCount(); }
+	// Picks the level of detail, then collects the index ranges of its meshlets that can be seen with these matrices.
+	const std::vector<IndexRange>& Cull(XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, const LodSelection& selection = LodSelection());
+	const MeshletCullStats& GetCullStats() const { return cullStats; }
+	size_t GetLod() const { return currentLod; }
+	float GetScreenSize() const { return currentScreenSize; }	// Of the bounds on the last Cull, in pixels of the viewport height.
+	size_t GetLodCount() const { return GetMesh()->GetLods().size(); }
+	const MeshCookReport& GetCookReport() const { return GetMesh()->GetCookReport(); }	// Only filled in when the shared mesh had to be cooked.
+	const MeshVertexFormat& GetVertexFormat() const { return GetMesh()->GetVertexFormat(); }	// Shaders build their input layout and dequantization from this.
+	ID3D11ShaderResourceView* GetTexture() { return GetTextureResource()->GetTexture(); }
+	// Set when the texture is a pack, see TexturePackerClass. Many models then draw with one texture.
+	void SetTextureRegion(const TextureRegion& region) { textureRegion = region; }
+	const TextureRegion& GetTextureRegion() const { return textureRegion; }
+	bool isLoaded = false;	// Files are in memory, CreateBuffers has not run yet.
 	bool isInitialized = false;
+	std::string errorMessage;
 
 private:
-	struct VertexType {
-		XMFLOAT3 position{ 0.0f, 0.0f, 0.0f };
-		XMFLOAT2 texture{ 0.0f, 0.0f };
-		XMFLOAT3 normal{ 0.0f, 0.0f, -1.0f };
-
-		VertexType() {};
-		VertexType(XMFLOAT3 pos, XMFLOAT2 tex) : position(pos), texture(tex) {};
-		VertexType(XMFLOAT3 pos, XMFLOAT2 tex, XMFLOAT3 norm) : position(pos), texture(tex), normal(norm) {};
-	};
-	struct ModelType {
-		float x, y, z;
-		float tu, tv;
-		float nx, ny, nz;
-
-		XMFLOAT3 GetPosition() { return XMFLOAT3(x, y, z); }
-		XMFLOAT2 GetTexture() { return XMFLOAT2(tu, tv); }
-		XMFLOAT3 GetNormal() { return XMFLOAT3(nx, ny, nz); }
-	};
-
-	bool InitializeBuffers(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename, char* textureFilename);
+	bool LoadFiles(AssetPath model, AssetPath texture, const MeshCookSettings& settings);
 	void ShutdownBuffers();
-	void RenderBuffers(ID3D11DeviceContext*) const;
-
-	D3D11_BUFFER_DESC BufferDesc(UINT byteWidth) const;
-	D3D11_SUBRESOURCE_DATA Data(const void* v) const;
-	bool LoadTexture(ID3D11Device*, ID3D11DeviceContext*, char*);
-	bool LoadModel(char* filename);
-
-	ID3D11Buffer* vertexBuffer{};
-	ID3D11Buffer* indexBuffer{};
-	TextureClass* m_Texture{};
-	ModelType* m_model{};
-	int vertexCount = 3;	// Set the number of vertices in the vertex array.
-	int indexCount = 3;	// Set the number of indices in the index array.
+	bool LoadTexture(AssetPath texture);
+	bool LoadModel(AssetPath model, const MeshCookSettings& settings);
+	float GetDistance(const float cameraPosition[3], const LodSelection& selection) const;
+	size_t SelectLod(float distance, const LodSelection& selection) const;
+	void RequestTextureMips(float distance, const LodSelection& selection);
+
+	ResourceRegistryClass* m_registry{};
+	ResourceHandle m_meshHandle;
+	ResourceHandle m_textureHandle;
+	uint64_t m_textureKey = 0;	// For the texture streamer.
+	// Shared and swapped by hot reloads, so they are looked up on every use instead of kept.
+	MeshClass* GetMesh() const { return m_registry->meshes.Get(m_meshHandle); }
+	TextureClass* GetTextureResource() const { return m_registry->textures.Get(m_textureHandle); }
+
+	TextureRegion textureRegion;
+	size_t currentLod = 0;
+	float currentScreenSize = FLT_MAX;
+	std::vector<IndexRange> visibleRanges;
+	MeshletCullStats cullStats;
 };
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "modelparserclass.hpp"
+#include <string.h>
+#include <charconv>
+#include <fstream>
+#include <thread>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MODELPARSER_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline unsigned int CountTrailingZeros(unsigned int mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+static inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool ModelParserClass::Parse(const char* filename, MeshData& mesh) {
+	m_filename = filename;
+	m_error.clear();
+	if (!ReadFile(filename)) { return Fail(0, "could not read the file"); }
+
+	size_t position = 0;
+	size_t line = 1;
+	size_t vertexCount = 0;
+	if (!ParseHeader(position, line, vertexCount)) { return false; }
+
+	// Split the data section into chunks that start right after a newline, one per thread.
+	size_t dataSize = m_size - position;
+	size_t threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0) { threadCount = 1; }
+	size_t chunkCount = dataSize / MIN_CHUNK_SIZE + 1;
+	if (chunkCount > threadCount) { chunkCount = threadCount; }
+
+	std::vector<Chunk> chunks(chunkCount);
+	size_t begin = position;
+	for (size_t i = 0; i < chunkCount; i++) {
+		size_t end = (i + 1 == chunkCount) ? m_size : position + dataSize / chunkCount * (i + 1);
+		if (end < begin) { end = begin; }
+		while (end < m_size && m_buffer[end - 1] != '\n') { end++; }
+		chunks[i].begin = begin;
+		chunks[i].end = end;
+		begin = end;
+	}
+
+	auto runChunks = [&](auto work) {
+		std::vector<std::thread> workers;
+		for (size_t i = 1; i < chunkCount; i++) { workers.emplace_back(work, std::ref(chunks[i])); }
+		work(chunks[0]);
+		for (std::thread& worker : workers) { worker.join(); }
+	};
+
+	// First pass finds the rows, then the prefix sums tell every chunk where its vertices and lines start.
+	runChunks([this](Chunk& chunk) { ScanChunk(chunk); });
+
+	size_t rowCount = 0;
+	for (Chunk& chunk : chunks) {
+		chunk.firstVertex = rowCount;
+		chunk.firstLine = line;
+		rowCount += chunk.rows.size();
+		line += chunk.lineCount;
+	}
+	if (rowCount != vertexCount) {
+		return Fail(line, "the header declares " + std::to_string(vertexCount) + " vertices but the data section has " + std::to_string(rowCount) + " rows");
+	}
+
+	mesh.vertices.resize(vertexCount);
+	MeshVertex* vertices = mesh.vertices.data();
+	runChunks([this, vertices](Chunk& chunk) { ParseChunk(chunk, vertices); });
+
+	for (const Chunk& chunk : chunks) {
+		if (!chunk.error.empty()) { return Fail(LineOf(chunk, chunk.errorOffset), chunk.error); }
+	}
+
+	// The text format has no index list, every vertex is drawn once in order.
+	mesh.indices.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) { mesh.indices[i] = (unsigned int)i; }
+
+	return true;
+}
+
+bool ModelParserClass::ReadFile(const char* filename) {
+	std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+	if (fin.fail()) { return false; }
+
+	std::streamoff size = fin.tellg();
+	if (size < 0) { return false; }
+	m_size = (size_t)size;
+	m_buffer.assign(m_size + BUFFER_PADDING, 0);
+
+	fin.seekg(0);
+	fin.read(m_buffer.data(), size);
+	return !fin.fail();
+}
+
+bool ModelParserClass::ParseHeader(size_t& position, size_t& line, size_t& vertexCount) {
+	if (!ExpectLabel(position, line, "Vertex Count:")) { return false; }
+
+	const char* data = m_buffer.data();
+	while (position < m_size && IsBlank(data[position])) { position++; }
+	unsigned long long count = 0;
+	auto result = std::from_chars(data + position, data + m_size, count);
+	if (result.ec != std::errc() || (result.ptr < data + m_size && !IsBlank(*result.ptr) && *result.ptr != '\n')) {
+		return Fail(line, "expected a vertex count after 'Vertex Count:'");
+	}
+	if (count > 0xFFFFFFFFull) { return Fail(line, "vertex count does not fit a 32-bit index"); }
+	vertexCount = (size_t)count;
+	position = result.ptr - data;
+
+	if (!ExpectLabel(position, line, "Data:")) { return false; }
+
+	// Nothing else may follow the label on its line.
+	while (position < m_size && IsBlank(data[position])) { position++; }
+	if (position < m_size && data[position] != '\n') { return Fail(line, "unexpected text after 'Data:'"); }
+	if (position < m_size) {
+		position++;
+		line++;
+	}
+	return true;
+}
+
+bool ModelParserClass::ExpectLabel(size_t& position, size_t& line, const char* label) {
+	// Skips blank lines, then the label has to be the next thing in the file.
+	const char* data = m_buffer.data();
+	while (position < m_size && (IsBlank(data[position]) || data[position] == '\n')) {
+		if (data[position] == '\n') { line++; }
+		position++;
+	}
+
+	size_t length = strlen(label);
+	if (m_size - position < length || memcmp(data + position, label, length) != 0) {
+		return Fail(line, std::string("expected '") + label + "'");
+	}
+	position += length;
+	return true;
+}
+
+void ModelParserClass::ScanChunk(Chunk& chunk) const {
+	const char* data = m_buffer.data();
+	size_t lineStart = chunk.begin;
+
+	auto addLine = [&](size_t newline) {
+		size_t i = lineStart;
+		while (i < newline && IsBlank(data[i])) { i++; }
+		if (i < newline) { chunk.rows.push_back(lineStart); }
+		lineStart = newline + 1;
+		chunk.lineCount++;
+	};
+
+	size_t i = chunk.begin;
+#if defined(__AVX2__)
+	const __m256i newline = _mm256_set1_epi8('\n');
+	for (; i + 32 <= chunk.end; i += 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+		while (mask) {
+			addLine(i + CountTrailingZeros(mask));
+			mask &= mask - 1;
+		}
+	}
+#elif defined(MODELPARSER_SSE2)
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (; i + 16 <= chunk.end; i += 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+		while (mask) {
+			addLine(i + CountTrailingZeros(mask));
+			mask &= mask - 1;
+		}
+	}
+#endif
+	for (; i < chunk.end; i++) {
+		if (data[i] == '\n') { addLine(i); }
+	}
+
+	// The last line of the file does not need a newline.
+	if (lineStart < chunk.end) {
+		size_t j = lineStart;
+		while (j < chunk.end && IsBlank(data[j])) { j++; }
+		if (j < chunk.end) { chunk.rows.push_back(lineStart); }
+	}
+}
+
+void ModelParserClass::ParseChunk(Chunk& chunk, MeshVertex* vertices) const {
+	const char* data = m_buffer.data();
+	for (size_t r = 0; r < chunk.rows.size(); r++) {
+		size_t begin = chunk.rows[r];
+		size_t end = FindRowEnd(begin);
+		if (end > chunk.end) { end = chunk.end; }
+		if (!ParseRow(data + begin, data + end, vertices[chunk.firstVertex + r], chunk.error)) {
+			chunk.errorOffset = begin;
+			return;
+		}
+	}
+}
+
+bool ModelParserClass::ParseRow(const char* begin, const char* end, MeshVertex& vertex, std::string& error) const {
+	float* values[8] = { &vertex.Position()[0], &vertex.Position()[1], &vertex.Position()[2], &vertex.Texcoord()[0], &vertex.Texcoord()[1],
+		&vertex.Normal()[0], &vertex.Normal()[1], &vertex.Normal()[2] };
+
+	const char* p = begin;
+	for (int i = 0; i < 8; i++) {
+		while (p < end && IsBlank(*p)) { p++; }
+		if (p == end) {
+			error = "expected 8 values per row, found " + std::to_string(i);
+			return false;
+		}
+
+		// from_chars takes no plus sign, the iostream loop this replaced did.
+		const char* number = *p == '+' && p + 1 < end && p[1] != '-' ? p + 1 : p;
+		auto result = std::from_chars(number, end, *values[i]);
+		if (result.ec != std::errc() || (result.ptr < end && !IsBlank(*result.ptr))) {
+			const char* token = p;
+			while (p < end && !IsBlank(*p)) { p++; }
+			error = "invalid number '" + std::string(token, p) + "'";
+			return false;
+		}
+		p = result.ptr;
+	}
+
+	while (p < end && IsBlank(*p)) { p++; }
+	if (p != end) {
+		error = "expected 8 values per row, found more";
+		return false;
+	}
+	return true;
+}
+
+size_t ModelParserClass::FindRowEnd(size_t position) const {
+	const void* newline = memchr(m_buffer.data() + position, '\n', m_size - position);
+	return newline ? (const char*)newline - m_buffer.data() : m_size;
+}
+
+size_t ModelParserClass::LineOf(const Chunk& chunk, size_t offset) const {
+	size_t line = chunk.firstLine;
+	for (size_t i = chunk.begin; i < offset; i++) {
+		if (m_buffer[i] == '\n') { line++; }
+	}
+	return line;
+}
+
+bool ModelParserClass::Fail(size_t line, const std::string& message) {
+	// Appended piece by piece, "(" + std::to_string(line) trips GCC 12's -Wrestrict in release builds.
+	m_error = m_filename;
+	if (line > 0) { m_error.append("(").append(std::to_string(line)).append(")"); }
+	m_error.append(": ").append(message);
+	return false;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "meshtypes.hpp"
+
+// Parser for the "Vertex Count: / Data:" text model format. The file is read into one buffer, line ends are found
+// with SIMD and the data rows are converted on several threads with std::from_chars, so it is locale independent.
+class ModelParserClass {
+public:
+	bool Parse(const char* filename, MeshData& mesh);
+	const std::string& GetError() const { return m_error; }	// "file(line): message" of the first problem found.
+
+private:
+	struct Chunk {
+		size_t begin = 0;
+		size_t end = 0;
+		size_t firstLine = 0;		// Line number of the first line in this chunk.
+		size_t firstVertex = 0;		// Index of the first vertex this chunk writes.
+		std::vector<size_t> rows;	// Start offsets of the non blank lines, each row ends at the next newline.
+		size_t lineCount = 0;		// Newlines inside the chunk.
+		size_t errorOffset = 0;
+		std::string error;
+	};
+
+	bool ReadFile(const char* filename);
+	bool ParseHeader(size_t& position, size_t& line, size_t& vertexCount);
+	bool ExpectLabel(size_t& position, size_t& line, const char* label);
+	void ScanChunk(Chunk& chunk) const;
+	void ParseChunk(Chunk& chunk, MeshVertex* vertices) const;
+	bool ParseRow(const char* begin, const char* end, MeshVertex& vertex, std::string& error) const;
+	size_t FindRowEnd(size_t position) const;
+	size_t LineOf(const Chunk& chunk, size_t offset) const;
+	bool Fail(size_t line, const std::string& message);
+
+	static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;	// Smaller files are not worth waking extra threads for.
+	static constexpr size_t BUFFER_PADDING = 64;	// Zeroed tail so the SIMD scan can read whole registers.
+
+	std::string m_filename;
+	std::vector<char> m_buffer;
+	size_t m_size = 0;
+	std::string m_error;
+};
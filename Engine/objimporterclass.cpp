@@ -0,0 +1,326 @@
+#include "objimporterclass.hpp"
+#include <math.h>
+#include <string.h>
+#include <charconv>
+#include <thread>
+#include "mappedfileclass.hpp"
+
+static inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Reads up to count numbers, at least required of them. The rest of the line is ignored, which skips the optional w
+// of positions and texture coordinates and the vertex colors some exporters append.
+static bool ParseFloats(const char* p, const char* end, float* values, int required, int count, std::string& error) {
+	for (int i = 0; i < count; i++) {
+		while (p < end && IsBlank(*p)) { p++; }
+		if (p == end) {
+			if (i >= required) { return true; }
+			error = "expected " + std::to_string(required) + " values, found " + std::to_string(i);
+			return false;
+		}
+
+		auto result = std::from_chars(p, end, values[i]);
+		if (result.ec != std::errc() || (result.ptr < end && !IsBlank(*result.ptr))) {
+			const char* token = p;
+			while (p < end && !IsBlank(*p)) { p++; }
+			error = "invalid number '" + std::string(token, p) + "'";
+			return false;
+		}
+		p = result.ptr;
+	}
+	return true;
+}
+
+bool ObjImporterClass::Import(const char* filename, MeshData& mesh) {
+	m_filename = filename;
+	m_error.clear();
+	MappedFileClass file(filename);
+	if (!file.isInitialized) { return Fail(0, "could not read the file"); }
+	m_data = (const char*)file.GetData();
+	m_size = file.GetSize();
+
+	size_t threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0) { threadCount = 1; }
+	size_t chunkCount = m_size / MIN_CHUNK_SIZE + 1;
+	if (chunkCount > threadCount) { chunkCount = threadCount; }
+
+	std::vector<Chunk> chunks(chunkCount);
+	size_t begin = 0;
+	for (size_t i = 0; i < chunkCount; i++) {
+		size_t end = (i + 1 == chunkCount) ? m_size : m_size / chunkCount * (i + 1);
+		if (end < begin) { end = begin; }
+		while (end < m_size && end > 0 && m_data[end - 1] != '\n') { end++; }
+		chunks[i].begin = begin;
+		chunks[i].end = end;
+		begin = end;
+	}
+
+	auto runChunks = [&](auto work) {
+		std::vector<std::thread> workers;
+		for (size_t i = 1; i < chunkCount; i++) { workers.emplace_back(work, std::ref(chunks[i])); }
+		work(chunks[0]);
+		for (std::thread& worker : workers) { worker.join(); }
+	};
+
+	// Counting first lets the second pass write every element straight to its final place.
+	runChunks([this](Chunk& chunk) { ScanChunk(chunk); });
+
+	size_t line = 1;
+	size_t totals[4]{};
+	for (Chunk& chunk : chunks) {
+		size_t* counts[4] = { &chunk.positions, &chunk.texcoords, &chunk.normals, &chunk.corners };
+		for (int k = 0; k < 4; k++) {
+			size_t count = *counts[k];
+			*counts[k] = totals[k];
+			totals[k] += count;
+		}
+		chunk.firstLine = line;
+		line += chunk.lineCount;
+	}
+	for (const Chunk& chunk : chunks) {
+		if (!chunk.error.empty()) { return Fail(LineOf(chunk, chunk.errorOffset), chunk.error); }
+	}
+	if (totals[3] > UINT32_MAX) { return Fail(0, "too many triangles for 32-bit indices"); }
+
+	for (int k = 0; k < 3; k++) { m_totals[k] = totals[k]; }
+	m_positions.resize(totals[0] * 3);
+	m_texcoords.resize(totals[1] * 2);
+	m_normals.resize(totals[2] * 3);
+	m_corners.resize(totals[3]);
+	runChunks([this](Chunk& chunk) { ParseChunk(chunk); });
+
+	for (const Chunk& chunk : chunks) {
+		if (!chunk.error.empty()) { return Fail(LineOf(chunk, chunk.errorOffset), chunk.error); }
+	}
+	if (totals[3] == 0) { return Fail(0, "the file has no faces"); }
+
+	BuildMesh(mesh);
+
+	m_positions = std::vector<float>();
+	m_texcoords = std::vector<float>();
+	m_normals = std::vector<float>();
+	m_corners = std::vector<Corner>();
+	m_data = 0;
+	return true;
+}
+
+ObjImporterClass::LineType ObjImporterClass::ReadLine(size_t& position, size_t chunkEnd, const char*& begin, const char*& end) const {
+	const char* line = m_data + position;
+	const char* newline = (const char*)memchr(line, '\n', chunkEnd - position);
+	end = newline ? newline : m_data + chunkEnd;
+	position = (end - m_data) + (newline ? 1 : 0);
+
+	const char* comment = (const char*)memchr(line, '#', end - line);
+	if (comment) { end = comment; }
+	begin = line;
+	while (begin < end && IsBlank(*begin)) { begin++; }
+	while (end > begin && IsBlank(end[-1])) { end--; }
+
+	// Keywords the importer has no use for (groups, materials, smoothing groups, lines) are skipped.
+	const char* keyword = begin;
+	while (begin < end && !IsBlank(*begin)) { begin++; }
+	size_t length = begin - keyword;
+	if (length == 1 && keyword[0] == 'v') { return LINE_POSITION; }
+	if (length == 2 && keyword[0] == 'v' && keyword[1] == 't') { return LINE_TEXCOORD; }
+	if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n') { return LINE_NORMAL; }
+	if (length == 1 && keyword[0] == 'f') { return LINE_FACE; }
+	return LINE_OTHER;
+}
+
+void ObjImporterClass::ScanChunk(Chunk& chunk) const {
+	size_t position = chunk.begin;
+	while (position < chunk.end) {
+		size_t lineStart = position;
+		const char* begin;
+		const char* end;
+		LineType type = ReadLine(position, chunk.end, begin, end);
+		chunk.lineCount++;
+
+		switch (type) {
+		case LINE_POSITION: chunk.positions++; break;
+		case LINE_TEXCOORD: chunk.texcoords++; break;
+		case LINE_NORMAL: chunk.normals++; break;
+		case LINE_FACE: {
+			size_t tokens = 0;
+			for (const char* p = begin; p < end;) {
+				while (p < end && IsBlank(*p)) { p++; }
+				if (p == end) { break; }
+				tokens++;
+				while (p < end && !IsBlank(*p)) { p++; }
+			}
+			if (tokens < 3) {
+				chunk.error = "a face needs at least 3 vertices";
+				chunk.errorOffset = lineStart;
+				return;
+			}
+			chunk.corners += (tokens - 2) * 3;
+			break;
+		}
+		default: break;
+		}
+	}
+}
+
+void ObjImporterClass::ParseChunk(Chunk& chunk) {
+	// Running element counts, negative face indices count back from these.
+	size_t seen[3] = { chunk.positions, chunk.texcoords, chunk.normals };
+	size_t corner = chunk.corners;
+	std::vector<Corner> polygon;
+
+	size_t position = chunk.begin;
+	while (position < chunk.end) {
+		size_t lineStart = position;
+		const char* begin;
+		const char* end;
+		switch (ReadLine(position, chunk.end, begin, end)) {
+		case LINE_POSITION: {
+			float* p = &m_positions[seen[0]++ * 3];
+			if (ParseFloats(begin, end, p, 3, 3, chunk.error)) { p[2] = -p[2]; }
+			break;
+		}
+		case LINE_TEXCOORD: {
+			float* t = &m_texcoords[seen[1]++ * 2];
+			t[1] = 0.0f;
+			if (ParseFloats(begin, end, t, 1, 2, chunk.error)) { t[1] = 1.0f - t[1]; }
+			break;
+		}
+		case LINE_NORMAL: {
+			float* n = &m_normals[seen[2]++ * 3];
+			if (ParseFloats(begin, end, n, 3, 3, chunk.error)) { n[2] = -n[2]; }
+			break;
+		}
+		case LINE_FACE:
+			if (!ParseFace(begin, end, seen, polygon, chunk.error)) { break; }
+			for (size_t i = 1; i + 1 < polygon.size(); i++) {
+				m_corners[corner++] = polygon[0];
+				m_corners[corner++] = polygon[i + 1];	// Reversed, OBJ fronts are counter clockwise.
+				m_corners[corner++] = polygon[i];
+			}
+			break;
+		default: break;
+		}
+
+		if (!chunk.error.empty()) {
+			chunk.errorOffset = lineStart;
+			return;
+		}
+	}
+}
+
+bool ObjImporterClass::ParseFace(const char* p, const char* end, const size_t seen[3], std::vector<Corner>& polygon, std::string& error) const {
+	// Each corner is v, v/vt, v//vn or v/vt/vn, indices count from 1 or back from the last element read when negative.
+	polygon.clear();
+	while (true) {
+		while (p < end && IsBlank(*p)) { p++; }
+		if (p == end) { return true; }
+
+		const char* token = p;
+		Corner corner;
+		uint32_t* slots[3] = { &corner.position, &corner.texcoord, &corner.normal };
+		for (int k = 0; k < 3; k++) {
+			if (k > 0) {
+				if (p == end || *p != '/') { break; }
+				p++;
+				if (p == end || *p == '/' || IsBlank(*p)) { continue; }
+			}
+
+			long long value = 0;
+			auto result = std::from_chars(p, end, value);
+			if (result.ec != std::errc()) { break; }
+			p = result.ptr;
+
+			if (value > 0 && (unsigned long long)value <= m_totals[k]) { *slots[k] = (uint32_t)(value - 1); }
+			else if (value < 0 && (unsigned long long)-value <= seen[k]) { *slots[k] = (uint32_t)(seen[k] + value); }
+			else {
+				error = "index " + std::to_string(value) + " is out of range";
+				return false;
+			}
+		}
+
+		if (corner.position == MISSING || (p < end && !IsBlank(*p))) {
+			while (p < end && !IsBlank(*p)) { p++; }
+			error = "invalid face vertex '" + std::string(token, p) + "'";
+			return false;
+		}
+		polygon.push_back(corner);
+	}
+}
+
+void ObjImporterClass::BuildMesh(MeshData& mesh) const {
+	size_t cornerCount = m_corners.size();
+	mesh.vertices.clear();
+	mesh.vertices.reserve(m_totals[0]);
+	mesh.indices.resize(cornerCount);
+	mesh.bounds = MeshBounds();
+
+	// Open addressing over the corner triples, sized so probes stay short.
+	size_t tableSize = 1;
+	while (tableSize < cornerCount * 2) { tableSize <<= 1; }
+	std::vector<uint32_t> table(tableSize, MISSING);
+	std::vector<Corner> keys;	// The corner each vertex was made from.
+	keys.reserve(m_totals[0]);
+
+	for (size_t t = 0; t < cornerCount; t += 3) {
+		// Without a normal a corner gets the face normal and a vertex of its own, the welder merges coplanar ones.
+		float faceNormal[3] = { 0.0f, 0.0f, -1.0f };
+		const float* a = &m_positions[(size_t)m_corners[t].position * 3];
+		const float* b = &m_positions[(size_t)m_corners[t + 1].position * 3];
+		const float* c = &m_positions[(size_t)m_corners[t + 2].position * 3];
+		if (m_corners[t].normal == MISSING || m_corners[t + 1].normal == MISSING || m_corners[t + 2].normal == MISSING) {
+			float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			float n[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length > 0.0f) {
+				for (int k = 0; k < 3; k++) { faceNormal[k] = n[k] / length; }
+			}
+		}
+
+		for (size_t i = t; i < t + 3; i++) {
+			const Corner& corner = m_corners[i];
+			uint32_t vertex = MISSING;
+			size_t slot = 0;
+			if (corner.normal != MISSING) {
+				uint32_t hash = corner.position * 0x9E3779B1u ^ corner.texcoord * 0x85EBCA77u ^ corner.normal * 0xC2B2AE3Du;
+				slot = (hash ^ (hash >> 15)) & (tableSize - 1);
+				while (table[slot] != MISSING) {
+					const Corner& key = keys[table[slot]];
+					if (key.position == corner.position && key.texcoord == corner.texcoord && key.normal == corner.normal) {
+						vertex = table[slot];
+						break;
+					}
+					slot = (slot + 1) & (tableSize - 1);
+				}
+			}
+
+			if (vertex == MISSING) {
+				vertex = (uint32_t)mesh.vertices.size();
+				if (corner.normal != MISSING) { table[slot] = vertex; }
+				keys.push_back(corner);
+
+				MeshVertex v;
+				memcpy(v.Position(), &m_positions[(size_t)corner.position * 3], sizeof(float) * 3);
+				if (corner.texcoord != MISSING) { memcpy(v.Texcoord(), &m_texcoords[(size_t)corner.texcoord * 2], sizeof(float) * 2); }
+				memcpy(v.Normal(), corner.normal != MISSING ? &m_normals[(size_t)corner.normal * 3] : faceNormal, sizeof(float) * 3);
+				mesh.vertices.push_back(v);
+				mesh.bounds.Add(v.Position());
+			}
+			mesh.indices[i] = vertex;
+		}
+	}
+}
+
+size_t ObjImporterClass::LineOf(const Chunk& chunk, size_t offset) const {
+	size_t line = chunk.firstLine;
+	for (size_t i = chunk.begin; i < offset; i++) {
+		if (m_data[i] == '\n') { line++; }
+	}
+	return line;
+}
+
+bool ObjImporterClass::Fail(size_t line, const std::string& message) {
+	m_error = m_filename;
+	if (line > 0) { m_error.append("(").append(std::to_string(line)).append(")"); }
+	m_error.append(": ").append(message);
+	m_data = 0;
+	return false;
+}
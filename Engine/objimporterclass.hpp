@@ -0,0 +1,60 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "meshtypes.hpp"
+
+// Wavefront OBJ importer. The file is mapped, split into newline aligned chunks and parsed by one thread per chunk in
+// two passes: the first counts elements, the second writes them into arrays sized from the prefix sums, so no line
+// costs an allocation. Polygons are fanned into triangles and every distinct v/vt/vn triple becomes one vertex.
+// Output is converted to the engine's left handed, clockwise, top left UV convention.
+class ObjImporterClass {
+public:
+	bool Import(const char* filename, MeshData& mesh);
+	const std::string& GetError() const { return m_error; }	// "file(line): message" of the first problem found.
+
+private:
+	static constexpr uint32_t MISSING = UINT32_MAX;
+
+	struct Corner {
+		uint32_t position = MISSING;
+		uint32_t texcoord = MISSING;
+		uint32_t normal = MISSING;
+	};
+
+	struct Chunk {
+		size_t begin = 0;
+		size_t end = 0;
+		size_t firstLine = 0;
+		size_t lineCount = 0;
+		size_t positions = 0;	// Elements in this chunk, then the index of the first one after the prefix sums.
+		size_t texcoords = 0;
+		size_t normals = 0;
+		size_t corners = 0;		// Three per triangle after fanning.
+		size_t errorOffset = 0;
+		std::string error;
+	};
+
+	enum LineType { LINE_OTHER, LINE_POSITION, LINE_TEXCOORD, LINE_NORMAL, LINE_FACE };
+
+	void ScanChunk(Chunk& chunk) const;
+	void ParseChunk(Chunk& chunk);
+	bool ParseFace(const char* p, const char* end, const size_t seen[3], std::vector<Corner>& polygon, std::string& error) const;
+	void BuildMesh(MeshData& mesh) const;
+	LineType ReadLine(size_t& position, size_t chunkEnd, const char*& begin, const char*& end) const;
+	size_t LineOf(const Chunk& chunk, size_t offset) const;
+	bool Fail(size_t line, const std::string& message);
+
+	static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+	std::string m_filename;
+	const char* m_data = 0;
+	size_t m_size = 0;
+	size_t m_totals[3]{};	// Positions, texture coordinates and normals in the whole file.
+	std::vector<float> m_positions;
+	std::vector<float> m_texcoords;
+	std::vector<float> m_normals;
+	std::vector<Corner> m_corners;
+	std::string m_error;
+};
@@ -0,0 +1,448 @@
+#include "pngdecoderclass.hpp"
+#include "inflateclass.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PNGDECODER_SSE2
+#endif
+
+static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+// Adam7 passes: first column, first row, column step, row step.
+static const int PASSES[7][4] = { { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+
+static const uint32_t OPAQUE = 0xFF000000u;	// Alpha of a little endian RGBA8 pixel.
+
+enum Filter { FILTER_NONE, FILTER_SUB, FILTER_UP, FILTER_AVERAGE, FILTER_PAETH };
+
+static uint32_t ReadLong(const unsigned char* p) { return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]; }
+static unsigned ReadShort(const unsigned char* p) { return p[0] << 8 | p[1]; }
+
+// CRC-32 of a chunk's type and data, four bytes a step through four tables.
+static uint32_t GetCrc(const unsigned char* data, size_t size) {
+	static const struct Tables {
+		uint32_t entries[4][256];
+		Tables() {
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; bit++) { crc = crc & 1 ? crc >> 1 ^ 0xEDB88320u : crc >> 1; }
+				entries[0][i] = crc;
+			}
+			for (uint32_t i = 0; i < 256; i++) {
+				for (int table = 1; table < 4; table++) { entries[table][i] = entries[table - 1][i] >> 8 ^ entries[0][entries[table - 1][i] & 0xFF]; }
+			}
+		}
+	} tables;
+	const auto& t = tables.entries;
+
+	uint32_t crc = 0xFFFFFFFFu;
+	for (; size >= 4; size -= 4, data += 4) {
+		crc ^= (uint32_t)data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+		crc = t[3][crc & 0xFF] ^ t[2][crc >> 8 & 0xFF] ^ t[1][crc >> 16 & 0xFF] ^ t[0][crc >> 24];
+	}
+	for (; size > 0; size--) { crc = crc >> 8 ^ t[0][(crc ^ *data++) & 0xFF]; }
+	return ~crc;
+}
+
+static inline unsigned char Paeth(int a, int b, int c) {
+	int pa = abs(b - c);
+	int pb = abs(a - c);
+	int pc = abs(a + b - 2 * c);
+	if (pa <= pb && pa <= pc) { return (unsigned char)a; }
+	return (unsigned char)(pb <= pc ? b : c);
+}
+
+// Filters undo in place: the row above is already unfiltered and so is everything left of the current byte.
+static void UnfilterSub(unsigned char* row, size_t size, size_t bpp) {
+	for (size_t i = bpp; i < size; i++) { row[i] += row[i - bpp]; }
+}
+
+static void UnfilterUp(unsigned char* row, const unsigned char* previous, size_t size) {
+	size_t i = 0;
+#if defined(PNGDECODER_SSE2)
+	for (; i + 16 <= size; i += 16) {
+		__m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(row + i)), _mm_loadu_si128((const __m128i*)(previous + i)));
+		_mm_storeu_si128((__m128i*)(row + i), sum);
+	}
+#endif
+	for (; i < size; i++) { row[i] += previous[i]; }
+}
+
+static void UnfilterAverage(unsigned char* row, const unsigned char* previous, size_t size, size_t bpp) {
+	for (size_t i = 0; i < bpp; i++) { row[i] += previous[i] >> 1; }
+	for (size_t i = bpp; i < size; i++) { row[i] += (unsigned char)((row[i - bpp] + previous[i]) >> 1); }
+}
+
+static void UnfilterPaeth(unsigned char* row, const unsigned char* previous, size_t size, size_t bpp) {
+	for (size_t i = 0; i < bpp; i++) { row[i] += previous[i]; }
+	for (size_t i = bpp; i < size; i++) { row[i] += Paeth(row[i - bpp], previous[i], previous[i - bpp]); }
+}
+
+#if defined(PNGDECODER_SSE2)
+// RGB8 and RGBA8 rows: every step depends on the pixel to the left, so a register holds one pixel and the channels
+// run side by side. Loads take a whole int while the row allows; for three byte pixels the extra byte belongs to the
+// next pixel, so it is masked out of the predictors and never stored.
+template <size_t BPP> static inline __m128i LoadPixel(const unsigned char* p, size_t remaining) {
+	int value = 0;
+	if (remaining >= 4) { memcpy(&value, p, 4); }
+	else { memcpy(&value, p, BPP); }
+	return _mm_cvtsi32_si128(value);
+}
+
+template <size_t BPP> static inline void StorePixel(unsigned char* p, __m128i pixel) {
+	int value = _mm_cvtsi128_si32(pixel);
+	memcpy(p, &value, BPP);
+}
+
+template <size_t BPP> static inline __m128i PixelMask() { return _mm_cvtsi32_si128(BPP == 4 ? -1 : 0x00FFFFFF); }
+
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+static inline __m128i Absolute(__m128i x) { return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x)); }
+
+template <size_t BPP> static void UnfilterPixelsSub(unsigned char* row, size_t size) {
+	const __m128i mask = PixelMask<BPP>();
+	__m128i left = _mm_setzero_si128();
+	for (size_t i = 0; i < size; i += BPP) {
+		__m128i pixel = _mm_add_epi8(LoadPixel<BPP>(row + i, size - i), left);
+		StorePixel<BPP>(row + i, pixel);
+		left = _mm_and_si128(pixel, mask);
+	}
+}
+
+template <size_t BPP> static void UnfilterPixelsAverage(unsigned char* row, const unsigned char* previous, size_t size) {
+	// avg_epu8 rounds up, the filter rounds down.
+	const __m128i mask = PixelMask<BPP>();
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i left = _mm_setzero_si128();
+	for (size_t i = 0; i < size; i += BPP) {
+		__m128i above = _mm_and_si128(LoadPixel<BPP>(previous + i, size - i), mask);
+		__m128i average = _mm_sub_epi8(_mm_avg_epu8(left, above), _mm_and_si128(_mm_xor_si128(left, above), one));
+		__m128i pixel = _mm_add_epi8(LoadPixel<BPP>(row + i, size - i), average);
+		StorePixel<BPP>(row + i, pixel);
+		left = _mm_and_si128(pixel, mask);
+	}
+}
+
+template <size_t BPP> static void UnfilterPixelsPaeth(unsigned char* row, const unsigned char* previous, size_t size) {
+	// Predictor distances need nine bits, so the channels are widened to 16 bit lanes.
+	const __m128i mask = PixelMask<BPP>();
+	const __m128i zero = _mm_setzero_si128();
+	__m128i left = zero;
+	__m128i upperLeft = zero;
+	for (size_t i = 0; i < size; i += BPP) {
+		__m128i above = _mm_unpacklo_epi8(_mm_and_si128(LoadPixel<BPP>(previous + i, size - i), mask), zero);
+		__m128i towardLeft = _mm_sub_epi16(above, upperLeft);
+		__m128i towardAbove = _mm_sub_epi16(left, upperLeft);
+		__m128i distanceLeft = Absolute(towardLeft);
+		__m128i distanceAbove = Absolute(towardAbove);
+		__m128i distanceUpperLeft = Absolute(_mm_add_epi16(towardLeft, towardAbove));
+		__m128i smallest = _mm_min_epi16(distanceUpperLeft, _mm_min_epi16(distanceLeft, distanceAbove));
+		__m128i predictor = Select(_mm_cmpeq_epi16(smallest, distanceLeft), left,
+			Select(_mm_cmpeq_epi16(smallest, distanceAbove), above, upperLeft));
+
+		__m128i pixel = _mm_add_epi8(LoadPixel<BPP>(row + i, size - i), _mm_packus_epi16(predictor, predictor));
+		StorePixel<BPP>(row + i, pixel);
+		left = _mm_unpacklo_epi8(_mm_and_si128(pixel, mask), zero);
+		upperLeft = above;
+	}
+}
+#endif
+
+static bool UnfilterRow(int filter, unsigned char* row, const unsigned char* previous, size_t size, size_t bpp) {
+#if defined(PNGDECODER_SSE2)
+	bool pixels = bpp == 3 || bpp == 4;
+#endif
+	switch (filter) {
+	case FILTER_NONE:
+		return true;
+	case FILTER_SUB:
+#if defined(PNGDECODER_SSE2)
+		if (pixels) {
+			if (bpp == 3) { UnfilterPixelsSub<3>(row, size); }
+			else { UnfilterPixelsSub<4>(row, size); }
+			return true;
+		}
+#endif
+		UnfilterSub(row, size, bpp);
+		return true;
+	case FILTER_UP:
+		UnfilterUp(row, previous, size);
+		return true;
+	case FILTER_AVERAGE:
+#if defined(PNGDECODER_SSE2)
+		if (pixels) {
+			if (bpp == 3) { UnfilterPixelsAverage<3>(row, previous, size); }
+			else { UnfilterPixelsAverage<4>(row, previous, size); }
+			return true;
+		}
+#endif
+		UnfilterAverage(row, previous, size, bpp);
+		return true;
+	case FILTER_PAETH:
+#if defined(PNGDECODER_SSE2)
+		if (pixels) {
+			if (bpp == 3) { UnfilterPixelsPaeth<3>(row, previous, size); }
+			else { UnfilterPixelsPaeth<4>(row, previous, size); }
+			return true;
+		}
+#endif
+		UnfilterPaeth(row, previous, size, bpp);
+		return true;
+	default:
+		return false;
+	}
+}
+
+PngDecoderClass::PngDecoderClass(const unsigned char* data, size_t size) : m_data(data), m_size(size) {
+	// Indices past the end of the palette come out opaque black.
+	const unsigned char black[4] = { 0, 0, 0, 255 };
+	for (uint32_t& entry : m_palette) { memcpy(&entry, black, 4); }
+}
+
+bool PngDecoderClass::IsPng(const unsigned char* data, size_t size) {
+	return size >= sizeof(SIGNATURE) && memcmp(data, SIGNATURE, sizeof(SIGNATURE)) == 0;
+}
+
+bool PngDecoderClass::Fail(const std::string& message) {
+	errorMessage = message;
+	return false;
+}
+
+bool PngDecoderClass::ReadHeader() {
+	if (!IsPng(m_data, m_size)) { return Fail("not a PNG file"); }
+
+	bool ended = false;
+	bool first = true;
+	for (size_t position = sizeof(SIGNATURE); !ended;) {
+		if (m_size - position < 12) { return Fail("unexpected end of file"); }
+		size_t length = ReadLong(m_data + position);
+		const unsigned char* type = m_data + position + 4;
+		const unsigned char* chunk = m_data + position + 8;
+		if (length > m_size - position - 12) { return Fail("unexpected end of file"); }
+		if (ReadLong(chunk + length) != GetCrc(type, length + 4)) { return Fail("bad CRC in " + std::string((const char*)type, 4) + " chunk"); }
+		position += length + 12;
+
+		if (first != (memcmp(type, "IHDR", 4) == 0)) { return Fail("the first chunk must be IHDR"); }
+		if (first) {
+			if (!ReadImageHeader(chunk, length)) { return false; }
+			first = false;
+		}
+		else if (memcmp(type, "PLTE", 4) == 0) {
+			if (length % 3 != 0 || length > 256 * 3) { return Fail("bad palette"); }
+			m_paletteSize = length / 3;
+			for (size_t i = 0; i < m_paletteSize; i++) {
+				unsigned char rgba[4] = { chunk[i * 3], chunk[i * 3 + 1], chunk[i * 3 + 2], 255 };
+				memcpy(&m_palette[i], rgba, 4);
+			}
+		}
+		else if (memcmp(type, "tRNS", 4) == 0) {
+			if (m_colorType == COLOR_PALETTE) {
+				if (length > m_paletteSize) { return Fail("bad transparency"); }
+				for (size_t i = 0; i < length; i++) { ((unsigned char*)&m_palette[i])[3] = chunk[i]; }
+			}
+			else if (m_colorType == COLOR_GRAY || m_colorType == COLOR_RGB) {
+				size_t count = m_colorType == COLOR_GRAY ? 1 : 3;
+				if (length != count * 2) { return Fail("bad transparency"); }
+				for (size_t i = 0; i < count; i++) { m_transparentColor[i] = (uint16_t)ReadShort(chunk + i * 2); }
+				m_hasTransparentColor = true;
+			}
+		}
+		else if (memcmp(type, "IDAT", 4) == 0) { m_imageData.push_back({ chunk, length }); }
+		else if (memcmp(type, "IEND", 4) == 0) { ended = true; }
+		else if (!(type[0] & 0x20)) { return Fail("unsupported critical chunk " + std::string((const char*)type, 4)); }
+	}
+
+	if (m_imageData.empty()) { return Fail("no image data"); }
+	if (m_colorType == COLOR_PALETTE && m_paletteSize == 0) { return Fail("missing palette"); }
+	m_headerRead = true;
+	return true;
+}
+
+bool PngDecoderClass::ReadImageHeader(const unsigned char* chunk, size_t size) {
+	if (size != 13) { return Fail("bad IHDR"); }
+	uint32_t width = ReadLong(chunk);
+	uint32_t height = ReadLong(chunk + 4);
+	m_bitDepth = chunk[8];
+	int colorType = chunk[9];
+	if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+		return Fail("bad size " + std::to_string(width) + "x" + std::to_string(height));
+	}
+	m_width = (int)width;
+	m_height = (int)height;
+
+	bool valid;
+	switch (colorType) {
+	case COLOR_GRAY:
+		m_channels = 1;
+		valid = m_bitDepth == 1 || m_bitDepth == 2 || m_bitDepth == 4 || m_bitDepth == 8 || m_bitDepth == 16;
+		break;
+	case COLOR_PALETTE:
+		m_channels = 1;
+		valid = m_bitDepth == 1 || m_bitDepth == 2 || m_bitDepth == 4 || m_bitDepth == 8;
+		break;
+	case COLOR_RGB: case COLOR_GRAY_ALPHA: case COLOR_RGBA:
+		m_channels = colorType == COLOR_RGB ? 3 : colorType == COLOR_RGBA ? 4 : 2;
+		valid = m_bitDepth == 8 || m_bitDepth == 16;
+		break;
+	default:
+		return Fail("unsupported color type " + std::to_string(colorType));
+	}
+	if (!valid) { return Fail("unsupported bit depth " + std::to_string(m_bitDepth)); }
+	m_colorType = (ColorType)colorType;
+
+	if (chunk[10] != 0 || chunk[11] != 0) { return Fail("unsupported compression or filter method"); }
+	if (chunk[12] > 1) { return Fail("unsupported interlace method"); }
+	m_interlaced = chunk[12] == 1;
+	return true;
+}
+
+size_t PngDecoderClass::GetRowSize(size_t width) const {
+	return (width * m_channels * m_bitDepth + 7) / 8;
+}
+
+bool PngDecoderClass::Decode(unsigned char* destination) {
+	if (!m_headerRead) { return Fail("the header was not read"); }
+
+	// Sizes of the reduced images: the whole one, or the seven interlace passes.
+	int passCount = m_interlaced ? 7 : 1;
+	size_t passWidths[7] = { (size_t)m_width };
+	size_t passHeights[7] = { (size_t)m_height };
+	size_t rawSize = 0;
+	for (int pass = 0; pass < passCount; pass++) {
+		if (m_interlaced) {
+			const int* step = PASSES[pass];
+			passWidths[pass] = m_width > step[0] ? (size_t)(m_width - step[0] + step[2] - 1) / step[2] : 0;
+			passHeights[pass] = m_height > step[1] ? (size_t)(m_height - step[1] + step[3] - 1) / step[3] : 0;
+		}
+		if (passWidths[pass] > 0) { rawSize += passHeights[pass] * (GetRowSize(passWidths[pass]) + 1); }
+	}
+
+	// One IDAT, the usual case for files written by tools, inflates straight from the file.
+	const unsigned char* stream = m_imageData[0].data;
+	size_t streamSize = m_imageData[0].size;
+	std::vector<unsigned char> joined;
+	if (m_imageData.size() > 1) {
+		for (const Span& span : m_imageData) { joined.insert(joined.end(), span.data, span.data + span.size); }
+		stream = joined.data();
+		streamSize = joined.size();
+	}
+
+	std::vector<unsigned char> raw(rawSize);
+	size_t written = 0;
+	std::string error;
+	if (!InflateClass::InflateZlib(stream, streamSize, raw.data(), rawSize, written, error)) { return Fail("image data: " + error); }
+	if (written != rawSize) { return Fail("not enough image data"); }
+	std::vector<unsigned char>().swap(joined);
+
+	size_t bpp = std::max<size_t>(1, (size_t)m_channels * m_bitDepth / 8);
+	std::vector<unsigned char> zeros(GetRowSize((size_t)m_width));	// The row above the first.
+	std::vector<unsigned char> scratch(m_interlaced ? (size_t)m_width * 4 : 0);
+	unsigned char* row = raw.data();
+	for (int pass = 0; pass < passCount; pass++) {
+		size_t width = passWidths[pass];
+		if (width == 0) { continue; }
+		size_t rowSize = GetRowSize(width);
+		const unsigned char* previous = zeros.data();
+		for (size_t y = 0; y < passHeights[pass]; y++, row += rowSize + 1) {
+			if (!UnfilterRow(row[0], row + 1, previous, rowSize, bpp)) { return Fail("bad filter type " + std::to_string(row[0])); }
+			previous = row + 1;
+
+			if (!m_interlaced) {
+				ExpandRow(row + 1, destination + y * m_width * 4, width);
+				continue;
+			}
+			const int* step = PASSES[pass];
+			ExpandRow(row + 1, scratch.data(), width);
+			unsigned char* target = destination + ((size_t)step[1] + y * step[3]) * m_width * 4 + (size_t)step[0] * 4;
+			for (size_t x = 0; x < width; x++) { memcpy(target + x * step[2] * 4, scratch.data() + x * 4, 4); }
+		}
+	}
+	return true;
+}
+
+void PngDecoderClass::ExpandRow(const unsigned char* row, unsigned char* rgba, size_t width) const {
+	if (m_bitDepth < 8) {
+		int depth = m_bitDepth;
+		int mask = (1 << depth) - 1;
+		int scale = 255 / mask;
+		for (size_t x = 0; x < width; x++, rgba += 4) {
+			size_t bit = x * depth;
+			int value = row[bit >> 3] >> (8 - depth - (int)(bit & 7)) & mask;
+			if (m_colorType == COLOR_PALETTE) {
+				memcpy(rgba, &m_palette[value], 4);
+				continue;
+			}
+			rgba[0] = rgba[1] = rgba[2] = (unsigned char)(value * scale);
+			rgba[3] = m_hasTransparentColor && value == m_transparentColor[0] ? 0 : 255;
+		}
+		return;
+	}
+
+	// Samples are big endian, so the first byte is the high byte at either depth.
+	size_t sampleSize = (size_t)m_bitDepth / 8;
+	size_t pixelSize = m_channels * sampleSize;
+	auto sample = [sampleSize](const unsigned char* p) -> unsigned { return sampleSize == 2 ? ReadShort(p) : p[0]; };
+	switch (m_colorType) {
+	case COLOR_GRAY:
+		if (sampleSize == 1 && !m_hasTransparentColor) {
+			for (size_t x = 0; x < width; x++) {
+				uint32_t pixel = row[x] * 0x010101u | OPAQUE;
+				memcpy(rgba + x * 4, &pixel, 4);
+			}
+			break;
+		}
+		for (size_t x = 0; x < width; x++, row += pixelSize, rgba += 4) {
+			rgba[0] = rgba[1] = rgba[2] = row[0];
+			rgba[3] = m_hasTransparentColor && sample(row) == m_transparentColor[0] ? 0 : 255;
+		}
+		break;
+	case COLOR_RGB:
+		if (sampleSize == 1 && !m_hasTransparentColor) {
+			// Four bytes at a time with the alpha byte overwritten, the last pixel would read past the row.
+			for (size_t x = 0; x + 1 < width; x++) {
+				uint32_t pixel;
+				memcpy(&pixel, row + x * 3, 4);
+				pixel |= OPAQUE;
+				memcpy(rgba + x * 4, &pixel, 4);
+			}
+			row += (width - 1) * 3;
+			rgba += (width - 1) * 4;
+			unsigned char last[4] = { row[0], row[1], row[2], 255 };
+			memcpy(rgba, last, 4);
+			break;
+		}
+		for (size_t x = 0; x < width; x++, row += pixelSize, rgba += 4) {
+			rgba[0] = row[0];
+			rgba[1] = row[sampleSize];
+			rgba[2] = row[sampleSize * 2];
+			rgba[3] = 255;
+			if (m_hasTransparentColor && sample(row) == m_transparentColor[0] && sample(row + sampleSize) == m_transparentColor[1] &&
+				sample(row + sampleSize * 2) == m_transparentColor[2]) { rgba[3] = 0; }
+		}
+		break;
+	case COLOR_PALETTE:
+		for (size_t x = 0; x < width; x++) { memcpy(rgba + x * 4, &m_palette[row[x]], 4); }
+		break;
+	case COLOR_GRAY_ALPHA:
+		for (size_t x = 0; x < width; x++, row += pixelSize, rgba += 4) {
+			rgba[0] = rgba[1] = rgba[2] = row[0];
+			rgba[3] = row[sampleSize];
+		}
+		break;
+	case COLOR_RGBA:
+		if (sampleSize == 1) {
+			memcpy(rgba, row, width * 4);
+			break;
+		}
+		for (size_t x = 0; x < width; x++, row += pixelSize, rgba += 4) {
+			rgba[0] = row[0];
+			rgba[1] = row[2];
+			rgba[2] = row[4];
+			rgba[3] = row[6];
+		}
+		break;
+	}
+}
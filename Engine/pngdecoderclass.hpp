@@ -0,0 +1,54 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// PNG decoder over a file already in memory, usually a MappedFileClass view. Writes RGBA8 rows, top row first, into
+// the caller's buffer. Handles every color type and bit depth (16 bit keeps the high byte), tRNS transparency and
+// Adam7 interlacing. Holds no shared state, so any number of images can decode at once on different threads.
+class PngDecoderClass {
+public:
+	static constexpr int MAX_DIMENSION = 16384;	// The largest texture D3D11 can create.
+
+	PngDecoderClass(const unsigned char* data, size_t size);	// The data must outlive the decoder.
+	PngDecoderClass(const PngDecoderClass&) = delete;
+
+	static bool IsPng(const unsigned char* data, size_t size);
+
+	bool ReadHeader();	// Walks and checks every chunk, so a damaged file fails here rather than halfway through Decode.
+	bool Decode(unsigned char* destination);	// GetWidth() * GetHeight() * 4 bytes, after ReadHeader.
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	std::string errorMessage;
+
+private:
+	enum ColorType { COLOR_GRAY = 0, COLOR_RGB = 2, COLOR_PALETTE = 3, COLOR_GRAY_ALPHA = 4, COLOR_RGBA = 6 };
+	struct Span {
+		const unsigned char* data;
+		size_t size;
+	};
+
+	bool ReadImageHeader(const unsigned char* chunk, size_t size);
+	size_t GetRowSize(size_t width) const;
+	void ExpandRow(const unsigned char* row, unsigned char* rgba, size_t width) const;
+	bool Fail(const std::string& message);
+
+	const unsigned char* m_data = 0;
+	size_t m_size = 0;
+	std::vector<Span> m_imageData;	// The IDAT chunks, one zlib stream between them.
+
+	int m_width = 0;
+	int m_height = 0;
+	int m_bitDepth = 0;
+	ColorType m_colorType = COLOR_RGBA;
+	int m_channels = 0;
+	bool m_interlaced = false;
+	bool m_headerRead = false;
+
+	uint32_t m_palette[256]{};	// RGBA, indexed by the pixel value.
+	size_t m_paletteSize = 0;
+	bool m_hasTransparentColor = false;	// tRNS of gray and RGB images: pixels of exactly this value are clear.
+	uint16_t m_transparentColor[3]{};
+};
@@ -0,0 +1,140 @@
+#include "renderstateclass.hpp"
+
+RenderStateClass::RenderStateClass(ID3D11DeviceContext* context) : m_context(context) {
+	if (FAILED(context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&m_context1))) { m_context1 = 0; }
+}
+
+RenderStateClass::~RenderStateClass() {
+	if (m_context1) {
+		m_context1->Release();
+		m_context1 = 0;
+	}
+}
+
+bool RenderStateClass::ViewportBinding::operator==(const ViewportBinding& other) const {
+	const D3D11_VIEWPORT& a = viewport;
+	const D3D11_VIEWPORT& b = other.viewport;
+	return a.TopLeftX == b.TopLeftX && a.TopLeftY == b.TopLeftY && a.Width == b.Width && a.Height == b.Height && a.MinDepth == b.MinDepth
+		&& a.MaxDepth == b.MaxDepth;
+}
+
+bool RenderStateClass::BlendBinding::operator==(const BlendBinding& other) const {
+	// D3D reads the factor only for blends that use it, comparing it always just costs a rare extra bind.
+	return state == other.state && sampleMask == other.sampleMask && blendFactor[0] == other.blendFactor[0] && blendFactor[1] == other.blendFactor[1]
+		&& blendFactor[2] == other.blendFactor[2] && blendFactor[3] == other.blendFactor[3];
+}
+
+template <class T>
+bool RenderStateClass::Update(Binding<T>& binding, const T& value) {
+	if (binding.known && binding.value == value) {
+		m_stats.skipped++;
+		return false;
+	}
+	binding.value = value;
+	binding.known = true;
+	m_stats.issued++;
+	return true;
+}
+
+bool RenderStateClass::PassThrough() {
+	m_stats.issued++;
+	return true;
+}
+
+void RenderStateClass::SetInputLayout(ID3D11InputLayout* layout) {
+	if (Update(m_inputLayout, layout)) { m_context->IASetInputLayout(layout); }
+}
+
+void RenderStateClass::SetVertexBuffer(UINT slot, ID3D11Buffer* buffer, UINT stride, UINT offset) {
+	if (slot < SLOTS ? Update(m_vertexBuffers[slot], VertexBufferBinding{ buffer, stride, offset }) : PassThrough()) {
+		m_context->IASetVertexBuffers(slot, 1, &buffer, &stride, &offset);
+	}
+}
+
+void RenderStateClass::SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset) {
+	if (Update(m_indexBuffer, IndexBufferBinding{ buffer, format, offset })) { m_context->IASetIndexBuffer(buffer, format, offset); }
+}
+
+void RenderStateClass::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) {
+	if (Update(m_topology, topology)) { m_context->IASetPrimitiveTopology(topology); }
+}
+
+void RenderStateClass::SetVertexShader(ID3D11VertexShader* shader) {
+	if (Update(m_vertexShader, shader)) { m_context->VSSetShader(shader, NULL, 0); }
+}
+
+void RenderStateClass::SetVertexConstantBuffer(UINT slot, ID3D11Buffer* buffer) {
+	SetVertexConstantBuffer(slot, buffer, 0, 0);
+}
+
+void RenderStateClass::SetVertexConstantBuffer(UINT slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount) {
+	if (!(slot < SLOTS ? Update(m_vertexConstantBuffers[slot], ConstantBufferBinding{ buffer, firstConstant, constantCount }) : PassThrough())) { return; }
+	if (constantCount == 0 || !m_context1) { m_context->VSSetConstantBuffers(slot, 1, &buffer); }
+	else { m_context1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount); }
+}
+
+void RenderStateClass::SetPixelShader(ID3D11PixelShader* shader) {
+	if (Update(m_pixelShader, shader)) { m_context->PSSetShader(shader, NULL, 0); }
+}
+
+void RenderStateClass::SetPixelConstantBuffer(UINT slot, ID3D11Buffer* buffer) {
+	if (slot < SLOTS ? Update(m_pixelConstantBuffers[slot], buffer) : PassThrough()) { m_context->PSSetConstantBuffers(slot, 1, &buffer); }
+}
+
+void RenderStateClass::SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view) {
+	if (slot < SLOTS ? Update(m_pixelShaderResources[slot], view) : PassThrough()) { m_context->PSSetShaderResources(slot, 1, &view); }
+}
+
+void RenderStateClass::SetPixelSampler(UINT slot, ID3D11SamplerState* sampler) {
+	if (slot < SLOTS ? Update(m_pixelSamplers[slot], sampler) : PassThrough()) { m_context->PSSetSamplers(slot, 1, &sampler); }
+}
+
+void RenderStateClass::SetRasterizerState(ID3D11RasterizerState* state) {
+	if (Update(m_rasterizerState, state)) { m_context->RSSetState(state); }
+}
+
+void RenderStateClass::SetViewport(const D3D11_VIEWPORT& viewport) {
+	if (Update(m_viewport, ViewportBinding{ viewport })) { m_context->RSSetViewports(1, &viewport); }
+}
+
+void RenderStateClass::SetRenderTarget(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depthStencil) {
+	// A null target binds none at all.
+	if (Update(m_renderTarget, RenderTargetBinding{ target, depthStencil })) { m_context->OMSetRenderTargets(target ? 1 : 0, &target, depthStencil); }
+}
+
+void RenderStateClass::SetDepthStencilState(ID3D11DepthStencilState* state, UINT stencilRef) {
+	if (Update(m_depthStencilState, DepthStencilBinding{ state, stencilRef })) { m_context->OMSetDepthStencilState(state, stencilRef); }
+}
+
+void RenderStateClass::SetBlendState(ID3D11BlendState* state, const FLOAT blendFactor[4], UINT sampleMask) {
+	BlendBinding binding{ state, { 1.0f, 1.0f, 1.0f, 1.0f }, sampleMask };	// What D3D uses for a null factor.
+	if (blendFactor) {
+		for (int i = 0; i < 4; i++) { binding.blendFactor[i] = blendFactor[i]; }
+	}
+	if (Update(m_blendState, binding)) { m_context->OMSetBlendState(state, binding.blendFactor, sampleMask); }
+}
+
+void RenderStateClass::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) {
+	m_stats.draws++;
+	m_context->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void RenderStateClass::Invalidate() {
+	m_inputLayout.known = false;
+	m_indexBuffer.known = false;
+	m_topology.known = false;
+	m_vertexShader.known = false;
+	m_pixelShader.known = false;
+	m_rasterizerState.known = false;
+	m_viewport.known = false;
+	m_renderTarget.known = false;
+	m_depthStencilState.known = false;
+	m_blendState.known = false;
+	for (UINT slot = 0; slot < SLOTS; slot++) {
+		m_vertexBuffers[slot].known = false;
+		m_vertexConstantBuffers[slot].known = false;
+		m_pixelConstantBuffers[slot].known = false;
+		m_pixelShaderResources[slot].known = false;
+		m_pixelSamplers[slot].known = false;
+	}
+}
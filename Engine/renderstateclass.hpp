@@ -0,0 +1,121 @@
+#pragma once
+#include <d3d11_1.h>
+#include <stddef.h>
+
+struct RenderStateStats {
+	size_t issued = 0;	// Calls that reached the context.
+	size_t skipped = 0;	// Calls that would have bound what was bound already.
+	size_t draws = 0;
+};
+
+// Binds through the immediate context, remembering what every stage holds and dropping the calls that would bind the
+// same again. Draw code sets everything it needs on every draw and leaves the filtering to this. Objects are told
+// apart by address, which stays unique while they are bound since the context holds a reference on them. Anything that
+// binds on the context directly has to Invalidate afterwards. Main thread only.
+class RenderStateClass {
+public:
+	static constexpr UINT SLOTS = 8;	// Tracked per stage and kind, higher slots always go through.
+
+	RenderStateClass(ID3D11DeviceContext* context);
+	RenderStateClass(const RenderStateClass&) = delete;
+	~RenderStateClass();
+
+	void SetInputLayout(ID3D11InputLayout* layout);
+	void SetVertexBuffer(UINT slot, ID3D11Buffer* buffer, UINT stride, UINT offset);
+	void SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset);
+	void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology);
+
+	void SetVertexShader(ID3D11VertexShader* shader);
+	void SetVertexConstantBuffer(UINT slot, ID3D11Buffer* buffer);
+	// A window of the buffer, in 16 byte constants, see ConstantRingClass. Needs the D3D 11.1 context.
+	void SetVertexConstantBuffer(UINT slot, ID3D11Buffer* buffer, UINT firstConstant, UINT constantCount);
+	void SetPixelShader(ID3D11PixelShader* shader);
+	void SetPixelConstantBuffer(UINT slot, ID3D11Buffer* buffer);
+	void SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view);
+	void SetPixelSampler(UINT slot, ID3D11SamplerState* sampler);
+
+	void SetRasterizerState(ID3D11RasterizerState* state);
+	void SetViewport(const D3D11_VIEWPORT& viewport);
+	void SetRenderTarget(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depthStencil);
+	void SetDepthStencilState(ID3D11DepthStencilState* state, UINT stencilRef);
+	void SetBlendState(ID3D11BlendState* state, const FLOAT blendFactor[4], UINT sampleMask);
+
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex);
+
+	void Invalidate();	// Everything is unknown again, the next call of each kind goes through.
+
+	ID3D11DeviceContext* GetContext() const { return m_context; }
+	const RenderStateStats& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = RenderStateStats(); }
+
+private:
+	template <class T>
+	struct Binding {
+		T value{};
+		bool known = false;
+	};
+	struct VertexBufferBinding {
+		ID3D11Buffer* buffer;
+		UINT stride;
+		UINT offset;
+		bool operator==(const VertexBufferBinding& other) const { return buffer == other.buffer && stride == other.stride && offset == other.offset; }
+	};
+	struct ConstantBufferBinding {
+		ID3D11Buffer* buffer;
+		UINT firstConstant;
+		UINT constantCount;	// 0 for the whole buffer.
+		bool operator==(const ConstantBufferBinding& other) const {
+			return buffer == other.buffer && firstConstant == other.firstConstant && constantCount == other.constantCount;
+		}
+	};
+	struct IndexBufferBinding {
+		ID3D11Buffer* buffer;
+		DXGI_FORMAT format;
+		UINT offset;
+		bool operator==(const IndexBufferBinding& other) const { return buffer == other.buffer && format == other.format && offset == other.offset; }
+	};
+	struct ViewportBinding {
+		D3D11_VIEWPORT viewport;
+		bool operator==(const ViewportBinding& other) const;
+	};
+	struct RenderTargetBinding {
+		ID3D11RenderTargetView* target;
+		ID3D11DepthStencilView* depthStencil;
+		bool operator==(const RenderTargetBinding& other) const { return target == other.target && depthStencil == other.depthStencil; }
+	};
+	struct DepthStencilBinding {
+		ID3D11DepthStencilState* state;
+		UINT stencilRef;
+		bool operator==(const DepthStencilBinding& other) const { return state == other.state && stencilRef == other.stencilRef; }
+	};
+	struct BlendBinding {
+		ID3D11BlendState* state;
+		FLOAT blendFactor[4];
+		UINT sampleMask;
+		bool operator==(const BlendBinding& other) const;
+	};
+
+	// Records the value and counts the call, false when it was bound already.
+	template <class T> bool Update(Binding<T>& binding, const T& value);
+	bool PassThrough();
+
+	ID3D11DeviceContext* m_context = 0;
+	ID3D11DeviceContext1* m_context1 = 0;	// 0 before the 11.1 runtime.
+	RenderStateStats m_stats;
+
+	Binding<ID3D11InputLayout*> m_inputLayout;
+	Binding<VertexBufferBinding> m_vertexBuffers[SLOTS];
+	Binding<IndexBufferBinding> m_indexBuffer;
+	Binding<D3D11_PRIMITIVE_TOPOLOGY> m_topology;
+	Binding<ID3D11VertexShader*> m_vertexShader;
+	Binding<ConstantBufferBinding> m_vertexConstantBuffers[SLOTS];
+	Binding<ID3D11PixelShader*> m_pixelShader;
+	Binding<ID3D11Buffer*> m_pixelConstantBuffers[SLOTS];
+	Binding<ID3D11ShaderResourceView*> m_pixelShaderResources[SLOTS];
+	Binding<ID3D11SamplerState*> m_pixelSamplers[SLOTS];
+	Binding<ID3D11RasterizerState*> m_rasterizerState;
+	Binding<ViewportBinding> m_viewport;
+	Binding<RenderTargetBinding> m_renderTarget;
+	Binding<DepthStencilBinding> m_depthStencilState;
+	Binding<BlendBinding> m_blendState;
+};
@@ -0,0 +1,46 @@
+#include "resourcecacheclass.hpp"
+#include <ctype.h>
+#include <filesystem>
+
+AssetPath PathTableClass::Intern(const char* path) {
+	if (!path || !*path) { return AssetPath(); }
+	std::string normalized = Normalize(path);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_ids.find(normalized);
+	if (found != m_ids.end()) { return { found->second }; }
+
+	m_strings.push_back(normalized);
+	uint32_t id = (uint32_t)m_strings.size();
+	m_ids.emplace(std::move(normalized), id);
+	return { id };
+}
+
+AssetPath PathTableClass::Find(const char* path) const {
+	if (!path || !*path) { return AssetPath(); }
+	std::string normalized = Normalize(path);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_ids.find(normalized);
+	return found != m_ids.end() ? AssetPath{ found->second } : AssetPath();
+}
+
+const std::string& PathTableClass::GetString(AssetPath path) const {
+	static const std::string none;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!path.IsValid() || path.id > m_strings.size()) { return none; }
+	return m_strings[path.id - 1];
+}
+
+size_t PathTableClass::GetCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_strings.size();
+}
+
+std::string PathTableClass::Normalize(const char* path) {
+	std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+#ifdef _WIN32
+	for (char& c : normalized) { c = (char)tolower((unsigned char)c); }
+#endif
+	return normalized;
+}
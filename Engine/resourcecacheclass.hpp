@@ -0,0 +1,235 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// An interned asset path. Equal paths get equal ids no matter how they were spelled.
+struct AssetPath {
+	uint32_t id = 0;	// 0 is no path.
+	bool IsValid() const { return id != 0; }
+	bool operator==(const AssetPath& other) const { return id == other.id; }
+	bool operator!=(const AssetPath& other) const { return id != other.id; }
+};
+
+// Cache keys are a path plus a variant for resources built several ways from one file, like shader permutations.
+inline uint64_t ResourceKey(AssetPath path, uint32_t variant = 0) { return (uint64_t)variant << 32 | path.id; }
+
+// Names a cache slot. The generation changes whenever the slot is freed, so stale handles just stop resolving.
+struct ResourceHandle {
+	uint32_t index = 0;
+	uint32_t generation = 0;	// 0 never names a live resource.
+	bool IsValid() const { return generation != 0; }
+};
+
+struct ResourceCacheStats {
+	size_t hits = 0;		// Acquires served by a resource that was already there or being loaded.
+	size_t misses = 0;		// Loads that actually ran.
+	size_t evictions = 0;	// Resources freed by their last release.
+	size_t resident = 0;
+};
+
+// Thread safe string interning for asset paths.
+class PathTableClass {
+public:
+	PathTableClass() {}
+	PathTableClass(const PathTableClass&) = delete;
+
+	AssetPath Intern(const char* path);
+	AssetPath Find(const char* path) const;	// Invalid when the path was never interned.
+	const std::string& GetString(AssetPath path) const;	// Empty for invalid paths.
+	size_t GetCount() const;
+
+	static std::string Normalize(const char* path);	// Lexically normal with forward slashes, lower case on Windows.
+
+private:
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, uint32_t> m_ids;
+	std::deque<std::string> m_strings;	// Indexed by id - 1, a deque keeps handed out references valid.
+};
+
+// Reference counted resources deduplicated by key. Any thread may acquire and release; the first acquire of a key
+// runs the create function outside the lock while later ones for the same key wait for it instead of loading again.
+// The last release deletes the resource.
+template <class T>
+class ResourceCacheClass {
+public:
+	ResourceCacheClass() {}
+	ResourceCacheClass(const ResourceCacheClass&) = delete;
+	~ResourceCacheClass();
+
+	// Invalid handle and the create function's error when the resource could not be made.
+	ResourceHandle Acquire(uint64_t key, const std::function<T*(std::string&)>& create, std::string& error);
+	ResourceHandle AddReference(ResourceHandle handle);
+	void Release(ResourceHandle handle);
+	// Swaps a rebuilt resource in under key, existing handles keep working and see it from now on. Returns what the
+	// caller has to delete: the old resource, or the new one when nobody holds the key anymore.
+	T* Replace(uint64_t key, T* resource);
+
+	T* Get(ResourceHandle handle) const;	// 0 for stale handles. Look it up again each frame, Replace may swap it.
+	T* Lookup(uint64_t key) const;	// What is loaded under key, 0 while nothing is.
+	uint32_t GetReferenceCount(ResourceHandle handle) const;
+	ResourceCacheStats GetStats() const;
+
+private:
+	struct Slot {
+		T* resource = 0;
+		uint64_t key = 0;
+		uint32_t generation = 1;
+		uint32_t references = 0;
+		bool loading = false;
+	};
+
+	const Slot* Find(ResourceHandle handle) const;
+	Slot* Find(ResourceHandle handle) { return const_cast<Slot*>(static_cast<const ResourceCacheClass*>(this)->Find(handle)); }
+	void FreeSlot(uint32_t index);
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_loaded;
+	std::vector<Slot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	std::unordered_map<uint64_t, uint32_t> m_lookup;
+	ResourceCacheStats m_stats;
+};
+
+template <class T>
+ResourceCacheClass<T>::~ResourceCacheClass() {
+	for (Slot& slot : m_slots) {
+		delete slot.resource;
+		slot.resource = 0;
+	}
+}
+
+template <class T>
+ResourceHandle ResourceCacheClass<T>::Acquire(uint64_t key, const std::function<T*(std::string&)>& create, std::string& error) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		auto found = m_lookup.find(key);
+		if (found == m_lookup.end()) { break; }
+
+		uint32_t index = found->second;
+		if (!m_slots[index].loading) {
+			m_slots[index].references++;
+			m_stats.hits++;
+			return { index, m_slots[index].generation };
+		}
+		// Someone else is loading it. When that fails the key is gone again and this thread tries itself.
+		m_loaded.wait(lock);
+	}
+
+	uint32_t index;
+	if (!m_freeSlots.empty()) {
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		index = (uint32_t)m_slots.size();
+		m_slots.emplace_back();
+	}
+	m_slots[index].key = key;
+	m_slots[index].references = 1;
+	m_slots[index].loading = true;
+	m_lookup[key] = index;
+	m_stats.misses++;
+
+	lock.unlock();
+	T* resource = create(error);
+	lock.lock();
+
+	Slot& slot = m_slots[index];
+	slot.loading = false;
+	if (resource) {
+		slot.resource = resource;
+		m_stats.resident++;
+	}
+	else {
+		m_lookup.erase(key);
+		FreeSlot(index);
+	}
+	m_loaded.notify_all();
+	return resource ? ResourceHandle{ index, slot.generation } : ResourceHandle();
+}
+
+template <class T>
+ResourceHandle ResourceCacheClass<T>::AddReference(ResourceHandle handle) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Slot* slot = Find(handle);
+	if (!slot) { return ResourceHandle(); }
+	slot->references++;
+	return handle;
+}
+
+template <class T>
+void ResourceCacheClass<T>::Release(ResourceHandle handle) {
+	T* evicted = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Slot* slot = Find(handle);
+		if (!slot || --slot->references > 0) { return; }
+		evicted = slot->resource;
+		m_lookup.erase(slot->key);
+		FreeSlot(handle.index);
+		m_stats.evictions++;
+		m_stats.resident--;
+	}
+	delete evicted;	// Outside the lock, a destructor may release resources of its own.
+}
+
+template <class T>
+T* ResourceCacheClass<T>::Replace(uint64_t key, T* resource) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_lookup.find(key);
+	if (found == m_lookup.end() || m_slots[found->second].loading) { return resource; }
+	std::swap(m_slots[found->second].resource, resource);
+	return resource;
+}
+
+template <class T>
+T* ResourceCacheClass<T>::Get(ResourceHandle handle) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const Slot* slot = Find(handle);
+	return slot ? slot->resource : 0;
+}
+
+template <class T>
+T* ResourceCacheClass<T>::Lookup(uint64_t key) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_lookup.find(key);
+	if (found == m_lookup.end() || m_slots[found->second].loading) { return 0; }
+	return m_slots[found->second].resource;
+}
+
+template <class T>
+uint32_t ResourceCacheClass<T>::GetReferenceCount(ResourceHandle handle) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const Slot* slot = Find(handle);
+	return slot ? slot->references : 0;
+}
+
+template <class T>
+ResourceCacheStats ResourceCacheClass<T>::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+template <class T>
+const typename ResourceCacheClass<T>::Slot* ResourceCacheClass<T>::Find(ResourceHandle handle) const {
+	if (!handle.IsValid() || handle.index >= m_slots.size()) { return 0; }
+	const Slot& slot = m_slots[handle.index];
+	return slot.generation == handle.generation && !slot.loading && slot.resource ? &slot : 0;
+}
+
+template <class T>
+void ResourceCacheClass<T>::FreeSlot(uint32_t index) {
+	Slot& slot = m_slots[index];
+	slot.resource = 0;
+	slot.references = 0;
+	slot.generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+	m_freeSlots.push_back(index);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "resourcecacheclass.hpp"
+#include "meshclass.hpp"
+#include "textureclass.hpp"
+#include "lightshaderclass.hpp"
+#include "texturestreamerclass.hpp"
+
+// The shared resources of the engine, each loaded once per path no matter how many owners ask for it. Owners keep
+// the handles they acquired and release them when done. The registry has to outlive every owner.
+class ResourceRegistryClass {
+public:
+	ResourceRegistryClass() {}
+	ResourceRegistryClass(const ResourceRegistryClass&) = delete;
+
+	PathTableClass paths;
+	ResourceCacheClass<MeshClass> meshes;			// Keyed by the source model path.
+	ResourceCacheClass<TextureClass> textures;		// Keyed by the image path.
+	ResourceCacheClass<LightShaderClass> shaders;	// Keyed by the vertex shader path and LightShaderClass::GetVariant.
+	// Not owned. When set, textures created from here on stream their mips under its budget, keyed like textures.
+	TextureStreamerClass* textureStreamer = 0;
+	// Not owned. When set, shaders created from here on load their bytecode through it.
+	ShaderCacheClass* shaderCache = 0;
+	// Not owned. The state objects shaders created from here on share, has to be set before any shader is.
+	StateObjectCacheClass* stateObjects = 0;
+};
@@ -0,0 +1,260 @@
+#include "shadercacheclass.hpp"
+#include <stdio.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "dependencygraphclass.hpp"
+
+#ifdef _WIN32
+#include <d3dcompiler.h>
+#endif
+
+namespace {
+
+constexpr uint32_t SHADER_FILE_TAG = 0x43444853;	// "SHDC"
+
+struct ShaderFileHeader {
+	uint32_t tag;
+	uint32_t version;
+	uint64_t sourceKey;
+	uint64_t size;
+};
+
+// FNV-1a, with every string ended by a zero so neighbouring ones can not run into each other.
+struct Hasher {
+	uint64_t hash = 14695981039346656037ull;
+
+	void Add(const void* data, size_t size) {
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++) { hash = (hash ^ bytes[i]) * 1099511628211ull; }
+	}
+	void Add(const std::string& text) { Add(text.c_str(), text.size() + 1); }
+	void Add(uint64_t value) { Add(&value, sizeof(value)); }
+};
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+ShaderCacheClass::ShaderCacheClass(const char* directory, ShaderCompiler compiler, uint64_t compilerKey, size_t threadCount)
+	: m_directory(directory), m_compiler(std::move(compiler)), m_compilerKey(compilerKey) {
+	m_pool = new ThreadPoolClass(threadCount);
+	std::error_code error;
+	std::filesystem::create_directories(m_directory, error);
+	isInitialized = !error && std::filesystem::is_directory(m_directory, error);
+}
+
+ShaderCacheClass::~ShaderCacheClass() {
+	// First, the workers still compiling write into the members.
+	if (m_pool) {
+		delete m_pool;
+		m_pool = 0;
+	}
+}
+
+void ShaderCacheClass::Prefetch(const std::vector<ShaderCompileRequest>& requests) {
+	for (const ShaderCompileRequest& request : requests) {
+		uint64_t key = GetPermutationKey(request);
+		std::shared_ptr<Pending> pending = std::make_shared<Pending>();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_pending.emplace(key, pending).second) { continue; }
+		}
+		m_pool->Submit([this, request, pending]() {
+			std::vector<unsigned char> bytecode;
+			std::string error;
+			bool result = Load(request, bytecode, error);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pending->result = result;
+			pending->bytecode = std::move(bytecode);
+			pending->error = std::move(error);
+			pending->done = true;
+			m_finished.notify_all();
+		});
+	}
+}
+
+bool ShaderCacheClass::Get(const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error) {
+	// A prefetched permutation is handed out once, later calls check the sources again, which is what a hot reload needs.
+	uint64_t key = GetPermutationKey(request);
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto found = m_pending.find(key);
+		if (found != m_pending.end()) {
+			// Every waiter holds the result itself, the first one to wake takes it out of the map while the others may
+			// still be waiting on it.
+			std::shared_ptr<Pending> pending = found->second;
+			m_finished.wait(lock, [&]() { return pending->done; });
+			bytecode = pending->bytecode;
+			error = pending->error;
+			found = m_pending.find(key);
+			if (found != m_pending.end() && found->second == pending) { m_pending.erase(found); }
+			return pending->result;
+		}
+	}
+	return Load(request, bytecode, error);
+}
+
+bool ShaderCacheClass::Load(const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error) {
+	auto start = std::chrono::steady_clock::now();
+	uint64_t permutationKey = GetPermutationKey(request);
+	uint64_t sourceKey = 0;
+	bool cacheable = isInitialized && GetSourceKey(request, permutationKey, sourceKey);
+	std::string filename = GetFilename(permutationKey);
+	if (cacheable && Read(filename, sourceKey, bytecode)) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.hits++;
+		m_stats.loadMilliseconds += MillisecondsSince(start);
+		return true;
+	}
+	double loadMilliseconds = MillisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	bytecode.clear();
+	bool result = m_compiler(request, bytecode, error);
+	// A failed write only costs the next launch another compile.
+	if (result && cacheable) { Write(filename, sourceKey, bytecode); }
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.loadMilliseconds += loadMilliseconds;
+	m_stats.compileMilliseconds += MillisecondsSince(start);
+	if (result) { m_stats.misses++; }
+	else { m_stats.failures++; }
+	return result;
+}
+
+bool ShaderCacheClass::Read(const std::string& filename, uint64_t sourceKey, std::vector<unsigned char>& bytecode) const {
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin.fail()) { return false; }
+	ShaderFileHeader header{};
+	fin.read((char*)&header, sizeof(header));
+	if (fin.fail() || header.tag != SHADER_FILE_TAG || header.version != FILE_VERSION || header.sourceKey != sourceKey) { return false; }
+
+	// Bytecode is a few kilobytes, anything near this is a damaged file.
+	if (header.size == 0 || header.size > (64u << 20)) { return false; }
+	bytecode.resize((size_t)header.size);
+	fin.read((char*)bytecode.data(), (std::streamsize)header.size);
+	return !fin.fail() && fin.peek() == EOF;
+}
+
+bool ShaderCacheClass::Write(const std::string& filename, uint64_t sourceKey, const std::vector<unsigned char>& bytecode) {
+	ShaderFileHeader header{};
+	header.tag = SHADER_FILE_TAG;
+	header.version = FILE_VERSION;
+	header.sourceKey = sourceKey;
+	header.size = bytecode.size();
+
+	// Write next to the target and swap it in, so a crash never leaves a half written entry behind. Two threads may
+	// compile the same permutation, each gets its own temporary file.
+	std::string tempFilename;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		tempFilename = filename + "." + std::to_string(m_nextTemp++) + ".tmp";
+	}
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (fout.fail()) { return false; }
+	fout.write((const char*)&header, sizeof(header));
+	fout.write((const char*)bytecode.data(), (std::streamsize)bytecode.size());
+	fout.close();
+
+	std::error_code error;
+	if (!fout.fail()) { std::filesystem::rename(tempFilename, filename, error); }
+	if (fout.fail() || error) {
+		std::filesystem::remove(tempFilename, error);
+		return false;
+	}
+	return true;
+}
+
+std::string ShaderCacheClass::GetFilename(uint64_t permutationKey) const {
+	char name[24];
+	snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)permutationKey);
+	return (std::filesystem::path(m_directory) / name).string();
+}
+
+uint64_t ShaderCacheClass::GetPermutationKey(const ShaderCompileRequest& request) const {
+	Hasher hasher;
+	hasher.Add(m_compilerKey);
+	hasher.Add((uint64_t)FILE_VERSION);
+	hasher.Add(std::filesystem::path(request.filename).lexically_normal().generic_string());
+	hasher.Add(request.entryPoint);
+	hasher.Add(request.profile);
+	hasher.Add((uint64_t)request.flags);
+	hasher.Add((uint64_t)request.defines.size());
+	for (const std::pair<std::string, std::string>& define : request.defines) {
+		hasher.Add(define.first);
+		hasher.Add(define.second);
+	}
+	return hasher.hash;
+}
+
+bool ShaderCacheClass::GetSourceKey(const ShaderCompileRequest& request, uint64_t permutationKey, uint64_t& sourceKey) {
+	// Every file a permutation could include, the same list hot reloading watches. A missing include still counts, by
+	// name, so adding it later changes the key.
+	Hasher hasher;
+	hasher.Add(permutationKey);
+	std::vector<std::string> files = DependencyGraphClass::ScanShaderIncludes(request.filename.c_str());
+	for (size_t i = 0; i < files.size(); i++) {
+		std::ifstream fin(files[i], std::ios::binary);
+		if (fin.fail() && i == 0) { return false; }
+		std::string contents((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+		hasher.Add(files[i]);
+		hasher.Add((uint64_t)contents.size());
+		hasher.Add(contents.data(), contents.size());
+	}
+	sourceKey = hasher.hash;
+	return true;
+}
+
+ShaderCacheStats ShaderCacheClass::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+bool ShaderCacheClass::Compile(ShaderCacheClass* cache, const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error) {
+	return cache ? cache->Get(request, bytecode, error) : CompileD3D(request, bytecode, error);
+}
+
+bool ShaderCacheClass::CompileD3D(const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error) {
+#ifdef _WIN32
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (const std::pair<std::string, std::string>& define : request.defines) { macros.push_back({ define.first.c_str(), define.second.c_str() }); }
+	macros.push_back({ NULL, NULL });
+
+	std::wstring filename = std::filesystem::path(request.filename).wstring();
+	ID3D10Blob* shaderBuffer = 0;
+	ID3D10Blob* errorMessage = 0;
+	HRESULT result = D3DCompileFromFile(filename.c_str(), macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, request.entryPoint.c_str(),
+		request.profile.c_str(), request.flags, 0, &shaderBuffer, &errorMessage);
+	if (errorMessage) {
+		error.assign((const char*)errorMessage->GetBufferPointer(), errorMessage->GetBufferSize());
+		errorMessage->Release();
+	}
+	if (FAILED(result)) {
+		if (shaderBuffer) { shaderBuffer->Release(); }
+		if (error.empty()) { error = request.filename + ": could not read the shader"; }
+		return false;
+	}
+
+	const unsigned char* data = (const unsigned char*)shaderBuffer->GetBufferPointer();
+	bytecode.assign(data, data + shaderBuffer->GetBufferSize());
+	shaderBuffer->Release();
+	error.clear();	// Only warnings.
+	return true;
+#else
+	(void)bytecode;
+	error = request.filename + ": the D3D compiler is only available on Windows";
+	return false;
+#endif
+}
+
+uint64_t ShaderCacheClass::GetD3DCompilerKey() {
+#ifdef _WIN32
+	return D3D_COMPILER_VERSION;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "threadpoolclass.hpp"
+
+// One permutation of a shader, everything D3DCompileFromFile is given.
+struct ShaderCompileRequest {
+	std::string filename;
+	std::string entryPoint;
+	std::string profile;	// Such as vs_5_0.
+	std::vector<std::pair<std::string, std::string>> defines;
+	uint32_t flags = 0;
+};
+
+// Compiles one request into bytecode, or fails with the compiler's messages. Called from any thread.
+typedef std::function<bool(const ShaderCompileRequest&, std::vector<unsigned char>&, std::string&)> ShaderCompiler;
+
+struct ShaderCacheStats {
+	size_t hits = 0;	// Bytecode loaded from the cache.
+	size_t misses = 0;	// Compiled, no entry or a stale one.
+	size_t failures = 0;	// Did not compile.
+	double loadMilliseconds = 0.0;	// Summed over the threads, hashing the sources included.
+	double compileMilliseconds = 0.0;
+};
+
+// Keeps compiled shader bytecode on disk, so launches after the first skip the compiler. Each permutation has one file,
+// named after its entry point, profile, defines, flags and compiler; inside it a hash over the source and every file it
+// includes says whether the bytecode is still current. Editing any of them makes the entry stale, which the next
+// compile overwrites. Prefetch compiles the misses on the cache's own workers while the caller gets on with loading,
+// Get then only waits for the ones it needs. Thread safe.
+class ShaderCacheClass {
+public:
+	static constexpr uint32_t FILE_VERSION = 1;
+
+	// compilerKey tells compilers apart whose output differs, such as two versions of d3dcompiler.
+	ShaderCacheClass(const char* directory, ShaderCompiler compiler, uint64_t compilerKey, size_t threadCount = 0);
+	ShaderCacheClass(const ShaderCacheClass&) = delete;
+	~ShaderCacheClass();	// Compiles still queued are dropped.
+
+	void Prefetch(const std::vector<ShaderCompileRequest>& requests);
+	bool Get(const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error);
+
+	// Get on the cache when there is one, the D3D compiler without.
+	static bool Compile(ShaderCacheClass* cache, const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error);
+	static bool CompileD3D(const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error);
+	static uint64_t GetD3DCompilerKey();
+
+	// Which file a request lives in, and what that file has to hold to be current. The source key is false when the
+	// shader itself can not be read, the compiler then reports why.
+	uint64_t GetPermutationKey(const ShaderCompileRequest& request) const;
+	static bool GetSourceKey(const ShaderCompileRequest& request, uint64_t permutationKey, uint64_t& sourceKey);
+
+	ShaderCacheStats GetStats() const;
+
+	bool isInitialized = false;	// Without its directory the cache only compiles.
+
+private:
+	struct Pending {
+		bool done = false;
+		bool result = false;
+		std::vector<unsigned char> bytecode;
+		std::string error;
+	};
+
+	bool Load(const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error);
+	bool Read(const std::string& filename, uint64_t sourceKey, std::vector<unsigned char>& bytecode) const;
+	bool Write(const std::string& filename, uint64_t sourceKey, const std::vector<unsigned char>& bytecode);
+	std::string GetFilename(uint64_t permutationKey) const;
+
+	std::string m_directory;
+	ShaderCompiler m_compiler;
+	uint64_t m_compilerKey = 0;
+	ThreadPoolClass* m_pool = 0;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_finished;
+	std::unordered_map<uint64_t, std::shared_ptr<Pending>> m_pending;	// By permutation key, shared with the worker and the waiters.
+	ShaderCacheStats m_stats;
+	uint64_t m_nextTemp = 0;
+};
@@ -0,0 +1,32 @@
+#include "shaderpermutationclass.hpp"
+
+std::vector<ShaderKey> ShaderPermutationClass::Enumerate(ShaderKey maximum) {
+	std::vector<ShaderKey> keys;
+	for (uint32_t bits = 0; bits < ShaderKey::COUNT; bits++) {
+		ShaderKey key{ bits };
+		if (key.IsValid() && IsWithin(key, maximum)) { keys.push_back(key); }
+	}
+	return keys;
+}
+
+std::vector<std::pair<std::string, std::string>> ShaderPermutationClass::GetDefines(ShaderKey key) {
+	// Every key defines the two numbers, so the shader never has to guess a default that differs from the key.
+	std::vector<std::pair<std::string, std::string>> defines;
+	if (key.Has(ShaderKey::TEXTURE)) { defines.push_back({ "TEXTURED", "1" }); }
+	if (key.Has(ShaderKey::ALPHA_TEST)) { defines.push_back({ "ALPHA_TEST", "1" }); }
+	if (key.Has(ShaderKey::FOG)) { defines.push_back({ "FOG", "1" }); }
+	defines.push_back({ "LIGHTING_MODEL", std::to_string(key.GetLighting()) });
+	defines.push_back({ "LIGHT_COUNT", std::to_string(key.GetLightCount()) });
+	return defines;
+}
+
+std::vector<ShaderKey> ShaderPermutationClass::GetDetailKeys(ShaderKey key) {
+	std::vector<ShaderKey> keys;
+	for (uint32_t detail = 0; detail < DETAIL_LEVELS; detail++) {
+		ShaderKey reduced = Reduce(key, detail);
+		bool known = false;
+		for (ShaderKey previous : keys) { known = known || previous == reduced; }
+		if (!known) { keys.push_back(reduced); }
+	}
+	return keys;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum ShaderLighting : uint32_t {
+	LIGHTING_UNLIT = 0,			// The surface color as it is.
+	LIGHTING_LAMBERT = 1,		// Diffuse only.
+	LIGHTING_BLINN_PHONG = 2,	// Diffuse and a specular highlight.
+};
+
+// The features one pixel shader permutation is compiled with, packed into a few bits so the key indexes a table of
+// all of them directly. Keys are built with the With functions at compile time and checked with IsValid, the
+// combinations that make no sense, such as lights on an unlit surface, are invalid and never compiled.
+struct ShaderKey {
+	static constexpr uint32_t TEXTURE = 1u << 0;
+	static constexpr uint32_t ALPHA_TEST = 1u << 1;	// Discards the pixels whose texture alpha is below the reference.
+	static constexpr uint32_t FOG = 1u << 2;
+	static constexpr uint32_t LIGHTING_SHIFT = 3;	// Two bits of ShaderLighting.
+	static constexpr uint32_t LIGHT_COUNT_SHIFT = 5;	// Three bits, 0 to MAX_LIGHTS.
+	static constexpr uint32_t MAX_LIGHTS = 4;
+	static constexpr uint32_t BITS = 8;
+	static constexpr uint32_t COUNT = 1u << BITS;	// Of the table a key indexes.
+
+	uint32_t bits = 0;
+
+	constexpr bool Has(uint32_t feature) const { return (bits & feature) != 0; }
+	constexpr ShaderLighting GetLighting() const { return (ShaderLighting)(bits >> LIGHTING_SHIFT & 3u); }
+	constexpr uint32_t GetLightCount() const { return bits >> LIGHT_COUNT_SHIFT & 7u; }
+
+	constexpr ShaderKey With(uint32_t feature, bool enabled = true) const { return { enabled ? bits | feature : bits & ~feature }; }
+	constexpr ShaderKey WithLighting(ShaderLighting lighting) const { return { (bits & ~(3u << LIGHTING_SHIFT)) | (lighting & 3u) << LIGHTING_SHIFT }; }
+	constexpr ShaderKey WithLightCount(uint32_t count) const { return { (bits & ~(7u << LIGHT_COUNT_SHIFT)) | (count & 7u) << LIGHT_COUNT_SHIFT }; }
+
+	constexpr bool IsValid() const {
+		if (bits >= COUNT || GetLighting() > LIGHTING_BLINN_PHONG || GetLightCount() > MAX_LIGHTS) { return false; }
+		if ((GetLighting() == LIGHTING_UNLIT) != (GetLightCount() == 0)) { return false; }
+		return !Has(ALPHA_TEST) || Has(TEXTURE);	// The alpha comes from the texture.
+	}
+
+	constexpr bool operator==(const ShaderKey& other) const { return bits == other.bits; }
+	constexpr bool operator!=(const ShaderKey& other) const { return bits != other.bits; }
+};
+
+// Builds the keys, their defines and their cheaper stand-ins. The shaders read the features as TEXTURED, ALPHA_TEST,
+// FOG, LIGHTING_MODEL and LIGHT_COUNT. Free of D3D, like the keys.
+class ShaderPermutationClass {
+public:
+	static constexpr uint32_t DETAIL_LEVELS = 3;	// Full, reduced and distant.
+
+	// Every valid key that uses no more than the given one: its flags or fewer, its lighting model or a simpler one, as
+	// many lights or fewer. Ordered by key, each once.
+	static std::vector<ShaderKey> Enumerate(ShaderKey maximum);
+	static constexpr uint32_t Count(ShaderKey maximum);
+
+	static std::vector<std::pair<std::string, std::string>> GetDefines(ShaderKey key);
+
+	// The key to draw with at a detail level, 0 being the full one. Further levels drop the specular highlight and
+	// the extra lights, which cost the most per pixel and are the least visible on something small. Fog and alpha test
+	// stay, leaving them out would change the silhouette and the color of what is far away.
+	static constexpr ShaderKey Reduce(ShaderKey key, uint32_t detail);
+	// The level for something that covers screenSize pixels of the viewport height, the measure the LODs are picked
+	// by. Below the first threshold the highlight goes, below the second all lights but one.
+	static constexpr float DETAIL_PIXELS[DETAIL_LEVELS - 1] = { 256.0f, 64.0f };
+	static constexpr uint32_t SelectDetail(float screenSize);
+	// The keys Reduce gives for every level, each once, which is what a scene drawing with key has to compile.
+	static std::vector<ShaderKey> GetDetailKeys(ShaderKey key);
+
+private:
+	static constexpr bool IsWithin(ShaderKey key, ShaderKey maximum);
+};
+
+constexpr bool ShaderPermutationClass::IsWithin(ShaderKey key, ShaderKey maximum) {
+	constexpr uint32_t FLAGS = ShaderKey::TEXTURE | ShaderKey::ALPHA_TEST | ShaderKey::FOG;
+	if ((key.bits & FLAGS & ~maximum.bits) != 0) { return false; }
+	return key.GetLighting() <= maximum.GetLighting() && key.GetLightCount() <= maximum.GetLightCount();
+}
+
+constexpr uint32_t ShaderPermutationClass::Count(ShaderKey maximum) {
+	uint32_t count = 0;
+	for (uint32_t bits = 0; bits < ShaderKey::COUNT; bits++) {
+		ShaderKey key{ bits };
+		if (key.IsValid() && IsWithin(key, maximum)) { count++; }
+	}
+	return count;
+}
+
+constexpr ShaderKey ShaderPermutationClass::Reduce(ShaderKey key, uint32_t detail) {
+	if (detail == 0 || key.GetLighting() == LIGHTING_UNLIT) { return key; }
+	uint32_t lights = key.GetLightCount();
+	uint32_t maximumLights = detail == 1 ? 2 : 1;
+	return key.WithLighting(LIGHTING_LAMBERT).WithLightCount(lights < maximumLights ? lights : maximumLights);
+}
+
+constexpr uint32_t ShaderPermutationClass::SelectDetail(float screenSize) {
+	uint32_t detail = 0;
+	while (detail + 1 < DETAIL_LEVELS && screenSize < DETAIL_PIXELS[detail]) { detail++; }
+	return detail;
+}
+
+// The rules, on every compiler that builds the engine.
+namespace ShaderKeyChecks {
+	inline constexpr ShaderKey FULL = ShaderKey().With(ShaderKey::TEXTURE).With(ShaderKey::ALPHA_TEST).With(ShaderKey::FOG)
+		.WithLighting(LIGHTING_BLINN_PHONG).WithLightCount(ShaderKey::MAX_LIGHTS);
+	static_assert(FULL.IsValid() && FULL.bits < ShaderKey::COUNT);
+	static_assert(FULL.GetLighting() == LIGHTING_BLINN_PHONG && FULL.GetLightCount() == 4 && FULL.Has(ShaderKey::FOG));
+	static_assert(ShaderKey().IsValid());	// Unlit and untextured, the plain color.
+	static_assert(!ShaderKey().WithLightCount(1).IsValid() && !ShaderKey().WithLighting(LIGHTING_LAMBERT).IsValid());
+	static_assert(!ShaderKey().With(ShaderKey::ALPHA_TEST).IsValid());
+	static_assert(!ShaderKey().WithLighting(LIGHTING_LAMBERT).WithLightCount(ShaderKey::MAX_LIGHTS + 1).IsValid());
+
+	// Untextured or textured with or without alpha test, with or without fog, unlit or one of two models with 1 to 4
+	// lights.
+	static_assert(ShaderPermutationClass::Count(FULL) == 3 * 2 * 9);
+	static_assert(ShaderPermutationClass::Count(ShaderKey()) == 1);
+
+	static_assert(ShaderPermutationClass::Reduce(FULL, 0) == FULL);
+	static_assert(ShaderPermutationClass::Reduce(FULL, 1).GetLighting() == LIGHTING_LAMBERT && ShaderPermutationClass::Reduce(FULL, 1).GetLightCount() == 2);
+	static_assert(ShaderPermutationClass::Reduce(FULL, 2).GetLightCount() == 1 && ShaderPermutationClass::Reduce(FULL, 2).Has(ShaderKey::FOG));
+	static_assert(ShaderPermutationClass::Reduce(FULL, 2).IsValid() && ShaderPermutationClass::Reduce(ShaderKey(), 2) == ShaderKey());
+
+	static_assert(ShaderPermutationClass::SelectDetail(1080.0f) == 0 && ShaderPermutationClass::SelectDetail(256.0f) == 0);
+	static_assert(ShaderPermutationClass::SelectDetail(255.0f) == 1 && ShaderPermutationClass::SelectDetail(64.0f) == 1);
+	static_assert(ShaderPermutationClass::SelectDetail(63.0f) == 2 && ShaderPermutationClass::SelectDetail(0.0f) == 2);
+}
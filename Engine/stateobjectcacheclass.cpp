@@ -0,0 +1,117 @@
+#include "stateobjectcacheclass.hpp"
+#include <string.h>
+
+namespace {
+
+// Descriptions with padding between their members are rebuilt member by member over zeroed memory, so equal
+// descriptions always have equal bytes.
+D3D11_DEPTH_STENCIL_DESC Canonical(const D3D11_DEPTH_STENCIL_DESC& desc) {
+	D3D11_DEPTH_STENCIL_DESC canonical;
+	memset(&canonical, 0, sizeof(canonical));
+	canonical.DepthEnable = desc.DepthEnable;
+	canonical.DepthWriteMask = desc.DepthWriteMask;
+	canonical.DepthFunc = desc.DepthFunc;
+	canonical.StencilEnable = desc.StencilEnable;
+	canonical.StencilReadMask = desc.StencilReadMask;
+	canonical.StencilWriteMask = desc.StencilWriteMask;
+	canonical.FrontFace = desc.FrontFace;
+	canonical.BackFace = desc.BackFace;
+	return canonical;
+}
+
+D3D11_BLEND_DESC Canonical(const D3D11_BLEND_DESC& desc) {
+	D3D11_BLEND_DESC canonical;
+	memset(&canonical, 0, sizeof(canonical));
+	canonical.AlphaToCoverageEnable = desc.AlphaToCoverageEnable;
+	canonical.IndependentBlendEnable = desc.IndependentBlendEnable;
+	for (int i = 0; i < 8; i++) {
+		const D3D11_RENDER_TARGET_BLEND_DESC& source = desc.RenderTarget[i];
+		D3D11_RENDER_TARGET_BLEND_DESC& target = canonical.RenderTarget[i];
+		target.BlendEnable = source.BlendEnable;
+		target.SrcBlend = source.SrcBlend;
+		target.DestBlend = source.DestBlend;
+		target.BlendOp = source.BlendOp;
+		target.SrcBlendAlpha = source.SrcBlendAlpha;
+		target.DestBlendAlpha = source.DestBlendAlpha;
+		target.BlendOpAlpha = source.BlendOpAlpha;
+		target.RenderTargetWriteMask = source.RenderTargetWriteMask;
+	}
+	return canonical;
+}
+
+// The other two are all 32 bit members.
+const D3D11_RASTERIZER_DESC& Canonical(const D3D11_RASTERIZER_DESC& desc) { return desc; }
+const D3D11_SAMPLER_DESC& Canonical(const D3D11_SAMPLER_DESC& desc) { return desc; }
+
+}
+
+StateObjectCacheClass::~StateObjectCacheClass() {
+	for (auto& [key, state] : m_states) { state->Release(); }
+	m_states.clear();
+}
+
+template <class Desc>
+std::string StateObjectCacheClass::GetKey(char kind, const Desc& desc) {
+	const Desc& canonical = Canonical(desc);
+	std::string key(1, kind);
+	key.append((const char*)&canonical, sizeof(Desc));
+	return key;
+}
+
+ID3D11DeviceChild* StateObjectCacheClass::Find(const std::string& key) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_states.find(key);
+	if (found == m_states.end()) { return 0; }
+	m_stats.reused++;
+	return found->second;
+}
+
+ID3D11DeviceChild* StateObjectCacheClass::Insert(const std::string& key, ID3D11DeviceChild* state) {
+	// Two threads may have created the same state, the first one in wins and the other is given back.
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto inserted = m_states.emplace(key, state);
+	if (!inserted.second) {
+		state->Release();
+		m_stats.reused++;
+		return inserted.first->second;
+	}
+	m_stats.created++;
+	return state;
+}
+
+ID3D11RasterizerState* StateObjectCacheClass::GetRasterizerState(const D3D11_RASTERIZER_DESC& desc) {
+	std::string key = GetKey('R', desc);
+	if (ID3D11DeviceChild* found = Find(key)) { return static_cast<ID3D11RasterizerState*>(found); }
+	ID3D11RasterizerState* state = 0;
+	if (FAILED(m_device->CreateRasterizerState(&desc, &state))) { return 0; }
+	return static_cast<ID3D11RasterizerState*>(Insert(key, state));
+}
+
+ID3D11DepthStencilState* StateObjectCacheClass::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc) {
+	std::string key = GetKey('D', desc);
+	if (ID3D11DeviceChild* found = Find(key)) { return static_cast<ID3D11DepthStencilState*>(found); }
+	ID3D11DepthStencilState* state = 0;
+	if (FAILED(m_device->CreateDepthStencilState(&desc, &state))) { return 0; }
+	return static_cast<ID3D11DepthStencilState*>(Insert(key, state));
+}
+
+ID3D11SamplerState* StateObjectCacheClass::GetSamplerState(const D3D11_SAMPLER_DESC& desc) {
+	std::string key = GetKey('S', desc);
+	if (ID3D11DeviceChild* found = Find(key)) { return static_cast<ID3D11SamplerState*>(found); }
+	ID3D11SamplerState* state = 0;
+	if (FAILED(m_device->CreateSamplerState(&desc, &state))) { return 0; }
+	return static_cast<ID3D11SamplerState*>(Insert(key, state));
+}
+
+ID3D11BlendState* StateObjectCacheClass::GetBlendState(const D3D11_BLEND_DESC& desc) {
+	std::string key = GetKey('B', desc);
+	if (ID3D11DeviceChild* found = Find(key)) { return static_cast<ID3D11BlendState*>(found); }
+	ID3D11BlendState* state = 0;
+	if (FAILED(m_device->CreateBlendState(&desc, &state))) { return 0; }
+	return static_cast<ID3D11BlendState*>(Insert(key, state));
+}
+
+StateObjectStats StateObjectCacheClass::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
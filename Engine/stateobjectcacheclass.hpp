@@ -0,0 +1,41 @@
+#pragma once
+#include <d3d11.h>
+#include <stddef.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct StateObjectStats {
+	size_t created = 0;	// Distinct descriptions, one device call each.
+	size_t reused = 0;	// Requests answered without the device.
+};
+
+// The immutable rasterizer, depth stencil, sampler and blend states, one per distinct description. Whoever needs one
+// asks with the description instead of creating it, so equal states are the same object, which is also what lets
+// RenderStateClass skip rebinding them. The states stay owned by the cache and must not be released. Thread safe,
+// shaders rebuilt by hot reloads ask from their workers.
+class StateObjectCacheClass {
+public:
+	StateObjectCacheClass(ID3D11Device* device) : m_device(device) {}
+	StateObjectCacheClass(const StateObjectCacheClass&) = delete;
+	~StateObjectCacheClass();
+
+	// 0 when the device refused the description.
+	ID3D11RasterizerState* GetRasterizerState(const D3D11_RASTERIZER_DESC& desc);
+	ID3D11DepthStencilState* GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc);
+	ID3D11SamplerState* GetSamplerState(const D3D11_SAMPLER_DESC& desc);
+	ID3D11BlendState* GetBlendState(const D3D11_BLEND_DESC& desc);
+
+	StateObjectStats GetStats() const;
+
+private:
+	// The kind and the bytes of the description, with the padding zeroed, hashed by the map.
+	template <class Desc> static std::string GetKey(char kind, const Desc& desc);
+	ID3D11DeviceChild* Find(const std::string& key);
+	ID3D11DeviceChild* Insert(const std::string& key, ID3D11DeviceChild* state);
+
+	ID3D11Device* m_device = 0;
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, ID3D11DeviceChild*> m_states;
+	StateObjectStats m_stats;
+};
@@ -0,0 +1,196 @@
+#include "targadecoderclass.hpp"
+#include "imageconverterclass.hpp"
+#include <string.h>
+#include <algorithm>
+
+static constexpr size_t HEADER_SIZE = 18;
+static constexpr unsigned char DESCRIPTOR_RIGHT_TO_LEFT = 0x10;
+static constexpr unsigned char DESCRIPTOR_TOP_DOWN = 0x20;
+
+static unsigned ReadShort(const unsigned char* p) { return p[0] | p[1] << 8; }
+
+TargaDecoderClass::TargaDecoderClass(std::istream& stream) : m_stream(&stream), m_chunk(CHUNK_SIZE) {}
+
+bool TargaDecoderClass::Fail(const std::string& message) {
+	errorMessage = message;
+	return false;
+}
+
+bool TargaDecoderClass::ReadHeader() {
+	unsigned char header[HEADER_SIZE];
+	if (!ReadBytes(header, HEADER_SIZE)) { return Fail("not a TGA file"); }
+
+	size_t idLength = header[0];
+	int colorMapType = header[1];
+	int imageType = header[2];
+	size_t colorMapFirst = ReadShort(header + 3);
+	size_t colorMapLength = ReadShort(header + 5);
+	int colorMapBits = header[7];
+	m_width = (int)ReadShort(header + 12);
+	m_height = (int)ReadShort(header + 14);
+	int pixelBits = header[16];
+	unsigned char descriptor = header[17];
+
+	m_runLength = imageType >= 9;
+	switch (imageType) {
+	case 1: case 9:
+		if (colorMapType != 1 || pixelBits != 8) { return Fail("unsupported color mapped format"); }
+		m_pixelType = PIXEL_MAPPED;
+		break;
+	case 2: case 10:
+		if (pixelBits != 24 && pixelBits != 32) { return Fail("unsupported pixel depth " + std::to_string(pixelBits)); }
+		m_pixelType = pixelBits == 32 ? PIXEL_BGRA : PIXEL_BGR;
+		break;
+	case 3: case 11:
+		if (pixelBits != 8) { return Fail("unsupported grayscale depth " + std::to_string(pixelBits)); }
+		m_pixelType = PIXEL_GRAY;
+		break;
+	default:
+		return Fail("unsupported image type " + std::to_string(imageType));
+	}
+	m_pixelSize = (size_t)pixelBits / 8;
+	m_topDown = (descriptor & DESCRIPTOR_TOP_DOWN) != 0;
+	m_rightToLeft = (descriptor & DESCRIPTOR_RIGHT_TO_LEFT) != 0;
+	if (m_width <= 0 || m_height <= 0 || m_width > MAX_DIMENSION || m_height > MAX_DIMENSION) {
+		return Fail("bad size " + std::to_string(m_width) + "x" + std::to_string(m_height));
+	}
+
+	unsigned char skipped[256];
+	if (!ReadBytes(skipped, idLength)) { return Fail("unexpected end of file"); }
+	if (colorMapType == 1) {
+		if (m_pixelType == PIXEL_MAPPED) {
+			if (!ReadColorMap(colorMapFirst, colorMapLength, colorMapBits)) { return false; }
+		}
+		else {
+			// True color images may still carry a map, it is of no use here.
+			size_t mapSize = colorMapLength * (((size_t)colorMapBits + 7) / 8);
+			for (size_t skip = 0; skip < mapSize; skip += sizeof(skipped)) {
+				if (!ReadBytes(skipped, std::min(mapSize - skip, sizeof(skipped)))) { return Fail("unexpected end of file"); }
+			}
+		}
+	}
+	m_headerRead = true;
+	return true;
+}
+
+bool TargaDecoderClass::ReadColorMap(size_t first, size_t count, int entryBits) {
+	if (entryBits != 24 && entryBits != 32) { return Fail("unsupported color map depth " + std::to_string(entryBits)); }
+	for (uint32_t& entry : m_palette) { entry = 0; }
+
+	size_t entrySize = (size_t)entryBits / 8;
+	for (size_t i = 0; i < count; i++) {
+		unsigned char bgra[4] = { 0, 0, 0, 255 };
+		if (!ReadBytes(bgra, entrySize)) { return Fail("unexpected end of file"); }
+		if (first + i >= 256) { continue; }	// An 8 bit pixel can never point there.
+		unsigned char rgba[4] = { bgra[2], bgra[1], bgra[0], bgra[3] };
+		memcpy(&m_palette[first + i], rgba, 4);
+	}
+	return true;
+}
+
+bool TargaDecoderClass::Decode(unsigned char* destination) {
+	if (!m_headerRead) { return Fail("the header was not read"); }
+
+	size_t rowSize = (size_t)m_width * 4;
+	for (int y = 0; y < m_height; y++) {
+		unsigned char* row = destination + (size_t)(m_topDown ? y : m_height - 1 - y) * rowSize;
+		bool success = m_runLength ? ReadRunLengthRow(row) : ReadPixels(row, (size_t)m_width);
+		if (!success) { return Fail("unexpected end of file"); }
+
+		if (m_rightToLeft) {
+			for (size_t left = 0, right = (size_t)m_width - 1; left < right; left++, right--) {
+				uint32_t pixel;
+				memcpy(&pixel, row + left * 4, 4);
+				memcpy(row + left * 4, row + right * 4, 4);
+				memcpy(row + right * 4, &pixel, 4);
+			}
+		}
+	}
+	return true;
+}
+
+bool TargaDecoderClass::ReadRunLengthRow(unsigned char* row) {
+	size_t width = (size_t)m_width;
+	for (size_t x = 0; x < width;) {
+		if (m_packetRemaining == 0) {
+			unsigned char header;
+			if (!ReadBytes(&header, 1)) { return false; }
+			m_packetRepeat = (header & 0x80) != 0;
+			m_packetRemaining = (size_t)(header & 0x7F) + 1;
+			if (m_packetRepeat && !ReadPixels(m_packetPixel, 1)) { return false; }
+		}
+
+		size_t count = std::min(m_packetRemaining, width - x);
+		if (m_packetRepeat) {
+			for (size_t i = 0; i < count; i++) { memcpy(row + (x + i) * 4, m_packetPixel, 4); }
+		}
+		else if (!ReadPixels(row + x * 4, count)) { return false; }
+		x += count;
+		m_packetRemaining -= count;
+	}
+	return true;
+}
+
+bool TargaDecoderClass::ReadPixels(unsigned char* destination, size_t count) {
+	while (count > 0) {
+		size_t available = (m_end - m_position) / m_pixelSize;
+		if (available == 0) {
+			if (!Fill()) { return false; }
+			continue;
+		}
+		size_t pixels = std::min(count, available);
+		ConvertPixels(m_chunk.data() + m_position, destination, pixels);
+		m_position += pixels * m_pixelSize;
+		destination += pixels * 4;
+		count -= pixels;
+	}
+	return true;
+}
+
+bool TargaDecoderClass::ReadBytes(unsigned char* destination, size_t count) {
+	while (count > 0) {
+		if (m_position == m_end && !Fill()) { return false; }
+		size_t bytes = std::min(count, m_end - m_position);
+		memcpy(destination, m_chunk.data() + m_position, bytes);
+		m_position += bytes;
+		destination += bytes;
+		count -= bytes;
+	}
+	return true;
+}
+
+bool TargaDecoderClass::Fill() {
+	// Keeps a pixel cut in half by the end of the chunk.
+	size_t left = m_end - m_position;
+	memmove(m_chunk.data(), m_chunk.data() + m_position, left);
+	m_stream->read((char*)m_chunk.data() + left, (std::streamsize)(CHUNK_SIZE - left));
+	size_t read = (size_t)m_stream->gcount();
+	m_position = 0;
+	m_end = left + read;
+	return read > 0;
+}
+
+void TargaDecoderClass::ConvertPixels(const unsigned char* source, unsigned char* destination, size_t count) const {
+	switch (m_pixelType) {
+	case PIXEL_BGRA:
+		ImageConverterClass::BgraToRgba(source, destination, count);
+		break;
+	case PIXEL_BGR:
+		for (size_t i = 0; i < count; i++, source += 3, destination += 4) {
+			destination[0] = source[2];
+			destination[1] = source[1];
+			destination[2] = source[0];
+			destination[3] = 255;
+		}
+		break;
+	case PIXEL_GRAY:
+		for (size_t i = 0; i < count; i++, destination += 4) {
+			destination[0] = destination[1] = destination[2] = source[i];
+			destination[3] = 255;
+		}
+		break;
+	case PIXEL_MAPPED:
+		for (size_t i = 0; i < count; i++) { memcpy(destination + i * 4, &m_palette[source[i]], 4); }
+		break;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Streaming TGA decoder. Reads through one fixed size chunk and writes RGBA8 rows, top row first, straight into the
+// caller's buffer, so a decode needs memory for one image and no more. Handles uncompressed and run length encoded
+// true color (24 and 32 bit), grayscale and color mapped (8 bit) images with any origin.
+class TargaDecoderClass {
+public:
+	static constexpr size_t CHUNK_SIZE = 64 * 1024;
+	static constexpr int MAX_DIMENSION = 16384;	// The largest texture D3D11 can create.
+
+	TargaDecoderClass(std::istream& stream);
+	TargaDecoderClass(const TargaDecoderClass&) = delete;
+
+	bool ReadHeader();
+	bool Decode(unsigned char* destination);	// GetWidth() * GetHeight() * 4 bytes, after ReadHeader.
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	std::string errorMessage;
+
+private:
+	enum PixelType { PIXEL_BGRA, PIXEL_BGR, PIXEL_GRAY, PIXEL_MAPPED };
+
+	bool Fill();
+	bool ReadBytes(unsigned char* destination, size_t count);
+	bool ReadPixels(unsigned char* destination, size_t count);
+	bool ReadRunLengthRow(unsigned char* row);
+	bool ReadColorMap(size_t first, size_t count, int entryBits);
+	void ConvertPixels(const unsigned char* source, unsigned char* destination, size_t count) const;
+	bool Fail(const std::string& message);
+
+	std::istream* m_stream = 0;
+	std::vector<unsigned char> m_chunk;
+	size_t m_position = 0;	// Unread bytes of the chunk are [m_position, m_end).
+	size_t m_end = 0;
+
+	int m_width = 0;
+	int m_height = 0;
+	PixelType m_pixelType = PIXEL_BGRA;
+	size_t m_pixelSize = 4;
+	bool m_runLength = false;
+	bool m_topDown = false;
+	bool m_rightToLeft = false;
+	bool m_headerRead = false;
+	uint32_t m_palette[256]{};	// RGBA, indexed by the pixel value.
+
+	// Run length packets may continue on the next row.
+	size_t m_packetRemaining = 0;
+	bool m_packetRepeat = false;
+	unsigned char m_packetPixel[4]{};
+};
@@ -0,0 +1,237 @@
+#include "testframework.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "assetloaderclass.hpp"
+
+namespace {
+	// An asset that counts how many of it are alive, so leaks and double frees show.
+	struct FakeAsset {
+		static std::atomic<int> alive;
+		int value;
+		std::thread::id uploadedOn;
+
+		FakeAsset(int value) : value(value) { alive++; }
+		~FakeAsset() { alive--; }
+	};
+	std::atomic<int> FakeAsset::alive{ 0 };
+
+	void Sleep(int milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+
+	AssetHandle<FakeAsset> LoadFake(AssetLoaderClass& loader, int value, FakeAsset* placeholder = 0, int milliseconds = 0) {
+		return loader.Load<FakeAsset>([value, milliseconds](std::string&) {
+			if (milliseconds) { Sleep(milliseconds); }
+			return new FakeAsset(value);
+		}, [](FakeAsset& asset, std::string&) {
+			asset.uploadedOn = std::this_thread::get_id();
+			return true;
+		}, placeholder);
+	}
+
+	// Sets its flag when the coroutine frame holding it goes away.
+	struct FrameGuard {
+		bool* destroyed;
+		~FrameGuard() { *destroyed = true; }
+	};
+
+	AssetTask AwaitBoth(AssetHandle<FakeAsset> first, AssetHandle<FakeAsset> second, int& sum, std::thread::id& resumedOn) {
+		FakeAsset* a = co_await first;
+		FakeAsset* b = co_await second;
+		sum = (a ? a->value : -1000) + (b ? b->value : -1000);
+		resumedOn = std::this_thread::get_id();
+	}
+
+	AssetTask AwaitChained(AssetLoaderClass& loader, AssetHandle<FakeAsset> first, int& result) {
+		// A load started from inside a resumed coroutine.
+		FakeAsset* a = co_await first;
+		FakeAsset* b = co_await LoadFake(loader, a->value * 10);
+		result = b->value;
+	}
+
+	AssetTask AwaitForever(AssetHandle<FakeAsset> handle, bool& destroyed, bool& resumed) {
+		FrameGuard guard{ &destroyed };
+		co_await handle;
+		resumed = true;
+	}
+}
+
+TEST(ThreadPoolSubmit) {
+	ThreadPoolClass pool(3);
+	CHECK(pool.isInitialized && pool.GetThreadCount() == 3);
+	CHECK(ThreadPoolClass().GetThreadCount() >= 1);
+
+	std::atomic<int> ran{ 0 };
+	std::mutex mutex;
+	std::condition_variable finished;
+	const int jobs = 1000;
+	for (int i = 0; i < jobs; i++) {
+		pool.Submit([&]() {
+			if (++ran == jobs) {
+				std::lock_guard<std::mutex> lock(mutex);
+				finished.notify_all();
+			}
+		});
+	}
+	std::unique_lock<std::mutex> lock(mutex);
+	CHECK(finished.wait_for(lock, std::chrono::seconds(10), [&] { return ran == jobs; }));
+}
+
+TEST(ParallelFor) {
+	ThreadPoolClass pool(4);
+	for (size_t count : { 0, 1, 3, 10000 }) {
+		std::vector<std::atomic<int>> runs(count);
+		pool.ParallelFor(count, [&](size_t i) { runs[i]++; });
+		bool once = true;
+		for (const auto& run : runs) { once = once && run == 1; }
+		CHECK(once);
+	}
+
+	// From inside a job of the same pool, with every worker busy in the outer loop.
+	ThreadPoolClass single(1);
+	std::atomic<int> inner{ 0 };
+	single.ParallelFor(4, [&](size_t) { single.ParallelFor(8, [&](size_t) { inner++; }); });
+	CHECK(inner == 32);
+}
+
+TEST(ThreadPoolShutdown) {
+	// Queued jobs are dropped, the running one finishes first.
+	std::atomic<bool> started{ false }, finished{ false };
+	std::atomic<int> dropped{ 0 };
+	{
+		ThreadPoolClass pool(1);
+		pool.Submit([&]() {
+			started = true;
+			Sleep(50);
+			finished = true;
+		});
+		for (int i = 0; i < 100; i++) { pool.Submit([&]() { dropped++; }); }
+		while (!started) { std::this_thread::yield(); }
+	}
+	CHECK(finished && dropped == 0);
+}
+
+TEST(LoadAndWait) {
+	FakeAsset placeholder(-1);
+	{
+		AssetLoaderClass loader(2);
+		CHECK(loader.isInitialized && loader.GetThreadCount() == 2);
+		AssetHandle<FakeAsset> handle = LoadFake(loader, 7, &placeholder, 20);
+		CHECK(handle.IsValid() && handle.IsLoading() && handle.Get() == &placeholder);
+		CHECK(loader.GetLoadingCount() == 1);
+
+		FakeAsset* asset = loader.Wait(handle);
+		CHECK(asset && asset->value == 7 && handle.IsReady() && handle.Get() == asset);
+		CHECK(asset->uploadedOn == std::this_thread::get_id());	// Uploads run on the main thread.
+		CHECK(loader.GetLoadingCount() == 0 && handle.GetError().empty());
+		CHECK(FakeAsset::alive == 2);
+	}
+	CHECK(FakeAsset::alive == 1);	// The loader owns what it loaded, the placeholder stays the caller's.
+
+	AssetHandle<FakeAsset> none;
+	CHECK(!none.IsValid() && !none.IsLoading() && none.Get() == 0 && none.GetError().empty());
+}
+
+TEST(Failures) {
+	AssetLoaderClass loader(2);
+	AssetHandle<FakeAsset> loadFails = loader.Load<FakeAsset>([](std::string& error) {
+		error = "missing.dds: could not read the file";
+		return (FakeAsset*)0;
+	}, 0);
+	AssetHandle<FakeAsset> silent = loader.Load<FakeAsset>([](std::string&) { return (FakeAsset*)0; }, 0);
+	AssetHandle<FakeAsset> uploadFails = loader.Load<FakeAsset>([](std::string&) { return new FakeAsset(1); }, [](FakeAsset&, std::string& error) {
+		error = "CreateTexture2D failed";
+		return false;
+	});
+	CHECK(loader.Wait(loadFails) == 0 && loadFails.IsFailed() && loadFails.GetError() == "missing.dds: could not read the file");
+	CHECK(loader.Wait(silent) == 0 && silent.GetError() == "the asset could not be loaded");
+	CHECK(loader.Wait(uploadFails) == 0 && uploadFails.GetError() == "CreateTexture2D failed" && uploadFails.Get() == 0);
+	CHECK(FakeAsset::alive == 0);	// What failed to upload is freed right away.
+}
+
+TEST(UpdateBudget) {
+	// Finished loads wait for Update, which takes no more than it is allowed a frame.
+	AssetLoaderClass loader(4);
+	std::vector<AssetHandle<FakeAsset>> handles;
+	for (int i = 0; i < 10; i++) { handles.push_back(LoadFake(loader, i)); }
+	Sleep(100);
+	CHECK(handles[0].IsLoading() && loader.GetLoadingCount() == 10);
+	CHECK(loader.Update(3) == 3 && loader.GetLoadingCount() == 7);
+	CHECK(loader.Update(0) == 0);
+	CHECK(loader.Update() == 7 && loader.GetLoadingCount() == 0);
+	bool ready = true;
+	for (int i = 0; i < 10; i++) { ready = ready && handles[i].IsReady() && handles[i].Get()->value == i; }
+	CHECK(ready);
+}
+
+TEST(BoundedUploadQueue) {
+	// With the main thread not taking any, workers stop once the queue is full instead of decoding everything.
+	std::atomic<int> loaded{ 0 };
+	AssetLoaderClass loader(4, 2);
+	std::vector<AssetHandle<FakeAsset>> handles;
+	for (int i = 0; i < 16; i++) {
+		handles.push_back(loader.Load<FakeAsset>([&loaded, i](std::string&) {
+			loaded++;
+			return new FakeAsset(i);
+		}, 0));
+	}
+	Sleep(100);
+	printf("  %d of 16 loaded with a queue of 2 and 4 workers\n", loaded.load());
+	CHECK(loaded == 2 + 4);	// Two queued, every worker holding one it could not queue.
+
+	size_t finished = 0;
+	while (finished < 16) { finished += loader.Update(1); }
+	CHECK(loaded == 16 && loader.GetLoadingCount() == 0);
+}
+
+TEST(Coroutines) {
+	AssetLoaderClass loader(2);
+	int sum = 0, chained = 0;
+	std::thread::id resumedOn;
+	AwaitBoth(LoadFake(loader, 3, 0, 10), LoadFake(loader, 4), sum, resumedOn);
+	AssetHandle<FakeAsset> first = LoadFake(loader, 5);
+	AwaitChained(loader, first, chained);
+	CHECK(sum == 0 && chained == 0);	// Suspended until Update finishes the loads.
+
+	while (loader.GetLoadingCount() > 0) {
+		loader.Update();
+		std::this_thread::yield();
+	}
+	CHECK(sum == 7 && resumedOn == std::this_thread::get_id());
+	CHECK(chained == 50);
+
+	// A ready handle does not suspend, a failed one yields 0.
+	AssetHandle<FakeAsset> failed = loader.Load<FakeAsset>([](std::string&) { return (FakeAsset*)0; }, 0);
+	loader.Wait(failed);
+	AwaitBoth(first, failed, sum, resumedOn);
+	CHECK(sum == 5 - 1000);
+}
+
+TEST(DestroyWhileWaiting) {
+	// Coroutines still waiting when the loader goes away are destroyed, not resumed.
+	bool destroyed = false, resumed = false;
+	{
+		AssetLoaderClass loader(1);
+		AwaitForever(LoadFake(loader, 1, 0, 20), destroyed, resumed);
+		CHECK(!destroyed);
+	}
+	CHECK(destroyed && !resumed && FakeAsset::alive == 0);
+}
+
+TEST(LoadBenchmark) {
+	// Loads that mostly wait on the disk, 2 ms each, one after another and then on the loader's threads.
+	const int loads = 48;
+	double serial = TestFramework::Benchmark("48 loads in turn", 1, [&]() {
+		for (int i = 0; i < loads; i++) {
+			Sleep(2);
+			delete new FakeAsset(i);
+		}
+	});
+	double pooled = TestFramework::Benchmark("48 loads on 4 threads", 1, [&]() {
+		AssetLoaderClass loader(4);
+		std::vector<AssetHandle<FakeAsset>> handles;
+		for (int i = 0; i < loads; i++) { handles.push_back(LoadFake(loader, i, 0, 2)); }
+		for (const auto& handle : handles) { loader.Wait(handle); }
+	});
+	printf("  %.1fx faster with the loader\n", serial / pooled);
+	CHECK(pooled < serial);
+}
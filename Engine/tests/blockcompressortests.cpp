@@ -0,0 +1,251 @@
+#include "testframework.hpp"
+#include "testimages.hpp"
+#include <math.h>
+#include <string.h>
+#include "blockcompressorclass.hpp"
+
+namespace {
+	const BlockFormat FORMATS[] = { BLOCK_FORMAT_BC1, BLOCK_FORMAT_BC3, BLOCK_FORMAT_BC5, BLOCK_FORMAT_BC7 };
+	const BlockQuality QUALITIES[] = { BLOCK_QUALITY_FAST, BLOCK_QUALITY_NORMAL, BLOCK_QUALITY_HIGH };
+	const char* const FORMAT_NAMES[] = { "BC1", "BC3", "BC5", "BC7" };
+	const char* const QUALITY_NAMES[] = { "fast", "normal", "high" };
+
+	std::vector<unsigned char> RoundTrip(const std::vector<unsigned char>& pixels, int width, int height, BlockFormat format, BlockQuality quality) {
+		std::vector<unsigned char> blocks(BlockCompressorClass::GetLevelSize(format, width, height));
+		BlockCompressorClass::Encode(pixels.data(), width, height, blocks.data(), format, quality);
+		std::vector<unsigned char> decoded(pixels.size());
+		BlockCompressorClass::Decode(blocks.data(), width, height, decoded.data(), format);
+		return decoded;
+	}
+
+	// GetPsnr takes the first channels, so alpha is moved to the front to measure it alone.
+	double GetAlphaPsnr(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int width, int height) {
+		std::vector<unsigned char> alphaA(a.size()), alphaB(b.size());
+		for (size_t i = 0; i < a.size(); i += 4) { alphaA[i] = a[i + 3], alphaB[i] = b[i + 3]; }
+		return BlockCompressorClass::GetPsnr(alphaA.data(), alphaB.data(), width, height, 1);
+	}
+
+	// A photo with a cut-out alpha, holes of alpha 0 in a wave.
+	std::vector<unsigned char> MakeCutOut(int width, int height) {
+		std::vector<unsigned char> pixels = TestImages::MakePhoto(width, height, 4, 3);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				pixels[((size_t)y * width + x) * 4 + 3] = sin(x * 0.2) + cos(y * 0.15) > 0.5 ? 0 : 255;
+			}
+		}
+		return pixels;
+	}
+}
+
+TEST(Sizes) {
+	CHECK(BlockCompressorClass::GetBlockSize(BLOCK_FORMAT_BC1) == 8 && BlockCompressorClass::GetBlockSize(BLOCK_FORMAT_BC3) == 16);
+	CHECK(BlockCompressorClass::GetBlockSize(BLOCK_FORMAT_BC5) == 16 && BlockCompressorClass::GetBlockSize(BLOCK_FORMAT_BC7) == 16);
+	CHECK(BlockCompressorClass::GetRowPitch(BLOCK_FORMAT_BC1, 1) == 8 && BlockCompressorClass::GetRowPitch(BLOCK_FORMAT_BC1, 5) == 16);
+	CHECK(BlockCompressorClass::GetRowPitch(BLOCK_FORMAT_BC7, 256) == 64 * 16);
+	CHECK(BlockCompressorClass::GetLevelSize(BLOCK_FORMAT_BC1, 1, 1) == 8 && BlockCompressorClass::GetLevelSize(BLOCK_FORMAT_BC3, 13, 7) == 4 * 2 * 16);
+	CHECK(BlockCompressorClass::GetLevelSize(BLOCK_FORMAT_BC7, 4096, 4096) == (size_t)4096 * 4096);
+
+	const unsigned char a[8] = { 10, 20, 30, 40, 50, 60, 70, 80 };
+	const unsigned char b[8] = { 11, 20, 30, 40, 50, 60, 70, 0 };
+	CHECK(isinf(BlockCompressorClass::GetPsnr(a, a, 2, 1, 4)));
+	CHECK(isinf(BlockCompressorClass::GetPsnr(a, b, 2, 1, 3)) == false);
+	CHECK_NEAR(BlockCompressorClass::GetPsnr(a, b, 2, 1, 3), 10.0 * log10(255.0 * 255.0 * 6.0), 1e-9);
+	CHECK(isinf(BlockCompressorClass::GetPsnr(a + 4, b + 4, 1, 1, 3)));
+}
+
+TEST(DecodesReferenceBlocks) {
+	// Blocks written by hand from the format descriptions, so the decoder is not only checked against the encoder.
+	unsigned char pixels[16 * 4];
+	const unsigned char bc1[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };	// Red and blue, indices 0 1 2 3 in each row.
+	BlockCompressorClass::Decode(bc1, 4, 4, pixels, BLOCK_FORMAT_BC1);
+	const unsigned char fourColors[4][4] = { { 255, 0, 0, 255 }, { 0, 0, 255, 255 }, { 170, 0, 85, 255 }, { 85, 0, 170, 255 } };
+	bool matches = true;
+	for (int i = 0; i < 16; i++) { matches = matches && memcmp(pixels + i * 4, fourColors[i % 4], 4) == 0; }
+	CHECK(matches);
+
+	const unsigned char threeColors[8] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 };	// color0 below color1.
+	BlockCompressorClass::Decode(threeColors, 4, 4, pixels, BLOCK_FORMAT_BC1);
+	const unsigned char expected[4][4] = { { 0, 0, 255, 255 }, { 255, 0, 0, 255 }, { 128, 0, 128, 255 }, { 0, 0, 0, 0 } };
+	matches = true;
+	for (int i = 0; i < 16; i++) { matches = matches && memcmp(pixels + i * 4, expected[i % 4], 4) == 0; }
+	CHECK(matches);
+
+	// BC4 halves of BC5: eight values from 200 down to 100, and six from 40 up to 240 with 0 and 255.
+	unsigned char bc5[16] = { 200, 100 };
+	bc5[8] = 40, bc5[9] = 240;
+	uint64_t indices = 0;
+	for (int i = 0; i < 16; i++) { indices |= (uint64_t)(i % 8) << (i * 3); }
+	for (int i = 0; i < 6; i++) { bc5[2 + i] = bc5[10 + i] = (unsigned char)(indices >> (i * 8)); }
+	BlockCompressorClass::Decode(bc5, 4, 4, pixels, BLOCK_FORMAT_BC5);
+	double eight[8] = { 200, 100 }, six[8] = { 40, 240, 0, 0, 0, 0, 0, 255 };
+	for (int i = 2; i < 8; i++) { eight[i] = ((8 - i) * 200.0 + (i - 1) * 100.0) / 7.0; }
+	for (int i = 2; i < 6; i++) { six[i] = ((6 - i) * 40.0 + (i - 1) * 240.0) / 5.0; }
+	double largest = 0.0;
+	bool constant = true;
+	for (int i = 0; i < 16; i++) {
+		largest = std::max({ largest, fabs(pixels[i * 4] - eight[i % 8]), fabs(pixels[i * 4 + 1] - six[i % 8]) });
+		constant = constant && pixels[i * 4 + 2] == 0 && pixels[i * 4 + 3] == 255;
+	}
+	CHECK(largest < 1.0 && constant);
+
+	// BC7 mode 6: 7 bit endpoints with a p-bit each, then 4 bit indices with one bit less on the anchor texel 0.
+	TestImages::BitWriter writer;
+	writer.Write(1 << 6, 7);
+	const int endpoints[4][2] = { { 127, 0 }, { 64, 10 }, { 0, 127 }, { 127, 100 } };	// R, G, B, A.
+	for (const int* channel : endpoints) {
+		writer.Write(channel[0], 7);
+		writer.Write(channel[1], 7);
+	}
+	writer.Write(1, 1);
+	writer.Write(0, 1);
+	writer.Write(0, 3);
+	for (int i = 1; i < 16; i++) { writer.Write(i, 4); }
+	CHECK(writer.bytes.size() == 16 && writer.count == 0);
+	BlockCompressorClass::Decode((const unsigned char*)writer.bytes.data(), 4, 4, pixels, BLOCK_FORMAT_BC7);
+	const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	matches = true;
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 4; c++) {
+			int low = endpoints[c][0] << 1 | 1, high = endpoints[c][1] << 1;
+			matches = matches && pixels[i * 4 + c] == ((64 - weights[i]) * low + weights[i] * high + 32) >> 6;
+		}
+	}
+	CHECK(matches && pixels[0] == 255 && pixels[15 * 4 + 2] == 254);
+
+	const unsigned char reserved[16] = {};	// No mode bit at all.
+	BlockCompressorClass::Decode(reserved, 4, 4, pixels, BLOCK_FORMAT_BC7);
+	CHECK(pixels[0] == 0 && pixels[3] == 0 && pixels[63] == 0);
+}
+
+TEST(QualitySettings) {
+	// Every format at every preset, each preset at least as good as the faster one, in PSNR of the channels it keeps.
+	const int width = 128, height = 96;
+	std::vector<unsigned char> photo = TestImages::MakePhoto(width, height, 4, 1);
+	std::vector<unsigned char> cutOut = MakeCutOut(width, height);
+	const double floors[4] = { 33.0, 33.0, 38.0, 38.0 };
+	for (int f = 0; f < 4; f++) {
+		BlockFormat format = FORMATS[f];
+		const std::vector<unsigned char>& pixels = format == BLOCK_FORMAT_BC5 ? photo : cutOut;
+		int channels = format == BLOCK_FORMAT_BC5 ? 2 : 3;
+		double previous = 0.0;
+		for (int q = 0; q < 3; q++) {
+			std::vector<unsigned char> decoded = RoundTrip(pixels, width, height, format, QUALITIES[q]);
+			double psnr = format == BLOCK_FORMAT_BC1 ? 0.0 : BlockCompressorClass::GetPsnr(pixels.data(), decoded.data(), width, height, channels);
+			double alpha = format == BLOCK_FORMAT_BC5 ? INFINITY : GetAlphaPsnr(pixels, decoded, width, height);
+			if (format == BLOCK_FORMAT_BC1) {
+				// Transparent texels come back black, only the opaque ones say how well color was kept.
+				std::vector<unsigned char> opaque = pixels, opaqueDecoded = decoded;
+				for (size_t i = 0; i < opaque.size(); i += 4) {
+					if (opaque[i + 3] == 0) { memset(&opaque[i], 0, 3), memset(&opaqueDecoded[i], 0, 3); }
+				}
+				psnr = BlockCompressorClass::GetPsnr(opaque.data(), opaqueDecoded.data(), width, height, 3);
+			}
+			printf("  %s %-6s color %.2f dB, alpha %.2f dB\n", FORMAT_NAMES[f], QUALITY_NAMES[q], psnr, alpha);
+			CHECK(psnr >= floors[f] && psnr >= previous - 0.05);
+			// Cut-outs are kept exactly by the three color mode of BC1 and the 0 and 255 of BC4. BC7 fits alpha with the color
+			// and may round it, but never across the alpha test.
+			bool sameSide = true;
+			for (size_t i = 3; i < decoded.size(); i += 4) { sameSide = sameSide && (decoded[i] < 128) == (pixels[i] < 128); }
+			CHECK(format == BLOCK_FORMAT_BC7 ? sameSide && alpha > 50.0 : isinf(alpha));
+			previous = psnr;
+		}
+	}
+
+	// BC1 drops the color of transparent texels for transparent black.
+	std::vector<unsigned char> decoded = RoundTrip(cutOut, width, height, BLOCK_FORMAT_BC1, BLOCK_QUALITY_NORMAL);
+	bool black = true;
+	for (size_t i = 0; i < decoded.size(); i += 4) {
+		if (cutOut[i + 3] == 0) { black = black && decoded[i] == 0 && decoded[i + 1] == 0 && decoded[i + 2] == 0; }
+	}
+	CHECK(black);
+
+	// Smooth alpha is what BC3 and BC7 are for.
+	double bc3 = GetAlphaPsnr(photo, RoundTrip(photo, width, height, BLOCK_FORMAT_BC3, BLOCK_QUALITY_NORMAL), width, height);
+	double bc7 = GetAlphaPsnr(photo, RoundTrip(photo, width, height, BLOCK_FORMAT_BC7, BLOCK_QUALITY_NORMAL), width, height);
+	printf("  smooth alpha BC3 %.2f dB, BC7 %.2f dB\n", bc3, bc7);
+	CHECK(bc3 > 40.0 && bc7 > 40.0);
+
+	// Flat colors: any 565 color in BC1, and every byte through the single color tables within the rounding of the format.
+	for (int value = 0; value < 256; value += 5) {
+		std::vector<unsigned char> flat(4 * 4 * 4);
+		for (size_t i = 0; i < flat.size(); i += 4) { flat[i] = (unsigned char)value, flat[i + 1] = (unsigned char)(255 - value), flat[i + 2] = 77, flat[i + 3] = 255; }
+		for (BlockFormat format : FORMATS) {
+			std::vector<unsigned char> result = RoundTrip(flat, 4, 4, format, BLOCK_QUALITY_FAST);
+			int worst = 0;
+			for (int c = 0; c < (format == BLOCK_FORMAT_BC5 ? 2 : 4); c++) { worst = std::max(worst, abs(result[c] - flat[c])); }
+			CHECK(worst <= (format == BLOCK_FORMAT_BC1 || format == BLOCK_FORMAT_BC3 ? 3 : 1));
+			CHECK(memcmp(result.data(), result.data() + 4, result.size() - 4) == 0);
+		}
+	}
+}
+
+TEST(UnalignedSizes) {
+	// Edge blocks repeat the last row and column, decoding writes only the texels inside the image.
+	const int sizes[][2] = { { 1, 1 }, { 3, 5 }, { 6, 2 }, { 13, 7 }, { 33, 1 }, { 2, 30 } };
+	std::vector<unsigned char> photo = TestImages::MakePhoto(64, 64, 4, 4);	// Cropped to each size, opaque for BC1.
+	for (size_t i = 3; i < photo.size(); i += 4) { photo[i] = 255; }
+	for (const int* size : sizes) {
+		int width = size[0], height = size[1];
+		std::vector<unsigned char> pixels((size_t)width * height * 4);
+		for (int y = 0; y < height; y++) { memcpy(&pixels[(size_t)y * width * 4], &photo[(size_t)y * 64 * 4], (size_t)width * 4); }
+		for (BlockFormat format : FORMATS) {
+			std::vector<unsigned char> blocks(BlockCompressorClass::GetLevelSize(format, width, height) + 16, 0xCD);
+			BlockCompressorClass::Encode(pixels.data(), width, height, blocks.data(), format, BLOCK_QUALITY_NORMAL);
+			CHECK(blocks.back() == 0xCD);
+			std::vector<unsigned char> decoded(pixels.size() + 64, 0xCD);
+			BlockCompressorClass::Decode(blocks.data(), width, height, decoded.data(), format);
+			bool guarded = true;
+			for (size_t i = pixels.size(); i < decoded.size(); i++) { guarded = guarded && decoded[i] == 0xCD; }
+			CHECK(guarded);
+			int channels = format == BLOCK_FORMAT_BC5 ? 2 : 3;
+			CHECK(BlockCompressorClass::GetPsnr(pixels.data(), decoded.data(), width, height, channels) > 35.0);
+		}
+	}
+
+	// The one texel in the last block of a 5x5 image fills that block alone, so it is as exact as a flat block.
+	std::vector<unsigned char> pixels(5 * 5 * 4);
+	for (size_t i = 0; i < pixels.size(); i += 4) { pixels[i] = 20, pixels[i + 1] = 220, pixels[i + 2] = 40, pixels[i + 3] = 255; }
+	const unsigned char corner[4] = { 255, 0, 255, 128 };
+	memcpy(&pixels[(4 * 5 + 4) * 4], corner, 4);
+	std::vector<unsigned char> decoded = RoundTrip(pixels, 5, 5, BLOCK_FORMAT_BC7, BLOCK_QUALITY_FAST);
+	CHECK(memcmp(&decoded[(4 * 5 + 4) * 4], corner, 4) == 0);
+	CHECK(decoded[(4 * 5 + 3) * 4] == 20 && decoded[(3 * 5 + 4) * 4 + 1] == 220);
+}
+
+TEST(ParallelEncode) {
+	// Bands of block rows on a pool give the same bytes as one thread.
+	ThreadPoolClass pool(4);
+	const int width = 150, height = 290;
+	std::vector<unsigned char> pixels = MakeCutOut(width, height);
+	for (BlockFormat format : FORMATS) {
+		std::vector<unsigned char> serial(BlockCompressorClass::GetLevelSize(format, width, height)), parallel(serial.size());
+		BlockCompressorClass::Encode(pixels.data(), width, height, serial.data(), format, BLOCK_QUALITY_NORMAL);
+		BlockCompressorClass::Encode(pixels.data(), width, height, parallel.data(), format, BLOCK_QUALITY_NORMAL, &pool);
+		CHECK(serial == parallel);
+	}
+}
+
+TEST(BlockBenchmark) {
+	const int width = 256, height = 256;
+	std::vector<unsigned char> pixels = TestImages::MakePhoto(width, height, 4, 8);
+	double blocks = (width / 4) * (height / 4);
+	ThreadPoolClass pool;
+	for (int f = 0; f < 4; f++) {
+		std::vector<unsigned char> output(BlockCompressorClass::GetLevelSize(FORMATS[f], width, height));
+		for (int q = 0; q < 3; q++) {
+			char name[64];
+			snprintf(name, sizeof(name), "%s %s encode 256x256", FORMAT_NAMES[f], QUALITY_NAMES[q]);
+			double serial = TestFramework::Benchmark(name, 1, [&]() {
+				BlockCompressorClass::Encode(pixels.data(), width, height, output.data(), FORMATS[f], QUALITIES[q]);
+			});
+			snprintf(name, sizeof(name), "%s %s encode 256x256, pool", FORMAT_NAMES[f], QUALITY_NAMES[q]);
+			double pooled = TestFramework::Benchmark(name, 1, [&]() {
+				BlockCompressorClass::Encode(pixels.data(), width, height, output.data(), FORMATS[f], QUALITIES[q], &pool);
+			});
+			printf("  %.0f / %.0f blocks/s serial / pool\n", blocks / serial * 1000.0, blocks / pooled * 1000.0);
+		}
+		std::vector<unsigned char> decoded(pixels.size());
+		double decode = TestFramework::Benchmark(FORMAT_NAMES[f], 10, [&]() { BlockCompressorClass::Decode(output.data(), width, height, decoded.data(), FORMATS[f]); });
+		printf("  %s decode %.0f blocks/s\n", FORMAT_NAMES[f], blocks / decode * 1000.0);
+	}
+}
@@ -0,0 +1,237 @@
+#include "testframework.hpp"
+#include "testdevice.hpp"
+#include <string.h>
+#include <vector>
+#include "constantringclass.hpp"
+#include "renderstateclass.hpp"
+
+using namespace TestDevice;
+
+namespace {
+	// Constants no two allocations share, so one landing on another shows.
+	std::vector<unsigned char> MakeConstants(int seed, UINT size) {
+		std::vector<unsigned char> constants(size);
+		for (UINT i = 0; i < size; i++) { constants[i] = (unsigned char)(seed * 131 + i * 7 + 1); }
+		return constants;
+	}
+
+	// Where the allocation went, as the shader reads it: the window the offsets select out of what the last map left.
+	bool Holds(const ConstantAllocation& allocation, const std::vector<unsigned char>& constants) {
+		const FakeBuffer* buffer = static_cast<const FakeBuffer*>(allocation.buffer);
+		size_t offset = (size_t)allocation.firstConstant * 16;
+		if (offset + constants.size() > buffer->memory.size()) { return false; }
+		return memcmp(buffer->memory.data() + offset, constants.data(), constants.size()) == 0;
+	}
+
+	UINT Aligned(UINT size) { return (size + ConstantRingClass::ALIGNMENT - 1) / ConstantRingClass::ALIGNMENT * ConstantRingClass::ALIGNMENT; }
+}
+
+TEST(Layout) {
+	// A matrix, then members packed into the registers after it until one would straddle.
+	static_assert([] {
+		ConstantLayout layout;
+		return layout.Add(64, true) == 0 && layout.Add(12) == 64 && layout.Add(4) == 76 && layout.Add(8) == 80 && layout.Add(4) == 88
+			&& layout.Add(12) == 96 && layout.Add(8) == 112 && layout.Add(4) == 120 && layout.Size() == 128;
+	}());
+	// Arrays and structs start a register of their own even where the member before leaves room.
+	static_assert([] {
+		ConstantLayout layout;
+		return layout.Add(4) == 0 && layout.Add(32, true) == 16 && layout.Add(4) == 48 && layout.Size() == 64;
+	}());
+
+	ConstantLayout layout;
+	CHECK(layout.Size() == 0);
+	CHECK(layout.Add(4) == 0 && layout.Size() == 16);
+	CHECK(layout.Add(16) == 16 && layout.Size() == 32);	// A float4 after a float never shares its register.
+	CHECK(layout.Add(4, true) == 32 && layout.Add(4, true) == 48 && layout.Size() == 64);
+}
+
+TEST(Alignment) {
+	FakeDevice device;
+	FakeContext context;
+	{
+		// Rounded up to whole allocations, and never smaller than the largest of them.
+		ConstantRingClass small(&device, &context, 100);
+		CHECK(small.isInitialized && device.bufferDesc.ByteWidth == ConstantRingClass::MAX_ALLOCATION);
+	}
+	ConstantRingClass ring(&device, &context, 10000);
+	CHECK(ring.isInitialized && ring.IsOffsetting());
+	CHECK(device.bufferDesc.ByteWidth == 10240 && device.bufferDesc.Usage == D3D11_USAGE_DYNAMIC);
+	CHECK(device.bufferDesc.BindFlags == D3D11_BIND_CONSTANT_BUFFER && device.bufferDesc.CPUAccessFlags == D3D11_CPU_ACCESS_WRITE);
+
+	// Every offset and size is a multiple of 256 bytes, 16 constants, whatever the size of the constants.
+	const UINT sizes[] = { 16, 64, 255, 256, 257, 1000, 4096 };
+	std::vector<ConstantAllocation> allocations;
+	std::vector<std::vector<unsigned char>> constants;
+	UINT expected = 0;
+	for (UINT size : sizes) {
+		constants.push_back(MakeConstants((int)allocations.size(), size));
+		ConstantAllocation allocation;
+		CHECK(ring.Write(constants.back().data(), size, allocation));
+		CHECK(allocation.firstConstant * 16 == expected && allocation.firstConstant % 16 == 0);
+		CHECK(allocation.constantCount * 16 == Aligned(size) && allocation.constantCount % 16 == 0);
+		allocations.push_back(allocation);
+		expected += Aligned(size);
+	}
+	// One discard for the first, the rest followed it without touching what came before.
+	CHECK(context.discards == 1 && context.noOverwrites == 6 && context.invalidMaps == 0 && context.Count("Unmap") == 7);
+	for (size_t i = 0; i < allocations.size(); i++) { CHECK(allocations[i].buffer == allocations[0].buffer && Holds(allocations[i], constants[i])); }
+	CHECK(ring.GetStats().allocations == 7 && ring.GetStats().wraps == 1 && ring.GetStats().bytes == expected);
+
+	// Nothing larger than one allocation, and nothing empty, reaches the context.
+	ConstantAllocation rejected;
+	std::vector<unsigned char> large(ConstantRingClass::MAX_ALLOCATION + 1);
+	CHECK(!ring.Write(large.data(), (UINT)large.size(), rejected));
+	CHECK(!ring.Write(large.data(), 0, rejected));
+	CHECK(rejected.buffer == 0 && context.Count("Map") == 7 && ring.GetStats().allocations == 7);
+
+	// The typed write takes the size of the mirror.
+	struct Object { float world[16]; float scaleBias[4]; } object{};
+	ConstantAllocation typed;
+	CHECK(ring.Write(object, typed) && typed.firstConstant * 16 == expected && typed.constantCount == 16);
+}
+
+TEST(WrapAround) {
+	FakeDevice device;
+	{
+		// An allocation that ends exactly at the end still fits, the next one starts over.
+		FakeContext context;
+		ConstantRingClass ring(&device, &context, 4096);
+		ConstantAllocation allocation;
+		std::vector<unsigned char> constants = MakeConstants(0, 200);
+		for (int i = 0; i < 16; i++) { CHECK(ring.Write(constants.data(), 200, allocation) && allocation.firstConstant == (UINT)i * 16); }
+		CHECK(context.discards == 1 && context.noOverwrites == 15);
+		CHECK(ring.Write(constants.data(), 200, allocation) && allocation.firstConstant == 0 && context.discards == 2);
+	}
+
+	// Sizes that do not divide the ring: every allocation follows the last until the next would cross the end, and
+	// everything written since the last discard is still what the draws that bound it read.
+	FakeContext context;
+	const UINT size = 16384;
+	ConstantRingClass ring(&device, &context, size);
+	struct Live { ConstantAllocation allocation; std::vector<unsigned char> constants; };
+	std::vector<Live> live;
+	UINT head = 0;
+	size_t wraps = 0;
+	int intact = 0;
+	const int writes = 2000;
+	for (int i = 0; i < writes; i++) {
+		UINT bytes = (UINT)(i * 389 % 1500) + 1;
+		Live next;
+		next.constants = MakeConstants(i, bytes);
+		bool wrap = i == 0 || head + Aligned(bytes) > size;
+		int discards = context.discards;
+		CHECK(ring.Write(next.constants.data(), bytes, next.allocation));
+		CHECK((context.discards != discards) == wrap);
+		if (wrap) {
+			live.clear();
+			head = 0;
+			wraps++;
+		}
+		CHECK(next.allocation.firstConstant * 16 == head);
+		CHECK(next.allocation.firstConstant * 16 + next.allocation.constantCount * 16 <= size);
+		head += Aligned(bytes);
+		live.push_back(next);
+		bool all = true;
+		for (const Live& earlier : live) { all = all && Holds(earlier.allocation, earlier.constants); }
+		intact += all ? 1 : 0;
+	}
+	const ConstantRingStats& stats = ring.GetStats();
+	printf("  %d writes into %u bytes: %zu wraps, %.1f allocations between them\n", writes, size, stats.wraps, (double)writes / stats.wraps);
+	CHECK(intact == writes);
+	CHECK(stats.allocations == (size_t)writes && stats.wraps == wraps && stats.wraps == (size_t)context.discards);
+	CHECK(context.discards + context.noOverwrites == writes && context.invalidMaps == 0);
+
+	// A failed map leaves nothing known about the buffer, the next write discards it.
+	ConstantAllocation allocation;
+	std::vector<unsigned char> constants = MakeConstants(1, 64);
+	CHECK(ring.Write(constants.data(), 64, allocation) && allocation.firstConstant != 0);
+	context.failMaps = true;
+	CHECK(!ring.Write(constants.data(), 64, allocation));
+	context.failMaps = false;
+	int discards = context.discards;
+	CHECK(ring.Write(constants.data(), 64, allocation) && allocation.firstConstant == 0 && context.discards == discards + 1);
+	CHECK(Holds(allocation, constants) && ring.GetStats().allocations == (size_t)writes + 2);
+}
+
+TEST(Fallback) {
+	// The 11.0 runtime fails the options query, an 11.1 driver may lack either half of what offsets need.
+	for (int device11 = 0; device11 < 3; device11++) {
+		FakeDevice device;
+		device.runtime11_1 = device11 != 0;
+		device.constantBufferOffsetting = device11 != 1;
+		device.mapNoOverwriteOnDynamicConstantBuffer = device11 != 2;
+		FakeContext context(device11 != 0);
+		ConstantRingClass ring(&device, &context, 1u << 20);
+		CHECK(ring.isInitialized && !ring.IsOffsetting() && device.bufferDesc.ByteWidth == ConstantRingClass::MAX_ALLOCATION);
+
+		// Every allocation discards and is the whole buffer.
+		for (int i = 0; i < 10; i++) {
+			std::vector<unsigned char> constants = MakeConstants(i, 64 + i * 300);
+			ConstantAllocation allocation;
+			CHECK(ring.Write(constants.data(), (UINT)constants.size(), allocation));
+			CHECK(allocation.firstConstant == 0 && allocation.constantCount == 0 && Holds(allocation, constants));
+		}
+		CHECK(context.discards == 10 && context.noOverwrites == 0 && context.invalidMaps == 0 && ring.GetStats().wraps == 10);
+	}
+
+	// Through the render state each draw binds its window on 11.1. Without it the draws bind the same whole buffer,
+	// which the discards rename under the binding, so only the first reaches the context.
+	for (int context11 = 0; context11 < 2; context11++) {
+		FakeDevice device;
+		device.runtime11_1 = context11 != 0;
+		FakeContext context(context11 != 0);
+		ConstantRingClass ring(&device, &context, 1u << 16);
+		RenderStateClass states(&context);
+		for (int i = 0; i < 20; i++) {
+			std::vector<unsigned char> constants = MakeConstants(i, 112);
+			ConstantAllocation allocation;
+			CHECK(ring.Write(constants.data(), (UINT)constants.size(), allocation));
+			states.SetVertexConstantBuffer(2, allocation.buffer, allocation.firstConstant, allocation.constantCount);
+			CHECK(context.firstConstant == allocation.firstConstant && context.constantCount == allocation.constantCount);
+			states.DrawIndexed(36, 0, 0);
+			CHECK(Holds(allocation, constants));
+		}
+		CHECK(context.Count("VSSetConstantBuffers1") == (context11 ? 20 : 0) && context.Count("VSSetConstantBuffers") == (context11 ? 0 : 1));
+		CHECK(context.discards == (context11 ? 1 : 20));
+	}
+}
+
+TEST(Lifetime) {
+	int live = liveObjects;
+	{
+		FakeDevice device;
+		FakeContext context;
+		ConstantRingClass ring(&device, &context, 1u << 16);
+		CHECK(liveObjects == live + 1);
+
+		device.refuse = true;
+		ConstantRingClass refused(&device, &context, 1u << 16);
+		CHECK(!refused.isInitialized && liveObjects == live + 1);
+	}
+	CHECK(liveObjects == live);
+}
+
+TEST(RingBenchmark) {
+	// The per object constants of a frame of 10000 objects, with the ring the application makes and without offsets.
+	const int objects = 10000;
+	struct Object { float world[16]; float positionScale[4]; float positionBias[4]; float texcoordScaleBias[4]; } object{};
+	for (int offsetting = 1; offsetting >= 0; offsetting--) {
+		FakeDevice device;
+		device.runtime11_1 = offsetting != 0;
+		FakeContext context(offsetting != 0);
+		ConstantRingClass ring(&device, &context, 4u << 20);
+		auto frame = [&]() {
+			ConstantAllocation allocation;
+			for (int i = 0; i < objects; i++) {
+				object.world[0] = (float)i;
+				ring.Write(object, allocation);
+			}
+		};
+		frame();
+		printf("  %d objects %s offsets: %d discards a frame, %zu bytes\n", objects, offsetting ? "with" : "without", context.discards,
+			ring.GetStats().bytes);
+		CHECK(context.discards == (offsetting ? 1 : objects) && ring.GetStats().bytes == (size_t)objects * 256);
+		TestFramework::Benchmark(offsetting ? "10000 object constants through the ring" : "10000 object constants discarding", 5, frame);
+	}
+}
@@ -0,0 +1,428 @@
+#include "testframework.hpp"
+#include <math.h>
+#include <string.h>
+#include <fstream>
+#include <random>
+#include "hdrdecoderclass.hpp"
+#include "imageconverterclass.hpp"
+#include "texturecookerclass.hpp"
+
+namespace {
+	enum HdrEncoding { HDR_FLAT, HDR_OLD_RUNS, HDR_RUNS };
+
+	std::string WriteFile(const char* name, const std::string& contents) {
+		std::string filename = TestFramework::GetTempFilename(name);
+		std::ofstream(filename, std::ios::binary) << contents;
+		return filename;
+	}
+
+	// What Radiance stores for a value: the largest channel's mantissa in [128, 256) over a shared exponent.
+	void ToRgbe(const float* rgb, unsigned char* rgbe) {
+		float largest = std::max(std::max(rgb[0], rgb[1]), rgb[2]);
+		if (largest < 1e-32f) {
+			memset(rgbe, 0, 4);
+			return;
+		}
+		int exponent = 0;
+		float scale = frexpf(largest, &exponent) * 256.0f / largest;
+		for (int channel = 0; channel < 3; channel++) { rgbe[channel] = (unsigned char)std::min(255.0f, std::max(0.0f, rgb[channel]) * scale); }
+		rgbe[3] = (unsigned char)(exponent + 128);
+	}
+
+	// What the decoder should give back for a pixel, the middle of the mantissa's step.
+	void FromRgbe(const unsigned char* rgbe, float* rgba) {
+		for (int channel = 0; channel < 3; channel++) { rgba[channel] = rgbe[3] ? (float)ldexp(rgbe[channel] + 0.5, rgbe[3] - 136) : 0.0f; }
+		rgba[3] = 1.0f;
+	}
+
+	// pixels holds RGBE rows top down, bottomUp stores them the other way round.
+	std::string ToHdr(const std::vector<unsigned char>& pixels, int width, int height, HdrEncoding encoding, bool bottomUp = false) {
+		std::string file = "#?RADIANCE\n# made by the tests\nFORMAT=32-bit_rle_rgbe\nEXPOSURE=1.0\n\n";
+		file += (bottomUp ? "+Y " : "-Y ") + std::to_string(height) + " +X " + std::to_string(width) + "\n";
+		for (int y = 0; y < height; y++) {
+			const unsigned char* row = pixels.data() + (size_t)(bottomUp ? height - 1 - y : y) * width * 4;
+			// Run length scanlines are only for widths that can tell them apart from flat ones.
+			if (encoding == HDR_RUNS && width >= 8 && width <= 0x7FFF) {
+				file += { 2, 2, (char)(width >> 8), (char)(width & 0xFF) };
+				for (int channel = 0; channel < 4; channel++) {
+					int x = 0;
+					while (x < width) {
+						int run = 1;
+						while (x + run < width && run < 127 && row[(x + run) * 4 + channel] == row[x * 4 + channel]) { run++; }
+						if (run >= 3) {
+							file += { (char)(128 + run), (char)row[x * 4 + channel] };
+							x += run;
+							continue;
+						}
+						// Literals up to the next run of three.
+						int count = 0;
+						while (x + count < width && count < 128) {
+							int next = x + count;
+							if (next + 2 < width && row[next * 4 + channel] == row[(next + 1) * 4 + channel] &&
+								row[next * 4 + channel] == row[(next + 2) * 4 + channel]) { break; }
+							count++;
+						}
+						file += (char)count;
+						for (int i = 0; i < count; i++) { file += (char)row[(x + i) * 4 + channel]; }
+						x += count;
+					}
+				}
+				continue;
+			}
+			for (int x = 0; x < width; x++) {
+				// Old style runs repeat the pixel before with 1, 1, 1, count, a second repeat in a row would count 256 times as
+				// much. The widths here stay under 256, so one always covers the run.
+				int run = 0;
+				while (encoding == HDR_OLD_RUNS && x > 0 && x + run < width && run < 255 && !memcmp(row + (x + run) * 4, row + (x - 1) * 4, 4)) { run++; }
+				if (run >= 2) {
+					file += { 1, 1, 1, (char)run };
+					x += run - 1;
+					continue;
+				}
+				file.append((const char*)row + x * 4, 4);
+			}
+		}
+		return file;
+	}
+
+	// Smooth random colors with flat stretches, so every encoding has runs to use.
+	std::vector<unsigned char> MakeRgbe(int width, int height, unsigned seed) {
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> mantissa(0, 255), exponent(100, 150), stretch(0, 3);
+		std::vector<unsigned char> pixels((size_t)width * height * 4);
+		for (size_t i = 0; i < pixels.size(); i += 4) {
+			if (i > 0 && stretch(random) != 0) {
+				memcpy(&pixels[i], &pixels[i - 4], 4);
+				continue;
+			}
+			for (int channel = 0; channel < 3; channel++) { pixels[i + channel] = (unsigned char)mantissa(random); }
+			pixels[i + mantissa(random) % 3] |= 0x80;
+			pixels[i + 3] = (unsigned char)exponent(random);
+		}
+		return pixels;
+	}
+
+	bool Decodes(const std::string& file, std::vector<float>& rgba, std::string& error) {
+		HdrDecoderClass decoder((const unsigned char*)file.data(), file.size());
+		bool result = decoder.ReadHeader();
+		if (result) {
+			rgba.assign((size_t)decoder.GetWidth() * decoder.GetHeight() * 4, 0.0f);
+			result = decoder.Decode(rgba.data());
+		}
+		error = decoder.errorMessage;
+		return result;
+	}
+
+	// A sky over a dark ground with a sun thousands of times brighter, linear floats.
+	std::vector<float> MakeSky(int width, int height) {
+		std::vector<float> sky((size_t)width * height * 4);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				float* texel = &sky[((size_t)y * width + x) * 4];
+				float up = 1.0f - (float)y / height;
+				float sun = expf(-((x - width * 0.7f) * (x - width * 0.7f) + (y - height * 0.2f) * (y - height * 0.2f)) / 4.0f) * 5000.0f;
+				texel[0] = up > 0.4f ? 0.3f * up + sun : 0.02f + 0.01f * (x % 3);
+				texel[1] = up > 0.4f ? 0.5f * up + sun * 0.9f : 0.015f;
+				texel[2] = up > 0.4f ? 1.2f * up + sun * 0.7f : 0.01f;
+				texel[3] = 1.0f;
+			}
+		}
+		return sky;
+	}
+
+	std::string SkyToHdr(const std::vector<float>& sky, int width, int height, std::vector<float>& stored) {
+		std::vector<unsigned char> rgbe((size_t)width * height * 4);
+		stored.resize(sky.size());
+		for (size_t i = 0; i < (size_t)width * height; i++) {
+			ToRgbe(&sky[i * 4], &rgbe[i * 4]);
+			FromRgbe(&rgbe[i * 4], &stored[i * 4]);
+		}
+		return ToHdr(rgbe, width, height, HDR_RUNS);
+	}
+}
+
+TEST(DecodeEncodings) {
+	// Every encoding and orientation gives back the same floats, down to the bit.
+	const int sizes[][2] = { { 37, 21 }, { 7, 3 }, { 1, 1 }, { 200, 2 } };
+	bool exact = true, decoded = true;
+	for (const auto& size : sizes) {
+		std::vector<unsigned char> pixels = MakeRgbe(size[0], size[1], (unsigned)size[0]);
+		std::vector<float> expected(pixels.size());
+		for (size_t i = 0; i < pixels.size(); i += 4) { FromRgbe(&pixels[i], &expected[i]); }
+		for (HdrEncoding encoding : { HDR_FLAT, HDR_OLD_RUNS, HDR_RUNS }) {
+			for (bool bottomUp : { false, true }) {
+				std::string file = ToHdr(pixels, size[0], size[1], encoding, bottomUp);
+				CHECK(HdrDecoderClass::IsHdr((const unsigned char*)file.data(), file.size()));
+				std::vector<float> rgba;
+				std::string error;
+				decoded = decoded && Decodes(file, rgba, error);
+				exact = exact && rgba == expected;
+			}
+		}
+	}
+	CHECK(decoded && exact);
+
+	// Zero exponents are black, CRLF line ends and other tools' signatures are fine.
+	std::string file = "#?RGBE\r\nFORMAT=32-bit_rle_rgbe\r\n\r\n-Y 1 +X 2\r\n";
+	file += std::string("\xFF\xFF\xFF\x00\x80\x40\x20\x81", 8);
+	std::vector<float> rgba;
+	std::string error;
+	CHECK(Decodes(file, rgba, error) && rgba.size() == 8);
+	CHECK(rgba[0] == 0.0f && rgba[3] == 1.0f && rgba[4] == 128.5f / 256.0f * 2.0f && rgba[5] == 64.5f / 128.0f && rgba[7] == 1.0f);
+}
+
+TEST(DecodeErrors) {
+	std::vector<unsigned char> pixels = MakeRgbe(16, 4, 3);
+	std::string good = ToHdr(pixels, 16, 4, HDR_RUNS);
+	size_t header = good.find("-Y 4 +X 16\n") + 11;
+	std::vector<float> rgba;
+	std::string error;
+	CHECK(Decodes(good, rgba, error) && error.empty());
+
+	auto fails = [&](const std::string& file) {
+		std::string message;
+		return !Decodes(file, rgba, message) && !message.empty();
+	};
+	CHECK(!HdrDecoderClass::IsHdr((const unsigned char*)"P6\n", 3) && fails("P6\n1 1\n255\n"));
+	CHECK(fails("#?RADIANCE\nFORMAT=32-bit_rle_xyze\n\n-Y 1 +X 1\n\x80\x80\x80\x80"));
+	CHECK(fails("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n"));	// No empty line.
+	CHECK(fails("#?RADIANCE\n\n"));
+	CHECK(fails("#?RADIANCE\n\n-Y 1 +X\n"));
+	CHECK(fails("#?RADIANCE\n\n+X 1 +Y 1\n\x80\x80\x80\x80"));	// Column major.
+	CHECK(fails("#?RADIANCE\n\n-Y 1 -X 1\n\x80\x80\x80\x80"));
+	CHECK(fails("#?RADIANCE\n\n-Y 0 +X 1\n"));
+	CHECK(fails("#?RADIANCE\n\n-Y 1 +X 16385\n"));
+	CHECK(fails("#?RADIANCE\n" + std::string(5000, 'x') + "\n\n-Y 1 +X 1\n\x80\x80\x80\x80"));
+	CHECK(fails("#?RADIANCE\n\n-Y 1 +X 2\n\x01\x01\x01\x01\x80\x80\x80\x80"));	// A repeat with nothing before it.
+	CHECK(fails("#?RADIANCE\n\n-Y 1 +X 2\n\x80\x80\x80\x80\x01\x01\x01\x02"));	// One past the end.
+	for (size_t size = header; size < good.size(); size += 7) { CHECK(fails(good.substr(0, size))); }
+
+	// Run length data that does not add up to the scanline.
+	std::string wrongWidth = good;
+	wrongWidth[header + 3] = 15;
+	CHECK(fails(wrongWidth));
+	std::string longRun = good.substr(0, header) + std::string("\x02\x02\x00\x10\x91\x80", 6) + good.substr(header + 4);
+	CHECK(fails(longRun));
+	std::string longLiterals = good.substr(0, header) + std::string("\x02\x02\x00\x10\x11", 5) + std::string(17, '\x80');
+	CHECK(fails(longLiterals));
+	std::string emptyLiterals = good.substr(0, header) + std::string("\x02\x02\x00\x10\x00", 5) + good.substr(header + 4);
+	CHECK(fails(emptyLiterals));
+
+	HdrDecoderClass decoder((const unsigned char*)good.data(), good.size());
+	CHECK(!decoder.Decode(rgba.data()) && !decoder.errorMessage.empty());	// Before ReadHeader.
+
+	// Random damage after the header fails cleanly or decodes, and never reads or writes out of bounds.
+	std::mt19937 random(11);
+	for (int i = 0; i < 2000; i++) {
+		std::string damaged = good;
+		for (int k = 0; k < 4; k++) { damaged[header + random() % (damaged.size() - header)] = (char)random(); }
+		Decodes(damaged, rgba, error);
+	}
+}
+
+TEST(HalfAccuracy) {
+	// Every half other than NaN comes back from its float unchanged, in the vector loop and the loop after it.
+	std::vector<float> values(65536);
+	for (size_t h = 0; h < values.size(); h++) { values[h] = ImageConverterClass::HalfToFloat((uint16_t)h); }
+	std::vector<uint16_t> halves(values.size());
+	ImageConverterClass::FloatToHalf(values.data(), halves.data(), halves.size() - 1);
+	ImageConverterClass::FloatToHalf(values.data() + halves.size() - 1, halves.data() + halves.size() - 1, 1);
+	bool same = true, nan = true;
+	for (size_t h = 0; h < values.size(); h++) {
+		if (isnan(values[h])) { nan = nan && (halves[h] & 0x7C00) == 0x7C00 && (halves[h] & 0x3FF) != 0; }
+		else { same = same && halves[h] == h; }
+	}
+	CHECK(same && nan);
+	CHECK(ImageConverterClass::HalfToFloat(0x3C00) == 1.0f && ImageConverterClass::HalfToFloat(0x7BFF) == 65504.0f);
+	CHECK(ImageConverterClass::HalfToFloat(0x0001) == 5.9604645e-8f && ImageConverterClass::HalfToFloat(0x8000) == 0.0f);
+
+	// Random floats of either sign land on the nearest half, ties on the even one, out of range on infinity.
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> exponent(-27.0f, 17.0f);
+	std::vector<float> source(100003);
+	for (size_t i = 0; i < source.size(); i++) { source[i] = exp2f(exponent(random)) * (i & 1 ? -1.0f : 1.0f); }
+	source[0] = 1.0f + 1.0f / 2048.0f;
+	source[1] = 65520.0f;
+	source[2] = INFINITY;
+	halves.resize(source.size());
+	ImageConverterClass::FloatToHalf(source.data(), halves.data(), source.size());
+	bool nearest = true;
+	double worst = 0.0;
+	for (size_t i = 0; i < source.size(); i++) {
+		uint16_t h = halves[i];
+		if ((h & 0x7FFF) >= 0x7C00) {
+			nearest = nearest && (h & 0x7FFF) == 0x7C00 && fabsf(source[i]) >= 65520.0f;
+			continue;
+		}
+		double error = fabs((double)ImageConverterClass::HalfToFloat(h) - source[i]);
+		if (fabsf(source[i]) >= 6.1035156e-5f) { worst = std::max(worst, error / fabsf(source[i])); }
+		for (int step : { -1, 1 }) {
+			int other = (h & 0x7FFF) + step;
+			if (other < 0 || other > 0x7BFF) { continue; }
+			double otherError = fabs((double)ImageConverterClass::HalfToFloat((uint16_t)(other | (h & 0x8000))) - source[i]);
+			nearest = nearest && (error < otherError || (error == otherError && (h & 1) == 0));
+		}
+	}
+	CHECK(nearest && halves[0] == 0x3C00 && halves[1] == 0x7C00 && halves[2] == 0x7C00);
+	CHECK(worst <= 1.0 / 2048.0);
+	printf("  halves: worst relative error %.2e of normal values (bound 2^-11 = %.2e)\n", worst, 1.0 / 2048.0);
+}
+
+TEST(Rgb9e5Accuracy) {
+	// Packed values with a normalized largest mantissa, or the smallest exponent, are what the encoder writes, and
+	// come back from their floats unchanged.
+	std::mt19937 random(9);
+	std::vector<uint32_t> packed(4099);
+	for (uint32_t& value : packed) {
+		uint32_t exponent = (uint32_t)random() % 32, mantissas[3] = { (uint32_t)random() % 512, (uint32_t)random() % 512, (uint32_t)random() % 512 };
+		if (exponent > 0) { mantissas[random() % 3] |= 256; }
+		value = exponent << 27 | mantissas[2] << 18 | mantissas[1] << 9 | mantissas[0];
+	}
+	std::vector<float> rgba(packed.size() * 4, 1.0f);
+	for (size_t i = 0; i < packed.size(); i++) { ImageConverterClass::Rgb9e5ToFloat(packed[i], &rgba[i * 4]); }
+	std::vector<uint32_t> repacked(packed.size());
+	ImageConverterClass::FloatToRgb9e5(rgba.data(), repacked.data(), packed.size());
+	CHECK(repacked == packed);
+
+	// Random colors within the range: every channel is off by at most half a step of the largest one's mantissa.
+	std::uniform_real_distribution<float> exponent(-14.0f, 15.9f), ratio(0.0f, 1.0f);
+	std::vector<float> source(50001 * 4);
+	for (size_t i = 0; i < source.size(); i += 4) {
+		float largest = exp2f(exponent(random));
+		for (int channel = 0; channel < 3; channel++) { source[i + channel] = largest * (channel == (int)(i / 4 % 3) ? 1.0f : ratio(random)); }
+		source[i + 3] = ratio(random);
+	}
+	packed.resize(source.size() / 4);
+	ImageConverterClass::FloatToRgb9e5(source.data(), packed.data(), packed.size());
+	double worst = 0.0, sum = 0.0;
+	for (size_t i = 0; i < packed.size(); i++) {
+		float decoded[3];
+		ImageConverterClass::Rgb9e5ToFloat(packed[i], decoded);
+		float largest = std::max(std::max(source[i * 4], source[i * 4 + 1]), source[i * 4 + 2]);
+		for (int channel = 0; channel < 3; channel++) {
+			double error = fabs(decoded[channel] - source[i * 4 + channel]) / largest;
+			worst = std::max(worst, error);
+			sum += error * error;
+		}
+	}
+	CHECK(worst <= 1.0 / 512.0);
+	printf("  RGB9E5: worst error %.2e of the largest channel (bound 2^-9 = %.2e), RMS %.2e\n", worst, 1.0 / 512.0, sqrt(sum / (packed.size() * 3)));
+
+	// Out of range values clamp: negatives and NaNs to zero, anything too bright to the largest value.
+	const float edges[] = { -1.0f, NAN, 1.0f, 0.0f, INFINITY, 1e6f, 2.0f, 0.0f, 0.0f, 1e-9f, 0.0f, 0.0f, 511.9f, 1.0f, 0.0f, 0.0f };
+	uint32_t edgePacked[4];
+	ImageConverterClass::FloatToRgb9e5(edges, edgePacked, 4);
+	float decoded[4][3];
+	for (int i = 0; i < 4; i++) { ImageConverterClass::Rgb9e5ToFloat(edgePacked[i], decoded[i]); }
+	CHECK(decoded[0][0] == 0.0f && decoded[0][1] == 0.0f && decoded[0][2] == 1.0f);
+	CHECK(decoded[1][0] == 65408.0f && decoded[1][1] == 65408.0f && decoded[1][2] == 0.0f);	// 2 is under half a step of 128.
+	CHECK(edgePacked[2] == 0);
+	CHECK(decoded[3][0] == 512.0f && decoded[3][1] == 2.0f);	// The mantissa rounds up to 512 and takes the next exponent.
+	uint32_t single;
+	ImageConverterClass::FloatToRgb9e5(edges + 12, &single, 1);
+	CHECK(single == edgePacked[3]);
+}
+
+TEST(CookHdr) {
+	// The sky cooked both ways: formats, sizes, memory per texel and error, and a box chain that keeps the mean. Odd sizes
+	// drop their last row or column the way GenerateMips does, so only a power of two keeps it exactly.
+	const int width = 128, height = 64;
+	std::vector<float> stored;
+	std::string filename = WriteFile("sky.hdr", SkyToHdr(MakeSky(width, height), width, height, stored));
+	double mean[3] = {};
+	for (size_t i = 0; i < stored.size(); i += 4) {
+		for (int channel = 0; channel < 3; channel++) { mean[channel] += stored[i + channel] / (width * height); }
+	}
+
+	double errors[2] = {};
+	for (TextureHdrFormat format : { TEXTURE_HDR_RGB9E5, TEXTURE_HDR_HALF }) {
+		TextureCookSettings settings;
+		settings.hdrFormat = format;
+		settings.compression = TEXTURE_COMPRESSION_BC7;	// Ignored, as is srgb.
+		settings.measureQuality = true;
+		CookedTexture cooked;
+		TextureCookReport report;
+		CHECK(TextureCookerClass::Cook(filename.c_str(), settings, cooked, report) && report.error.empty());
+		bool half = format == TEXTURE_HDR_HALF;
+		size_t chainTexels = MipGeneratorClass::GetChainSize(width, height) / 4;
+		CHECK(cooked.format == (half ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R9G9B9E5_SHAREDEXP) && report.format == cooked.format);
+		CHECK(cooked.width == width && cooked.height == height && cooked.mipLevels == 8 && cooked.levels.size() == 8);
+		CHECK(report.bitsPerTexel == (half ? 64.0 : 32.0) && report.cookedBytes == chainTexels * (half ? 8 : 4));
+		CHECK(report.uncompressedBytes == chainTexels * 16 && cooked.data.size() == report.cookedBytes);
+		CHECK(cooked.levels[7].width == 1 && cooked.levels[7].height == 1 && cooked.levels[7].offset + cooked.levels[7].size == cooked.data.size());
+
+		// Level 0 holds exactly what the file does: an RGBE mantissa with the half step the decoder adds fits in 9 bits
+		// under the same exponent, and in the 11 of a half. The 1x1 level holds the mean.
+		bool level0 = true;
+		for (size_t i = 0; i < (size_t)width * height; i++) {
+			float decoded[3];
+			if (half) {
+				for (int channel = 0; channel < 3; channel++) { decoded[channel] = ImageConverterClass::HalfToFloat(((uint16_t*)cooked.data.data())[i * 4 + channel]); }
+			}
+			else { ImageConverterClass::Rgb9e5ToFloat(((uint32_t*)cooked.data.data())[i], decoded); }
+			for (int channel = 0; channel < 3; channel++) { level0 = level0 && decoded[channel] == stored[i * 4 + channel]; }
+		}
+		CHECK(level0);
+		float last[3];
+		const unsigned char* texel = cooked.data.data() + cooked.levels[7].offset;
+		if (half) {
+			for (int channel = 0; channel < 3; channel++) { last[channel] = ImageConverterClass::HalfToFloat(((const uint16_t*)texel)[channel]); }
+		}
+		else { ImageConverterClass::Rgb9e5ToFloat(*(const uint32_t*)texel, last); }
+		for (int channel = 0; channel < 3; channel++) { CHECK_NEAR(last[channel], mean[channel], mean[channel] * 0.01); }
+
+		errors[half] = report.hdrError;
+		printf("  %-7s %4.0f bits a texel, %6zu bytes for the chain (%zu as floats), RMS error %.2e of the brightest channel\n",
+			half ? "half" : "RGB9E5", report.bitsPerTexel, report.cookedBytes, report.uncompressedBytes, report.hdrError);
+	}
+	CHECK(errors[0] == 0.0 && errors[1] == 0.0);
+
+	// Only values near the bottom of the range lose anything, a night sky ten thousand times darker does.
+	std::vector<float> night = MakeSky(width, height);
+	for (float& value : night) { value *= 1e-4f; }
+	std::string nightFilename = WriteFile("night.hdr", SkyToHdr(night, width, height, stored));
+	for (TextureHdrFormat format : { TEXTURE_HDR_RGB9E5, TEXTURE_HDR_HALF }) {
+		TextureCookSettings settings;
+		settings.hdrFormat = format;
+		settings.measureQuality = true;
+		CookedTexture cooked;
+		TextureCookReport report;
+		CHECK(TextureCookerClass::Cook(nightFilename.c_str(), settings, cooked, report));
+		errors[format == TEXTURE_HDR_HALF] = report.hdrError;
+		printf("  %-7s night sky, RMS error %.2e of the brightest channel\n", format == TEXTURE_HDR_HALF ? "half" : "RGB9E5", report.hdrError);
+	}
+	CHECK(errors[0] > 0.0 && errors[0] < 0.01 && errors[1] > 0.0 && errors[1] <= errors[0]);
+
+	// Broken files fail with the decoder's message.
+	std::string broken = WriteFile("broken.hdr", "#?RADIANCE\nFORMAT=32-bit_rle_xyze\n\n-Y 1 +X 1\n\x80\x80\x80\x80");
+	CookedTexture cooked;
+	TextureCookReport report;
+	CHECK(!TextureCookerClass::Cook(broken.c_str(), TextureCookSettings(), cooked, report) && report.error.find("xyze") != std::string::npos);
+}
+
+TEST(HdrBenchmark) {
+	const int width = 2048, height = 1024;
+	std::vector<float> stored;
+	std::string file = SkyToHdr(MakeSky(width, height), width, height, stored);
+	std::vector<float> rgba((size_t)width * height * 4);
+	TestFramework::Benchmark("decode 2048x1024 run length HDR", 3, [&]() {
+		HdrDecoderClass decoder((const unsigned char*)file.data(), file.size());
+		CHECK(decoder.ReadHeader() && decoder.Decode(rgba.data()));
+	});
+	CHECK(rgba == stored);
+	std::vector<uint16_t> halves(rgba.size());
+	std::vector<uint32_t> packed(rgba.size() / 4);
+	TestFramework::Benchmark("2048x1024 to halves", 3, [&]() { ImageConverterClass::FloatToHalf(rgba.data(), halves.data(), rgba.size()); });
+	TestFramework::Benchmark("2048x1024 to RGB9E5", 3, [&]() { ImageConverterClass::FloatToRgb9e5(rgba.data(), packed.data(), packed.size()); });
+
+	std::string filename = WriteFile("bench.hdr", file);
+	for (TextureHdrFormat format : { TEXTURE_HDR_RGB9E5, TEXTURE_HDR_HALF }) {
+		TextureCookSettings settings;
+		settings.hdrFormat = format;
+		CookedTexture cooked;
+		TextureCookReport report;
+		TestFramework::Benchmark(format == TEXTURE_HDR_HALF ? "cook 2048x1024 HDR to halves" : "cook 2048x1024 HDR to RGB9E5", 1, [&]() {
+			CHECK(TextureCookerClass::Cook(filename.c_str(), settings, cooked, report));
+		});
+	}
+}
@@ -0,0 +1,137 @@
+#include "testframework.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "dependencygraphclass.hpp"
+#include "filewatcherclass.hpp"
+
+namespace {
+	void WriteFile(const std::filesystem::path& filename, const std::string& contents) { std::ofstream(filename, std::ios::binary) << contents; }
+
+	// Polls until something settles or the time is up.
+	std::vector<std::string> PollFor(FileWatcherClass& watcher, int milliseconds) {
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+		std::vector<std::string> files;
+		while (files.empty() && std::chrono::steady_clock::now() < end) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			files = watcher.Poll();
+		}
+		return files;
+	}
+
+	std::vector<std::string> Sorted(std::vector<std::string> strings) {
+		std::sort(strings.begin(), strings.end());
+		return strings;
+	}
+}
+
+TEST(Debounce) {
+	std::filesystem::path directory = TestFramework::GetTempFilename("watched");
+	std::filesystem::path elsewhere = TestFramework::GetTempFilename("unwatched");
+	std::filesystem::create_directories(directory);
+	std::filesystem::create_directories(elsewhere);
+	FileWatcherClass watcher;
+	CHECK(watcher.isInitialized);
+	CHECK(watcher.Watch(directory.string().c_str()) && watcher.Watch(directory.string().c_str()));
+	CHECK(!watcher.Watch((directory / "missing").string().c_str()));
+	std::string shader = PathTableClass::Normalize((directory / "light.ps").string().c_str());
+	std::string include = PathTableClass::Normalize((directory / "common.hlsli").string().c_str());
+
+	// An editor saving in several writes, each well inside the debounce time of the one before: one change, once
+	// the last write is DEBOUNCE_MILLISECONDS old.
+	std::chrono::steady_clock::time_point lastWrite;
+	for (int i = 0; i < 5; i++) {
+		WriteFile(elsewhere / "light.ps", "unwatched");
+		WriteFile(directory / "light.ps", "float4 main() : SV_TARGET { return " + std::to_string(i) + "; }\n");
+		lastWrite = std::chrono::steady_clock::now();	// Before the sleep, which a loaded machine may stretch.
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	std::vector<std::string> files = PollFor(watcher, 2000);
+	auto settled = std::chrono::steady_clock::now();
+	CHECK(files == std::vector<std::string>{ shader });
+	CHECK(settled - lastWrite >= std::chrono::milliseconds(FileWatcherClass::DEBOUNCE_MILLISECONDS - 20));
+	CHECK(PollFor(watcher, 3 * FileWatcherClass::DEBOUNCE_MILLISECONDS).empty());
+
+	// Two files written together settle together, each once, and a later write is a change of its own.
+	WriteFile(directory / "light.ps", "edited");
+	WriteFile(directory / "common.hlsli", "edited");
+	WriteFile(directory / "light.ps", "edited again");
+	files = PollFor(watcher, 2000);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	std::vector<std::string> rest = watcher.Poll();
+	files.insert(files.end(), rest.begin(), rest.end());
+	CHECK(Sorted(files) == Sorted({ shader, include }));
+	WriteFile(directory / "common.hlsli", "edited once more");
+	CHECK(PollFor(watcher, 2000) == std::vector<std::string>{ include });
+
+	// A short debounce hands the writes out sooner, still once.
+	FileWatcherClass quick(20);
+	CHECK(quick.Watch(elsewhere.string().c_str()));
+	for (int i = 0; i < 3; i++) { WriteFile(elsewhere / "texture.tga", std::string(64, (char)i)); }
+	CHECK(PollFor(quick, 2000).size() == 1 && PollFor(quick, 200).empty());
+}
+
+TEST(Dependents) {
+	PathTableClass paths;
+	AssetPath lightVs = paths.Intern("shaders/light.vs"), lightPs = paths.Intern("shaders/light.ps");
+	AssetPath colorVs = paths.Intern("shaders/color.vs"), colorPs = paths.Intern("shaders/color.ps");
+	AssetPath common = paths.Intern("shaders/common.hlsli"), model = paths.Intern("data/cube.txt");
+	DependencyGraphClass graph;
+	graph.SetDependencies(0, { lightVs, lightPs, common });
+	graph.SetDependencies(1, { colorVs, colorPs, common, common, AssetPath() });	// Repeats and invalid paths are dropped.
+	graph.SetDependencies(2, { model });
+
+	// Only the entries built from the edited file.
+	CHECK(graph.GetDependents(common) == std::vector<uint32_t>({ 0, 1 }));
+	CHECK(graph.GetDependents(lightPs) == std::vector<uint32_t>{ 0 });
+	CHECK(graph.GetDependents(colorVs) == std::vector<uint32_t>{ 1 });
+	CHECK(graph.GetDependents(model) == std::vector<uint32_t>{ 2 });
+	CHECK(graph.GetDependents(paths.Intern("shaders/texture.ps")).empty() && graph.GetDependents(AssetPath()).empty());
+
+	// A rebuild that lists other files replaces the entry's list.
+	AssetPath fog = paths.Intern("shaders/fog.hlsli");
+	graph.SetDependencies(0, { lightVs, lightPs, fog });
+	CHECK(graph.GetDependents(common) == std::vector<uint32_t>{ 1 } && graph.GetDependents(fog) == std::vector<uint32_t>{ 0 });
+	graph.Remove(1);
+	graph.Remove(7);
+	CHECK(graph.GetDependents(common).empty() && graph.GetDependents(colorPs).empty() && graph.GetDependents(lightVs) == std::vector<uint32_t>{ 0 });
+}
+
+TEST(ScanShaderIncludes) {
+	std::filesystem::path directory = TestFramework::GetTempFilename("shaders");
+	std::filesystem::create_directories(directory / "lights");
+	WriteFile(directory / "light.ps",
+		"#include \"common.hlsli\"\n"
+		"  #  include \"lights/lighting.hlsli\"\n"
+		"#include <system.hlsli>\n"
+		"// #include \"commented.hlsli\"\n"
+		"#if FOG\n#include \"fog.hlsli\"\n#endif\n"
+		"float4 LightPixelShader() : SV_TARGET { return Shade(); }\n");
+	WriteFile(directory / "common.hlsli", "#include \"missing.hlsli\"\n");
+	// Nested includes resolve against the file that includes them, a cycle back is followed once.
+	WriteFile(directory / "lights" / "lighting.hlsli", "#include \"brdf.hlsli\"\n#include \"../common.hlsli\"\n");
+	WriteFile(directory / "lights" / "brdf.hlsli", "#include \"lighting.hlsli\"\nfloat Brdf() { return 1; }\n");
+	WriteFile(directory / "fog.hlsli", "float Fog() { return 0; }\n");
+
+	auto normalized = [&](const char* name) { return PathTableClass::Normalize((directory / name).string().c_str()); };
+	std::vector<std::string> files = DependencyGraphClass::ScanShaderIncludes((directory / "light.ps").string().c_str());
+	CHECK(!files.empty() && files[0] == normalized("light.ps"));
+	// A missing include is listed too, creating it has to rebuild the shader.
+	CHECK(Sorted(files) == Sorted({ normalized("light.ps"), normalized("common.hlsli"), normalized("missing.hlsli"),
+		normalized("lights/lighting.hlsli"), normalized("lights/brdf.hlsli"), normalized("fog.hlsli") }));
+
+	// What a rebuild after an edit sees: the new include is listed, and the graph maps it to the shader.
+	WriteFile(directory / "fog.hlsli", "#include \"lights/noise.hlsli\"\nfloat Fog() { return 0; }\n");
+	std::vector<std::string> rescanned = DependencyGraphClass::ScanShaderIncludes((directory / "light.ps").string().c_str());
+	CHECK(rescanned.size() == files.size() + 1 && std::count(rescanned.begin(), rescanned.end(), normalized("lights/noise.hlsli")) == 1);
+	PathTableClass paths;
+	DependencyGraphClass graph;
+	std::vector<AssetPath> dependencies;
+	for (const std::string& file : rescanned) { dependencies.push_back(paths.Intern(file.c_str())); }
+	graph.SetDependencies(3, dependencies);
+	CHECK(graph.GetDependents(paths.Find(normalized("lights/noise.hlsli").c_str())) == std::vector<uint32_t>{ 3 });
+
+	CHECK(DependencyGraphClass::ScanShaderIncludes((directory / "absent.ps").string().c_str()).size() == 1);
+}
@@ -0,0 +1,408 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "gltfimporterclass.hpp"
+#include "objimporterclass.hpp"
+
+namespace {
+	std::string WriteFile(const char* name, const std::string& contents) {
+		std::string filename = TestFramework::GetTempFilename(name);
+		std::ofstream(filename, std::ios::binary) << contents;
+		return filename;
+	}
+
+	// The grids have power of two sides, so flipping v and z there and back is exact.
+	MeshData MakeTestMesh() {
+		return TestMeshes::MakeGrid(16);
+	}
+
+	// The mesh in OBJ's right handed, counter clockwise, bottom left UV convention, one v/vt/vn each.
+	std::string ToObj(const MeshData& mesh) {
+		std::string text = "# grid\nmtllib grid.mtl\no grid\n";
+		char line[256];
+		for (const MeshVertex& v : mesh.vertices) {
+			snprintf(line, sizeof(line), "v %.9g %.9g %.9g\nvt %.9g %.9g\nvn %.9g %.9g %.9g\n", v.Position()[0], v.Position()[1], -v.Position()[2],
+				v.Texcoord()[0], 1.0f - v.Texcoord()[1], v.Normal()[0], v.Normal()[1], -v.Normal()[2]);
+			text += line;
+		}
+		text += "usemtl default\ns 1\n";
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+			unsigned int a = mesh.indices[i] + 1, b = mesh.indices[i + 2] + 1, c = mesh.indices[i + 1] + 1;
+			snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+			text += line;
+		}
+		return text;
+	}
+
+	bool ImportObj(const std::string& text, MeshData& mesh, std::string& error) {
+		ObjImporterClass importer;
+		bool result = importer.Import(WriteFile("import.obj", text).c_str(), mesh);
+		error = importer.GetError();
+		return result;
+	}
+
+	std::string ObjError(const std::string& text) {
+		MeshData mesh;
+		std::string error;
+		if (ImportObj(text, mesh, error)) { return ""; }
+		return error.substr(error.find("import.obj") + strlen("import.obj"));
+	}
+
+	// A glTF document with one mesh under one node, its accessors packed into one buffer.
+	struct Gltf {
+		std::string json;
+		std::string bin;
+
+		// Appends the values as a buffer view and an accessor over it, returns the accessor's JSON.
+		std::string AddAccessor(const void* data, size_t size, size_t count, int componentType, const char* type, bool normalized = false) {
+			while (bin.size() % 4) { bin += '\0'; }
+			std::string accessor = "{\"bufferView\":" + std::to_string(views.size()) + ",\"count\":" + std::to_string(count) +
+				",\"componentType\":" + std::to_string(componentType) + ",\"type\":\"" + type + "\"" + (normalized ? ",\"normalized\":true" : "") + "}";
+			views.push_back("{\"buffer\":0,\"byteOffset\":" + std::to_string(bin.size()) + ",\"byteLength\":" + std::to_string(size) + "}");
+			bin.append((const char*)data, size);
+			accessors.push_back(accessor);
+			return std::to_string(accessors.size() - 1);
+		}
+
+		// The document around the accessors, primitive is the JSON of the one primitive and node that of its node.
+		void Finish(const std::string& primitive, const std::string& node, const char* uri) {
+			json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[" + node + "],";
+			json += "\"meshes\":[{\"primitives\":[" + primitive + "]}],\"accessors\":[" + Join(accessors) + "],";
+			json += "\"bufferViews\":[" + Join(views) + "],\"buffers\":[{" + (uri ? "\"uri\":\"" + std::string(uri) + "\"," : "") +
+				"\"byteLength\":" + std::to_string(bin.size()) + "}]}";
+		}
+
+		std::string ToGlb() const {
+			std::string padded = json;
+			while (padded.size() % 4) { padded += ' '; }
+			std::string paddedBin = bin;
+			while (paddedBin.size() % 4) { paddedBin += '\0'; }
+			uint32_t header[5] = { 0x46546C67, 2, (uint32_t)(12 + 8 + padded.size() + 8 + paddedBin.size()), (uint32_t)padded.size(), 0x4E4F534A };
+			uint32_t binHeader[2] = { (uint32_t)paddedBin.size(), 0x004E4942 };
+			return std::string((const char*)header, sizeof(header)) + padded + std::string((const char*)binHeader, sizeof(binHeader)) + paddedBin;
+		}
+
+		static std::string Join(const std::vector<std::string>& items) {
+			std::string result;
+			for (const std::string& item : items) { result += (result.empty() ? "" : ",") + item; }
+			return result;
+		}
+
+		std::vector<std::string> views;
+		std::vector<std::string> accessors;
+	};
+
+	// The mesh in glTF's right handed, counter clockwise convention with a primitive over float attributes and 32-bit
+	// indices. Leaving out the normals makes the importer shade it flat.
+	Gltf ToGltf(const MeshData& mesh, bool normals, const std::string& node = "{\"mesh\":0}", const char* uri = "import.bin") {
+		std::vector<float> positions, texcoords, directions;
+		for (const MeshVertex& v : mesh.vertices) {
+			positions.insert(positions.end(), { v.Position()[0], v.Position()[1], -v.Position()[2] });
+			texcoords.insert(texcoords.end(), { v.Texcoord()[0], v.Texcoord()[1] });
+			directions.insert(directions.end(), { v.Normal()[0], v.Normal()[1], -v.Normal()[2] });
+		}
+		std::vector<uint32_t> indices;
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) { indices.insert(indices.end(), { mesh.indices[i], mesh.indices[i + 2], mesh.indices[i + 1] }); }
+
+		Gltf gltf;
+		size_t count = mesh.vertices.size();
+		std::string primitive = "{\"attributes\":{\"POSITION\":" + gltf.AddAccessor(positions.data(), positions.size() * 4, count, 5126, "VEC3");
+		primitive += ",\"TEXCOORD_0\":" + gltf.AddAccessor(texcoords.data(), texcoords.size() * 4, count, 5126, "VEC2");
+		if (normals) { primitive += ",\"NORMAL\":" + gltf.AddAccessor(directions.data(), directions.size() * 4, count, 5126, "VEC3"); }
+		primitive += "},\"indices\":" + gltf.AddAccessor(indices.data(), indices.size() * 4, indices.size(), 5125, "SCALAR") + "}";
+		gltf.Finish(primitive, node, uri);
+		return gltf;
+	}
+
+	bool ImportGltf(const Gltf& gltf, bool binary, MeshData& mesh, std::string& error) {
+		std::string filename;
+		if (binary) { filename = WriteFile("import.glb", gltf.ToGlb()); }
+		else {
+			// The temporary names are numbered, the document points at the one the buffer got.
+			std::string json = gltf.json;
+			size_t uri = json.find("\"import.bin\"");
+			std::string bin = std::filesystem::path(WriteFile("import.bin", gltf.bin)).filename().string();
+			if (uri != std::string::npos) { json.replace(uri + 1, strlen("import.bin"), bin); }
+			filename = WriteFile("import.gltf", json);
+		}
+		GltfImporterClass importer;
+		bool result = importer.Import(filename.c_str(), mesh);
+		error = importer.GetError();
+		return result;
+	}
+
+	std::string GltfError(const Gltf& gltf, bool binary = false) {
+		MeshData mesh;
+		std::string error;
+		if (ImportGltf(gltf, binary, mesh, error)) { return ""; }
+		return error.substr(error.find(": ") + 2);
+	}
+
+	// The same triangles up to the rounding of the transforms the normals went through.
+	bool NearTriangles(const MeshData& a, const MeshData& b) {
+		std::vector<std::array<float, 24>> x = TestMeshes::GetTriangles(a), y = TestMeshes::GetTriangles(b);
+		if (x.size() != y.size()) { return false; }
+		for (size_t i = 0; i < x.size(); i++) {
+			for (int k = 0; k < 24; k++) {
+				if (fabsf(x[i][k] - y[i][k]) > 1e-6f) { return false; }
+			}
+		}
+		return true;
+	}
+
+	// The normal of every triangle agrees with its winding, (b - a) x (c - a) with the engine's clockwise fronts.
+	bool FlatNormalsMatchWinding(const MeshData& mesh) {
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+			const MeshVertex* v[3] = { &mesh.vertices[mesh.indices[i]], &mesh.vertices[mesh.indices[i + 1]], &mesh.vertices[mesh.indices[i + 2]] };
+			float ab[3], ac[3];
+			for (int k = 0; k < 3; k++) {
+				ab[k] = v[1]->Position()[k] - v[0]->Position()[k];
+				ac[k] = v[2]->Position()[k] - v[0]->Position()[k];
+			}
+			float n[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (int corner = 0; corner < 3; corner++) {
+				for (int k = 0; k < 3; k++) {
+					if (fabsf(v[corner]->Normal()[k] - n[k] / length) > 1e-5f) { return false; }
+				}
+			}
+		}
+		return true;
+	}
+}
+
+TEST(ObjRoundTrip) {
+	// Converted to OBJ's conventions and back, with every shared v/vt/vn triple one vertex again.
+	MeshData grid = MakeTestMesh();
+	MeshData mesh;
+	std::string error;
+	CHECK(ImportObj(ToObj(grid), mesh, error));
+	CHECK(mesh.vertices.size() == grid.vertices.size() && mesh.indices.size() == grid.indices.size());
+	CHECK(TestMeshes::GetTriangles(mesh) == TestMeshes::GetTriangles(grid));
+	CHECK(memcmp(mesh.bounds.minimum, grid.bounds.minimum, sizeof(float) * 3) == 0 && memcmp(mesh.bounds.maximum, grid.bounds.maximum, sizeof(float) * 3) == 0);
+}
+
+TEST(ObjFaces) {
+	// A quad and a pentagon fanned from their first corner, relative indices, optional w, comments and line endings.
+	std::string text =
+		"v 0 0 0 1\r\nv 1 0 0\nv 1 1 0\nv 0 1 0 # corner\nv 0.5 1.5 0\n"
+		"vt 0 0\nvt 1 0 0\nvt 1 1\nvt 0\n"
+		"vn 0 0 1\n"
+		"g quad\nf 1/1/1 2/2/1 3/3/1 4/4/1\n"
+		"\n\t\n"
+		"f -5//-1 -4//-1 -3//-1 -1//-1 -2//-1\r\n";
+	MeshData mesh;
+	std::string error;
+	CHECK(ImportObj(text, mesh, error));
+	CHECK(mesh.indices.size() == 15);	// 2 triangles for the quad, 3 for the pentagon.
+	CHECK(mesh.vertices.size() == 9);	// The pentagon's corners have no texture coordinates, new triples.
+
+	// The first corner, then the others in turn, reversed for the clockwise fronts. z and v flip.
+	const MeshVertex& first = mesh.vertices[mesh.indices[0]];
+	const MeshVertex& third = mesh.vertices[mesh.indices[1]];
+	const MeshVertex& second = mesh.vertices[mesh.indices[2]];
+	CHECK(first.Position()[0] == 0.0f && first.Position()[1] == 0.0f && first.Texcoord()[1] == 1.0f);
+	CHECK(third.Position()[0] == 1.0f && third.Position()[1] == 1.0f && third.Texcoord()[0] == 1.0f && third.Texcoord()[1] == 0.0f);
+	CHECK(second.Position()[0] == 1.0f && second.Position()[1] == 0.0f);
+	CHECK(first.Normal()[2] == -1.0f && FlatNormalsMatchWinding(mesh));
+	CHECK(mesh.vertices[mesh.indices[14]].Position()[1] == 1.5f && mesh.vertices[mesh.indices[14]].Texcoord()[1] == 0.0f);
+}
+
+TEST(ObjMissingNormals) {
+	// Corners without a normal get the face normal and a vertex each, the fronts face where the winding says.
+	MeshData grid = MakeTestMesh();
+	std::string text;
+	char line[128];
+	for (const MeshVertex& v : grid.vertices) {
+		snprintf(line, sizeof(line), "v %.9g %.9g %.9g\n", v.Position()[0], v.Position()[1], -v.Position()[2]);
+		text += line;
+	}
+	for (size_t i = 0; i < grid.indices.size(); i += 3) {
+		snprintf(line, sizeof(line), "f %u %u %u\n", grid.indices[i] + 1, grid.indices[i + 2] + 1, grid.indices[i + 1] + 1);
+		text += line;
+	}
+	MeshData mesh;
+	std::string error;
+	CHECK(ImportObj(text, mesh, error));
+	CHECK(mesh.vertices.size() == grid.indices.size());
+	CHECK(FlatNormalsMatchWinding(mesh));
+	bool facesLikeGrid = true;
+	for (size_t i = 0; i < mesh.indices.size(); i++) {
+		const float* n = mesh.vertices[mesh.indices[i]].Normal();
+		const float* expected = grid.vertices[grid.indices[i]].Normal();
+		facesLikeGrid = facesLikeGrid && n[0] * expected[0] + n[1] * expected[1] + n[2] * expected[2] > 0.8f;
+	}
+	CHECK(facesLikeGrid);
+}
+
+TEST(ObjErrors) {
+	const std::string vertices = "v 0 0 0\nv 1 0 0\nv 0 1 0\n";
+	CHECK(ObjError(vertices + "f 1 2 3\n").empty());
+	CHECK(ObjError(vertices) == ": the file has no faces");
+	CHECK(ObjError("") == ": could not read the file");	// Empty files do not map.
+	CHECK(ObjError(vertices + "f 1 2\n") == "(4): a face needs at least 3 vertices");
+	CHECK(ObjError(vertices + "f 1 2 4\n") == "(4): index 4 is out of range");
+	CHECK(ObjError(vertices + "f 1 2 0\n") == "(4): index 0 is out of range");
+	CHECK(ObjError(vertices + "f -1 -2 -4\n") == "(4): index -4 is out of range");
+	CHECK(ObjError("v 0 0 0\nf 1 -2 1\nv 1 0 0\n") == "(2): index -2 is out of range");	// Counts back from what was read so far.
+	CHECK(ObjError(vertices + "f 1/2 2 3\n") == "(4): index 2 is out of range");
+	CHECK(ObjError(vertices + "f 1 2 3x\n") == "(4): invalid face vertex '3x'");
+	CHECK(ObjError(vertices + "f 1 2 /3\n") == "(4): invalid face vertex '/3'");
+	CHECK(ObjError("v 0 0\n" + vertices + "f 1 2 3\n") == "(1): expected 3 values, found 2");
+	CHECK(ObjError("v 0 zero 0\n" + vertices + "f 1 2 3\n") == "(1): invalid number 'zero'");
+	CHECK(ObjError(vertices + "vn 0 0 1,\nf 1 2 3\n") == "(4): invalid number '1,'");
+
+	ObjImporterClass importer;
+	MeshData mesh;
+	std::string missing = TestFramework::GetTempFilename("missing.obj");
+	CHECK(!importer.Import(missing.c_str(), mesh) && importer.GetError() == missing + ": could not read the file");
+}
+
+TEST(GltfRoundTrip) {
+	// The same mesh from a .gltf with its .bin and from a .glb.
+	MeshData grid = MakeTestMesh();
+	Gltf gltf = ToGltf(grid, true);
+	for (bool binary : { false, true }) {
+		MeshData mesh;
+		std::string error;
+		CHECK(ImportGltf(binary ? ToGltf(grid, true, "{\"mesh\":0}", 0) : gltf, binary, mesh, error));
+		CHECK(mesh.vertices.size() == grid.vertices.size() && mesh.indices.size() == grid.indices.size());
+		CHECK(NearTriangles(mesh, grid));
+	}
+}
+
+TEST(GltfMissingNormals) {
+	MeshData grid = MakeTestMesh();
+	MeshData mesh;
+	std::string error;
+	CHECK(ImportGltf(ToGltf(grid, false), false, mesh, error));
+	CHECK(mesh.vertices.size() == grid.indices.size());
+	CHECK(FlatNormalsMatchWinding(mesh));
+	bool sameCorners = true;
+	for (size_t i = 0; i < mesh.indices.size(); i++) {
+		const MeshVertex& v = mesh.vertices[mesh.indices[i]];
+		const MeshVertex& expected = grid.vertices[grid.indices[i]];
+		for (int k = 0; k < 3; k++) { sameCorners = sameCorners && v.Position()[k] == expected.Position()[k]; }
+		sameCorners = sameCorners && v.Texcoord()[0] == expected.Texcoord()[0] && v.Texcoord()[1] == expected.Texcoord()[1];
+	}
+	CHECK(sameCorners);
+}
+
+TEST(GltfNodes) {
+	// A node translated, a child scaled by -1 in x which turns the winding over and back again, both drawing the mesh.
+	MeshData grid = MakeTestMesh();
+	Gltf gltf = ToGltf(grid, true, "{\"mesh\":0,\"translation\":[0,0,-2],\"children\":[1]},{\"mesh\":0,\"scale\":[-1,1,1]}");
+	MeshData mesh;
+	std::string error;
+	CHECK(ImportGltf(gltf, false, mesh, error));
+	CHECK(mesh.vertices.size() == grid.vertices.size() * 2 && mesh.indices.size() == grid.indices.size() * 2);
+
+	MeshData moved = grid, mirrored = grid;
+	for (MeshVertex& v : moved.vertices) { v.Position()[2] += 2.0f; }	// Translated along -z in glTF, +z here.
+	for (MeshVertex& v : mirrored.vertices) {
+		v.Position()[0] = -v.Position()[0];
+		v.Position()[2] += 2.0f;
+		v.Normal()[0] = -v.Normal()[0];
+	}
+	for (size_t i = 0; i < mirrored.indices.size(); i += 3) { std::swap(mirrored.indices[i + 1], mirrored.indices[i + 2]); }
+	MeshData first, second;
+	first.vertices = second.vertices = mesh.vertices;
+	first.indices.assign(mesh.indices.begin(), mesh.indices.begin() + grid.indices.size());
+	second.indices.assign(mesh.indices.begin() + grid.indices.size(), mesh.indices.end());
+
+	CHECK(NearTriangles(first, moved));
+	CHECK(NearTriangles(second, mirrored));
+}
+
+TEST(GltfQuantized) {
+	// KHR_mesh_quantization: normalized bytes and shorts read as 0..1 and -1..1, 8 and 16-bit indices.
+	const int16_t positions[] = { 0, 0, 0, 32767, 0, 0, 0, -32767, 0 };
+	const uint8_t texcoords[] = { 0, 0, 255, 0, 0, 255, 0, 0 };
+	const int8_t normals[] = { 0, 0, 127, 0, 0, 127, 0, 0, 127, 0, 0, 0 };
+	const uint8_t indices[] = { 0, 1, 2, 0 };
+	Gltf gltf;
+	std::string primitive = "{\"attributes\":{\"POSITION\":" + gltf.AddAccessor(positions, sizeof(positions), 3, 5122, "VEC3", true);
+	primitive += ",\"TEXCOORD_0\":" + gltf.AddAccessor(texcoords, sizeof(texcoords) - 2, 3, 5121, "VEC2", true);
+	primitive += ",\"NORMAL\":" + gltf.AddAccessor(normals, 9, 3, 5120, "VEC3", true);
+	primitive += "},\"indices\":" + gltf.AddAccessor(indices, 3, 3, 5121, "SCALAR") + "}";
+	gltf.Finish(primitive, "{\"mesh\":0}", "import.bin");
+	gltf.json.insert(1, "\"extensionsRequired\":[\"KHR_mesh_quantization\"],");
+
+	MeshData mesh;
+	std::string error;
+	CHECK(ImportGltf(gltf, false, mesh, error));
+	CHECK(mesh.vertices.size() == 3 && mesh.indices.size() == 3);
+	CHECK(mesh.indices[0] == 0 && mesh.indices[1] == 2 && mesh.indices[2] == 1);
+	CHECK(mesh.vertices[1].Position()[0] == 1.0f && mesh.vertices[2].Position()[1] == -1.0f);
+	CHECK(mesh.vertices[1].Texcoord()[0] == 1.0f && mesh.vertices[2].Texcoord()[1] == 1.0f);
+	CHECK(mesh.vertices[0].Normal()[2] == -1.0f);
+}
+
+TEST(GltfErrors) {
+	MeshData grid = MakeTestMesh();
+	Gltf valid = ToGltf(grid, true);
+	CHECK(GltfError(valid).empty());
+
+	auto edited = [&](const std::string& from, const std::string& to) {
+		Gltf gltf = valid;
+		size_t at = gltf.json.find(from);
+		if (at != std::string::npos) { gltf.json.replace(at, from.size(), to); }
+		return gltf;
+	};
+	CHECK(GltfError(edited("\"2.0\"", "\"1.0\"")) == "not a glTF 2.0 file");
+	CHECK(GltfError(edited("{\"asset\"", "{\"extensionsRequired\":[\"KHR_draco_mesh_compression\"],\"asset\"")) == "requires the unsupported extension KHR_draco_mesh_compression");
+	CHECK(GltfError(edited("\"scene\":0", "\"scene\":3")) == "the default scene does not exist");
+	CHECK(GltfError(edited("\"POSITION\":0", "\"POSITION\":9")) == "POSITION refers to a missing accessor");
+	CHECK(GltfError(edited("\"indices\":3", "\"indices\":0")) == "mesh 0 has invalid indices");
+	CHECK(GltfError(edited("\"uri\":\"import.bin\"", "\"uri\":\"data:application/octet-stream;base64,AAAA\"")) == "buffer 0 is embedded as base64, export with a separate .bin or as .glb");
+	CHECK(GltfError(edited("\"uri\":\"import.bin\"", "\"uri\":\"missing.bin\"")).find("could not read buffer 0 from") == 0);
+	CHECK(GltfError(edited("\"mesh\":0}", "\"mesh\":0,\"children\":[0]}")) == "the node hierarchy has a cycle");
+	CHECK(GltfError(edited("\"mesh\":0}", "\"mesh\":0,\"rotation\":[0,0,1]}")) == "node 0 has an invalid transform");
+	CHECK(GltfError(edited("\"attributes\"", "\"mode\":1,\"attributes\"")) == "the scene has no triangle meshes");
+	CHECK(GltfError(edited("\"byteLength\":" + std::to_string(valid.bin.size()) + "}", "\"byteLength\":100}")) == "buffer view 0 reaches past its buffer");
+	CHECK(GltfError(edited("\"count\":289", "\"count\":290")) == "accessor 0 reaches past its buffer view");
+	CHECK(GltfError(edited("\"count\":1536", "\"count\":1535")) == "mesh 0 has a partial triangle");
+	CHECK(GltfError(edited("{\"asset\"", "{\"asset\" \"version\"")).find("line 1:") == 0);
+
+	// An index past the vertices fails in the jobs.
+	Gltf outOfRange = valid;
+	uint32_t index = 289;
+	memcpy(&outOfRange.bin[outOfRange.bin.size() - 4], &index, 4);
+	CHECK(GltfError(outOfRange) == "index 289 is out of range for 289 vertices");
+
+	// A .glb whose chunk claims more than the file has.
+	Gltf binary = ToGltf(grid, true, "{\"mesh\":0}", 0);
+	std::string glb = binary.ToGlb();
+	uint32_t length = (uint32_t)glb.size();
+	memcpy(&glb[12], &length, 4);
+	GltfImporterClass importer;
+	MeshData mesh;
+	CHECK(!importer.Import(WriteFile("broken.glb", glb).c_str(), mesh));
+	CHECK(importer.GetError().find("a .glb chunk runs past the end of the file") != std::string::npos);
+}
+
+TEST(ImportBenchmark) {
+	// The same 256x256 grid from each format, against the engine's text format for scale.
+	MeshData grid = TestMeshes::MakeGrid(256);
+	std::string obj = WriteFile("bench.obj", ToObj(grid));
+	Gltf gltf = ToGltf(grid, true, "{\"mesh\":0}", 0);
+	std::string glb = WriteFile("bench.glb", gltf.ToGlb());
+
+	double objTime = TestFramework::Benchmark("import .obj", 3, [&]() {
+		ObjImporterClass importer;
+		MeshData mesh;
+		importer.Import(obj.c_str(), mesh);
+	});
+	double glbTime = TestFramework::Benchmark("import .glb", 3, [&]() {
+		GltfImporterClass importer;
+		MeshData mesh;
+		importer.Import(glb.c_str(), mesh);
+	});
+	double objMegabytes = (double)std::ifstream(obj, std::ios::binary | std::ios::ate).tellg() / (1 << 20);
+	double glbMegabytes = (double)std::ifstream(glb, std::ios::binary | std::ios::ate).tellg() / (1 << 20);
+	printf("  %zu vertices: .obj %.1f MB at %.0f MB/s, .glb %.1f MB at %.0f MB/s\n", grid.vertices.size(), objMegabytes,
+		objMegabytes * 1000.0 / objTime, glbMegabytes, glbMegabytes * 1000.0 / glbTime);
+}
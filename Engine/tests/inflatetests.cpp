@@ -0,0 +1,331 @@
+#include "testframework.hpp"
+#include "testimages.hpp"
+#include <random>
+#include "inflateclass.hpp"
+
+using namespace TestImages;
+
+namespace {
+	bool Inflate(const std::string& stream, size_t capacity, std::vector<unsigned char>& data, std::string& error, bool zlib = false) {
+		data.assign(capacity + 1, 0);	// One spare byte, which must stay untouched.
+		size_t written = 0;
+		const unsigned char* source = (const unsigned char*)stream.data();
+		bool success = zlib ? InflateClass::InflateZlib(source, stream.size(), data.data(), capacity, written, error) :
+			InflateClass::Inflate(source, stream.size(), data.data(), capacity, written, error);
+		bool spareUntouched = data[capacity] == 0;
+		data.resize(written);
+		return success && spareUntouched;
+	}
+
+	bool RoundTrips(const std::vector<unsigned char>& data, BlockType type, size_t blockSize = 1 << 16) {
+		std::vector<unsigned char> inflated;
+		std::string error;
+		return Inflate(Deflate(data, type, blockSize), data.size(), inflated, error) && inflated == data;
+	}
+
+	std::vector<unsigned char> FromHex(const char* hex) {
+		std::vector<unsigned char> bytes;
+		for (; hex[0] && hex[1]; hex += 2) { bytes.push_back((unsigned char)std::stoi(std::string(hex, 2), 0, 16)); }
+		return bytes;
+	}
+
+	// What a token list decodes to, one byte at a time.
+	std::vector<unsigned char> Apply(const std::vector<Token>& tokens) {
+		std::vector<unsigned char> data;
+		for (const Token& token : tokens) {
+			if (!token.length) { data.push_back(token.literal); }
+			for (size_t i = 0; i < token.length; i++) { data.push_back(data[data.size() - token.distance]); }
+		}
+		return data;
+	}
+
+	std::string WriteBlock(const std::vector<Token>& tokens, BlockType type) {
+		BitWriter writer;
+		writer.Write(1, 1);
+		std::vector<uint8_t> literals = FixedLiteralLengths(), distances(30, 5);
+		if (type == BLOCK_DYNAMIC) {
+			std::vector<uint32_t> literalCounts(286, 0), distanceCounts(30, 0);
+			literalCounts[256] = 1;
+			for (const Token& token : tokens) {
+				if (!token.length) { literalCounts[token.literal]++; }
+				else {
+					literalCounts[257 + LengthSymbol(token.length)]++;
+					distanceCounts[DistanceSymbol(token.distance)]++;
+				}
+			}
+			literals = CodeLengths(literalCounts, 15);
+			distances = CodeLengths(distanceCounts, 15);
+			if (std::count(distances.begin(), distances.end(), 0) == 30) { distances[0] = 1; }
+		}
+		writer.Write(type == BLOCK_DYNAMIC ? 2 : 1, 2);
+		if (type == BLOCK_DYNAMIC) { WriteDynamicHeader(writer, literals, distances); }
+		WriteTokens(writer, tokens.data(), tokens.size(), literals, distances);
+		writer.Align();
+		return writer.bytes;
+	}
+
+	// The start of a final dynamic block with the given code length code, the lengths still to be written.
+	BitWriter DynamicHeader(int literalCount, int distanceCount, const std::vector<std::pair<int, int>>& codeLengthLengths) {
+		uint8_t lengths[19] = {};
+		for (const auto& entry : codeLengthLengths) { lengths[entry.first] = (uint8_t)entry.second; }
+		int count = 19;
+		while (count > 4 && !lengths[CODE_LENGTH_ORDER[count - 1]]) { count--; }
+		BitWriter writer;
+		writer.Write(1, 1);
+		writer.Write(2, 2);
+		writer.Write(literalCount - 257, 5);
+		writer.Write(distanceCount - 1, 5);
+		writer.Write(count - 4, 4);
+		for (int i = 0; i < count; i++) { writer.Write(lengths[CODE_LENGTH_ORDER[i]], 3); }
+		return writer;
+	}
+
+	std::string Error(BitWriter writer, size_t capacity = 100) {
+		writer.Align();
+		std::vector<unsigned char> data;
+		std::string error;
+		return Inflate(writer.bytes, capacity, data, error) ? "" : error;
+	}
+}
+
+TEST(ReferenceStreams) {
+	// From zlib itself at level 9, the first with fixed codes and the second with dynamic ones.
+	std::vector<unsigned char> data;
+	std::string error;
+	std::vector<unsigned char> fixed = FromHex("78dacb48cdc9c9d751c840a214014b1e06f6");
+	CHECK(((fixed[2] >> 1) & 3) == 1);
+	CHECK(Inflate(std::string(fixed.begin(), fixed.end()), 20, data, error, true) && std::string(data.begin(), data.end()) == "hello, hello, hello!");
+
+	std::vector<unsigned char> dynamic = FromHex("78daedcdb90dc0400c03b059f559de7f82dc0ae9dd1320360404ba044b4b8a61849c686a1535b15a780094a264af9e62a28c351871fbac"
+		"b3c09078ca15b48ce59841c48eba7671efbdf7defbf3fd000c97d3b8");
+	std::vector<unsigned char> expected;
+	for (int i = 0; i < 1200; i++) { expected.push_back((unsigned char)"abcdefgh"[i % 3 ? (i * i * 7 + i / 5) % 8 : (i / 3) % 4]); }
+	CHECK(((dynamic[2] >> 1) & 3) == 2);
+	CHECK(Inflate(std::string(dynamic.begin(), dynamic.end()), 1200, data, error, true) && data == expected);
+}
+
+TEST(StoredBlocks) {
+	std::vector<unsigned char> random = RandomBytes(200000, 1);
+	CHECK(RoundTrips(random, BLOCK_STORED, 65535) && RoundTrips(random, BLOCK_STORED, 1000));
+	CHECK(RoundTrips({}, BLOCK_STORED) && RoundTrips({ 42 }, BLOCK_STORED));
+
+	// After a block with codes, the bits left of its last byte are dropped and the stored block starts at the next.
+	std::vector<Token> tokens = { { 0, 0, 'a' }, { 0, 0, 'b' }, { 5, 2, 0 } };
+	BitWriter writer;
+	writer.Write(0, 1);
+	writer.Write(1, 2);
+	WriteTokens(writer, tokens.data(), tokens.size(), FixedLiteralLengths(), std::vector<uint8_t>(30, 5));
+	CHECK(writer.count != 0);
+	writer.Write(1, 1);
+	writer.Write(0, 2);
+	writer.Align();
+	writer.Write(3, 16);
+	writer.Write(3 ^ 0xFFFF, 16);
+	writer.bytes += "xyz";
+	std::vector<unsigned char> data;
+	std::string error;
+	CHECK(Inflate(writer.bytes, 10, data, error) && std::string(data.begin(), data.end()) == "abababaxyz");
+}
+
+TEST(FixedAndDynamicBlocks) {
+	std::vector<unsigned char> photo = MakePhoto(256, 256, 4, 1);
+	std::vector<unsigned char> text;
+	for (int i = 0; i < 20000; i++) { text.push_back((unsigned char)"the quick brown fox jumps over the lazy dog "[(i * 7 + i / 13) % 44]); }
+	for (BlockType type : { BLOCK_FIXED, BLOCK_DYNAMIC }) {
+		CHECK(RoundTrips(photo, type) && RoundTrips(text, type));
+		CHECK(RoundTrips(photo, type, 5000));	// Several blocks, matches reaching into the ones before.
+		CHECK(RoundTrips({}, type) && RoundTrips(RandomBytes(100000, 2), type));
+	}
+	// The encoder really compresses, so the blocks are full of matches.
+	CHECK(Deflate(text, BLOCK_DYNAMIC).size() < text.size() / 10);
+}
+
+TEST(LongCodes) {
+	// Fibonacci frequencies give the deepest codes a length limit allows, past FAST_BITS into the slow path.
+	std::vector<Token> tokens;
+	uint32_t a = 1, b = 1;
+	for (int symbol = 0; symbol < 24; symbol++) {
+		for (uint32_t i = 0; i < a; i++) { tokens.push_back({ 0, 0, (unsigned char)(symbol * 10) }); }
+		uint32_t next = a + b;
+		a = b;
+		b = next;
+	}
+	std::shuffle(tokens.begin(), tokens.end(), std::mt19937(2));
+	std::vector<uint32_t> counts(286, 0);
+	counts[256] = 1;
+	for (const Token& token : tokens) { counts[token.literal]++; }
+	std::vector<uint8_t> lengths = CodeLengths(counts, 15);
+	CHECK(*std::max_element(lengths.begin(), lengths.end()) > InflateClass::FAST_BITS + 2);
+
+	std::vector<unsigned char> expected = Apply(tokens), data;
+	std::string error;
+	CHECK(Inflate(WriteBlock(tokens, BLOCK_DYNAMIC), expected.size(), data, error) && data == expected);
+}
+
+TEST(Matches) {
+	// Every kind of copy: runs of one byte, overlapping short distances, eight byte steps, the full window, and
+	// matches ending right at the end of the buffer where the eight byte steps would overshoot.
+	std::vector<Token> tokens;
+	std::vector<unsigned char> random = RandomBytes(33000, 3);
+	for (unsigned char byte : random) { tokens.push_back({ 0, 0, byte }); }
+	for (int distance : { 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 100, 1000, 32767, 32768 }) {
+		for (int length : { 3, 4, 7, 8, 9, 15, 16, 17, 100, 257, 258 }) { tokens.push_back({ (uint16_t)length, (uint16_t)distance, 0 }); }
+	}
+	for (int length : { 3, 10, 258, 5 }) { tokens.push_back({ (uint16_t)length, 12, 0 }); }
+	std::vector<unsigned char> expected = Apply(tokens), data;
+	std::string error;
+	for (BlockType type : { BLOCK_FIXED, BLOCK_DYNAMIC }) {
+		CHECK(Inflate(WriteBlock(tokens, type), expected.size(), data, error) && data == expected);
+		CHECK(Inflate(WriteBlock(tokens, type), expected.size() + 1000, data, error) && data == expected);
+	}
+}
+
+TEST(Malformed) {
+	std::vector<unsigned char> data;
+	std::string error;
+	BitWriter writer;
+	writer.Write(1, 1);
+	writer.Write(3, 2);
+	CHECK(Error(writer) == "bad block type");
+
+	// Stored blocks with a wrong length check, cut short, and cut inside their header.
+	std::string stored = Deflate({ 1, 2, 3, 4, 5 }, BLOCK_STORED);
+	std::string wrongCheck = stored;
+	wrongCheck[3] ^= 1;
+	CHECK(!Inflate(wrongCheck, 5, data, error) && error == "bad stored block length");
+	CHECK(!Inflate(stored.substr(0, stored.size() - 1), 5, data, error) && error == "truncated stored block");
+	CHECK(!Inflate(stored.substr(0, 3), 5, data, error) && error == "truncated stored block");
+	CHECK(!Inflate(stored, 4, data, error) && error == "more data than expected");
+
+	// Codes that decode to nothing allowed.
+	std::vector<uint32_t> fixedCodes = CanonicalCodes(FixedLiteralLengths());
+	writer = BitWriter();
+	writer.Write(1, 1);
+	writer.Write(1, 2);
+	writer.WriteCode(fixedCodes['a'], 8);
+	writer.WriteCode(fixedCodes[286], 8);
+	CHECK(Error(writer) == "bad length code");
+	writer = BitWriter();
+	writer.Write(1, 1);
+	writer.Write(1, 2);
+	writer.WriteCode(fixedCodes['a'], 8);
+	writer.WriteCode(fixedCodes[257], 7);
+	writer.WriteCode(30, 5);
+	CHECK(Error(writer) == "bad distance code");
+	std::vector<Token> tooFar = { { 0, 0, 'a' }, { 3, 2, 0 } };
+	writer = BitWriter();
+	writer.Write(1, 1);
+	writer.Write(1, 2);
+	WriteTokens(writer, tooFar.data(), tooFar.size(), FixedLiteralLengths(), std::vector<uint8_t>(30, 5));
+	CHECK(Error(writer) == "distance too far back");
+
+	// More output than room for it, with what fit written.
+	std::vector<unsigned char> text(1000, 'x');
+	for (size_t i = 0; i < text.size(); i += 7) { text[i] = (unsigned char)('a' + i % 26); }
+	for (BlockType type : { BLOCK_FIXED, BLOCK_DYNAMIC }) {
+		size_t written = 0;
+		std::string stream = Deflate(text, type);
+		std::vector<unsigned char> small(600);
+		CHECK(!InflateClass::Inflate((const unsigned char*)stream.data(), stream.size(), small.data(), small.size(), written, error));
+		CHECK(error == "more data than expected" && written <= 600 && std::equal(small.begin(), small.begin() + written, text.begin()));
+	}
+
+	// Dynamic tables that break the rules, each built by hand.
+	writer = DynamicHeader(287, 1, {});
+	CHECK(Error(writer) == "too many length or distance codes");
+	std::vector<std::pair<int, int>> everyCodeOneBit;
+	for (int symbol = 0; symbol < 19; symbol++) { everyCodeOneBit.push_back({ symbol, 1 }); }
+	CHECK(Error(DynamicHeader(257, 1, everyCodeOneBit)) == "bad code length code");
+
+	// Symbols 0 and 16 get codes 0 and 1, 0 and 18 likewise.
+	writer = DynamicHeader(257, 1, { { 0, 1 }, { 16, 1 } });
+	writer.WriteCode(1, 1);
+	writer.Write(0, 2);
+	CHECK(Error(writer) == "repeat without a previous length");
+	writer = DynamicHeader(257, 1, { { 0, 1 }, { 18, 1 } });
+	for (int i = 0; i < 2; i++) {
+		writer.WriteCode(1, 1);
+		writer.Write(127, 7);
+	}
+	CHECK(Error(writer) == "code lengths overflow");
+	writer = DynamicHeader(257, 1, { { 0, 1 }, { 18, 1 } });
+	writer.WriteCode(1, 1);
+	writer.Write(127, 7);
+	writer.WriteCode(1, 1);
+	writer.Write(120 - 11, 7);
+	CHECK(Error(writer) == "no end of block code");
+
+	// Every literal one bit long.
+	writer = DynamicHeader(257, 1, { { 1, 1 } });
+	for (int i = 0; i < 258; i++) { writer.WriteCode(0, 1); }
+	CHECK(Error(writer) == "bad literal code");
+
+	// Only the end of block code, symbol 1 gets code 0 and 18 code 1.
+	auto onlyEnd = [](int distanceCount) {
+		BitWriter header = DynamicHeader(257, distanceCount, { { 1, 1 }, { 18, 1 } });
+		header.WriteCode(1, 1);
+		header.Write(127, 7);
+		header.WriteCode(1, 1);
+		header.Write(118 - 11, 7);
+		for (int i = 0; i < 1 + distanceCount; i++) { header.WriteCode(0, 1); }
+		return header;
+	};
+	CHECK(Error(onlyEnd(3)) == "bad distance code");
+	writer = onlyEnd(1);
+	writer.WriteCode(1, 1);	// No symbol has this code.
+	CHECK(Error(writer) == "bad literal or length code");
+	writer = onlyEnd(1);
+	writer.WriteCode(0, 1);
+	CHECK(Error(writer, 0) == "");
+
+	// Cut anywhere, a stream fails instead of making up the rest.
+	std::string stream = Deflate(MakePhoto(64, 64, 4, 3), BLOCK_DYNAMIC, 4000);
+	bool allFail = true;
+	for (size_t size = 0; size < stream.size(); size += 7) { allFail = allFail && !Inflate(stream.substr(0, size), 64 * 64 * 4, data, error); }
+	CHECK(allFail);
+	std::string final = Deflate(text, BLOCK_FIXED);
+	CHECK(!Inflate(final.substr(0, final.size() / 2), text.size(), data, error) && error == "truncated data");
+
+	// The zlib header.
+	std::string valid = Zlib(text, BLOCK_FIXED);
+	CHECK(Inflate(valid, text.size(), data, error, true) && data == text);
+	CHECK(!Inflate(valid.substr(0, 1), text.size(), data, error, true) && error == "truncated zlib header");
+	CHECK(!Inflate("\x78\x02" + valid.substr(2), text.size(), data, error, true) && error == "bad zlib header");
+	CHECK(!Inflate("\x77\x01" + valid.substr(2), text.size(), data, error, true) && error == "bad zlib header");
+	CHECK(!Inflate(std::string("\x78\x20", 2) + valid.substr(2), text.size(), data, error, true) && error == "preset dictionaries are not supported");
+}
+
+TEST(Fuzz) {
+	// Damaged streams fail or decode, they never read or write out of bounds. Run under a sanitizer to be sure.
+	std::vector<std::string> streams = { Deflate(MakePhoto(32, 32, 3, 4), BLOCK_DYNAMIC, 1000), Deflate(MakePhoto(32, 32, 3, 5), BLOCK_FIXED),
+		Deflate(RandomBytes(3000, 4), BLOCK_STORED, 700) };
+	std::mt19937 random(6);
+	int decoded = 0, failed = 0;
+	std::vector<unsigned char> data;
+	std::string error;
+	for (int i = 0; i < 5000; i++) {
+		std::string stream = streams[random() % streams.size()];
+		for (int flips = 1 + random() % 3; flips > 0; flips--) { stream[random() % stream.size()] ^= (char)(1 << random() % 8); }
+		Inflate(stream, 3072, data, error) ? decoded++ : failed++;
+	}
+	printf("  %d damaged streams decoded, %d failed\n", decoded, failed);
+	CHECK(failed > 0);
+}
+
+TEST(InflateBenchmark) {
+	std::vector<unsigned char> photo = MakePhoto(1024, 1024, 4, 7);
+	double megabytes = photo.size() / 1e6;
+	for (BlockType type : { BLOCK_STORED, BLOCK_FIXED, BLOCK_DYNAMIC }) {
+		std::string stream = Deflate(photo, type);
+		std::vector<unsigned char> data(photo.size());
+		size_t written = 0;
+		std::string error;
+		bool success = true;
+		const char* names[] = { "inflate stored 4 MB", "inflate fixed 4 MB", "inflate dynamic 4 MB" };
+		double milliseconds = TestFramework::Benchmark(names[type], 5, [&]() {
+			success = success && InflateClass::Inflate((const unsigned char*)stream.data(), stream.size(), data.data(), data.size(), written, error);
+		});
+		printf("  %.0f MB/s out, %.1f%% of the size\n", megabytes / milliseconds * 1000.0, 100.0 * stream.size() / photo.size());
+		CHECK(success && data == photo);
+	}
+}
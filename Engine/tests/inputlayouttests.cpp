@@ -0,0 +1,85 @@
+#include "testframework.hpp"
+#include "testdevice.hpp"
+#include <string.h>
+#include "inputlayoutclass.hpp"
+#include "vertexencoderclass.hpp"
+
+using namespace TestDevice;
+
+namespace {
+	// Bytes per element of the DXGI formats the layouts use.
+	UINT GetFormatSize(DXGI_FORMAT format) {
+		switch (format) {
+		case DXGI_FORMAT_R32G32_FLOAT: return 8;
+		case DXGI_FORMAT_R32G32B32_FLOAT: return 12;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT: return 16;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT: return 8;
+		case DXGI_FORMAT_R16G16B16A16_SNORM: return 8;
+		case DXGI_FORMAT_R16G16_FLOAT: return 4;
+		case DXGI_FORMAT_R16G16_UNORM: return 4;
+		case DXGI_FORMAT_R16G16_SNORM: return 4;
+		default: return 0;
+		}
+	}
+}
+
+TEST(Elements) {
+	// Every encoding the cooker writes: the input layout reads each attribute from the slot and offset it was written to,
+	// in a format of the size the encoder packed.
+	for (uint32_t position = 0; position < 3; position++) {
+		for (uint32_t texcoord = 0; texcoord < 3; texcoord++) {
+			for (uint32_t normal = 0; normal < 2; normal++) {
+				for (uint32_t streams = 0; streams < 2; streams++) {
+					VertexEncoding encoding{ (PositionEncoding)position, (TexcoordEncoding)texcoord, (NormalEncoding)normal, (VertexStreams)streams };
+					VertexLayout layout = VertexEncoderClass::Describe(encoding);
+					MeshVertexFormat format = VertexEncoderClass::Layout(encoding);
+					InputElements input = InputLayoutClass::GetElements(layout);
+					CHECK(input.count == 3);
+					UINT strides[VertexLayout::MAX_STREAMS]{};
+					for (UINT i = 0; i < input.count; i++) {
+						const D3D11_INPUT_ELEMENT_DESC& desc = input.elements[i];
+						const VertexElement& element = layout.elements[i];
+						CHECK(strcmp(desc.SemanticName, InputLayoutClass::GetSemanticName(element.semantic)) == 0 && desc.SemanticIndex == 0);
+						CHECK(desc.InputSlot == element.stream && desc.AlignedByteOffset == strides[desc.InputSlot]);
+						CHECK(GetFormatSize(desc.Format) == VertexLayout::GetElementSize(element.format));
+						CHECK(desc.InputSlotClass == D3D11_INPUT_PER_VERTEX_DATA && desc.InstanceDataStepRate == 0);
+						strides[desc.InputSlot] += GetFormatSize(desc.Format);
+					}
+					CHECK(format.streamCount == layout.streamCount && strides[0] + strides[1] == format.stride);
+					for (uint32_t stream = 0; stream < format.streamCount; stream++) { CHECK(strides[stream] == format.streamStrides[stream]); }
+				}
+			}
+		}
+	}
+
+	// The float layout is MeshVertex, the compact one the 16 bytes it promises.
+	InputElements full = InputLayoutClass::GetElements(MESH_VERTEX_LAYOUT);
+	CHECK(full.elements[0].Format == DXGI_FORMAT_R32G32B32_FLOAT && full.elements[1].Format == DXGI_FORMAT_R32G32_FLOAT);
+	MeshVertex vertex;
+	CHECK(full.elements[2].AlignedByteOffset == (UINT)((vertex.Normal() - vertex.Position()) * sizeof(float)));
+	InputElements compact = InputLayoutClass::GetElements(VertexEncoderClass::Describe(VertexEncoding::Compact()));
+	CHECK(compact.elements[0].Format == DXGI_FORMAT_R16G16B16A16_SNORM && compact.elements[1].Format == DXGI_FORMAT_R16G16_FLOAT);
+	CHECK(compact.elements[2].Format == DXGI_FORMAT_R16G16_SNORM && compact.elements[2].AlignedByteOffset == 12);
+
+	// A depth pass selecting the positions keeps them where they are.
+	InputElements positions = InputLayoutClass::GetElements(VertexLayoutChecks::SPLIT.Select(1u << SEMANTIC_POSITION));
+	CHECK(positions.count == 1 && strcmp(positions.elements[0].SemanticName, "POSITION") == 0 && positions.elements[0].InputSlot == 0);
+	CHECK(InputLayoutClass::GetFormat((VertexElementFormat)99) == DXGI_FORMAT_UNKNOWN && InputLayoutClass::GetSemanticName((VertexSemantic)99) == 0);
+}
+
+TEST(Create) {
+	FakeDevice device;
+	std::vector<unsigned char> bytecode(100);
+	ID3D11InputLayout* inputLayout = 0;
+	VertexLayout layout = VertexEncoderClass::Describe({ POSITION_SNORM16, TEXCOORD_HALF2, NORMAL_OCT16, STREAMS_POSITION_SPLIT });
+	CHECK(InputLayoutClass::Create(&device, layout, bytecode, &inputLayout) == S_OK && inputLayout);
+	CHECK(device.inputElements.size() == 3 && device.bytecodeLength == 100);
+	CHECK(device.inputElements[1].InputSlot == 1 && device.inputElements[2].AlignedByteOffset == 4);
+	inputLayout->Release();
+
+	// A layout that failed to build never reaches the device.
+	VertexLayout invalid = VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_FLOAT3).Add(SEMANTIC_POSITION, ELEMENT_FLOAT3);
+	inputLayout = 0;
+	int creates = device.creates;
+	CHECK(InputLayoutClass::Create(&device, invalid, bytecode, &inputLayout) == E_INVALIDARG && !inputLayout && device.creates == creates);
+}
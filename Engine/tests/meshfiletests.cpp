@@ -0,0 +1,182 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include "meshcookerclass.hpp"
+#include "meshfileclass.hpp"
+#include "modelparserclass.hpp"
+
+namespace {
+	CookedMesh Cook(const MeshData& mesh, bool withMeshlets) {
+		CookedMesh cooked;
+		VertexEncoderClass::Encode(mesh.vertices, VertexEncoding::Compact(), cooked.format, cooked.vertices);
+		cooked.indices = mesh.indices;
+		MeshLod lod;
+		lod.indexCount = (uint32_t)mesh.indices.size();
+		if (withMeshlets) {
+			cooked.meshlets = MeshletClass::Build(mesh, 0, mesh.indices.size());
+			lod.meshletCount = (uint32_t)cooked.meshlets.size();
+		}
+		cooked.lods.push_back(lod);
+		cooked.bounds = mesh.bounds;
+		cooked.bounds.radius = 1.0f;
+		cooked.cookKey = 1234;
+		return cooked;
+	}
+
+	std::vector<char> ReadBytes(const std::string& filename) {
+		std::ifstream fin(filename, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+	}
+
+	bool Opens(const std::vector<char>& bytes) {
+		std::string filename = TestFramework::GetTempFilename("corrupt.mesh");
+		std::ofstream(filename, std::ios::binary).write(bytes.data(), (std::streamsize)bytes.size());
+		MeshFileClass mesh(filename.c_str());
+		return mesh.isInitialized;
+	}
+
+	MeshFileSection* GetSection(std::vector<char>& bytes, uint32_t type) {
+		MeshFileHeader* header = (MeshFileHeader*)bytes.data();
+		MeshFileSection* sections = (MeshFileSection*)(bytes.data() + sizeof(MeshFileHeader));
+		for (uint32_t i = 0; i < header->sectionCount; i++) {
+			if (sections[i].type == type) { return &sections[i]; }
+		}
+		return 0;
+	}
+}
+
+TEST(RoundTrip) {
+	MeshData mesh = TestMeshes::MakeGrid(16);
+	CookedMesh cooked = Cook(mesh, true);
+	std::string filename = TestFramework::GetTempFilename("grid.mesh");
+	CHECK(MeshFileClass::Write(filename.c_str(), cooked));
+
+	MeshFileClass file(filename.c_str());
+	CHECK(file.isInitialized);
+	if (!file.isInitialized) { return; }
+	CHECK(file.GetCookKey() == 1234);
+	CHECK(file.GetVertexCount() == mesh.vertices.size());
+	CHECK(file.GetVertexStride() == cooked.format.stride);
+	CHECK(memcmp(file.GetVertices(), cooked.vertices.data(), cooked.vertices.size()) == 0);
+	CHECK(file.GetIndexStride() == 2);	// 289 vertices fit 16 bits.
+	CHECK(file.GetIndexCount() == mesh.indices.size());
+	const uint16_t* indices = (const uint16_t*)file.GetIndices();
+	bool sameIndices = true;
+	for (size_t i = 0; i < mesh.indices.size(); i++) { sameIndices = sameIndices && indices[i] == mesh.indices[i]; }
+	CHECK(sameIndices);
+	CHECK(file.GetVertexFormat().encoding == VertexEncoding::Compact());
+	CHECK(file.GetMeshletCount() == cooked.meshlets.size() && file.GetMeshletCount() > 0);
+	CHECK(memcmp(file.GetMeshlets(), cooked.meshlets.data(), cooked.meshlets.size() * sizeof(Meshlet)) == 0);
+	CHECK(file.GetLodCount() == 1 && file.GetLods()[0].indexCount == mesh.indices.size());
+	CHECK(file.GetBounds().radius == 1.0f && file.GetBounds().maximum[0] == 1.0f);
+
+	// The dequantized vertices come back close to what went in.
+	MeshVertex vertex = VertexEncoderClass::Decode((const unsigned char*)file.GetVertices(), (size_t)file.GetVertexCount(), 20, file.GetVertexFormat());
+	CHECK_NEAR(vertex.Position()[0], mesh.vertices[20].Position()[0], 1e-4f);
+	CHECK_NEAR(vertex.Position()[1], mesh.vertices[20].Position()[1], 1e-4f);
+	CHECK_NEAR(vertex.Texcoord()[0], mesh.vertices[20].Texcoord()[0], 1e-3f);
+}
+
+TEST(WideIndices) {
+	MeshData mesh = TestMeshes::MakeGrid(260);	// 261 * 261 vertices, more than 16 bits address.
+	std::string filename = TestFramework::GetTempFilename("wide.mesh");
+	CHECK(MeshFileClass::Write(filename.c_str(), Cook(mesh, false)));
+
+	MeshFileClass file(filename.c_str());
+	CHECK(file.isInitialized && file.GetIndexStride() == 4);
+	if (!file.isInitialized) { return; }
+	CHECK(memcmp(file.GetIndices(), mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int)) == 0);
+}
+
+TEST(CookTextModel) {
+	MeshData grid = TestMeshes::MakeGrid(8);
+	std::string source = TestFramework::GetTempFilename("grid.txt");
+	std::string cooked = MeshCookerClass::GetCookedFilename(source.c_str());
+	CHECK(TestMeshes::WriteTextModel(source.c_str(), TestMeshes::MakeSoup(grid)));
+
+	MeshCookSettings settings;
+	CHECK(MeshCookerClass::IsStale(source.c_str(), cooked.c_str(), settings));
+	MeshCookReport report;
+	CHECK(MeshCookerClass::Cook(source.c_str(), cooked.c_str(), settings, report));
+	CHECK(report.error.empty());
+
+	MeshFileClass file(cooked.c_str());
+	CHECK(file.isInitialized);
+	if (!file.isInitialized) { return; }
+	CHECK(file.GetVertexCount() == grid.vertices.size());	// The corners welded back together.
+	CHECK(file.GetLods()[0].indexCount == grid.indices.size());
+	CHECK(file.GetCookKey() == MeshCookerClass::GetCookKey(settings));
+	CHECK(!MeshCookerClass::IsStale(source.c_str(), cooked.c_str(), settings));
+}
+
+TEST(CorruptHeaders) {
+	// Without meshlets, so the meshlet section can be emptied without breaking the level that points into it.
+	std::string filename = TestFramework::GetTempFilename("valid.mesh");
+	CHECK(MeshFileClass::Write(filename.c_str(), Cook(TestMeshes::MakeGrid(4), false)));
+	const std::vector<char> valid = ReadBytes(filename);
+	CHECK(Opens(valid));
+
+	auto corrupt = [&valid](auto change) {
+		std::vector<char> bytes = valid;
+		change(bytes);
+		return Opens(bytes);
+	};
+	CHECK(!Opens({}));
+	CHECK(!Opens(std::vector<char>(valid.begin(), valid.begin() + sizeof(MeshFileHeader) - 1)));
+	CHECK(!Opens(std::vector<char>(valid.begin(), valid.end() - MESH_FILE_ALIGNMENT)));	// Cut into the bounds.
+	CHECK(!corrupt([](std::vector<char>& bytes) { bytes[0] = 'X'; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { ((MeshFileHeader*)bytes.data())->version = MESH_FILE_VERSION - 1; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { ((MeshFileHeader*)bytes.data())->sectionCount = 1000000; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { GetSection(bytes, MESH_SECTION_VERTICES)->offset += 4; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { GetSection(bytes, MESH_SECTION_VERTICES)->offset = 0; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { GetSection(bytes, MESH_SECTION_INDICES)->count *= 1000; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { GetSection(bytes, MESH_SECTION_INDICES)->stride = 3; }));
+	CHECK(!corrupt([](std::vector<char>& bytes) { GetSection(bytes, MESH_SECTION_LODS)->count = 0; }));
+
+	// An empty section past the end of the file passes the count check, the offset alone has to catch it.
+	CHECK(!corrupt([](std::vector<char>& bytes) {
+		MeshFileSection* meshlets = GetSection(bytes, MESH_SECTION_MESHLETS);
+		meshlets->count = 0;
+		meshlets->offset = (bytes.size() + 16 * MESH_FILE_ALIGNMENT) & ~(uint64_t)(MESH_FILE_ALIGNMENT - 1);
+	}));
+	// As does one without a stride, however many elements it claims.
+	CHECK(!corrupt([](std::vector<char>& bytes) {
+		MeshFileSection* meshlets = GetSection(bytes, MESH_SECTION_MESHLETS);
+		meshlets->stride = 0;
+		meshlets->count = ~0ull;
+	}));
+
+	// Payloads that disagree with the sections.
+	CHECK(!corrupt([](std::vector<char>& bytes) {
+		MeshLod* lod = (MeshLod*)(bytes.data() + GetSection(bytes, MESH_SECTION_LODS)->offset);
+		lod->indexCount += 3;
+	}));
+	CHECK(!corrupt([](std::vector<char>& bytes) {
+		MeshVertexFormat* format = (MeshVertexFormat*)(bytes.data() + GetSection(bytes, MESH_SECTION_VERTEX_FORMAT)->offset);
+		format->stride += 4;
+	}));
+}
+
+TEST(LoadBenchmark) {
+	// Opening the cooked file against parsing and welding the text it was cooked from.
+	MeshData grid = TestMeshes::MakeGrid(128);
+	std::string source = TestFramework::GetTempFilename("large.txt");
+	std::string cooked = TestFramework::GetTempFilename("large.mesh");
+	CHECK(TestMeshes::WriteTextModel(source.c_str(), TestMeshes::MakeSoup(grid)));
+	CHECK(MeshFileClass::Write(cooked.c_str(), Cook(grid, true)));
+
+	double parse = TestFramework::Benchmark("parse and weld text model", 3, [&]() {
+		MeshData mesh;
+		ModelParserClass parser;
+		CHECK(parser.Parse(source.c_str(), mesh));
+		MeshWelderClass::Weld(mesh);
+	});
+	double map = TestFramework::Benchmark("map cooked mesh", 20, [&]() {
+		MeshFileClass file(cooked.c_str());
+		CHECK(file.isInitialized);
+	});
+	printf("  %zu vertices, %zu indices, mapped %.0fx faster\n", grid.vertices.size(), grid.indices.size(), parse / map);
+	CHECK(map < parse);
+}
@@ -0,0 +1,235 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <math.h>
+#include "meshcookerclass.hpp"
+#include "meshletclass.hpp"
+
+namespace {
+	// A perspective camera at eye looking down +z, in the row vector convention of DirectXMath's LookAtLH and
+	// PerspectiveFovLH, the way CameraClass and D3DClass build theirs.
+	struct Camera {
+		float eye[3];
+		float matrix[16];
+
+		Camera(float x, float y, float z, float fieldOfView, float screenNear = 0.1f, float screenDepth = 100.0f) : eye{ x, y, z } {
+			float scale = 1.0f / tanf(fieldOfView * 0.5f);
+			float range = screenDepth / (screenDepth - screenNear);
+			const float view[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, -x, -y, -z, 1 };
+			const float projection[16] = { scale, 0, 0, 0, 0, scale, 0, 0, 0, 0, range, 1, 0, 0, -screenNear * range, 0 };
+			for (int row = 0; row < 4; row++) {
+				for (int column = 0; column < 4; column++) {
+					float sum = 0.0f;
+					for (int k = 0; k < 4; k++) { sum += view[row * 4 + k] * projection[k * 4 + column]; }
+					matrix[row * 4 + column] = sum;
+				}
+			}
+		}
+
+		MeshletFrustum GetFrustum() const { return MeshletFrustum::FromMatrix(matrix, eye); }
+
+		bool Contains(const float* p) const {
+			float clip[4];
+			for (int column = 0; column < 4; column++) { clip[column] = p[0] * matrix[column] + p[1] * matrix[4 + column] + p[2] * matrix[8 + column] + matrix[12 + column]; }
+			return fabsf(clip[0]) < clip[3] && fabsf(clip[1]) < clip[3] && clip[2] > 0.0f && clip[2] < clip[3];
+		}
+
+		bool Faces(const MeshData& mesh, size_t triangle) const {
+			const float* a = mesh.vertices[mesh.indices[triangle]].Position();
+			const float* b = mesh.vertices[mesh.indices[triangle + 1]].Position();
+			const float* c = mesh.vertices[mesh.indices[triangle + 2]].Position();
+			float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			float n[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			return n[0] * (eye[0] - a[0]) + n[1] * (eye[1] - a[1]) + n[2] * (eye[2] - a[2]) > 0.0f;
+		}
+	};
+
+	MeshData MakeOptimizedSphere(uint32_t rings, uint32_t segments) {
+		const float center[3] = { 0.0f, 0.0f, 0.0f };
+		MeshData mesh = TestMeshes::MakeSphere(rings, segments, 1.0f, center);
+		MeshOptimizerClass::Optimize(mesh, true);
+		return mesh;
+	}
+
+	std::vector<bool> GetDrawn(const std::vector<IndexRange>& visible, size_t indexCount) {
+		std::vector<bool> drawn(indexCount / 3, false);
+		for (const IndexRange& range : visible) {
+			for (uint32_t i = range.start; i < range.start + range.count; i += 3) { drawn[i / 3] = true; }
+		}
+		return drawn;
+	}
+}
+
+TEST(Limits) {
+	MeshData mesh = MakeOptimizedSphere(48, 96);
+	for (uint32_t limits : { 0u, 1u, 2u }) {
+		uint32_t maxVertices = limits == 0 ? MeshletClass::MAX_VERTICES : limits == 1 ? 16 : 3;
+		uint32_t maxTriangles = limits == 0 ? MeshletClass::MAX_TRIANGLES : limits == 1 ? 32 : 1;
+		std::vector<Meshlet> meshlets = MeshletClass::Build(mesh, 0, mesh.indices.size(), maxVertices, maxTriangles);
+
+		// The meshlets cover the indices one after another, within both limits, the spheres holding every vertex.
+		bool covered = true, withinLimits = true, bounded = true;
+		uint32_t next = 0;
+		for (const Meshlet& meshlet : meshlets) {
+			covered = covered && meshlet.indexStart == next && meshlet.indexCount > 0 && meshlet.indexCount % 3 == 0;
+			next = meshlet.indexStart + meshlet.indexCount;
+
+			std::vector<unsigned int> unique(mesh.indices.begin() + meshlet.indexStart, mesh.indices.begin() + next);
+			std::sort(unique.begin(), unique.end());
+			unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+			withinLimits = withinLimits && meshlet.vertexCount == unique.size() && meshlet.vertexCount <= maxVertices && meshlet.indexCount / 3 <= maxTriangles;
+			for (unsigned int index : unique) {
+				const float* p = mesh.vertices[index].Position();
+				float x = p[0] - meshlet.center[0], y = p[1] - meshlet.center[1], z = p[2] - meshlet.center[2];
+				bounded = bounded && sqrtf(x * x + y * y + z * z) <= meshlet.radius * 1.0001f + 1e-6f;
+			}
+		}
+		printf("  %u vertices, %u triangles: %zu meshlets for %zu triangles\n", maxVertices, maxTriangles, meshlets.size(), mesh.indices.size() / 3);
+		CHECK(covered && next == mesh.indices.size());
+		CHECK(withinLimits);
+		CHECK(bounded);
+	}
+
+	// A part of the index buffer, and limits no triangle fits in.
+	std::vector<Meshlet> part = MeshletClass::Build(mesh, 300, 600);
+	CHECK(!part.empty() && part.front().indexStart == 300 && part.back().indexStart + part.back().indexCount == 900);
+	CHECK(MeshletClass::Build(mesh, 0, mesh.indices.size(), 2, 10).empty());
+	CHECK(MeshletClass::Build(mesh, 0, mesh.indices.size(), 64, 0).empty());
+}
+
+TEST(Cones) {
+	// A flat patch has a cone of no width around its facing, a whole sphere one that culls nothing.
+	MeshData flat;
+	const float corners[4][3] = { { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 }, { 1, 1, 0 } };
+	for (const auto& corner : corners) {
+		MeshVertex vertex;
+		for (int k = 0; k < 3; k++) { vertex.Position()[k] = corner[k]; }
+		flat.vertices.push_back(vertex);
+	}
+	flat.indices = { 0, 1, 2, 1, 3, 2 };
+	Meshlet patch = MeshletClass::Build(flat, 0, flat.indices.size())[0];
+	CHECK(patch.coneAxis[2] == -1.0f && patch.coneCutoff == 0.0f);
+
+	const float center[3] = { 0.0f, 0.0f, 0.0f };
+	MeshData sphere = TestMeshes::MakeSphere(8, 16, 1.0f, center);
+	CHECK(MeshletClass::Build(sphere, 0, sphere.indices.size(), 256, 256)[0].coneCutoff == 1.0f);
+}
+
+TEST(BackfaceCulling) {
+	// Seen from outside, the meshlets on the far side of the sphere go, every triangle facing the camera stays.
+	MeshData mesh = MakeOptimizedSphere(64, 128);
+	std::vector<Meshlet> meshlets = MeshletClass::Build(mesh, 0, mesh.indices.size());
+	Camera camera(0.3f, 0.5f, -4.0f, 1.5f);
+	std::vector<IndexRange> visible;
+	MeshletCullStats stats = MeshletClass::Cull(meshlets.data(), meshlets.size(), camera.GetFrustum(), visible);
+	std::vector<bool> drawn = GetDrawn(visible, mesh.indices.size());
+
+	size_t facing = 0, drawnTriangles = 0;
+	bool conservative = true;
+	for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+		bool faces = camera.Faces(mesh, i);
+		facing += faces;
+		drawnTriangles += drawn[i / 3];
+		conservative = conservative && (drawn[i / 3] || !faces);
+	}
+	printf("  %zu meshlets, %zu back face culled, %zu draws: %zu of %zu triangles drawn, %zu facing the camera\n", stats.tested,
+		stats.backfaceCulled, stats.drawCalls, drawnTriangles, drawn.size(), facing);
+	CHECK(stats.tested == meshlets.size() && stats.frustumCulled == 0);
+	CHECK(stats.backfaceCulled > meshlets.size() / 4);
+	CHECK(stats.drawCalls == visible.size() && stats.drawCalls <= meshlets.size() - stats.backfaceCulled);
+	CHECK(conservative);
+}
+
+TEST(FrustumCulling) {
+	// A wide grid facing a camera that sees a twenty-fifth of it. Every triangle with a corner inside stays.
+	MeshData mesh = TestMeshes::MakeGrid(200);
+	for (MeshVertex& vertex : mesh.vertices) {
+		vertex.Position()[0] = vertex.Position()[0] * 50.0f - 25.0f;
+		vertex.Position()[1] = vertex.Position()[1] * 50.0f - 25.0f;
+	}
+	MeshOptimizerClass::Optimize(mesh, false);
+	std::vector<Meshlet> meshlets = MeshletClass::Build(mesh, 0, mesh.indices.size());
+	Camera camera(2.0f, -3.0f, -5.0f, 1.5707963f);
+	std::vector<IndexRange> visible;
+	MeshletCullStats stats = MeshletClass::Cull(meshlets.data(), meshlets.size(), camera.GetFrustum(), visible);
+	std::vector<bool> drawn = GetDrawn(visible, mesh.indices.size());
+
+	size_t inside = 0, drawnTriangles = 0;
+	bool conservative = true;
+	for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+		bool contained = false;
+		for (int k = 0; k < 3; k++) { contained = contained || camera.Contains(mesh.vertices[mesh.indices[i + k]].Position()); }
+		inside += contained;
+		drawnTriangles += drawn[i / 3];
+		conservative = conservative && (drawn[i / 3] || !contained);
+	}
+	printf("  %zu meshlets, %zu frustum culled, %zu draws: %zu of %zu triangles drawn, %zu inside\n", stats.tested,
+		stats.frustumCulled, stats.drawCalls, drawnTriangles, drawn.size(), inside);
+	CHECK(stats.frustumCulled > meshlets.size() / 2);
+	CHECK(drawnTriangles < drawn.size() / 2);
+	CHECK(conservative);
+
+	// Behind the camera everything goes.
+	visible.clear();
+	stats = MeshletClass::Cull(meshlets.data(), meshlets.size(), Camera(0.0f, 0.0f, 5.0f, 1.5707963f).GetFrustum(), visible);
+	CHECK(stats.frustumCulled == meshlets.size() && visible.empty() && stats.drawCalls == 0);
+}
+
+TEST(MergedDraws) {
+	// With nothing culled the ranges join into one draw, appended after what the list already held.
+	MeshData mesh = TestMeshes::MakeGrid(64);
+	std::vector<Meshlet> meshlets = MeshletClass::Build(mesh, 0, mesh.indices.size());
+	Camera camera(0.5f, 0.5f, -50.0f, 1.5f);
+	std::vector<IndexRange> visible = { { 7, 3 } };
+	MeshletCullStats stats = MeshletClass::Cull(meshlets.data(), meshlets.size(), camera.GetFrustum(), visible);
+	CHECK(meshlets.size() > 1 && stats.frustumCulled == 0 && stats.backfaceCulled == 0);
+	CHECK(stats.drawCalls == 1 && visible.size() == 2);
+	CHECK(visible[1].start == 0 && visible[1].count == mesh.indices.size());
+}
+
+TEST(CookKey) {
+	MeshCookSettings settings;
+	uint32_t key = MeshCookerClass::GetCookKey(settings);
+	MeshCookSettings other = settings;
+	other.reduceOverdraw = !other.reduceOverdraw;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	other = settings;
+	other.maxMeshletVertices = 32;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	other = settings;
+	other.maxMeshletTriangles = 64;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	CHECK(key != 0 && MeshCookerClass::GetCookKey(settings) == key);
+}
+
+TEST(MeshletBenchmark) {
+	MeshData mesh = MakeOptimizedSphere(256, 512);
+	std::vector<Meshlet> meshlets;
+	double build = TestFramework::Benchmark("build meshlets 256x512 sphere", 3, [&]() {
+		meshlets = MeshletClass::Build(mesh, 0, mesh.indices.size());
+	});
+
+	// A camera sweeping past the sphere, half of the meshlets facing away and some outside the view.
+	std::vector<IndexRange> visible;
+	MeshletCullStats total;
+	const int frames = 100;
+	double cull = TestFramework::Benchmark("cull 100 frames", 3, [&]() {
+		total = MeshletCullStats();
+		for (int frame = 0; frame < frames; frame++) {
+			float angle = 6.2831853f * frame / frames;
+			Camera camera(sinf(angle) * 1.5f, 0.2f, -2.5f, 0.8f);
+			MeshletFrustum frustum = camera.GetFrustum();
+			visible.clear();
+			MeshletCullStats stats = MeshletClass::Cull(meshlets.data(), meshlets.size(), frustum, visible);
+			total.tested += stats.tested;
+			total.frustumCulled += stats.frustumCulled;
+			total.backfaceCulled += stats.backfaceCulled;
+			total.drawCalls += stats.drawCalls;
+		}
+	});
+	printf("  %zu triangles in %zu meshlets, %.1f M triangles/s built, %.0f M meshlets/s culled\n", mesh.indices.size() / 3, meshlets.size(),
+		mesh.indices.size() / 3 / build / 1000.0, total.tested / cull / 1000.0);
+	printf("  a frame: %.1f%% frustum culled, %.1f%% back face culled, %.0f draws\n", 100.0 * total.frustumCulled / total.tested,
+		100.0 * total.backfaceCulled / total.tested, (double)total.drawCalls / frames);
+	CHECK(total.backfaceCulled > 0);
+}
@@ -0,0 +1,148 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <float.h>
+#include <random>
+#include "meshoptimizerclass.hpp"
+
+namespace {
+	// Pixels shaded per pixel covered, looking at the mesh along each axis both ways with orthographic cameras, back
+	// faces culled and a depth test before shading. 1 when no pixel was shaded twice.
+	float MeasureOverdraw(const MeshData& mesh, int resolution = 64) {
+		size_t shaded = 0, covered = 0;
+		for (int axis = 0; axis < 3; axis++) {
+			int u = (axis + 1) % 3, v = (axis + 2) % 3;
+			float scale[2] = { resolution / (mesh.bounds.maximum[u] - mesh.bounds.minimum[u]), resolution / (mesh.bounds.maximum[v] - mesh.bounds.minimum[v]) };
+			for (float direction : { -1.0f, 1.0f }) {
+				std::vector<float> depth((size_t)resolution * resolution, FLT_MAX);
+				for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+					const float* p[3] = { mesh.vertices[mesh.indices[i]].Position(), mesh.vertices[mesh.indices[i + 1]].Position(), mesh.vertices[mesh.indices[i + 2]].Position() };
+					float ab[3], ac[3];
+					for (int k = 0; k < 3; k++) {
+						ab[k] = p[1][k] - p[0][k];
+						ac[k] = p[2][k] - p[0][k];
+					}
+					float facing = ab[(axis + 1) % 3] * ac[(axis + 2) % 3] - ab[(axis + 2) % 3] * ac[(axis + 1) % 3];	// The cross product along the axis.
+					if (facing * direction >= 0.0f) { continue; }
+
+					float x[3], y[3], z[3];
+					for (int k = 0; k < 3; k++) {
+						x[k] = (p[k][u] - mesh.bounds.minimum[u]) * scale[0];
+						y[k] = (p[k][v] - mesh.bounds.minimum[v]) * scale[1];
+						z[k] = p[k][axis] * direction;
+					}
+					float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+					int x0 = std::max(0, (int)std::min({ x[0], x[1], x[2] })), x1 = std::min(resolution - 1, (int)std::max({ x[0], x[1], x[2] }));
+					int y0 = std::max(0, (int)std::min({ y[0], y[1], y[2] })), y1 = std::min(resolution - 1, (int)std::max({ y[0], y[1], y[2] }));
+					for (int py = y0; py <= y1; py++) {
+						for (int px = x0; px <= x1; px++) {
+							float cx = px + 0.5f, cy = py + 0.5f;
+							float w0 = ((x[2] - x[1]) * (cy - y[1]) - (y[2] - y[1]) * (cx - x[1])) / area;
+							float w1 = ((x[0] - x[2]) * (cy - y[2]) - (y[0] - y[2]) * (cx - x[2])) / area;
+							float w2 = 1.0f - w0 - w1;
+							if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) { continue; }
+							float d = w0 * z[0] + w1 * z[1] + w2 * z[2];
+							float& stored = depth[(size_t)py * resolution + px];
+							if (d < stored) {
+								stored = d;
+								shaded++;
+							}
+						}
+					}
+				}
+				for (float d : depth) { covered += d != FLT_MAX; }
+			}
+		}
+		return covered ? (float)shaded / covered : 0.0f;
+	}
+
+	MeshData Shuffle(MeshData mesh) {
+		std::vector<std::array<unsigned int, 3>> triangles;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) { triangles.push_back({ mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] }); }
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+		mesh.indices.clear();
+		for (const auto& triangle : triangles) { mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end()); }
+		return mesh;
+	}
+}
+
+TEST(TinyIndexLists) {
+	CHECK(MeshOptimizerClass::AnalyzeCache({}, 3).acmr == 0.0f);
+	CHECK(MeshOptimizerClass::AnalyzeCache({ 0, 1 }, 3).acmr == 0.0f);	// No whole triangle.
+	MeshCacheStats single = MeshOptimizerClass::AnalyzeCache({ 0, 1, 2 }, 3);
+	CHECK(single.acmr == 3.0f && single.atvr == 1.0f);
+
+	MeshData mesh = TestMeshes::MakeGrid(1);
+	mesh.indices = { 0, 1 };
+	MeshOptimizeStats stats = MeshOptimizerClass::Optimize(mesh, true);
+	CHECK(mesh.indices.empty() && mesh.vertices.empty());
+	CHECK(stats.before.acmr == 0.0f && stats.after.acmr == 0.0f && stats.clusters == 0);
+}
+
+TEST(DropsDegenerateTriangles) {
+	MeshData grid = TestMeshes::MakeGrid(4);
+	MeshData mesh = grid;
+	mesh.indices.insert(mesh.indices.end(), { 0, 0, 1, 2, 3, 2, 4, 4, 4 });
+	MeshOptimizerClass::Optimize(mesh, false);
+	CHECK(TestMeshes::GetTriangles(mesh) == TestMeshes::GetTriangles(grid));
+}
+
+TEST(ShuffledGrid) {
+	MeshData grid = TestMeshes::MakeGrid(100);
+	MeshData mesh = Shuffle(grid);
+	MeshOptimizeStats stats = MeshOptimizerClass::Optimize(mesh, false);
+	printf("  ACMR %.3f to %.3f, ATVR %.3f to %.3f\n", stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr);
+	CHECK(stats.before.acmr > 2.5f);
+	CHECK(stats.after.acmr < 0.7f);
+	CHECK(stats.after.atvr < 1.4f);
+	CHECK(TestMeshes::GetTriangles(mesh) == TestMeshes::GetTriangles(grid));
+}
+
+TEST(VertexFetchOrder) {
+	// Vertices end up in the order the indices first use them, the unused one is dropped.
+	MeshData mesh = Shuffle(TestMeshes::MakeGrid(16));
+	mesh.vertices.push_back(MeshVertex());
+	size_t used = mesh.vertices.size() - 1;
+	MeshOptimizerClass::Optimize(mesh, true);
+	CHECK(mesh.vertices.size() == used);
+	unsigned int next = 0;
+	bool firstUseOrder = true;
+	for (unsigned int index : mesh.indices) {
+		firstUseOrder = firstUseOrder && index <= next;
+		if (index == next) { next++; }
+	}
+	CHECK(firstUseOrder && next == used);
+}
+
+TEST(OverdrawClusters) {
+	// A sphere inside another, the inner one first. Drawing the outer one first hides the inner one behind it.
+	const float center[3] = { 0.0f, 0.0f, 0.0f };
+	MeshData mesh = TestMeshes::MakeSphere(24, 48, 0.5f, center);
+	MeshData outer = TestMeshes::MakeSphere(24, 48, 1.0f, center);
+	for (unsigned int index : outer.indices) { mesh.indices.push_back(index + (unsigned int)mesh.vertices.size()); }
+	mesh.vertices.insert(mesh.vertices.end(), outer.vertices.begin(), outer.vertices.end());
+	mesh.bounds = outer.bounds;
+
+	MeshData cacheOnly = mesh;
+	MeshOptimizeStats cacheStats = MeshOptimizerClass::Optimize(cacheOnly, false);
+	MeshData sorted = mesh;
+	MeshOptimizeStats sortedStats = MeshOptimizerClass::Optimize(sorted, true);
+
+	float original = MeasureOverdraw(mesh), cacheOverdraw = MeasureOverdraw(cacheOnly), sortedOverdraw = MeasureOverdraw(sorted);
+	printf("  overdraw %.3f in file order, %.3f cache order, %.3f with %zu sorted clusters\n", original, cacheOverdraw, sortedOverdraw, sortedStats.clusters);
+	printf("  ACMR %.3f cache order, %.3f with sorted clusters\n", cacheStats.after.acmr, sortedStats.after.acmr);
+	CHECK(original > 1.2f);	// The inner sphere covers a quarter of the outer one, shaded twice when it comes first.
+	CHECK(sortedStats.clusters > 1);
+	CHECK(sortedOverdraw < original && sortedOverdraw < cacheOverdraw && sortedOverdraw < 1.01f);
+	CHECK(sortedStats.after.acmr <= cacheStats.after.acmr * 1.05f);	// Clusters split where the cache starts over.
+	CHECK(TestMeshes::GetTriangles(sorted) == TestMeshes::GetTriangles(mesh));
+}
+
+TEST(OptimizeBenchmark) {
+	MeshData grid = Shuffle(TestMeshes::MakeGrid(256));
+	size_t triangles = grid.indices.size() / 3;
+	double milliseconds = TestFramework::Benchmark("optimize shuffled 256x256 grid", 3, [&]() {
+		MeshData mesh = grid;
+		MeshOptimizerClass::Optimize(mesh, true);
+	});
+	printf("  %zu triangles, %.1f M triangles/s\n", triangles, triangles / milliseconds / 1000.0);
+}
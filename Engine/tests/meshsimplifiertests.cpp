@@ -0,0 +1,245 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <math.h>
+#include <string.h>
+#include <map>
+#include "meshcookerclass.hpp"
+#include "meshsimplifierclass.hpp"
+
+namespace {
+	MeshData MakeUnitSphere(uint32_t rings, uint32_t segments) {
+		const float center[3] = { 0.0f, 0.0f, 0.0f };
+		return TestMeshes::MakeSphere(rings, segments, 1.0f, center);
+	}
+
+	// A flat grid, with the texture coordinates squared when curved so they stop being linear over the triangles.
+	MeshData MakeFlatGrid(uint32_t quads, bool curved) {
+		MeshData mesh = TestMeshes::MakeGrid(quads);
+		for (MeshVertex& vertex : mesh.vertices) {
+			vertex.Position()[2] = 0.0f;
+			vertex.Normal()[0] = vertex.Normal()[1] = 0.0f;
+			vertex.Normal()[2] = -1.0f;
+			if (curved) { vertex.Texcoord()[0] *= vertex.Texcoord()[0]; }
+		}
+		return mesh;
+	}
+
+	// Six times the enclosed volume, from the tetrahedra every triangle makes with the origin.
+	double GetVolume(const MeshData& mesh, const unsigned int* indices, size_t indexCount) {
+		double volume = 0.0;
+		for (size_t i = 0; i + 2 < indexCount; i += 3) {
+			const float* a = mesh.vertices[indices[i]].Position();
+			const float* b = mesh.vertices[indices[i + 1]].Position();
+			const float* c = mesh.vertices[indices[i + 2]].Position();
+			volume += (double)a[0] * (b[1] * c[2] - b[2] * c[1]) - (double)a[1] * (b[0] * c[2] - b[2] * c[0]) + (double)a[2] * (b[0] * c[1] - b[1] * c[0]);
+		}
+		return volume;
+	}
+
+	// Edges between positions that no triangle runs the other way, zero when the surface is closed across the seams.
+	size_t CountOpenEdges(const MeshData& mesh, const std::vector<unsigned int>& indices) {
+		typedef std::array<float, 3> Position;
+		auto position = [&](unsigned int i) { const float* p = mesh.vertices[i].Position(); return Position{ p[0], p[1], p[2] }; };
+		std::map<std::pair<Position, Position>, int> open;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				Position a = position(indices[i + k]), b = position(indices[i + (k + 1) % 3]);
+				if (a == b) { continue; }
+				auto reverse = open.find({ b, a });
+				if (reverse == open.end()) { open[{ a, b }]++; }
+				else if (--reverse->second == 0) { open.erase(reverse); }
+			}
+		}
+		size_t count = 0;
+		for (const auto& edge : open) { count += edge.second; }
+		return count;
+	}
+
+	// Every index in range, no triangle repeating a vertex, and on a sphere around the origin none folded inwards. Three
+	// neighbours on the locked seam may end up in one triangle standing edge on, its normal square to the way out.
+	bool IsValid(const MeshData& mesh, const unsigned int* indices, size_t indexCount, bool sphere) {
+		if (indexCount % 3 != 0) { return false; }
+		for (size_t i = 0; i < indexCount; i += 3) {
+			unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+			if (a >= mesh.vertices.size() || b >= mesh.vertices.size() || c >= mesh.vertices.size()) { return false; }
+			if (a == b || b == c || a == c) { return false; }
+			if (!sphere) { continue; }
+
+			const float* p[3] = { mesh.vertices[a].Position(), mesh.vertices[b].Position(), mesh.vertices[c].Position() };
+			float ab[3], ac[3], centroid[3];
+			for (int k = 0; k < 3; k++) {
+				ab[k] = p[1][k] - p[0][k];
+				ac[k] = p[2][k] - p[0][k];
+				centroid[k] = p[0][k] + p[1][k] + p[2][k];
+			}
+			float n[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+			float lengths = sqrtf((n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * (centroid[0] * centroid[0] + centroid[1] * centroid[1] + centroid[2] * centroid[2]));
+			if (n[0] * centroid[0] + n[1] * centroid[1] + n[2] * centroid[2] < -0.001f * lengths) { return false; }
+		}
+		return true;
+	}
+}
+
+TEST(SimplifySphere) {
+	MeshData mesh = MakeUnitSphere(64, 128);
+	MeshSimplifySettings settings;
+	double volume = GetVolume(mesh, mesh.indices.data(), mesh.indices.size());
+	for (size_t divisor : { 4, 16 }) {
+		size_t target = mesh.indices.size() / divisor / 3 * 3;
+		float error = 0.0f;
+		std::vector<unsigned int> indices = MeshSimplifierClass::Simplify(mesh, target, 1.0f, settings, error);
+		double simplified = GetVolume(mesh, indices.data(), indices.size());
+		printf("  %zu of %zu triangles, error %.4f, volume %.2f%% of the original\n", indices.size() / 3, mesh.indices.size() / 3, error, 100.0 * simplified / volume);
+		CHECK(indices.size() <= target && indices.size() > target / 2);
+		CHECK(IsValid(mesh, indices.data(), indices.size(), true));
+		CHECK(error > 0.0f && error < 0.2f);	// A tenth of the extent.
+		CHECK(simplified < volume && simplified > volume * 0.9);	// Collapses onto the surface only cut corners off.
+	}
+
+	// Nothing to do leaves the indices as they were.
+	float error = 1.0f;
+	CHECK(MeshSimplifierClass::Simplify(mesh, mesh.indices.size(), 1.0f, settings, error) == mesh.indices && error == 0.0f);
+}
+
+TEST(MaxError) {
+	// The error limit stops the collapses before the target, a looser limit lets more of them through.
+	MeshData mesh = MakeUnitSphere(64, 128);
+	MeshSimplifySettings settings;
+	size_t previous = mesh.indices.size();
+	float previousError = 0.0f;
+	for (float maxError : { 0.005f, 0.02f, 0.08f }) {
+		float error = 0.0f;
+		std::vector<unsigned int> indices = MeshSimplifierClass::Simplify(mesh, 0, maxError, settings, error);
+		float extent = mesh.bounds.maximum[0] - mesh.bounds.minimum[0];
+		printf("  max error %.3f: %zu triangles, error %.4f\n", maxError, indices.size() / 3, error);
+		CHECK(error <= maxError * extent * 1.0001f && error >= previousError);
+		CHECK(indices.size() < previous && indices.size() > 0);
+		CHECK(IsValid(mesh, indices.data(), indices.size(), true));
+		previous = indices.size();
+		previousError = error;
+	}
+}
+
+TEST(FlatGrid) {
+	// A flat grid with linear texture coordinates loses no shape however far it goes, its outline stays.
+	MeshData mesh = MakeFlatGrid(32, false);
+	MeshSimplifySettings settings;
+	float error = 1.0f;
+	std::vector<unsigned int> indices = MeshSimplifierClass::Simplify(mesh, 0, 0.001f, settings, error);
+	printf("  flat: %zu of %zu triangles, error %g\n", indices.size() / 3, mesh.indices.size() / 3, error);
+	CHECK(indices.size() * 20 < mesh.indices.size());
+	CHECK(error < 1e-4f && IsValid(mesh, indices.data(), indices.size(), false));
+
+	double area = 0.0;
+	bool corners[4] = {};
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const float* a = mesh.vertices[indices[i]].Position();
+		const float* b = mesh.vertices[indices[i + 1]].Position();
+		const float* c = mesh.vertices[indices[i + 2]].Position();
+		area += 0.5 * ((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]));
+		for (int k = 0; k < 3; k++) {
+			const float* p = mesh.vertices[indices[i + k]].Position();
+			if ((p[0] == 0.0f || p[0] == 1.0f) && (p[1] == 0.0f || p[1] == 1.0f)) { corners[(p[0] == 1.0f) + (p[1] == 1.0f) * 2] = true; }
+		}
+	}
+	CHECK(fabs(fabs(area) - 1.0) < 1e-5);	// Covers the square without folds.
+	CHECK(corners[0] && corners[1] && corners[2] && corners[3]);
+}
+
+TEST(AttributeError) {
+	// Texture coordinates that curve over a flat grid hold collapses back, unless they are given no weight.
+	MeshData mesh = MakeFlatGrid(32, true);
+	MeshSimplifySettings weighted;
+	MeshSimplifySettings unweighted;
+	unweighted.texcoordWeight = 0.0f;
+	float weightedError = 0.0f, unweightedError = 0.0f;
+	std::vector<unsigned int> kept = MeshSimplifierClass::Simplify(mesh, 0, 0.001f, weighted, weightedError);
+	std::vector<unsigned int> collapsed = MeshSimplifierClass::Simplify(mesh, 0, 0.001f, unweighted, unweightedError);
+	printf("  curved texture coordinates: %zu triangles weighted, %zu without weight\n", kept.size() / 3, collapsed.size() / 3);
+	CHECK(kept.size() > collapsed.size() * 4);
+	CHECK(weightedError <= 0.001f && unweightedError < 1e-4f);
+}
+
+TEST(Watertight) {
+	// The sphere's texture seam and poles repeat positions, those vertices stay put so no crack opens however far it goes.
+	MeshData mesh = MakeUnitSphere(32, 64);
+	MeshSimplifySettings settings;
+	for (size_t divisor : { 1, 2, 8, 32 }) {
+		float error = 0.0f;
+		std::vector<unsigned int> indices = MeshSimplifierClass::Simplify(mesh, mesh.indices.size() / divisor / 3 * 3, 1.0f, settings, error);
+		CHECK(CountOpenEdges(mesh, indices) == 0);
+	}
+}
+
+TEST(LodChain) {
+	MeshData mesh = MakeUnitSphere(64, 128);
+	std::vector<MeshVertex> vertices = mesh.vertices;
+	size_t fullDetail = mesh.indices.size();
+	MeshSimplifySettings settings;
+	settings.lodCount = 5;
+	std::vector<MeshLod> lods = MeshSimplifierClass::BuildLods(mesh, settings);
+
+	// Level 0 is the mesh as it was, every further one appended after it, smaller and coarser than the one before.
+	CHECK(lods.size() > 2 && lods.size() <= settings.lodCount);
+	CHECK(lods[0].indexStart == 0 && lods[0].indexCount == fullDetail && lods[0].error == 0.0f);
+	bool chained = true;
+	for (size_t i = 1; i < lods.size(); i++) {
+		const MeshLod& lod = lods[i];
+		printf("  level %zu: %u triangles, error %.4f\n", i, lod.indexCount / 3, lod.error);
+		chained = chained && lod.indexStart == lods[i - 1].indexStart + lods[i - 1].indexCount;
+		chained = chained && lod.indexCount * 10 <= lods[i - 1].indexCount * 9 && lod.error >= lods[i - 1].error;
+		chained = chained && IsValid(mesh, &mesh.indices[lod.indexStart], lod.indexCount, true);
+		chained = chained && lod.error <= settings.maxError * 2.0f;
+	}
+	CHECK(chained);
+	CHECK(mesh.indices.size() == lods.back().indexStart + lods.back().indexCount);
+	CHECK(mesh.vertices.size() == vertices.size() && memcmp(mesh.vertices.data(), vertices.data(), vertices.size() * sizeof(MeshVertex)) == 0);
+
+	// One level, or nothing to simplify, is the mesh alone.
+	MeshData single = MakeUnitSphere(8, 16);
+	settings.lodCount = 1;
+	CHECK(MeshSimplifierClass::BuildLods(single, settings).size() == 1 && single.indices.size() == MakeUnitSphere(8, 16).indices.size());
+	MeshData empty;
+	settings.lodCount = 4;
+	CHECK(MeshSimplifierClass::BuildLods(empty, settings).size() == 1);
+}
+
+TEST(CookKey) {
+	MeshCookSettings settings;
+	uint32_t key = MeshCookerClass::GetCookKey(settings);
+	MeshCookSettings other = settings;
+	other.lods.lodCount = 2;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	other = settings;
+	other.lods.reduction = 0.25f;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	other = settings;
+	other.lods.maxError = 0.1f;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	other = settings;
+	other.lods.texcoordWeight = 2.0f;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+	other = settings;
+	other.lods.normalWeight = 0.0f;
+	CHECK(MeshCookerClass::GetCookKey(other) != key);
+}
+
+TEST(SimplifyBenchmark) {
+	// The levels of BuildLods against simplifying the same levels one after another.
+	MeshData sphere = MakeUnitSphere(128, 256);
+	MeshSimplifySettings settings;
+	double parallel = TestFramework::Benchmark("build 3 levels on their own threads", 2, [&]() {
+		MeshData mesh = sphere;
+		MeshSimplifierClass::BuildLods(mesh, settings);
+	});
+	double serial = TestFramework::Benchmark("simplify 3 levels in turn", 2, [&]() {
+		size_t target = sphere.indices.size();
+		for (uint32_t level = 1; level < settings.lodCount; level++) {
+			target /= 2;
+			float error = 0.0f;
+			MeshSimplifierClass::Simplify(sphere, target / 3 * 3, settings.maxError, settings, error);
+		}
+	});
+	printf("  %zu triangles, %.1f M triangles/s in parallel, %.1f in turn\n", sphere.indices.size() / 3,
+		sphere.indices.size() / 3 / parallel / 1000.0, sphere.indices.size() / 3 / serial / 1000.0);
+}
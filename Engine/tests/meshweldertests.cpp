@@ -0,0 +1,111 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <math.h>
+#include "meshoptimizerclass.hpp"
+#include "meshwelderclass.hpp"
+
+namespace {
+	// The 36 corners of a cube with a normal and texture coordinates per face, the way data/cube.txt has it.
+	MeshData MakeCube() {
+		MeshData mesh;
+		for (int axis = 0; axis < 3; axis++) {
+			for (float side : { -1.0f, 1.0f }) {
+				const float corners[6][2] = { { -1, 1 }, { 1, 1 }, { -1, -1 }, { -1, -1 }, { 1, 1 }, { 1, -1 } };
+				for (const float* corner : corners) {
+					MeshVertex vertex;
+					vertex.Position()[axis] = side;
+					vertex.Position()[(axis + 1) % 3] = corner[0];
+					vertex.Position()[(axis + 2) % 3] = corner[1];
+					vertex.Texcoord()[0] = (corner[0] + 1.0f) * 0.5f;
+					vertex.Texcoord()[1] = (1.0f - corner[1]) * 0.5f;
+					vertex.Normal()[0] = vertex.Normal()[1] = vertex.Normal()[2] = 0.0f;
+					vertex.Normal()[axis] = side;
+					mesh.indices.push_back((unsigned int)mesh.vertices.size());
+					mesh.vertices.push_back(vertex);
+				}
+			}
+		}
+		return mesh;
+	}
+}
+
+TEST(WeldCube) {
+	MeshData mesh = MakeCube();
+	MeshWeldStats stats = MeshWelderClass::Weld(mesh);
+	CHECK(stats.verticesBefore == 36 && stats.verticesAfter == 24);	// Four corners a face.
+	CHECK(mesh.vertices.size() == 24 && mesh.indices.size() == 36);
+	CHECK(stats.bytesBefore == 36 * sizeof(MeshVertex) + 36 * 4);
+	CHECK(stats.bytesAfter == 24 * sizeof(MeshVertex) + 36 * 2);
+	CHECK(stats.BytesSaved() == stats.bytesBefore - stats.bytesAfter);
+	CHECK(TestMeshes::GetTriangles(mesh) == TestMeshes::GetTriangles(MakeCube()));
+}
+
+TEST(WeldGrid) {
+	MeshData grid = TestMeshes::MakeGrid(16);
+	MeshData soup = TestMeshes::MakeSoup(grid);
+	MeshData welded = soup;
+	MeshWeldStats stats = MeshWelderClass::Weld(welded);
+	CHECK(stats.verticesBefore == soup.vertices.size() && stats.verticesAfter == grid.vertices.size());
+	bool sameCorners = welded.indices.size() == soup.indices.size();
+	for (size_t i = 0; sameCorners && i < soup.indices.size(); i++) {
+		sameCorners = TestMeshes::SameVertex(welded.vertices[welded.indices[i]], soup.vertices[soup.indices[i]]);
+	}
+	CHECK(sameCorners);
+
+	// Welding again finds nothing left to merge.
+	stats = MeshWelderClass::Weld(welded);
+	CHECK(stats.verticesAfter == stats.verticesBefore);
+}
+
+TEST(WeldBitPatterns) {
+	// Signed zeros weld, any difference in an attribute keeps vertices apart, equal NaNs weld.
+	MeshData mesh;
+	mesh.vertices.resize(6);
+	mesh.vertices[1].Position()[0] = -0.0f;
+	mesh.vertices[2].Normal()[2] = -0.999f;
+	mesh.vertices[3].Texcoord()[1] = 1e-30f;
+	mesh.vertices[4].Position()[1] = NAN;
+	mesh.vertices[5].Position()[1] = NAN;
+	mesh.indices = { 0, 1, 2, 3, 4, 5 };
+	MeshWeldStats stats = MeshWelderClass::Weld(mesh);
+	CHECK(stats.verticesAfter == 4);
+	CHECK(mesh.indices[0] == mesh.indices[1] && mesh.indices[4] == mesh.indices[5]);
+	CHECK(mesh.indices[2] != mesh.indices[0] && mesh.indices[3] != mesh.indices[0]);
+}
+
+TEST(IndexStride) {
+	CHECK(MeshWelderClass::IndexStride(0) == 2);
+	CHECK(MeshWelderClass::IndexStride(0x10000) == 2);	// Index 65535 is the last one 16 bits hold.
+	CHECK(MeshWelderClass::IndexStride(0x10001) == 4);
+}
+
+TEST(CacheMissRatios) {
+	// Unwelded every corner is a miss, welding brings that down, the cache order further.
+	MeshData grid = TestMeshes::MakeGrid(64);
+	MeshData mesh = TestMeshes::MakeSoup(grid);
+	CHECK_NEAR(MeshOptimizerClass::AnalyzeCache(mesh.indices, mesh.vertices.size()).acmr, 3.0f, 1e-6f);
+
+	MeshWelderClass::Weld(mesh);
+	MeshCacheStats welded = MeshOptimizerClass::AnalyzeCache(mesh.indices, mesh.vertices.size());
+	MeshOptimizeStats stats = MeshOptimizerClass::Optimize(mesh, false);
+	MeshCacheStats optimized = MeshOptimizerClass::AnalyzeCache(mesh.indices, mesh.vertices.size());
+	printf("  ACMR unwelded 3.000, welded %.3f, optimized %.3f, ATVR %.3f to %.3f\n", welded.acmr, optimized.acmr, welded.atvr, optimized.atvr);
+	CHECK(stats.before.acmr == welded.acmr && stats.after.acmr == optimized.acmr);
+	CHECK(welded.acmr < 1.5f);
+	CHECK(optimized.acmr < welded.acmr && optimized.acmr < 0.8f);
+	CHECK(optimized.atvr < welded.atvr && optimized.atvr < 1.5f);
+	CHECK(TestMeshes::GetTriangles(mesh) == TestMeshes::GetTriangles(grid));
+}
+
+TEST(WeldBenchmark) {
+	MeshData soup = TestMeshes::MakeSoup(TestMeshes::MakeGrid(256));
+	size_t corners = soup.vertices.size();
+	double milliseconds = TestFramework::Benchmark("copy and weld 256x256 grid", 3, [&]() {
+		MeshData mesh = soup;
+		MeshWelderClass::Weld(mesh);
+	});
+	MeshWeldStats stats = MeshWelderClass::Weld(soup);
+	printf("  %zu corners to %zu vertices, %.1f M corners/s, %zu of %zu bytes saved\n", corners, stats.verticesAfter,
+		corners / milliseconds / 1000.0, stats.BytesSaved(), stats.bytesBefore);
+	CHECK(stats.verticesAfter == 257 * 257);
+}
@@ -0,0 +1,259 @@
+#include "testframework.hpp"
+#include "testimages.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include "mipgeneratorclass.hpp"
+
+namespace {
+	double SrgbToLinear(double value) { return value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4); }
+	double LinearToSrgb(double linear) { return linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055; }
+
+	// The 2x2 average, in double precision where sRGB needs it. The last row and column of odd sizes dropped as GenerateMips does.
+	std::vector<unsigned char> ReferenceBox(const unsigned char* image, int width, int height, bool srgb) {
+		int destinationWidth = std::max(1, width / 2), destinationHeight = std::max(1, height / 2);
+		std::vector<unsigned char> result((size_t)destinationWidth * destinationHeight * 4);
+		for (int y = 0; y < destinationHeight; y++) {
+			for (int x = 0; x < destinationWidth; x++) {
+				const int xs[2] = { std::min(2 * x, width - 1), std::min(2 * x + 1, width - 1) };
+				const int ys[2] = { std::min(2 * y, height - 1), std::min(2 * y + 1, height - 1) };
+				for (int channel = 0; channel < 4; channel++) {
+					int bytes = 0;
+					double linear = 0.0;
+					for (int sy : ys) {
+						for (int sx : xs) {
+							unsigned char byte = image[((size_t)sy * width + sx) * 4 + channel];
+							bytes += byte;
+							linear += SrgbToLinear(byte / 255.0);
+						}
+					}
+					// Without a conversion halves are exact, and round up.
+					unsigned char& out = result[((size_t)y * destinationWidth + x) * 4 + channel];
+					out = srgb && channel < 3 ? (unsigned char)floor(LinearToSrgb(linear / 4.0) * 255.0 + 0.5) : (unsigned char)((bytes + 2) / 4);
+				}
+			}
+		}
+		return result;
+	}
+
+	int MaxDifference(const unsigned char* a, const unsigned char* b, size_t count, size_t* differing = 0) {
+		int largest = 0;
+		for (size_t i = 0; i < count; i++) {
+			int difference = abs(a[i] - b[i]);
+			largest = std::max(largest, difference);
+			if (differing && difference) { (*differing)++; }
+		}
+		return largest;
+	}
+
+	bool IsConstant(const unsigned char* pixels, size_t count, const unsigned char* color) {
+		for (size_t i = 0; i < count; i++) {
+			if (memcmp(pixels + i * 4, color, 4) != 0) { return false; }
+		}
+		return true;
+	}
+}
+
+TEST(BoxMatchesReference) {
+	// Random bytes hit every table entry, the odd sizes the clamped last row and column.
+	size_t differing = 0, total = 0;
+	int largest = 0;
+	for (bool srgb : { false, true }) {
+		for (int size : { 2, 7, 64, 129 }) {
+			std::vector<unsigned char> image = TestImages::RandomBytes((size_t)size * (size + 3) * 4, (unsigned)size);
+			std::vector<unsigned char> expected = ReferenceBox(image.data(), size, size + 3, srgb);
+			std::vector<unsigned char> result(expected.size());
+			MipGeneratorClass::Downsample(image.data(), size, size + 3, result.data(), MIP_FILTER_BOX, srgb);
+			largest = std::max(largest, MaxDifference(result.data(), expected.data(), result.size(), &differing));
+			total += result.size();
+		}
+	}
+	printf("  %zu of %zu bytes one off the double precision reference\n", differing, total);
+	CHECK(largest <= 1 && differing * 1000 < total);
+
+	// Black and white average to half the light, which is 188 in sRGB and not the 128 of averaging the bytes.
+	const unsigned char checker[16] = { 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 0, 0 };
+	unsigned char average[4];
+	MipGeneratorClass::Downsample(checker, 2, 2, average, MIP_FILTER_BOX, true);
+	CHECK(average[0] == 188 && average[1] == 188 && average[2] == 188 && average[3] == 128);
+	MipGeneratorClass::Downsample(checker, 2, 2, average, MIP_FILTER_BOX, false);
+	CHECK(average[0] == 128 && average[3] == 128);
+
+	// Every sRGB byte makes it through the tables and back.
+	std::vector<unsigned char> ramp(256 * 2 * 4);
+	for (size_t i = 0; i < ramp.size(); i++) { ramp[i] = (unsigned char)(i / 8); }
+	std::vector<unsigned char> same(256 * 4);
+	MipGeneratorClass::Downsample(ramp.data(), 512, 1, same.data(), MIP_FILTER_BOX, true);
+	bool lossless = true;
+	for (size_t i = 0; i < same.size(); i++) { lossless = lossless && same[i] == i / 4; }
+	CHECK(lossless);
+}
+
+TEST(NonPowerOfTwoChains) {
+	std::vector<MipLevel> levels = MipGeneratorClass::GetLevels(5, 3);
+	CHECK(levels.size() == 3 && levels[1].width == 2 && levels[1].height == 1 && levels[2].width == 1 && levels[2].height == 1);
+	CHECK(levels[1].offset == 5 * 3 * 4 && levels[2].offset == levels[1].offset + 2 * 4);
+	CHECK(MipGeneratorClass::GetChainSize(5, 3) == (5 * 3 + 2 + 1) * 4);
+	CHECK(MipGeneratorClass::GetLevels(1, 1).size() == 1 && MipGeneratorClass::GetChainSize(1, 1) == 4);
+	levels = MipGeneratorClass::GetLevels(1, 9);
+	CHECK(levels.size() == 4 && levels[1].height == 4 && levels[2].height == 2 && levels[3].height == 1 && levels[3].width == 1);
+	CHECK(MipGeneratorClass::GetLevels(1000, 7).size() == 10 && MipGeneratorClass::GetLevels(4096, 4096).size() == 13);
+
+	// Each level is the reference box of the one above, whatever the sizes along the way.
+	const int sizes[][2] = { { 37, 23 }, { 1, 17 }, { 300, 1 }, { 129, 127 } };
+	for (bool srgb : { false, true }) {
+		for (const int* size : sizes) {
+			std::vector<unsigned char> chain(MipGeneratorClass::GetChainSize(size[0], size[1]));
+			std::vector<unsigned char> image = TestImages::MakePhoto(size[0], size[1], 4, 2);
+			std::copy(image.begin(), image.end(), chain.begin());
+			MipGeneratorClass::Generate(chain.data(), size[0], size[1], MIP_FILTER_BOX, srgb);
+			levels = MipGeneratorClass::GetLevels(size[0], size[1]);
+			int largest = 0;
+			for (size_t i = 1; i < levels.size(); i++) {
+				const MipLevel& above = levels[i - 1];
+				std::vector<unsigned char> expected = ReferenceBox(chain.data() + above.offset, above.width, above.height, srgb);
+				largest = std::max(largest, MaxDifference(chain.data() + levels[i].offset, expected.data(), expected.size()));
+			}
+			CHECK(largest <= 1);
+		}
+	}
+
+	// A flat color stays exactly that all the way down, with either filter.
+	const unsigned char color[4] = { 200, 30, 90, 77 };
+	for (MipFilter filter : { MIP_FILTER_BOX, MIP_FILTER_KAISER }) {
+		for (bool srgb : { false, true }) {
+			std::vector<unsigned char> chain(MipGeneratorClass::GetChainSize(45, 19));
+			for (size_t i = 0; i < 45 * 19; i++) { memcpy(&chain[i * 4], color, 4); }
+			MipGeneratorClass::Generate(chain.data(), 45, 19, filter, srgb);
+			CHECK(IsConstant(chain.data(), chain.size() / 4, color));
+		}
+		std::vector<float> floats(MipGeneratorClass::GetChainSize(45, 19));
+		for (size_t i = 0; i < 45 * 19 * 4; i++) { floats[i] = 2.5f; }
+		MipGeneratorClass::Generate(floats.data(), 45, 19, filter);
+		bool flat = true;
+		for (float value : floats) { flat = flat && fabsf(value - 2.5f) < 1e-5f; }
+		CHECK(flat);
+	}
+}
+
+TEST(KaiserFilter) {
+	// Weights summing to 1 keep any flat value, right up to the clamped edges.
+	for (float value : { 0.125f, 1.0f, 37.0f }) {
+		std::vector<float> flat(33 * 20 * 4, value), half(16 * 10 * 4);
+		MipGeneratorClass::Downsample(flat.data(), 33, 20, half.data(), MIP_FILTER_KAISER);
+		float largest = 0.0f;
+		for (float result : half) { largest = std::max(largest, fabsf(result - value)); }
+		CHECK(largest <= value * 1e-5f);
+	}
+
+	// Symmetric weights: the mirrored image gives the mirrored result, edges included as both sides clamp alike.
+	const int width = 48, height = 12;
+	std::vector<float> image(width * height * 4), mirrored(image.size());
+	for (size_t i = 0; i < image.size(); i++) { image[i] = (float)TestImages::RandomBytes(1, (unsigned)i + 1)[0]; }
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			for (int channel = 0; channel < 4; channel++) { mirrored[(y * width + width - 1 - x) * 4 + channel] = image[(y * width + x) * 4 + channel]; }
+		}
+	}
+	std::vector<float> result(width / 2 * height / 2 * 4), mirroredResult(result.size());
+	MipGeneratorClass::Downsample(image.data(), width, height, result.data(), MIP_FILTER_KAISER);
+	MipGeneratorClass::Downsample(mirrored.data(), width, height, mirroredResult.data(), MIP_FILTER_KAISER);
+	float largest = 0.0f;
+	for (int y = 0; y < height / 2; y++) {
+		for (int x = 0; x < width / 2; x++) {
+			for (int channel = 0; channel < 4; channel++) {
+				float a = result[(y * width / 2 + x) * 4 + channel], b = mirroredResult[(y * width / 2 + width / 2 - 1 - x) * 4 + channel];
+				largest = std::max(largest, fabsf(a - b));
+			}
+		}
+	}
+	CHECK(largest < 1e-3f);
+
+	// Sharper: stripes repeating every 16 texels keep more of their contrast two levels down than the box leaves them.
+	auto contrast = [](MipFilter filter) {
+		const int size = 256;
+		std::vector<unsigned char> chain(MipGeneratorClass::GetChainSize(size, size));
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				unsigned char value = (unsigned char)(127.5 + 127.5 * sin(2.0 * 3.14159265358979 * x / 16.0));
+				unsigned char* texel = &chain[((size_t)y * size + x) * 4];
+				texel[0] = texel[1] = texel[2] = value, texel[3] = 255;
+			}
+		}
+		MipGeneratorClass::Generate(chain.data(), size, size, filter, false);
+		const MipLevel level = MipGeneratorClass::GetLevels(size, size)[2];
+		int lowest = 255, highest = 0;
+		for (int x = 0; x < level.width; x++) {
+			int value = chain[level.offset + ((size_t)level.height / 2 * level.width + x) * 4];
+			lowest = std::min(lowest, value), highest = std::max(highest, value);
+		}
+		return highest - lowest;
+	};
+	int box = contrast(MIP_FILTER_BOX), kaiser = contrast(MIP_FILTER_KAISER);
+	printf("  contrast of 16 texel stripes two levels down: box %d, Kaiser %d of 255\n", box, kaiser);
+	CHECK(kaiser > box + 10);
+
+	// Ringing: the negative lobes next to a bright line would go below zero, floats and bytes both stop there.
+	std::vector<float> line(32 * 32 * 4, 0.0f), lineResult(16 * 16 * 4);
+	for (int y = 0; y < 32; y++) {
+		for (int channel = 0; channel < 4; channel++) { line[(y * 32 + 16) * 4 + channel] = 100.0f; }
+	}
+	MipGeneratorClass::Downsample(line.data(), 32, 32, lineResult.data(), MIP_FILTER_KAISER);
+	float lowest = 0.0f, brightest = 0.0f;
+	int zeros = 0;
+	for (float value : lineResult) {
+		lowest = std::min(lowest, value), brightest = std::max(brightest, value);
+		zeros += value == 0.0f;
+	}
+	CHECK(lowest == 0.0f && brightest > 40.0f && zeros > 0);
+	std::vector<unsigned char> bytes(32 * 32 * 4, 0), bytesResult(16 * 16 * 4);
+	for (int y = 0; y < 32; y++) { memset(&bytes[(y * 32 + 16) * 4], 255, 4); }
+	MipGeneratorClass::Downsample(bytes.data(), 32, 32, bytesResult.data(), MIP_FILTER_KAISER, true);
+	const unsigned char* row = &bytesResult[8 * 16 * 4];
+	CHECK(row[8 * 4] > 128 && row[7 * 4] > 64 && row[6 * 4] == 0 && row[9 * 4] == 0);
+}
+
+TEST(ParallelChains) {
+	// Bands only split the rows, every texel is computed the same way on any thread, so the chains match bit for bit.
+	ThreadPoolClass pool(4);
+	const int width = 517, height = 300;
+	std::vector<unsigned char> image = TestImages::MakePhoto(width, height, 4, 5);
+	for (MipFilter filter : { MIP_FILTER_BOX, MIP_FILTER_KAISER }) {
+		for (bool srgb : { false, true }) {
+			std::vector<unsigned char> serial(MipGeneratorClass::GetChainSize(width, height)), parallel(serial.size());
+			std::copy(image.begin(), image.end(), serial.begin());
+			std::copy(image.begin(), image.end(), parallel.begin());
+			MipGeneratorClass::Generate(serial.data(), width, height, filter, srgb);
+			MipGeneratorClass::Generate(parallel.data(), width, height, filter, srgb, &pool);
+			CHECK(serial == parallel);
+		}
+		std::vector<float> serial(MipGeneratorClass::GetChainSize(width, height)), parallel(serial.size());
+		for (size_t i = 0; i < image.size(); i++) { serial[i] = parallel[i] = image[i] / 16.0f; }
+		MipGeneratorClass::Generate(serial.data(), width, height, filter);
+		MipGeneratorClass::Generate(parallel.data(), width, height, filter, &pool);
+		CHECK(memcmp(serial.data(), parallel.data(), serial.size() * sizeof(float)) == 0);
+	}
+}
+
+TEST(MipBenchmark) {
+	// Timings only, how much the pool gains depends on the cores of the machine.
+	const int size = 2048;
+	std::vector<unsigned char> image = TestImages::MakePhoto(size, size, 4, 6);
+	std::vector<unsigned char> chain(MipGeneratorClass::GetChainSize(size, size));
+	std::copy(image.begin(), image.end(), chain.begin());
+	ThreadPoolClass pool;
+	printf("  %zu pool threads\n", pool.GetThreadCount());
+	double box = TestFramework::Benchmark("box sRGB chain 2048x2048", 3, [&]() { MipGeneratorClass::Generate(chain.data(), size, size, MIP_FILTER_BOX, true); });
+	double boxPool = TestFramework::Benchmark("box sRGB chain 2048x2048, pool", 3, [&]() {
+		MipGeneratorClass::Generate(chain.data(), size, size, MIP_FILTER_BOX, true, &pool);
+	});
+	double kaiser = TestFramework::Benchmark("Kaiser sRGB chain 2048x2048", 3, [&]() {
+		MipGeneratorClass::Generate(chain.data(), size, size, MIP_FILTER_KAISER, true);
+	});
+	double kaiserPool = TestFramework::Benchmark("Kaiser sRGB chain 2048x2048, pool", 3, [&]() {
+		MipGeneratorClass::Generate(chain.data(), size, size, MIP_FILTER_KAISER, true, &pool);
+	});
+	double megapixels = size * size / 1e6;
+	printf("  box %.0f / %.0f MP/s, Kaiser %.0f / %.0f MP/s serial / pool\n", megapixels / box * 1000.0, megapixels / boxPool * 1000.0,
+		megapixels / kaiser * 1000.0, megapixels / kaiserPool * 1000.0);
+	CHECK(std::equal(image.begin(), image.end(), chain.begin()));
+}
@@ -0,0 +1,10 @@
+#pragma once
+// Stand-in for the Windows SDK header, see d3d11.h.
+#include "d3d11.h"
+
+struct ID3D11DeviceContext1 : ID3D11DeviceContext {
+	virtual void VSSetConstantBuffers1(UINT StartSlot, UINT NumBuffers, ID3D11Buffer* const* ppConstantBuffers, const UINT* pFirstConstant,
+		const UINT* pNumConstants) = 0;
+};
+
+inline constexpr IID IID_ID3D11DeviceContext1 = { 0xbb2c6faa, 0xb5fb, 0x4082, { 0x8e, 0x6b, 0x38, 0x8b, 0x8c, 0xfa, 0x90, 0xe1 } };
@@ -0,0 +1,114 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <fstream>
+#include "modelparserclass.hpp"
+
+namespace {
+	// The loop ModelClass::LoadModel used before the parser, with end of file checks so a bad header fails instead of
+	// spinning forever.
+	bool ReferenceParse(const char* filename, std::vector<MeshVertex>& vertices) {
+		std::ifstream fin(filename);
+		if (fin.fail()) { return false; }
+
+		char input = 0;
+		while (fin.get(input) && input != ':') {}
+		int vertexCount = 0;
+		fin >> vertexCount;
+		while (fin.get(input) && input != ':') {}
+		if (fin.fail() || vertexCount < 0) { return false; }
+
+		vertices.resize(vertexCount);
+		for (MeshVertex& v : vertices) {
+			fin >> v.Position()[0] >> v.Position()[1] >> v.Position()[2];
+			fin >> v.Texcoord()[0] >> v.Texcoord()[1];
+			fin >> v.Normal()[0] >> v.Normal()[1] >> v.Normal()[2];
+		}
+		return !fin.fail();
+	}
+
+	std::string WriteText(const char* name, const std::string& text) {
+		std::string filename = TestFramework::GetTempFilename(name);
+		std::ofstream(filename, std::ios::binary) << text;
+		return filename;
+	}
+
+	bool MatchesReference(const std::string& filename, size_t vertexCount) {
+		MeshData mesh;
+		ModelParserClass parser;
+		std::vector<MeshVertex> reference;
+		if (!parser.Parse(filename.c_str(), mesh) || !ReferenceParse(filename.c_str(), reference)) { return false; }
+		if (mesh.vertices.size() != vertexCount || reference.size() != vertexCount || mesh.indices.size() != vertexCount) { return false; }
+		for (size_t i = 0; i < vertexCount; i++) {
+			if (!TestMeshes::SameVertex(mesh.vertices[i], reference[i]) || mesh.indices[i] != i) { return false; }
+		}
+		return true;
+	}
+
+	// The error of parsing text, empty when it parsed.
+	std::string ParseError(const std::string& text) {
+		MeshData mesh;
+		ModelParserClass parser;
+		std::string filename = WriteText("error.txt", text);
+		if (parser.Parse(filename.c_str(), mesh)) { return ""; }
+		return parser.GetError().substr(filename.size());
+	}
+}
+
+TEST(SmallModel) {
+	MeshData grid = TestMeshes::MakeGrid(8);
+	std::string filename = TestFramework::GetTempFilename("grid.txt");
+	CHECK(TestMeshes::WriteTextModel(filename.c_str(), TestMeshes::MakeSoup(grid)));
+	CHECK(MatchesReference(filename, grid.indices.size()));
+}
+
+TEST(NumberForms) {
+	// Tabs, carriage returns, blank rows, exponents, signs and no newline at the end.
+	std::string text = "Vertex Count: 3\r\n\r\nData:\r\n\r\n"
+		"-1.0\t1.0 -1.0 0.0 0.0 0.0 0.0 -1.0\r\n"
+		"\r\n"
+		"  1e-3 -.5 +2 1.5E2 0.25 -0 3.4028234e38 1.17549435e-38\r\n"
+		"0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8";
+	CHECK(MatchesReference(WriteText("forms.txt", text), 3));
+}
+
+TEST(LargeModel) {
+	// Big enough to be split across every thread, timed against the old loop.
+	MeshData grid = TestMeshes::MakeGrid(160);
+	std::string filename = TestFramework::GetTempFilename("large.txt");
+	CHECK(TestMeshes::WriteTextModel(filename.c_str(), TestMeshes::MakeSoup(grid)));
+	CHECK(MatchesReference(filename, grid.indices.size()));
+
+	std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+	double megabytes = (double)fin.tellg() / (1 << 20);
+	double reference = TestFramework::Benchmark("iostream loop", 2, [&]() {
+		std::vector<MeshVertex> vertices;
+		ReferenceParse(filename.c_str(), vertices);
+	});
+	double parallel = TestFramework::Benchmark("parallel from_chars parser", 5, [&]() {
+		MeshData mesh;
+		ModelParserClass parser;
+		parser.Parse(filename.c_str(), mesh);
+	});
+	printf("  %.1f MB, %zu rows: %.0f MB/s against %.0f MB/s\n", megabytes, grid.indices.size(), megabytes * 1000.0 / parallel, megabytes * 1000.0 / reference);
+	CHECK(parallel < reference);
+}
+
+TEST(Errors) {
+	const char* row = "0 0 0 0 0 0 0 1\n";
+	CHECK(ParseError("Vertex Count: 1\n\nData:\n\n" + std::string(row)).empty());
+	CHECK(ParseError("") == "(1): expected 'Vertex Count:'");
+	CHECK(ParseError("Vertex Count 1\n\nData:\n\n" + std::string(row)) == "(1): expected 'Vertex Count:'");	// The old loop spun here.
+	CHECK(ParseError("Vertex Count: many\n") == "(1): expected a vertex count after 'Vertex Count:'");
+	CHECK(ParseError("Vertex Count: 1\n\nData: 0\n") == "(3): unexpected text after 'Data:'");
+	CHECK(ParseError("Vertex Count: 2\n\nData:\n\n" + std::string(row)) == "(6): the header declares 2 vertices but the data section has 1 rows");
+	CHECK(ParseError("Vertex Count: 2\n\nData:\n\n" + std::string(row) + "0 0 x 0 0 0 0 1\n") == "(6): invalid number 'x'");
+	CHECK(ParseError("Vertex Count: 1\n\nData:\n\n0 0 0 0 0 0 1\n") == "(5): expected 8 values per row, found 7");
+	CHECK(ParseError("Vertex Count: 1\n\nData:\n\n0 0 0 0 0 0 0 1 2\n") == "(5): expected 8 values per row, found more");
+	CHECK(ParseError("Vertex Count: 1\n\nData:\n\n0 0 0 0 0 0 0 1,\n") == "(5): invalid number '1,'");
+	CHECK(ParseError("Vertex Count: 1\n\nData:\n\n0 0 0 0 0 0 0 +-1\n") == "(5): invalid number '+-1'");
+
+	MeshData mesh;
+	ModelParserClass parser;
+	std::string missing = TestFramework::GetTempFilename("missing.txt");
+	CHECK(!parser.Parse(missing.c_str(), mesh) && parser.GetError() == missing + ": could not read the file");
+}
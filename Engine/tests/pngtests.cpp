@@ -0,0 +1,385 @@
+#include "testframework.hpp"
+#include "testimages.hpp"
+#include <random>
+#include <sstream>
+#include <thread>
+#include "pngdecoderclass.hpp"
+#include "targadecoderclass.hpp"
+
+using namespace TestImages;
+
+namespace {
+	PngImage MakeImage(int width, int height, int colorType, int bitDepth, unsigned seed) {
+		PngImage image;
+		image.width = width;
+		image.height = height;
+		image.colorType = colorType;
+		image.bitDepth = bitDepth;
+		std::mt19937 random(seed);
+		image.samples.resize((size_t)width * height * GetChannels(colorType));
+		for (uint16_t& sample : image.samples) { sample = (uint16_t)(random() & ((1u << bitDepth) - 1)); }
+		if (colorType == 3) {
+			image.palette = RandomBytes(3 * (size_t)std::min(1 << bitDepth, 200), seed);	// 8 bit indices past the palette too.
+		}
+		return image;
+	}
+
+	// What the decoder should make of the samples, worked out pixel by pixel.
+	std::vector<unsigned char> Expected(const PngImage& image) {
+		int channels = GetChannels(image.colorType);
+		auto eight = [&image](unsigned sample) {
+			return (unsigned char)(image.bitDepth == 16 ? sample >> 8 : sample * 255 / ((1u << image.bitDepth) - 1));
+		};
+		auto key = [&image](int i) { return (unsigned)(image.transparency[i * 2] << 8 | image.transparency[i * 2 + 1]); };
+		std::vector<unsigned char> rgba((size_t)image.width * image.height * 4);
+		for (size_t pixel = 0; pixel < (size_t)image.width * image.height; pixel++) {
+			const uint16_t* s = &image.samples[pixel * channels];
+			unsigned char* out = &rgba[pixel * 4];
+			switch (image.colorType) {
+			case 0:
+				out[0] = out[1] = out[2] = eight(s[0]);
+				out[3] = !image.transparency.empty() && s[0] == key(0) ? 0 : 255;
+				break;
+			case 2:
+				for (int channel = 0; channel < 3; channel++) { out[channel] = eight(s[channel]); }
+				out[3] = !image.transparency.empty() && s[0] == key(0) && s[1] == key(1) && s[2] == key(2) ? 0 : 255;
+				break;
+			case 3:
+				if (s[0] < image.palette.size() / 3) {
+					memcpy(out, &image.palette[s[0] * 3], 3);
+					out[3] = s[0] < image.transparency.size() ? image.transparency[s[0]] : 255;
+				}
+				else {
+					out[0] = out[1] = out[2] = 0;
+					out[3] = 255;
+				}
+				break;
+			case 4:
+				out[0] = out[1] = out[2] = eight(s[0]);
+				out[3] = eight(s[1]);
+				break;
+			case 6:
+				for (int channel = 0; channel < 4; channel++) { out[channel] = eight(s[channel]); }
+				break;
+			}
+		}
+		return rgba;
+	}
+
+	bool Decode(const std::string& png, std::vector<unsigned char>& rgba, std::string& error) {
+		PngDecoderClass decoder((const unsigned char*)png.data(), png.size());
+		bool success = decoder.ReadHeader();
+		if (success) {
+			rgba.assign((size_t)decoder.GetWidth() * decoder.GetHeight() * 4, 0);
+			success = decoder.Decode(rgba.data());
+		}
+		error = decoder.errorMessage;
+		return success;
+	}
+
+	bool DecodesTo(const PngImage& image) {
+		std::vector<unsigned char> rgba;
+		std::string error;
+		return Decode(ToPng(image), rgba, error) && rgba == Expected(image);
+	}
+
+	struct Chunk {
+		std::string type;
+		std::string data;
+	};
+
+	std::vector<Chunk> Split(const std::string& png) {
+		std::vector<Chunk> chunks;
+		for (size_t position = 8; position + 12 <= png.size();) {
+			const unsigned char* p = (const unsigned char*)png.data() + position;
+			size_t length = (size_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+			chunks.push_back({ png.substr(position + 4, 4), png.substr(position + 8, length) });
+			position += length + 12;
+		}
+		return chunks;
+	}
+
+	// Writes the chunks back with fresh CRCs.
+	std::string Join(const std::vector<Chunk>& chunks) {
+		std::string png = "\x89PNG\r\n\x1A\n";
+		for (const Chunk& chunk : chunks) { AppendChunk(png, chunk.type.c_str(), chunk.data); }
+		return png;
+	}
+
+	std::string Error(const std::string& png) {
+		std::vector<unsigned char> rgba;
+		std::string error;
+		return Decode(png, rgba, error) ? "" : error;
+	}
+}
+
+TEST(Filters) {
+	// Each filter alone and all five in turn, on every color type and depth they go with. The widths leave partial
+	// pixels at the end of the SSE2 loads of the three and four byte paths.
+	for (int colorType : { 0, 2, 4, 6 }) {
+		for (int bitDepth : { 8, 16 }) {
+			for (int filter = -1; filter < 5; filter++) {
+				for (int width : { 1, 2, 7, 33 }) {
+					PngImage image = MakeImage(width, 9, colorType, bitDepth, (unsigned)(colorType * 100 + bitDepth + width));
+					image.filter = filter;
+					CHECK(DecodesTo(image));
+				}
+			}
+		}
+	}
+	// Smooth content, where Paeth picks each of its three predictors.
+	PngImage photo = MakeImage(64, 64, 6, 8, 1);
+	std::vector<unsigned char> pixels = MakePhoto(64, 64, 4, 1);
+	photo.samples.assign(pixels.begin(), pixels.end());
+	for (int filter = 0; filter < 5; filter++) {
+		photo.filter = filter;
+		CHECK(DecodesTo(photo));
+	}
+}
+
+TEST(LowBitDepths) {
+	// Rows of packed samples end partway through a byte at most widths.
+	for (int bitDepth : { 1, 2, 4, 8 }) {
+		for (int width = 1; width <= 17; width++) {
+			if (bitDepth < 8) { CHECK(DecodesTo(MakeImage(width, 5, 0, bitDepth, (unsigned)(width + bitDepth)))); }
+			PngImage palette = MakeImage(width, 5, 3, bitDepth, (unsigned)(width * bitDepth));
+			palette.transparency = RandomBytes(palette.palette.size() / 3 / 2 + 1, 3);
+			CHECK(DecodesTo(palette));
+		}
+	}
+}
+
+TEST(TransparentColor) {
+	for (int colorType : { 0, 2 }) {
+		for (int bitDepth : { 1, 8, 16 }) {
+			if (colorType == 2 && bitDepth == 1) { continue; }
+			PngImage image = MakeImage(19, 7, colorType, bitDepth, (unsigned)(colorType + bitDepth));
+			int channels = GetChannels(colorType);
+			// Every third pixel the key, so some match on all channels and others on only some of them.
+			uint16_t keys[3] = { (uint16_t)(image.samples[0]), (uint16_t)(image.samples[1 % channels]), (uint16_t)(image.samples[2 % channels]) };
+			for (size_t pixel = 0; pixel < image.samples.size() / channels; pixel += 3) {
+				for (int channel = 0; channel < channels; channel++) { image.samples[pixel * channels + channel] = keys[channel]; }
+			}
+			image.samples[3 * channels] ^= 1;
+			for (int channel = 0; channel < channels; channel++) {
+				image.transparency.push_back((unsigned char)(keys[channel] >> 8));
+				image.transparency.push_back((unsigned char)keys[channel]);
+			}
+			CHECK(DecodesTo(image));
+			std::vector<unsigned char> expected = Expected(image);
+			CHECK(expected[3] == 0 && expected[3 * 4 + 3] == 255);
+		}
+	}
+}
+
+TEST(Interlaced) {
+	// Sizes smaller than the Adam7 pattern leave some passes empty.
+	for (int width = 1; width <= 10; width++) {
+		for (int height = 1; height <= 10; height++) {
+			PngImage image = MakeImage(width, height, 6, 8, (unsigned)(width * 16 + height));
+			image.interlaced = true;
+			CHECK(DecodesTo(image));
+		}
+	}
+	for (int colorType : { 0, 2, 3, 4, 6 }) {
+		for (int bitDepth : { 1, 2, 4, 8, 16 }) {
+			bool valid = bitDepth == 8 || (bitDepth == 16 && colorType != 3) || (bitDepth < 8 && (colorType == 0 || colorType == 3));
+			if (!valid) { continue; }
+			PngImage image = MakeImage(37, 29, colorType, bitDepth, (unsigned)(colorType * 17 + bitDepth));
+			image.interlaced = true;
+			CHECK(DecodesTo(image));
+		}
+	}
+}
+
+TEST(ChunksAndCompression) {
+	// The image data split over many IDAT chunks, with every kind of DEFLATE block, and chunks the decoder skips.
+	PngImage image = MakeImage(45, 31, 2, 8, 5);
+	for (size_t idatSize : { 1, 7, 100 }) {
+		image.idatSize = idatSize;
+		CHECK(DecodesTo(image));
+	}
+	for (BlockType type : { BLOCK_STORED, BLOCK_FIXED, BLOCK_DYNAMIC }) {
+		image.compression = type;
+		CHECK(DecodesTo(image));
+	}
+	std::vector<Chunk> chunks = Split(ToPng(image));
+	chunks.insert(chunks.begin() + 1, { "tEXt", std::string("Comment\0made by hand", 20) });
+	chunks.insert(chunks.end() - 1, { "abCD", "anything" });
+	std::vector<unsigned char> rgba;
+	std::string error;
+	CHECK(Decode(Join(chunks), rgba, error) && rgba == Expected(image));
+}
+
+TEST(Errors) {
+	PngImage image = MakeImage(4, 4, 6, 8, 6);
+	std::string png = ToPng(image);
+	CHECK(Error("") == "not a PNG file" && Error(png.substr(1)) == "not a PNG file");
+	CHECK(PngDecoderClass::IsPng((const unsigned char*)png.data(), png.size()));
+
+	// Damage anywhere in a chunk or its CRC is caught.
+	std::string damaged = png;
+	damaged[8 + 8 + 3] ^= 1;	// The width.
+	CHECK(Error(damaged) == "bad CRC in IHDR chunk");
+	damaged = png;
+	damaged[png.size() - 12 - 5] ^= 0x40;	// The last byte of the image data.
+	CHECK(Error(damaged) == "bad CRC in IDAT chunk");
+	damaged = png;
+	damaged[png.size() - 1] ^= 1;
+	CHECK(Error(damaged) == "bad CRC in IEND chunk");
+
+	// Cut anywhere.
+	bool allFail = true;
+	for (size_t size = 0; size < png.size(); size++) { allFail = allFail && Error(png.substr(0, size)) != ""; }
+	CHECK(allFail);
+	CHECK(Error(png.substr(0, png.size() - 20)) == "unexpected end of file");
+
+	std::vector<Chunk> chunks = Split(png);
+	auto edited = [&chunks](size_t chunk, size_t offset, unsigned char value) {
+		std::vector<Chunk> copy = chunks;
+		copy[chunk].data[offset] = (char)value;
+		return Join(copy);
+	};
+	CHECK(Error(edited(0, 3, 0)) == "bad size 0x4");
+	CHECK(Error(edited(0, 4, 1)) == "bad size 4x16777220");
+	CHECK(Error(edited(0, 8, 3)) == "unsupported bit depth 3");
+	CHECK(Error(edited(0, 9, 5)) == "unsupported color type 5");
+	CHECK(Error(edited(0, 10, 1)) == "unsupported compression or filter method");
+	CHECK(Error(edited(0, 11, 1)) == "unsupported compression or filter method");
+	CHECK(Error(edited(0, 12, 2)) == "unsupported interlace method");
+	CHECK(Error(edited(0, 7, 5)) == "not enough image data");	// One row more than there is.
+	CHECK(Error(edited(0, 7, 3)) == "image data: more data than expected");
+
+	std::vector<Chunk> copy = chunks;
+	copy[0].data.pop_back();
+	CHECK(Error(Join(copy)) == "bad IHDR");
+	copy = chunks;
+	std::swap(copy[0], copy[1]);
+	CHECK(Error(Join(copy)) == "the first chunk must be IHDR");
+	copy = chunks;
+	copy.erase(copy.begin() + 1);
+	CHECK(Error(Join(copy)) == "no image data");
+	copy = chunks;
+	copy.insert(copy.begin() + 1, { "ABCD", "" });
+	CHECK(Error(Join(copy)) == "unsupported critical chunk ABCD");
+	copy = chunks;
+	copy.pop_back();
+	CHECK(Error(Join(copy)) == "unexpected end of file");	// No IEND.
+
+	PngImage filtered = image;
+	filtered.filter = 5;
+	CHECK(Error(ToPng(filtered)) == "bad filter type 5");
+	PngImage truncated = image;
+	truncated.compression = BLOCK_STORED;
+	chunks = Split(ToPng(truncated));
+	chunks[1].data[3] ^= 1;	// The stored block length, after the zlib header and the block header.
+	CHECK(Error(Join(chunks)) == "image data: bad stored block length");
+
+	PngImage palette = MakeImage(4, 4, 3, 8, 7);
+	chunks = Split(ToPng(palette));
+	copy = chunks;
+	copy.erase(copy.begin() + 1);
+	CHECK(Error(Join(copy)) == "missing palette");
+	copy = chunks;
+	copy[1].data.pop_back();
+	CHECK(Error(Join(copy)) == "bad palette");
+	copy = chunks;
+	copy.insert(copy.begin() + 2, { "tRNS", std::string(201, '\x80') });
+	CHECK(Error(Join(copy)) == "bad transparency");
+	PngImage gray = MakeImage(4, 4, 0, 8, 8);
+	gray.transparency = { 0, 1, 2 };
+	CHECK(Error(ToPng(gray)) == "bad transparency");
+
+	PngDecoderClass decoder((const unsigned char*)png.data(), png.size());
+	std::vector<unsigned char> rgba(64);
+	CHECK(!decoder.Decode(rgba.data()) && decoder.errorMessage == "the header was not read");
+}
+
+TEST(Fuzz) {
+	// Damaged files fail or decode, they never read or write out of bounds. The CRCs are fixed up after the damage
+	// so that most of it reaches the inflate and unfiltering. Run under a sanitizer to be sure.
+	std::vector<std::string> files;
+	for (int colorType : { 2, 3, 6 }) {
+		PngImage image = MakeImage(13, 11, colorType, 8, (unsigned)colorType);
+		files.push_back(ToPng(image));
+		image.interlaced = true;
+		image.compression = BLOCK_FIXED;
+		files.push_back(ToPng(image));
+	}
+	std::mt19937 random(9);
+	int decoded = 0, failed = 0;
+	std::vector<unsigned char> rgba;
+	std::string error;
+	for (int i = 0; i < 4000; i++) {
+		std::vector<Chunk> chunks = Split(files[random() % files.size()]);
+		for (int flips = 1 + random() % 3; flips > 0; flips--) {
+			Chunk& chunk = chunks[random() % chunks.size()];
+			if (!chunk.data.empty()) { chunk.data[random() % chunk.data.size()] ^= (char)(1 << random() % 8); }
+		}
+		std::string png = Join(chunks);
+		if (random() % 4 == 0) { png.resize(random() % png.size()); }
+		Decode(png, rgba, error) ? decoded++ : failed++;
+	}
+	printf("  %d damaged files decoded, %d failed\n", decoded, failed);
+	CHECK(decoded > 0 && failed > 0);
+}
+
+TEST(ConcurrentDecodes) {
+	// Decoders share nothing, so independent images decode side by side.
+	std::vector<PngImage> images;
+	std::vector<std::string> files;
+	for (int i = 0; i < 4; i++) {
+		images.push_back(MakeImage(200 + i, 150, i % 2 ? 6 : 2, 8, (unsigned)i));
+		images.back().interlaced = i >= 2;
+		files.push_back(ToPng(images.back()));
+	}
+	std::vector<int> matches(files.size(), 0);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < files.size(); i++) {
+		threads.emplace_back([&, i]() {
+			std::vector<unsigned char> rgba;
+			std::string error;
+			std::vector<unsigned char> expected = Expected(images[i]);
+			for (int repeat = 0; repeat < 10; repeat++) { matches[i] += Decode(files[i], rgba, error) && rgba == expected; }
+		});
+	}
+	for (std::thread& thread : threads) { thread.join(); }
+	CHECK(matches == std::vector<int>(files.size(), 10));
+}
+
+TEST(PngBenchmark) {
+	// The same picture as PNG and as the uncompressed and run length encoded TGA the engine read before.
+	const int width = 1024, height = 1024;
+	std::vector<unsigned char> pixels = MakePhoto(width, height, 4, 10);
+	double megabytes = pixels.size() / 1e6;
+
+	PngImage image;
+	image.width = width;
+	image.height = height;
+	image.samples.assign(pixels.begin(), pixels.end());
+	image.filter = 4;
+	std::string png = ToPng(image);
+
+	std::string tga(18, '\0');
+	tga[2] = 2;
+	tga[12] = (char)(width & 0xFF), tga[13] = (char)(width >> 8);
+	tga[14] = (char)(height & 0xFF), tga[15] = (char)(height >> 8);
+	tga[16] = 32;
+	tga[17] = 0x28;	// Top down, 8 alpha bits.
+	for (size_t i = 0; i < pixels.size(); i += 4) { tga += { (char)pixels[i + 2], (char)pixels[i + 1], (char)pixels[i], (char)pixels[i + 3] }; }
+
+	std::vector<unsigned char> rgba(pixels.size());
+	bool pngMatches = true, tgaMatches = true;
+	double pngTime = TestFramework::Benchmark("PNG decode 1024x1024", 5, [&]() {
+		PngDecoderClass decoder((const unsigned char*)png.data(), png.size());
+		pngMatches = pngMatches && decoder.ReadHeader() && decoder.Decode(rgba.data()) && rgba == pixels;
+	});
+	double tgaTime = TestFramework::Benchmark("TGA decode 1024x1024", 5, [&]() {
+		std::istringstream stream(tga);
+		TargaDecoderClass decoder(stream);
+		tgaMatches = tgaMatches && decoder.ReadHeader() && decoder.Decode(rgba.data()) && rgba == pixels;
+	});
+	printf("  PNG %.0f MB/s from a %.0f%% file, TGA %.0f MB/s\n", megabytes / pngTime * 1000.0, 100.0 * png.size() / tga.size(),
+		megabytes / tgaTime * 1000.0);
+	CHECK(pngMatches && tgaMatches);
+}
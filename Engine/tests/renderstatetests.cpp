@@ -0,0 +1,316 @@
+#include "testframework.hpp"
+#include "testdevice.hpp"
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "renderstateclass.hpp"
+#include "stateobjectcacheclass.hpp"
+
+using namespace TestDevice;
+
+namespace {
+	// Objects to bind, never handed to anything that would release them.
+	template <class Interface> Interface* Fake() {
+		static FakeObject<Interface> objects[4];
+		static int next = 0;
+		return &objects[next++ % 4];
+	}
+
+	D3D11_DEPTH_STENCIL_DESC MakeDepthStencilDesc(unsigned char garbage, D3D11_COMPARISON_FUNC func) {
+		// The padding after the stencil masks holds whatever the stack did, as it does for a description filled in
+		// member by member.
+		D3D11_DEPTH_STENCIL_DESC desc;
+		memset(&desc, garbage, sizeof(desc));
+		desc.DepthEnable = 1;
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+		desc.DepthFunc = func;
+		desc.StencilEnable = 0;
+		desc.StencilReadMask = 0xFF;
+		desc.StencilWriteMask = 0xFF;
+		desc.FrontFace = { D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_INCR, D3D11_STENCIL_OP_KEEP, D3D11_COMPARISON_ALWAYS };
+		desc.BackFace = { D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_DECR, D3D11_STENCIL_OP_KEEP, D3D11_COMPARISON_ALWAYS };
+		return desc;
+	}
+
+	D3D11_BLEND_DESC MakeBlendDesc(unsigned char garbage, bool blend) {
+		D3D11_BLEND_DESC desc;
+		memset(&desc, garbage, sizeof(desc));
+		desc.AlphaToCoverageEnable = 0;
+		desc.IndependentBlendEnable = 0;
+		for (D3D11_RENDER_TARGET_BLEND_DESC& target : desc.RenderTarget) {
+			target.BlendEnable = blend;
+			target.SrcBlend = D3D11_BLEND_SRC_ALPHA;
+			target.DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+			target.BlendOp = D3D11_BLEND_OP_ADD;
+			target.SrcBlendAlpha = D3D11_BLEND_ONE;
+			target.DestBlendAlpha = D3D11_BLEND_ZERO;
+			target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+			target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+		}
+		return desc;
+	}
+
+	D3D11_SAMPLER_DESC MakeSamplerDesc(UINT anisotropy) {
+		D3D11_SAMPLER_DESC desc{};
+		desc.Filter = anisotropy > 1 ? D3D11_FILTER_ANISOTROPIC : D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		desc.AddressU = desc.AddressV = desc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+		desc.MaxAnisotropy = anisotropy;
+		desc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+		desc.MaxLOD = 3.402823466e+38f;
+		return desc;
+	}
+
+	D3D11_RASTERIZER_DESC MakeRasterizerDesc(D3D11_CULL_MODE cull) {
+		D3D11_RASTERIZER_DESC desc{};
+		desc.FillMode = D3D11_FILL_SOLID;
+		desc.CullMode = cull;
+		desc.DepthClipEnable = 1;
+		return desc;
+	}
+
+	// What the draw code does for one mesh: everything it needs, every time.
+	struct Material {
+		ID3D11InputLayout* layout;
+		ID3D11VertexShader* vertexShader;
+		ID3D11PixelShader* pixelShader;
+		ID3D11ShaderResourceView* texture;
+		ID3D11BlendState* blend;
+	};
+
+	void DrawMesh(RenderStateClass& states, const Material& material, ID3D11Buffer* vertices, ID3D11Buffer* indices, ID3D11Buffer* constants,
+		UINT firstConstant, ID3D11SamplerState* sampler, ID3D11RasterizerState* rasterizer, ID3D11DepthStencilState* depth) {
+		states.SetInputLayout(material.layout);
+		states.SetVertexBuffer(0, vertices, 32, 0);
+		states.SetIndexBuffer(indices, DXGI_FORMAT_R32_UINT, 0);
+		states.SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		states.SetVertexShader(material.vertexShader);
+		states.SetVertexConstantBuffer(0, constants, firstConstant, 16);
+		states.SetPixelShader(material.pixelShader);
+		states.SetPixelShaderResource(0, material.texture);
+		states.SetPixelSampler(0, sampler);
+		states.SetRasterizerState(rasterizer);
+		states.SetDepthStencilState(depth, 0);
+		states.SetBlendState(material.blend, 0, 0xFFFFFFFF);
+		states.DrawIndexed(300, 0, 0);
+	}
+}
+
+TEST(RedundantBinds) {
+	FakeContext context;
+	RenderStateClass states(&context);
+	ID3D11InputLayout* layout = Fake<ID3D11InputLayout>();
+
+	// The same again is dropped, anything different goes through, and every call is counted one way or the other.
+	states.SetInputLayout(layout);
+	states.SetInputLayout(layout);
+	CHECK(context.Count("IASetInputLayout") == 1 && states.GetStats().issued == 1 && states.GetStats().skipped == 1);
+	states.SetInputLayout(0);
+	states.SetInputLayout(layout);
+	CHECK(context.Count("IASetInputLayout") == 3);
+
+	// Every member of a binding counts.
+	ID3D11Buffer* buffer = Fake<ID3D11Buffer>();
+	states.SetVertexBuffer(0, buffer, 32, 0);
+	states.SetVertexBuffer(0, buffer, 32, 0);
+	states.SetVertexBuffer(0, buffer, 24, 0);
+	states.SetVertexBuffer(0, buffer, 24, 64);
+	states.SetVertexBuffer(1, buffer, 24, 64);	// Another slot.
+	CHECK(context.Count("IASetVertexBuffers") == 4);
+	states.SetIndexBuffer(buffer, DXGI_FORMAT_R16_UINT, 0);
+	states.SetIndexBuffer(buffer, DXGI_FORMAT_R16_UINT, 0);
+	states.SetIndexBuffer(buffer, DXGI_FORMAT_R32_UINT, 0);
+	CHECK(context.Count("IASetIndexBuffer") == 2);
+
+	D3D11_VIEWPORT viewport = { 0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f };
+	states.SetViewport(viewport);
+	states.SetViewport(viewport);
+	viewport.MaxDepth = 0.5f;
+	states.SetViewport(viewport);
+	CHECK(context.Count("RSSetViewports") == 2);
+
+	// A null blend factor is the same as ones, which is what the context is given for it.
+	ID3D11BlendState* blend = Fake<ID3D11BlendState>();
+	const FLOAT ones[4] = { 1.0f, 1.0f, 1.0f, 1.0f }, half[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
+	states.SetBlendState(blend, 0, 0xFFFFFFFF);
+	states.SetBlendState(blend, ones, 0xFFFFFFFF);
+	CHECK(context.Count("OMSetBlendState") == 1 && context.blendFactor[0] == 1.0f);
+	states.SetBlendState(blend, half, 0xFFFFFFFF);
+	states.SetBlendState(blend, half, 0x0000FFFF);
+	CHECK(context.Count("OMSetBlendState") == 3 && context.blendFactor[0] == 0.5f);
+
+	ID3D11DepthStencilState* depth = Fake<ID3D11DepthStencilState>();
+	states.SetDepthStencilState(depth, 0);
+	states.SetDepthStencilState(depth, 1);
+	states.SetDepthStencilState(depth, 1);
+	CHECK(context.Count("OMSetDepthStencilState") == 2);
+
+	// A null target binds no views at all rather than one null one.
+	ID3D11RenderTargetView* target = Fake<ID3D11RenderTargetView>();
+	ID3D11DepthStencilView* depthView = Fake<ID3D11DepthStencilView>();
+	states.SetRenderTarget(target, depthView);
+	CHECK(context.renderTargetCount == 1);
+	states.SetRenderTarget(0, depthView);
+	states.SetRenderTarget(0, depthView);
+	CHECK(context.Count("OMSetRenderTargets") == 2 && context.renderTargetCount == 0);
+
+	// Slots past the tracked ones always go through.
+	ID3D11ShaderResourceView* view = Fake<ID3D11ShaderResourceView>();
+	for (int i = 0; i < 3; i++) {
+		states.SetPixelShaderResource(RenderStateClass::SLOTS - 1, view);
+		states.SetPixelShaderResource(RenderStateClass::SLOTS, view);
+		states.SetPixelSampler(RenderStateClass::SLOTS + 3, 0);
+	}
+	CHECK(context.Count("PSSetShaderResources") == 4 && context.Count("PSSetSamplers") == 3);
+
+	// After Invalidate the next call of each kind goes through again, draws always do.
+	states.Invalidate();
+	states.SetInputLayout(layout);
+	states.SetVertexBuffer(0, buffer, 24, 64);
+	states.SetPixelShaderResource(RenderStateClass::SLOTS - 1, view);
+	states.SetDepthStencilState(depth, 1);
+	states.DrawIndexed(3, 0, 0);
+	states.DrawIndexed(3, 0, 0);
+	CHECK(context.Count("IASetInputLayout") == 4 && context.Count("IASetVertexBuffers") == 5 && context.Count("PSSetShaderResources") == 5);
+	CHECK(context.Count("OMSetDepthStencilState") == 3 && context.Count("DrawIndexed") == 2 && states.GetStats().draws == 2);
+
+	// The context saw exactly the calls counted as issued.
+	const RenderStateStats& stats = states.GetStats();
+	CHECK((int)stats.issued + (int)stats.draws == context.total);
+	states.ResetStats();
+	CHECK(states.GetStats().issued == 0 && states.GetStats().skipped == 0 && states.GetStats().draws == 0);
+}
+
+TEST(ConstantBufferWindows) {
+	ID3D11Buffer* ring = Fake<ID3D11Buffer>();
+	{
+		// With the 11.1 context a window binds through VSSetConstantBuffers1, the whole buffer through the old call.
+		FakeContext context(true);
+		{
+			RenderStateClass states(&context);
+			CHECK(context.references == 2);	// The 11.1 interface it queried.
+			states.SetVertexConstantBuffer(0, ring, 16, 16);
+			CHECK(context.Count("VSSetConstantBuffers1") == 1 && context.firstConstant == 16 && context.constantCount == 16);
+			states.SetVertexConstantBuffer(0, ring, 16, 16);
+			states.SetVertexConstantBuffer(0, ring, 32, 16);
+			states.SetVertexConstantBuffer(0, ring, 32, 32);
+			CHECK(context.Count("VSSetConstantBuffers1") == 3 && context.firstConstant == 32 && context.constantCount == 32);
+			states.SetVertexConstantBuffer(0, ring);
+			states.SetVertexConstantBuffer(0, ring, 0, 0);
+			CHECK(context.Count("VSSetConstantBuffers") == 1 && states.GetStats().skipped == 2);
+			// A window at the same offset as the whole buffer is still a different binding.
+			states.SetVertexConstantBuffer(0, ring, 0, 16);
+			CHECK(context.Count("VSSetConstantBuffers1") == 4);
+		}
+		CHECK(context.references == 1);
+	}
+	{
+		// The 11.0 runtime has no windows, the constant ring then binds whole buffers, and the fallback never calls 11.1.
+		FakeContext context(false);
+		RenderStateClass states(&context);
+		states.SetVertexConstantBuffer(0, ring, 16, 16);
+		states.SetVertexConstantBuffer(0, ring);
+		CHECK(context.Count("VSSetConstantBuffers") == 2 && context.Count("VSSetConstantBuffers1") == 0 && context.references == 1);
+	}
+}
+
+TEST(StateObjectSharing) {
+	FakeDevice device;
+	int live = liveObjects;
+	{
+		StateObjectCacheClass cache(&device);
+
+		// Equal descriptions are one object, made once, whatever their padding holds.
+		ID3D11DepthStencilState* depth = cache.GetDepthStencilState(MakeDepthStencilDesc(0xAB, D3D11_COMPARISON_LESS));
+		CHECK(depth && cache.GetDepthStencilState(MakeDepthStencilDesc(0xCD, D3D11_COMPARISON_LESS)) == depth);
+		CHECK(cache.GetDepthStencilState(MakeDepthStencilDesc(0xAB, D3D11_COMPARISON_LESS_EQUAL)) != depth);
+		ID3D11BlendState* opaque = cache.GetBlendState(MakeBlendDesc(0x00, false));
+		CHECK(opaque && cache.GetBlendState(MakeBlendDesc(0x5A, false)) == opaque && cache.GetBlendState(MakeBlendDesc(0x00, true)) != opaque);
+		ID3D11SamplerState* sampler = cache.GetSamplerState(MakeSamplerDesc(1));
+		CHECK(sampler && cache.GetSamplerState(MakeSamplerDesc(1)) == sampler && cache.GetSamplerState(MakeSamplerDesc(16)) != sampler);
+		ID3D11RasterizerState* back = cache.GetRasterizerState(MakeRasterizerDesc(D3D11_CULL_BACK));
+		CHECK(back && cache.GetRasterizerState(MakeRasterizerDesc(D3D11_CULL_BACK)) == back);
+		CHECK(cache.GetRasterizerState(MakeRasterizerDesc(D3D11_CULL_NONE)) != back);
+
+		// The kinds do not share, even where the bytes could match.
+		CHECK((void*)cache.GetRasterizerState(D3D11_RASTERIZER_DESC{}) != (void*)cache.GetSamplerState(D3D11_SAMPLER_DESC{}));
+		StateObjectStats stats = cache.GetStats();
+		CHECK(stats.created == 10 && stats.reused == 4 && device.creates == 10 && liveObjects == live + 10);
+
+		// A refused description is not cached, the next request asks the device again.
+		device.refuse = true;
+		CHECK(cache.GetSamplerState(MakeSamplerDesc(8)) == 0 && cache.GetSamplerState(MakeSamplerDesc(8)) == 0 && device.creates == 12);
+		CHECK(cache.GetSamplerState(MakeSamplerDesc(1)) == sampler);	// Cached ones still come back.
+		device.refuse = false;
+		CHECK(cache.GetSamplerState(MakeSamplerDesc(8)) != 0 && cache.GetStats().created == 11);
+
+		// Shared objects are what lets the render state drop the rebinds of equal states.
+		FakeContext context;
+		RenderStateClass states(&context);
+		for (int i = 0; i < 10; i++) {
+			states.SetDepthStencilState(cache.GetDepthStencilState(MakeDepthStencilDesc((unsigned char)i, D3D11_COMPARISON_LESS)), 0);
+			states.SetBlendState(cache.GetBlendState(MakeBlendDesc((unsigned char)(i * 3), false)), 0, 0xFFFFFFFF);
+		}
+		CHECK(context.Count("OMSetDepthStencilState") == 1 && context.Count("OMSetBlendState") == 1);
+	}
+	CHECK(liveObjects == live);	// The cache released all it made.
+}
+
+TEST(ConcurrentStateObjects) {
+	// Workers asking for the same descriptions at once all get the one object, extra creates are given back.
+	FakeDevice device;
+	int live = liveObjects;
+	{
+		StateObjectCacheClass cache(&device);
+		std::vector<ID3D11SamplerState*> found[4];
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++) {
+			threads.emplace_back([&, t]() {
+				for (int i = 0; i < 400; i++) { found[t].push_back(cache.GetSamplerState(MakeSamplerDesc((UINT)(i % 16) + 1))); }
+			});
+		}
+		for (std::thread& thread : threads) { thread.join(); }
+		bool same = true;
+		for (int t = 1; t < 4; t++) { same = same && found[t] == found[0]; }
+		StateObjectStats stats = cache.GetStats();
+		CHECK(same && stats.created == 16 && stats.created + stats.reused == 1600 && liveObjects == live + 16);
+	}
+	CHECK(liveObjects == live);
+}
+
+TEST(FrameBinds) {
+	// A frame of meshes sorted by material, each one setting everything: how many calls reach the context.
+	FakeDevice device;
+	StateObjectCacheClass cache(&device);
+	FakeContext context;
+	RenderStateClass states(&context);
+	Material materials[3];
+	ID3D11InputLayout* layout = Fake<ID3D11InputLayout>();
+	for (int i = 0; i < 3; i++) {
+		materials[i] = { layout, Fake<ID3D11VertexShader>(), Fake<ID3D11PixelShader>(), Fake<ID3D11ShaderResourceView>(),
+			cache.GetBlendState(MakeBlendDesc(0, i == 2)) };
+	}
+	ID3D11Buffer* vertices = Fake<ID3D11Buffer>();
+	ID3D11Buffer* indices = Fake<ID3D11Buffer>();
+	ID3D11Buffer* constants = Fake<ID3D11Buffer>();
+	const int draws = 3000;
+	auto frame = [&]() {
+		for (int i = 0; i < draws; i++) {
+			// Each draw has its own window of the constant ring, the rest changes with the material.
+			ID3D11SamplerState* sampler = cache.GetSamplerState(MakeSamplerDesc(16));
+			ID3D11RasterizerState* rasterizer = cache.GetRasterizerState(MakeRasterizerDesc(D3D11_CULL_BACK));
+			ID3D11DepthStencilState* depth = cache.GetDepthStencilState(MakeDepthStencilDesc(0, D3D11_COMPARISON_LESS));
+			DrawMesh(states, materials[i * 3 / draws], vertices, indices, constants, (UINT)(i % 256) * 16, sampler, rasterizer, depth);
+		}
+	};
+	frame();
+	const RenderStateStats& stats = states.GetStats();
+	StateObjectStats objects = cache.GetStats();
+	printf("  %d draws: %zu binds reached the context, %zu dropped (%.1f%%), %zu state objects for %zu requests\n", draws, stats.issued,
+		stats.skipped, 100.0 * stats.skipped / (stats.issued + stats.skipped), objects.created, objects.created + objects.reused);
+	// All twelve for the first draw, then the constant window on every draw after it, and the shaders and texture of
+	// the next two materials, the last of which also blends.
+	CHECK(stats.issued == 12 + (size_t)(draws - 1) + 3 + 4 && stats.skipped == (size_t)draws * 12 - stats.issued);
+	CHECK(context.Count("VSSetConstantBuffers1") == draws && context.Count("PSSetShader") == 3 && context.Count("OMSetBlendState") == 2);
+	CHECK(cache.GetStats().created == 5);
+	TestFramework::Benchmark("3000 draws through the render state", 10, frame);
+}
@@ -0,0 +1,196 @@
+#include "testframework.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "resourcecacheclass.hpp"
+
+namespace {
+	struct FakeResource {
+		static std::atomic<int> alive;
+		int value;
+
+		FakeResource(int value) : value(value) { alive++; }
+		~FakeResource() { alive--; }
+	};
+	std::atomic<int> FakeResource::alive{ 0 };
+
+	// A create function that counts its calls.
+	std::function<FakeResource*(std::string&)> Creates(int value, std::atomic<int>& calls, int milliseconds = 0) {
+		return [value, &calls, milliseconds](std::string&) {
+			calls++;
+			if (milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+			return new FakeResource(value);
+		};
+	}
+}
+
+TEST(PathTable) {
+	PathTableClass paths;
+	AssetPath stone = paths.Intern("data/textures/stone.tga");
+	CHECK(stone.IsValid());
+	CHECK(paths.Intern("./data/textures/../textures/stone.tga") == stone);
+	CHECK(paths.Intern("data//textures/stone.tga") == stone);
+	CHECK(paths.Intern("data/textures/seafloor.tga") != stone);
+	CHECK(paths.Find("data/./textures/stone.tga") == stone && !paths.Find("data/missing.tga").IsValid());
+	CHECK(paths.GetString(stone) == "data/textures/stone.tga" && paths.GetString(AssetPath()).empty());
+	CHECK(!paths.Intern("").IsValid() && !paths.Intern(0).IsValid());
+	CHECK(paths.GetCount() == 2);
+
+	// Variants of one path are different keys.
+	CHECK(ResourceKey(stone) != ResourceKey(stone, 1) && ResourceKey(stone, 1) != ResourceKey(paths.Find("data/textures/seafloor.tga"), 1));
+
+	// Threads interning the same names get the same ids.
+	PathTableClass shared;
+	std::vector<std::vector<AssetPath>> ids(4);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < ids.size(); t++) {
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < 500; i++) { ids[t].push_back(shared.Intern(("models/" + std::to_string(i) + ".obj").c_str())); }
+		});
+	}
+	for (std::thread& thread : threads) { thread.join(); }
+	CHECK(shared.GetCount() == 500 && ids[1] == ids[0] && ids[2] == ids[0] && ids[3] == ids[0]);
+	CHECK(shared.GetString(ids[0][42]) == "models/42.obj");
+}
+
+TEST(Sharing) {
+	ResourceCacheClass<FakeResource> cache;
+	std::atomic<int> calls{ 0 };
+	std::string error;
+	ResourceHandle first = cache.Acquire(1, Creates(10, calls), error);
+	ResourceHandle second = cache.Acquire(1, Creates(20, calls), error);
+	ResourceHandle other = cache.Acquire(2, Creates(30, calls), error);
+	CHECK(calls == 2 && first.IsValid() && second.index == first.index && second.generation == first.generation);
+	CHECK(cache.Get(first)->value == 10 && cache.Get(other)->value == 30 && cache.Lookup(1) == cache.Get(first));
+	CHECK(cache.GetReferenceCount(first) == 2 && cache.GetReferenceCount(other) == 1);
+
+	ResourceCacheStats stats = cache.GetStats();
+	CHECK(stats.hits == 1 && stats.misses == 2 && stats.resident == 2 && stats.evictions == 0);
+}
+
+TEST(Eviction) {
+	// The last release frees the resource, its handles go stale and the slot comes back under a new generation.
+	ResourceCacheClass<FakeResource> cache;
+	std::atomic<int> calls{ 0 };
+	std::string error;
+	ResourceHandle handle = cache.Acquire(1, Creates(10, calls), error);
+	ResourceHandle copy = cache.AddReference(handle);
+	CHECK(copy.index == handle.index && cache.GetReferenceCount(handle) == 2);
+
+	cache.Release(handle);
+	CHECK(FakeResource::alive == 1 && cache.Get(copy) != 0);
+	cache.Release(copy);
+	CHECK(FakeResource::alive == 0 && cache.Get(handle) == 0 && cache.Lookup(1) == 0);
+	CHECK(cache.GetStats().evictions == 1 && cache.GetStats().resident == 0);
+
+	ResourceHandle again = cache.Acquire(2, Creates(20, calls), error);
+	CHECK(again.index == handle.index && again.generation != handle.generation);
+	CHECK(cache.Get(handle) == 0 && cache.Get(again)->value == 20);
+	CHECK(!cache.AddReference(handle).IsValid() && cache.GetReferenceCount(handle) == 0);
+	cache.Release(handle);	// Stale, changes nothing.
+	CHECK(cache.GetReferenceCount(again) == 1);
+	CHECK(cache.Get(ResourceHandle()) == 0 && cache.Get(ResourceHandle{ 99, 1 }) == 0);
+
+	// Whatever is still held goes with the cache.
+	ResourceCacheClass<FakeResource>* held = new ResourceCacheClass<FakeResource>;
+	held->Acquire(1, Creates(1, calls), error);
+	held->Acquire(2, Creates(2, calls), error);
+	CHECK(FakeResource::alive == 3);
+	delete held;
+	CHECK(FakeResource::alive == 1);
+}
+
+TEST(Failures) {
+	// A failed create hands back its error and leaves nothing behind, the next acquire tries again.
+	ResourceCacheClass<FakeResource> cache;
+	std::string error;
+	ResourceHandle failed = cache.Acquire(1, [](std::string& error) {
+		error = "stone.tga: could not read the file";
+		return (FakeResource*)0;
+	}, error);
+	CHECK(!failed.IsValid() && error == "stone.tga: could not read the file");
+	CHECK(cache.Lookup(1) == 0 && cache.GetStats().resident == 0);
+
+	std::atomic<int> calls{ 0 };
+	error.clear();
+	ResourceHandle retried = cache.Acquire(1, Creates(10, calls), error);
+	CHECK(retried.IsValid() && calls == 1 && error.empty() && cache.Get(retried)->value == 10);
+	CHECK(cache.GetStats().misses == 2);
+}
+
+TEST(ConcurrentAcquire) {
+	// Threads asking for a key while it loads wait for that load instead of running their own.
+	ResourceCacheClass<FakeResource> cache;
+	std::atomic<int> calls{ 0 };
+	std::vector<ResourceHandle> handles(8);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < handles.size(); i++) {
+		threads.emplace_back([&, i]() {
+			std::string error;
+			handles[i] = cache.Acquire(7, Creates(70, calls, 20), error);
+		});
+	}
+	for (std::thread& thread : threads) { thread.join(); }
+	bool same = true;
+	for (const ResourceHandle& handle : handles) { same = same && handle.index == handles[0].index && handle.generation == handles[0].generation; }
+	CHECK(calls == 1 && same && cache.GetReferenceCount(handles[0]) == 8);
+	CHECK(cache.GetStats().hits == 7 && FakeResource::alive == 1);
+
+	// When the load they waited on fails, one of the waiters loads it itself.
+	ResourceCacheClass<FakeResource> retrying;
+	std::atomic<int> attempts{ 0 };
+	auto failsOnce = [&attempts](std::string& error) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		if (attempts++ == 0) {
+			error = "busy";
+			return (FakeResource*)0;
+		}
+		return new FakeResource(1);
+	};
+	threads.clear();
+	std::atomic<int> valid{ 0 };
+	for (int i = 0; i < 4; i++) {
+		threads.emplace_back([&]() {
+			std::string error;
+			valid += retrying.Acquire(1, failsOnce, error).IsValid();
+		});
+	}
+	for (std::thread& thread : threads) { thread.join(); }
+	CHECK(attempts == 2 && valid == 3);
+}
+
+TEST(Replace) {
+	// A rebuilt resource shows through the handles already out, the caller deletes what comes back.
+	ResourceCacheClass<FakeResource> cache;
+	std::atomic<int> calls{ 0 };
+	std::string error;
+	ResourceHandle handle = cache.Acquire(1, Creates(10, calls), error);
+	FakeResource* old = cache.Replace(1, new FakeResource(11));
+	CHECK(old && old->value == 10 && cache.Get(handle)->value == 11);
+	delete old;
+
+	FakeResource* unused = new FakeResource(20);
+	CHECK(cache.Replace(2, unused) == unused);	// Nobody holds key 2.
+	delete unused;
+	cache.Release(handle);
+	CHECK(FakeResource::alive == 0);
+}
+
+TEST(CacheBenchmark) {
+	// Acquires that hit, the common case once a level is loaded.
+	ResourceCacheClass<FakeResource> cache;
+	std::atomic<int> calls{ 0 };
+	std::string error;
+	const int keys = 1000;
+	std::vector<ResourceHandle> held;
+	for (int i = 0; i < keys; i++) { held.push_back(cache.Acquire(i, Creates(i, calls), error)); }
+	const int rounds = 100;
+	double milliseconds = TestFramework::Benchmark("100 x 1000 acquires and releases", 3, [&]() {
+		for (int round = 0; round < rounds; round++) {
+			for (int i = 0; i < keys; i++) { cache.Release(cache.Acquire(i, Creates(i, calls), error)); }
+		}
+	});
+	printf("  %.1f M acquire and release pairs/s\n", rounds * keys / milliseconds / 1000.0);
+	CHECK(calls == keys);
+	for (ResourceHandle handle : held) { cache.Release(handle); }
+}
@@ -0,0 +1,281 @@
+#include "testframework.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include "shadercacheclass.hpp"
+
+namespace {
+	std::string ReadFile(const std::string& filename) {
+		std::ifstream fin(filename, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+	}
+
+	void WriteFile(const std::string& filename, const std::string& contents) { std::ofstream(filename, std::ios::binary) << contents; }
+
+	// What the stub compiler makes of a request: everything it was given, so a wrong hand out shows.
+	std::vector<unsigned char> GetBytecode(const ShaderCompileRequest& request) {
+		std::string text = "DXBC" + request.entryPoint + "|" + request.profile + "|" + std::to_string(request.flags);
+		for (const std::pair<std::string, std::string>& define : request.defines) { text += "|" + define.first + "=" + define.second; }
+		text += "|" + ReadFile(request.filename);
+		return std::vector<unsigned char>(text.begin(), text.end());
+	}
+
+	// Stands in for D3DCompileFromFile: takes its time, counts its calls and fails on sources that say so.
+	ShaderCompiler StubCompiler(std::atomic<int>& calls, int milliseconds) {
+		return [&calls, milliseconds](const ShaderCompileRequest& request, std::vector<unsigned char>& bytecode, std::string& error) {
+			calls++;
+			if (milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+			std::string source = ReadFile(request.filename);
+			if (source.empty() || source.find("syntax error") != std::string::npos) {
+				error = request.filename + "(1,1): error X3000: syntax error";
+				return false;
+			}
+			bytecode = GetBytecode(request);
+			return true;
+		};
+	}
+
+	// A shader with an include next to it in a fresh directory, and the cache directory beside them.
+	std::string MakeShaders(const char* name, std::string& cacheDirectory) {
+		std::filesystem::path directory = TestFramework::GetTempFilename(name);
+		std::filesystem::create_directories(directory);
+		WriteFile((directory / "common.hlsli").string(), "float4 Tint(float4 color) { return color; }\n");
+		WriteFile((directory / "light.hlsl").string(), "#include \"common.hlsli\"\nfloat4 LightPixelShader() : SV_TARGET { return Tint(1); }\n");
+		cacheDirectory = (directory / "cache").string();
+		return (directory / "light.hlsl").string();
+	}
+
+	std::vector<ShaderCompileRequest> MakePermutations(const std::string& filename, int count) {
+		std::vector<ShaderCompileRequest> requests;
+		for (int i = 0; i < count; i++) {
+			ShaderCompileRequest request;
+			request.filename = filename;
+			request.entryPoint = "LightPixelShader";
+			request.profile = "ps_5_0";
+			request.defines = { { "LIGHT_COUNT", std::to_string(i % 4 + 1) }, { "SHADOWS", i / 4 % 2 ? "1" : "0" }, { "VARIANT", std::to_string(i) } };
+			requests.push_back(request);
+		}
+		return requests;
+	}
+
+	size_t CountFiles(const std::string& directory, const char* extension) {
+		size_t count = 0;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) { count += entry.path().extension() == extension; }
+		return count;
+	}
+}
+
+TEST(Keys) {
+	std::string cacheDirectory;
+	std::string filename = MakeShaders("keys", cacheDirectory);
+	std::atomic<int> calls{ 0 };
+	ShaderCacheClass cache(cacheDirectory.c_str(), StubCompiler(calls, 0), 1, 1);
+	ShaderCacheClass otherCompiler(cacheDirectory.c_str(), StubCompiler(calls, 0), 2, 1);
+	CHECK(cache.isInitialized);
+	ShaderCompileRequest request = MakePermutations(filename, 1)[0];
+	uint64_t key = cache.GetPermutationKey(request);
+
+	// Anything the compiler is given is a different permutation, spellings of the same path are not.
+	ShaderCompileRequest changed = request;
+	changed.filename = (std::filesystem::path(filename).parent_path() / "." / "light.hlsl").string();
+	CHECK(cache.GetPermutationKey(changed) == key);
+	changed = request;
+	changed.entryPoint = "LightVertexShader";
+	CHECK(cache.GetPermutationKey(changed) != key);
+	changed = request;
+	changed.profile = "ps_4_0";
+	CHECK(cache.GetPermutationKey(changed) != key);
+	changed = request;
+	changed.flags = 1;
+	CHECK(cache.GetPermutationKey(changed) != key);
+	changed = request;
+	changed.defines[0].second = "2";
+	CHECK(cache.GetPermutationKey(changed) != key);
+	changed = request;
+	std::swap(changed.defines[0], changed.defines[1]);
+	CHECK(cache.GetPermutationKey(changed) != key);
+	changed = request;
+	changed.defines = { { "LIGHT_COUNT1", "" } };
+	ShaderCompileRequest split = request;
+	split.defines = { { "LIGHT_COUNT", "1" } };
+	CHECK(cache.GetPermutationKey(changed) != cache.GetPermutationKey(split));	// Strings can not run into each other.
+	CHECK(otherCompiler.GetPermutationKey(request) != key);
+
+	// The source key covers the includes, and fails only without the shader itself.
+	uint64_t sourceKey = 0, editedKey = 0, missingKey = 0;
+	CHECK(ShaderCacheClass::GetSourceKey(request, key, sourceKey));
+	WriteFile((std::filesystem::path(filename).parent_path() / "common.hlsli").string(), "float4 Tint(float4 color) { return color * 2; }\n");
+	CHECK(ShaderCacheClass::GetSourceKey(request, key, editedKey) && editedKey != sourceKey);
+	std::filesystem::remove(std::filesystem::path(filename).parent_path() / "common.hlsli");
+	CHECK(ShaderCacheClass::GetSourceKey(request, key, missingKey) && missingKey != editedKey);
+	changed = request;
+	changed.filename += ".missing";
+	CHECK(!ShaderCacheClass::GetSourceKey(changed, key, sourceKey));
+}
+
+TEST(ColdAndWarm) {
+	// A launch with an empty cache compiles every permutation, the next one compiles none.
+	std::string cacheDirectory;
+	std::string filename = MakeShaders("coldwarm", cacheDirectory);
+	std::vector<ShaderCompileRequest> requests = MakePermutations(filename, 16);
+	std::atomic<int> calls{ 0 };
+	const int compileMilliseconds = 10;
+
+	auto launch = [&](ShaderCacheStats& stats) {
+		ShaderCacheClass cache(cacheDirectory.c_str(), StubCompiler(calls, compileMilliseconds), 1, 2);
+		bool same = cache.isInitialized;
+		auto start = std::chrono::steady_clock::now();
+		cache.Prefetch(requests);
+		for (const ShaderCompileRequest& request : requests) {
+			std::vector<unsigned char> bytecode;
+			std::string error;
+			same = same && cache.Get(request, bytecode, error) && bytecode == GetBytecode(request) && error.empty();
+		}
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		stats = cache.GetStats();
+		CHECK(same);
+		return milliseconds;
+	};
+	ShaderCacheStats cold, warm;
+	double coldMilliseconds = launch(cold);
+	CHECK(calls == 16 && cold.misses == 16 && cold.hits == 0 && cold.failures == 0);
+	CHECK(CountFiles(cacheDirectory, ".cso") == 16 && CountFiles(cacheDirectory, ".tmp") == 0);
+	double warmMilliseconds = launch(warm);
+	CHECK(calls == 16 && warm.hits == 16 && warm.misses == 0 && warm.compileMilliseconds == 0.0);
+	CHECK(warmMilliseconds < coldMilliseconds);
+	printf("  16 permutations at %d ms a compile on 2 workers: cold %.1f ms (%.1f ms compiling), warm %.2f ms (%.2f ms loading)\n",
+		compileMilliseconds, coldMilliseconds, cold.compileMilliseconds, warmMilliseconds, warm.loadMilliseconds);
+
+	// Editing an include makes every permutation stale, the entries are overwritten in place.
+	WriteFile((std::filesystem::path(filename).parent_path() / "common.hlsli").string(), "float4 Tint(float4 color) { return color * 0.5; }\n");
+	ShaderCacheStats edited;
+	launch(edited);
+	CHECK(calls == 32 && edited.misses == 16 && CountFiles(cacheDirectory, ".cso") == 16);
+
+	// Another compiler does not use these entries.
+	ShaderCacheClass other(cacheDirectory.c_str(), StubCompiler(calls, 0), 2, 1);
+	std::vector<unsigned char> bytecode;
+	std::string error;
+	CHECK(other.Get(requests[0], bytecode, error) && other.GetStats().misses == 1 && CountFiles(cacheDirectory, ".cso") == 17);
+}
+
+TEST(FailuresAndDamage) {
+	std::string cacheDirectory;
+	std::string filename = MakeShaders("failures", cacheDirectory);
+	std::atomic<int> calls{ 0 };
+	ShaderCacheClass cache(cacheDirectory.c_str(), StubCompiler(calls, 0), 1, 1);
+	ShaderCompileRequest request = MakePermutations(filename, 1)[0];
+	std::vector<unsigned char> bytecode;
+	std::string error;
+
+	// A failed compile hands out the compiler's messages and is not cached, a prefetched one as well.
+	std::string source = ReadFile(filename);
+	WriteFile(filename, source + "syntax error\n");
+	CHECK(!cache.Get(request, bytecode, error) && error.find("X3000") != std::string::npos);
+	cache.Prefetch({ request });
+	error.clear();
+	CHECK(!cache.Get(request, bytecode, error) && error.find("X3000") != std::string::npos);
+	CHECK(cache.GetStats().failures == 2 && calls == 2 && CountFiles(cacheDirectory, ".cso") == 0);
+
+	// Fixed, it compiles once and then loads.
+	WriteFile(filename, source);
+	CHECK(cache.Get(request, bytecode, error) && bytecode == GetBytecode(request));
+	CHECK(cache.Get(request, bytecode, error) && bytecode == GetBytecode(request) && calls == 3 && cache.GetStats().hits == 1);
+
+	// Damaged entries are compiled again: truncated, grown, or with a corrupt header.
+	std::string entry = (std::filesystem::path(cacheDirectory) / std::filesystem::directory_iterator(cacheDirectory)->path().filename()).string();
+	std::string good = ReadFile(entry);
+	std::string otherKey = good;
+	otherKey[8] ^= 1;
+	const std::string damaged[] = { good.substr(0, good.size() - 1), good.substr(0, 10), good + "x", "", "X" + good.substr(1),
+		good.substr(0, 4) + "\x02" + good.substr(5), otherKey };
+	int expected = calls;
+	for (const std::string& bytes : damaged) {
+		WriteFile(entry, bytes);
+		CHECK(cache.Get(request, bytecode, error) && bytecode == GetBytecode(request) && calls == ++expected);
+	}
+	CHECK(ReadFile(entry) == good);
+
+	// A missing shader goes to the compiler, which says why. Without its directory the cache only compiles.
+	ShaderCompileRequest missing = request;
+	missing.filename += ".missing";
+	CHECK(!cache.Get(missing, bytecode, error) && !error.empty());
+	std::string blocked = TestFramework::GetTempFilename("blocked");
+	WriteFile(blocked, "a file, not a directory");
+	ShaderCacheClass uncached((blocked + "/cache").c_str(), StubCompiler(calls, 0), 1, 1);
+	CHECK(!uncached.isInitialized);
+	CHECK(uncached.Get(request, bytecode, error) && uncached.Get(request, bytecode, error) && uncached.GetStats().misses == 2);
+
+	// Without a cache Compile goes straight to D3D, which only Windows has.
+	error.clear();
+	bool compiled = ShaderCacheClass::Compile(0, request, bytecode, error);
+#ifdef _WIN32
+	(void)compiled;
+#else
+	CHECK(!compiled && !error.empty() && ShaderCacheClass::GetD3DCompilerKey() == 0);
+#endif
+	CHECK(ShaderCacheClass::Compile(&cache, request, bytecode, error) && bytecode == GetBytecode(request));
+}
+
+TEST(ConcurrentGet) {
+	// Two threads waiting on the same prefetched permutation both get its bytecode, whichever wakes first. Before the
+	// pending entries were shared the second one read the entry the first had erased, which the sanitizers catch.
+	std::string cacheDirectory;
+	std::string filename = MakeShaders("concurrent", cacheDirectory);
+	std::vector<ShaderCompileRequest> requests = MakePermutations(filename, 24);
+	std::atomic<int> calls{ 0 };
+	ShaderCacheClass cache(cacheDirectory.c_str(), StubCompiler(calls, 2), 1, 2);
+	std::atomic<int> wrong{ 0 };
+	auto get = [&](const ShaderCompileRequest& request) {
+		std::vector<unsigned char> bytecode;
+		std::string error;
+		if (!cache.Get(request, bytecode, error) || bytecode != GetBytecode(request)) { wrong++; }
+	};
+	for (const ShaderCompileRequest& request : requests) {
+		cache.Prefetch({ request });
+		std::thread first(get, std::cref(request));
+		std::thread second(get, std::cref(request));
+		first.join();
+		second.join();
+	}
+	// Each permutation compiled once: the waiter that comes late finds it in the cache directory.
+	ShaderCacheStats stats = cache.GetStats();
+	CHECK(wrong == 0 && calls == 24 && stats.misses == 24 && stats.hits <= 24);
+
+	// Without a prefetch both may compile, each writes its own temporary file and the entry is whole either way.
+	for (ShaderCompileRequest& request : requests) { request.flags = 1; }
+	for (const ShaderCompileRequest& request : requests) {
+		std::thread first(get, std::cref(request));
+		std::thread second(get, std::cref(request));
+		first.join();
+		second.join();
+	}
+	CHECK(wrong == 0 && calls >= 48 && CountFiles(cacheDirectory, ".tmp") == 0 && CountFiles(cacheDirectory, ".cso") == 48);
+
+	// Many threads over all permutations at once, half of them prefetched again.
+	std::vector<ShaderCompileRequest> again(requests.begin(), requests.begin() + 12);
+	cache.Prefetch(again);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&, t]() {
+			for (size_t i = 0; i < requests.size(); i++) { get(requests[(i + t * 5) % requests.size()]); }
+		});
+	}
+	for (std::thread& thread : threads) { thread.join(); }
+	CHECK(wrong == 0);
+}
+
+TEST(DropsQueuedCompiles) {
+	// A cache destroyed with compiles still queued finishes the running ones and drops the rest.
+	std::string cacheDirectory;
+	std::string filename = MakeShaders("dropped", cacheDirectory);
+	std::atomic<int> calls{ 0 };
+	{
+		ShaderCacheClass cache(cacheDirectory.c_str(), StubCompiler(calls, 5), 1, 1);
+		cache.Prefetch(MakePermutations(filename, 20));
+	}
+	CHECK(calls < 20 && CountFiles(cacheDirectory, ".tmp") == 0);
+}
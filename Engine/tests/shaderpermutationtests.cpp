@@ -0,0 +1,126 @@
+#include "testframework.hpp"
+#include <filesystem>
+#include <map>
+#include <set>
+#include "shadercacheclass.hpp"
+#include "shaderpermutationclass.hpp"
+
+namespace {
+	typedef std::vector<std::pair<std::string, std::string>> DefineList;
+
+	const ShaderKey FULL = ShaderKeyChecks::FULL;
+	const ShaderKey SCENE = ShaderKey().With(ShaderKey::TEXTURE).WithLighting(LIGHTING_LAMBERT).WithLightCount(1);
+
+	// The key a shader compiled with these defines sees, as light.ps reads them.
+	ShaderKey FromDefines(const DefineList& defines) {
+		std::map<std::string, std::string> values(defines.begin(), defines.end());
+		ShaderKey key;
+		key = key.With(ShaderKey::TEXTURE, values.count("TEXTURED") != 0).With(ShaderKey::ALPHA_TEST, values.count("ALPHA_TEST") != 0);
+		key = key.With(ShaderKey::FOG, values.count("FOG") != 0);
+		key = key.WithLighting((ShaderLighting)std::stoul(values["LIGHTING_MODEL"])).WithLightCount((uint32_t)std::stoul(values["LIGHT_COUNT"]));
+		return key;
+	}
+
+	bool Contains(const std::vector<ShaderKey>& keys, ShaderKey key) {
+		for (ShaderKey other : keys) {
+			if (other == key) { return true; }
+		}
+		return false;
+	}
+}
+
+TEST(Enumerate) {
+	// Every valid key is within the full one, each once and in order.
+	std::vector<ShaderKey> keys = ShaderPermutationClass::Enumerate(FULL);
+	CHECK(keys.size() == ShaderPermutationClass::Count(FULL) && keys.size() == 54);
+	for (size_t i = 0; i < keys.size(); i++) {
+		CHECK(keys[i].IsValid());
+		if (i > 0) { CHECK(keys[i - 1].bits < keys[i].bits); }
+	}
+	for (uint32_t bits = 0; bits < ShaderKey::COUNT; bits++) { CHECK(Contains(keys, ShaderKey{ bits }) == ShaderKey{ bits }.IsValid()); }
+
+	// A smaller maximum keeps its flags or fewer, its lighting or simpler and as many lights or fewer.
+	std::vector<ShaderKey> scene = ShaderPermutationClass::Enumerate(SCENE);
+	CHECK(scene.size() == ShaderPermutationClass::Count(SCENE) && scene.size() == 4);
+	for (ShaderKey key : scene) {
+		CHECK(key.IsValid() && !key.Has(ShaderKey::ALPHA_TEST) && !key.Has(ShaderKey::FOG));
+		CHECK(key.GetLighting() <= LIGHTING_LAMBERT && key.GetLightCount() <= 1);
+	}
+	CHECK(Contains(scene, SCENE) && Contains(scene, ShaderKey()) && Contains(scene, ShaderKey().With(ShaderKey::TEXTURE)));
+
+	std::vector<ShaderKey> plain = ShaderPermutationClass::Enumerate(ShaderKey());
+	CHECK(plain.size() == 1 && plain[0] == ShaderKey());
+	// An invalid maximum still bounds the keys, only valid ones come out.
+	std::vector<ShaderKey> invalid = ShaderPermutationClass::Enumerate(ShaderKey().With(ShaderKey::ALPHA_TEST));
+	CHECK(invalid.size() == 1 && invalid[0] == ShaderKey());
+}
+
+TEST(KeyDefines) {
+	CHECK(ShaderPermutationClass::GetDefines(ShaderKey()) == DefineList({ { "LIGHTING_MODEL", "0" }, { "LIGHT_COUNT", "0" } }));
+	CHECK(ShaderPermutationClass::GetDefines(SCENE) == DefineList({ { "TEXTURED", "1" }, { "LIGHTING_MODEL", "1" }, { "LIGHT_COUNT", "1" } }));
+	CHECK(ShaderPermutationClass::GetDefines(FULL) ==
+		DefineList({ { "TEXTURED", "1" }, { "ALPHA_TEST", "1" }, { "FOG", "1" }, { "LIGHTING_MODEL", "2" }, { "LIGHT_COUNT", "4" } }));
+	CHECK(ShaderPermutationClass::GetDefines(ShaderKey().With(ShaderKey::FOG)) ==
+		DefineList({ { "FOG", "1" }, { "LIGHTING_MODEL", "0" }, { "LIGHT_COUNT", "0" } }));
+
+	// For every key the defines say exactly which one it is, each name once.
+	std::set<DefineList> seen;
+	for (ShaderKey key : ShaderPermutationClass::Enumerate(FULL)) {
+		DefineList defines = ShaderPermutationClass::GetDefines(key);
+		std::set<std::string> names;
+		for (const auto& define : defines) { names.insert(define.first); }
+		CHECK(names.size() == defines.size());
+		CHECK(FromDefines(defines) == key);
+		CHECK(seen.insert(defines).second);
+	}
+}
+
+TEST(TableSlots) {
+	// The shaders sit in a table of ShaderKey::COUNT entries indexed by the key, see LightShaderClass::HasKey, and in
+	// the shader cache in a file per permutation key.
+	std::string directory = TestFramework::GetTempFilename("permutations");
+	std::filesystem::create_directories(directory);
+	ShaderCompiler never = [](const ShaderCompileRequest&, std::vector<unsigned char>&, std::string&) { return false; };
+	ShaderCacheClass cache(directory.c_str(), never, 1, 1);
+
+	std::vector<bool> used(ShaderKey::COUNT, false);
+	std::set<uint64_t> permutationKeys;
+	for (ShaderKey key : ShaderPermutationClass::Enumerate(FULL)) {
+		CHECK(key.bits < ShaderKey::COUNT && !used[key.bits]);
+		used[key.bits] = true;
+		ShaderCompileRequest request{ "light.ps", "LightPixelShader", "ps_5_0", ShaderPermutationClass::GetDefines(key), 0 };
+		CHECK(permutationKeys.insert(cache.GetPermutationKey(request)).second);
+	}
+	CHECK(permutationKeys.size() == ShaderPermutationClass::Count(FULL));
+}
+
+TEST(Detail) {
+	// Reducing never asks for more than the key has, and every level of every key is one the full key compiles.
+	std::vector<ShaderKey> keys = ShaderPermutationClass::Enumerate(FULL);
+	for (ShaderKey key : keys) {
+		std::vector<ShaderKey> within = ShaderPermutationClass::Enumerate(key);
+		for (uint32_t detail = 0; detail < ShaderPermutationClass::DETAIL_LEVELS; detail++) {
+			ShaderKey reduced = ShaderPermutationClass::Reduce(key, detail);
+			CHECK(reduced.IsValid() && Contains(within, reduced));
+			CHECK(reduced.Has(ShaderKey::FOG) == key.Has(ShaderKey::FOG) && reduced.Has(ShaderKey::ALPHA_TEST) == key.Has(ShaderKey::ALPHA_TEST));
+			if (detail > 0) { CHECK(reduced.GetLightCount() <= ShaderPermutationClass::Reduce(key, detail - 1).GetLightCount()); }
+		}
+		std::vector<ShaderKey> detailKeys = ShaderPermutationClass::GetDetailKeys(key);
+		CHECK(detailKeys[0] == key && detailKeys.size() <= ShaderPermutationClass::DETAIL_LEVELS);
+		for (uint32_t detail = 0; detail < ShaderPermutationClass::DETAIL_LEVELS; detail++) {
+			CHECK(Contains(detailKeys, ShaderPermutationClass::Reduce(key, detail)));
+		}
+	}
+	CHECK(ShaderPermutationClass::GetDetailKeys(FULL).size() == 3 && ShaderPermutationClass::GetDetailKeys(SCENE).size() == 1);
+
+	// The level follows the screen size, so a model further away never shades with more.
+	uint32_t previous = 0;
+	for (float distance = 1.0f; distance < 1000.0f; distance *= 1.1f) {
+		float screenSize = 2.0f * 1.0f * 935.0f / distance;	// A unit sphere in a 1080 pixel viewport at 60 degrees.
+		uint32_t detail = ShaderPermutationClass::SelectDetail(screenSize);
+		CHECK(detail >= previous && detail < ShaderPermutationClass::DETAIL_LEVELS);
+		previous = detail;
+	}
+	CHECK(previous == ShaderPermutationClass::DETAIL_LEVELS - 1);
+	CHECK(ShaderPermutationClass::SelectDetail(3.4e38f) == 0);	// What a model reports before its first cull.
+}
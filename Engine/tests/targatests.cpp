@@ -0,0 +1,333 @@
+#include "testframework.hpp"
+#include <string.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include "imageconverterclass.hpp"
+#include "targadecoderclass.hpp"
+
+namespace {
+	std::vector<unsigned char> RandomBytes(size_t count, unsigned seed) {
+		std::mt19937 random(seed);
+		std::vector<unsigned char> bytes(count);
+		for (unsigned char& byte : bytes) { byte = (unsigned char)random(); }
+		return bytes;
+	}
+
+	// The loop TextureClass::SetTargaData ran before the converter: bottom up BGRA in, top down RGBA out.
+	std::vector<unsigned char> ScalarFlipSwizzle(const std::vector<unsigned char>& image, int width, int height) {
+		std::vector<unsigned char> result(image.size());
+		int destination = 0;
+		int source = (width * height * 4) - (width * 4);
+		for (int h = 0; h < height; h++) {
+			for (int w = 0; w < width; w++) {
+				result[destination + 0] = image[source + 2];
+				result[destination + 1] = image[source + 1];
+				result[destination + 2] = image[source + 0];
+				result[destination + 3] = image[source + 3];
+				source += 4;
+				destination += 4;
+			}
+			source -= (width * 8);
+		}
+		return result;
+	}
+
+	// An image as it sits in the file, pixels in file order and uncompressed.
+	struct TargaFile {
+		int imageType = 2;	// 1 color mapped, 2 true color, 3 grayscale.
+		int bits = 32;
+		int width = 0;
+		int height = 0;
+		unsigned char descriptor = 0;
+		std::string id;
+		int mapFirst = 0;
+		int mapBits = 0;
+		std::vector<unsigned char> map;	// BGR or BGRA entries.
+		std::vector<unsigned char> pixels;
+	};
+
+	TargaFile MakeTarga(int imageType, int bits, int width, int height, unsigned char descriptor, unsigned seed) {
+		TargaFile tga;
+		tga.imageType = imageType;
+		tga.bits = bits;
+		tga.width = width;
+		tga.height = height;
+		tga.descriptor = descriptor;
+		tga.pixels = RandomBytes((size_t)width * height * bits / 8, seed);
+		// Runs of equal pixels for the run length packets, some of them crossing rows.
+		size_t pixelSize = (size_t)bits / 8;
+		for (size_t i = 0; i + 40 * pixelSize < tga.pixels.size(); i += 97 * pixelSize) {
+			for (size_t j = 1; j < 40; j++) { memcpy(&tga.pixels[i + j * pixelSize], &tga.pixels[i], pixelSize); }
+		}
+		return tga;
+	}
+
+	// Greedy packets of at most 128 pixels, which like most writers ignore row ends.
+	std::string RunLengthEncode(const std::vector<unsigned char>& pixels, size_t pixelSize) {
+		std::string out;
+		size_t count = pixels.size() / pixelSize;
+		auto same = [&](size_t a, size_t b) { return memcmp(&pixels[a * pixelSize], &pixels[b * pixelSize], pixelSize) == 0; };
+		for (size_t i = 0; i < count;) {
+			size_t run = 1;
+			while (i + run < count && run < 128 && same(i, i + run)) { run++; }
+			if (run > 1) {
+				out += (char)(0x80 | (run - 1));
+				out.append((const char*)&pixels[i * pixelSize], pixelSize);
+				i += run;
+				continue;
+			}
+			size_t raw = 1;
+			while (i + raw < count && raw < 128 && !(i + raw + 1 < count && same(i + raw, i + raw + 1))) { raw++; }
+			out += (char)(raw - 1);
+			out.append((const char*)&pixels[i * pixelSize], raw * pixelSize);
+			i += raw;
+		}
+		return out;
+	}
+
+	std::string ToFile(const TargaFile& tga, bool runLength) {
+		unsigned char header[18] = {};
+		header[0] = (unsigned char)tga.id.size();
+		header[1] = tga.map.empty() ? 0 : 1;
+		header[2] = (unsigned char)(tga.imageType + (runLength ? 8 : 0));
+		size_t mapEntries = tga.mapBits ? tga.map.size() / (tga.mapBits / 8) : 0;
+		header[3] = (unsigned char)tga.mapFirst;
+		header[4] = (unsigned char)(tga.mapFirst >> 8);
+		header[5] = (unsigned char)mapEntries;
+		header[6] = (unsigned char)(mapEntries >> 8);
+		header[7] = (unsigned char)tga.mapBits;
+		header[12] = (unsigned char)tga.width;
+		header[13] = (unsigned char)(tga.width >> 8);
+		header[14] = (unsigned char)tga.height;
+		header[15] = (unsigned char)(tga.height >> 8);
+		header[16] = (unsigned char)tga.bits;
+		header[17] = tga.descriptor;
+		std::string file((const char*)header, sizeof(header));
+		file += tga.id;
+		file.append((const char*)tga.map.data(), tga.map.size());
+		if (runLength) { file += RunLengthEncode(tga.pixels, (size_t)tga.bits / 8); }
+		else { file.append((const char*)tga.pixels.data(), tga.pixels.size()); }
+		return file;
+	}
+
+	// What the decoder should make of the file, worked out pixel by pixel.
+	std::vector<unsigned char> Expected(const TargaFile& tga) {
+		std::vector<unsigned char> rgba((size_t)tga.width * tga.height * 4);
+		size_t pixelSize = (size_t)tga.bits / 8;
+		bool topDown = (tga.descriptor & 0x20) != 0, rightToLeft = (tga.descriptor & 0x10) != 0;
+		for (int row = 0; row < tga.height; row++) {
+			for (int column = 0; column < tga.width; column++) {
+				const unsigned char* p = &tga.pixels[((size_t)row * tga.width + column) * pixelSize];
+				int y = topDown ? row : tga.height - 1 - row, x = rightToLeft ? tga.width - 1 - column : column;
+				unsigned char* out = &rgba[((size_t)y * tga.width + x) * 4];
+				if (tga.imageType == 3) {
+					out[0] = out[1] = out[2] = p[0];
+					out[3] = 255;
+				}
+				else if (tga.imageType == 1) {
+					size_t entrySize = (size_t)tga.mapBits / 8, entry = (size_t)p[0] - tga.mapFirst;
+					if (p[0] < tga.mapFirst || entry >= tga.map.size() / entrySize) { memset(out, 0, 4); }
+					else {
+						const unsigned char* e = &tga.map[entry * entrySize];
+						out[0] = e[2], out[1] = e[1], out[2] = e[0], out[3] = entrySize == 4 ? e[3] : 255;
+					}
+				}
+				else {
+					out[0] = p[2], out[1] = p[1], out[2] = p[0], out[3] = tga.bits == 32 ? p[3] : 255;
+				}
+			}
+		}
+		return rgba;
+	}
+
+	bool Decode(const std::string& file, std::vector<unsigned char>& rgba, std::string& error) {
+		std::istringstream stream(file);
+		TargaDecoderClass decoder(stream);
+		bool success = decoder.ReadHeader();
+		if (success) {
+			rgba.assign((size_t)decoder.GetWidth() * decoder.GetHeight() * 4, 0);
+			success = decoder.Decode(rgba.data());
+		}
+		error = decoder.errorMessage;
+		return success;
+	}
+
+	bool DecodesTo(const TargaFile& tga, bool runLength) {
+		std::vector<unsigned char> rgba;
+		std::string error;
+		return Decode(ToFile(tga, runLength), rgba, error) && rgba == Expected(tga);
+	}
+}
+
+TEST(FlipSwizzleMatchesScalar) {
+	// Every width up to past two AVX2 blocks, so each kernel's tail is hit, and odd heights for the middle row.
+	bool same = true, sameUnflipped = true;
+	for (int width = 1; width <= 37; width++) {
+		for (int height = 1; height <= 6; height++) {
+			std::vector<unsigned char> image = RandomBytes((size_t)width * height * 4, (unsigned)(width * 16 + height));
+			std::vector<unsigned char> expected = ScalarFlipSwizzle(image, width, height);
+			std::vector<unsigned char> flipped = image;
+			ImageConverterClass::BgraToRgbaImage(flipped.data(), width, height, true);
+			same = same && flipped == expected;
+
+			// Unflipped is the scalar loop on an image flipped beforehand.
+			std::vector<unsigned char> upsideDown(image.size());
+			for (int y = 0; y < height; y++) { memcpy(&upsideDown[(size_t)y * width * 4], &image[(size_t)(height - 1 - y) * width * 4], (size_t)width * 4); }
+			std::vector<unsigned char> swizzled = image;
+			ImageConverterClass::BgraToRgbaImage(swizzled.data(), width, height, false);
+			sameUnflipped = sameUnflipped && swizzled == ScalarFlipSwizzle(upsideDown, width, height);
+		}
+	}
+	CHECK(same && sameUnflipped);
+
+	// Unaligned source and destination, out of place.
+	std::vector<unsigned char> source = RandomBytes(4 * 101 + 3, 1), destination(4 * 101 + 3);
+	bool unaligned = true;
+	for (size_t offset = 0; offset < 4; offset++) {
+		ImageConverterClass::BgraToRgba(source.data() + offset, destination.data() + 3 - offset, 100);
+		for (size_t i = 0; i < 100; i++) {
+			const unsigned char* s = &source[offset + i * 4];
+			const unsigned char* d = &destination[3 - offset + i * 4];
+			unaligned = unaligned && d[0] == s[2] && d[1] == s[1] && d[2] == s[0] && d[3] == s[3];
+		}
+	}
+	CHECK(unaligned);
+}
+
+TEST(TrueColor) {
+	for (int bits : { 24, 32 }) {
+		for (bool runLength : { false, true }) {
+			CHECK(DecodesTo(MakeTarga(2, bits, 29, 17, bits == 32 ? 8 : 0, (unsigned)bits), runLength));
+		}
+	}
+	// Image ids and color maps of true color images are skipped.
+	TargaFile tga = MakeTarga(2, 24, 5, 3, 0, 4);
+	tga.id = "made by hand";
+	tga.mapBits = 24;
+	tga.map = RandomBytes(3 * 300, 5);
+	CHECK(DecodesTo(tga, false) && DecodesTo(tga, true));
+}
+
+TEST(EightBit) {
+	for (bool runLength : { false, true }) {
+		CHECK(DecodesTo(MakeTarga(3, 8, 31, 9, 0, 6), runLength));
+
+		// Color maps of either depth, starting past 0, some indices outside them.
+		for (int mapBits : { 24, 32 }) {
+			TargaFile tga = MakeTarga(1, 8, 31, 9, 0, 7);
+			tga.mapFirst = 16;
+			tga.mapBits = mapBits;
+			tga.map = RandomBytes((size_t)200 * mapBits / 8, 8);
+			CHECK(DecodesTo(tga, runLength));
+		}
+	}
+}
+
+TEST(Origins) {
+	// Bottom left is what most tools write, the others are rare but legal.
+	for (unsigned char origin : { 0x00, 0x10, 0x20, 0x30 }) {
+		for (int bits : { 8, 24, 32 }) {
+			int imageType = bits == 8 ? 3 : 2;
+			CHECK(DecodesTo(MakeTarga(imageType, bits, 13, 7, origin, 9), false));
+			CHECK(DecodesTo(MakeTarga(imageType, bits, 13, 7, origin, 9), true));
+		}
+	}
+	// One pixel wide and one row high.
+	CHECK(DecodesTo(MakeTarga(2, 32, 1, 5, 0x30, 10), true) && DecodesTo(MakeTarga(2, 32, 5, 1, 0x10, 10), true));
+}
+
+TEST(ChunkBoundaries) {
+	// Larger than a chunk, with 3 byte pixels cut by its end.
+	TargaFile tga = MakeTarga(2, 24, 301, 297, 0, 11);
+	CHECK(tga.pixels.size() > 4 * TargaDecoderClass::CHUNK_SIZE);
+	CHECK(DecodesTo(tga, false) && DecodesTo(tga, true));
+
+	// Runs that repeat one pixel over several rows.
+	TargaFile flat = MakeTarga(2, 32, 301, 297, 0, 12);
+	for (size_t i = 4; i < flat.pixels.size(); i++) { flat.pixels[i] = flat.pixels[i % 4]; }
+	std::string file = ToFile(flat, true);
+	CHECK(file.size() < flat.pixels.size() / 100 && DecodesTo(flat, true));
+}
+
+TEST(Errors) {
+	std::vector<unsigned char> rgba;
+	std::string error;
+	std::string valid = ToFile(MakeTarga(2, 32, 8, 8, 0, 13), false);
+	CHECK(!Decode("", rgba, error) && error == "not a TGA file");
+	CHECK(!Decode(valid.substr(0, 17), rgba, error) && error == "not a TGA file");
+	CHECK(!Decode(valid.substr(0, valid.size() - 1), rgba, error) && error == "unexpected end of file");
+	std::string runLength = ToFile(MakeTarga(2, 32, 8, 8, 0, 13), true);
+	CHECK(!Decode(runLength.substr(0, runLength.size() - 1), rgba, error) && error == "unexpected end of file");
+
+	auto patched = [&](size_t offset, unsigned char value) {
+		std::string file = valid;
+		file[offset] = (char)value;
+		return file;
+	};
+	CHECK(!Decode(patched(2, 4), rgba, error) && error == "unsupported image type 4");
+	CHECK(!Decode(patched(16, 15), rgba, error) && error == "unsupported pixel depth 15");
+	CHECK(!Decode(patched(2, 3), rgba, error) && error == "unsupported grayscale depth 32");
+	CHECK(!Decode(patched(2, 1), rgba, error) && error == "unsupported color mapped format");
+	CHECK(!Decode(patched(12, 0), rgba, error) && error == "bad size 0x8");
+
+	TargaFile mapped = MakeTarga(1, 8, 4, 4, 0, 14);
+	mapped.mapBits = 16;
+	mapped.map = RandomBytes(32, 15);
+	CHECK(!Decode(ToFile(mapped, false), rgba, error) && error == "unsupported color map depth 16");
+
+	std::istringstream stream(valid);
+	TargaDecoderClass decoder(stream);
+	CHECK(!decoder.Decode(rgba.data()) && decoder.errorMessage == "the header was not read");
+}
+
+TEST(Fuzz) {
+	// Damaged files fail or decode, they never read or write out of bounds. Run under a sanitizer to be sure.
+	std::vector<std::string> files;
+	for (bool runLength : { false, true }) {
+		files.push_back(ToFile(MakeTarga(2, 32, 23, 11, 0, 16), runLength));
+		files.push_back(ToFile(MakeTarga(2, 24, 23, 11, 0x20, 17), runLength));
+		files.push_back(ToFile(MakeTarga(3, 8, 23, 11, 0x10, 18), runLength));
+	}
+	std::mt19937 random(19);
+	int decoded = 0, failed = 0;
+	std::vector<unsigned char> rgba;
+	std::string error;
+	for (int i = 0; i < 3000; i++) {
+		std::string file = files[random() % files.size()];
+		for (int flips = 1 + random() % 4; flips > 0; flips--) { file[random() % file.size()] = (char)random(); }
+		if (random() % 4 == 0) { file.resize(random() % file.size()); }
+		// The size is in the header, keep the decodes small.
+		if (file.size() >= 16 && (unsigned char)file[13] | (unsigned char)file[15]) { continue; }
+		Decode(file, rgba, error) ? decoded++ : failed++;
+	}
+	printf("  %d damaged files decoded, %d failed\n", decoded, failed);
+	CHECK(decoded > 0 && failed > 0);
+}
+
+TEST(TargaBenchmark) {
+	const int width = 2048, height = 1024;
+	std::vector<unsigned char> image = RandomBytes((size_t)width * height * 4, 20);
+	double megabytes = image.size() / 1e6;
+
+	std::vector<unsigned char> scalar;
+	double scalarTime = TestFramework::Benchmark("scalar flip and swizzle 2048x1024", 5, [&]() { scalar = ScalarFlipSwizzle(image, width, height); });
+	std::vector<unsigned char> vectorized;
+	double vectorizedTime = TestFramework::Benchmark("vectorized flip and swizzle 2048x1024", 5, [&]() {
+		vectorized = image;
+		ImageConverterClass::BgraToRgbaImage(vectorized.data(), width, height, true);
+	});
+	printf("  %.0f MB/s scalar, %.0f MB/s vectorized\n", megabytes / scalarTime * 1000.0, megabytes / vectorizedTime * 1000.0);
+	CHECK(vectorized == scalar);
+
+	for (bool runLength : { false, true }) {
+		TargaFile tga = MakeTarga(2, 32, width, height, 0, 21);
+		std::string file = ToFile(tga, runLength);
+		std::vector<unsigned char> rgba;
+		std::string error;
+		bool success = true;
+		double milliseconds = TestFramework::Benchmark(runLength ? "decode run length 2048x1024" : "decode 2048x1024", 5, [&]() { success = success && Decode(file, rgba, error); });
+		printf("  %.0f MB/s of decoded pixels\n", megabytes / milliseconds * 1000.0);
+		CHECK(success);
+	}
+}
@@ -0,0 +1,214 @@
+#pragma once
+#include <d3d11_1.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <string.h>
+#include <vector>
+
+// Fakes of the D3D11 device and context the mocked classes are built against. The context counts the calls that reach
+// it, the device hands out reference counted objects and counts how many are still alive. Buffers are memory the
+// context maps the way a driver does: a discard hands out fresh memory filled with garbage, a no-overwrite map the
+// memory of the last discard.
+namespace TestDevice {
+	inline std::atomic<int> liveObjects{ 0 };
+
+	template <class Interface>
+	struct FakeObject : Interface {
+		std::atomic<ULONG> references{ 1 };
+
+		FakeObject() { liveObjects++; }
+		virtual ~FakeObject() { liveObjects--; }
+
+		HRESULT QueryInterface(REFIID, void** object) override {
+			*object = 0;
+			return E_NOINTERFACE;
+		}
+		ULONG AddRef() override { return ++references; }
+		ULONG Release() override {
+			ULONG count = --references;
+			if (count == 0) { delete this; }
+			return count;
+		}
+	};
+
+	struct FakeBuffer : FakeObject<ID3D11Buffer> {
+		D3D11_BUFFER_DESC desc;
+		std::vector<unsigned char> memory;
+		bool discarded = false;	// No-overwrite maps are only valid after a discard.
+		bool mapped = false;
+
+		FakeBuffer(const D3D11_BUFFER_DESC& bufferDesc) : desc(bufferDesc) {}
+	};
+
+	class FakeContext : public ID3D11DeviceContext1 {
+	public:
+		// Without the 11.1 interface the context is what the 11.0 runtime hands out.
+		FakeContext(bool context1 = true) : m_context1(context1) {}
+
+		std::map<std::string, int> calls;
+		int total = 0;
+		// Of the last constant buffer bound to the vertex shader, 0 constants for the whole buffer.
+		UINT firstConstant = 0;
+		UINT constantCount = 0;
+		UINT renderTargetCount = 0;
+		FLOAT blendFactor[4] = {};
+		ULONG references = 1;
+		int discards = 0;
+		int noOverwrites = 0;
+		int invalidMaps = 0;	// Maps the runtime would have failed.
+		bool failMaps = false;	// Every map fails, as for a device that was removed.
+
+		int Count(const char* method) const {
+			auto found = calls.find(method);
+			return found == calls.end() ? 0 : found->second;
+		}
+
+		HRESULT QueryInterface(REFIID riid, void** object) override {
+			*object = 0;
+			if (!(riid == IID_ID3D11DeviceContext1) || !m_context1) { return E_NOINTERFACE; }
+			*object = static_cast<ID3D11DeviceContext1*>(this);
+			AddRef();
+			return S_OK;
+		}
+		ULONG AddRef() override { return ++references; }
+		ULONG Release() override { return --references; }	// Lives on the test's stack.
+
+		void IASetInputLayout(ID3D11InputLayout*) override { Record("IASetInputLayout"); }
+		void IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override { Record("IASetVertexBuffers"); }
+		void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override { Record("IASetIndexBuffer"); }
+		void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override { Record("IASetPrimitiveTopology"); }
+		void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override { Record("VSSetShader"); }
+		void VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override {
+			Record("VSSetConstantBuffers");
+			firstConstant = 0;
+			constantCount = 0;
+		}
+		void VSSetConstantBuffers1(UINT, UINT, ID3D11Buffer* const*, const UINT* first, const UINT* count) override {
+			Record("VSSetConstantBuffers1");
+			firstConstant = *first;
+			constantCount = *count;
+		}
+		void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override { Record("PSSetShader"); }
+		void PSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override { Record("PSSetConstantBuffers"); }
+		void PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*) override { Record("PSSetShaderResources"); }
+		void PSSetSamplers(UINT, UINT, ID3D11SamplerState* const*) override { Record("PSSetSamplers"); }
+		void RSSetState(ID3D11RasterizerState*) override { Record("RSSetState"); }
+		void RSSetViewports(UINT, const D3D11_VIEWPORT*) override { Record("RSSetViewports"); }
+		void OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override {
+			Record("OMSetRenderTargets");
+			renderTargetCount = count;
+		}
+		void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override { Record("OMSetDepthStencilState"); }
+		void OMSetBlendState(ID3D11BlendState*, const FLOAT factor[4], UINT) override {
+			Record("OMSetBlendState");
+			for (int i = 0; i < 4; i++) { blendFactor[i] = factor ? factor[i] : 1.0f; }
+		}
+		void DrawIndexed(UINT, UINT, INT) override { Record("DrawIndexed"); }
+
+		HRESULT Map(ID3D11Resource* resource, UINT, D3D11_MAP type, UINT, D3D11_MAPPED_SUBRESOURCE* mapped) override {
+			Record("Map");
+			*mapped = {};
+			FakeBuffer* buffer = static_cast<FakeBuffer*>(resource);
+			bool valid = !buffer->mapped && (buffer->desc.CPUAccessFlags & D3D11_CPU_ACCESS_WRITE) &&
+				(type == D3D11_MAP_WRITE_DISCARD || (type == D3D11_MAP_WRITE_NO_OVERWRITE && buffer->discarded));
+			if (!valid) {
+				invalidMaps++;
+				return E_INVALIDARG;
+			}
+			if (failMaps) { return E_FAIL; }
+
+			if (type == D3D11_MAP_WRITE_DISCARD) {
+				discards++;
+				buffer->memory.assign(buffer->desc.ByteWidth, 0xcd);
+				buffer->discarded = true;
+			} else {
+				noOverwrites++;
+			}
+			buffer->mapped = true;
+			mapped->pData = buffer->memory.data();
+			mapped->RowPitch = buffer->desc.ByteWidth;
+			mapped->DepthPitch = buffer->desc.ByteWidth;
+			return S_OK;
+		}
+		void Unmap(ID3D11Resource* resource, UINT) override {
+			Record("Unmap");
+			FakeBuffer* buffer = static_cast<FakeBuffer*>(resource);
+			if (!buffer->mapped) { invalidMaps++; }
+			buffer->mapped = false;
+		}
+
+	private:
+		void Record(const char* method) {
+			calls[method]++;
+			total++;
+		}
+
+		bool m_context1;
+	};
+
+	class FakeDevice : public ID3D11Device {
+	public:
+		std::atomic<int> creates{ 0 };
+		bool refuse = false;	// Every create fails, as for a description the device does not accept.
+		// The 11.0 runtime fails the 11.1 options query, the 11.1 runtime reports what the driver does.
+		bool runtime11_1 = true;
+		BOOL constantBufferOffsetting = 1;
+		BOOL mapNoOverwriteOnDynamicConstantBuffer = 1;
+		D3D11_BUFFER_DESC bufferDesc{};	// Of the last buffer created.
+		std::vector<D3D11_INPUT_ELEMENT_DESC> inputElements;	// Of the last input layout created.
+		SIZE_T bytecodeLength = 0;
+
+		HRESULT QueryInterface(REFIID, void** object) override {
+			*object = 0;
+			return E_NOINTERFACE;
+		}
+		ULONG AddRef() override { return 1; }
+		ULONG Release() override { return 1; }
+
+		HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState** state) override { return Create(state); }
+		HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC*, ID3D11DepthStencilState** state) override { return Create(state); }
+		HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState** state) override { return Create(state); }
+		HRESULT CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState** state) override { return Create(state); }
+
+		HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* data, ID3D11Buffer** buffer) override {
+			creates++;
+			bufferDesc = *desc;
+			*buffer = 0;
+			if (refuse) { return E_INVALIDARG; }
+			FakeBuffer* created = new FakeBuffer(*desc);
+			if (data) {
+				created->memory.assign((const unsigned char*)data->pSysMem, (const unsigned char*)data->pSysMem + desc->ByteWidth);
+			}
+			*buffer = created;
+			return S_OK;
+		}
+		HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT count, const void*, SIZE_T length,
+			ID3D11InputLayout** layout) override {
+			inputElements.assign(elements, elements + count);
+			bytecodeLength = length;
+			return Create(layout);
+		}
+		HRESULT CheckFeatureSupport(D3D11_FEATURE feature, void* data, UINT size) override {
+			if (!runtime11_1 || feature != D3D11_FEATURE_D3D11_OPTIONS || size != sizeof(D3D11_FEATURE_DATA_D3D11_OPTIONS)) {
+				return E_INVALIDARG;
+			}
+			D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+			memset(&options, 0, sizeof(options));
+			options.ConstantBufferOffsetting = constantBufferOffsetting;
+			options.MapNoOverwriteOnDynamicConstantBuffer = mapNoOverwriteOnDynamicConstantBuffer;
+			memcpy(data, &options, sizeof(options));
+			return S_OK;
+		}
+
+	private:
+		template <class Interface>
+		HRESULT Create(Interface** object) {
+			creates++;
+			*object = 0;
+			if (refuse) { return E_INVALIDARG; }
+			*object = new FakeObject<Interface>();
+			return S_OK;
+		}
+	};
+}
@@ -0,0 +1,62 @@
+#include "testframework.hpp"
+#include <string.h>
+#include <filesystem>
+
+namespace {
+	struct TestCase {
+		const char* name;
+		TestFramework::TestFunction function;
+	};
+
+	std::vector<TestCase>& GetTests() {
+		static std::vector<TestCase> tests;	// Filled by the static initializers of every test file.
+		return tests;
+	}
+
+	int failures = 0;
+	std::filesystem::path tempDirectory;
+}
+
+bool TestFramework::Register(const char* name, TestFunction function) {
+	GetTests().push_back({ name, function });
+	return true;
+}
+
+void TestFramework::Fail(const char* file, int line, const char* condition) {
+	printf("  %s:%d: CHECK(%s) failed\n", file, line, condition);
+	failures++;
+}
+
+std::string TestFramework::GetTempFilename(const char* name) {
+	static int counter = 0;
+	std::filesystem::path path = tempDirectory / (std::to_string(counter++) + "-" + name);
+	return path.string();
+}
+
+int TestFramework::Run(int argc, char** argv) {
+	// One directory per executable, ctest may run several of them at once.
+	std::error_code error;
+	tempDirectory = std::filesystem::temp_directory_path(error) / "engine-tests" / std::filesystem::path(argv[0]).stem();
+	std::filesystem::remove_all(tempDirectory, error);
+	std::filesystem::create_directories(tempDirectory, error);
+
+	int failed = 0, run = 0;
+	for (const TestCase& test : GetTests()) {
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++) { selected = selected || strcmp(argv[i], test.name) == 0; }
+		if (!selected) { continue; }
+
+		printf("%s\n", test.name);
+		fflush(stdout);
+		int before = failures;
+		test.function();
+		run++;
+		if (failures != before) { failed++; }
+	}
+	printf("%d of %d tests passed\n", run - failed, run);
+	return failed == 0 && run > 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+	return TestFramework::Run(argc, argv);
+}
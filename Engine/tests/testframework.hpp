@@ -0,0 +1,42 @@
+#pragma once
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Just enough of a test runner for the headless build. TEST registers a case, CHECK reports a failed condition and
+// carries on so one run shows every failure. The main in testframework.cpp runs the cases of its executable, or the
+// ones named on the command line, and fails the run when any check did.
+class TestFramework {
+public:
+	typedef void (*TestFunction)();
+
+	static bool Register(const char* name, TestFunction function);
+	static void Fail(const char* file, int line, const char* condition);
+	static int Run(int argc, char** argv);
+
+	// A fresh file name in the test directory, which is emptied when the run starts.
+	static std::string GetTempFilename(const char* name);
+
+	// Runs function repeat times and prints the average. Returns it, in milliseconds.
+	template <typename Function>
+	static double Benchmark(const char* name, int repeat, Function function) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeat; i++) { function(); }
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeat;
+		printf("  benchmark %-40s %10.3f ms\n", name, milliseconds);
+		return milliseconds;
+	}
+};
+
+#define TEST(name) \
+	static void name(); \
+	static const bool name##Registered = TestFramework::Register(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) { TestFramework::Fail(__FILE__, __LINE__, #condition); } } while (0)
+
+// For the floating point results, where the exact value depends on the compiler.
+#define CHECK_NEAR(value, expected, tolerance) \
+	CHECK(((value) > (expected) ? (value) - (expected) : (expected) - (value)) <= (tolerance))
@@ -0,0 +1,126 @@
+#pragma once
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include "meshtypes.hpp"
+
+// Synthesized meshes for the tests, so none of them depend on asset files.
+namespace TestMeshes {
+	// A quads by quads grid of two triangles each over the unit square, rippled in z so the normals vary. Faces -z, with
+	// the engine's clockwise fronts (b - a) x (c - a) points along the normals.
+	inline MeshData MakeGrid(uint32_t quads) {
+		MeshData mesh;
+		uint32_t side = quads + 1;
+		for (uint32_t y = 0; y < side; y++) {
+			for (uint32_t x = 0; x < side; x++) {
+				float u = (float)x / quads, v = (float)y / quads;
+				MeshVertex vertex;
+				vertex.Position()[0] = u;
+				vertex.Position()[1] = v;
+				vertex.Position()[2] = 0.05f * sinf(u * 6.2831853f) * cosf(v * 6.2831853f);
+				vertex.Texcoord()[0] = u;
+				vertex.Texcoord()[1] = v;
+				float dx = 0.05f * 6.2831853f * cosf(u * 6.2831853f) * cosf(v * 6.2831853f);
+				float dy = -0.05f * 6.2831853f * sinf(u * 6.2831853f) * sinf(v * 6.2831853f);
+				float length = sqrtf(dx * dx + dy * dy + 1.0f);
+				vertex.Normal()[0] = dx / length;
+				vertex.Normal()[1] = dy / length;
+				vertex.Normal()[2] = -1.0f / length;
+				mesh.vertices.push_back(vertex);
+				mesh.bounds.Add(vertex.Position());
+			}
+		}
+		for (uint32_t y = 0; y < quads; y++) {
+			for (uint32_t x = 0; x < quads; x++) {
+				unsigned int corner = y * side + x;
+				unsigned int quad[6] = { corner, corner + side, corner + 1, corner + side, corner + side + 1, corner + 1 };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	// Latitude and longitude rings around center, fronts outside. The texture seam and the poles repeat positions
+	// exactly, the way a welded mesh has them.
+	inline MeshData MakeSphere(uint32_t rings, uint32_t segments, float radius, const float center[3]) {
+		MeshData mesh;
+		for (uint32_t ring = 0; ring <= rings; ring++) {
+			float theta = 3.14159265f * ring / rings;
+			float sine = ring == 0 || ring == rings ? 0.0f : sinf(theta), cosine = ring == rings ? -1.0f : cosf(theta);
+			for (uint32_t segment = 0; segment <= segments; segment++) {
+				float phi = 6.2831853f * (segment % segments) / segments;
+				MeshVertex vertex;
+				float normal[3] = { sine * cosf(phi), cosine, sine * sinf(phi) };
+				for (int k = 0; k < 3; k++) {
+					vertex.Position()[k] = center[k] + normal[k] * radius;
+					vertex.Normal()[k] = normal[k];
+				}
+				vertex.Texcoord()[0] = (float)segment / segments;
+				vertex.Texcoord()[1] = (float)ring / rings;
+				mesh.vertices.push_back(vertex);
+				mesh.bounds.Add(vertex.Position());
+			}
+		}
+		for (uint32_t ring = 0; ring < rings; ring++) {
+			for (uint32_t segment = 0; segment < segments; segment++) {
+				unsigned int corner = ring * (segments + 1) + segment, below = corner + segments + 1;
+				// The rows at the poles are fans, the triangle that would have an edge of no length is left out.
+				if (ring != 0) { mesh.indices.insert(mesh.indices.end(), { corner, corner + 1, below }); }
+				if (ring + 1 != rings) { mesh.indices.insert(mesh.indices.end(), { corner + 1, below + 1, below }); }
+			}
+		}
+		return mesh;
+	}
+
+	// Every corner its own vertex, the way the text format and unindexed imports arrive.
+	inline MeshData MakeSoup(const MeshData& indexed) {
+		MeshData mesh;
+		for (unsigned int index : indexed.indices) {
+			mesh.indices.push_back((unsigned int)mesh.vertices.size());
+			mesh.vertices.push_back(indexed.vertices[index]);
+		}
+		mesh.bounds = indexed.bounds;
+		return mesh;
+	}
+
+	// In the "Vertex Count: / Data:" text format, one row per corner.
+	inline bool WriteTextModel(const char* filename, const MeshData& mesh) {
+		FILE* file = fopen(filename, "wb");
+		if (!file) { return false; }
+		fprintf(file, "Vertex Count: %zu\n\nData:\n\n", mesh.indices.size());
+		for (unsigned int index : mesh.indices) {
+			const MeshVertex& v = mesh.vertices[index];
+			fprintf(file, "%.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n", v.Position()[0], v.Position()[1], v.Position()[2],
+				v.Texcoord()[0], v.Texcoord()[1], v.Normal()[0], v.Normal()[1], v.Normal()[2]);
+		}
+		return fclose(file) == 0;
+	}
+
+	// Every triangle as its vertices, rotated so the smallest comes first, in sorted order. Equal for meshes that draw
+	// the same triangles with the same winding, whatever order they come in.
+	inline std::vector<std::array<float, 24>> GetTriangles(const MeshData& mesh) {
+		std::vector<std::array<float, 24>> triangles;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			std::array<std::array<float, 8>, 3> corners;
+			for (int k = 0; k < 3; k++) {
+				const MeshVertex& v = mesh.vertices[mesh.indices[i + k]];
+				std::copy(std::begin(v.components), std::end(v.components), corners[k].begin());
+			}
+			int first = (int)(std::min_element(corners.begin(), corners.end()) - corners.begin());
+			std::array<float, 24> triangle;
+			for (int k = 0; k < 3; k++) { std::copy(corners[(first + k) % 3].begin(), corners[(first + k) % 3].end(), triangle.begin() + k * 8); }
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	inline bool SameVertex(const MeshVertex& a, const MeshVertex& b) {
+		for (int k = 0; k < 3; k++) {
+			if (a.Position()[k] != b.Position()[k] || a.Normal()[k] != b.Normal()[k]) { return false; }
+		}
+		return a.Texcoord()[0] == b.Texcoord()[0] && a.Texcoord()[1] == b.Texcoord()[1];
+	}
+}
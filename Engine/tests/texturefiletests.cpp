@@ -0,0 +1,394 @@
+#include "testframework.hpp"
+#include "testimages.hpp"
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "texturecookerclass.hpp"
+#include "texturefileclass.hpp"
+
+namespace {
+	constexpr size_t DATA_OFFSET = sizeof(DDS_MAGIC) + sizeof(DdsHeader) + sizeof(DdsHeaderDx10);
+	constexpr uint32_t DDPF_FOURCC = 0x4;
+	constexpr uint32_t DDPF_RGB = 0x40;
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	constexpr uint32_t DDSD_DEPTH = 0x800000;
+	constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	constexpr uint32_t DDSCAPS2_CUBEMAP_ALL_FACES = 0xFC00;
+
+	std::string WriteFile(const char* name, const std::string& contents) {
+		std::string filename = TestFramework::GetTempFilename(name);
+		std::ofstream(filename, std::ios::binary) << contents;
+		return filename;
+	}
+
+	std::string ReadFile(const std::string& filename) {
+		std::ifstream fin(filename, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+	}
+
+	bool Opens(const std::string& bytes) {
+		TextureFileClass texture(WriteFile("corrupt.dds", bytes).c_str());
+		return texture.isInitialized;
+	}
+
+	DdsHeader& GetHeader(std::string& bytes) { return *(DdsHeader*)&bytes[sizeof(DDS_MAGIC)]; }
+	DdsHeaderDx10& GetExtension(std::string& bytes) { return *(DdsHeaderDx10*)&bytes[sizeof(DDS_MAGIC) + sizeof(DdsHeader)]; }
+
+	// Random texels in every level of every slice, laid out the way the cooker does.
+	CookedTexture MakeTexture(DXGI_FORMAT format, int width, int height, uint32_t mipLevels, uint32_t arraySize, bool cube) {
+		CookedTexture texture;
+		texture.format = format;
+		texture.width = width;
+		texture.height = height;
+		texture.mipLevels = mipLevels;
+		texture.arraySize = arraySize;
+		texture.cube = cube;
+		texture.cookKey = 0x80001234;
+		for (uint32_t slice = 0; slice < arraySize; slice++) {
+			for (uint32_t mip = 0; mip < mipLevels; mip++) {
+				CookedTextureLevel level{};
+				level.width = std::max(1, width >> mip);
+				level.height = std::max(1, height >> mip);
+				level.offset = texture.data.size();
+				TextureFileClass::GetLevelPitch(format, level.width, level.height, level.rowPitch, level.size);
+				texture.levels.push_back(level);
+				texture.data.resize(texture.data.size() + level.size);
+			}
+		}
+		texture.data = TestImages::RandomBytes(texture.data.size(), (unsigned)(width * 7 + arraySize));
+		return texture;
+	}
+
+	bool MatchesFile(const CookedTexture& texture, const TextureFileClass& file) {
+		if (!file.isInitialized || file.GetFormat() != texture.format || file.GetWidth() != texture.width || file.GetHeight() != texture.height) {
+			return false;
+		}
+		if (file.GetMipLevels() != texture.mipLevels || file.GetArraySize() != texture.arraySize || file.IsCube() != texture.cube) { return false; }
+		if (file.GetLevels().size() != texture.levels.size()) { return false; }
+		size_t offset = DATA_OFFSET;
+		for (size_t i = 0; i < texture.levels.size(); i++) {
+			const CookedTextureLevel& expected = texture.levels[i];
+			const CookedTextureLevel& level = file.GetLevels()[i];
+			if (level.width != expected.width || level.height != expected.height || level.rowPitch != expected.rowPitch) { return false; }
+			if (level.size != expected.size || level.offset != offset) { return false; }
+			if (memcmp(file.GetLevelData(i), texture.data.data() + expected.offset, expected.size) != 0) { return false; }
+			offset += level.size;
+		}
+		return true;
+	}
+
+	// A file as older tools write it, with no DX10 header. Levels are left zero.
+	std::string MakeLegacy(const DdsPixelFormat& format, int size, uint32_t mipLevels, uint32_t caps2, size_t texelBytes) {
+		DdsHeader header{};
+		header.size = sizeof(DdsHeader);
+		header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | DDSD_MIPMAPCOUNT;
+		header.width = header.height = (uint32_t)size;
+		header.mipMapCount = mipLevels;
+		header.format = format;
+		header.format.size = sizeof(DdsPixelFormat);
+		header.caps = 0x1000;
+		header.caps2 = caps2;
+		std::string bytes(DDS_MAGIC, sizeof(DDS_MAGIC));
+		bytes.append((const char*)&header, sizeof(header));
+		size_t faces = caps2 & DDSCAPS2_CUBEMAP ? 6 : 1;
+		for (size_t face = 0; face < faces; face++) {
+			for (uint32_t mip = 0; mip < mipLevels; mip++) { bytes.append(std::max(1, size >> mip) * std::max(1, size >> mip) * texelBytes, '\0'); }
+		}
+		return bytes;
+	}
+
+	constexpr uint32_t FourCC(const char* code) {
+		return (uint32_t)(unsigned char)code[0] | (uint32_t)(unsigned char)code[1] << 8 | (uint32_t)(unsigned char)code[2] << 16 |
+			(uint32_t)(unsigned char)code[3] << 24;
+	}
+}
+
+TEST(LevelPitches) {
+	size_t rowPitch = 0, size = 0;
+	CHECK(TextureFileClass::GetLevelPitch(DXGI_FORMAT_R8G8B8A8_UNORM, 13, 7, rowPitch, size) && rowPitch == 52 && size == 52 * 7);
+	CHECK(TextureFileClass::GetLevelPitch(DXGI_FORMAT_BC1_UNORM, 13, 7, rowPitch, size) && rowPitch == 4 * 8 && size == 4 * 8 * 2);
+	CHECK(TextureFileClass::GetLevelPitch(DXGI_FORMAT_BC7_UNORM, 1, 1, rowPitch, size) && rowPitch == 16 && size == 16);
+	CHECK(TextureFileClass::GetLevelPitch(DXGI_FORMAT_R16G16B16A16_FLOAT, 3, 2, rowPitch, size) && rowPitch == 24 && size == 48);
+	CHECK(TextureFileClass::GetLevelPitch(DXGI_FORMAT_R9G9B9E5_SHAREDEXP, 5, 1, rowPitch, size) && rowPitch == 20);
+	CHECK(TextureFileClass::GetLevelPitch(DXGI_FORMAT_R8_UNORM, 5, 3, rowPitch, size) && rowPitch == 5 && size == 15);
+	CHECK(!TextureFileClass::GetLevelPitch(DXGI_FORMAT_UNKNOWN, 4, 4, rowPitch, size));
+	CHECK(TextureFileClass::GetBlockSize(DXGI_FORMAT_BC5_UNORM) == 4 && TextureFileClass::GetBlockSize(DXGI_FORMAT_B8G8R8A8_UNORM) == 1);
+	CHECK(TextureFileClass::GetBlockSize(DXGI_FORMAT_UNKNOWN) == 0);
+}
+
+TEST(RoundTrip) {
+	// Levels map back at the offsets D3D11 uploads them from, back to back after the headers in subresource order.
+	const CookedTexture textures[] = {
+		MakeTexture(DXGI_FORMAT_R8G8B8A8_UNORM, 13, 7, 4, 1, false),
+		MakeTexture(DXGI_FORMAT_BC7_UNORM, 16, 8, 5, 1, false),
+		MakeTexture(DXGI_FORMAT_BC1_UNORM, 8, 8, 4, 6, true),
+		MakeTexture(DXGI_FORMAT_R16G16B16A16_FLOAT, 6, 6, 2, 3, false),
+		MakeTexture(DXGI_FORMAT_R9G9B9E5_SHAREDEXP, 1, 1, 1, 1, false),
+	};
+	for (const CookedTexture& texture : textures) {
+		std::string filename = TestFramework::GetTempFilename("roundtrip.dds");
+		CHECK(TextureFileClass::Write(filename.c_str(), texture));
+		CHECK(!std::filesystem::exists(filename + ".tmp"));
+		CHECK(std::filesystem::file_size(filename) == DATA_OFFSET + texture.data.size());
+		TextureFileClass file(filename.c_str());
+		CHECK(MatchesFile(texture, file));
+		CHECK(file.GetCookKey() == texture.cookKey);
+	}
+
+	// A cube stores six slices a cube and counts cubes in its DX10 header.
+	std::string filename = TestFramework::GetTempFilename("cube.dds");
+	TextureFileClass::Write(filename.c_str(), textures[2]);
+	std::string bytes = ReadFile(filename);
+	CHECK(GetExtension(bytes).arraySize == 1 && (GetHeader(bytes).caps2 & DDSCAPS2_CUBEMAP_ALL_FACES) == DDSCAPS2_CUBEMAP_ALL_FACES);
+
+	// Writing over an older file replaces it whole.
+	CHECK(TextureFileClass::Write(filename.c_str(), textures[4]));
+	TextureFileClass replaced(filename.c_str());
+	CHECK(MatchesFile(textures[4], replaced));
+}
+
+TEST(WriteRejects) {
+	std::string filename = TestFramework::GetTempFilename("rejected.dds");
+	CookedTexture texture = MakeTexture(DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 3, 1, false);
+	CookedTexture unknown = texture;
+	unknown.format = DXGI_FORMAT_UNKNOWN;
+	CHECK(!TextureFileClass::Write(filename.c_str(), unknown));
+	CookedTexture missingLevel = texture;
+	missingLevel.levels.pop_back();
+	CHECK(!TextureFileClass::Write(filename.c_str(), missingLevel));
+	CookedTexture pastData = texture;
+	pastData.levels.back().offset = pastData.data.size() - 1;
+	CHECK(!TextureFileClass::Write(filename.c_str(), pastData));
+	CookedTexture partCube = MakeTexture(DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 4, true);
+	CHECK(!TextureFileClass::Write(filename.c_str(), partCube));
+	CookedTexture empty;
+	empty.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	CHECK(!TextureFileClass::Write(filename.c_str(), empty));
+	CHECK(!std::filesystem::exists(filename));
+	CHECK(!TextureFileClass::Write((TestFramework::GetTempFilename("missing") + "/directory/rejected.dds").c_str(), texture));
+}
+
+TEST(CorruptFiles) {
+	std::string filename = TestFramework::GetTempFilename("valid.dds");
+	TextureFileClass::Write(filename.c_str(), MakeTexture(DXGI_FORMAT_BC3_UNORM, 32, 16, 6, 2, false));
+	const std::string valid = ReadFile(filename);
+	CHECK(Opens(valid));
+
+	// Cut anywhere, the file is refused rather than read past its end.
+	bool refused = true;
+	for (size_t size = 0; size < valid.size(); size += size < DATA_OFFSET ? 1 : 7) { refused = refused && !Opens(valid.substr(0, size)); }
+	CHECK(refused && !Opens(valid.substr(0, valid.size() - 1)));
+	CHECK(Opens(valid + std::string(100, 'x')));
+
+	auto corrupt = [&](auto change) {
+		std::string bytes = valid;
+		change(bytes);
+		return Opens(bytes);
+	};
+	CHECK(!corrupt([](std::string& bytes) { bytes[0] = 'X'; }));
+	CHECK(!corrupt([](std::string& bytes) { GetHeader(bytes).size = 100; }));
+	CHECK(!corrupt([](std::string& bytes) { GetHeader(bytes).format.size = 0; }));
+	CHECK(!corrupt([](std::string& bytes) { GetHeader(bytes).flags |= DDSD_DEPTH; }));
+	CHECK(!corrupt([](std::string& bytes) { GetHeader(bytes).width = 0; }));
+	CHECK(!corrupt([](std::string& bytes) { GetHeader(bytes).height = 16385; }));
+	CHECK(!corrupt([](std::string& bytes) { GetHeader(bytes).mipMapCount = 7; }));	// 32x16 has six levels.
+	CHECK(!corrupt([](std::string& bytes) { GetExtension(bytes).resourceDimension = 4; }));
+	CHECK(!corrupt([](std::string& bytes) { GetExtension(bytes).arraySize = 0; }));
+	CHECK(!corrupt([](std::string& bytes) { GetExtension(bytes).arraySize = 3; }));	// Data for two.
+	CHECK(!corrupt([](std::string& bytes) { GetExtension(bytes).arraySize = 0x10000000; }));
+	CHECK(!corrupt([](std::string& bytes) { GetExtension(bytes).dxgiFormat = 1000; }));
+	CHECK(!corrupt([](std::string& bytes) { GetExtension(bytes).miscFlag = 0x4; }));	// A cube, but not square and short of faces.
+	CHECK(corrupt([](std::string& bytes) { GetHeader(bytes).mipMapCount = 3; }));	// Fewer levels only leave data over.
+
+	// Files of other tools and older versions load, with no cook key to match.
+	std::string untagged = valid;
+	memset(GetHeader(untagged).reserved1, 0, sizeof(GetHeader(untagged).reserved1));
+	TextureFileClass other(WriteFile("untagged.dds", untagged).c_str());
+	CHECK(other.isInitialized && other.GetCookKey() == 0);
+	std::string older = valid;
+	GetHeader(older).reserved1[1] = TEXTURE_FILE_VERSION + 1;
+	TextureFileClass version(WriteFile("version.dds", older).c_str());
+	CHECK(version.isInitialized && version.GetCookKey() == 0);
+	TextureFileClass missing(TestFramework::GetTempFilename("missing.dds").c_str());
+	CHECK(!missing.isInitialized);
+
+	// Random bytes after a valid header, none may crash.
+	int opened = 0;
+	for (unsigned seed = 1; seed <= 300; seed++) {
+		std::string bytes = valid;
+		std::vector<unsigned char> noise = TestImages::RandomBytes(4, seed);
+		size_t position = noise[0] % DATA_OFFSET;
+		bytes[position] = (char)noise[1];
+		if (seed % 3 == 0) { bytes.resize(DATA_OFFSET + noise[2] * 4); }
+		opened += Opens(bytes);
+	}
+	printf("  %d of 300 corrupted files still opened\n", opened);
+}
+
+TEST(LegacyHeaders) {
+	DdsPixelFormat dxt1{};
+	dxt1.flags = DDPF_FOURCC;
+	dxt1.fourCC = FourCC("DXT1");
+	TextureFileClass bc1(WriteFile("dxt1.dds", MakeLegacy(dxt1, 16, 5, 0, 0) + std::string(128 + 32 + 8 + 8 + 8, '\0')).c_str());
+	CHECK(bc1.isInitialized && bc1.GetFormat() == DXGI_FORMAT_BC1_UNORM && bc1.GetMipLevels() == 5 && bc1.GetCookKey() == 0);
+	CHECK(bc1.GetLevels()[0].offset == sizeof(DDS_MAGIC) + sizeof(DdsHeader) && bc1.GetLevels()[0].size == 128);
+
+	const std::pair<const char*, DXGI_FORMAT> fourCCs[] = { { "DXT5", DXGI_FORMAT_BC3_UNORM }, { "ATI2", DXGI_FORMAT_BC5_UNORM },
+		{ "BC4U", DXGI_FORMAT_BC4_UNORM }, { "DXT3", DXGI_FORMAT_BC2_UNORM } };
+	for (const auto& [code, format] : fourCCs) {
+		DdsPixelFormat pixelFormat{};
+		pixelFormat.flags = DDPF_FOURCC;
+		pixelFormat.fourCC = FourCC(code);
+		TextureFileClass file(WriteFile("legacy.dds", MakeLegacy(pixelFormat, 8, 1, 0, 2)).c_str());
+		CHECK(file.isInitialized && file.GetFormat() == format);
+	}
+	DdsPixelFormat unknown{};
+	unknown.flags = DDPF_FOURCC;
+	unknown.fourCC = FourCC("ABCD");
+	CHECK(!Opens(MakeLegacy(unknown, 8, 1, 0, 4)));
+
+	// Uncompressed 32 bit, told apart by the masks.
+	DdsPixelFormat masks{};
+	masks.flags = DDPF_RGB;
+	masks.rgbBitCount = 32;
+	masks.rBitMask = 0xFF, masks.gBitMask = 0xFF00, masks.bBitMask = 0xFF0000, masks.aBitMask = 0xFF000000;
+	TextureFileClass rgba(WriteFile("rgba.dds", MakeLegacy(masks, 4, 3, 0, 4)).c_str());
+	CHECK(rgba.isInitialized && rgba.GetFormat() == DXGI_FORMAT_R8G8B8A8_UNORM && rgba.GetLevels().size() == 3);
+	masks.rBitMask = 0xFF0000, masks.bBitMask = 0xFF;
+	TextureFileClass bgra(WriteFile("bgra.dds", MakeLegacy(masks, 4, 1, 0, 4)).c_str());
+	CHECK(bgra.isInitialized && bgra.GetFormat() == DXGI_FORMAT_B8G8R8A8_UNORM);
+	masks.aBitMask = 0;
+	TextureFileClass bgrx(WriteFile("bgrx.dds", MakeLegacy(masks, 4, 1, 0, 4)).c_str());
+	CHECK(bgrx.isInitialized && bgrx.GetFormat() == DXGI_FORMAT_B8G8R8X8_UNORM);
+	masks.rgbBitCount = 24;
+	CHECK(!Opens(MakeLegacy(masks, 4, 1, 0, 3)));
+
+	// Cube maps need all six faces.
+	masks.rgbBitCount = 32;
+	TextureFileClass cube(WriteFile("cube.dds", MakeLegacy(masks, 4, 3, DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALL_FACES, 4)).c_str());
+	CHECK(cube.isInitialized && cube.IsCube() && cube.GetArraySize() == 6 && cube.GetLevels().size() == 18);
+	CHECK(!Opens(MakeLegacy(masks, 4, 3, DDSCAPS2_CUBEMAP | 0x0C00, 4)));
+}
+
+TEST(CookAndStale) {
+	// A photo with alpha and the same photo opaque, as PNG and TGA sources.
+	const int width = 64, height = 32;
+	TestImages::PngImage image;
+	image.width = width;
+	image.height = height;
+	std::vector<unsigned char> pixels = TestImages::MakePhoto(width, height, 4, 12);
+	image.samples.assign(pixels.begin(), pixels.end());
+	std::string translucent = WriteFile("translucent.png", TestImages::ToPng(image));
+	for (size_t i = 3; i < image.samples.size(); i += 4) { image.samples[i] = 255; }
+	std::string opaque = WriteFile("opaque.png", TestImages::ToPng(image));
+	std::string tga(18, '\0');
+	tga[2] = 2, tga[12] = (char)width, tga[14] = (char)height, tga[16] = 32, tga[17] = 0x28;
+	for (size_t i = 0; i < pixels.size(); i += 4) { tga += { (char)pixels[i + 2], (char)pixels[i + 1], (char)pixels[i], (char)255 }; }
+	std::string targa = WriteFile("opaque.tga", tga);
+
+	CHECK(TextureCookerClass::GetCookedFilename("data/stone01.tga") == std::filesystem::path("data/stone01.dds").string());
+
+	TextureCookSettings settings;
+	settings.measureQuality = true;
+	const std::pair<std::string, DXGI_FORMAT> sources[] = { { opaque, DXGI_FORMAT_BC1_UNORM }, { translucent, DXGI_FORMAT_BC3_UNORM },
+		{ targa, DXGI_FORMAT_BC1_UNORM } };
+	for (const auto& [source, format] : sources) {
+		std::string cooked = TextureCookerClass::GetCookedFilename(source.c_str());
+		CHECK(TextureCookerClass::IsStale(source.c_str(), cooked.c_str(), settings));
+		TextureCookReport report;
+		CHECK(TextureCookerClass::Cook(source.c_str(), cooked.c_str(), settings, report));
+		CHECK(report.error.empty() && report.format == format && report.psnr > 35.0);
+		CHECK(report.bitsPerTexel == (format == DXGI_FORMAT_BC1_UNORM ? 4.0 : 8.0));
+		CHECK(report.uncompressedBytes == MipGeneratorClass::GetChainSize(width, height));
+		CHECK(report.cookedBytes * (format == DXGI_FORMAT_BC1_UNORM ? 8 : 4) > report.uncompressedBytes);
+		TextureFileClass file(cooked.c_str());
+		CHECK(file.isInitialized && file.GetFormat() == format && file.GetMipLevels() == 7 && file.GetCookKey() == TextureCookerClass::GetCookKey(settings));
+		CHECK(!TextureCookerClass::IsStale(source.c_str(), cooked.c_str(), settings));
+	}
+
+	// Every setting is in the key, so changing any of them cooks again.
+	std::string cooked = TextureCookerClass::GetCookedFilename(opaque.c_str());
+	TextureCookSettings changes[5] = { settings, settings, settings, settings, settings };
+	changes[0].compression = TEXTURE_COMPRESSION_BC7;
+	changes[1].quality = BLOCK_QUALITY_HIGH;
+	changes[2].mipFilter = MIP_FILTER_BOX;
+	changes[3].srgb = false;
+	changes[4].hdrFormat = TEXTURE_HDR_HALF;
+	for (const TextureCookSettings& changed : changes) {
+		CHECK(TextureCookerClass::GetCookKey(changed) != TextureCookerClass::GetCookKey(settings));
+		CHECK(TextureCookerClass::IsStale(opaque.c_str(), cooked.c_str(), changed));
+	}
+	TextureCookSettings measured = settings;
+	measured.measureQuality = false;
+	CHECK(!TextureCookerClass::IsStale(opaque.c_str(), cooked.c_str(), measured));
+
+	// A newer source, a cooked file that was shipped alone, and a source that is a DDS file already.
+	std::filesystem::last_write_time(opaque, std::filesystem::last_write_time(cooked) + std::chrono::seconds(5));
+	CHECK(TextureCookerClass::IsStale(opaque.c_str(), cooked.c_str(), settings));
+	std::filesystem::remove(opaque);
+	CHECK(!TextureCookerClass::IsStale(opaque.c_str(), cooked.c_str(), settings));
+	CHECK(!TextureCookerClass::IsStale(cooked.c_str(), cooked.c_str(), changes[0]));
+
+	// Sizes that are not whole blocks stay RGBA8, and the chain is the mip generator's.
+	TestImages::PngImage odd;
+	odd.width = 13;
+	odd.height = 7;
+	std::vector<unsigned char> oddPixels = TestImages::MakePhoto(13, 7, 4, 13);
+	odd.samples.assign(oddPixels.begin(), oddPixels.end());
+	std::string oddSource = WriteFile("odd.png", TestImages::ToPng(odd));
+	CookedTexture texture;
+	TextureCookReport report;
+	CHECK(TextureCookerClass::Cook(oddSource.c_str(), settings, texture, report));
+	std::vector<unsigned char> chain(MipGeneratorClass::GetChainSize(13, 7));
+	std::copy(oddPixels.begin(), oddPixels.end(), chain.begin());
+	MipGeneratorClass::Generate(chain.data(), 13, 7, settings.mipFilter, settings.srgb);
+	CHECK(texture.format == DXGI_FORMAT_R8G8B8A8_UNORM && texture.mipLevels == 4 && texture.data == chain && report.bitsPerTexel == 32.0);
+
+	CHECK(!TextureCookerClass::Cook(WriteFile("broken.png", "\x89PNG\r\n\x1a\n broken").c_str(), settings, texture, report) && !report.error.empty());
+	report.error.clear();
+	CHECK(!TextureCookerClass::Cook(TestFramework::GetTempFilename("missing.tga").c_str(), settings, texture, report) && !report.error.empty());
+}
+
+TEST(LoadBenchmark) {
+	// Cold is the first run, decoding the source, building the mips and compressing them. Warm maps the cooked file,
+	// whose levels are used in place. Reading the same file into the heap is what the loader did before mapping.
+	const int size = 1024;
+	TestImages::PngImage image;
+	image.width = image.height = size;
+	std::vector<unsigned char> pixels = TestImages::MakePhoto(size, size, 4, 14);
+	for (size_t i = 3; i < pixels.size(); i += 4) { pixels[i] = 255; }
+	image.samples.assign(pixels.begin(), pixels.end());
+	std::string source = WriteFile("bench.png", TestImages::ToPng(image));
+	std::string cooked = TextureCookerClass::GetCookedFilename(source.c_str());
+	ThreadPoolClass pool;
+	TextureCookSettings settings;
+
+	bool cold = true;
+	double coldTime = TestFramework::Benchmark("cold load, cook 1024x1024 PNG to BC1", 1, [&]() {
+		TextureCookReport report;
+		cold = cold && TextureCookerClass::IsStale(source.c_str(), cooked.c_str(), settings) &&
+			TextureCookerClass::Cook(source.c_str(), cooked.c_str(), settings, report, &pool);
+		TextureFileClass file(cooked.c_str());
+		cold = cold && file.isInitialized;
+	});
+	size_t checksum = 0;
+	bool warm = true;
+	double warmTime = TestFramework::Benchmark("warm load, map the cooked file", 20, [&]() {
+		warm = warm && !TextureCookerClass::IsStale(source.c_str(), cooked.c_str(), settings);
+		TextureFileClass file(cooked.c_str());
+		warm = warm && file.isInitialized;
+		for (size_t i = 0; warm && i < file.GetLevels().size(); i++) {
+			const unsigned char* data = file.GetLevelData(i);
+			for (size_t j = 0; j < file.GetLevels()[i].size; j += 4096) { checksum += data[j]; }
+		}
+	});
+	double heapTime = TestFramework::Benchmark("read the cooked file into the heap", 20, [&]() {
+		std::ifstream fin(cooked, std::ios::binary);
+		std::vector<char> bytes((size_t)std::filesystem::file_size(cooked));
+		fin.read(bytes.data(), (std::streamsize)bytes.size());
+		checksum += (unsigned char)bytes.back();
+	});
+	printf("  cold %.1f ms, warm %.3f ms (%.0fx), heap read %.3f ms, checksum %zu\n", coldTime, warmTime, coldTime / warmTime, heapTime, checksum);
+	CHECK(cold && warm);
+}
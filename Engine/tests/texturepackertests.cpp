@@ -0,0 +1,250 @@
+#include "testframework.hpp"
+#include "testimages.hpp"
+#include <math.h>
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include "texturepackerclass.hpp"
+
+namespace {
+	// A PNG source of the given size, each with its own pixels. Opaque unless asked otherwise.
+	std::string WriteSource(const char* name, int width, int height, unsigned seed, bool opaque = true) {
+		TestImages::PngImage image;
+		image.width = width;
+		image.height = height;
+		std::vector<unsigned char> pixels = TestImages::MakePhoto(width, height, 4, seed);
+		for (size_t i = 3; opaque && i < pixels.size(); i += 4) { pixels[i] = 255; }
+		image.samples.assign(pixels.begin(), pixels.end());
+		std::string filename = TestFramework::GetTempFilename(name);
+		std::ofstream(filename, std::ios::binary) << TestImages::ToPng(image);
+		return filename;
+	}
+
+	TexturePackSettings GetSettings(int pageSize, int padding) {
+		TexturePackSettings settings;
+		settings.pageSize = pageSize;
+		settings.padding = padding;
+		settings.cook.compression = TEXTURE_COMPRESSION_NONE;	// Packs stay RGBA8 so the texels can be compared.
+		return settings;
+	}
+
+	struct Rectangle {
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+
+	Rectangle GetRectangle(const TexturePackEntry& entry, int pageSize) {
+		const float* scaleBias = entry.region.scaleBias;
+		return { (int)lroundf(scaleBias[2] * pageSize), (int)lroundf(scaleBias[3] * pageSize), (int)lroundf(scaleBias[0] * pageSize),
+			(int)lroundf(scaleBias[1] * pageSize) };
+	}
+
+	const uint32_t* GetTexel(const CookedTexture& texture, size_t subresource, int x, int y) {
+		const CookedTextureLevel& level = texture.levels[subresource];
+		return (const uint32_t*)(texture.data.data() + level.offset + y * level.rowPitch) + x;
+	}
+
+	// Every level of every entry is where the region puts it, and the gutter around it repeats its edge, as far as the
+	// pages keep mips.
+	bool IsCopied(const CookedTexture& page, const CookedTexture& source, const Rectangle& rectangle, uint32_t slice, int padding) {
+		for (uint32_t mip = 0; mip < page.mipLevels; mip++) {
+			const CookedTextureLevel& from = source.levels[std::min(mip, source.mipLevels - 1)];
+			int left = rectangle.x >> mip, top = rectangle.y >> mip, gutter = padding >> mip;
+			for (int y = -gutter; y < from.height + gutter; y++) {
+				for (int x = -gutter; x < from.width + gutter; x++) {
+					int sourceX = std::min(std::max(x, 0), from.width - 1), sourceY = std::min(std::max(y, 0), from.height - 1);
+					if (*GetTexel(page, (size_t)slice * page.mipLevels + mip, left + x, top + y) != *GetTexel(source, mip, sourceX, sourceY)) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
+
+TEST(AtlasPlacement) {
+	// Many sizes on small pages, so there are several of them.
+	const int pageSize = 256, padding = 8;
+	std::vector<TexturePackSource> sources;
+	for (unsigned i = 0; i < 40; i++) {
+		int width = 8 << (i % 4), height = 8 << (i * 7 % 5);
+		if (i % 3 == 0) { width += 4; }	// Not every size is a power of two.
+		sources.push_back({ WriteSource("atlas.png", width, height, i + 1), false });
+	}
+	std::vector<CookedTexture> packs;
+	std::vector<TexturePackEntry> entries;
+	TexturePackReport report;
+	CHECK(TexturePackerClass::Pack(sources, GetSettings(pageSize, padding), packs, entries, report));
+	CHECK(report.error.empty() && report.textures == 40 && report.atlasTextures == 40 && report.arraySlices == 0 && packs.size() == 1);
+	CHECK(report.atlasPages > 1 && packs[0].arraySize == report.atlasPages && packs[0].width == pageSize);
+	CHECK(packs[0].mipLevels == 4 && packs[0].format == DXGI_FORMAT_R8G8B8A8_UNORM);	// A gutter of 8 covers four levels.
+	CHECK(report.efficiency > 0.3 && report.efficiency <= 1.0);
+	printf("  %zu pages, %.0f%% of the used area is texels\n", report.atlasPages, report.efficiency * 100.0);
+
+	// Inside the page, gutters included, and aligned to the coarsest page level and to blocks.
+	std::vector<Rectangle> rectangles;
+	bool inside = true, aligned = true;
+	for (const TexturePackEntry& entry : entries) {
+		Rectangle rectangle = GetRectangle(entry, pageSize);
+		rectangles.push_back(rectangle);
+		inside = inside && entry.pack == 0 && entry.region.slice < report.atlasPages;
+		inside = inside && rectangle.x >= padding && rectangle.y >= padding;
+		inside = inside && rectangle.x + rectangle.width + padding <= pageSize && rectangle.y + rectangle.height + padding <= pageSize;
+		aligned = aligned && rectangle.x % 8 == 0 && rectangle.y % 8 == 0;
+	}
+	CHECK(inside && aligned);
+
+	// No two entries of a page overlap, not even their gutters.
+	bool separate = true;
+	for (size_t i = 0; i < entries.size(); i++) {
+		for (size_t j = i + 1; j < entries.size(); j++) {
+			if (entries[i].region.slice != entries[j].region.slice) { continue; }
+			const Rectangle& a = rectangles[i];
+			const Rectangle& b = rectangles[j];
+			bool apart = a.x + a.width + padding <= b.x - padding || b.x + b.width + padding <= a.x - padding ||
+				a.y + a.height + padding <= b.y - padding || b.y + b.height + padding <= a.y - padding;
+			separate = separate && apart;
+		}
+	}
+	CHECK(separate);
+
+	// The texels of every level are the cooked source's.
+	TextureCookSettings cook = GetSettings(pageSize, padding).cook;
+	bool copied = true;
+	for (size_t i = 0; i < sources.size(); i++) {
+		CookedTexture source;
+		TextureCookReport cookReport;
+		TextureCookerClass::Cook(sources[i].filename.c_str(), cook, source, cookReport);
+		CHECK(rectangles[i].width == source.width && rectangles[i].height == source.height);
+		copied = copied && IsCopied(packs[0], source, rectangles[i], entries[i].region.slice, padding);
+	}
+	CHECK(copied);
+}
+
+TEST(ArraysAndOptions) {
+	// Tiling textures and ones too big for a page get whole slices, one array per size in the order sizes appear.
+	std::vector<TexturePackSource> sources = {
+		{ WriteSource("small.png", 16, 16, 1), false },
+		{ WriteSource("tiling.png", 32, 32, 2), true },
+		{ WriteSource("large.png", 128, 64, 3), false },
+		{ WriteSource("tiling2.png", 32, 32, 4), true },
+		{ WriteSource("small2.png", 24, 8, 5), false },
+	};
+	std::vector<CookedTexture> packs;
+	std::vector<TexturePackEntry> entries;
+	TexturePackReport report;
+	CHECK(TexturePackerClass::Pack(sources, GetSettings(128, 4), packs, entries, report));
+	CHECK(packs.size() == 3 && report.atlasTextures == 2 && report.arraySlices == 3 && report.atlasPages == 1);
+	CHECK(entries[0].pack == 0 && entries[4].pack == 0);
+	CHECK(entries[1].pack == 1 && entries[1].region.slice == 0 && entries[3].pack == 1 && entries[3].region.slice == 1);
+	CHECK(entries[2].pack == 2 && entries[2].region.slice == 0 && packs[2].width == 128 && packs[2].height == 64 && packs[2].mipLevels == 8);
+	CHECK(packs[1].arraySize == 2 && packs[1].mipLevels == 6);
+	const float identity[4] = { 1.0f, 1.0f, 0.0f, 0.0f };
+	CHECK(memcmp(entries[1].region.scaleBias, identity, sizeof(identity)) == 0 && memcmp(entries[2].region.scaleBias, identity, sizeof(identity)) == 0);
+	CookedTexture tiling;
+	TextureCookReport cookReport;
+	TextureCookerClass::Cook(sources[3].filename.c_str(), GetSettings(128, 4).cook, tiling, cookReport);
+	CHECK(memcmp(packs[1].data.data() + packs[1].levels[6].offset, tiling.data.data(), tiling.data.size()) == 0);
+
+	// Without atlases every texture is a slice.
+	TexturePackSettings noAtlas = GetSettings(128, 4);
+	noAtlas.atlas = false;
+	CHECK(TexturePackerClass::Pack(sources, noAtlas, packs, entries, report));
+	CHECK(report.atlasTextures == 0 && report.arraySlices == 5 && packs.size() == 4 && report.efficiency == 1.0);
+
+	// Opaque packs compress to BC1 with the default settings, a translucent source makes its pack BC3.
+	sources.push_back({ WriteSource("translucent.png", 16, 16, 6, false), false });
+	TexturePackSettings compressed = GetSettings(128, 4);
+	compressed.cook.compression = TEXTURE_COMPRESSION_AUTO;
+	CHECK(TexturePackerClass::Pack(sources, compressed, packs, entries, report));
+	CHECK(packs[0].format == DXGI_FORMAT_BC3_UNORM && packs[1].format == DXGI_FORMAT_BC1_UNORM && packs[2].format == DXGI_FORMAT_BC1_UNORM);
+	CHECK(packs[0].cookKey == TextureCookerClass::GetCookKey(compressed.cook));
+
+	// Sources that cannot be packed.
+	std::string missing = TestFramework::GetTempFilename("missing.png");
+	CHECK(!TexturePackerClass::Pack({ { missing, false } }, compressed, packs, entries, report) && report.error.find(missing) == 0);
+	std::string hdr = TestFramework::GetTempFilename("sky.hdr");
+	std::ofstream(hdr, std::ios::binary) << std::string("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y 1 +X 2\n") + std::string(8, '\x80');
+	report.error.clear();
+	CHECK(!TexturePackerClass::Pack({ { hdr, false } }, compressed, packs, entries, report) && report.error == hdr + ": HDR images are not packed");
+}
+
+TEST(WrittenPacks) {
+	std::vector<TexturePackSource> sources = { { WriteSource("a.png", 16, 16, 7), false }, { WriteSource("b b.png", 8, 32, 8), true } };
+	std::vector<CookedTexture> packs;
+	std::vector<TexturePackEntry> entries;
+	TexturePackReport report;
+	CHECK(TexturePackerClass::Pack(sources, GetSettings(64, 4), packs, entries, report));
+	std::string base = TestFramework::GetTempFilename("level");
+	CHECK(TexturePackerClass::Write(base.c_str(), packs, entries));
+	CHECK(TexturePackerClass::GetPackFilename(base.c_str(), 1) == base + ".1.dds");
+
+	std::vector<TexturePackEntry> read;
+	std::vector<std::string> packFilenames;
+	CHECK(TexturePackerClass::ReadEntries((base + ".pack").c_str(), read, packFilenames));
+	CHECK(packFilenames.size() == 2 && packFilenames[0] == base + ".0.dds" && read.size() == 2);
+	bool same = true;
+	for (size_t i = 0; i < read.size() && i < entries.size(); i++) {
+		same = same && read[i].filename == entries[i].filename && read[i].pack == entries[i].pack && read[i].region.slice == entries[i].region.slice;
+		same = same && memcmp(read[i].region.scaleBias, entries[i].region.scaleBias, sizeof(read[i].region.scaleBias)) == 0;
+	}
+	CHECK(same);
+	for (size_t i = 0; i < packFilenames.size(); i++) {
+		TextureFileClass file(packFilenames[i].c_str());
+		CHECK(file.isInitialized && file.GetArraySize() == packs[i].arraySize && file.GetMipLevels() == packs[i].mipLevels);
+	}
+
+	// Broken indexes are refused.
+	std::ifstream fin(base + ".pack", std::ios::binary);
+	std::string index((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+	auto reads = [&](const std::string& text) {
+		std::string filename = TestFramework::GetTempFilename("broken.pack");
+		std::ofstream(filename, std::ios::binary) << text;
+		return TexturePackerClass::ReadEntries(filename.c_str(), read, packFilenames);
+	};
+	CHECK(reads(index));
+	CHECK(!reads("XPAK" + index.substr(4)));
+	CHECK(!reads(index.substr(0, index.size() - 1)));	// The last line lost its end.
+	CHECK(!reads("EPAK 2 2\n"));
+	CHECK(!reads("EPAK 1 2\n2 0 1 1 0 0 a.png\n"));	// A pack that is not there.
+	CHECK(!reads("EPAK 1 2\n0 0 1 x 0 0 a.png\n"));
+	CHECK(!TexturePackerClass::ReadEntries(TestFramework::GetTempFilename("missing.pack").c_str(), read, packFilenames));
+}
+
+TEST(PackBenchmark) {
+	// A large set of small textures, the kind that makes draws bind bound: efficiency and the time to place them.
+	std::vector<TexturePackSource> sources;
+	unsigned state = 12345;
+	for (int i = 0; i < 600; i++) {
+		state = state * 1664525u + 1013904223u;
+		int width = 8 + (int)(state >> 26);	// 8 to 71.
+		state = state * 1664525u + 1013904223u;
+		int height = 8 + (int)(state >> 26);
+		sources.push_back({ WriteSource("bench.png", width, height, (unsigned)i + 100), false });
+	}
+	ThreadPoolClass pool;
+	for (int padding : { 0, 4, 8 }) {
+		std::vector<CookedTexture> packs;
+		std::vector<TexturePackEntry> entries;
+		TexturePackReport report;
+		TexturePackSettings settings = GetSettings(1024, padding);
+		CHECK(TexturePackerClass::Pack(sources, settings, packs, entries, report, &pool));
+		printf("  padding %d: %zu textures on %zu pages, %.1f%% efficient, placed in %.3f ms, %.1f ms in all\n", padding, report.atlasTextures,
+			report.atlasPages, report.efficiency * 100.0, report.packSeconds * 1000.0, report.totalSeconds * 1000.0);
+		// Against what the gutters and block alignment alone leave, which no packer gets past.
+		int alignment = std::max(4, padding);
+		double texels = 0.0, padded = 0.0;
+		for (const TexturePackEntry& entry : entries) {
+			Rectangle rectangle = GetRectangle(entry, settings.pageSize);
+			texels += (double)rectangle.width * rectangle.height;
+			padded += (double)((rectangle.width + 2 * padding + alignment - 1) / alignment * alignment) *
+				((rectangle.height + 2 * padding + alignment - 1) / alignment * alignment);
+		}
+		printf("  %.1f%% at best with these gutters\n", texels / padded * 100.0);
+		CHECK(report.atlasTextures == sources.size());
+		CHECK(report.efficiency > 0.85 * texels / padded);
+	}
+}
@@ -0,0 +1,231 @@
+#include "testframework.hpp"
+#include <math.h>
+#include <map>
+#include "texturestreamerclass.hpp"
+
+namespace {
+	// Bytes of every mip of a square RGBA8 texture, finest first.
+	std::vector<size_t> GetMipSizes(int size) {
+		std::vector<size_t> sizes;
+		for (int level = size; level > 0; level /= 2) { sizes.push_back((size_t)level * level * 4); }
+		return sizes;
+	}
+
+	size_t GetBytes(const std::vector<size_t>& sizes, uint32_t mip) {
+		size_t bytes = 0;
+		for (size_t i = mip; i < sizes.size(); i++) { bytes += sizes[i]; }
+		return bytes;
+	}
+
+	// Runs frames that request the same mips until nothing changes any more.
+	void Settle(TextureStreamerClass& streamer, const std::map<uint64_t, uint32_t>& requests) {
+		for (int frame = 0; frame < 100; frame++) {
+			for (const auto& [key, mip] : requests) { streamer.Request(key, mip); }
+			if (streamer.Update().empty()) { return; }
+		}
+	}
+}
+
+TEST(Settings) {
+	TextureStreamSettings defaults;
+	CHECK(TextureStreamSettings::FromVideoMemory(0).budgetBytes == defaults.budgetBytes);
+	CHECK(TextureStreamSettings::FromVideoMemory(-1).budgetBytes == defaults.budgetBytes);
+	CHECK(TextureStreamSettings::FromVideoMemory(2048).budgetBytes == (size_t)1024 << 20);
+	CHECK(TextureStreamSettings::FromVideoMemory(2048, 0.25f).budgetBytes == (size_t)512 << 20);
+	CHECK(TextureStreamSettings::FromVideoMemory(1).budgetBytes == defaults.tailBytes * 64);	// Never below 64 tails.
+
+	CHECK(TextureStreamerClass::GetDesiredMip(64.0f, 64.0f, 10) == 0);
+	CHECK(TextureStreamerClass::GetDesiredMip(64.0f, 100.0f, 10) == 0);	// Magnified.
+	CHECK(TextureStreamerClass::GetDesiredMip(64.0f, 32.0f, 10) == 1);
+	CHECK(TextureStreamerClass::GetDesiredMip(64.0f, 20.0f, 10) == 1);	// Trilinear needs the finer of the pair.
+	CHECK(TextureStreamerClass::GetDesiredMip(1024.0f, 1.0f, 10) == 9 && TextureStreamerClass::GetDesiredMip(1e9f, 1.0f, 10) == 9);
+	CHECK(TextureStreamerClass::GetDesiredMip(0.0f, 1.0f, 10) == 0 && TextureStreamerClass::GetDesiredMip(1.0f, 0.0f, 10) == 0);
+	CHECK(TextureStreamerClass::GetDesiredMip(NAN, 1.0f, 10) == 0 && TextureStreamerClass::GetDesiredMip(8.0f, 1.0f, 0) == 0);
+}
+
+TEST(TailsAndResidency) {
+	TextureStreamerClass streamer;
+	std::vector<size_t> sizes = GetMipSizes(1024);
+	// 64 KB of tail holds the 64x64 mip and down, 128x128 and down is 85 KB.
+	CHECK(streamer.Add(1, sizes, 100) == 4);
+	CHECK(streamer.GetResidentMip(1) == 4 && streamer.GetStats().residentBytes == GetBytes(sizes, 4));
+	CHECK(streamer.Add(1, sizes, 100) == 4 && streamer.GetStats().textures == 1);	// Adding again keeps what is there.
+	CHECK(streamer.Add(2, sizes, 2) == 2);	// A block compressed texture that cannot start coarser.
+	CHECK(streamer.Add(3, GetMipSizes(16), 100) == 0 && streamer.Add(4, {}, 0) == 0);
+	CHECK(streamer.GetStats().residentBytes == GetBytes(sizes, 4) + GetBytes(sizes, 2) + GetBytes(GetMipSizes(16), 0));
+	CHECK(streamer.GetStats().textures == 4 && streamer.GetResidentMip(99) == 0);
+
+	// What the texture holds after a hot reload, never coarser than the tail.
+	streamer.SetResident(1, 1);
+	CHECK(streamer.GetResidentMip(1) == 1 && streamer.GetStats().residentBytes == GetBytes(sizes, 1) + GetBytes(sizes, 2) + GetBytes(GetMipSizes(16), 0));
+	streamer.SetResident(1, 8);
+	CHECK(streamer.GetResidentMip(1) == 4);
+	streamer.Remove(2);
+	streamer.Remove(3);
+	streamer.Remove(4);
+	streamer.Remove(99);
+	CHECK(streamer.GetStats().textures == 1 && streamer.GetStats().residentBytes == GetBytes(sizes, 4));
+	streamer.Request(99, 0);	// Unknown keys are ignored.
+	CHECK(streamer.Update().empty());
+}
+
+TEST(LoadOrder) {
+	// One mip per texture and frame, the furthest behind first, under the upload cap.
+	TextureStreamSettings settings;
+	settings.uploadBytesPerFrame = 300 << 10;
+	TextureStreamerClass streamer(settings);
+	std::vector<size_t> sizes = GetMipSizes(1024);
+	streamer.Add(1, sizes, 100);
+	streamer.Add(2, sizes, 100);
+	streamer.Request(1, 3);
+	streamer.Request(2, 0);
+	streamer.Request(2, 2);	// The finest request of the frame wins.
+	std::vector<TextureStreamAction> actions = streamer.Update();
+	// Texture 2 is two mips behind and loads first, texture 1 is one behind and fits under the cap after it.
+	CHECK(actions.size() == 2 && streamer.GetResidentMip(1) == 3 && streamer.GetResidentMip(2) == 3);
+	CHECK(streamer.GetStats().frameUploadedBytes == 2 * sizes[3] && streamer.GetStats().loads == 2);
+	CHECK(streamer.GetStats().visibleFrames == 2 && streamer.GetStats().deficitFrames == 2 && streamer.GetStats().severeDeficitFrames == 1);
+
+	// Texture 1 has what it asked for, texture 2 moves on by one mip.
+	streamer.Request(1, 3);
+	streamer.Request(2, 0);
+	actions = streamer.Update();
+	CHECK(actions.size() == 1 && actions[0].key == 2 && actions[0].mip == 2 && streamer.GetStats().frameUploadedBytes == sizes[2]);
+	// A mip bigger than the cap still goes through alone.
+	streamer.Request(2, 0);
+	actions = streamer.Update();
+	CHECK(actions.size() == 1 && actions[0].mip == 1 && streamer.GetStats().frameUploadedBytes == sizes[1]);
+	streamer.Request(2, 0);
+	CHECK(streamer.Update().size() == 1 && streamer.GetResidentMip(2) == 0);
+	CHECK(streamer.GetStats().uploadedBytes == GetBytes(sizes, 0) - GetBytes(sizes, 4) + sizes[3]);
+
+	// Nothing changes, nothing is reported, and a drawn texture that has what it needs is no deficit.
+	size_t deficits = streamer.GetStats().deficitFrames;
+	streamer.Request(1, 3);
+	streamer.Request(2, 0);
+	CHECK(streamer.Update().empty() && streamer.GetStats().deficitFrames == deficits);
+}
+
+TEST(BudgetAndEviction) {
+	// Room for the tails and one full texture.
+	std::vector<size_t> sizes = GetMipSizes(1024);
+	TextureStreamSettings settings;
+	settings.uploadBytesPerFrame = SIZE_MAX;
+	settings.budgetBytes = 3 * GetBytes(sizes, 4) + GetBytes(sizes, 0) - GetBytes(sizes, 4);
+	TextureStreamerClass streamer(settings);
+	for (uint64_t key = 1; key <= 3; key++) { CHECK(streamer.Add(key, sizes, 100) == 4); }
+
+	Settle(streamer, { { 1, 0 } });
+	CHECK(streamer.GetResidentMip(1) == 0 && streamer.GetStats().residentBytes == settings.budgetBytes);
+
+	// Still drawn at mip 0, texture 1 keeps its mips and texture 2 gets no more than the budget leaves.
+	Settle(streamer, { { 1, 0 }, { 2, 0 } });
+	CHECK(streamer.GetResidentMip(1) == 0 && streamer.GetResidentMip(2) == 4 && streamer.GetStats().deniedLoads > 0);
+	CHECK(streamer.GetStats().evictions == 0);
+
+	// Once texture 1 is no longer drawn its mips go to texture 2, down to its tail and no further.
+	Settle(streamer, { { 2, 0 } });
+	CHECK(streamer.GetResidentMip(1) == 4 && streamer.GetResidentMip(2) == 0 && streamer.GetStats().evictions == 4);
+	CHECK(streamer.GetStats().residentBytes <= settings.budgetBytes);
+
+	// Least recently used first: with three textures at mip 1 and the budget full, a fourth tail is over it and
+	// texture 2, drawn longest ago, gives back before texture 3.
+	settings.budgetBytes = 3 * GetBytes(sizes, 1);
+	streamer.SetSettings(settings);
+	Settle(streamer, { { 1, 1 }, { 2, 1 }, { 3, 1 } });
+	CHECK(streamer.GetResidentMip(1) == 1 && streamer.GetResidentMip(2) == 1 && streamer.GetResidentMip(3) == 1);
+	Settle(streamer, { { 1, 1 }, { 3, 1 } });
+	Settle(streamer, { { 1, 1 } });
+	CHECK(streamer.GetStats().residentBytes == settings.budgetBytes);
+	size_t evictions = streamer.GetStats().evictions;
+	streamer.Add(4, sizes, 100);
+	streamer.Request(1, 1);
+	streamer.Update();
+	CHECK(streamer.GetResidentMip(2) == 2 && streamer.GetResidentMip(3) == 1 && streamer.GetResidentMip(1) == 1);
+	CHECK(streamer.GetStats().evictions == evictions + 1 && streamer.GetStats().residentBytes <= settings.budgetBytes);
+
+	// A smaller budget takes effect on the next update, from textures nobody draws.
+	settings.budgetBytes = 4 * GetBytes(sizes, 4);
+	streamer.SetSettings(settings);
+	std::vector<TextureStreamAction> actions = streamer.Update();
+	CHECK(actions.size() == 3 && streamer.GetStats().residentBytes == settings.budgetBytes);
+}
+
+TEST(CameraPath) {
+	// A street of textured walls on both sides, the camera drives down it and back. Walls in view request the mip
+	// their distance needs, the budget holds a fraction of what all of them would take at full resolution.
+	const int walls = 200;
+	const float spacing = 10.0f, texelsPerWorld = 256.0f, pixelsPerWorldAtOne = 1000.0f, viewDistance = 150.0f;
+	std::vector<size_t> sizes = GetMipSizes(1024);
+	TextureStreamSettings settings = TextureStreamSettings::FromVideoMemory(256, 0.25f);
+	settings.uploadBytesPerFrame = 8u << 20;
+	TextureStreamerClass streamer(settings);
+	size_t everything = 0;
+	for (int i = 0; i < walls; i++) {
+		streamer.Add((uint64_t)i, sizes, 100);
+		everything += GetBytes(sizes, 0);
+	}
+
+	// Resident mips as the texture holds them, applied from the actions the way TextureClass::SetResidentMip would.
+	std::vector<uint32_t> applied(walls, 4);
+	size_t frames = 0, overBudget = 0, busiestFrame = 0;
+	auto drive = [&](float from, float to, int steps) {
+		for (int step = 0; step <= steps; step++) {
+			float camera = from + (to - from) * step / steps;
+			for (int i = 0; i < walls; i++) {
+				float distance = fabsf(i / 2 * spacing - camera) + 2.0f;	// Walls come in pairs, one each side.
+				if (distance > viewDistance) { continue; }
+				streamer.Request((uint64_t)i, TextureStreamerClass::GetDesiredMip(texelsPerWorld, pixelsPerWorldAtOne / distance, (uint32_t)sizes.size()));
+			}
+			for (const TextureStreamAction& action : streamer.Update()) { applied[action.key] = action.mip; }
+			frames++;
+			overBudget += streamer.GetStats().residentBytes > settings.budgetBytes;
+			busiestFrame = std::max(busiestFrame, streamer.GetStats().frameUploadedBytes);
+		}
+	};
+	drive(0.0f, walls / 2 * spacing, 600);
+	drive(walls / 2 * spacing, 0.0f, 300);	// Faster on the way back.
+	const TextureStreamStats& stats = streamer.GetStats();
+	printf("  %zu frames, peak %.1f of %.1f MB budget (%.1f MB all at full size), %.1f MB uploaded, %.2f MB a frame\n", frames,
+		stats.peakResidentBytes / 1048576.0, settings.budgetBytes / 1048576.0, everything / 1048576.0, stats.uploadedBytes / 1048576.0,
+		stats.uploadedBytes / 1048576.0 / frames);
+	printf("  pop-in: %.1f%% of visible texture frames blurrier than wanted, %.2f%% by two mips or more, %zu loads, %zu evictions, %zu denied\n",
+		100.0 * stats.deficitFrames / stats.visibleFrames, 100.0 * stats.severeDeficitFrames / stats.visibleFrames, stats.loads, stats.evictions,
+		stats.deniedLoads);
+
+	CHECK(overBudget == 0 && stats.peakResidentBytes <= settings.budgetBytes);
+	CHECK(stats.evictions > 0 && stats.deniedLoads == 0 && busiestFrame <= settings.uploadBytesPerFrame);
+	CHECK(stats.deficitFrames * 5 < stats.visibleFrames && stats.severeDeficitFrames * 20 < stats.visibleFrames);
+
+	// The actions told every texture what the streamer thinks it holds, and the resident bytes add up to exactly that.
+	size_t resident = 0;
+	bool reported = true;
+	for (int i = 0; i < walls; i++) {
+		reported = reported && applied[i] == streamer.GetResidentMip((uint64_t)i);
+		resident += GetBytes(sizes, applied[i]);
+	}
+	CHECK(reported && resident == stats.residentBytes);
+
+	// Parked, the walls in view get everything they asked for.
+	for (int frame = 0; frame < 60; frame++) {
+		for (int i = 0; i < 10; i++) { streamer.Request((uint64_t)i, 0); }
+		streamer.Update();
+	}
+	bool sharp = true;
+	for (int i = 0; i < 10; i++) { sharp = sharp && streamer.GetResidentMip((uint64_t)i) == 0; }
+	CHECK(sharp);
+}
+
+TEST(StreamerBenchmark) {
+	// Update over many textures, most of them far away and requesting their tail.
+	TextureStreamerClass streamer(TextureStreamSettings::FromVideoMemory(1024));
+	std::vector<size_t> sizes = GetMipSizes(2048);
+	for (uint64_t key = 0; key < 5000; key++) { streamer.Add(key, sizes, 100); }
+	uint64_t frame = 0;
+	TestFramework::Benchmark("Update with 5000 textures, 500 drawn", 100, [&]() {
+		for (uint64_t i = 0; i < 500; i++) { streamer.Request((frame * 37 + i) % 5000, (uint32_t)(i % 6)); }
+		streamer.Update();
+		frame++;
+	});
+	CHECK(streamer.GetStats().peakResidentBytes <= streamer.GetSettings().budgetBytes);
+}
@@ -0,0 +1,171 @@
+#include "testframework.hpp"
+#include "testmeshes.hpp"
+#include <math.h>
+#include <string.h>
+#include <random>
+#include "vertexencoderclass.hpp"
+
+namespace {
+	const char* positionNames[] = { "float3", "snorm16", "half" };
+	const char* texcoordNames[] = { "float2", "half2", "unorm16" };
+	const char* normalNames[] = { "float3", "oct16" };
+
+	// An offset sphere and a grid with texture coordinates that wrap past 0..1, so no attribute sits in its
+	// encoding's sweet spot.
+	MeshData MakeMesh() {
+		const float center[3] = { 10.0f, -3.0f, 5.0f };
+		MeshData mesh = TestMeshes::MakeSphere(64, 128, 3.0f, center);
+		MeshData grid = TestMeshes::MakeGrid(64);
+		for (MeshVertex& vertex : grid.vertices) {
+			vertex.Texcoord()[0] = vertex.Texcoord()[0] * 8.0f - 4.0f;
+			vertex.Texcoord()[1] = vertex.Texcoord()[1] * 3.0f;
+		}
+		mesh.vertices.insert(mesh.vertices.end(), grid.vertices.begin(), grid.vertices.end());
+		return mesh;
+	}
+
+	struct Errors {
+		float position = 0.0f;
+		float texcoord = 0.0f;
+		float normal = 0.0f;	// In degrees.
+	};
+
+	Errors Measure(const std::vector<MeshVertex>& vertices, const std::vector<unsigned char>& encoded, const MeshVertexFormat& format) {
+		Errors errors;
+		for (size_t i = 0; i < vertices.size(); i++) {
+			MeshVertex decoded = VertexEncoderClass::Decode(encoded.data(), vertices.size(), i, format);
+			const MeshVertex& original = vertices[i];
+			for (int k = 0; k < 3; k++) { errors.position = std::max(errors.position, fabsf(decoded.Position()[k] - original.Position()[k])); }
+			for (int k = 0; k < 2; k++) { errors.texcoord = std::max(errors.texcoord, fabsf(decoded.Texcoord()[k] - original.Texcoord()[k])); }
+
+			const float* n = original.Normal();
+			const float* d = decoded.Normal();
+			double cross[3] = { (double)n[1] * d[2] - (double)n[2] * d[1], (double)n[2] * d[0] - (double)n[0] * d[2], (double)n[0] * d[1] - (double)n[1] * d[0] };
+			double dot = (double)n[0] * d[0] + (double)n[1] * d[1] + (double)n[2] * d[2];
+			double angle = atan2(sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot);
+			errors.normal = std::max(errors.normal, (float)(angle * 57.29577951308232));
+		}
+		return errors;
+	}
+}
+
+TEST(HalfRoundTrip) {
+	// Every half converts to a float and back to itself, NaNs stay NaNs.
+	bool exact = true;
+	for (uint32_t h = 0; h < 0x10000; h++) {
+		float value = VertexEncoderClass::HalfToFloat((uint16_t)h);
+		uint16_t back = VertexEncoderClass::FloatToHalf(value);
+		bool nan = (h & 0x7C00) == 0x7C00 && (h & 0x3FF) != 0;
+		exact = exact && (nan ? isnan(value) && (back & 0x7C00) == 0x7C00 && (back & 0x3FF) != 0 : back == h);
+	}
+	CHECK(exact);
+}
+
+TEST(HalfRounding) {
+	CHECK(VertexEncoderClass::FloatToHalf(1.0f) == 0x3C00);
+	CHECK(VertexEncoderClass::FloatToHalf(-2.0f) == 0xC000);
+	CHECK(VertexEncoderClass::FloatToHalf(65504.0f) == 0x7BFF);
+	CHECK(VertexEncoderClass::FloatToHalf(65519.0f) == 0x7BFF);
+	CHECK(VertexEncoderClass::FloatToHalf(65520.0f) == 0x7C00);	// Halfway to the next, which would be infinity.
+	CHECK(VertexEncoderClass::FloatToHalf(1.0f + 1.0f / 2048.0f) == 0x3C00);	// A tie rounds to even.
+	CHECK(VertexEncoderClass::FloatToHalf(1.0f + 3.0f / 2048.0f) == 0x3C02);
+	CHECK(VertexEncoderClass::FloatToHalf(5.9604645e-8f) == 0x0001);	// The smallest subnormal.
+	CHECK(VertexEncoderClass::FloatToHalf(2.9802322e-8f) == 0x0000);	// Half of it ties to zero.
+	CHECK(VertexEncoderClass::FloatToHalf(-0.0f) == 0x8000);
+
+	// Random floats land on the nearest half, ties on the even one.
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> exponent(-26.0f, 15.99f);	// Below 65504, past it rounds to infinity.
+	bool nearest = true;
+	for (int i = 0; i < 200000; i++) {
+		float value = exp2f(exponent(random)) * (i & 1 ? -1.0f : 1.0f);
+		uint16_t h = VertexEncoderClass::FloatToHalf(value);
+		double error = fabs((double)VertexEncoderClass::HalfToFloat(h) - value);
+		for (int step : { -1, 1 }) {
+			uint16_t other = (uint16_t)((h & 0x7FFF) + step);
+			if (other > 0x7BFF) { continue; }
+			double otherError = fabs((double)VertexEncoderClass::HalfToFloat((uint16_t)(other | (h & 0x8000))) - value);
+			nearest = nearest && (error < otherError || (error == otherError && (h & 1) == 0));
+		}
+	}
+	CHECK(nearest);
+}
+
+TEST(ErrorBounds) {
+	MeshData mesh = MakeMesh();
+	float halfExtent = 0.0f, texcoordExtent = 0.0f, texcoordMagnitude = 0.0f;
+	MeshBounds bounds;
+	float texcoordMinimum[2] = { 1e30f, 1e30f }, texcoordMaximum[2] = { -1e30f, -1e30f };
+	for (const MeshVertex& vertex : mesh.vertices) {
+		bounds.Add(vertex.Position());
+		for (int k = 0; k < 2; k++) {
+			texcoordMinimum[k] = std::min(texcoordMinimum[k], vertex.Texcoord()[k]);
+			texcoordMaximum[k] = std::max(texcoordMaximum[k], vertex.Texcoord()[k]);
+			texcoordMagnitude = std::max(texcoordMagnitude, fabsf(vertex.Texcoord()[k]));
+		}
+	}
+	for (int k = 0; k < 3; k++) { halfExtent = std::max(halfExtent, (bounds.maximum[k] - bounds.minimum[k]) * 0.5f); }
+	for (int k = 0; k < 2; k++) { texcoordExtent = std::max(texcoordExtent, texcoordMaximum[k] - texcoordMinimum[k]); }
+
+	// Rounding to the nearest step of each encoding, with a little slack for the float math around it.
+	const float positionBounds[] = { 0.0f, halfExtent / 32767.0f * 0.51f, halfExtent / 2048.0f * 0.51f };
+	const float texcoordBounds[] = { 0.0f, texcoordMagnitude / 2048.0f * 0.51f, texcoordExtent / 65535.0f * 0.51f };
+	const float normalBounds[] = { 0.0f, 0.01f };
+
+	printf("  %-8s %-8s %-6s %-6s %6s %12s %10s %10s\n", "position", "texcoord", "normal", "split", "bytes", "position", "texcoord", "degrees");
+	for (uint32_t position = 0; position < 3; position++) {
+		for (uint32_t texcoord = 0; texcoord < 3; texcoord++) {
+			for (uint32_t normal = 0; normal < 2; normal++) {
+				VertexEncoding interleaved{ (PositionEncoding)position, (TexcoordEncoding)texcoord, (NormalEncoding)normal, STREAMS_INTERLEAVED };
+				VertexEncoding split = interleaved;
+				split.streams = STREAMS_POSITION_SPLIT;
+
+				MeshVertexFormat format, splitFormat;
+				std::vector<unsigned char> encoded, splitEncoded;
+				VertexEncodeStats stats = VertexEncoderClass::Encode(mesh.vertices, interleaved, format, encoded);
+				VertexEncodeStats splitStats = VertexEncoderClass::Encode(mesh.vertices, split, splitFormat, splitEncoded);
+				Errors errors = Measure(mesh.vertices, encoded, format);
+				Errors splitErrors = Measure(mesh.vertices, splitEncoded, splitFormat);
+				printf("  %-8s %-8s %-6s %-6s %6u %12.3g %10.3g %10.3g\n", positionNames[position], texcoordNames[texcoord], normalNames[normal],
+					"either", format.stride, errors.position, errors.texcoord, errors.normal);
+
+				uint32_t stride = VertexEncoderClass::Describe(interleaved).GetStride();
+				CHECK(format.stride == stride && splitFormat.stride == stride && splitFormat.streamCount == 2);
+				CHECK(stats.bytesBefore == mesh.vertices.size() * sizeof(MeshVertex) && stats.bytesAfter == mesh.vertices.size() * stride);
+				CHECK(splitStats.bytesAfter == stats.bytesAfter);
+				CHECK(errors.position <= positionBounds[position]);
+				CHECK(errors.texcoord <= texcoordBounds[texcoord]);
+				CHECK(errors.normal <= normalBounds[normal]);
+
+				// The report is what the decoder gives back, and the streams only move the attributes around.
+				CHECK(stats.maxPositionError == errors.position && stats.maxTexcoordError == errors.texcoord);
+				CHECK_NEAR(stats.maxNormalError, errors.normal, 1e-4f);
+				CHECK(splitErrors.position == errors.position && splitErrors.texcoord == errors.texcoord && splitErrors.normal == errors.normal);
+			}
+		}
+	}
+}
+
+TEST(MemoryReport) {
+	MeshData mesh = MakeMesh();
+	MeshVertexFormat format;
+	std::vector<unsigned char> encoded;
+	VertexEncodeStats full = VertexEncoderClass::Encode(mesh.vertices, VertexEncoding(), format, encoded);
+	VertexEncodeStats compact = VertexEncoderClass::Encode(mesh.vertices, VertexEncoding::Compact(), format, encoded);
+	printf("  %zu vertices: %zu bytes as floats, %zu compact, %.1f MB against %.1f MB a frame at 100 draws\n", mesh.vertices.size(),
+		full.bytesAfter, compact.bytesAfter, full.BandwidthPerFrame(100) / (1 << 20), compact.BandwidthPerFrame(100) / (1 << 20));
+	CHECK(full.bytesAfter == full.bytesBefore);
+	CHECK(compact.bytesAfter * 2 == compact.bytesBefore);
+	CHECK(compact.BandwidthPerFrame(100) == compact.bytesAfter * 100.0);
+}
+
+TEST(EncodeBenchmark) {
+	const float center[3] = { 0.0f, 0.0f, 0.0f };
+	MeshData mesh = TestMeshes::MakeSphere(512, 1024, 1.0f, center);
+	MeshVertexFormat format;
+	std::vector<unsigned char> encoded;
+	double milliseconds = TestFramework::Benchmark("encode compact", 3, [&]() {
+		VertexEncoderClass::Encode(mesh.vertices, VertexEncoding::Compact(), format, encoded);
+	});
+	printf("  %zu vertices, %.1f M vertices/s, error checks included\n", mesh.vertices.size(), mesh.vertices.size() / milliseconds / 1000.0);
+}
@@ -1,54 +1,173 @@
 #include "textureclass.hpp"
+#include <algorithm>
+#include <vector>
 
-TextureClass::TextureClass(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename) {
-	bool success = LoadTarga32Bit(filename);
-	if (!success) { return; }
+TextureClass::TextureClass(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename) : TextureClass(filename) {
+	if (isLoaded) { Create(device, deviceContext); }
+}
 
-	D3D11_TEXTURE2D_DESC textureDesc = SetTextureDesc();
-	HRESULT result = device->CreateTexture2D(&textureDesc, NULL, &m_texture);
-	if (FAILED(result)) { return; }
+TextureClass::TextureClass(char* filename, const TextureCookSettings& settings) {
+	isLoaded = Load(filename, settings);
+}
 
-	unsigned int rowPitch = (m_width * 4) * sizeof(unsigned char);	// Set the row pitch of the targa image data.
-	deviceContext->UpdateSubresource(m_texture, 0, NULL, m_targaData, rowPitch, 0);
+bool TextureClass::Load(const char* sourceFilename, const TextureCookSettings& settings) {
+	// Images are cooked once into a DDS file next to them, later launches just map that file. Decoding, mips and block
+	// compression all happen here, off the thread that owns the device.
+	std::string textureFilename = TextureCookerClass::GetCookedFilename(sourceFilename);
+	if (TextureCookerClass::IsStale(sourceFilename, textureFilename.c_str(), settings)) {
+		bool success = TextureCookerClass::Cook(sourceFilename, textureFilename.c_str(), settings, m_cookReport);
+		if (!success) {
+			errorMessage = m_cookReport.error;
+			return false;
+		}
+	}
 
-	success = SetSRVDesc(textureDesc.Format, device);
-	if (!success) { return; }
-	deviceContext->GenerateMips(m_textureView);
+	m_file = new TextureFileClass(textureFilename.c_str());
+	if (not m_file->isInitialized) {
+		errorMessage = textureFilename + ": not a valid texture";
+		return false;
+	}
+	m_width = m_file->GetWidth();
+	m_height = m_file->GetHeight();
+	m_mipLevels = m_file->GetMipLevels();
+	return true;
+}
+
+bool TextureClass::Create(ID3D11Device* device, ID3D11DeviceContext*, uint32_t firstMip) {
+	if (!isLoaded || firstMip >= m_mipLevels) { return false; }
+
+	// The levels already have the GPU layout, so the driver copies them straight out of the mapped file.
+	const std::vector<CookedTextureLevel>& levels = m_file->GetLevels();
+	std::vector<D3D11_SUBRESOURCE_DATA> levelData;
+	for (size_t i = 0; i < levels.size(); i++) {
+		if (i % m_mipLevels < firstMip) { continue; }
+		D3D11_SUBRESOURCE_DATA data{};
+		data.pSysMem = m_file->GetLevelData(i);
+		data.SysMemPitch = (UINT)levels[i].rowPitch;
+		data.SysMemSlicePitch = 0;
+		levelData.push_back(data);
+	}
 
-	delete[] m_targaData;
-	m_targaData = 0;
+	m_streamed = firstMip > 0;
+	D3D11_TEXTURE2D_DESC textureDesc = SetTextureDesc(firstMip);
+	HRESULT result = device->CreateTexture2D(&textureDesc, levelData.data(), &m_texture);
+	if (FAILED(result)) { return false; }
 
+	bool success = SetSRVDesc(textureDesc.Format, device);
+	if (!success) { return false; }
+	m_residentMip = firstMip;
+
+	if (!m_streamed) {
+		delete m_file;	// The GPU has its own copy now, drop the mapping.
+		m_file = 0;
+	}
+
+	isLoaded = false;
 	isInitialized = true;
+	return true;
+}
+
+bool TextureClass::SetResidentMip(ID3D11Device* device, ID3D11DeviceContext* deviceContext, uint32_t mip) {
+	if (!isInitialized || !m_streamed || mip >= m_mipLevels) { return false; }
+	if (mip == m_residentMip) { return true; }
+
+	// Textures cannot change their mip count, so a new one replaces it. The old one stays until the copies are queued.
+	ID3D11Texture2D* oldTexture = m_texture;
+	ID3D11ShaderResourceView* oldView = m_textureView;
+	m_texture = 0;
+	m_textureView = 0;
+	D3D11_TEXTURE2D_DESC textureDesc = SetTextureDesc(mip);
+	HRESULT result = device->CreateTexture2D(&textureDesc, 0, &m_texture);
+	if (FAILED(result) || !SetSRVDesc(textureDesc.Format, device)) {
+		ReleaseTexture();
+		m_texture = oldTexture;
+		m_textureView = oldView;
+		return false;
+	}
+
+	// Subresources go slice by slice, each with its mips from the finest one the texture holds.
+	const std::vector<CookedTextureLevel>& levels = m_file->GetLevels();
+	uint32_t oldLevels = m_mipLevels - m_residentMip, newLevels = m_mipLevels - mip;
+	for (uint32_t slice = 0; slice < m_file->GetArraySize(); slice++) {
+		for (uint32_t level = mip; level < m_mipLevels; level++) {
+			UINT destination = slice * newLevels + level - mip;
+			if (level >= m_residentMip) {
+				deviceContext->CopySubresourceRegion(m_texture, destination, 0, 0, 0, oldTexture, slice * oldLevels + level - m_residentMip, 0);
+				continue;
+			}
+			size_t subresource = (size_t)slice * m_mipLevels + level;
+			deviceContext->UpdateSubresource(m_texture, destination, 0, m_file->GetLevelData(subresource), (UINT)levels[subresource].rowPitch, 0);
+		}
+	}
+	oldView->Release();
+	oldTexture->Release();
+	m_residentMip = mip;
+	return true;
+}
+
+std::vector<size_t> TextureClass::GetMipSizes() const {
+	std::vector<size_t> sizes;
+	if (!m_file) { return sizes; }
+	sizes.resize(m_mipLevels);
+	const std::vector<CookedTextureLevel>& levels = m_file->GetLevels();
+	for (size_t i = 0; i < levels.size(); i++) { sizes[i % m_mipLevels] += levels[i].size; }
+	return sizes;
+}
+
+uint32_t TextureClass::GetCoarsestTopMip() const {
+	if (m_mipLevels == 0) { return 0; }
+	int blockSize = m_file ? TextureFileClass::GetBlockSize(m_file->GetFormat()) : 1;
+	if (blockSize <= 1) { return m_mipLevels - 1; }
+	uint32_t mip = 0;
+	while (mip + 1 < m_mipLevels && std::max(m_width >> (mip + 1), 1) % blockSize == 0 && std::max(m_height >> (mip + 1), 1) % blockSize == 0) { mip++; }
+	return mip;
 }
 
-D3D11_TEXTURE2D_DESC TextureClass::SetTextureDesc() const {
+D3D11_TEXTURE2D_DESC TextureClass::SetTextureDesc(uint32_t firstMip) const {
 	D3D11_TEXTURE2D_DESC textureDesc{};
-	textureDesc.Height = m_height;
-	textureDesc.Width = m_width;
-	textureDesc.MipLevels = 0;
-	textureDesc.ArraySize = 1;
-	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.Height = std::max(m_height >> firstMip, 1);
+	textureDesc.Width = std::max(m_width >> firstMip, 1);
+	textureDesc.MipLevels = m_mipLevels - firstMip;
+	textureDesc.ArraySize = m_file->GetArraySize();
+	textureDesc.Format = m_file->GetFormat();
 	textureDesc.SampleDesc.Count = 1;
 	textureDesc.SampleDesc.Quality = 0;
-	textureDesc.Usage = D3D11_USAGE_DEFAULT;
-	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	textureDesc.Usage = m_streamed ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;	// Streamed ones get their finer mips copied in.
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 	textureDesc.CPUAccessFlags = 0;
-	textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+	textureDesc.MiscFlags = m_file->IsCube() ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
 	return textureDesc;
 }
 
 bool TextureClass::SetSRVDesc(DXGI_FORMAT format, ID3D11Device* device) {
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
 	srvDesc.Format = format;
-	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = -1;
+	if (m_file->IsCube() && m_file->GetArraySize() > 6) {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+		srvDesc.TextureCubeArray.MostDetailedMip = 0;
+		srvDesc.TextureCubeArray.MipLevels = -1;
+		srvDesc.TextureCubeArray.First2DArrayFace = 0;
+		srvDesc.TextureCubeArray.NumCubes = m_file->GetArraySize() / 6;
+	}
+	else if (m_file->IsCube()) {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MostDetailedMip = 0;
+		srvDesc.TextureCube.MipLevels = -1;
+	}
+	else {
+		// Single images are one slice arrays as well, so the shaders sample them and packed textures alike.
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MostDetailedMip = 0;
+		srvDesc.Texture2DArray.MipLevels = -1;
+		srvDesc.Texture2DArray.FirstArraySlice = 0;
+		srvDesc.Texture2DArray.ArraySize = m_file->GetArraySize();
+	}
 
 	HRESULT result = device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureView);
 	return !FAILED(result);
 }
 
-TextureClass::~TextureClass() {
+void TextureClass::ReleaseTexture() {
 	if (m_textureView) {
 		m_textureView->Release();
 		m_textureView = 0;
@@ -57,68 +176,12 @@ TextureClass::~TextureClass() {
 		m_texture->Release();
 		m_texture = 0;
 	}
-	if (m_targaData) {
-		delete[] m_targaData;
-		m_targaData = 0;
-	}
 }
 
-TextureClass::fileData TextureClass::GetFileData(char* filename){
-	fileData nll = fileData();
-	FILE* filePtr;
-	int error = fopen_s(&filePtr, filename, "rb");	// Open the targa file for reading in binary.
-	if (error != 0) { return nll; }
-
-	TargaHeader targaFileHeader;	// Read in the file header.
-	unsigned int count = (unsigned int)fread(&targaFileHeader, sizeof(TargaHeader), 1, filePtr);
-	if (count != 1) { return nll; }
-
-	m_height = (int)targaFileHeader.height;
-	m_width = (int)targaFileHeader.width;
-	int bpp = (int)targaFileHeader.bpp;
-	if (bpp != 32) { return nll; }	// Check that it is 32 bit and not 24 bit.
-
-	int imageSize = m_width * m_height * 4;
-	unsigned char* targaImage = new unsigned char[imageSize];
-	count = (unsigned int)fread(targaImage, 1, imageSize, filePtr);	// Read in the targa image data.
-	if (count != imageSize) { return nll; }
-
-	error = fclose(filePtr);	// Close the file.
-	if (error != 0) { return nll; }
-
-	return fileData(imageSize, targaImage, true);
-}
-
-void TextureClass::SetTargaData(TextureClass::fileData data) {
-	m_targaData = new unsigned char[data.imageSize];
-	int targa_dst_data = 0;	// Initialize the index into the targa destination data array.
-	int targa_img_data = (m_width * m_height * 4) - (m_width * 4);	// Initialize the index into the targa image data.
-
-	// Now copy the targa image data into the targa destination array in the correct order since the targa format is stored upside down and also is not in RGBA order.
-	for (int h = 0; h < m_height; h++) {
-		for (int w = 0; w < m_width; w++) {
-			m_targaData[targa_dst_data + 0] = data.targaImage[targa_img_data + 2];  // Red.
-			m_targaData[targa_dst_data + 1] = data.targaImage[targa_img_data + 1];  // Green.
-			m_targaData[targa_dst_data + 2] = data.targaImage[targa_img_data + 0];  // Blue
-			m_targaData[targa_dst_data + 3] = data.targaImage[targa_img_data + 3];  // Alpha
-
-			// Increment the indexes into the targa data.
-			targa_img_data += 4;
-			targa_dst_data += 4;
-		}
-		targa_img_data -= (m_width * 8);	// Set the targa image data index back to the preceding row at the beginning of the column since its reading it in upside down.
+TextureClass::~TextureClass() {
+	ReleaseTexture();
+	if (m_file) {
+		delete m_file;
+		m_file = 0;
 	}
 }
-
-bool TextureClass::LoadTarga32Bit(char* filename)
-{
-	auto data = GetFileData(filename);
-	if (not data.isInitialized) { return false; }
-
-	SetTargaData(data);
-	
-	delete[] data.targaImage;
-	data.targaImage = 0;
-
-	return true;
-}
\ No newline at end of file
@@ -1,46 +1,57 @@
 #pragma once
 #include <d3d11.h>
-#include <stdio.h>
+#include "texturecookerclass.hpp"
+#include "texturefileclass.hpp"
+#include <string>
+#include <vector>
+
+// Where a model's image lies in the texture it is drawn with: the array slice and the transform from its own UVs. Packed
+// textures share one texture this way, see TexturePackerClass.
+struct TextureRegion {
+    uint32_t slice = 0;
+    float scaleBias[4]{ 1.0f, 1.0f, 0.0f, 0.0f };	// xy scale, zw bias.
+};
 
 class TextureClass {
 public:
     TextureClass(ID3D11Device*, ID3D11DeviceContext*, char*);
+    // Cooks the source when the cooked file is stale and maps the result, Create makes the GPU texture. Safe on worker threads.
+    TextureClass(char*, const TextureCookSettings& settings = TextureCookSettings());
     TextureClass(const TextureClass&) { isInitialized = true; }
     ~TextureClass();
 
+    // Makes the immutable texture straight from the mapped levels. Above 0 the texture is streamed instead: it starts
+    // with the mips from firstMip on and keeps the file mapped for SetResidentMip, see TextureStreamerClass.
+    bool Create(ID3D11Device*, ID3D11DeviceContext*, uint32_t firstMip = 0);
+    // Rebuilds a streamed texture with the mips from mip on. Mips it already had are copied on the GPU, only the finer
+    // ones are read from the file. On the thread owning the context, the old SRV is released.
+    bool SetResidentMip(ID3D11Device*, ID3D11DeviceContext*, uint32_t mip);
     ID3D11ShaderResourceView* GetTexture() { return m_textureView; }
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
+    uint32_t GetMipLevels() const { return m_mipLevels; }
+    uint32_t GetResidentMip() const { return m_residentMip; }
+    std::vector<size_t> GetMipSizes() const;	// Bytes of every mip over all slices, empty once the mapping is gone.
+    uint32_t GetCoarsestTopMip() const;	// Block compressed textures can only start at mips a whole number of blocks wide.
+    const TextureCookReport& GetCookReport() const { return m_cookReport; }	// Only filled in when this load had to cook the image.
 
+    bool isLoaded = false;	// The cooked file is mapped, Create has not run yet.
     bool isInitialized = false;
+    std::string errorMessage;
 
 private:
-    struct TargaHeader {
-        unsigned char data1[12];
-        unsigned short width;
-        unsigned short height;
-        unsigned char bpp;
-        unsigned char data2;
-    };
-    D3D11_TEXTURE2D_DESC SetTextureDesc() const;
+    bool Load(const char* sourceFilename, const TextureCookSettings& settings);
+    D3D11_TEXTURE2D_DESC SetTextureDesc(uint32_t firstMip) const;
     bool SetSRVDesc(DXGI_FORMAT format, ID3D11Device* device);
-    bool LoadTarga32Bit(char*);
+    void ReleaseTexture();
     
-    unsigned char* m_targaData = 0;
+    TextureFileClass* m_file = 0;	// Only mapped while the texture is being created, or for as long as it streams.
+    TextureCookReport m_cookReport;
     ID3D11Texture2D* m_texture = 0;
     ID3D11ShaderResourceView* m_textureView = 0;
     int m_width = 0;
     int m_height = 0;
-
-    struct fileData {
-        int imageSize = 0;
-        unsigned char* targaImage{};
-        bool isInitialized = false;
-
-        fileData() {};
-        fileData(int i, unsigned char* t, bool init) : imageSize(i), targaImage(t), isInitialized(init) {};
-    };
-
-    fileData GetFileData(char* fileName);
-    void SetTargaData(fileData data);
+    uint32_t m_mipLevels = 0;	// Of the file, the texture holds the ones from m_residentMip on.
+    uint32_t m_residentMip = 0;
+    bool m_streamed = false;
 };
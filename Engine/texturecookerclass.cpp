@@ -0,0 +1,290 @@
+#include "texturecookerclass.hpp"
+#include <math.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include "hdrdecoderclass.hpp"
+#include "imageconverterclass.hpp"
+#include "pngdecoderclass.hpp"
+#include "targadecoderclass.hpp"
+
+namespace {
+
+constexpr size_t CONVERT_TEXELS = 64 * 1024;	// Per job of the HDR conversion.
+
+double GetBitsPerTexel(const CookedTexture& texture) { return texture.levels[0].size * 8.0 / ((double)texture.width * texture.height); }
+
+}
+
+std::string TextureCookerClass::GetCookedFilename(const char* sourceFilename) {
+	std::filesystem::path path(sourceFilename);
+	path.replace_extension(".dds");
+	return path.string();
+}
+
+bool TextureCookerClass::IsStale(const char* sourceFilename, const char* textureFilename, const TextureCookSettings& settings) {
+	// A source that is already a DDS file is used as it is.
+	std::error_code error;
+	if (std::filesystem::equivalent(sourceFilename, textureFilename, error)) { return false; }
+
+	auto textureTime = std::filesystem::last_write_time(textureFilename, error);
+	if (error) { return true; }	// Never cooked.
+	auto sourceTime = std::filesystem::last_write_time(sourceFilename, error);
+	if (error) { return false; }	// Only the cooked file was shipped.
+
+	if (textureTime < sourceTime) { return true; }
+
+	// Older versions and files of other tools carry no key, other settings need a new cook as well.
+	TextureFileClass texture(textureFilename);
+	return !texture.isInitialized || texture.GetCookKey() != GetCookKey(settings);
+}
+
+bool TextureCookerClass::Cook(const char* sourceFilename, const char* textureFilename, const TextureCookSettings& settings,
+	TextureCookReport& report, ThreadPoolClass* pool) {
+	CookedTexture cooked;
+	if (!Cook(sourceFilename, settings, cooked, report, pool)) { return false; }
+	if (!TextureFileClass::Write(textureFilename, cooked)) {
+		report.error = std::string(textureFilename) + ": could not write the cooked texture";
+		return false;
+	}
+	return true;
+}
+
+bool TextureCookerClass::Cook(const char* sourceFilename, const TextureCookSettings& settings, CookedTexture& cooked, TextureCookReport& report,
+	ThreadPoolClass* pool) {
+	MappedFileClass file(sourceFilename);
+	if (file.isInitialized && HdrDecoderClass::IsHdr(file.GetData(), file.GetSize())) { return CookHdr(file, settings, cooked, report, pool); }
+
+	std::vector<unsigned char> chain;
+	int width = 0;
+	int height = 0;
+	if (!Decode(sourceFilename, file, chain, width, height, report.error)) { return false; }
+	MipGeneratorClass::Generate(chain.data(), width, height, settings.mipFilter, settings.srgb, pool);
+
+	CookedTexture texture;
+	texture.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	texture.width = width;
+	texture.height = height;
+	texture.cookKey = GetCookKey(settings);
+	for (const MipLevel& mip : MipGeneratorClass::GetLevels(width, height)) {
+		size_t rowPitch = (size_t)mip.width * 4;
+		texture.levels.push_back({ mip.width, mip.height, mip.offset, rowPitch, rowPitch * mip.height });
+	}
+	texture.mipLevels = (uint32_t)texture.levels.size();
+	texture.data = std::move(chain);
+	report.uncompressedBytes = texture.data.size();
+
+	TextureCompression compression = SelectCompression(texture, settings);
+	if (compression == TEXTURE_COMPRESSION_NONE) {
+		cooked = std::move(texture);
+		report.format = cooked.format;
+		report.cookedBytes = cooked.data.size();
+		report.bitsPerTexel = GetBitsPerTexel(cooked);
+		if (settings.measureQuality) { report.psnr = INFINITY; }
+		return true;
+	}
+
+	Compress(texture, compression, settings.quality, cooked, pool);
+	report.format = cooked.format;
+	report.cookedBytes = cooked.data.size();
+	report.bitsPerTexel = GetBitsPerTexel(cooked);
+
+	if (settings.measureQuality) {
+		BlockFormat format = GetBlockFormat(compression);
+		std::vector<unsigned char> decoded((size_t)width * height * 4);
+		BlockCompressorClass::Decode(cooked.data.data(), width, height, decoded.data(), format);
+		int channels = format == BLOCK_FORMAT_BC5 ? 2 : IsOpaque(texture) ? 3 : 4;
+		report.psnr = BlockCompressorClass::GetPsnr(texture.data.data(), decoded.data(), width, height, channels);
+	}
+	return true;
+}
+
+bool TextureCookerClass::CookHdr(const MappedFileClass& file, const TextureCookSettings& settings, CookedTexture& cooked,
+	TextureCookReport& report, ThreadPoolClass* pool) {
+	// Decoded and filtered as floats, which only the last step narrows.
+	HdrDecoderClass decoder(file.GetData(), file.GetSize());
+	if (!decoder.ReadHeader()) {
+		report.error = decoder.errorMessage;
+		return false;
+	}
+	int width = decoder.GetWidth();
+	int height = decoder.GetHeight();
+	std::vector<float> chain(MipGeneratorClass::GetChainSize(width, height));
+	if (!decoder.Decode(chain.data())) {
+		report.error = decoder.errorMessage;
+		return false;
+	}
+	// Always the box: the Kaiser's negative lobes ring around a bright sun, and clamping that at zero makes light out
+	// of nothing. A test sky came out more than twice too bright at 1x1 that way, the box keeps the mean exactly (of power
+	// of two sizes, odd ones drop their last row or column like GenerateMips).
+	MipGeneratorClass::Generate(chain.data(), width, height, MIP_FILTER_BOX, pool);
+
+	bool half = settings.hdrFormat == TEXTURE_HDR_HALF;
+	size_t texelBytes = half ? 8 : 4;
+	cooked = CookedTexture();
+	cooked.format = half ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R9G9B9E5_SHAREDEXP;
+	cooked.width = width;
+	cooked.height = height;
+	cooked.cookKey = GetCookKey(settings);
+	for (const MipLevel& mip : MipGeneratorClass::GetLevels(width, height)) {
+		size_t rowPitch = (size_t)mip.width * texelBytes;
+		cooked.levels.push_back({ mip.width, mip.height, mip.offset / 4 * texelBytes, rowPitch, rowPitch * mip.height });
+	}
+	cooked.mipLevels = (uint32_t)cooked.levels.size();
+
+	// The chain and the cooked levels hold the same texels in the same order, so it converts in one run.
+	size_t texels = chain.size() / 4;
+	cooked.data.resize(texels * texelBytes);
+	uint16_t* halves = (uint16_t*)cooked.data.data();
+	uint32_t* packed = (uint32_t*)cooked.data.data();
+	size_t chunks = (texels + CONVERT_TEXELS - 1) / CONVERT_TEXELS;
+	auto convert = [&](size_t i) {
+		size_t first = i * CONVERT_TEXELS;
+		size_t count = std::min(CONVERT_TEXELS, texels - first);
+		if (half) { ImageConverterClass::FloatToHalf(chain.data() + first * 4, halves + first * 4, count * 4); }
+		else { ImageConverterClass::FloatToRgb9e5(chain.data() + first * 4, packed + first, count); }
+	};
+	if (pool && chunks > 1) { pool->ParallelFor(chunks, convert); }
+	else {
+		for (size_t i = 0; i < chunks; i++) { convert(i); }
+	}
+
+	report.format = cooked.format;
+	report.uncompressedBytes = chain.size() * sizeof(float);
+	report.cookedBytes = cooked.data.size();
+	report.bitsPerTexel = GetBitsPerTexel(cooked);
+
+	if (settings.measureQuality) {
+		// Relative to the brightest channel, which is what the shared exponent and the halves both keep the precision of.
+		double sum = 0.0;
+		size_t count = 0;
+		for (size_t i = 0; i < (size_t)width * height; i++) {
+			const float* source = chain.data() + i * 4;
+			float largest = std::max(std::max(source[0], source[1]), source[2]);
+			if (largest <= 0.0f) { continue; }
+			float decoded[3];
+			if (half) {
+				for (int channel = 0; channel < 3; channel++) { decoded[channel] = ImageConverterClass::HalfToFloat(halves[i * 4 + channel]); }
+			}
+			else { ImageConverterClass::Rgb9e5ToFloat(packed[i], decoded); }
+			for (int channel = 0; channel < 3; channel++) {
+				double error = (decoded[channel] - source[channel]) / largest;
+				sum += error * error;
+			}
+			count += 3;
+		}
+		report.hdrError = count > 0 ? sqrt(sum / count) : 0.0;
+	}
+	return true;
+}
+
+TextureCompression TextureCookerClass::SelectCompression(const CookedTexture& texture, const TextureCookSettings& settings) {
+	// D3D11 wants level 0 of a block compressed texture in whole blocks, other sizes stay uncompressed.
+	if (texture.width % 4 != 0 || texture.height % 4 != 0) { return TEXTURE_COMPRESSION_NONE; }
+	if (settings.compression != TEXTURE_COMPRESSION_AUTO) { return settings.compression; }
+	return IsOpaque(texture) ? TEXTURE_COMPRESSION_BC1 : TEXTURE_COMPRESSION_BC3;
+}
+
+void TextureCookerClass::Compress(const CookedTexture& texture, TextureCompression compression, BlockQuality quality, CookedTexture& cooked,
+	ThreadPoolClass* pool) {
+	BlockFormat format = GetBlockFormat(compression);
+	cooked.width = texture.width;
+	cooked.height = texture.height;
+	cooked.mipLevels = texture.mipLevels;
+	cooked.arraySize = texture.arraySize;
+	cooked.cube = texture.cube;
+	cooked.cookKey = texture.cookKey;
+	switch (format) {
+	case BLOCK_FORMAT_BC3: cooked.format = DXGI_FORMAT_BC3_UNORM; break;
+	case BLOCK_FORMAT_BC5: cooked.format = DXGI_FORMAT_BC5_UNORM; break;
+	case BLOCK_FORMAT_BC7: cooked.format = DXGI_FORMAT_BC7_UNORM; break;
+	default: cooked.format = DXGI_FORMAT_BC1_UNORM; break;
+	}
+
+	size_t size = 0;
+	cooked.levels.clear();
+	for (const CookedTextureLevel& level : texture.levels) {
+		size_t levelSize = BlockCompressorClass::GetLevelSize(format, level.width, level.height);
+		cooked.levels.push_back({ level.width, level.height, size, BlockCompressorClass::GetRowPitch(format, level.width), levelSize });
+		size += levelSize;
+	}
+	cooked.data.resize(size);
+	for (size_t i = 0; i < texture.levels.size(); i++) {
+		const CookedTextureLevel& level = texture.levels[i];
+		BlockCompressorClass::Encode(texture.data.data() + level.offset, level.width, level.height, cooked.data.data() + cooked.levels[i].offset,
+			format, quality, pool);
+	}
+}
+
+BlockFormat TextureCookerClass::GetBlockFormat(TextureCompression compression) {
+	switch (compression) {
+	case TEXTURE_COMPRESSION_BC3: return BLOCK_FORMAT_BC3;
+	case TEXTURE_COMPRESSION_BC5: return BLOCK_FORMAT_BC5;
+	case TEXTURE_COMPRESSION_BC7: return BLOCK_FORMAT_BC7;
+	default: return BLOCK_FORMAT_BC1;
+	}
+}
+
+bool TextureCookerClass::IsOpaque(const CookedTexture& texture) {
+	// The mips only average level 0, so it decides for the whole chain. Every slice counts.
+	for (uint32_t slice = 0; slice < texture.arraySize; slice++) {
+		const CookedTextureLevel& level = texture.levels[(size_t)slice * texture.mipLevels];
+		const unsigned char* texels = texture.data.data() + level.offset;
+		for (size_t i = 3; i < level.size; i += 4) {
+			if (texels[i] != 255) { return false; }
+		}
+	}
+	return true;
+}
+
+uint32_t TextureCookerClass::GetCookKey(const TextureCookSettings& settings) {
+	// Never zero, which is what files without a key read as.
+	return 1u << 31 | (uint32_t)settings.compression | (uint32_t)settings.quality << 8 | (uint32_t)settings.mipFilter << 16 |
+		(uint32_t)settings.srgb << 24 | (uint32_t)settings.hdrFormat << 25;
+}
+
+bool TextureCookerClass::Decode(const char* sourceFilename, const MappedFileClass& file, std::vector<unsigned char>& chain, int& width,
+	int& height, std::string& error) {
+	// Told apart by the PNG signature, anything else is taken for a TGA, which has none.
+	if (file.isInitialized && PngDecoderClass::IsPng(file.GetData(), file.GetSize())) { return DecodePng(file, chain, width, height, error); }
+	return DecodeTarga(sourceFilename, chain, width, height, error);
+}
+
+bool TextureCookerClass::DecodeTarga(const char* sourceFilename, std::vector<unsigned char>& chain, int& width, int& height, std::string& error) {
+	std::ifstream stream(sourceFilename, std::ios::binary);
+	if (!stream) {
+		error = "could not open the file";
+		return false;
+	}
+
+	TargaDecoderClass decoder(stream);
+	if (!decoder.ReadHeader()) {
+		error = decoder.errorMessage;
+		return false;
+	}
+	width = decoder.GetWidth();
+	height = decoder.GetHeight();
+	chain.resize(MipGeneratorClass::GetChainSize(width, height));
+	if (!decoder.Decode(chain.data())) {
+		error = decoder.errorMessage;
+		return false;
+	}
+	return true;
+}
+
+bool TextureCookerClass::DecodePng(const MappedFileClass& file, std::vector<unsigned char>& chain, int& width, int& height, std::string& error) {
+	// Inflates from the mapped file and unfilters straight into the chain.
+	PngDecoderClass decoder(file.GetData(), file.GetSize());
+	if (!decoder.ReadHeader()) {
+		error = decoder.errorMessage;
+		return false;
+	}
+	width = decoder.GetWidth();
+	height = decoder.GetHeight();
+	chain.resize(MipGeneratorClass::GetChainSize(width, height));
+	if (!decoder.Decode(chain.data())) {
+		error = decoder.errorMessage;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <d3d11.h>
+#include "blockcompressorclass.hpp"
+#include "mappedfileclass.hpp"
+#include "mipgeneratorclass.hpp"
+#include "texturefileclass.hpp"
+#include <string>
+#include <vector>
+
+enum TextureCompression {
+	TEXTURE_COMPRESSION_NONE,	// RGBA8, 4 bytes a texel.
+	TEXTURE_COMPRESSION_AUTO,	// BC1 when every texel is opaque, BC3 otherwise.
+	TEXTURE_COMPRESSION_BC1,
+	TEXTURE_COMPRESSION_BC3,
+	TEXTURE_COMPRESSION_BC5,
+	TEXTURE_COMPRESSION_BC7,
+};
+
+// What HDR sources are cooked to. Neither is block compressed.
+enum TextureHdrFormat {
+	TEXTURE_HDR_RGB9E5,	// R9G9B9E5_SHAREDEXP, 4 bytes a texel: 9 bit mantissas under a shared exponent, no alpha.
+	TEXTURE_HDR_HALF,	// R16G16B16A16_FLOAT, 8 bytes a texel, for when one texel spans too much range or needs alpha.
+};
+
+struct TextureCookSettings {
+	TextureCompression compression = TEXTURE_COMPRESSION_AUTO;
+	BlockQuality quality = BLOCK_QUALITY_NORMAL;
+	MipFilter mipFilter = MIP_FILTER_KAISER;	// HDR sources always use the box.
+	bool srgb = true;	// Color is filtered in linear light. Off for data such as normal maps.
+	TextureHdrFormat hdrFormat = TEXTURE_HDR_RGB9E5;	// HDR sources ignore the compression and srgb.
+	bool measureQuality = false;	// Decodes level 0 again for the PSNR or HDR error in the report.
+};
+
+// What the cooker did to a texture, or why it failed.
+struct TextureCookReport {
+	std::string error;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	size_t uncompressedBytes = 0;	// The RGBA8 mip chain, or the float one of HDR sources.
+	size_t cookedBytes = 0;
+	double bitsPerTexel = 0.0;	// What level 0 costs in memory: 32 for RGBA8 and RGB9E5, 64 for halves, 4 or 8 for BCn.
+	double psnr = 0.0;	// Of level 0 over the channels the source uses, only with measureQuality.
+	double hdrError = 0.0;	// HDR sources: RMS error of level 0 relative to each texel's brightest channel, with measureQuality.
+};
+
+// Turns source images (PNG, Radiance HDR, or TGA for anything without either signature) into cooked *.dds files that
+// TextureClass can map directly: decoded, with the mips built on the CPU and block compressed unless the settings say
+// otherwise. HDR images keep their range as half floats or shared exponents. Needs no device, so it runs on workers.
+class TextureCookerClass {
+public:
+	static std::string GetCookedFilename(const char* sourceFilename);
+	static bool IsStale(const char* sourceFilename, const char* textureFilename, const TextureCookSettings& settings);
+	static bool Cook(const char* sourceFilename, const char* textureFilename, const TextureCookSettings& settings, TextureCookReport& report,
+		ThreadPoolClass* pool = 0);
+	// The same cook kept in memory.
+	static bool Cook(const char* sourceFilename, const TextureCookSettings& settings, CookedTexture& cooked, TextureCookReport& report,
+		ThreadPoolClass* pool = 0);
+
+	// What Cook does to an RGBA8 texture, for callers that build their own such as the texture packer. Select resolves
+	// AUTO and falls back to NONE for sizes that are not whole blocks. Compress takes any other compression and encodes
+	// every level of every slice.
+	static TextureCompression SelectCompression(const CookedTexture& texture, const TextureCookSettings& settings);
+	static void Compress(const CookedTexture& texture, TextureCompression compression, BlockQuality quality, CookedTexture& cooked,
+		ThreadPoolClass* pool = 0);
+	static uint32_t GetCookKey(const TextureCookSettings& settings);
+
+private:
+	static BlockFormat GetBlockFormat(TextureCompression compression);
+	static bool IsOpaque(const CookedTexture& texture);
+	static bool CookHdr(const MappedFileClass& file, const TextureCookSettings& settings, CookedTexture& cooked, TextureCookReport& report,
+		ThreadPoolClass* pool);
+	// Leaves room for the whole mip chain after level 0.
+	static bool Decode(const char* sourceFilename, const MappedFileClass& file, std::vector<unsigned char>& chain, int& width, int& height,
+		std::string& error);
+	static bool DecodeTarga(const char* sourceFilename, std::vector<unsigned char>& chain, int& width, int& height, std::string& error);
+	static bool DecodePng(const MappedFileClass& file, std::vector<unsigned char>& chain, int& width, int& height, std::string& error);
+};
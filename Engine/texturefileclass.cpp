@@ -0,0 +1,259 @@
+#include "texturefileclass.hpp"
+#include <string.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+	constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+		return (uint32_t)(unsigned char)a | (uint32_t)(unsigned char)b << 8 | (uint32_t)(unsigned char)c << 16 | (uint32_t)(unsigned char)d << 24;
+	}
+
+	constexpr uint32_t DDSD_CAPS = 0x1;
+	constexpr uint32_t DDSD_HEIGHT = 0x2;
+	constexpr uint32_t DDSD_WIDTH = 0x4;
+	constexpr uint32_t DDSD_PITCH = 0x8;
+	constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+	constexpr uint32_t DDSD_DEPTH = 0x800000;
+	constexpr uint32_t DDPF_FOURCC = 0x4;
+	constexpr uint32_t DDPF_RGB = 0x40;
+	constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+	constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+	constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+	constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	constexpr uint32_t DDSCAPS2_CUBEMAP_ALL_FACES = 0xFC00;
+	constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+	constexpr uint32_t DDS_MISC_TEXTURECUBE = 0x4;
+	constexpr int MAX_DIMENSION = 16384;	// D3D11's limit for 2D textures.
+	constexpr uint32_t MAX_ARRAY_SIZE = 2048;
+
+	// Bytes of one block and its edge in texels, 1 for formats that are not block compressed.
+	bool GetFormatBlock(DXGI_FORMAT format, size_t& blockBytes, int& blockSize) {
+		blockSize = 1;
+		switch (format) {
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC4_SNORM:
+			blockBytes = 8;
+			blockSize = 4;
+			return true;
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC6H_UF16:
+		case DXGI_FORMAT_BC6H_SF16:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			blockBytes = 16;
+			blockSize = 4;
+			return true;
+		case DXGI_FORMAT_R8_UNORM:
+			blockBytes = 1;
+			return true;
+		case DXGI_FORMAT_R8G8_UNORM:
+			blockBytes = 2;
+			return true;
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+		case DXGI_FORMAT_R11G11B10_FLOAT:
+		case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+		case DXGI_FORMAT_R16G16_FLOAT:
+			blockBytes = 4;
+			return true;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			blockBytes = 8;
+			return true;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			blockBytes = 16;
+			return true;
+		default:
+			return false;
+		}
+	}
+}
+
+TextureFileClass::TextureFileClass(const char* filename) {
+	m_file = new MappedFileClass(filename);
+	if (not m_file->isInitialized) { return; }
+
+	size_t size = m_file->GetSize();
+	size_t offset = sizeof(DDS_MAGIC) + sizeof(DdsHeader);
+	if (size < offset) { return; }
+	if (memcmp(m_file->GetData(), DDS_MAGIC, sizeof(DDS_MAGIC)) != 0) { return; }
+	const DdsHeader& header = *(const DdsHeader*)(m_file->GetData() + sizeof(DDS_MAGIC));
+	if (header.size != sizeof(DdsHeader) || header.format.size != sizeof(DdsPixelFormat)) { return; }
+	if ((header.flags & DDSD_DEPTH) || (header.caps2 & DDSCAPS2_VOLUME)) { return; }	// Volume textures.
+
+	m_width = (int)header.width;
+	m_height = (int)header.height;
+	if (header.width == 0 || header.height == 0 || header.width > MAX_DIMENSION || header.height > MAX_DIMENSION) { return; }
+	m_mipLevels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount ? header.mipMapCount : 1;
+	uint32_t fullChain = 1;
+	while ((m_width | m_height) >> fullChain) { fullChain++; }
+	if (m_mipLevels > fullChain) { return; }
+
+	if ((header.format.flags & DDPF_FOURCC) && header.format.fourCC == MakeFourCC('D', 'X', '1', '0')) {
+		if (size < offset + sizeof(DdsHeaderDx10)) { return; }
+		const DdsHeaderDx10& extension = *(const DdsHeaderDx10*)(m_file->GetData() + offset);
+		offset += sizeof(DdsHeaderDx10);
+		if (extension.resourceDimension != DDS_DIMENSION_TEXTURE2D) { return; }
+		if (extension.arraySize == 0 || extension.arraySize > MAX_ARRAY_SIZE) { return; }
+		m_format = (DXGI_FORMAT)extension.dxgiFormat;
+		m_cube = (extension.miscFlag & DDS_MISC_TEXTURECUBE) != 0;
+		m_arraySize = extension.arraySize * (m_cube ? 6 : 1);
+	}
+	else {
+		if (!ReadLegacyFormat(header)) { return; }
+		// Old cube maps may leave faces out, D3D11 wants all six.
+		m_cube = (header.caps2 & DDSCAPS2_CUBEMAP) != 0;
+		if (m_cube && (header.caps2 & DDSCAPS2_CUBEMAP_ALL_FACES) != DDSCAPS2_CUBEMAP_ALL_FACES) { return; }
+		m_arraySize = m_cube ? 6 : 1;
+	}
+	if (m_cube && m_width != m_height) { return; }
+
+	uint32_t version = header.reserved1[1];
+	if (memcmp(header.reserved1, TEXTURE_FILE_TAG, sizeof(TEXTURE_FILE_TAG)) == 0 && version == TEXTURE_FILE_VERSION) {
+		m_cookKey = header.reserved1[2];
+	}
+
+	// Lay out every subresource up front so GetLevelData can hand out raw pointers.
+	m_levels.reserve((size_t)m_arraySize * m_mipLevels);
+	for (uint32_t slice = 0; slice < m_arraySize; slice++) {
+		for (uint32_t mip = 0; mip < m_mipLevels; mip++) {
+			CookedTextureLevel level{};
+			level.width = m_width >> mip ? m_width >> mip : 1;
+			level.height = m_height >> mip ? m_height >> mip : 1;
+			level.offset = offset;
+			if (!GetLevelPitch(m_format, level.width, level.height, level.rowPitch, level.size)) { return; }
+			if (level.size > size - offset) { return; }
+			offset += level.size;
+			m_levels.push_back(level);
+		}
+	}
+	isInitialized = true;
+}
+
+TextureFileClass::~TextureFileClass() {
+	if (m_file) {
+		delete m_file;
+		m_file = 0;
+	}
+}
+
+bool TextureFileClass::ReadLegacyFormat(const DdsHeader& header) {
+	// Files written before the DX10 header, as older tools still do.
+	const DdsPixelFormat& format = header.format;
+	if (format.flags & DDPF_FOURCC) {
+		switch (format.fourCC) {
+		case MakeFourCC('D', 'X', 'T', '1'): m_format = DXGI_FORMAT_BC1_UNORM; return true;
+		case MakeFourCC('D', 'X', 'T', '2'):
+		case MakeFourCC('D', 'X', 'T', '3'): m_format = DXGI_FORMAT_BC2_UNORM; return true;
+		case MakeFourCC('D', 'X', 'T', '4'):
+		case MakeFourCC('D', 'X', 'T', '5'): m_format = DXGI_FORMAT_BC3_UNORM; return true;
+		case MakeFourCC('A', 'T', 'I', '1'):
+		case MakeFourCC('B', 'C', '4', 'U'): m_format = DXGI_FORMAT_BC4_UNORM; return true;
+		case MakeFourCC('B', 'C', '4', 'S'): m_format = DXGI_FORMAT_BC4_SNORM; return true;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'): m_format = DXGI_FORMAT_BC5_UNORM; return true;
+		case MakeFourCC('B', 'C', '5', 'S'): m_format = DXGI_FORMAT_BC5_SNORM; return true;
+		case 113: m_format = DXGI_FORMAT_R16G16B16A16_FLOAT; return true;	// D3DFMT_A16B16G16R16F
+		case 116: m_format = DXGI_FORMAT_R32G32B32A32_FLOAT; return true;	// D3DFMT_A32B32G32R32F
+		default: return false;
+		}
+	}
+	if (!(format.flags & DDPF_RGB) || format.rgbBitCount != 32) { return false; }
+	if (format.rBitMask == 0x000000ff && format.gBitMask == 0x0000ff00 && format.bBitMask == 0x00ff0000) {
+		m_format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		return true;
+	}
+	if (format.rBitMask == 0x00ff0000 && format.gBitMask == 0x0000ff00 && format.bBitMask == 0x000000ff) {
+		m_format = format.aBitMask ? DXGI_FORMAT_B8G8R8A8_UNORM : DXGI_FORMAT_B8G8R8X8_UNORM;
+		return true;
+	}
+	return false;
+}
+
+bool TextureFileClass::GetLevelPitch(DXGI_FORMAT format, int width, int height, size_t& rowPitch, size_t& size) {
+	size_t blockBytes = 0;
+	int blockSize = 1;
+	if (!GetFormatBlock(format, blockBytes, blockSize)) { return false; }
+	size_t columns = ((size_t)width + blockSize - 1) / blockSize;
+	size_t rows = ((size_t)height + blockSize - 1) / blockSize;
+	rowPitch = columns * blockBytes;
+	size = rowPitch * rows;
+	return true;
+}
+
+int TextureFileClass::GetBlockSize(DXGI_FORMAT format) {
+	size_t blockBytes = 0;
+	int blockSize = 1;
+	return GetFormatBlock(format, blockBytes, blockSize) ? blockSize : 0;
+}
+
+bool TextureFileClass::Write(const char* filename, const CookedTexture& texture) {
+	size_t blockBytes = 0;
+	int blockSize = 1;
+	if (!GetFormatBlock(texture.format, blockBytes, blockSize)) { return false; }
+	if (texture.levels.size() != (size_t)texture.mipLevels * texture.arraySize || texture.levels.empty()) { return false; }
+	if (texture.cube && texture.arraySize % 6 != 0) { return false; }
+	for (const CookedTextureLevel& level : texture.levels) {
+		if (level.offset > texture.data.size() || level.size > texture.data.size() - level.offset) { return false; }
+	}
+
+	DdsHeader header{};
+	header.size = sizeof(DdsHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+	header.flags |= blockSize > 1 ? DDSD_LINEARSIZE : DDSD_PITCH;
+	header.height = (uint32_t)texture.height;
+	header.width = (uint32_t)texture.width;
+	header.pitchOrLinearSize = (uint32_t)(blockSize > 1 ? texture.levels[0].size : texture.levels[0].rowPitch);
+	header.mipMapCount = texture.mipLevels;
+	memcpy(header.reserved1, TEXTURE_FILE_TAG, sizeof(TEXTURE_FILE_TAG));
+	header.reserved1[1] = TEXTURE_FILE_VERSION;
+	header.reserved1[2] = texture.cookKey;
+	header.format.size = sizeof(DdsPixelFormat);
+	header.format.flags = DDPF_FOURCC;
+	header.format.fourCC = MakeFourCC('D', 'X', '1', '0');
+	header.caps = DDSCAPS_TEXTURE;
+	if (texture.mipLevels > 1) { header.caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP; }
+	if (texture.cube) {
+		header.caps |= DDSCAPS_COMPLEX;
+		header.caps2 = DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALL_FACES;
+	}
+
+	DdsHeaderDx10 extension{};
+	extension.dxgiFormat = (uint32_t)texture.format;
+	extension.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+	extension.miscFlag = texture.cube ? DDS_MISC_TEXTURECUBE : 0;
+	extension.arraySize = texture.cube ? texture.arraySize / 6 : texture.arraySize;
+
+	// Write next to the target and swap it in, so a crash never leaves a half written texture behind.
+	std::string tempFilename = std::string(filename) + ".tmp";
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (fout.fail()) { return false; }
+
+	// The levels follow the headers back to back in subresource order, which is all DDS has for a layout.
+	fout.write(DDS_MAGIC, sizeof(DDS_MAGIC));
+	fout.write((const char*)&header, sizeof(header));
+	fout.write((const char*)&extension, sizeof(extension));
+	for (const CookedTextureLevel& level : texture.levels) {
+		fout.write((const char*)texture.data.data() + level.offset, (std::streamsize)level.size);
+	}
+	fout.close();
+	if (fout.fail()) { return false; }
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, filename, error);
+	return !error;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <d3d11.h>
+#include <stdint.h>
+#include <vector>
+#include "mappedfileclass.hpp"
+
+// Cooked texture container (*.dds). A plain DDS file with the DX10 header, so any DDS viewer opens it: every array
+// slice with all of its mips in the layout D3D11 uploads, straight from the mapped file. The cooker tags its files in
+// reserved header words, untagged DDS files from other tools load as well.
+static constexpr char DDS_MAGIC[4] = { 'D', 'D', 'S', ' ' };
+static constexpr char TEXTURE_FILE_TAG[4] = { 'E', 'T', 'E', 'X' };
+static constexpr uint32_t TEXTURE_FILE_VERSION = 1;	// Bumped whenever cooked output changes, older files get re-cooked.
+
+struct DdsPixelFormat {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t rBitMask;
+	uint32_t gBitMask;
+	uint32_t bBitMask;
+	uint32_t aBitMask;
+};
+
+struct DdsHeader {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];	// The first three hold TEXTURE_FILE_TAG, the version and the cook key.
+	DdsPixelFormat format;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+
+struct CookedTextureLevel {
+	int width;
+	int height;
+	size_t offset;	// From the start of the data.
+	size_t rowPitch;	// Bytes from one row of texels to the next, or of blocks for BCn.
+	size_t size;
+};
+
+// A texture decoded, with all of its mips, in the format it is uploaded in. What the cooker hands to Write.
+struct CookedTexture {
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	int width = 0;
+	int height = 0;
+	uint32_t mipLevels = 0;
+	uint32_t arraySize = 1;	// Six a cube for cube maps.
+	bool cube = false;
+	uint32_t cookKey = 0;	// The settings it was cooked with, a change means a new cook.
+	std::vector<CookedTextureLevel> levels;	// In subresource order, all mips of the first slice, then the next.
+	std::vector<unsigned char> data;
+};
+
+class TextureFileClass {
+public:
+	TextureFileClass(const char* filename);
+	TextureFileClass(const TextureFileClass&) = delete;
+	~TextureFileClass();
+
+	DXGI_FORMAT GetFormat() const { return m_format; }
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	uint32_t GetMipLevels() const { return m_mipLevels; }
+	uint32_t GetArraySize() const { return m_arraySize; }
+	bool IsCube() const { return m_cube; }
+	uint32_t GetCookKey() const { return m_cookKey; }	// Zero for files of other tools and older versions.
+	// Offsets of the levels are from the start of the file.
+	const std::vector<CookedTextureLevel>& GetLevels() const { return m_levels; }
+	const unsigned char* GetLevelData(size_t subresource) const { return m_file->GetData() + m_levels[subresource].offset; }
+
+	static bool Write(const char* filename, const CookedTexture& texture);
+	// False for formats the container does not know.
+	static bool GetLevelPitch(DXGI_FORMAT format, int width, int height, size_t& rowPitch, size_t& size);
+	static int GetBlockSize(DXGI_FORMAT format);	// Texels along a block edge, 4 for BCn, 1 otherwise and 0 for unknown formats.
+
+	bool isInitialized = false;
+
+private:
+	bool ReadLegacyFormat(const DdsHeader& header);
+
+	MappedFileClass* m_file = 0;
+	DXGI_FORMAT m_format = DXGI_FORMAT_UNKNOWN;
+	int m_width = 0;
+	int m_height = 0;
+	uint32_t m_mipLevels = 0;
+	uint32_t m_arraySize = 0;
+	bool m_cube = false;
+	uint32_t m_cookKey = 0;
+	std::vector<CookedTextureLevel> m_levels;
+};
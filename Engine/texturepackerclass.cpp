@@ -0,0 +1,376 @@
+#include "texturepackerclass.hpp"
+#include <string.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace {
+	constexpr char PACK_INDEX_MAGIC[] = "EPAK";
+	constexpr uint32_t PACK_INDEX_VERSION = 1;
+
+	// Bottom-left skyline packing: the top edge of everything placed so far, as segments from left to right. A
+	// rectangle goes where its top ends up lowest, ties go to the spot that buries the least area under it.
+	class Skyline {
+	public:
+		Skyline(int width, int height) : m_width(width), m_height(height) { m_segments.push_back({ 0, 0, width }); }
+
+		bool Insert(int width, int height, int& x, int& y) {
+			size_t best = m_segments.size();
+			int bestTop = 0;
+			long long bestWaste = 0;
+			for (size_t i = 0; i < m_segments.size(); i++) {
+				long long waste = 0;
+				int top = Fit(i, width, height, waste);
+				if (top < 0) { continue; }
+				if (best == m_segments.size() || top < bestTop || (top == bestTop && waste < bestWaste)) {
+					best = i;
+					bestTop = top;
+					bestWaste = waste;
+				}
+			}
+			if (best == m_segments.size()) { return false; }
+
+			x = m_segments[best].x;
+			y = bestTop - height;
+			Place(best, width, bestTop);
+			return true;
+		}
+
+		int GetHeight() const {
+			int height = 0;
+			for (const Segment& segment : m_segments) { height = std::max(height, segment.y); }
+			return height;
+		}
+
+	private:
+		struct Segment {
+			int x;
+			int y;
+			int width;
+		};
+
+		// Top of the rectangle resting on the segments from index on, -1 when it sticks out of the page.
+		int Fit(size_t index, int width, int height, long long& waste) const {
+			int x = m_segments[index].x;
+			if (x + width > m_width) { return -1; }
+			int y = 0;
+			for (size_t i = index; i < m_segments.size() && m_segments[i].x < x + width; i++) { y = std::max(y, m_segments[i].y); }
+			if (y + height > m_height) { return -1; }
+			for (size_t i = index; i < m_segments.size() && m_segments[i].x < x + width; i++) {
+				int covered = std::min(m_segments[i].x + m_segments[i].width, x + width) - m_segments[i].x;
+				waste += (long long)(y - m_segments[i].y) * covered;
+			}
+			return y + height;
+		}
+
+		void Place(size_t index, int width, int top) {
+			int x = m_segments[index].x;
+			m_segments.insert(m_segments.begin() + index, { x, top, width });
+			// Cut the segments now below the new one.
+			size_t i = index + 1;
+			while (i < m_segments.size() && m_segments[i].x < x + width) {
+				int right = m_segments[i].x + m_segments[i].width;
+				if (right <= x + width) {
+					m_segments.erase(m_segments.begin() + i);
+					continue;
+				}
+				m_segments[i].width = right - (x + width);
+				m_segments[i].x = x + width;
+				break;
+			}
+			for (size_t j = 1; j < m_segments.size();) {
+				if (m_segments[j - 1].y == m_segments[j].y) {
+					m_segments[j - 1].width += m_segments[j].width;
+					m_segments.erase(m_segments.begin() + j);
+				}
+				else { j++; }
+			}
+		}
+
+		std::vector<Segment> m_segments;
+		int m_width;
+		int m_height;
+	};
+
+	int AlignUp(int value, int alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+	// An RGBA8 array of blank slices that all share one layout.
+	void InitializeArray(CookedTexture& texture, int width, int height, uint32_t mipLevels, uint32_t arraySize) {
+		texture.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		texture.width = width;
+		texture.height = height;
+		texture.mipLevels = mipLevels;
+		texture.arraySize = arraySize;
+		size_t offset = 0;
+		for (uint32_t slice = 0; slice < arraySize; slice++) {
+			for (uint32_t mip = 0; mip < mipLevels; mip++) {
+				CookedTextureLevel level{};
+				level.width = width >> mip ? width >> mip : 1;
+				level.height = height >> mip ? height >> mip : 1;
+				level.offset = offset;
+				level.rowPitch = (size_t)level.width * 4;
+				level.size = level.rowPitch * level.height;
+				offset += level.size;
+				texture.levels.push_back(level);
+			}
+		}
+		// Opaque black, so the gaps between atlas entries never cost an opaque pack its BC1.
+		texture.data.assign(offset, 0);
+		for (size_t i = 3; i < offset; i += 4) { texture.data[i] = 255; }
+	}
+}
+
+bool TexturePackerClass::Pack(const std::vector<TexturePackSource>& sources, const TexturePackSettings& settings, std::vector<CookedTexture>& packs,
+	std::vector<TexturePackEntry>& entries, TexturePackReport& report, ThreadPoolClass* pool) {
+	auto start = std::chrono::steady_clock::now();
+	packs.clear();
+	entries.assign(sources.size(), TexturePackEntry());
+	report = TexturePackReport();
+	report.textures = sources.size();
+
+	// Everything is packed as RGBA8 mips and compressed as a whole afterwards.
+	TextureCookSettings cookSettings = settings.cook;
+	cookSettings.compression = TEXTURE_COMPRESSION_NONE;
+	cookSettings.measureQuality = false;
+	std::vector<CookedTexture> textures(sources.size());
+	std::vector<TextureCookReport> cookReports(sources.size());
+	std::vector<char> cooked(sources.size());
+	auto cook = [&](size_t i) {
+		cooked[i] = TextureCookerClass::Cook(sources[i].filename.c_str(), cookSettings, textures[i], cookReports[i], pool);
+	};
+	if (pool && sources.size() > 1) { pool->ParallelFor(sources.size(), cook); }
+	else {
+		for (size_t i = 0; i < sources.size(); i++) { cook(i); }
+	}
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (!cooked[i]) {
+			report.error = sources[i].filename + ": " + cookReports[i].error;
+			return false;
+		}
+		if (textures[i].format != DXGI_FORMAT_R8G8B8A8_UNORM) {
+			report.error = sources[i].filename + ": HDR images are not packed";
+			return false;
+		}
+		entries[i].filename = sources[i].filename;
+	}
+
+	// The pages keep the mips the gutter still covers. Entries start on multiples of the last level's texel and of a
+	// block, so every level lines up and level 0 compresses like the texture alone.
+	int pageSize = settings.pageSize;
+	uint32_t pageMips = 1;
+	while ((settings.padding >> pageMips) > 0 && (pageSize >> pageMips) > 0) { pageMips++; }
+	int alignment = std::max(4, 1 << (pageMips - 1));
+	int padding = settings.padding > 0 ? AlignUp(settings.padding, alignment) : 0;
+
+	std::vector<size_t> atlased;
+	std::vector<size_t> whole;
+	for (size_t i = 0; i < sources.size(); i++) {
+		bool fits = textures[i].width + 2 * padding <= pageSize && textures[i].height + 2 * padding <= pageSize;
+		if (settings.atlas && !sources[i].tiling && fits) { atlased.push_back(i); }
+		else { whole.push_back(i); }
+	}
+
+	// Tall first, then wide, which leaves the flattest skylines.
+	auto packStart = std::chrono::steady_clock::now();
+	std::stable_sort(atlased.begin(), atlased.end(), [&](size_t a, size_t b) {
+		if (textures[a].height != textures[b].height) { return textures[a].height > textures[b].height; }
+		return textures[a].width > textures[b].width;
+	});
+	struct Placement {
+		uint32_t page;
+		int x;
+		int y;
+	};
+	std::vector<Placement> placements(atlased.size());
+	std::vector<Skyline> pages;
+	for (size_t i = 0; i < atlased.size(); i++) {
+		const CookedTexture& texture = textures[atlased[i]];
+		int width = AlignUp(texture.width + 2 * padding, alignment);
+		int height = AlignUp(texture.height + 2 * padding, alignment);
+		Placement& placement = placements[i];
+		placement.page = 0;
+		while (placement.page < pages.size() && !pages[placement.page].Insert(width, height, placement.x, placement.y)) { placement.page++; }
+		if (placement.page == pages.size()) {
+			pages.emplace_back(pageSize, pageSize);
+			pages.back().Insert(width, height, placement.x, placement.y);
+		}
+	}
+	report.packSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - packStart).count();
+
+	if (!pages.empty()) {
+		packs.emplace_back();
+		InitializeArray(packs.back(), pageSize, pageSize, pageMips, (uint32_t)pages.size());
+		uint64_t texels = 0;
+		for (size_t i = 0; i < atlased.size(); i++) {
+			const CookedTexture& texture = textures[atlased[i]];
+			TexturePackEntry& entry = entries[atlased[i]];
+			int x = placements[i].x + padding;
+			int y = placements[i].y + padding;
+			entry.pack = 0;
+			entry.region.slice = placements[i].page;
+			entry.region.scaleBias[0] = (float)texture.width / pageSize;
+			entry.region.scaleBias[1] = (float)texture.height / pageSize;
+			entry.region.scaleBias[2] = (float)x / pageSize;
+			entry.region.scaleBias[3] = (float)y / pageSize;
+			texels += (uint64_t)texture.width * texture.height;
+		}
+		// Entries never overlap, not even their gutters, so they are copied in parallel.
+		CookedTexture& atlas = packs.back();
+		auto copy = [&](size_t i) {
+			CopyToPage(textures[atlased[i]], placements[i].x + padding, placements[i].y + padding, padding, atlas, placements[i].page);
+		};
+		if (pool && atlased.size() > 1) { pool->ParallelFor(atlased.size(), copy); }
+		else {
+			for (size_t i = 0; i < atlased.size(); i++) { copy(i); }
+		}
+		report.atlasTextures = atlased.size();
+		report.atlasPages = pages.size();
+		uint64_t area = 0;
+		for (const Skyline& skyline : pages) { area += (uint64_t)pageSize * skyline.GetHeight(); }
+		report.efficiency = (double)texels / area;
+	}
+
+	// One array per size for the rest, in the order the sizes first show up.
+	std::map<std::pair<int, int>, std::vector<size_t>> sizes;
+	std::vector<std::pair<int, int>> order;
+	for (size_t i : whole) {
+		std::pair<int, int> size(textures[i].width, textures[i].height);
+		if (sizes.find(size) == sizes.end()) { order.push_back(size); }
+		sizes[size].push_back(i);
+	}
+	for (const std::pair<int, int>& size : order) {
+		const std::vector<size_t>& slices = sizes[size];
+		packs.emplace_back();
+		CookedTexture& array = packs.back();
+		InitializeArray(array, size.first, size.second, textures[slices[0]].mipLevels, (uint32_t)slices.size());
+		for (uint32_t slice = 0; slice < slices.size(); slice++) {
+			CookedTexture& texture = textures[slices[slice]];
+			memcpy(array.data.data() + array.levels[(size_t)slice * array.mipLevels].offset, texture.data.data(), texture.data.size());
+			entries[slices[slice]].pack = (uint32_t)packs.size() - 1;
+			entries[slices[slice]].region.slice = slice;
+			texture = CookedTexture();
+		}
+		report.arraySlices += slices.size();
+	}
+
+	uint32_t cookKey = TextureCookerClass::GetCookKey(settings.cook);
+	for (CookedTexture& pack : packs) {
+		pack.cookKey = cookKey;
+		TextureCompression compression = TextureCookerClass::SelectCompression(pack, settings.cook);
+		if (compression == TEXTURE_COMPRESSION_NONE) { continue; }
+		CookedTexture compressed;
+		TextureCookerClass::Compress(pack, compression, settings.cook.quality, compressed, pool);
+		pack = std::move(compressed);
+	}
+	report.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+void TexturePackerClass::CopyToPage(const CookedTexture& source, int x, int y, int padding, CookedTexture& pages, uint32_t page) {
+	// Every level of the entry goes where level 0 went, scaled down, with the gutter repeating its edge texels.
+	for (uint32_t mip = 0; mip < pages.mipLevels; mip++) {
+		const CookedTextureLevel& from = source.levels[std::min(mip, source.mipLevels - 1)];
+		const CookedTextureLevel& to = pages.levels[(size_t)page * pages.mipLevels + mip];
+		int left = x >> mip;
+		int top = y >> mip;
+		int gutter = padding >> mip;
+		int first = std::max(top - gutter, 0);
+		int last = std::min(top + from.height + gutter, to.height);
+		int columns = std::min(from.width + gutter, to.width - left);
+		for (int row = first; row < last; row++) {
+			int sourceRow = std::min(std::max(row - top, 0), from.height - 1);
+			const uint32_t* input = (const uint32_t*)(source.data.data() + from.offset + sourceRow * from.rowPitch);
+			uint32_t* output = (uint32_t*)(pages.data.data() + to.offset + row * to.rowPitch) + left;
+			for (int i = std::max(-gutter, -left); i < 0; i++) { output[i] = input[0]; }
+			memcpy(output, input, (size_t)from.width * 4);
+			for (int i = from.width; i < columns; i++) { output[i] = input[from.width - 1]; }
+		}
+	}
+}
+
+std::string TexturePackerClass::GetPackFilename(const char* baseFilename, uint32_t pack) {
+	return std::string(baseFilename) + "." + std::to_string(pack) + ".dds";
+}
+
+bool TexturePackerClass::Write(const char* baseFilename, const std::vector<CookedTexture>& packs, const std::vector<TexturePackEntry>& entries) {
+	for (uint32_t i = 0; i < packs.size(); i++) {
+		if (!TextureFileClass::Write(GetPackFilename(baseFilename, i).c_str(), packs[i])) { return false; }
+	}
+
+	// One line per entry, the filename last so it may hold spaces. Floats round trip through to_chars.
+	// Appended in place, which also keeps GCC 12 from seeing overlaps in the temporaries of " " + string.
+	std::string text;
+	text.reserve(64 + entries.size() * 96);
+	text.append(PACK_INDEX_MAGIC).append(" ").append(std::to_string(PACK_INDEX_VERSION));
+	text.append(" ").append(std::to_string(packs.size())).append("\n");
+	for (const TexturePackEntry& entry : entries) {
+		text.append(std::to_string(entry.pack)).append(" ").append(std::to_string(entry.region.slice));
+		for (float value : entry.region.scaleBias) {
+			char buffer[32];
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			text.append(" ").append(buffer, result.ptr);
+		}
+		text.append(" ").append(entry.filename).append("\n");
+	}
+
+	std::string indexFilename = std::string(baseFilename) + ".pack";
+	std::string tempFilename = indexFilename + ".tmp";
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (fout.fail()) { return false; }
+	fout.write(text.data(), (std::streamsize)text.size());
+	fout.close();
+	if (fout.fail()) { return false; }
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, indexFilename, error);
+	return !error;
+}
+
+bool TexturePackerClass::ReadEntries(const char* indexFilename, std::vector<TexturePackEntry>& entries, std::vector<std::string>& packFilenames) {
+	MappedFileClass file(indexFilename);
+	if (!file.isInitialized) { return false; }
+	const char* text = (const char*)file.GetData();
+	const char* end = text + file.GetSize();
+
+	auto skipSpace = [&]() {
+		while (text < end && *text == ' ') { text++; }
+	};
+	auto readNumber = [&](auto& value) {
+		skipSpace();
+		auto result = std::from_chars(text, end, value);
+		text = result.ptr;
+		return result.ec == std::errc();
+	};
+
+	size_t magicLength = strlen(PACK_INDEX_MAGIC);
+	if ((size_t)(end - text) < magicLength || memcmp(text, PACK_INDEX_MAGIC, magicLength) != 0) { return false; }
+	text += magicLength;
+	uint32_t version = 0;
+	uint32_t packCount = 0;
+	if (!readNumber(version) || version != PACK_INDEX_VERSION || !readNumber(packCount)) { return false; }
+	if (text == end || *text++ != '\n') { return false; }
+
+	std::filesystem::path base(indexFilename);
+	base.replace_extension();
+	packFilenames.clear();
+	for (uint32_t i = 0; i < packCount; i++) { packFilenames.push_back(GetPackFilename(base.string().c_str(), i)); }
+
+	entries.clear();
+	while (text < end) {
+		TexturePackEntry entry;
+		if (!readNumber(entry.pack) || entry.pack >= packCount || !readNumber(entry.region.slice)) { return false; }
+		for (float& value : entry.region.scaleBias) {
+			if (!readNumber(value)) { return false; }
+		}
+		skipSpace();
+		const char* lineEnd = (const char*)memchr(text, '\n', end - text);
+		if (!lineEnd) { return false; }
+		entry.filename.assign(text, lineEnd);
+		text = lineEnd + 1;
+		entries.push_back(entry);
+	}
+	return true;
+}
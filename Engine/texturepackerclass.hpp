@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "textureclass.hpp"
+#include "texturecookerclass.hpp"
+
+struct TexturePackSource {
+	std::string filename;
+	bool tiling = false;	// Wraps its UVs, so it needs a whole array slice instead of an atlas spot.
+};
+
+struct TexturePackSettings {
+	TextureCookSettings cook;	// Every pack is cooked with these, the sources only ever get RGBA8 mips.
+	int pageSize = 2048;	// Width and height of the atlas pages.
+	// Texels of edge repeated around every atlas entry, so filtering stays inside it. The pages keep the mips this
+	// still covers by one texel, 8 gives four levels.
+	int padding = 8;
+	bool atlas = true;	// Off gives every texture a whole slice, textures of one size then share an array.
+};
+
+// Where one source ended up: the pack that holds it and where it lies in there.
+struct TexturePackEntry {
+	std::string filename;
+	uint32_t pack = 0;
+	TextureRegion region;
+};
+
+struct TexturePackReport {
+	std::string error;
+	size_t textures = 0;
+	size_t atlasTextures = 0;	// The others got whole slices.
+	size_t atlasPages = 0;
+	size_t arraySlices = 0;	// Slices of whole textures, over all of the size classes.
+	// Texels of the atlased textures over the page area up to the top of what was placed, gutters and gaps count as lost.
+	double efficiency = 1.0;
+	double packSeconds = 0.0;	// Placing the rectangles only.
+	double totalSeconds = 0.0;	// With the cooks, the copies and the compression.
+};
+
+// Bins textures that are cooked the same way into shared textures, so models drawn with any of them bind one SRV and
+// only differ by the TextureRegion they hand to the shader. Small textures are packed into padded atlas pages with a
+// skyline packer, the rest become slices of one array per size. Every pack is a texture array written as a cooked
+// *.dds, atlas pages come first. Runs at cook time and needs no device.
+class TexturePackerClass {
+public:
+	static bool Pack(const std::vector<TexturePackSource>& sources, const TexturePackSettings& settings, std::vector<CookedTexture>& packs,
+		std::vector<TexturePackEntry>& entries, TexturePackReport& report, ThreadPoolClass* pool = 0);
+	// Writes pack i next to base as <base>.<i>.dds and the entries as <base>.pack.
+	static bool Write(const char* baseFilename, const std::vector<CookedTexture>& packs, const std::vector<TexturePackEntry>& entries);
+	static std::string GetPackFilename(const char* baseFilename, uint32_t pack);
+	// Entries of a written pack, with their pack files resolved next to the index.
+	static bool ReadEntries(const char* indexFilename, std::vector<TexturePackEntry>& entries, std::vector<std::string>& packFilenames);
+
+private:
+	static void CopyToPage(const CookedTexture& source, int x, int y, int padding, CookedTexture& pages, uint32_t page);
+};
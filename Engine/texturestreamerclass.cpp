@@ -0,0 +1,156 @@
+#include "texturestreamerclass.hpp"
+#include <math.h>
+#include <algorithm>
+
+TextureStreamSettings TextureStreamSettings::FromVideoMemory(int megabytes, float share) {
+	TextureStreamSettings settings;
+	// Integrated cards report little or no dedicated memory, they still get the default.
+	if (megabytes > 0) { settings.budgetBytes = std::max((size_t)((double)megabytes * share * (1 << 20)), settings.tailBytes * 64); }
+	return settings;
+}
+
+uint32_t TextureStreamerClass::Add(uint64_t key, const std::vector<size_t>& mipSizes, uint32_t coarsestTopMip) {
+	auto found = m_entries.find(key);
+	if (found != m_entries.end()) { return found->second.residentMip; }
+
+	Entry entry;
+	entry.mipSizes = mipSizes;
+	uint32_t mipLevels = (uint32_t)mipSizes.size();
+	entry.tailMip = mipLevels > 0 ? mipLevels - 1 : 0;
+	while (entry.tailMip > 0 && GetBytes(entry, entry.tailMip - 1) <= m_settings.tailBytes) { entry.tailMip--; }
+	entry.tailMip = std::min(entry.tailMip, coarsestTopMip);
+	entry.residentMip = entry.tailMip;
+	entry.desiredMip = entry.tailMip;
+	entry.reportedMip = entry.tailMip;
+	entry.lastUsed = m_frame;
+
+	// The tails always fit, the budget only ever holds back the finer mips.
+	m_stats.residentBytes += GetBytes(entry, entry.residentMip);
+	m_stats.peakResidentBytes = std::max(m_stats.peakResidentBytes, m_stats.residentBytes);
+	uint32_t tailMip = entry.tailMip;
+	m_entries.emplace(key, std::move(entry));
+	m_stats.textures = m_entries.size();
+	return tailMip;
+}
+
+void TextureStreamerClass::Remove(uint64_t key) {
+	auto found = m_entries.find(key);
+	if (found == m_entries.end()) { return; }
+	m_stats.residentBytes -= GetBytes(found->second, found->second.residentMip);
+	m_entries.erase(found);
+	m_stats.textures = m_entries.size();
+}
+
+void TextureStreamerClass::SetResident(uint64_t key, uint32_t mip) {
+	auto found = m_entries.find(key);
+	if (found == m_entries.end()) { return; }
+	Entry& entry = found->second;
+	mip = std::min(mip, entry.tailMip);
+	if (mip == entry.residentMip && mip == entry.reportedMip) { return; }
+	m_stats.residentBytes -= GetBytes(entry, entry.residentMip);
+	m_stats.residentBytes += GetBytes(entry, mip);
+	m_stats.peakResidentBytes = std::max(m_stats.peakResidentBytes, m_stats.residentBytes);
+	entry.residentMip = mip;
+	entry.reportedMip = mip;
+}
+
+void TextureStreamerClass::Request(uint64_t key, uint32_t mip) {
+	auto found = m_entries.find(key);
+	if (found == m_entries.end()) { return; }
+	found->second.requestedMip = std::min(found->second.requestedMip, mip);
+}
+
+const std::vector<TextureStreamAction>& TextureStreamerClass::Update() {
+	m_frame++;
+	m_actions.clear();
+	m_stats.frameUploadedBytes = 0;
+
+	// Settle what every texture needs this frame and note the ones drawn blurrier than that.
+	std::vector<std::pair<uint64_t, Entry*>> loads;
+	for (auto& [key, entry] : m_entries) {
+		if (entry.requestedMip == UINT32_MAX) { entry.desiredMip = entry.tailMip; }
+		else {
+			entry.desiredMip = std::min(entry.requestedMip, entry.tailMip);
+			entry.requestedMip = UINT32_MAX;
+			entry.lastUsed = m_frame;
+			m_stats.visibleFrames++;
+			if (entry.residentMip > entry.desiredMip) { m_stats.deficitFrames++; }
+			if (entry.residentMip > entry.desiredMip + 1) { m_stats.severeDeficitFrames++; }
+		}
+		if (entry.residentMip > entry.desiredMip) { loads.push_back({ key, &entry }); }
+	}
+
+	// A shrunk budget or a hot reload may have left too much resident.
+	if (m_stats.residentBytes > m_settings.budgetBytes) { Evict(0, 0); }
+
+	// One mip per texture and frame, the furthest behind first, so every texture sharpens a little before any of them
+	// gets everything. The key only keeps the order the same from run to run.
+	std::sort(loads.begin(), loads.end(), [](const std::pair<uint64_t, Entry*>& a, const std::pair<uint64_t, Entry*>& b) {
+		uint32_t deficitA = a.second->residentMip - a.second->desiredMip, deficitB = b.second->residentMip - b.second->desiredMip;
+		if (deficitA != deficitB) { return deficitA > deficitB; }
+		return a.first < b.first;
+	});
+	for (auto& [key, entry] : loads) {
+		uint32_t mip = entry->residentMip - 1;
+		size_t bytes = entry->mipSizes[mip];
+		if (m_stats.frameUploadedBytes > 0 && m_stats.frameUploadedBytes + bytes > m_settings.uploadBytesPerFrame) { break; }
+		if (m_stats.residentBytes + bytes > m_settings.budgetBytes && !Evict(bytes, entry)) {
+			m_stats.deniedLoads++;
+			continue;
+		}
+		entry->residentMip = mip;
+		m_stats.residentBytes += bytes;
+		m_stats.frameUploadedBytes += bytes;
+		m_stats.loads++;
+	}
+	m_stats.uploadedBytes += m_stats.frameUploadedBytes;
+	m_stats.peakResidentBytes = std::max(m_stats.peakResidentBytes, m_stats.residentBytes);
+
+	for (auto& [key, entry] : m_entries) {
+		if (entry.residentMip == entry.reportedMip) { continue; }
+		entry.reportedMip = entry.residentMip;
+		m_actions.push_back({ key, entry.residentMip });
+	}
+	return m_actions;
+}
+
+bool TextureStreamerClass::Evict(size_t bytes, const Entry* keep) {
+	// Only mips finer than their texture needs are given back, the least recently drawn textures first.
+	std::vector<Entry*> candidates;
+	for (auto& [key, entry] : m_entries) {
+		if (&entry != keep && entry.residentMip < entry.desiredMip) { candidates.push_back(&entry); }
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+		if (a->lastUsed != b->lastUsed) { return a->lastUsed < b->lastUsed; }
+		return a->residentMip < b->residentMip;
+	});
+
+	for (Entry* entry : candidates) {
+		while (entry->residentMip < entry->desiredMip && m_stats.residentBytes + bytes > m_settings.budgetBytes) {
+			m_stats.residentBytes -= entry->mipSizes[entry->residentMip];
+			entry->residentMip++;
+			m_stats.evictions++;
+		}
+		if (m_stats.residentBytes + bytes <= m_settings.budgetBytes) { return true; }
+	}
+	return false;
+}
+
+uint32_t TextureStreamerClass::GetDesiredMip(float texelsPerWorld, float pixelsPerWorld, uint32_t mipLevels) {
+	if (!(texelsPerWorld > 0.0f) || !(pixelsPerWorld > 0.0f) || mipLevels == 0) { return 0; }
+	// Trilinear filtering blends towards the next coarser mip, so the finer one of the pair has to be there.
+	float ratio = texelsPerWorld / pixelsPerWorld;
+	if (ratio <= 1.0f) { return 0; }
+	return std::min((uint32_t)floorf(log2f(ratio)), mipLevels - 1);
+}
+
+uint32_t TextureStreamerClass::GetResidentMip(uint64_t key) const {
+	auto found = m_entries.find(key);
+	return found == m_entries.end() ? 0 : found->second.residentMip;
+}
+
+size_t TextureStreamerClass::GetBytes(const Entry& entry, uint32_t mip) {
+	size_t bytes = 0;
+	for (size_t i = mip; i < entry.mipSizes.size(); i++) { bytes += entry.mipSizes[i]; }
+	return bytes;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+struct TextureStreamSettings {
+	size_t budgetBytes = 256u << 20;	// Video memory the streamed textures may take together.
+	size_t uploadBytesPerFrame = 4u << 20;	// Caps the uploads of one frame, one load always goes through.
+	size_t tailBytes = 64u << 10;	// Textures start with the mips that fit in this, those stay resident.
+
+	// A share of the card's dedicated memory, as D3DClass::GetVideoCardInfo reports it. The rest is for the render
+	// targets, the meshes and whatever else is running.
+	static TextureStreamSettings FromVideoMemory(int megabytes, float share = 0.5f);
+};
+
+struct TextureStreamStats {
+	size_t textures = 0;
+	size_t residentBytes = 0;
+	size_t peakResidentBytes = 0;
+	size_t uploadedBytes = 0;	// Over all frames.
+	size_t frameUploadedBytes = 0;	// Of the last Update.
+	size_t loads = 0;	// Single mips made resident.
+	size_t evictions = 0;	// Single mips dropped.
+	size_t deniedLoads = 0;	// Loads the budget had no room for, not even after evicting.
+	// Pop-in: textures that were requested in a frame and drew with fewer mips than they asked for.
+	size_t visibleFrames = 0;	// Texture frames, every requested texture counts once per Update.
+	size_t deficitFrames = 0;	// Of those, drawn blurrier than wanted.
+	size_t severeDeficitFrames = 0;	// Two or more mips blurrier.
+};
+
+// A texture should now have its mips from mip on, see TextureClass::SetResidentMip.
+struct TextureStreamAction {
+	uint64_t key = 0;
+	uint32_t mip = 0;
+};
+
+// Decides which mips of the streamed textures are resident. Textures start with their small tail, the models drawing
+// them request the mip their on-screen texel density needs every frame and Update answers with the textures to grow or
+// shrink. Finer mips load one level at a time, the biggest deficit first; when the budget runs out, the textures used
+// least recently give back mips they no longer need. Knows nothing of the GPU, so it runs just as well against a
+// simulated camera. Main thread only.
+class TextureStreamerClass {
+public:
+	TextureStreamerClass(const TextureStreamSettings& settings = TextureStreamSettings()) : m_settings(settings) {}
+	TextureStreamerClass(const TextureStreamerClass&) = delete;
+
+	// Sizes of every mip, finest first, over all of the slices. Returns the mip the texture starts resident at: the
+	// finest one that keeps the tail inside tailBytes, but never coarser than coarsestTopMip.
+	uint32_t Add(uint64_t key, const std::vector<size_t>& mipSizes, uint32_t coarsestTopMip);
+	void Remove(uint64_t key);
+	// What the texture really holds, after a hot reload or a failed action.
+	void SetResident(uint64_t key, uint32_t mip);
+	// The finest mip some model draws the texture at this frame. The finest request of the frame wins.
+	void Request(uint64_t key, uint32_t mip);
+	// Ends the frame: returns the textures whose resident mip changed, and takes them as done.
+	const std::vector<TextureStreamAction>& Update();
+
+	// The mip whose texels land about one per pixel. texelsPerWorld is the texel density on the surface, pixelsPerWorld
+	// what a unit of world covers on screen at the distance it is seen from.
+	static uint32_t GetDesiredMip(float texelsPerWorld, float pixelsPerWorld, uint32_t mipLevels);
+
+	uint32_t GetResidentMip(uint64_t key) const;	// 0 for keys that are not streamed.
+	const TextureStreamStats& GetStats() const { return m_stats; }
+	const TextureStreamSettings& GetSettings() const { return m_settings; }
+	void SetSettings(const TextureStreamSettings& settings) { m_settings = settings; }
+
+private:
+	struct Entry {
+		std::vector<size_t> mipSizes;
+		uint32_t tailMip = 0;	// Never evicted past this.
+		uint32_t residentMip = 0;
+		uint32_t requestedMip = UINT32_MAX;	// Of this frame, none yet.
+		uint32_t desiredMip = 0;	// What this frame needs, the tail when nothing asked for the texture.
+		uint64_t lastUsed = 0;	// Frame of the last request.
+		uint32_t reportedMip = 0;	// What the last action told the texture to hold.
+	};
+
+	static size_t GetBytes(const Entry& entry, uint32_t mip);	// Resident from mip on.
+	bool Evict(size_t bytes, const Entry* keep);
+
+	TextureStreamSettings m_settings;
+	std::unordered_map<uint64_t, Entry> m_entries;
+	std::vector<TextureStreamAction> m_actions;
+	TextureStreamStats m_stats;
+	uint64_t m_frame = 0;
+};
@@ -0,0 +1,106 @@
+#include "threadpoolclass.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// Shared by the caller of ParallelFor and its helpers. A helper may start after the caller returned or never run
+// at all when the pool goes away first, so every copy of a helper holds a reference and the last one deletes it.
+struct ParallelBatch {
+	std::function<void(size_t)> job;
+	size_t count = 0;
+	std::atomic<size_t> next{ 0 };
+	std::mutex mutex;
+	std::condition_variable finished;
+	size_t done = 0;
+	size_t references = 0;
+};
+
+struct BatchReference {
+	ParallelBatch* batch;
+
+	BatchReference(ParallelBatch* batch) : batch(batch) { AddReference(); }
+	BatchReference(const BatchReference& other) : batch(other.batch) { AddReference(); }
+	BatchReference& operator=(const BatchReference&) = delete;
+	~BatchReference() {
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock(batch->mutex);
+			last = --batch->references == 0;
+		}
+		if (last) { delete batch; }
+	}
+
+	void AddReference() {
+		std::lock_guard<std::mutex> lock(batch->mutex);
+		batch->references++;
+	}
+};
+
+}
+
+static void WorkOn(ParallelBatch* batch) {
+	size_t completed = 0;
+	for (size_t index = batch->next++; index < batch->count; index = batch->next++) {
+		batch->job(index);
+		completed++;
+	}
+	std::lock_guard<std::mutex> lock(batch->mutex);
+	batch->done += completed;
+	if (batch->done == batch->count) { batch->finished.notify_all(); }
+}
+
+ThreadPoolClass::ThreadPoolClass(size_t threadCount) {
+	if (threadCount == 0) {
+		size_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+	for (size_t i = 0; i < threadCount; i++) { m_threads.emplace_back(&ThreadPoolClass::Run, this); }
+	isInitialized = true;
+}
+
+ThreadPoolClass::~ThreadPoolClass() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+		m_jobs.clear();
+	}
+	m_wake.notify_all();
+	for (std::thread& thread : m_threads) { thread.join(); }
+}
+
+void ThreadPoolClass::Submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(std::move(job));
+	}
+	m_wake.notify_one();
+}
+
+void ThreadPoolClass::Run() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+			if (m_stopping) { return; }
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		job();
+	}
+}
+
+void ThreadPoolClass::ParallelFor(size_t count, std::function<void(size_t)> job) {
+	if (count == 0) { return; }
+	BatchReference reference(new ParallelBatch);
+	ParallelBatch* batch = reference.batch;
+	batch->job = std::move(job);
+	batch->count = count;
+	size_t helpers = std::min(m_threads.size(), count - 1);
+	for (size_t i = 0; i < helpers; i++) { Submit([reference]() { WorkOn(reference.batch); }); }
+
+	WorkOn(batch);
+	std::unique_lock<std::mutex> lock(batch->mutex);
+	batch->finished.wait(lock, [batch] { return batch->done == batch->count; });
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running submitted jobs in order. Jobs still queued when the pool is destroyed are
+// dropped, running ones are waited for.
+class ThreadPoolClass {
+public:
+	ThreadPoolClass(size_t threadCount = 0);	// 0 leaves one hardware thread to the main loop.
+	ThreadPoolClass(const ThreadPoolClass&) = delete;
+	~ThreadPoolClass();
+
+	void Submit(std::function<void()> job);
+	// Runs job(0) to job(count - 1) on the workers and the calling thread and returns once all of them ran. The caller
+	// does its share instead of just waiting, so this also works from inside a job of the same pool.
+	void ParallelFor(size_t count, std::function<void(size_t)> job);
+	size_t GetThreadCount() const { return m_threads.size(); }
+
+	bool isInitialized = false;
+
+private:
+	void Run();
+
+	std::vector<std::thread> m_threads;
+	std::deque<std::function<void()>> m_jobs;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_stopping = false;
+};
@@ -0,0 +1,394 @@
+#include "vertexencoderclass.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VERTEXENCODER_SSE2
+#endif
+#if defined(__F16C__) || defined(__AVX2__)
+#include <immintrin.h>
+#define VERTEXENCODER_F16C
+#endif
+
+static constexpr float SNORM16_MAX = 32767.0f;
+static constexpr float UNORM16_MAX = 65535.0f;
+
+MeshVertexFormat VertexEncoderClass::Layout(const VertexEncoding& encoding) {
+	VertexLayout layout = Describe(encoding);
+	MeshVertexFormat format;
+	format.encoding = encoding;
+	format.stride = layout.GetStride();
+	format.streamCount = layout.streamCount;
+	for (uint32_t stream = 0; stream < layout.streamCount; stream++) { format.streamStrides[stream] = layout.strides[stream]; }
+	return format;
+}
+
+size_t VertexEncoderClass::GetAttribute(const VertexLayout& layout, VertexSemantic semantic, size_t vertexCount, uint32_t& stride) {
+	const VertexElement* element = layout.Find(semantic);
+	stride = layout.strides[element->stream];
+	return layout.GetStreamStart(element->stream, vertexCount) + element->offset;
+}
+
+VertexEncodeStats VertexEncoderClass::Encode(const std::vector<MeshVertex>& vertices, const VertexEncoding& encoding, MeshVertexFormat& format, std::vector<unsigned char>& output) {
+	format = Layout(encoding);
+	ComputeBounds(vertices, format);
+
+	output.assign(vertices.size() * format.stride, 0);
+	VertexLayout layout = Describe(encoding);
+	uint32_t stride = 0;
+	size_t start = GetAttribute(layout, SEMANTIC_POSITION, vertices.size(), stride);
+	EncodePositions(vertices, format, output.data() + start, stride);
+	start = GetAttribute(layout, SEMANTIC_TEXCOORD, vertices.size(), stride);
+	EncodeTexcoords(vertices, format, output.data() + start, stride);
+	start = GetAttribute(layout, SEMANTIC_NORMAL, vertices.size(), stride);
+	EncodeNormals(vertices, format, output.data() + start, stride);
+
+	// Measure what the encoding cost by decoding everything again.
+	VertexEncodeStats stats;
+	stats.bytesBefore = vertices.size() * sizeof(MeshVertex);
+	stats.bytesAfter = output.size();
+	for (size_t i = 0; i < vertices.size(); i++) {
+		const MeshVertex& original = vertices[i];
+		MeshVertex decoded = Decode(output.data(), vertices.size(), i, format);
+		for (int k = 0; k < 3; k++) {
+			stats.maxPositionError = std::max(stats.maxPositionError, fabsf(decoded.Position()[k] - original.Position()[k]));
+		}
+		for (int k = 0; k < 2; k++) {
+			stats.maxTexcoordError = std::max(stats.maxTexcoordError, fabsf(decoded.Texcoord()[k] - original.Texcoord()[k]));
+		}
+
+		// The angle from sine and cosine, acos of a cosine this close to 1 would report float rounding as error.
+		const float* n = original.Normal();
+		const float* d = decoded.Normal();
+		if (n[0] != 0.0f || n[1] != 0.0f || n[2] != 0.0f) {
+			float cross[3] = { n[1] * d[2] - n[2] * d[1], n[2] * d[0] - n[0] * d[2], n[0] * d[1] - n[1] * d[0] };
+			float sine = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+			float degrees = atan2f(sine, n[0] * d[0] + n[1] * d[1] + n[2] * d[2]) * 57.2957795f;
+			stats.maxNormalError = std::max(stats.maxNormalError, degrees);
+		}
+	}
+	return stats;
+}
+
+void VertexEncoderClass::ComputeBounds(const std::vector<MeshVertex>& vertices, MeshVertexFormat& format) {
+	if (vertices.empty()) { return; }
+
+	float minimum[5], maximum[5];
+	for (int k = 0; k < 3; k++) { minimum[k] = maximum[k] = vertices[0].Position()[k]; }
+	for (int k = 0; k < 2; k++) { minimum[3 + k] = maximum[3 + k] = vertices[0].Texcoord()[k]; }
+	for (const MeshVertex& v : vertices) {
+		for (int k = 0; k < 3; k++) {
+			minimum[k] = std::min(minimum[k], v.Position()[k]);
+			maximum[k] = std::max(maximum[k], v.Position()[k]);
+		}
+		for (int k = 0; k < 2; k++) {
+			minimum[3 + k] = std::min(minimum[3 + k], v.Texcoord()[k]);
+			maximum[3 + k] = std::max(maximum[3 + k], v.Texcoord()[k]);
+		}
+	}
+
+	// Positions are stored in -1..1 around the box centre, flat axes keep a unit scale.
+	if (format.encoding.position != POSITION_FLOAT3) {
+		for (int k = 0; k < 3; k++) {
+			float halfExtent = (maximum[k] - minimum[k]) * 0.5f;
+			format.positionScale[k] = halfExtent > 0.0f ? halfExtent : 1.0f;
+			format.positionBias[k] = (maximum[k] + minimum[k]) * 0.5f;
+		}
+	}
+	if (format.encoding.texcoord == TEXCOORD_UNORM16) {
+		for (int k = 0; k < 2; k++) {
+			float extent = maximum[3 + k] - minimum[3 + k];
+			format.texcoordScaleBias[k] = extent > 0.0f ? extent : 1.0f;
+			format.texcoordScaleBias[2 + k] = minimum[3 + k];
+		}
+	}
+}
+
+void VertexEncoderClass::EncodePositions(const std::vector<MeshVertex>& vertices, const MeshVertexFormat& format, unsigned char* out, uint32_t stride) {
+	size_t count = vertices.size();
+
+	if (format.encoding.position == POSITION_FLOAT3) {
+		for (size_t i = 0; i < count; i++) { memcpy(out + i * stride, vertices[i].Position(), 12); }
+		return;
+	}
+
+	float invScale[4] = { 1.0f / format.positionScale[0], 1.0f / format.positionScale[1], 1.0f / format.positionScale[2], 0.0f };
+
+	if (format.encoding.position == POSITION_HALF) {
+		std::vector<float> normalized(count * 4);
+		for (size_t i = 0; i < count; i++) {
+			for (int k = 0; k < 3; k++) { normalized[i * 4 + k] = (vertices[i].Position()[k] - format.positionBias[k]) * invScale[k]; }
+			normalized[i * 4 + 3] = 1.0f;
+		}
+		std::vector<uint16_t> halves(count * 4);
+		EncodeHalves(normalized.data(), normalized.size(), halves.data());
+		for (size_t i = 0; i < count; i++) { memcpy(out + i * stride, &halves[i * 4], 8); }
+		return;
+	}
+
+	size_t i = 0;
+#ifdef VERTEXENCODER_SSE2
+	const __m128 bias = _mm_loadu_ps(format.positionBias);
+	const __m128 scale = _mm_loadu_ps(invScale);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const __m128 snormMax = _mm_set1_ps(SNORM16_MAX);
+	const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128i wOne = _mm_set_epi16(0, 0, 0, 0, 0x7FFF, 0, 0, 0);
+	for (; i < count; i++) {
+		// Reads position plus the first texcoord, the fourth lane is masked to w = 1 below.
+		__m128 p = _mm_loadu_ps(vertices[i].Position());
+		p = _mm_and_ps(_mm_mul_ps(_mm_sub_ps(p, bias), scale), xyzMask);
+		p = _mm_mul_ps(_mm_min_ps(_mm_max_ps(p, minusOne), one), snormMax);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(p), _mm_setzero_si128());
+		_mm_storel_epi64((__m128i*)(out + i * stride), _mm_or_si128(packed, wOne));
+	}
+#endif
+	for (; i < count; i++) {
+		int16_t packed[4] = { 0, 0, 0, 0x7FFF };
+		for (int k = 0; k < 3; k++) {
+			float value = (vertices[i].Position()[k] - format.positionBias[k]) * invScale[k];
+			value = std::min(1.0f, std::max(-1.0f, value));
+			packed[k] = (int16_t)nearbyintf(value * SNORM16_MAX);
+		}
+		memcpy(out + i * stride, packed, 8);
+	}
+}
+
+void VertexEncoderClass::EncodeTexcoords(const std::vector<MeshVertex>& vertices, const MeshVertexFormat& format, unsigned char* out, uint32_t stride) {
+	size_t count = vertices.size();
+
+	if (format.encoding.texcoord == TEXCOORD_FLOAT2) {
+		for (size_t i = 0; i < count; i++) { memcpy(out + i * stride, vertices[i].Texcoord(), 8); }
+		return;
+	}
+
+	if (format.encoding.texcoord == TEXCOORD_HALF2) {
+		std::vector<float> texcoords(count * 2);
+		for (size_t i = 0; i < count; i++) { memcpy(&texcoords[i * 2], vertices[i].Texcoord(), 8); }
+		std::vector<uint16_t> halves(count * 2);
+		EncodeHalves(texcoords.data(), texcoords.size(), halves.data());
+		for (size_t i = 0; i < count; i++) { memcpy(out + i * stride, &halves[i * 2], 4); }
+		return;
+	}
+
+	const float* scaleBias = format.texcoordScaleBias;
+	for (size_t i = 0; i < count; i++) {
+		uint16_t packed[2];
+		for (int k = 0; k < 2; k++) {
+			float value = (vertices[i].Texcoord()[k] - scaleBias[2 + k]) / scaleBias[k];
+			packed[k] = (uint16_t)nearbyintf(std::min(1.0f, std::max(0.0f, value)) * UNORM16_MAX);
+		}
+		memcpy(out + i * stride, packed, 4);
+	}
+}
+
+void VertexEncoderClass::EncodeNormals(const std::vector<MeshVertex>& vertices, const MeshVertexFormat& format, unsigned char* out, uint32_t stride) {
+	size_t count = vertices.size();
+
+	if (format.encoding.normal == NORMAL_FLOAT3) {
+		for (size_t i = 0; i < count; i++) { memcpy(out + i * stride, vertices[i].Normal(), 12); }
+		return;
+	}
+
+	size_t i = 0;
+#ifdef VERTEXENCODER_SSE2
+	// Four normals at a time in structure of arrays form.
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 snormMax = _mm_set1_ps(SNORM16_MAX);
+	for (; i + 4 <= count; i += 4) {
+		const float* n0 = vertices[i].Normal();
+		const float* n1 = vertices[i + 1].Normal();
+		const float* n2 = vertices[i + 2].Normal();
+		const float* n3 = vertices[i + 3].Normal();
+		__m128 x = _mm_set_ps(n3[0], n2[0], n1[0], n0[0]);
+		__m128 y = _mm_set_ps(n3[1], n2[1], n1[1], n0[1]);
+		__m128 z = _mm_set_ps(n3[2], n2[2], n1[2], n0[2]);
+
+		// Project onto the octahedron |x| + |y| + |z| = 1. Zero normals end up as (0, 0).
+		__m128 sum = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+		__m128 valid = _mm_cmpgt_ps(sum, zero);
+		__m128 inv = _mm_and_ps(_mm_div_ps(one, sum), valid);
+		__m128 ox = _mm_mul_ps(x, inv);
+		__m128 oy = _mm_mul_ps(y, inv);
+
+		// Fold the lower hemisphere over the diagonals.
+		__m128 signX = _mm_or_ps(_mm_and_ps(ox, signMask), one);
+		__m128 signY = _mm_or_ps(_mm_and_ps(oy, signMask), one);
+		__m128 foldX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, oy)), signX);
+		__m128 foldY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, ox)), signY);
+		__m128 lower = _mm_and_ps(_mm_cmplt_ps(z, zero), valid);
+		ox = _mm_or_ps(_mm_and_ps(lower, foldX), _mm_andnot_ps(lower, ox));
+		oy = _mm_or_ps(_mm_and_ps(lower, foldY), _mm_andnot_ps(lower, oy));
+
+		ox = _mm_mul_ps(_mm_min_ps(_mm_max_ps(ox, minusOne), one), snormMax);
+		oy = _mm_mul_ps(_mm_min_ps(_mm_max_ps(oy, minusOne), one), snormMax);
+		__m128i ix = _mm_cvtps_epi32(ox);
+		__m128i iy = _mm_cvtps_epi32(oy);
+		__m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(ix, iy), _mm_unpackhi_epi32(ix, iy));	// x0 y0 x1 y1 ... x3 y3
+
+		for (int k = 0; k < 4; k++) {
+			int pair = _mm_cvtsi128_si32(packed);
+			memcpy(out + (i + k) * stride, &pair, 4);
+			packed = _mm_srli_si128(packed, 4);
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		float encoded[2];
+		OctahedralEncode(vertices[i].Normal(), encoded);
+		int16_t packed[2] = { (int16_t)nearbyintf(encoded[0] * SNORM16_MAX), (int16_t)nearbyintf(encoded[1] * SNORM16_MAX) };
+		memcpy(out + i * stride, packed, 4);
+	}
+}
+
+void VertexEncoderClass::EncodeHalves(const float* input, size_t count, uint16_t* output) {
+	size_t i = 0;
+#ifdef VERTEXENCODER_F16C
+	for (; i + 4 <= count; i += 4) {
+		__m128i halves = _mm_cvtps_ph(_mm_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storel_epi64((__m128i*)(output + i), halves);
+	}
+#endif
+	for (; i < count; i++) { output[i] = FloatToHalf(input[i]); }
+}
+
+void VertexEncoderClass::OctahedralEncode(const float normal[3], float result[2]) {
+	float sum = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+	if (!(sum > 0.0f)) {
+		result[0] = result[1] = 0.0f;
+		return;
+	}
+
+	float x = normal[0] / sum;
+	float y = normal[1] / sum;
+	if (normal[2] < 0.0f) {
+		float foldX = (1.0f - fabsf(y)) * (x < 0.0f || (x == 0.0f && signbit(x)) ? -1.0f : 1.0f);
+		float foldY = (1.0f - fabsf(x)) * (y < 0.0f || (y == 0.0f && signbit(y)) ? -1.0f : 1.0f);
+		x = foldX;
+		y = foldY;
+	}
+	result[0] = std::min(1.0f, std::max(-1.0f, x));
+	result[1] = std::min(1.0f, std::max(-1.0f, y));
+}
+
+void VertexEncoderClass::OctahedralDecode(const float encoded[2], float normal[3]) {
+	// Mirrors the decode in light.vs.
+	float x = encoded[0];
+	float y = encoded[1];
+	float z = 1.0f - fabsf(x) - fabsf(y);
+	if (z < 0.0f) {
+		float foldX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldX;
+		y = foldY;
+	}
+	float length = sqrtf(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+MeshVertex VertexEncoderClass::Decode(const unsigned char* vertices, size_t vertexCount, size_t index, const MeshVertexFormat& format) {
+	MeshVertex result;
+	VertexLayout layout = Describe(format.encoding);
+	uint32_t stride = 0;
+	const unsigned char* position = vertices + GetAttribute(layout, SEMANTIC_POSITION, vertexCount, stride);
+	position += index * stride;
+	const unsigned char* texcoord = vertices + GetAttribute(layout, SEMANTIC_TEXCOORD, vertexCount, stride);
+	texcoord += index * stride;
+	const unsigned char* normal = vertices + GetAttribute(layout, SEMANTIC_NORMAL, vertexCount, stride);
+	normal += index * stride;
+
+	switch (format.encoding.position) {
+	case POSITION_FLOAT3:
+		memcpy(result.Position(), position, 12);
+		break;
+	case POSITION_SNORM16: {
+		int16_t packed[4];
+		memcpy(packed, position, 8);
+		for (int k = 0; k < 3; k++) { result.Position()[k] = std::max(packed[k] / SNORM16_MAX, -1.0f) * format.positionScale[k] + format.positionBias[k]; }
+		break;
+	}
+	case POSITION_HALF: {
+		uint16_t packed[4];
+		memcpy(packed, position, 8);
+		for (int k = 0; k < 3; k++) { result.Position()[k] = HalfToFloat(packed[k]) * format.positionScale[k] + format.positionBias[k]; }
+		break;
+	}
+	}
+
+	switch (format.encoding.texcoord) {
+	case TEXCOORD_FLOAT2:
+		memcpy(result.Texcoord(), texcoord, 8);
+		break;
+	case TEXCOORD_HALF2: {
+		uint16_t packed[2];
+		memcpy(packed, texcoord, 4);
+		for (int k = 0; k < 2; k++) { result.Texcoord()[k] = HalfToFloat(packed[k]); }
+		break;
+	}
+	case TEXCOORD_UNORM16: {
+		uint16_t packed[2];
+		memcpy(packed, texcoord, 4);
+		float* texture = result.Texcoord();
+		for (int k = 0; k < 2; k++) { texture[k] = packed[k] / UNORM16_MAX * format.texcoordScaleBias[k] + format.texcoordScaleBias[2 + k]; }
+		break;
+	}
+	}
+
+	switch (format.encoding.normal) {
+	case NORMAL_FLOAT3:
+		memcpy(result.Normal(), normal, 12);
+		break;
+	case NORMAL_OCT16: {
+		int16_t packed[2];
+		memcpy(packed, normal, 4);
+		float encoded[2] = { std::max(packed[0] / SNORM16_MAX, -1.0f), std::max(packed[1] / SNORM16_MAX, -1.0f) };
+		OctahedralDecode(encoded, result.Normal());
+		break;
+	}
+	}
+	return result;
+}
+
+uint16_t VertexEncoderClass::FloatToHalf(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	if (magnitude >= 0x7F800000) { return sign | (magnitude > 0x7F800000 ? 0x7E00 : 0x7C00); }	// NaN stays NaN, infinity stays infinity.
+	if (magnitude >= 0x477FF000) { return sign | 0x7C00; }	// Rounds past the largest half.
+	if (magnitude < 0x38800000) {
+		// Subnormal half, the unit is 2^-24 and nearbyint rounds to nearest even.
+		float absolute;
+		memcpy(&absolute, &magnitude, 4);
+		return sign | (uint16_t)nearbyintf(absolute * 16777216.0f);
+	}
+
+	// Rebias the exponent and round the mantissa to nearest even.
+	magnitude -= 0x38000000;
+	return sign | (uint16_t)((magnitude + 0xFFF + ((magnitude >> 13) & 1)) >> 13);
+}
+
+float VertexEncoderClass::HalfToFloat(uint16_t value) {
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+
+	float result;
+	if (exponent == 0) {
+		result = mantissa / 16777216.0f;
+		return sign ? -result : result;
+	}
+
+	uint32_t bits = exponent == 31 ? (sign | 0x7F800000 | (mantissa << 13)) : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+	memcpy(&result, &bits, 4);
+	return result;
+}
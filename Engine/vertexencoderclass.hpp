@@ -0,0 +1,114 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "meshtypes.hpp"
+#include "vertexlayoutclass.hpp"
+
+enum PositionEncoding : uint32_t {
+	POSITION_FLOAT3 = 0,	// R32G32B32_FLOAT, 12 bytes.
+	POSITION_SNORM16 = 1,	// R16G16B16A16_SNORM in the mesh bounds, 8 bytes.
+	POSITION_HALF = 2,		// R16G16B16A16_FLOAT in the mesh bounds, 8 bytes.
+};
+
+enum NormalEncoding : uint32_t {
+	NORMAL_FLOAT3 = 0,		// R32G32B32_FLOAT, 12 bytes.
+	NORMAL_OCT16 = 1,		// Octahedral R16G16_SNORM, 4 bytes.
+};
+
+enum TexcoordEncoding : uint32_t {
+	TEXCOORD_FLOAT2 = 0,	// R32G32_FLOAT, 8 bytes.
+	TEXCOORD_HALF2 = 1,		// R16G16_FLOAT, 4 bytes. Keeps wrapping coordinates outside 0..1.
+	TEXCOORD_UNORM16 = 2,	// R16G16_UNORM in the texture coordinate bounds, 4 bytes.
+};
+
+enum VertexStreams : uint32_t {
+	STREAMS_INTERLEAVED = 0,	// Every attribute in one stream.
+	STREAMS_POSITION_SPLIT = 1,	// Positions in stream 0, the rest in stream 1, for passes that only read positions.
+};
+
+struct VertexEncoding {
+	PositionEncoding position = POSITION_FLOAT3;
+	TexcoordEncoding texcoord = TEXCOORD_FLOAT2;
+	NormalEncoding normal = NORMAL_FLOAT3;
+	VertexStreams streams = STREAMS_INTERLEAVED;
+
+	static constexpr VertexEncoding Compact() { return { POSITION_SNORM16, TEXCOORD_HALF2, NORMAL_OCT16 }; }
+	bool operator==(const VertexEncoding& other) const {
+		return position == other.position && texcoord == other.texcoord && normal == other.normal && streams == other.streams;
+	}
+	bool operator!=(const VertexEncoding& other) const { return !(*this == other); }
+};
+
+// Stored with every cooked mesh. The shader rebuilds attributes as value * scale + offset. Where the attributes lie
+// follows from the encoding, see VertexEncoderClass::Describe. The streams of all vertices are stored one after the
+// other.
+struct MeshVertexFormat {
+	VertexEncoding encoding;
+	uint32_t stride = 0;	// Of all streams together.
+	uint32_t streamCount = 1;
+	uint32_t streamStrides[VertexLayout::MAX_STREAMS]{};
+	float positionScale[4]{ 1.0f, 1.0f, 1.0f, 0.0f };
+	float positionBias[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
+	float texcoordScaleBias[4]{ 1.0f, 1.0f, 0.0f, 0.0f };	// xy scale, zw bias.
+};
+
+struct VertexEncodeStats {
+	size_t bytesBefore = 0;			// With the full float layout.
+	size_t bytesAfter = 0;
+	float maxPositionError = 0.0f;	// In model units.
+	float maxNormalError = 0.0f;	// In degrees.
+	float maxTexcoordError = 0.0f;
+
+	// Vertex fetch bandwidth per frame if every vertex is fetched once per draw.
+	double BandwidthPerFrame(double drawsPerFrame) const { return bytesAfter * drawsPerFrame; }
+};
+
+// Packs float vertices into the compact encodings. The hot loops use SSE2 (F16C for halves) with scalar fallbacks.
+class VertexEncoderClass {
+public:
+	// The layout the encoding stores, the same for the cooker and the input layouts.
+	static constexpr VertexLayout Describe(const VertexEncoding& encoding);
+	static MeshVertexFormat Layout(const VertexEncoding& encoding);
+	static VertexEncodeStats Encode(const std::vector<MeshVertex>& vertices, const VertexEncoding& encoding, MeshVertexFormat& format, std::vector<unsigned char>& output);
+	// The vertex at index of the vertexCount encoded ones.
+	static MeshVertex Decode(const unsigned char* vertices, size_t vertexCount, size_t index, const MeshVertexFormat& format);
+
+	static uint16_t FloatToHalf(float value);
+	static float HalfToFloat(uint16_t value);
+
+private:
+	static void ComputeBounds(const std::vector<MeshVertex>& vertices, MeshVertexFormat& format);
+	// Where the attribute of the first vertex lies in the encoded vertices, the next one is a stride further.
+	static size_t GetAttribute(const VertexLayout& layout, VertexSemantic semantic, size_t vertexCount, uint32_t& stride);
+	static void EncodePositions(const std::vector<MeshVertex>& vertices, const MeshVertexFormat& format, unsigned char* out, uint32_t stride);
+	static void EncodeTexcoords(const std::vector<MeshVertex>& vertices, const MeshVertexFormat& format, unsigned char* out, uint32_t stride);
+	static void EncodeNormals(const std::vector<MeshVertex>& vertices, const MeshVertexFormat& format, unsigned char* out, uint32_t stride);
+	static void EncodeHalves(const float* input, size_t count, uint16_t* output);
+	static void OctahedralEncode(const float normal[3], float result[2]);
+	static void OctahedralDecode(const float encoded[2], float normal[3]);
+};
+
+constexpr VertexLayout VertexEncoderClass::Describe(const VertexEncoding& encoding) {
+	VertexElementFormat position = ELEMENT_FLOAT3;
+	if (encoding.position == POSITION_SNORM16) { position = ELEMENT_SNORM16X4; }
+	if (encoding.position == POSITION_HALF) { position = ELEMENT_HALF4; }
+	VertexElementFormat texcoord = ELEMENT_FLOAT2;
+	if (encoding.texcoord == TEXCOORD_HALF2) { texcoord = ELEMENT_HALF2; }
+	if (encoding.texcoord == TEXCOORD_UNORM16) { texcoord = ELEMENT_UNORM16X2; }
+	VertexElementFormat normal = encoding.normal == NORMAL_OCT16 ? ELEMENT_SNORM16X2 : ELEMENT_FLOAT3;
+
+	// Same attribute order as the float layout: position, texcoord, normal.
+	uint32_t stream = encoding.streams == STREAMS_POSITION_SPLIT ? 1 : 0;
+	return VertexLayout().Add(SEMANTIC_POSITION, position, 0).Add(SEMANTIC_TEXCOORD, texcoord, stream).Add(SEMANTIC_NORMAL, normal, stream);
+}
+
+// The full float encoding stores MeshVertex as it is.
+static_assert(VertexEncoderClass::Describe(VertexEncoding()).GetStride() == sizeof(MeshVertex));
+static_assert(VertexEncoderClass::Describe(VertexEncoding()).Find(SEMANTIC_TEXCOORD)->offset == MESH_VERTEX_LAYOUT.Find(SEMANTIC_TEXCOORD)->offset
+	&& VertexEncoderClass::Describe(VertexEncoding()).Find(SEMANTIC_NORMAL)->offset == MESH_VERTEX_LAYOUT.Find(SEMANTIC_NORMAL)->offset);
+// The sizes the encodings promise.
+static_assert(VertexEncoderClass::Describe(VertexEncoding::Compact()).GetStride() == 16);
+static_assert(VertexEncoderClass::Describe({ POSITION_HALF, TEXCOORD_UNORM16, NORMAL_FLOAT3 }).GetStride() == 24);
+static_assert(VertexEncoderClass::Describe({ POSITION_SNORM16, TEXCOORD_HALF2, NORMAL_OCT16, STREAMS_POSITION_SPLIT }).strides[0] == 8);
+static_assert(VertexEncoderClass::Describe({ POSITION_FLOAT3, TEXCOORD_FLOAT2, NORMAL_FLOAT3, STREAMS_POSITION_SPLIT }).strides[1] == 20);
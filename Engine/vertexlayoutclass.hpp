@@ -0,0 +1,203 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <array>
+#include <type_traits>
+
+// How vertex attributes are stored, the few DXGI formats the meshes use. Kept free of D3D so the cooker builds
+// anywhere, InputLayoutClass maps them.
+enum VertexElementFormat : uint32_t {
+	ELEMENT_FLOAT2 = 0,
+	ELEMENT_FLOAT3 = 1,
+	ELEMENT_FLOAT4 = 2,
+	ELEMENT_HALF2 = 3,
+	ELEMENT_HALF4 = 4,
+	ELEMENT_UNORM16X2 = 5,
+	ELEMENT_SNORM16X2 = 6,
+	ELEMENT_SNORM16X4 = 7,
+};
+
+enum VertexSemantic : uint32_t {
+	SEMANTIC_POSITION = 0,
+	SEMANTIC_TEXCOORD = 1,
+	SEMANTIC_NORMAL = 2,
+	SEMANTIC_COLOR = 3,
+};
+
+struct VertexElement {
+	VertexSemantic semantic = SEMANTIC_POSITION;
+	VertexElementFormat format = ELEMENT_FLOAT3;
+	uint32_t stream = 0;
+	uint32_t offset = 0;	// In its stream.
+};
+
+// Which attribute lies where in which vertex stream, the one description the cooked vertices, the input layouts and
+// the C++ vertex structs are all made from. Built at compile time, each Add packs the element after the ones already
+// in its stream. Streams let passes that need only some attributes fetch only those bytes, a depth pass binds the
+// position stream alone.
+struct VertexLayout {
+	static constexpr uint32_t MAX_ELEMENTS = 8;
+	static constexpr uint32_t MAX_STREAMS = 2;
+
+	VertexElement elements[MAX_ELEMENTS]{};
+	uint32_t elementCount = 0;
+	uint32_t streamCount = 0;
+	uint32_t strides[MAX_STREAMS]{};
+	bool isValid = true;	// False after a semantic was added twice or the limits were passed.
+
+	static constexpr uint32_t GetElementSize(VertexElementFormat format) {
+		switch (format) {
+		case ELEMENT_FLOAT2: return 8;
+		case ELEMENT_FLOAT3: return 12;
+		case ELEMENT_FLOAT4: return 16;
+		case ELEMENT_HALF2: return 4;
+		case ELEMENT_HALF4: return 8;
+		case ELEMENT_UNORM16X2: return 4;
+		case ELEMENT_SNORM16X2: return 4;
+		case ELEMENT_SNORM16X4: return 8;
+		}
+		return 0;
+	}
+
+	constexpr VertexLayout& Add(VertexSemantic semantic, VertexElementFormat format, uint32_t stream = 0) {
+		if (elementCount == MAX_ELEMENTS || stream >= MAX_STREAMS || Has(semantic)) {
+			isValid = false;
+			return *this;
+		}
+		elements[elementCount++] = VertexElement{ semantic, format, stream, strides[stream] };
+		strides[stream] += GetElementSize(format);
+		if (stream >= streamCount) { streamCount = stream + 1; }
+		return *this;
+	}
+
+	constexpr bool Has(VertexSemantic semantic) const {
+		for (uint32_t i = 0; i < elementCount; i++) {
+			if (elements[i].semantic == semantic) { return true; }
+		}
+		return false;
+	}
+
+	constexpr const VertexElement* Find(VertexSemantic semantic) const {
+		for (uint32_t i = 0; i < elementCount; i++) {
+			if (elements[i].semantic == semantic) { return &elements[i]; }
+		}
+		return 0;
+	}
+
+	// Of all streams together.
+	constexpr uint32_t GetStride() const {
+		uint32_t stride = 0;
+		for (uint32_t stream = 0; stream < streamCount; stream++) { stride += strides[stream]; }
+		return stride;
+	}
+
+	// The elements with the semantics in the mask, still where they are, for the input layout of a pass that needs
+	// only those.
+	constexpr VertexLayout Select(uint32_t semanticMask) const {
+		VertexLayout selected = *this;
+		selected.elementCount = 0;
+		for (uint32_t i = 0; i < elementCount; i++) {
+			if (semanticMask & (1u << elements[i].semantic)) { selected.elements[selected.elementCount++] = elements[i]; }
+		}
+		return selected;
+	}
+
+	// Whether a stream holds floats only, which a VertexStruct can then hand out in place.
+	constexpr bool IsFloat(uint32_t stream) const {
+		for (uint32_t i = 0; i < elementCount; i++) {
+			VertexElementFormat format = elements[i].format;
+			if (elements[i].stream == stream && format != ELEMENT_FLOAT2 && format != ELEMENT_FLOAT3 && format != ELEMENT_FLOAT4) { return false; }
+		}
+		return true;
+	}
+
+	// Where a stream starts when the streams of vertexCount vertices lie one after the other in a single buffer.
+	constexpr size_t GetStreamStart(uint32_t stream, size_t vertexCount) const {
+		size_t start = 0;
+		for (uint32_t previous = 0; previous < stream && previous < streamCount; previous++) { start += strides[previous] * vertexCount; }
+		return start;
+	}
+};
+
+// The C++ type of each element format.
+template <VertexElementFormat FORMAT> struct VertexElementType;
+template <> struct VertexElementType<ELEMENT_FLOAT2> { using Type = std::array<float, 2>; };
+template <> struct VertexElementType<ELEMENT_FLOAT3> { using Type = std::array<float, 3>; };
+template <> struct VertexElementType<ELEMENT_FLOAT4> { using Type = std::array<float, 4>; };
+template <> struct VertexElementType<ELEMENT_HALF2> { using Type = std::array<uint16_t, 2>; };
+template <> struct VertexElementType<ELEMENT_HALF4> { using Type = std::array<uint16_t, 4>; };
+template <> struct VertexElementType<ELEMENT_UNORM16X2> { using Type = std::array<uint16_t, 2>; };
+template <> struct VertexElementType<ELEMENT_SNORM16X2> { using Type = std::array<int16_t, 2>; };
+template <> struct VertexElementType<ELEMENT_SNORM16X4> { using Type = std::array<int16_t, 4>; };
+
+// One vertex of one stream of a layout, exactly as the GPU reads it, with typed access by semantic. Arrays of these
+// upload as they are. A stream of floats is stored as floats, its attributes can also be used in place.
+template <const VertexLayout& LAYOUT, uint32_t STREAM = 0>
+struct VertexStruct {
+	static_assert(LAYOUT.isValid && STREAM < LAYOUT.streamCount, "VertexStruct needs a valid layout and one of its streams.");
+	static constexpr uint32_t STRIDE = LAYOUT.strides[STREAM];
+	static constexpr bool FLOATS = LAYOUT.IsFloat(STREAM);
+	using Component = std::conditional_t<FLOATS, float, unsigned char>;
+
+	template <VertexSemantic SEMANTIC> using Type = typename VertexElementType<LAYOUT.Find(SEMANTIC)->format>::Type;
+
+	template <VertexSemantic SEMANTIC>
+	void Set(const Type<SEMANTIC>& value) {
+		static_assert(LAYOUT.Find(SEMANTIC)->stream == STREAM, "The attribute lives in another stream.");
+		memcpy((unsigned char*)components + LAYOUT.Find(SEMANTIC)->offset, value.data(), sizeof(value));
+	}
+	template <VertexSemantic SEMANTIC>
+	Type<SEMANTIC> Get() const {
+		static_assert(LAYOUT.Find(SEMANTIC)->stream == STREAM, "The attribute lives in another stream.");
+		Type<SEMANTIC> value;
+		memcpy(value.data(), (const unsigned char*)components + LAYOUT.Find(SEMANTIC)->offset, sizeof(value));
+		return value;
+	}
+
+	template <VertexSemantic SEMANTIC>
+	float* Attribute() {
+		static_assert(FLOATS && LAYOUT.Find(SEMANTIC)->stream == STREAM, "Only attributes of a float stream can be used in place.");
+		return components + LAYOUT.Find(SEMANTIC)->offset / sizeof(float);
+	}
+	template <VertexSemantic SEMANTIC>
+	const float* Attribute() const { return const_cast<VertexStruct*>(this)->template Attribute<SEMANTIC>(); }
+
+	float* Position() { return Attribute<SEMANTIC_POSITION>(); }
+	float* Texcoord() { return Attribute<SEMANTIC_TEXCOORD>(); }
+	float* Normal() { return Attribute<SEMANTIC_NORMAL>(); }
+	const float* Position() const { return Attribute<SEMANTIC_POSITION>(); }
+	const float* Texcoord() const { return Attribute<SEMANTIC_TEXCOORD>(); }
+	const float* Normal() const { return Attribute<SEMANTIC_NORMAL>(); }
+
+	Component components[STRIDE / sizeof(Component)]{};
+};
+
+// The rules, on every compiler that builds the engine.
+namespace VertexLayoutChecks {
+	inline constexpr VertexLayout INTERLEAVED = VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_FLOAT3).Add(SEMANTIC_TEXCOORD, ELEMENT_HALF2)
+		.Add(SEMANTIC_NORMAL, ELEMENT_SNORM16X2);
+	static_assert(INTERLEAVED.isValid && INTERLEAVED.streamCount == 1 && INTERLEAVED.strides[0] == 20);
+	static_assert(INTERLEAVED.Find(SEMANTIC_TEXCOORD)->offset == 12 && INTERLEAVED.Find(SEMANTIC_NORMAL)->offset == 16);
+	static_assert(!INTERLEAVED.Has(SEMANTIC_COLOR));
+
+	inline constexpr VertexLayout SPLIT = VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_SNORM16X4, 0).Add(SEMANTIC_TEXCOORD, ELEMENT_HALF2, 1)
+		.Add(SEMANTIC_NORMAL, ELEMENT_SNORM16X2, 1);
+	static_assert(SPLIT.streamCount == 2 && SPLIT.strides[0] == 8 && SPLIT.strides[1] == 8 && SPLIT.GetStride() == 16);
+	static_assert(SPLIT.Find(SEMANTIC_TEXCOORD)->offset == 0 && SPLIT.Find(SEMANTIC_NORMAL)->offset == 4 && SPLIT.Find(SEMANTIC_NORMAL)->stream == 1);
+	static_assert(SPLIT.GetStreamStart(0, 100) == 0 && SPLIT.GetStreamStart(1, 100) == 800);
+
+	inline constexpr VertexLayout POSITIONS = SPLIT.Select(1u << SEMANTIC_POSITION);
+	static_assert(POSITIONS.elementCount == 1 && POSITIONS.elements[0].semantic == SEMANTIC_POSITION && POSITIONS.strides[0] == 8);
+
+	static_assert(!VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_FLOAT3).Add(SEMANTIC_POSITION, ELEMENT_FLOAT3).isValid);
+	static_assert(!VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_FLOAT3, VertexLayout::MAX_STREAMS).isValid);
+
+	static_assert(sizeof(VertexStruct<INTERLEAVED>) == 20 && sizeof(VertexStruct<SPLIT, 0>) == 8 && sizeof(VertexStruct<SPLIT, 1>) == 8);
+	static_assert(sizeof(VertexStruct<INTERLEAVED>::Type<SEMANTIC_TEXCOORD>) == VertexLayout::GetElementSize(ELEMENT_HALF2));
+
+	// Float streams are floats, in place.
+	inline constexpr VertexLayout MIXED = VertexLayout().Add(SEMANTIC_POSITION, ELEMENT_FLOAT3, 0).Add(SEMANTIC_TEXCOORD, ELEMENT_HALF2, 1);
+	static_assert(MIXED.IsFloat(0) && !MIXED.IsFloat(1) && !INTERLEAVED.IsFloat(0));
+	static_assert(VertexStruct<MIXED, 0>::FLOATS && sizeof(VertexStruct<MIXED, 0>) == 12 && !VertexStruct<MIXED, 1>::FLOATS);
+}